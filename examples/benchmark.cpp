@@ -0,0 +1,67 @@
+#include <chrono>
+#include <string>
+#include <iostream>
+#include <stdexcept>
+
+#include <builder.h>
+
+// Build a document of records holding several attributes each.
+std::string generate (size_t records) {
+    std::string content = "<?xml version='1.0' encoding='UTF-8'?>\n<records>\n";
+
+    for (size_t i = 0; i < records; ++i) {
+        const std::string id = std::to_string(i);
+
+        content += "  <record id='" + id + "' kind='sample' status='active' owner='service-" + id + "'>\n";
+        content += "    <name>record " + id + "</name>\n";
+        content += "    <value unit='ms' scale='1'>" + id + "</value>\n";
+        content += "    <tags><tag>alpha</tag><tag>beta</tag><tag>gamma</tag></tags>\n";
+        content += "  </record>\n";
+    }
+
+    return content + "</records>\n";
+}
+
+// Parse a document several times, and return the throughput in MB/s.
+double measure (const std::string& content, unsigned flags, size_t runs) {
+    const char* first = content.data();
+    const char* last  = first + content.size();
+
+    xml::sax_handler handler;
+    xml::sax_parser  parser(first, last, flags);
+
+    const auto start = std::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < runs; ++i) {
+        parser.reset(first, last, flags);
+
+        if (parser.parse(handler) != xml::reader::end_document)
+            throw std::runtime_error("malformed XML document");
+    }
+
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    return content.size() * runs / elapsed.count() / 1e6;
+}
+
+int main (int argc, char** argv) {
+    const size_t records = argc > 1 ? std::stoul(argv[1]) : 100000;
+    const size_t runs    = argc > 2 ? std::stoul(argv[2]) : 10;
+
+    try {
+        const std::string content = generate(records);
+
+        std::cout << "document: " << content.size() / 1e6 << " MB, " << runs << " runs" << std::endl;
+
+        const double strict  = measure(content, xml::reader::parse_default, runs);
+        const double trusted = measure(content, xml::reader::parse_trusted, runs);
+
+        std::cout << "strict:  " << strict  << " MB/s" << std::endl;
+        std::cout << "trusted: " << trusted << " MB/s (x" << trusted / strict << ")" << std::endl;
+    } catch (std::exception & e) {
+        std::cerr << e.what() << std::endl;
+        return 2;
+    }
+
+    return 0;
+}
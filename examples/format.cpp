@@ -1,6 +1,8 @@
 #include <iostream>
+#include <stdexcept>
 
-#include <document.h>
+#include <builder.h>
+#include <serializer.h>
 
 void usage (const char* exec_path) {
     std::cout << "Usage :" << std::endl;
@@ -14,13 +16,16 @@ int main (int argc, char** argv) {
     }
 
     try {
-        xml::wdocument doc(argv[1]);
+        xml::wdocument doc = xml::wbuilder::load_utf8(argv[1]);
+
+        std::cout << doc << std::endl;
     } catch (xml::wexception & e) {
         std::wcerr << e << std::endl;
-        return e.errCode();
+        return 2 + e.errCode();
+    } catch (std::runtime_error & e) {
+        std::cerr << e.what() << std::endl;
+        return 2;
     }
 
-    std::wcout << doc << std::endl;
-
     return 0;
 }
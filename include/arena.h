@@ -0,0 +1,193 @@
+#ifndef ARENA_H_INCLUDED
+#define ARENA_H_INCLUDED
+
+#include <new>
+#include <vector>
+#include <cstddef>
+#include <utility>
+
+namespace xml {
+    //! \brief A scratch memory arena.
+    /*!
+     *  This class hands out memory from a few large blocks, and releases
+     *  all of it at once with \c reset(). The blocks are kept, so that an
+     *  arena that is filled and reset repeatedly stops allocating memory
+     *  once it has grown to the largest size it has to hold.
+     *
+     *  The memory of an arena is never released to the heap one object at
+     *  a time : objects built in it with an \c arena_node or an
+     *  \c arena_allocator leave their memory to it when deleted, and must
+     *  not be used once the arena has been reset or destroyed.
+     */
+    class arena {
+    public:
+        //! \brief Constructor.
+        /*!
+         *  No memory is allocated until the first call to \c allocate().
+         *
+         *  \param [in] blockSize The size of the first block, in bytes.
+         */
+        explicit arena(size_t blockSize = 1 << 16);
+
+        arena(const arena&) = delete;
+        arena& operator=(const arena&) = delete;
+
+        //! \brief Destructor.
+        /*!
+         *  Releases all the blocks.
+         */
+        ~arena();
+
+        //! \brief Allocate memory.
+        /*!
+         *  \param [in] size The number of bytes to allocate.
+         *
+         *  \return A pointer to suitably aligned memory.
+         */
+        void* allocate(size_t size);
+
+        //! \brief Release all the memory allocated so far.
+        /*!
+         *  The blocks are kept for the next allocations.
+         */
+        void reset() noexcept;
+
+        //! \brief Whether a pointer has been allocated by this arena.
+        /*!
+         *  \param [in] ptr The pointer to check.
+         *
+         *  \return \c true if \c ptr lies in one of the blocks.
+         */
+        bool owns(const void* ptr) const noexcept;
+
+        //! \brief Get the size of the blocks.
+        /*!
+         *  \return The total number of bytes of the blocks.
+         */
+        size_t capacity() const noexcept;
+
+    private:
+        //! A block of memory.
+        struct block_t {
+            char*  data; //!< The first byte of the block.
+            size_t size; //!< The number of bytes of the block.
+        };
+
+        std::vector<block_t> mBlocks; //!< The blocks, in allocation order.
+
+        size_t mBlock;     //!< The index of the block being filled.
+        size_t mUsed;      //!< The number of bytes used in the block being filled.
+        size_t mBlockSize; //!< The size of the first block.
+    };
+
+    //! \brief A node built in an \c arena.
+    /*!
+     *  This class is a \c nodeT allocated by a placement \c new taking
+     *  the arena, such as <tt>new (memory) arena_node<element_t>(name)</tt>.
+     *  Deleting it runs the destructor and leaves the memory to the arena,
+     *  so that a tree of them is erased as any other, while the nodes
+     *  allocated by a plain \c new stay on the heap. Copies and clones are
+     *  plain \c nodeT allocated on the heap.
+     *
+     *  \tparam nodeT The type of node to build.
+     */
+    template <typename nodeT>
+    class arena_node : public nodeT {
+    public:
+        //! \brief Constructor.
+        /*!
+         *  \param [in] args The arguments of the constructor of \c nodeT.
+         */
+        template <typename... argsT>
+        explicit arena_node(argsT&&... args)
+        :
+            nodeT(std::forward<argsT>(args)...)
+        {}
+
+        //! \brief Allocate a node in an arena.
+        /*!
+         *  \param [in] size   The size of the node.
+         *  \param [in] memory The arena to allocate the node in.
+         */
+        static void* operator new(size_t size, arena& memory)
+        {
+            return memory.allocate(size);
+        }
+
+        //! \brief Release a node whose constructor threw.
+        static void operator delete(void*, arena&) noexcept
+        {}
+
+        //! \brief Release a node : its memory is left to the arena.
+        static void operator delete(void*) noexcept
+        {}
+    };
+
+    //! \brief A standard allocator using an \c arena, or the heap.
+    /*!
+     *  Memory allocated in an arena is left to it when deallocated.
+     *  Containers copied from one using an arena allocate their copy on
+     *  the heap.
+     *
+     *  \tparam T The type of object to allocate.
+     */
+    template <typename T>
+    class arena_allocator {
+    public:
+        typedef T value_type; //!< The type of object to allocate.
+
+        //! \brief Constructor.
+        /*!
+         *  \param [in] memory The arena to allocate in, or \c nullptr for the heap.
+         */
+        explicit arena_allocator(arena* memory = nullptr) noexcept
+        :
+            mArena(memory)
+        {}
+
+        //! \brief Converting constructor.
+        template <typename U>
+        arena_allocator(const arena_allocator<U>& rhs) noexcept
+        :
+            mArena(rhs.memory())
+        {}
+
+        //! \brief Allocate \c n objects.
+        T* allocate(size_t n)
+        {
+            return static_cast<T*>(mArena != nullptr ? mArena->allocate(n * sizeof(T)) : ::operator new(n * sizeof(T)));
+        }
+
+        //! \brief Release objects allocated by \c allocate().
+        void deallocate(T* ptr, size_t) noexcept
+        {
+            if (mArena == nullptr)
+                ::operator delete(ptr);
+        }
+
+        //! \brief Get the allocator of a container copy, which uses the heap.
+        arena_allocator select_on_container_copy_construction() const noexcept
+        {
+            return arena_allocator();
+        }
+
+        //! \brief Get the arena allocated in.
+        /*!
+         *  \return The arena, or \c nullptr for the heap.
+         */
+        arena* memory() const noexcept { return mArena; }
+
+        //! \brief Whether two allocators use the same memory.
+        template <typename U>
+        bool operator==(const arena_allocator<U>& rhs) const noexcept { return mArena == rhs.memory(); }
+
+        //! \brief Whether two allocators use different memories.
+        template <typename U>
+        bool operator!=(const arena_allocator<U>& rhs) const noexcept { return mArena != rhs.memory(); }
+
+    private:
+        arena* mArena; //!< The arena allocated in, or \c nullptr for the heap.
+    };
+}
+
+#endif /* ARENA_H_INCLUDED */
@@ -0,0 +1,202 @@
+#ifndef ATTRIBUTE_INDEX_H_INCLUDED
+#define ATTRIBUTE_INDEX_H_INCLUDED
+
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <cstddef>
+#include <unordered_map>
+
+#include <element.h>
+#include <namespace-table.h>
+
+namespace xml {
+    //! \brief An index of the elements of a tree by attribute value.
+    /*!
+     *  This class maps the namespace, the local name and the value of each
+     *  attribute of a tree to the elements carrying it, in document order.
+     *  Looking up \c //order[@id='123'] is then a hash lookup instead of a
+     *  walk comparing every attribute of the tree.
+     *
+     *  The index is built on first use, by a single thread while the others
+     *  wait, and is read without locking afterwards. Its keys reference the
+     *  names and values of the tree : it is dropped by \c invalidate() when
+     *  the tree is modified, and rebuilt on next use.
+     *
+     *  \sa xml::basic_document::index_attributes()
+     *
+     *  \tparam charT The type of character used in the tree.
+     *                By default, char and wchar_t are supported.
+     */
+    template <typename charT>
+    class basic_attribute_index {
+    public:
+        //! \name Member types
+        //!@{
+        typedef          basic_element<charT>          element_t;        //!< The type of indexed elements.
+        typedef typename element_t::node_interface_t node_interface_t; //!< The base type of nodes.
+        typedef typename element_t::child_t          child_t;          //!< The type of nodes of the tree.
+        typedef typename element_t::parent_t         parent_t;         //!< The type of parent nodes.
+        typedef typename element_t::attribute_t      attribute_t;      //!< The type of indexed attributes.
+        typedef typename element_t::view_t           view_t;           //!< The type of names and values.
+
+        typedef std::vector<const element_t*> elements_t; //!< A list of elements, in document order.
+
+        //!@}
+
+        //! \brief Constructor.
+        /*!
+         *  Builds an empty index, that is filled on first lookup.
+         */
+        basic_attribute_index()
+        :
+            mMutex(),
+            mBuilt(false),
+            mBuilding(false),
+            mEntries()
+        {}
+
+        basic_attribute_index(const basic_attribute_index&) = delete;
+        basic_attribute_index& operator=(const basic_attribute_index&) = delete;
+
+        //! \brief Build the index of a tree, unless it is already built.
+        /*!
+         *  Concurrent calls build the index once.
+         *
+         *  \param [in] root The root element of the tree.
+         */
+        void build(const element_t& root) const
+        {
+            if (mBuilt.load(std::memory_order_acquire))
+                return;
+
+            std::lock_guard<std::mutex> lock(mMutex);
+
+            if (mBuilt.load(std::memory_order_relaxed))
+                return;
+
+            mBuilding = true;
+            mEntries.clear();
+
+            const child_t* it = &root;
+
+            while (it != nullptr) {
+                const element_t& element = static_cast<const element_t&>(*it);
+
+                for (const attribute_t& attribute : element.attributes())
+                    mEntries[key_t { attribute.namespace_id(), attribute.local_name(), attribute.value().view() }].push_back(&element);
+
+                element.mIndexed = true;
+                it = next(element, root);
+            }
+
+            if (root.has_parent())
+                root.parent().mIndexed = true;
+
+            mBuilding = false;
+            mBuilt.store(true, std::memory_order_release);
+        }
+
+        //! \brief Whether the index is built.
+        bool built() const { return mBuilt.load(std::memory_order_acquire); }
+
+        //! \brief Drop the content of the index.
+        /*!
+         *  Called when the tree is modified. Modifications made while the
+         *  index is built, by the loaders of a lazy tree, are ignored : the
+         *  index sees the loaded nodes.
+         */
+        void invalidate()
+        {
+            if (mBuilding || !mBuilt.load(std::memory_order_relaxed))
+                return;
+
+            mBuilt.store(false, std::memory_order_relaxed);
+            mEntries.clear();
+        }
+
+        //! \brief Find the elements carrying an attribute.
+        /*!
+         *  The index must be built.
+         *
+         *  \param [in] ns    The namespace of the attribute, in the namespace table of the tree.
+         *  \param [in] local The local name of the attribute.
+         *  \param [in] value The value of the attribute.
+         *
+         *  \return The elements carrying the attribute, in document order.
+         */
+        const elements_t& find(namespace_id_t ns, const view_t& local, const view_t& value) const
+        {
+            static const elements_t none;
+
+            typename entries_t::const_iterator it = mEntries.find(key_t { ns, local, value });
+
+            return it != mEntries.end() ? it->second : none;
+        }
+
+        //! \brief Get the number of distinct attributes in the index.
+        size_t size() const { return mEntries.size(); }
+
+    private:
+        //! \brief The key of an attribute.
+        class key_t {
+        public:
+            namespace_id_t ns;    //!< The namespace of the attribute.
+            view_t         local; //!< The local name of the attribute.
+            view_t         value; //!< The value of the attribute.
+
+            //! \brief Equality operator.
+            bool operator==(const key_t& rhs) const
+            {
+                return ns == rhs.ns && local == rhs.local && value == rhs.value;
+            }
+        };
+
+        //! \brief The hash function of the keys.
+        class hash_t {
+        public:
+            //! \brief Hash a key.
+            size_t operator()(const key_t& key) const
+            {
+                return (key.value.hash() * 31 + key.local.hash()) * 31 + key.ns;
+            }
+        };
+
+        typedef std::unordered_map<key_t, elements_t, hash_t> entries_t; //!< The type of the entries.
+
+        //! \brief Get the element following another one in document order.
+        static const child_t* next(const element_t& element, const element_t& root)
+        {
+            const child_t* it = &element;
+
+            if (!element.empty())
+                it = &element.front();
+            else
+                it = following(it, root);
+
+            while (it != nullptr && it->kind() != node_interface_t::element_kind)
+                it = following(it, root);
+
+            return it;
+        }
+
+        //! \brief Get the node following a node and its descendants in document order.
+        static const child_t* following(const child_t* it, const element_t& root)
+        {
+            while (it != &root && it->next_sibling() == nullptr)
+                it = &static_cast<const element_t&>(it->parent());
+
+            return it != &root ? it->next_sibling() : nullptr;
+        }
+
+        mutable std::mutex        mMutex;    //!< Serializes the builds.
+        mutable std::atomic<bool> mBuilt;    //!< Whether the entries are complete.
+        mutable bool              mBuilding; //!< Whether the entries are being built.
+        mutable entries_t         mEntries;  //!< The elements of each attribute.
+    };
+
+    typedef basic_attribute_index<char>    attribute_index;  //!< A specialized \c basic_attribute_index for char.
+    typedef basic_attribute_index<wchar_t> wattribute_index; //!< A specialized \c basic_attribute_index for wchar_t.
+}
+
+#endif /* ATTRIBUTE_INDEX_H_INCLUDED */
@@ -0,0 +1,212 @@
+#ifndef ATTRIBUTE_SET_H_INCLUDED
+#define ATTRIBUTE_SET_H_INCLUDED
+
+#include <set>
+#include <cstddef>
+#include <utility>
+#include <initializer_list>
+
+#include <arena.h>
+#include <attribute.h>
+#include <parent-node.h>
+
+namespace xml {
+    //! \brief The attributes of an element.
+    /*!
+     *  This class is a \c std::set of \c basic_attribute, allocated on the
+     *  heap or in an \c arena, that reports the changes of its content to
+     *  the element owning it : the attribute index of the document is
+     *  dropped when attributes are inserted or erased, and not when they
+     *  are only read. Insertions and erasures that leave the set unchanged
+     *  are not reported.
+     *
+     *  A copy of the set of an element belongs to no element.
+     *
+     *  \sa xml::basic_attribute_index
+     *
+     *  \tparam charT The type of character used in the attributes.
+     *                By default, char and wchar_t are supported.
+     */
+    template <typename charT>
+    class basic_attribute_set : public std::set<basic_attribute<charT>, std::less<basic_attribute<charT> >, arena_allocator<basic_attribute<charT> > > {
+    public:
+        //! \name Member types
+        //!@{
+        typedef          basic_attribute<charT>                                           attribute_t; //!< The attribute type.
+        typedef          std::set<attribute_t, std::less<attribute_t>, arena_allocator<attribute_t> > set_t; //!< The type of the set.
+        typedef          basic_parent_node<charT>                                         owner_t;     //!< The type of the element owning the set.
+        typedef typename set_t::value_type                                                value_type;  //!< The type of the attributes.
+        typedef typename set_t::allocator_type                                            allocator_t; //!< The type of the allocator.
+
+        //!@}
+
+        //! \brief Constructor.
+        /*!
+         *  \param [in] owner The element owning the set, or \c nullptr.
+         */
+        explicit basic_attribute_set(owner_t* owner = nullptr)
+        :
+            set_t(),
+            mOwner(owner)
+        {}
+
+        //! \brief Constructor of a set allocated by an allocator.
+        /*!
+         *  \param [in] owner     The element owning the set, or \c nullptr.
+         *  \param [in] allocator The allocator of the attributes.
+         */
+        basic_attribute_set(owner_t* owner, const allocator_t& allocator)
+        :
+            set_t(allocator),
+            mOwner(owner)
+        {}
+
+        //! \brief Copy constructor.
+        /*!
+         *  The copy is allocated on the heap.
+         *
+         *  \param [in] rhs   The set to copy.
+         *  \param [in] owner The element owning the copy, or \c nullptr.
+         */
+        basic_attribute_set(const basic_attribute_set& rhs, owner_t* owner = nullptr)
+        :
+            set_t(rhs),
+            mOwner(owner)
+        {}
+
+        //! \brief Move constructor.
+        /*!
+         *  \param [in] rhs   The set to move.
+         *  \param [in] owner The element owning the set, or \c nullptr.
+         */
+        basic_attribute_set(basic_attribute_set&& rhs, owner_t* owner = nullptr)
+        :
+            set_t(std::move(rhs)),
+            mOwner(owner)
+        {}
+
+        //! \brief Copy assignment operator.
+        basic_attribute_set& operator=(const basic_attribute_set& rhs)
+        {
+            set_t::operator=(rhs);
+            changed();
+
+            return *this;
+        }
+
+        //! \brief Move assignment operator.
+        basic_attribute_set& operator=(basic_attribute_set&& rhs)
+        {
+            set_t::operator=(std::move(rhs));
+            changed();
+
+            return *this;
+        }
+
+        //! \brief Assign a list of attributes.
+        basic_attribute_set& operator=(std::initializer_list<value_type> list)
+        {
+            set_t::operator=(list);
+            changed();
+
+            return *this;
+        }
+
+        //! \brief Insert attributes, as \c std::set::insert().
+        template <typename... argsT>
+        auto insert(argsT&&... args) -> decltype(std::declval<set_t&>().insert(std::forward<argsT>(args)...))
+        {
+            guard_t guard(*this);
+
+            return set_t::insert(std::forward<argsT>(args)...);
+        }
+
+        //! \brief Insert a list of attributes.
+        void insert(std::initializer_list<value_type> list)
+        {
+            guard_t guard(*this);
+
+            set_t::insert(list);
+        }
+
+        //! \brief Build an attribute in place, as \c std::set::emplace().
+        template <typename... argsT>
+        auto emplace(argsT&&... args) -> decltype(std::declval<set_t&>().emplace(std::forward<argsT>(args)...))
+        {
+            guard_t guard(*this);
+
+            return set_t::emplace(std::forward<argsT>(args)...);
+        }
+
+        //! \brief Build an attribute in place, as \c std::set::emplace_hint().
+        template <typename... argsT>
+        auto emplace_hint(argsT&&... args) -> decltype(std::declval<set_t&>().emplace_hint(std::forward<argsT>(args)...))
+        {
+            guard_t guard(*this);
+
+            return set_t::emplace_hint(std::forward<argsT>(args)...);
+        }
+
+        //! \brief Erase attributes, as \c std::set::erase().
+        template <typename... argsT>
+        auto erase(argsT&&... args) -> decltype(std::declval<set_t&>().erase(std::forward<argsT>(args)...))
+        {
+            guard_t guard(*this);
+
+            return set_t::erase(std::forward<argsT>(args)...);
+        }
+
+        //! \brief Erase all the attributes.
+        void clear()
+        {
+            guard_t guard(*this);
+
+            set_t::clear();
+        }
+
+        //! \brief Exchange the attributes of two sets.
+        void swap(basic_attribute_set& rhs)
+        {
+            set_t::swap(rhs);
+            changed();
+            rhs.changed();
+        }
+
+    private:
+        //! \brief Reports a change if the number of attributes changed in its scope.
+        class guard_t {
+        public:
+            //! \brief Constructor.
+            guard_t(basic_attribute_set& set)
+            :
+                mSet(set),
+                mSize(set.size())
+            {}
+
+            //! \brief Destructor.
+            ~guard_t()
+            {
+                if (mSet.size() != mSize)
+                    mSet.changed();
+            }
+
+        private:
+            basic_attribute_set& mSet;  //!< The set.
+            size_t               mSize; //!< The number of attributes before the change.
+        };
+
+        //! \brief Report a change to the owner of the set.
+        void changed()
+        {
+            if (mOwner != nullptr)
+                mOwner->touch();
+        }
+
+        owner_t* mOwner; //!< The element owning the set, or \c nullptr.
+    };
+
+    typedef basic_attribute_set<char>    attribute_set;  //!< A specialized \c basic_attribute_set for char.
+    typedef basic_attribute_set<wchar_t> wattribute_set; //!< A specialized \c basic_attribute_set for wchar_t.
+}
+
+#endif /* ATTRIBUTE_SET_H_INCLUDED */
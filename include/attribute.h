@@ -4,12 +4,20 @@
 #include <string>
 #include <istream>
 #include <sstream>
+#include <algorithm>
+
+#include <typed-string.h>
+#include <namespace-table.h>
 
 namespace xml {
 
     //! \brief A XML attribute.
     /*!
      *  This class represents an XML attribute that has a name and a value.
+     *  When the document is parsed with namespaces, it also has the
+     *  identifier of its namespace in the namespace table of the document.
+     *  When the document is annotated by a schema, it also holds the typed
+     *  value of its value.
      *
      *  \tparam charT The type of character used in the name and value.
      *                By default, char and wchar_t are supported.
@@ -19,7 +27,11 @@ namespace xml {
     public:
         //! \name Member types
         //!@{
-        typedef std::basic_string<charT>  string_t;  //!< The type of string to parse
+        typedef std::basic_string<charT>  string_t;       //!< The type of string to parse
+        typedef basic_string_ref<charT>   string_ref_t;   //!< The type of string stored.
+        typedef basic_typed_string<charT> typed_string_t; //!< The type of value stored.
+        typedef basic_string_view<charT>  view_t;         //!< The type of local names.
+        typedef basic_namespace_table<charT> table_t;     //!< The namespace table type.
 
         typedef basic_attribute<charT> attribute_t;                 //!< The type of attribute.
         typedef attribute_t*           attribute_pointer_t;         //!< Pointer to \c attribute_t.
@@ -35,13 +47,16 @@ namespace xml {
          *
          *  \param [in] name  The name of the attribute.
          *  \param [in] value The value of the attribute.
+         *  \param [in] ns    The namespace of the attribute.
          */
         basic_attribute(
-            const string_t& name,
-            const string_t& value)
+            string_ref_t name,
+            string_ref_t value,
+            namespace_id_t ns = table_t::no_namespace)
         :
-            mName(name),
-            mValue(value)
+            mName(std::move(name)),
+            mValue(std::move(value)),
+            mNamespace(ns)
         {}
 
         //! \brief Copy constructor.
@@ -53,7 +68,8 @@ namespace xml {
         basic_attribute(attribute_const_reference_t rhs)
         :
             mName(rhs.mName),
-            mValue(rhs.mValue)
+            mValue(rhs.mValue),
+            mNamespace(rhs.mNamespace)
         {}
 
         //! \brief Move constructor.
@@ -65,7 +81,8 @@ namespace xml {
         basic_attribute(attribute_move_t rhs)
         :
             mName(std::move(rhs.mName)),
-            mValue(std::move(rhs.mValue))
+            mValue(std::move(rhs.mValue)),
+            mNamespace(rhs.mNamespace)
         {}
 
         //! \brief Destructor.
@@ -82,7 +99,7 @@ namespace xml {
          *
          *  \return A constant reference to the name of the \c basic_attribute.
          */
-        const string_t& name() const
+        const string_ref_t& name() const
         {
             return mName;
         }
@@ -94,11 +111,59 @@ namespace xml {
          *
          *  \return A reference to the name of the \c basic_attribute.
          */
-        string_t& name()
+        string_ref_t& name()
         {
             return mName;
         }
 
+        //! \brief Get the local name of an attribute.
+        /*!
+         *  \return The part of the name that follows its prefix, or the
+         *          whole name if it has no prefix.
+         */
+        view_t local_name() const
+        {
+            const view_t name = mName.view();
+            const charT* colon = std::find(name.begin(), name.end(), charT(':'));
+
+            return colon != name.end() ? view_t(colon + 1, name.end()) : name;
+        }
+
+        //! \brief Get the namespace of an attribute.
+        /*!
+         *  \return The identifier of the namespace of the attribute in the
+         *          namespace table of its document.
+         */
+        namespace_id_t namespace_id() const
+        {
+            return mNamespace;
+        }
+
+        //! \brief Get the namespace of an attribute.
+        /*!
+         *  \return A reference to the identifier of the namespace of the
+         *          attribute, which must be interned in the namespace table
+         *          of its document.
+         */
+        namespace_id_t& namespace_id()
+        {
+            return mNamespace;
+        }
+
+        //! \brief Whether an attribute has a given expanded name.
+        /*!
+         *  The namespaces are compared as integers, before the local names.
+         *
+         *  \param [in] ns    The identifier of the namespace.
+         *  \param [in] local The local name.
+         *
+         *  \return \c true if the attribute is named \c local in \c ns.
+         */
+        bool has_name(namespace_id_t ns, const view_t& local) const
+        {
+            return mNamespace == ns && local_name() == local;
+        }
+
         //! \brief Get the value of an attribute.
         /*!
          *  This function returns a constant reference to the value of the
@@ -106,7 +171,7 @@ namespace xml {
          *
          *  \return A constant reference to the value of the \c basic_attribute.
          */
-        const string_t& value() const
+        const typed_string_t& value() const
         {
             return mValue;
         }
@@ -114,18 +179,55 @@ namespace xml {
         //! \brief Get the value of an attribute.
         /*!
          *  This function returns a reference to the value of the
-         *  \c basic_attribute.
+         *  \c basic_attribute. A value referencing the source of the document
+         *  is copied when it is modified, and its typed value is dropped.
          *
          *  \return A reference to the value of the \c basic_attribute.
          */
-        string_t& value()
+        typed_string_t& value()
         {
             return mValue;
         }
 
+        //! \brief Get the typed value of an attribute.
+        /*!
+         *  \return The value converted by the last schema annotation of the
+         *          document, or an \c untyped value.
+         */
+        const typed_value& typed() const
+        {
+            return mValue.typed();
+        }
+
+        //! \brief Get the typed value of an attribute.
+        /*!
+         *  \return A reference to the typed value, set by the schema
+         *          annotation of the document.
+         */
+        typed_value& typed()
+        {
+            return mValue.annotation();
+        }
+
+        //! \brief A \c basic_attribute lower than operator.
+        /*!
+         *  Attributes are ordered by name, so that a set of attributes holds
+         *  at most one attribute with a given name.
+         *
+         *  \param [in] rhs A constant reference to the \c attribute_t to compare.
+         *
+         *  \return \c true if the name of this attribute is lower than the name of \c rhs.
+         */
+        bool operator<(attribute_const_reference_t rhs) const
+        {
+            return mName < rhs.mName;
+        }
+
     private:
-        string_t  mName; //!< The name of an attribute.
-        string_t mValue; //!< The value of an attribute.
+        string_ref_t    mName; //!< The name of an attribute.
+        typed_string_t mValue; //!< The value of an attribute, and its typed value.
+
+        namespace_id_t mNamespace; //!< The namespace of an attribute.
     };
 
     typedef basic_attribute<char>    attribute;  //!< A specialized \c basic_attribute for char.
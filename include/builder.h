@@ -0,0 +1,647 @@
+#ifndef BUILDER_H_INCLUDED
+#define BUILDER_H_INCLUDED
+
+#include <memory>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <string>
+#include <cstdlib>
+#include <stdexcept>
+
+#include <sax.h>
+#include <exception.h>
+#include <expected.h>
+#include <entity-decoder.h>
+#include <document.h>
+#include <namespace-table.h>
+#include <mapped-file.h>
+
+namespace xml {
+    //! \brief A XML tree builder.
+    /*!
+     *  This class is a \c basic_sax_handler that fills a \c basic_document
+     *  with the \c basic_element and \c basic_text nodes corresponding to
+     *  the events it receives. CDATA sections are stored as text nodes.
+     *  Texts made of white spaces are kept, unless the
+     *  \c reader_t::parse_strip_whitespace flag is given : they are then
+     *  dropped, except in the scope of \c xml:space="preserve".
+     *  Comments, processing instructions and the document type declaration
+     *  are skipped. Character and entity references are decoded in texts
+     *  and attribute values.
+     *
+     *  Namespace prefixes are resolved while parsing, unless the
+     *  \c reader_t::parse_no_namespaces flag is given : each namespace URI
+     *  is interned once in the namespace table of the document, and
+     *  elements and attributes get the identifier of their namespace. The
+     *  prefixes in scope are kept in a \c basic_namespace_scope, so that
+     *  resolving a prefix does not depend on the depth of the element.
+     *  An unbound prefix is an \c invalid_namespace error.
+     *
+     *  A builder can reference the parsed buffer in the nodes instead of
+     *  copying names and values, when the buffer is kept alive as the
+     *  source of the document.
+     *
+     *  Parse errors are thrown as \c basic_exception by \c parse(), or
+     *  returned as \c basic_parse_error by \c try_parse(), which can be
+     *  used without exception support.
+     *
+     *  \sa xml::basic_sax_parser
+     *  \sa xml::basic_document
+     *
+     *  \tparam charT The type of character used in the XML document.
+     *                By default, char and wchar_t are supported.
+     */
+    template <typename charT>
+    class basic_builder : public basic_sax_handler<charT> {
+    public:
+        //! \name Member types
+        //!@{
+        typedef          basic_sax_parser<charT>   parser_t;        //!< The parser type.
+        typedef typename parser_t::reader_t        reader_t;        //!< The reader type.
+        typedef typename parser_t::token_t         token_t;         //!< The token type.
+        typedef typename parser_t::view_t          view_t;          //!< The type of names and values.
+        typedef typename parser_t::const_pointer_t const_pointer_t; //!< Pointer to a constant character.
+        typedef typename reader_t::scanner_t       scanner_t;       //!< The scanner type.
+        typedef          basic_entity_decoder<charT> decoder_t;     //!< The reference decoder type.
+
+        typedef          basic_document<charT>    document_t;   //!< The document type.
+        typedef typename document_t::version_t    version_t;    //!< The version type.
+        typedef typename document_t::encoding_t   encoding_t;   //!< The encoding type.
+        typedef typename document_t::standalone_t standalone_t; //!< The standalone status type.
+        typedef typename document_t::string_t     string_t;     //!< The string type.
+        typedef typename document_t::string_ref_t string_ref_t; //!< The type of string stored in nodes.
+
+        typedef          basic_element<charT>         element_t;         //!< The element type.
+        typedef typename element_t::element_pointer_t element_pointer_t; //!< Pointer to \c element_t.
+
+        typedef basic_namespace_table<charT> namespace_table_t; //!< The namespace table type.
+        typedef basic_namespace_scope<charT> namespace_scope_t; //!< The type of the prefixes in scope.
+
+        typedef basic_parse_error<charT>            parse_error_t; //!< The parse error type.
+        typedef basic_exception<charT>              exception_t;   //!< The type of exception thrown on parse errors.
+        typedef expected<document_t, parse_error_t> result_t;      //!< The result of a parse that does not throw.
+
+        //!@}
+
+        //! \brief Constructor.
+        /*!
+         *  Builds a tree builder waiting for the events of a document.
+         *
+         *  \param [in] reference Whether the nodes reference the parsed
+         *                        buffer instead of copying it.
+         *  \param [in] flags     A combination of \c reader_t::flags_t, such as
+         *                        \c reader_t::parse_no_namespaces.
+         */
+        basic_builder(bool reference = false, unsigned flags = reader_t::parse_default)
+        :
+            mDocument(),
+            mStack(),
+            mScope(),
+            mPrefixed(),
+            mExpanded(),
+            mError(nullptr),
+            mErrorCode(reader_t::no_error),
+            mReference(reference),
+            mNamespaces((flags & reader_t::parse_no_namespaces) == 0),
+            mStrip((flags & reader_t::parse_strip_whitespace) != 0),
+            mPending(false)
+        {
+            mVersion.major = 1;
+            mVersion.minor = 0;
+
+            mEncoding.value   = encoding_t::undefined;
+            mStandalone.value = standalone_t::undefined;
+        }
+
+        //! \brief Destructor.
+        /*!
+         *  This destructor does nothing.
+         */
+        virtual ~basic_builder()
+        {}
+
+        //! \brief Store a pseudo-attribute of the XML declaration.
+        bool declaration(const view_t& name, const view_t& value)
+        {
+            if (name.equals("version")) {
+                if (value.size() != 3 || value[1] != '.' ||
+                    value[0] < '0' || value[0] > '9' ||
+                    value[2] < '0' || value[2] > '9')
+                    return fail("invalid XML version", reader_t::invalid_declaration);
+
+                mVersion.major = static_cast<uint8_t>(value[0] - '0');
+                mVersion.minor = static_cast<uint8_t>(value[2] - '0');
+            } else if (name.equals("encoding")) {
+                mEncoding.value = utf8::is_utf8(value.begin(), value.end())
+                    ? encoding_t::UTF8
+                    : encoding_t::undefined;
+            } else if (name.equals("standalone")) {
+                if (value.equals("yes"))
+                    mStandalone.value = standalone_t::yes;
+                else if (value.equals("no"))
+                    mStandalone.value = standalone_t::no;
+                else
+                    return fail("invalid standalone status", reader_t::invalid_declaration);
+            } else {
+                return fail("invalid XML declaration", reader_t::invalid_declaration);
+            }
+
+            return true;
+        }
+
+        //! \brief Create an element, or the document if it is the root element.
+        bool start_element(const view_t& name)
+        {
+            if (mPending && !resolve())
+                return false;
+
+            if (!mDocument) {
+                mDocument.reset(new document_t(store(name)));
+
+                mDocument->version()    = mVersion;
+                mDocument->encoding()   = mEncoding;
+                mDocument->standalone() = mStandalone;
+
+                mStack.push_back(&mDocument->root());
+            } else {
+                mStack.push_back(static_cast<element_pointer_t>(
+                    &*mStack.back()->emplace_element_back(store(name))));
+            }
+
+            if (mNamespaces) {
+                mScope.push();
+                mPending = true;
+            }
+
+            return true;
+        }
+
+        //! \brief Add an attribute to the current element.
+        bool attribute(const view_t& name, const view_t& value)
+        {
+            string_ref_t decoded;
+
+            if (!decoder_t::decode(value, decoded, mReference))
+                return fail("invalid character or entity reference", reader_t::invalid_reference);
+
+            if (!mNamespaces) {
+                mStack.back()->attributes().emplace(store(name), std::move(decoded));
+
+                return true;
+            }
+
+            const const_pointer_t colon = scanner_t::find(name.begin(), name.end(), ':');
+            const view_t          prefix(name.begin(), colon);
+
+            if (colon == name.end() && !name.equals("xmlns")) {
+                mStack.back()->attributes().emplace(store(name), std::move(decoded), namespace_table_t::no_namespace);
+            } else if (colon == name.end() || prefix.equals("xmlns")) {
+                if (!declare(colon == name.end() ? view_t() : view_t(colon + 1, name.end()), decoded.view()))
+                    return false;
+
+                mStack.back()->attributes().emplace(store(name), std::move(decoded), namespace_table_t::xmlns_namespace);
+            } else {
+                mPrefixed.push_back(prefixed_t { name, std::move(decoded) });
+            }
+
+            return true;
+        }
+
+        //! \brief Close the current element.
+        bool end_element(const view_t& name)
+        {
+            if (mPending && !resolve())
+                return false;
+
+            mStack.pop_back();
+
+            if (mNamespaces)
+                mScope.pop();
+
+            return true;
+        }
+
+        //! \brief Add a text node to the current element.
+        bool text(const view_t& value)
+        {
+            if (mStrip && scanner_t::all_whitespace(value.begin(), value.end())) {
+                if (mPending && !resolve())
+                    return false;
+
+                if (!mStack.back()->preserves_space())
+                    return true;
+            }
+
+            string_ref_t decoded;
+
+            if (!decoder_t::decode(value, decoded, mReference))
+                return fail("invalid character or entity reference", reader_t::invalid_reference);
+
+            mStack.back()->emplace_text_back(std::move(decoded));
+
+            return true;
+        }
+
+        //! \brief Add a CDATA section as a text node to the current element.
+        bool cdata(const view_t& value)
+        {
+            mStack.back()->emplace_text_back(store(value));
+
+            return true;
+        }
+
+        //! \brief Get the built document.
+        /*!
+         *  The document is moved out of the builder, which must not be used
+         *  anymore. Calling this function before the root element has been
+         *  started causes undefined behaviour.
+         *
+         *  \return The built document.
+         */
+        document_t release()
+        {
+            return std::move(*mDocument);
+        }
+
+        //! \brief Get the error found by the builder.
+        /*!
+         *  \return A description of the error, or \c nullptr.
+         */
+        const char* error() const { return mError; }
+
+        //! \brief Get the code of the error found by the builder.
+        /*!
+         *  \return The code of the error, or \c reader_t::no_error.
+         */
+        typename reader_t::error_t error_code() const { return mErrorCode; }
+
+        //! \brief Parse a document without throwing exceptions.
+        /*!
+         *  A malformed document costs no more than the parse itself : the
+         *  error is returned as a code and an offset, without formatting
+         *  any message.
+         *
+         *  \param [in] first     A pointer to the first character of the document.
+         *  \param [in] last      A pointer past the last character of the document.
+         *  \param [in] reference Whether the nodes reference the parsed buffer,
+         *                        which must then outlive the document.
+         *  \param [in] flags     A combination of \c reader_t::flags_t, such as
+         *                        \c reader_t::parse_trusted.
+         *
+         *  \return The parsed document, or the first error found.
+         */
+        static result_t try_parse(const_pointer_t first, const_pointer_t last, bool reference = false, unsigned flags = reader_t::parse_default)
+        {
+            parser_t parser(first, last, flags);
+            basic_builder builder(reference, flags);
+
+            if (parser.parse(builder) != reader_t::end_document)
+                return result_t(builder.error()
+                    ? parse_error_t(builder.error(), builder.error_code(), parser.offset())
+                    : parse_error_t("malformed XML document", parser.error_code(), parser.offset()));
+
+            return result_t(builder.release());
+        }
+
+        //! \brief Parse a document.
+        /*!
+         *  \param [in] first     A pointer to the first character of the document.
+         *  \param [in] last      A pointer past the last character of the document.
+         *  \param [in] reference Whether the nodes reference the parsed buffer,
+         *                        which must then outlive the document.
+         *  \param [in] flags     A combination of \c reader_t::flags_t, such as
+         *                        \c reader_t::parse_trusted.
+         *
+         *  \throw exception_t If the document is not well-formed.
+         *
+         *  \return The parsed document.
+         */
+        static document_t parse(const_pointer_t first, const_pointer_t last, bool reference = false, unsigned flags = reader_t::parse_default)
+        {
+            result_t result = try_parse(first, last, reference, flags);
+
+            if (!result)
+                raise(result.error(), first);
+
+            return std::move(result.value());
+        }
+
+        //! \brief Parse a document.
+        /*!
+         *  \param [in] str The content of the document.
+         *
+         *  \throw exception_t If the document is not well-formed.
+         *
+         *  \return The parsed document.
+         */
+        static document_t parse(const string_t& str)
+        {
+            return parse(str.data(), str.data() + str.size());
+        }
+
+        //! \brief Load a document from a file.
+        /*!
+         *  The file is mapped in memory and becomes the source of the
+         *  document : names, attribute values and texts reference the
+         *  mapped characters, and are only copied when they are modified.
+         *  The file holds characters of type \c charT in native byte order.
+         *
+         *  \param [in] path The path of the file.
+         *
+         *  \throw std::runtime_error If the file cannot be mapped or if the
+         *                            document is not well-formed.
+         *
+         *  \return The loaded document.
+         */
+        static document_t load(const std::string& path)
+        {
+            std::shared_ptr<const mapped_file> file = std::make_shared<const mapped_file>(path);
+
+            const_pointer_t first = static_cast<const_pointer_t>(file->data());
+            const_pointer_t last  = first + file->size() / sizeof(charT);
+
+            result_t result = try_parse(first, last, true);
+
+            if (!result)
+                raise(result.error(), first, file);
+
+            document_t document = std::move(result.value());
+
+            document.source(std::move(file));
+
+            return document;
+        }
+
+        //! \brief Parse a document encoded in UTF-8.
+        /*!
+         *  The input is validated, then converted to \c charT with
+         *  \c utf8::decode() in a buffer that becomes the source of the
+         *  document, and that the nodes reference. With \c char, the input
+         *  is parsed in place. Error offsets are given in bytes for an
+         *  invalid input, and in characters of the converted buffer for a
+         *  malformed document.
+         *
+         *  \param [in] first     A pointer to the first byte of the document.
+         *  \param [in] last      A pointer past the last byte of the document.
+         *  \param [in] reference Whether the nodes of a \c char document
+         *                        reference the input, which must then outlive
+         *                        the document.
+         *
+         *  \throw std::runtime_error If the input is not valid UTF-8 or if the
+         *                            document is not well-formed.
+         *
+         *  \return The parsed document.
+         */
+        static document_t parse_utf8(const char* first, const char* last, bool reference = false)
+        {
+            return parseUtf8(first, last, reference, nullptr);
+        }
+
+        //! \brief Load a document from a file encoded in UTF-8.
+        /*!
+         *  The file is mapped in memory. With \c char, it becomes the source
+         *  of the document as with \c load(). Otherwise, it is converted
+         *  with \c parse_utf8() and released.
+         *
+         *  \param [in] path The path of the file.
+         *
+         *  \throw std::runtime_error If the file cannot be mapped, if it is not
+         *                            valid UTF-8 or if the document is not
+         *                            well-formed.
+         *
+         *  \return The loaded document.
+         */
+        static document_t load_utf8(const std::string& path)
+        {
+            std::shared_ptr<const mapped_file> file = std::make_shared<const mapped_file>(path);
+
+            const char* first = static_cast<const char*>(file->data());
+
+            document_t document = parseUtf8(first, first + file->size(), true, file);
+
+            if (sizeof(charT) == 1)
+                document.source(std::move(file));
+
+            return document;
+        }
+
+    private:
+        //! \brief Parse a document encoded in UTF-8.
+        /*!
+         *  \param [in] first     A pointer to the first byte of the document.
+         *  \param [in] last      A pointer past the last byte of the document.
+         *  \param [in] reference Whether the nodes of a \c char document
+         *                        reference the input.
+         *  \param [in] source    The owner of the input, given to the
+         *                        exceptions thrown for a \c char document,
+         *                        or \c nullptr.
+         *
+         *  \throw exception_t If the input is not valid UTF-8 or if the
+         *                     document is not well-formed.
+         *
+         *  \return The parsed document.
+         */
+        static document_t parseUtf8(const char* first, const char* last, bool reference, std::shared_ptr<const void> source)
+        {
+            const char* invalid = utf8::validate(first, last);
+
+            if (invalid != last)
+                raise(parse_error_t("invalid UTF-8 document", reader_t::invalid_encoding, invalid - first),
+                    sizeof(charT) == 1 ? reinterpret_cast<const_pointer_t>(first) : nullptr, sizeof(charT) == 1 ? source : nullptr);
+
+            if (sizeof(charT) == 1) {
+                const_pointer_t begin = reinterpret_cast<const_pointer_t>(first);
+
+                result_t result = try_parse(begin, reinterpret_cast<const_pointer_t>(last), reference);
+
+                if (!result)
+                    raise(result.error(), begin, std::move(source));
+
+                return std::move(result.value());
+            }
+
+            std::shared_ptr<string_t> buffer = std::make_shared<string_t>(last - first, charT());
+
+            buffer->resize(utf8::decode(first, last, &(*buffer)[0]) - buffer->data());
+
+            result_t result = try_parse(buffer->data(), buffer->data() + buffer->size(), true);
+
+            if (!result)
+                raise(result.error(), buffer->data(), buffer);
+
+            document_t document = std::move(result.value());
+
+            document.source(std::move(buffer));
+
+            return document;
+        }
+
+        //! \brief Store a name or a value in a node.
+        /*!
+         *  \param [in] view The characters to store.
+         *
+         *  \return A string referencing \c view, or a copy of it.
+         */
+        string_ref_t store(const view_t& view) const
+        {
+            return mReference ? string_ref_t(view) : string_ref_t(view.str());
+        }
+
+        //! \brief Bind a prefix declared by an attribute of the current element.
+        /*!
+         *  \param [in] prefix The declared prefix, or an empty view for the
+         *                     default namespace.
+         *  \param [in] uri    The namespace URI.
+         *
+         *  \return \c false if the declaration is forbidden.
+         */
+        bool declare(const view_t& prefix, const view_t& uri)
+        {
+            const namespace_id_t id = mDocument->namespaces().intern(uri);
+
+            if (prefix.equals("xmlns") || (!prefix.empty() && uri.empty()) ||
+                id == namespace_table_t::xmlns_namespace ||
+                prefix.equals("xml") != (id == namespace_table_t::xml_namespace))
+                return fail("invalid namespace declaration", reader_t::invalid_namespace);
+
+            mScope.bind(prefix, id);
+
+            return true;
+        }
+
+        //! \brief Resolve the namespaces of the current element and of its attributes.
+        /*!
+         *  This is done once the start tag has been read, since the
+         *  namespace declarations may follow the attributes that use them.
+         *
+         *  \return \c false if a prefix is not bound, or if two attributes
+         *          have the same namespace and local name.
+         */
+        bool resolve()
+        {
+            element_t& element = *mStack.back();
+
+            mPending = false;
+
+            const namespace_id_t id = lookup(element.name().view());
+
+            if (id == namespace_table_t::npos || id == namespace_table_t::xmlns_namespace)
+                return fail("unbound namespace prefix", reader_t::invalid_namespace);
+
+            element.namespace_id() = id;
+
+            if (mPrefixed.empty())
+                return true;
+
+            mExpanded.clear();
+
+            for (prefixed_t& attribute : mPrefixed) {
+                const namespace_id_t ns = lookup(attribute.name);
+
+                if (ns == namespace_table_t::npos)
+                    return fail("unbound namespace prefix", reader_t::invalid_namespace);
+
+                element.attributes().emplace(store(attribute.name), std::move(attribute.value), ns);
+                mExpanded.emplace_back(ns, view_t(scanner_t::find(attribute.name.begin(), attribute.name.end(), ':') + 1, attribute.name.end()));
+            }
+
+            mPrefixed.clear();
+
+            if (mExpanded.size() == 1)
+                return true;
+
+            std::sort(mExpanded.begin(), mExpanded.end());
+
+            if (std::adjacent_find(mExpanded.begin(), mExpanded.end()) != mExpanded.end())
+                return fail("duplicate namespaced attribute", reader_t::invalid_namespace);
+
+            return true;
+        }
+
+        //! \brief Find the namespace bound to the prefix of a name.
+        /*!
+         *  \param [in] name A qualified name.
+         *
+         *  \return The identifier of the namespace, or
+         *          \c namespace_table_t::npos if the prefix is not bound.
+         */
+        namespace_id_t lookup(const view_t& name) const
+        {
+            const const_pointer_t colon = scanner_t::find(name.begin(), name.end(), ':');
+
+            return mScope.find(colon != name.end() ? view_t(name.begin(), colon) : view_t());
+        }
+
+        //! \brief Record an error and stop parsing.
+        /*!
+         *  \param [in] what A description of the error.
+         *  \param [in] code The code of the error.
+         *
+         *  \return \c false.
+         */
+        bool fail(const char* what, typename reader_t::error_t code)
+        {
+            mError     = what;
+            mErrorCode = code;
+
+            return false;
+        }
+
+        //! \brief Throw an exception describing a parse error.
+        /*!
+         *  Without exception support, the program is aborted : only
+         *  \c try_parse() reports errors then.
+         *
+         *  \param [in] error  The parse error.
+         *  \param [in] first  A pointer to the first character of the parsed
+         *                     document, or \c nullptr.
+         *  \param [in] source The owner of the parsed document, or \c nullptr.
+         *
+         *  \throw exception_t Always.
+         */
+        static void raise(const parse_error_t& error, const_pointer_t first, std::shared_ptr<const void> source = nullptr)
+        {
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS)
+            throw exception_t(error, first, std::move(source));
+#else
+            (void) error;
+            (void) first;
+            (void) source;
+            std::abort();
+#endif
+        }
+
+        std::unique_ptr<document_t> mDocument; //!< The document being built.
+
+        std::vector<element_pointer_t> mStack; //!< The elements currently open.
+
+        //! \brief A prefixed attribute waiting for the end of its start tag.
+        class prefixed_t {
+        public:
+            view_t       name;  //!< The qualified name of the attribute.
+            string_ref_t value; //!< The decoded value of the attribute.
+        };
+
+        namespace_scope_t                               mScope;    //!< The prefixes in scope.
+        std::vector<prefixed_t>                         mPrefixed; //!< The prefixed attributes of the current start tag.
+        std::vector<std::pair<namespace_id_t, view_t> > mExpanded; //!< The expanded names of these attributes.
+
+        version_t    mVersion;    //!< The version found in the XML declaration.
+        encoding_t   mEncoding;   //!< The encoding found in the XML declaration.
+        standalone_t mStandalone; //!< The standalone status found in the XML declaration.
+
+        const char*                mError;     //!< A description of the error found by the builder.
+        typename reader_t::error_t mErrorCode; //!< The code of the error found by the builder.
+
+        bool mReference;  //!< Whether the nodes reference the parsed buffer.
+        bool mNamespaces; //!< Whether namespace prefixes are resolved.
+        bool mStrip;      //!< Whether the texts made of white spaces are dropped.
+        bool mPending;    //!< Whether the current start tag has not been resolved yet.
+    };
+
+    typedef basic_builder<char>    builder;  //!< A specialized \c basic_builder for char.
+    typedef basic_builder<wchar_t> wbuilder; //!< A specialized \c basic_builder for wchar_t.
+}
+
+#endif /* BUILDER_H_INCLUDED */
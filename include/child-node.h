@@ -143,6 +143,30 @@ namespace xml {
          */
         parent_reference_t parent() { return *mParent; }
 
+        //! \brief Whether the node has a parent.
+        /*!
+         *  A node that has been built on its own, such as a fragment
+         *  returned by a streaming reader, has no parent until it is
+         *  inserted in another node.
+         *
+         *  \return \c true if \c parent() can be called.
+         */
+        bool has_parent() const { return mParent != nullptr; }
+
+        //! \brief Get the next sibling of the node.
+        /*!
+         *  \return A pointer to the next sibling, or \c nullptr if the node
+         *          is the last child of its parent.
+         */
+        const child_t* next_sibling() const { return mNext; }
+
+        //! \brief Get the previous sibling of the node.
+        /*!
+         *  \return A pointer to the previous sibling, or \c nullptr if the
+         *          node is the first child of its parent.
+         */
+        const child_t* previous_sibling() const { return mPrevious; }
+
     protected:
         parent_pointer_t mParent;  //!< A pointer to the current node's parent
 
@@ -2,15 +2,19 @@
 #define DOCUMENT_H_INCLUDED
 
 #include <string>
+#include <memory>
+#include <cstdint>
 
 #include <parent-node.h>
 #include <element.h>
+#include <attribute-index.h>
 
 namespace xml {
     //! \brief A XML document.
     /*!
      *  This class represents a XML document. It can have a version,
      *  encoding and a standalone status. It has a mandatory root element.
+     *  It owns the table interning the namespaces of its nodes.
      *
      *  \sa xml::basic_parent_node
      *
@@ -40,7 +44,12 @@ namespace xml {
         typedef const document_t&     document_const_reference_t; //!< Constant reference to \c document_t.
         typedef document_t&&          document_move_t;            //!< Move a \c document_t.
 
-        typedef std::basic_string<charT> string_t; //!< The string type.
+        typedef          std::basic_string<charT> string_t;     //!< The string type.
+        typedef typename root_t::string_ref_t     string_ref_t; //!< The type of string stored in nodes.
+
+        typedef basic_namespace_table<charT> namespace_table_t; //!< The namespace table type.
+
+        typedef basic_attribute_index<charT> attribute_index_t; //!< The attribute index type.
 
         //!@}
 
@@ -90,15 +99,18 @@ namespace xml {
          *
          *  \param[in] root_name The name of the root element.
          */
-        basic_document(const string_t& root_name)
+        basic_document(string_ref_t root_name)
         :
             parent_t(),
             mVersion(),
             mEncoding(),
             mStandalone(),
-            mRoot(nullptr)
+            mNamespaces(),
+            mRoot(nullptr),
+            mSource(),
+            mIndex()
         {
-            parent_t::template emplace_front<root_t>(root_name);
+            parent_t::template emplace_front<root_t>(std::move(root_name));
 
             mRoot = &(*parent_t::template begin<root_t>());
         }
@@ -116,7 +128,10 @@ namespace xml {
             mVersion(),
             mEncoding(),
             mStandalone(),
-            mRoot(nullptr)
+            mNamespaces(),
+            mRoot(nullptr),
+            mSource(),
+            mIndex()
         {
             parent_t::push_front(root);
 
@@ -136,7 +151,10 @@ namespace xml {
             mVersion(),
             mEncoding(),
             mStandalone(),
-            mRoot(nullptr)
+            mNamespaces(),
+            mRoot(nullptr),
+            mSource(),
+            mIndex()
         {
             parent_t::push_front(std::move(root));
 
@@ -155,9 +173,14 @@ namespace xml {
             mVersion(rhs.mVersion),
             mEncoding(rhs.mEncoding),
             mStandalone(rhs.mStandalone),
-            mRoot(nullptr)
+            mNamespaces(rhs.mNamespaces),
+            mRoot(nullptr),
+            mSource(),
+            mIndex()
         {
             mRoot = &(*parent_t::template begin<root_t>());
+
+            index_attributes(rhs.indexes_attributes());
         }
 
         //! \brief Move constructor.
@@ -172,7 +195,10 @@ namespace xml {
             mVersion(rhs.mVersion),
             mEncoding(rhs.mEncoding),
             mStandalone(rhs.mStandalone),
-            mRoot(rhs.mRoot)
+            mNamespaces(std::move(rhs.mNamespaces)),
+            mRoot(rhs.mRoot),
+            mSource(std::move(rhs.mSource)),
+            mIndex(std::move(rhs.mIndex))
         {}
 
         //! \brief Destructor.
@@ -193,6 +219,15 @@ namespace xml {
             return node_interface_t::stringToType("document");
         }
 
+        //! \brief Get the kind of a \c document_t.
+        /*!
+         *  \return \c node_interface_t::document_kind.
+         */
+        virtual typename node_interface_t::kind_t kind() const
+        {
+            return node_interface_t::document_kind;
+        }
+
         //! \brief Get a constant reference to the root element of this XML document.
         /*!
          *  This function returns a constant reference to the root element of
@@ -211,12 +246,133 @@ namespace xml {
          */
         root_reference_t root() { return *mRoot; }
 
+        //! \brief Get the XML version of this document.
+        /*!
+         *  \return A constant reference to the XML version of this document.
+         */
+        const version_t& version() const { return mVersion; }
+
+        //! \brief Get the XML version of this document.
+        /*!
+         *  \return A reference to the XML version of this document.
+         */
+        version_t& version() { return mVersion; }
+
+        //! \brief Get the encoding of this document.
+        /*!
+         *  \return A constant reference to the encoding of this document.
+         */
+        const encoding_t& encoding() const { return mEncoding; }
+
+        //! \brief Get the encoding of this document.
+        /*!
+         *  \return A reference to the encoding of this document.
+         */
+        encoding_t& encoding() { return mEncoding; }
+
+        //! \brief Get the standalone status of this document.
+        /*!
+         *  \return A constant reference to the standalone status of this document.
+         */
+        const standalone_t& standalone() const { return mStandalone; }
+
+        //! \brief Get the standalone status of this document.
+        /*!
+         *  \return A reference to the standalone status of this document.
+         */
+        standalone_t& standalone() { return mStandalone; }
+
+        //! \brief Get the namespaces of this document.
+        /*!
+         *  \return A constant reference to the table interning the
+         *          namespaces of the nodes of this document.
+         */
+        const namespace_table_t& namespaces() const { return mNamespaces; }
+
+        //! \brief Get the namespaces of this document.
+        /*!
+         *  \return A reference to the table interning the namespaces of the
+         *          nodes of this document.
+         */
+        namespace_table_t& namespaces() { return mNamespaces; }
+
+        //! \brief Get the source of this document.
+        /*!
+         *  The source is the buffer the names and values of the nodes may
+         *  reference, such as a \c mapped_file. A copy of the document owns
+         *  all its strings and has no source.
+         *
+         *  \return The source of this document, or an empty pointer.
+         */
+        const std::shared_ptr<const void>& source() const { return mSource; }
+
+        //! \brief Set the source of this document.
+        /*!
+         *  \param [in] source The buffer referenced by the nodes, kept alive
+         *                     as long as this document.
+         */
+        void source(std::shared_ptr<const void> source) { mSource = std::move(source); }
+
+        //! \brief Enable or disable the attribute index of this document.
+        /*!
+         *  The index maps each attribute name and value to the elements
+         *  carrying it. It is built on first use, dropped whenever the
+         *  children or the attributes of a node of the document are
+         *  modified, and used by XPath expressions to select the
+         *  elements of predicates such as \c [@id='123'] without walking
+         *  the whole tree. A copy of the document has an index if this
+         *  document has one.
+         *
+         *  \param [in] enable Whether the document has an index.
+         */
+        void index_attributes(bool enable = true)
+        {
+            if (!enable)
+                mIndex.reset();
+            else if (mIndex == nullptr)
+                mIndex.reset(new attribute_index_t());
+        }
+
+        //! \brief Whether the document has an attribute index.
+        bool indexes_attributes() const { return mIndex != nullptr; }
+
+        //! \brief Get the attribute index of this document.
+        /*!
+         *  The index is built if it is not already. Several threads may
+         *  call this function on the same document.
+         *
+         *  \return The index, or \c nullptr if the document has none.
+         */
+        const attribute_index_t* attribute_index() const
+        {
+            if (mIndex == nullptr)
+                return nullptr;
+
+            mIndex->build(root());
+
+            return mIndex.get();
+        }
+
+    protected:
+        //! \brief Drop the attribute index after a modification.
+        virtual void modified()
+        {
+            if (mIndex != nullptr)
+                mIndex->invalidate();
+        }
+
     private:
         version_t    mVersion;    //!< The XML version of this document.
         encoding_t   mEncoding;   //!< The encoding version of this document.
         standalone_t mStandalone; //!< Whether this XML document is a standalone.
 
+        namespace_table_t mNamespaces; //!< The namespaces of the nodes of this document.
+
         root_pointer_t mRoot; //!< A pointer to the root element of this document.
+
+        std::shared_ptr<const void> mSource; //!< The buffer referenced by the nodes.
+
+        std::unique_ptr<attribute_index_t> mIndex; //!< The attribute index, if enabled.
     };
 
     typedef basic_document<char>    document;  //!< A specialized \c basic_document for char.
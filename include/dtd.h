@@ -0,0 +1,1224 @@
+#ifndef DTD_H_INCLUDED
+#define DTD_H_INCLUDED
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <reader.h>
+#include <exception.h>
+#include <expected.h>
+#include <entity-decoder.h>
+#include <document.h>
+
+namespace xml {
+    //! \brief A compiled document type definition.
+    /*!
+     *  This class reads the markup declarations of a DTD, such as an
+     *  external subset, and compiles them once : element names are
+     *  interned, and each element content model is turned into a
+     *  deterministic automaton over the interned names. Validating the
+     *  children of an element is then a single walk over its sibling list,
+     *  following one transition per child.
+     *
+     *  A compiled DTD is immutable and only handed out through a
+     *  \c std::shared_ptr to a constant object : it can be cached, and
+     *  shared by threads validating documents concurrently.
+     *
+     *  Element, attribute list, entity and notation declarations,
+     *  comments and processing instructions are read. Entity and notation
+     *  declarations are skipped ; parameter entity references and
+     *  conditional sections are not supported. Attribute defaults are
+     *  checked, but not added to the validated documents.
+     *
+     *  \sa xml::basic_document
+     *
+     *  \tparam charT The type of character used in the DTD.
+     *                By default, char and wchar_t are supported.
+     */
+    template <typename charT>
+    class basic_dtd {
+    public:
+        //! \name Member types
+        //!@{
+        typedef          basic_reader<charT>         reader_t;        //!< The reader type, whose error codes are used.
+        typedef typename reader_t::scanner_t         scanner_t;       //!< The scanner type.
+        typedef typename reader_t::view_t            view_t;          //!< The type of names and values.
+        typedef typename reader_t::const_pointer_t   const_pointer_t; //!< Pointer to a constant character.
+        typedef          basic_entity_decoder<charT> decoder_t;       //!< The reference decoder type.
+
+        typedef          basic_document<charT>       document_t;       //!< The document type.
+        typedef          basic_element<charT>        element_t;        //!< The element type.
+        typedef          basic_text<charT>           text_t;           //!< The text type.
+        typedef typename element_t::string_t         string_t;         //!< The string type.
+        typedef typename element_t::string_ref_t     string_ref_t;     //!< The type of string stored in nodes.
+        typedef typename element_t::node_interface_t node_interface_t; //!< The base type of nodes.
+
+        typedef basic_dtd<charT>                       dtd_t;         //!< The DTD type.
+        typedef std::shared_ptr<const dtd_t>           dtd_pointer_t; //!< A shared pointer to a compiled DTD.
+        typedef basic_parse_error<charT>               parse_error_t; //!< The parse error type.
+        typedef basic_exception<charT>                 exception_t;   //!< The type of exception thrown on parse errors.
+        typedef expected<dtd_pointer_t, parse_error_t> result_t;      //!< The result of a compilation that does not throw.
+
+        //!@}
+
+        //! The validity errors.
+        enum error_t {
+            undeclared_element,      //!< An element is not declared.
+            invalid_content,         //!< The children of an element do not match its content model.
+            undeclared_attribute,    //!< An attribute is not declared for its element.
+            missing_attribute,       //!< A required attribute is missing.
+            invalid_attribute_value, //!< An attribute value does not match its type or its fixed value.
+            duplicate_id,            //!< An \c ID value is used twice.
+            unknown_idref            //!< An \c IDREF value does not match any \c ID.
+        };
+
+        //! \brief A validity error.
+        class violation_t {
+        public:
+            error_t          code;    //!< The error.
+            const element_t* element; //!< The invalid element.
+            view_t           name;    //!< The name of the invalid attribute, if any.
+        };
+
+        typedef std::vector<violation_t> violations_t; //!< A list of validity errors.
+
+        basic_dtd(const basic_dtd&) = delete;
+        basic_dtd& operator=(const basic_dtd&) = delete;
+
+        //! \brief Compile a DTD without throwing exceptions.
+        /*!
+         *  The declarations are copied, so that the input does not need to
+         *  outlive the compiled DTD.
+         *
+         *  \param [in] first A pointer to the first character of the declarations.
+         *  \param [in] last  A pointer past the last character of the declarations.
+         *
+         *  \return The compiled DTD, or the first error found, with an
+         *          \c invalid_doctype or \c unexpected_end code.
+         */
+        static result_t try_compile(const_pointer_t first, const_pointer_t last)
+        {
+            std::shared_ptr<dtd_t> dtd(new dtd_t(first, last));
+
+            if (!dtd->compile())
+                return result_t(parse_error_t(dtd->mError, dtd->mErrorCode, dtd->mCursor - dtd->mSource.data()));
+
+            return result_t(dtd_pointer_t(std::move(dtd)));
+        }
+
+        //! \brief Compile a DTD.
+        /*!
+         *  \param [in] first A pointer to the first character of the declarations.
+         *  \param [in] last  A pointer past the last character of the declarations.
+         *
+         *  \throw exception_t If the declarations are malformed.
+         *
+         *  \return The compiled DTD.
+         */
+        static dtd_pointer_t compile(const_pointer_t first, const_pointer_t last)
+        {
+            result_t result = try_compile(first, last);
+
+            if (!result)
+                throw exception_t(result.error(), first);
+
+            return std::move(result.value());
+        }
+
+        //! \brief Compile a DTD.
+        /*!
+         *  \param [in] str The declarations.
+         *
+         *  \throw exception_t If the declarations are malformed.
+         *
+         *  \return The compiled DTD.
+         */
+        static dtd_pointer_t compile(const string_t& str)
+        {
+            return compile(str.data(), str.data() + str.size());
+        }
+
+        //! \brief Whether an element is declared.
+        /*!
+         *  \param [in] name The name of the element.
+         *
+         *  \return \c true if the DTD declares the element.
+         */
+        bool declares(const view_t& name) const
+        {
+            typename symbols_t::const_iterator it = mSymbols.find(name);
+
+            return it != mSymbols.end() && mElements[it->second].content != content_undeclared;
+        }
+
+        //! \brief Validate a subtree.
+        /*!
+         *  The tree is walked iteratively, so that its depth does not
+         *  matter. When no list of violations is given, the validation
+         *  stops at the first error.
+         *
+         *  \param [in]  root       The root of the subtree.
+         *  \param [out] violations The list the validity errors are
+         *                          appended to, or \c nullptr.
+         *
+         *  \return \c true if the subtree is valid.
+         */
+        bool validate(const element_t& root, violations_t* violations = nullptr) const
+        {
+            context_t context(violations);
+
+            context.stack.push_back(entry_t { &root, symbol(root.name().view()) });
+
+            while (!context.stack.empty()) {
+                const entry_t entry = context.stack.back();
+
+                context.stack.pop_back();
+
+                if (!check(entry, context))
+                    return false;
+            }
+
+            for (const reference_t& reference : context.references)
+                if (context.ids.count(reference.value) == 0 &&
+                    !context.report(unknown_idref, reference.element, reference.name))
+                    return false;
+
+            return context.valid;
+        }
+
+        //! \brief Validate a document.
+        /*!
+         *  \param [in]  document   The document.
+         *  \param [out] violations The list the validity errors are
+         *                          appended to, or \c nullptr.
+         *
+         *  \return \c true if the document is valid.
+         */
+        bool validate(const document_t& document, violations_t* violations = nullptr) const
+        {
+            return validate(document.root(), violations);
+        }
+
+    private:
+        typedef uint32_t symbol_t; //!< The type of interned element names.
+
+        enum : symbol_t { no_symbol = symbol_t(-1) }; //!< The symbol of names that do not appear in the DTD.
+
+        //! The content types of elements.
+        enum content_t {
+            content_undeclared, //!< The element only appears in other declarations.
+            content_empty,      //!< \c EMPTY : no content.
+            content_any,        //!< \c ANY : any declared element and text.
+            content_mixed,      //!< Text and some elements, in any order.
+            content_children    //!< Elements matching a content model.
+        };
+
+        //! The types of attributes.
+        enum type_t {
+            type_cdata,       //!< \c CDATA : any string.
+            type_id,          //!< \c ID : a name unique in the document.
+            type_idref,       //!< \c IDREF : the name of an \c ID.
+            type_idrefs,      //!< \c IDREFS : a list of names of \c ID.
+            type_entity,      //!< \c ENTITY : a name.
+            type_entities,    //!< \c ENTITIES : a list of names.
+            type_nmtoken,     //!< \c NMTOKEN : a name token.
+            type_nmtokens,    //!< \c NMTOKENS : a list of name tokens.
+            type_enumeration  //!< An enumeration or a \c NOTATION : one of a list of tokens.
+        };
+
+        //! The default declarations of attributes.
+        enum presence_t {
+            presence_implied,  //!< \c #IMPLIED : optional.
+            presence_required, //!< \c #REQUIRED : mandatory.
+            presence_fixed,    //!< \c #FIXED : optional, with a fixed value.
+            presence_default   //!< Optional, with a default value.
+        };
+
+        //! \brief The declaration of an attribute.
+        class attribute_decl_t {
+        public:
+            view_t     name;     //!< The name of the attribute.
+            type_t     type;     //!< The type of the attribute.
+            presence_t presence; //!< The default declaration of the attribute.
+            string_t   value;    //!< The decoded default value, if any.
+            size_t     first;    //!< The index of the first token of an enumeration.
+            size_t     last;     //!< Past the index of the last token of an enumeration.
+        };
+
+        //! \brief The declaration of an element.
+        class element_decl_t {
+        public:
+            content_t                     content;    //!< The content type of the element.
+            uint32_t                      start;      //!< The initial state of its automaton, if any.
+            std::vector<attribute_decl_t> attributes; //!< Its declared attributes.
+        };
+
+        //! \brief A state of a content model automaton.
+        class state_t {
+        public:
+            uint32_t first;     //!< The index of the first transition leaving this state.
+            uint32_t last;      //!< Past the index of the last transition leaving this state.
+            bool     accepting; //!< Whether the content may end in this state.
+        };
+
+        //! \brief A transition of a content model automaton.
+        class transition_t {
+        public:
+            symbol_t symbol; //!< The name of the child element.
+            uint32_t target; //!< The state reached.
+
+            //! \brief Order transitions by symbol.
+            bool operator<(const transition_t& rhs) const { return symbol < rhs.symbol; }
+        };
+
+        //! The kinds of particles of a content model.
+        enum particle_kind_t {
+            particle_name,     //!< An element name.
+            particle_sequence, //!< A sequence of particles.
+            particle_choice    //!< A choice of particles.
+        };
+
+        //! \brief A particle of a content model being compiled.
+        class particle_t {
+        public:
+            particle_kind_t     kind;       //!< The kind of particle.
+            charT               occurrence; //!< \c '?', \c '*', \c '+', or 0.
+            symbol_t            symbol;     //!< The element name of a \c particle_name.
+            std::vector<size_t> children;   //!< The particles of a group.
+        };
+
+        //! \brief The position sets of a particle, in the Glushkov construction.
+        class positions_t {
+        public:
+            bool                  nullable; //!< Whether the particle matches an empty content.
+            std::vector<uint32_t> first;    //!< The positions that can start the particle.
+            std::vector<uint32_t> last;     //!< The positions that can end the particle.
+        };
+
+        //! \brief An element waiting to be validated.
+        class entry_t {
+        public:
+            const element_t* element; //!< The element.
+            symbol_t         symbol;  //!< The symbol of its name.
+        };
+
+        //! \brief An \c IDREF value, resolved at the end of the validation.
+        class reference_t {
+        public:
+            const element_t* element; //!< The element holding the value.
+            view_t           name;    //!< The name of the attribute.
+            view_t           value;   //!< The referenced \c ID.
+        };
+
+        //! \brief The state of one validation.
+        class context_t {
+        public:
+            //! \brief Constructor.
+            explicit context_t(violations_t* list)
+            :
+                stack(),
+                ids(),
+                references(),
+                seen(),
+                violations(list),
+                valid(true)
+            {}
+
+            //! \brief Record a validity error.
+            /*!
+             *  \return \c true if the validation goes on.
+             */
+            bool report(error_t code, const element_t* element, const view_t& name = view_t())
+            {
+                valid = false;
+
+                if (violations == nullptr)
+                    return false;
+
+                violations->push_back(violation_t { code, element, name });
+
+                return true;
+            }
+
+            std::vector<entry_t>                                stack;      //!< The elements left to validate.
+            std::unordered_set<view_t, typename view_t::hash_t> ids;        //!< The \c ID values found.
+            std::vector<reference_t>                            references; //!< The \c IDREF values found.
+            std::vector<char>                                   seen;       //!< The declared attributes found on the current element.
+            violations_t*                                       violations; //!< The list of errors, or \c nullptr.
+            bool                                                valid;      //!< Whether no error has been found.
+        };
+
+        typedef std::unordered_map<view_t, symbol_t, typename view_t::hash_t> symbols_t; //!< The type of the symbol table.
+
+        //! \brief Constructor.
+        /*!
+         *  \param [in] first A pointer to the first character of the declarations.
+         *  \param [in] last  A pointer past the last character of the declarations.
+         */
+        basic_dtd(const_pointer_t first, const_pointer_t last)
+        :
+            mSource(first, last),
+            mSymbols(),
+            mElements(),
+            mStates(),
+            mTransitions(),
+            mTokens(),
+            mCursor(mSource.data()),
+            mEnd(mSource.data() + mSource.size()),
+            mError(nullptr),
+            mErrorCode(reader_t::no_error)
+        {}
+
+        //! \brief Get the symbol of an element name.
+        /*!
+         *  \return The symbol, or \c no_symbol if the name does not appear
+         *          in the DTD.
+         */
+        symbol_t symbol(const view_t& name) const
+        {
+            typename symbols_t::const_iterator it = mSymbols.find(name);
+
+            return it != mSymbols.end() ? it->second : no_symbol;
+        }
+
+        //! \brief Validate an element, and schedule its children.
+        /*!
+         *  \return \c false if the validation stops.
+         */
+        bool check(const entry_t& entry, context_t& context) const
+        {
+            const element_t& element = *entry.element;
+            const element_decl_t* decl = entry.symbol != no_symbol ? &mElements[entry.symbol] : nullptr;
+
+            if (decl != nullptr && decl->content == content_undeclared)
+                decl = nullptr;
+
+            if (decl == nullptr && !context.report(undeclared_element, &element))
+                return false;
+
+            if (decl != nullptr && !checkAttributes(element, *decl, context))
+                return false;
+
+            const content_t content = decl != nullptr ? decl->content : content_any;
+            const size_t    mark    = context.stack.size();
+            uint32_t        state   = decl != nullptr ? decl->start : 0;
+            bool            matched = true;
+
+            for (auto it = element.begin(); it != element.end(); ++it) {
+                const typename node_interface_t::kind_t kind = it->kind();
+
+                if (kind == node_interface_t::element_kind) {
+                    const element_t& child  = static_cast<const element_t&>(*it);
+                    const symbol_t   symbol = this->symbol(child.name().view());
+
+                    context.stack.push_back(entry_t { &child, symbol });
+
+                    if (matched && content == content_empty)
+                        matched = false;
+                    else if (matched && content != content_any)
+                        matched = advance(state, symbol);
+                } else if (kind == node_interface_t::text_kind && matched) {
+                    const string_ref_t& data = static_cast<const text_t&>(*it).data();
+
+                    if (content == content_empty ||
+                        (content == content_children && !scanner_t::all_whitespace(data.begin(), data.end())))
+                        matched = false;
+                }
+            }
+
+            if (matched && content == content_children && !mStates[state].accepting)
+                matched = false;
+
+            if (!matched && !context.report(invalid_content, &element))
+                return false;
+
+            std::reverse(context.stack.begin() + mark, context.stack.end());
+
+            return true;
+        }
+
+        //! \brief Follow the transition of a child element.
+        /*!
+         *  \param [in,out] state  The current state, updated.
+         *  \param [in]     symbol The symbol of the child.
+         *
+         *  \return \c false if the child is not allowed.
+         */
+        bool advance(uint32_t& state, symbol_t symbol) const
+        {
+            const transition_t* first = mTransitions.data() + mStates[state].first;
+            const transition_t* last  = mTransitions.data() + mStates[state].last;
+            const transition_t* found = std::lower_bound(first, last, transition_t { symbol, 0 });
+
+            if (found == last || found->symbol != symbol)
+                return false;
+
+            state = found->target;
+
+            return true;
+        }
+
+        //! \brief Validate the attributes of an element.
+        /*!
+         *  \return \c false if the validation stops.
+         */
+        bool checkAttributes(const element_t& element, const element_decl_t& decl, context_t& context) const
+        {
+            context.seen.assign(decl.attributes.size(), 0);
+
+            for (const typename element_t::attribute_t& attribute : element.attributes()) {
+                const view_t name = attribute.name().view();
+                size_t i = 0;
+
+                while (i != decl.attributes.size() && decl.attributes[i].name != name)
+                    ++i;
+
+                if (i == decl.attributes.size()) {
+                    if (!context.report(undeclared_attribute, &element, name))
+                        return false;
+
+                    continue;
+                }
+
+                context.seen[i] = 1;
+
+                if (!checkValue(decl.attributes[i], attribute.value().view(), element, context))
+                    return false;
+            }
+
+            for (size_t i = 0; i != decl.attributes.size(); ++i)
+                if (!context.seen[i] && decl.attributes[i].presence == presence_required &&
+                    !context.report(missing_attribute, &element, decl.attributes[i].name))
+                    return false;
+
+            return true;
+        }
+
+        //! \brief Validate an attribute value.
+        /*!
+         *  \return \c false if the validation stops.
+         */
+        bool checkValue(const attribute_decl_t& decl, const view_t& value, const element_t& element, context_t& context) const
+        {
+            bool valid = decl.presence != presence_fixed || value == view_t(decl.value);
+
+            const_pointer_t first = scanner_t::skip_whitespace(value.begin(), value.end());
+            const_pointer_t last  = value.end();
+
+            while (last != first && scanner_t::is_whitespace(last[-1]))
+                --last;
+
+            switch (decl.type) {
+            case type_cdata:
+                break;
+
+            case type_id:
+                if (!isName(first, last))
+                    valid = false;
+                else if (!context.ids.insert(view_t(first, last)).second && !context.report(duplicate_id, &element, decl.name))
+                    return false;
+                break;
+
+            case type_idref:
+            case type_idrefs:
+            case type_entity:
+            case type_entities:
+            case type_nmtoken:
+            case type_nmtokens: {
+                const bool list = decl.type == type_idrefs || decl.type == type_entities || decl.type == type_nmtokens;
+                size_t count = 0;
+
+                while (first != last) {
+                    const_pointer_t end = first;
+
+                    while (end != last && !scanner_t::is_whitespace(*end))
+                        ++end;
+
+                    if (decl.type == type_nmtoken || decl.type == type_nmtokens ? !isNmtoken(first, end) : !isName(first, end))
+                        valid = false;
+                    else if (decl.type == type_idref || decl.type == type_idrefs)
+                        context.references.push_back(reference_t { &element, decl.name, view_t(first, end) });
+
+                    ++count;
+                    first = scanner_t::skip_whitespace(end, last);
+                }
+
+                if (count == 0 || (count > 1 && !list))
+                    valid = false;
+                break;
+            }
+
+            case type_enumeration:
+                valid = valid && std::find(mTokens.begin() + decl.first, mTokens.begin() + decl.last, view_t(first, last)) != mTokens.begin() + decl.last;
+                break;
+            }
+
+            return valid || context.report(invalid_attribute_value, &element, decl.name);
+        }
+
+        //! \brief Whether some characters are a name.
+        static bool isName(const_pointer_t first, const_pointer_t last)
+        {
+            return first != last && scanner_t::is_name_start(*first) && scanner_t::find_name_end(first, last) == last;
+        }
+
+        //! \brief Whether some characters are a name token.
+        static bool isNmtoken(const_pointer_t first, const_pointer_t last)
+        {
+            return first != last && scanner_t::find_name_end(first, last) == last;
+        }
+
+        //! \brief Read all the declarations.
+        /*!
+         *  \return \c false if they are malformed.
+         */
+        bool compile()
+        {
+            for (;;) {
+                mCursor = scanner_t::skip_whitespace(mCursor, mEnd);
+
+                if (mCursor == mEnd)
+                    return true;
+
+                bool read;
+
+                if (matches("<!--"))
+                    read = skip(4, "-->");
+                else if (matches("<?"))
+                    read = skip(2, "?>");
+                else if (matches("<!ELEMENT"))
+                    read = readElement();
+                else if (matches("<!ATTLIST"))
+                    read = readAttributeList();
+                else if (matches("<!ENTITY") || matches("<!NOTATION"))
+                    read = skipDeclaration();
+                else
+                    read = fail("invalid markup declaration");
+
+                if (!read)
+                    return false;
+            }
+        }
+
+        //! \brief Whether the next characters match an ASCII string.
+        bool matches(const char* str) const
+        {
+            const_pointer_t cursor = mCursor;
+
+            for (; *str != '\0'; ++str, ++cursor)
+                if (cursor == mEnd || *cursor != static_cast<charT>(*str))
+                    return false;
+
+            return true;
+        }
+
+        //! \brief Whether the next characters are a keyword followed by a delimiter.
+        bool keyword(const char* str)
+        {
+            size_t size = 0;
+
+            while (str[size] != '\0')
+                ++size;
+
+            if (!matches(str) || (mCursor + size != mEnd && scanner_t::is_name_char(mCursor[size])))
+                return false;
+
+            mCursor += size;
+
+            return true;
+        }
+
+        //! \brief Skip a comment or a processing instruction.
+        bool skip(size_t size, const char* end)
+        {
+            for (mCursor += size; mCursor != mEnd; ++mCursor)
+                if (matches(end)) {
+                    while (*end++ != '\0')
+                        ++mCursor;
+
+                    return true;
+                }
+
+            return fail("unexpected end of DTD", reader_t::unexpected_end);
+        }
+
+        //! \brief Skip a declaration up to its closing \c '>'.
+        bool skipDeclaration()
+        {
+            for (mCursor += 2; mCursor != mEnd; ++mCursor) {
+                if (*mCursor == '"' || *mCursor == '\'') {
+                    mCursor = scanner_t::find(mCursor + 1, mEnd, *mCursor);
+
+                    if (mCursor == mEnd)
+                        break;
+                } else if (*mCursor == '>') {
+                    ++mCursor;
+
+                    return true;
+                }
+            }
+
+            return fail("unexpected end of DTD", reader_t::unexpected_end);
+        }
+
+        //! \brief Skip mandatory white spaces.
+        bool space()
+        {
+            const_pointer_t cursor = scanner_t::skip_whitespace(mCursor, mEnd);
+
+            if (cursor == mCursor)
+                return fail(cursor == mEnd ? "unexpected end of DTD" : "missing white space",
+                    cursor == mEnd ? reader_t::unexpected_end : reader_t::invalid_doctype);
+
+            mCursor = cursor;
+
+            return true;
+        }
+
+        //! \brief Read a name or a name token.
+        /*!
+         *  \param [out] name  The name read.
+         *  \param [in]  token Whether a name token is expected.
+         *
+         *  \return \c false if there is no name.
+         */
+        bool readName(view_t& name, bool token = false)
+        {
+            if (mCursor == mEnd)
+                return fail("unexpected end of DTD", reader_t::unexpected_end);
+
+            if (!token && !scanner_t::is_name_start(*mCursor))
+                return fail("invalid name", reader_t::invalid_doctype);
+
+            const_pointer_t last = scanner_t::find_name_end(mCursor, mEnd);
+
+            if (last == mCursor)
+                return fail("invalid name token", reader_t::invalid_doctype);
+
+            name    = view_t(mCursor, last);
+            mCursor = last;
+
+            return true;
+        }
+
+        //! \brief Read the closing \c '>' of a declaration.
+        bool close()
+        {
+            mCursor = scanner_t::skip_whitespace(mCursor, mEnd);
+
+            if (mCursor == mEnd)
+                return fail("unexpected end of DTD", reader_t::unexpected_end);
+
+            if (*mCursor != '>')
+                return fail("invalid markup declaration");
+
+            ++mCursor;
+
+            return true;
+        }
+
+        //! \brief Expect a character.
+        bool expect(charT c)
+        {
+            if (mCursor == mEnd)
+                return fail("unexpected end of DTD", reader_t::unexpected_end);
+
+            if (*mCursor != c)
+                return fail("invalid markup declaration");
+
+            ++mCursor;
+
+            return true;
+        }
+
+        //! \brief Intern an element name.
+        symbol_t intern(const view_t& name)
+        {
+            std::pair<typename symbols_t::iterator, bool> inserted = mSymbols.emplace(name, static_cast<symbol_t>(mElements.size()));
+
+            if (inserted.second)
+                mElements.push_back(element_decl_t { content_undeclared, 0, std::vector<attribute_decl_t>() });
+
+            return inserted.first->second;
+        }
+
+        //! \brief Read an element type declaration.
+        bool readElement()
+        {
+            mCursor += 9;
+
+            view_t name;
+
+            if (!space() || !readName(name) || !space())
+                return false;
+
+            const symbol_t symbol = intern(name);
+
+            if (mElements[symbol].content != content_undeclared)
+                return fail("element declared twice");
+
+            content_t content;
+            uint32_t  start = 0;
+
+            if (keyword("EMPTY")) {
+                content = content_empty;
+            } else if (keyword("ANY")) {
+                content = content_any;
+            } else if (matches("(")) {
+                const_pointer_t group = mCursor;
+
+                ++mCursor;
+                mCursor = scanner_t::skip_whitespace(mCursor, mEnd);
+
+                if (matches("#PCDATA")) {
+                    content = content_mixed;
+
+                    if (!readMixed(start))
+                        return false;
+                } else {
+                    content = content_children;
+                    mCursor = group;
+
+                    if (!readChildren(start))
+                        return false;
+                }
+            } else {
+                return fail("invalid content specification");
+            }
+
+            mElements[symbol].content = content;
+            mElements[symbol].start   = start;
+
+            return close();
+        }
+
+        //! \brief Read a mixed content declaration, after \c "(".
+        /*!
+         *  \param [out] start The initial state of the automaton.
+         */
+        bool readMixed(uint32_t& start)
+        {
+            mCursor += 7;
+
+            std::vector<transition_t> transitions;
+            bool names = false;
+
+            start = static_cast<uint32_t>(mStates.size());
+
+            for (;;) {
+                mCursor = scanner_t::skip_whitespace(mCursor, mEnd);
+
+                if (matches(")"))
+                    break;
+
+                view_t name;
+
+                if (!expect('|'))
+                    return false;
+
+                mCursor = scanner_t::skip_whitespace(mCursor, mEnd);
+
+                if (!readName(name))
+                    return false;
+
+                transitions.push_back(transition_t { intern(name), start });
+                names = true;
+            }
+
+            ++mCursor;
+
+            if (matches("*"))
+                ++mCursor;
+            else if (names)
+                return fail("mixed content must be repeated");
+
+            std::sort(transitions.begin(), transitions.end());
+
+            mStates.push_back(state_t {
+                static_cast<uint32_t>(mTransitions.size()),
+                static_cast<uint32_t>(mTransitions.size() + transitions.size()),
+                true });
+            mTransitions.insert(mTransitions.end(), transitions.begin(), transitions.end());
+
+            return true;
+        }
+
+        //! \brief Read and compile a content model.
+        /*!
+         *  The model is read as a tree of particles, then compiled with the
+         *  Glushkov construction into an automaton with one state per
+         *  occurrence of an element name, which is made deterministic by
+         *  the subset construction.
+         *
+         *  \param [out] start The initial state of the automaton.
+         */
+        bool readChildren(uint32_t& start)
+        {
+            std::vector<particle_t> particles;
+            size_t root;
+
+            if (!readParticle(particles, root))
+                return false;
+
+            std::vector<symbol_t>              symbols;
+            std::vector<std::vector<uint32_t> > follow;
+
+            const positions_t model = analyze(particles, root, symbols, follow);
+
+            for (std::vector<uint32_t>& positions : follow) {
+                std::sort(positions.begin(), positions.end());
+                positions.erase(std::unique(positions.begin(), positions.end()), positions.end());
+            }
+
+            // States of the Glushkov automaton : 0 is the initial state, and
+            // p + 1 is the state reached by the name at position p.
+            std::vector<bool> accepting(symbols.size() + 1, false);
+
+            accepting[0] = model.nullable;
+
+            for (uint32_t position : model.last)
+                accepting[position + 1] = true;
+
+            std::map<std::vector<uint32_t>, uint32_t> ids;
+            std::vector<std::vector<uint32_t> >       sets(1, std::vector<uint32_t>(1, 0));
+
+            start = static_cast<uint32_t>(mStates.size());
+            ids[sets[0]] = start;
+
+            for (size_t i = 0; i != sets.size(); ++i) {
+                std::map<symbol_t, std::vector<uint32_t> > targets;
+                bool accepts = false;
+
+                for (uint32_t state : sets[i]) {
+                    accepts = accepts || accepting[state];
+
+                    for (uint32_t position : state == 0 ? model.first : follow[state - 1])
+                        targets[symbols[position]].push_back(position + 1);
+                }
+
+                mStates.push_back(state_t {
+                    static_cast<uint32_t>(mTransitions.size()),
+                    static_cast<uint32_t>(mTransitions.size() + targets.size()),
+                    accepts });
+
+                for (std::pair<const symbol_t, std::vector<uint32_t> >& target : targets) {
+                    std::sort(target.second.begin(), target.second.end());
+                    target.second.erase(std::unique(target.second.begin(), target.second.end()), target.second.end());
+
+                    std::pair<typename std::map<std::vector<uint32_t>, uint32_t>::iterator, bool> inserted =
+                        ids.emplace(target.second, static_cast<uint32_t>(start + sets.size()));
+
+                    if (inserted.second)
+                        sets.push_back(target.second);
+
+                    mTransitions.push_back(transition_t { target.first, inserted.first->second });
+                }
+            }
+
+            return true;
+        }
+
+        //! \brief Read a particle of a content model.
+        /*!
+         *  \param [in,out] particles The particles read.
+         *  \param [out]    index     The index of the particle read.
+         */
+        bool readParticle(std::vector<particle_t>& particles, size_t& index)
+        {
+            mCursor = scanner_t::skip_whitespace(mCursor, mEnd);
+
+            if (matches("(")) {
+                ++mCursor;
+
+                std::vector<size_t> children;
+                charT separator = 0;
+
+                for (;;) {
+                    size_t child;
+
+                    if (!readParticle(particles, child))
+                        return false;
+
+                    children.push_back(child);
+                    mCursor = scanner_t::skip_whitespace(mCursor, mEnd);
+
+                    if (matches(")"))
+                        break;
+
+                    if (mCursor == mEnd)
+                        return fail("unexpected end of DTD", reader_t::unexpected_end);
+
+                    if ((*mCursor != '|' && *mCursor != ',') || (separator != 0 && *mCursor != separator))
+                        return fail("invalid content model");
+
+                    separator = *mCursor++;
+                }
+
+                ++mCursor;
+
+                index = particles.size();
+                particles.push_back(particle_t { separator == '|' ? particle_choice : particle_sequence, 0, no_symbol, std::move(children) });
+            } else {
+                view_t name;
+
+                if (!readName(name))
+                    return false;
+
+                index = particles.size();
+                particles.push_back(particle_t { particle_name, 0, intern(name), std::vector<size_t>() });
+            }
+
+            if (mCursor != mEnd && (*mCursor == '?' || *mCursor == '*' || *mCursor == '+'))
+                particles[index].occurrence = *mCursor++;
+
+            return true;
+        }
+
+        //! \brief Compute the position sets of a particle.
+        /*!
+         *  \param [in]     particles The particles of the content model.
+         *  \param [in]     index     The index of the particle.
+         *  \param [in,out] symbols   The element name at each position.
+         *  \param [in,out] follow    The positions that can follow each position.
+         *
+         *  \return The position sets of the particle.
+         */
+        static positions_t analyze(const std::vector<particle_t>& particles, size_t index,
+            std::vector<symbol_t>& symbols, std::vector<std::vector<uint32_t> >& follow)
+        {
+            const particle_t& particle = particles[index];
+            positions_t result;
+
+            if (particle.kind == particle_name) {
+                const uint32_t position = static_cast<uint32_t>(symbols.size());
+
+                symbols.push_back(particle.symbol);
+                follow.push_back(std::vector<uint32_t>());
+
+                result.nullable = false;
+                result.first.push_back(position);
+                result.last.push_back(position);
+            } else {
+                result = analyze(particles, particle.children[0], symbols, follow);
+
+                for (size_t i = 1; i != particle.children.size(); ++i) {
+                    positions_t next = analyze(particles, particle.children[i], symbols, follow);
+
+                    if (particle.kind == particle_choice) {
+                        result.nullable = result.nullable || next.nullable;
+                        result.first.insert(result.first.end(), next.first.begin(), next.first.end());
+                        result.last.insert(result.last.end(), next.last.begin(), next.last.end());
+                        continue;
+                    }
+
+                    for (uint32_t position : result.last)
+                        follow[position].insert(follow[position].end(), next.first.begin(), next.first.end());
+
+                    if (result.nullable)
+                        result.first.insert(result.first.end(), next.first.begin(), next.first.end());
+
+                    if (next.nullable)
+                        next.last.insert(next.last.end(), result.last.begin(), result.last.end());
+
+                    result.last     = std::move(next.last);
+                    result.nullable = result.nullable && next.nullable;
+                }
+            }
+
+            if (particle.occurrence == '*' || particle.occurrence == '+')
+                for (uint32_t position : result.last)
+                    follow[position].insert(follow[position].end(), result.first.begin(), result.first.end());
+
+            if (particle.occurrence == '*' || particle.occurrence == '?')
+                result.nullable = true;
+
+            return result;
+        }
+
+        //! \brief Read an attribute list declaration.
+        bool readAttributeList()
+        {
+            mCursor += 9;
+
+            view_t name;
+
+            if (!space() || !readName(name))
+                return false;
+
+            std::vector<attribute_decl_t>& attributes = mElements[intern(name)].attributes;
+
+            for (;;) {
+                mCursor = scanner_t::skip_whitespace(mCursor, mEnd);
+
+                if (matches(">")) {
+                    ++mCursor;
+                    return true;
+                }
+
+                attribute_decl_t decl { view_t(), type_cdata, presence_implied, string_t(), mTokens.size(), mTokens.size() };
+
+                if (!readName(decl.name) || !space() || !readType(decl) || !space() || !readDefault(decl))
+                    return false;
+
+                bool declared = false;
+
+                for (const attribute_decl_t& attribute : attributes)
+                    declared = declared || attribute.name == decl.name;
+
+                if (!declared)
+                    attributes.push_back(std::move(decl));
+            }
+        }
+
+        //! \brief Read the type of an attribute.
+        bool readType(attribute_decl_t& decl)
+        {
+            if (keyword("CDATA"))
+                decl.type = type_cdata;
+            else if (keyword("ID"))
+                decl.type = type_id;
+            else if (keyword("IDREF"))
+                decl.type = type_idref;
+            else if (keyword("IDREFS"))
+                decl.type = type_idrefs;
+            else if (keyword("ENTITY"))
+                decl.type = type_entity;
+            else if (keyword("ENTITIES"))
+                decl.type = type_entities;
+            else if (keyword("NMTOKEN"))
+                decl.type = type_nmtoken;
+            else if (keyword("NMTOKENS"))
+                decl.type = type_nmtokens;
+            else if (keyword("NOTATION"))
+                return space() && readEnumeration(decl, false);
+            else if (matches("("))
+                return readEnumeration(decl, true);
+            else
+                return fail("invalid attribute type");
+
+            return true;
+        }
+
+        //! \brief Read the tokens of an enumeration or of a \c NOTATION type.
+        /*!
+         *  \param [out] decl   The declaration of the attribute.
+         *  \param [in]  tokens Whether the values are name tokens, or names.
+         */
+        bool readEnumeration(attribute_decl_t& decl, bool tokens)
+        {
+            if (!expect('('))
+                return false;
+
+            decl.type  = type_enumeration;
+            decl.first = mTokens.size();
+
+            for (;;) {
+                view_t token;
+
+                mCursor = scanner_t::skip_whitespace(mCursor, mEnd);
+
+                if (!readName(token, tokens))
+                    return false;
+
+                mTokens.push_back(token);
+                mCursor = scanner_t::skip_whitespace(mCursor, mEnd);
+
+                if (matches(")"))
+                    break;
+
+                if (!expect('|'))
+                    return false;
+            }
+
+            ++mCursor;
+            decl.last = mTokens.size();
+
+            return true;
+        }
+
+        //! \brief Read the default declaration of an attribute.
+        bool readDefault(attribute_decl_t& decl)
+        {
+            if (keyword("#REQUIRED")) {
+                decl.presence = presence_required;
+                return true;
+            }
+
+            if (keyword("#IMPLIED")) {
+                decl.presence = presence_implied;
+                return true;
+            }
+
+            decl.presence = presence_default;
+
+            if (keyword("#FIXED")) {
+                decl.presence = presence_fixed;
+
+                if (!space())
+                    return false;
+            }
+
+            if (mCursor == mEnd)
+                return fail("unexpected end of DTD", reader_t::unexpected_end);
+
+            if (*mCursor != '"' && *mCursor != '\'')
+                return fail("invalid default value");
+
+            const_pointer_t last = scanner_t::find(mCursor + 1, mEnd, *mCursor);
+
+            if (last == mEnd)
+                return fail("unexpected end of DTD", reader_t::unexpected_end);
+
+            string_ref_t value;
+
+            if (!decoder_t::decode(view_t(mCursor + 1, last), value, false))
+                return fail("invalid character or entity reference", reader_t::invalid_reference);
+
+            decl.value = value.str();
+            mCursor    = last + 1;
+
+            return true;
+        }
+
+        //! \brief Record an error and stop compiling.
+        /*!
+         *  \param [in] what A description of the error.
+         *  \param [in] code The code of the error.
+         *
+         *  \return \c false.
+         */
+        bool fail(const char* what, typename reader_t::error_t code = reader_t::invalid_doctype)
+        {
+            mError     = what;
+            mErrorCode = code;
+
+            return false;
+        }
+
+        string_t mSource; //!< A copy of the declarations, referenced by the names and tokens.
+
+        symbols_t                   mSymbols;     //!< The element names, interned.
+        std::vector<element_decl_t> mElements;    //!< The declarations of the elements, by symbol.
+        std::vector<state_t>        mStates;      //!< The states of all the content model automata.
+        std::vector<transition_t>   mTransitions; //!< The transitions of all the automata, sorted by symbol in each state.
+        std::vector<view_t>         mTokens;      //!< The tokens of all the enumerations.
+
+        const_pointer_t mCursor; //!< The next character to compile.
+        const_pointer_t mEnd;    //!< The end of the declarations.
+
+        const char*                mError;     //!< A description of the compilation error.
+        typename reader_t::error_t mErrorCode; //!< The code of the compilation error.
+    };
+
+    typedef basic_dtd<char>    dtd;  //!< A specialized \c basic_dtd for char.
+    typedef basic_dtd<wchar_t> wdtd; //!< A specialized \c basic_dtd for wchar_t.
+}
+
+#endif /* DTD_H_INCLUDED */
@@ -2,9 +2,13 @@
 #define ELEMENT_H_INCLUDED
 
 #include <set>
+#include <algorithm>
 
+#include <string-ref.h>
+#include <arena.h>
 #include <node.h>
 #include <attribute.h>
+#include <attribute-set.h>
 #include <text.h>
 
 namespace xml {
@@ -12,7 +16,9 @@ namespace xml {
     //! \brief A XML element.
     /*!
      *  This class represents an XML element. It can be an empty tag or it can
-     *  have several children. It also has attributes.
+     *  have several children. It also has attributes. When the document is
+     *  parsed with namespaces, it has the identifier of its namespace in the
+     *  namespace table of the document.
      *
      *  \tparam charT The type of character used in the name and value.
      *                By default, char and wchar_t are supported.
@@ -40,10 +46,15 @@ namespace xml {
         typedef const element_t&     element_const_reference_t; //!< Constant reference to \c element_t.
         typedef element_t&&          element_move_t;            //!< Move a \c element_t.
 
-        typedef std::basic_string<charT> string_t; //!< The string type.
+        typedef std::basic_string<charT> string_t;     //!< The string type.
+        typedef basic_string_ref<charT>  string_ref_t; //!< The type of string stored.
+        typedef basic_string_view<charT> view_t;       //!< The type of local names.
 
-        typedef basic_attribute<charT> attribute_t;     //!< The attribute type of this element.
-        typedef std::set<attribute_t > attribute_set_t; //!< A set of \c basic_attribute.
+        typedef basic_namespace_table<charT> table_t; //!< The namespace table type.
+
+        typedef basic_attribute<charT> attribute_t; //!< The attribute type of this element.
+
+        typedef basic_attribute_set<charT> attribute_set_t; //!< A set of \c basic_attribute, allocated on the heap or in an \c arena.
 
         typedef          basic_text<charT>              text_t;                 //!< The text type.
         typedef typename text_t::text_const_reference_t text_const_reference_t; //!< A pointer to \c text_t.
@@ -65,11 +76,28 @@ namespace xml {
          *  \param[in] parent The parent node of this element.
          */
         basic_element(
-            string_t name,
+            string_ref_t name,
             parent_pointer_t parent = nullptr)
         :
             node_t(parent),
-            mName(name)
+            mName(std::move(name)),
+            mNamespace(table_t::no_namespace),
+            mAttributes(this)
+        {}
+
+        //! \brief Constructor of an element whose attributes are allocated in an arena.
+        /*!
+         *  \param[in] name   The name of this element.
+         *  \param[in] memory The arena the attributes are allocated in.
+         */
+        basic_element(
+            string_ref_t name,
+            arena& memory)
+        :
+            node_t(nullptr),
+            mName(std::move(name)),
+            mNamespace(table_t::no_namespace),
+            mAttributes(this, arena_allocator<attribute_t>(&memory))
         {}
 
         //! \brief Copy constructor.
@@ -81,7 +109,9 @@ namespace xml {
         basic_element(element_const_reference_t rhs)
         :
             node_t(rhs),
-            mName(rhs.mName)
+            mName(rhs.mName),
+            mNamespace(rhs.mNamespace),
+            mAttributes(rhs.mAttributes, this)
         {}
 
         //! \brief Move constructor.
@@ -93,7 +123,9 @@ namespace xml {
         basic_element(element_move_t rhs)
         :
             node_t(rhs),
-            mName(std::move(rhs.mName))
+            mName(std::move(rhs.mName)),
+            mNamespace(rhs.mNamespace),
+            mAttributes(std::move(rhs.mAttributes), this)
         {}
 
         //! \brief Destructor.
@@ -114,6 +146,15 @@ namespace xml {
             return node_interface_t::stringToType("element");
         }
 
+        //! \brief Get the kind of a \c element_t.
+        /*!
+         *  \return \c node_interface_t::element_kind.
+         */
+        virtual typename node_interface_t::kind_t kind() const
+        {
+            return node_interface_t::element_kind;
+        }
+
         //! \brief Clone the current \c element_t.
         /*!
          *  This function creates a deep copy of this \c element_t,
@@ -136,6 +177,105 @@ namespace xml {
             return new element_t(static_cast<element_move_t>(rhs));
         }
 
+        //! \brief Get the name of an element.
+        /*!
+         *  This function returns a constant reference to the name of the
+         *  \c element_t.
+         *
+         *  \return A constant reference to the name of the \c element_t.
+         */
+        const string_ref_t& name() const
+        {
+            return mName;
+        }
+
+        //! \brief Get the name of an element.
+        /*!
+         *  This function returns a reference to the name of the
+         *  \c element_t. A name referencing the source of the document is
+         *  copied when it is modified.
+         *
+         *  \return A reference to the name of the \c element_t.
+         */
+        string_ref_t& name()
+        {
+            return mName;
+        }
+
+        //! \brief Get the local name of an element.
+        /*!
+         *  \return The part of the name that follows its prefix, or the
+         *          whole name if it has no prefix.
+         */
+        view_t local_name() const
+        {
+            const view_t name = mName.view();
+            const charT* colon = std::find(name.begin(), name.end(), charT(':'));
+
+            return colon != name.end() ? view_t(colon + 1, name.end()) : name;
+        }
+
+        //! \brief Get the namespace of an element.
+        /*!
+         *  \return The identifier of the namespace of the element in the
+         *          namespace table of its document.
+         */
+        namespace_id_t namespace_id() const
+        {
+            this->expand();
+
+            return mNamespace;
+        }
+
+        //! \brief Get the namespace of an element.
+        /*!
+         *  \return A reference to the identifier of the namespace of the
+         *          element, which must be interned in the namespace table of
+         *          its document.
+         */
+        namespace_id_t& namespace_id()
+        {
+            this->expand();
+
+            return mNamespace;
+        }
+
+        //! \brief Whether an element has a given expanded name.
+        /*!
+         *  The namespaces are compared as integers, before the local names.
+         *
+         *  \param [in] ns    The identifier of the namespace.
+         *  \param [in] local The local name.
+         *
+         *  \return \c true if the element is named \c local in \c ns.
+         */
+        bool has_name(namespace_id_t ns, const view_t& local) const
+        {
+            return namespace_id() == ns && local_name() == local;
+        }
+
+        //! \brief Whether the white spaces of an element are significant.
+        /*!
+         *  The closest \c xml:space attribute of the element or of its
+         *  ancestors decides.
+         *
+         *  \return \c true if it is \c "preserve", \c false if it is
+         *          \c "default" or if there is none.
+         */
+        bool preserves_space() const
+        {
+            for (const basic_element* element = this;;) {
+                for (const attribute_t& attribute : element->attributes())
+                    if (attribute.name().view().equals("xml:space"))
+                        return attribute.value().view().equals("preserve");
+
+                if (!element->has_parent() || element->parent().kind() != node_interface_t::element_kind)
+                    return false;
+
+                element = &static_cast<const basic_element&>(element->parent());
+            }
+        }
+
         //! \brief Get the attributes of an element.
         /*!
          *  This function returns a constant reference to the attributes of the
@@ -145,18 +285,23 @@ namespace xml {
          */
         const attribute_set_t& attributes() const
         {
+            this->expand();
+
             return mAttributes;
         }
 
         //! \brief Get the attributes of an element.
         /*!
          *  This function returns a reference to the attributes of the
-         *  \c element_t.
+         *  \c element_t. The attribute index of the document, if any,
+         *  is dropped when attributes are inserted or erased.
          *
          *  \return A reference to the attributes of the \c element_t.
          */
         attribute_set_t& attributes()
         {
+            this->expand();
+
             return mAttributes;
         }
 
@@ -560,6 +705,21 @@ namespace xml {
             return parent_t::template emplace_back<text_t>(std::forward<Args>(args) ...);
         }
 
+        //! \brief Insert an allocated \c child_t after the last element.
+        /*!
+         *  The element takes the ownership of the \c child_t, such as an
+         *  \c arena_node, and deletes it when it is erased.
+         *
+         *  \param [in] ptr A pointer to the \c child_t to insert.
+         *
+         *  \return An \c iterator pointing to the inserted element.
+         */
+        template <class classT = child_t>
+        iterator<classT> adopt_back (child_pointer_t ptr)
+        {
+            return parent_t::template adopt_back<classT>(ptr);
+        }
+
         //! \brief Erase element.
         /*!
          *  The element pointed by the \c iterator will be erased.
@@ -616,10 +776,27 @@ namespace xml {
             return parent_t::clear();
         }
 
+        //! \brief Move children from another element.
+        /*!
+         *  The children in between \c first (included) and \c last (excluded)
+         *  are unlinked from \c other and inserted before \c position,
+         *  without being copied.
+         *
+         *  \param [in] position An iterator before which the children are inserted.
+         *  \param [in] other    The element owning the children.
+         *  \param [in] first    An iterator to the first child to move.
+         *  \param [in] last     An iterator past the last child to move.
+         */
+        void splice (iterator<> position, element_reference_t other, iterator<> first, iterator<> last)
+        {
+            parent_t::splice(position, other, first, last);
+        }
+
     private:
-        string_t mName;
+        string_ref_t   mName;      //!< The name of this element.
+        namespace_id_t mNamespace; //!< The namespace of this element.
 
-        attribute_set_t mAttributes;
+        attribute_set_t mAttributes; //!< The attributes of this element.
     };
 
     typedef basic_element<char>    element;  //!< A specialized \c basic_element for char.
@@ -0,0 +1,280 @@
+#ifndef ENTITY_DECODER_H_INCLUDED
+#define ENTITY_DECODER_H_INCLUDED
+
+#include <string>
+#include <cstdint>
+#include <algorithm>
+
+#include <scanner.h>
+#include <string-view.h>
+#include <string-ref.h>
+
+namespace xml {
+    //! \brief A decoder of character and entity references.
+    /*!
+     *  This class replaces the predefined entity references \c "&lt;",
+     *  \c "&gt;", \c "&amp;", \c "&apos;" and \c "&quot;", and the
+     *  character references \c "&#...;" and \c "&#x...;", with the
+     *  characters they designate.
+     *
+     *  The \c '&' characters are found with \c basic_scanner::find(),
+     *  which compares 16 bytes at a time. A value without any reference
+     *  costs a single search, and is kept as a view or copied as is.
+     *  Otherwise, it is decoded in place, since a reference is always
+     *  longer than its replacement.
+     *
+     *  Character references are encoded in UTF-8 in \c char buffers, in
+     *  UTF-16 in 16-bit buffers, and stored as is in 32-bit buffers.
+     *
+     *  \sa xml::basic_scanner
+     *
+     *  \tparam charT The type of character used in the XML document.
+     *                By default, char and wchar_t are supported.
+     */
+    template <typename charT>
+    class basic_entity_decoder {
+    public:
+        //! \name Member types
+        //!@{
+        typedef basic_scanner<charT>     scanner_t;    //!< The scanner type.
+        typedef basic_string_view<charT> view_t;       //!< The type of values.
+        typedef basic_string_ref<charT>  string_ref_t; //!< The type of string stored in nodes.
+        typedef std::basic_string<charT> string_t;     //!< The string type.
+
+        typedef charT*       pointer_t;       //!< Pointer to a character.
+        typedef const charT* const_pointer_t; //!< Pointer to a constant character.
+
+        //!@}
+
+        //! \brief Find the first reference of a value.
+        /*!
+         *  \param [in] first A pointer to the first character of the value.
+         *  \param [in] last  A pointer past the last character of the value.
+         *
+         *  \return A pointer to the first \c '&', or \c last.
+         */
+        static const_pointer_t find(const_pointer_t first, const_pointer_t last)
+        {
+            return scanner_t::find(first, last, '&');
+        }
+
+        //! \brief Decode the references of a value in place.
+        /*!
+         *  \param [in] first A pointer to the first character of the value.
+         *  \param [in] last  A pointer past the last character of the value.
+         *
+         *  \return A pointer past the last decoded character, or \c nullptr
+         *          if a reference is malformed or designates a character
+         *          that is not allowed in a XML document.
+         */
+        static pointer_t decode(pointer_t first, pointer_t last)
+        {
+            pointer_t cursor = const_cast<pointer_t>(find(first, last));
+            pointer_t out    = cursor;
+
+            while (cursor != last) {
+                const_pointer_t end = scanner_t::find(cursor + 1, last, ';');
+                uint32_t code = 0;
+
+                if (end == last || !reference(cursor + 1, end, code))
+                    return nullptr;
+
+                out    = put(out, code);
+                cursor = const_cast<pointer_t>(end + 1);
+
+                pointer_t next = const_cast<pointer_t>(find(cursor, last));
+
+                out    = std::copy(cursor, next, out);
+                cursor = next;
+            }
+
+            return out;
+        }
+
+        //! \brief Decode the references of a value in place, keeping the malformed ones.
+        /*!
+         *  A malformed reference is kept as is, and its \c '&' is reported
+         *  to \c invalid. The search for the \c ';' of a reference stops at
+         *  the next \c '&', so that each character is read once whatever
+         *  the number of stray \c '&' is.
+         *
+         *  \tparam functionT The type of function called for each malformed
+         *                    reference, with a pointer to its \c '&'.
+         *
+         *  \param [in] first   A pointer to the first character of the value.
+         *  \param [in] last    A pointer past the last character of the value.
+         *  \param [in] invalid The function called for each malformed reference.
+         *
+         *  \return A pointer past the last decoded character.
+         */
+        template <typename functionT>
+        static pointer_t repair(pointer_t first, pointer_t last, functionT invalid)
+        {
+            pointer_t cursor = const_cast<pointer_t>(find(first, last));
+            pointer_t out    = cursor;
+
+            while (cursor != last) {
+                const_pointer_t end = scanner_t::find_first_of(cursor + 1, last, ';', '&');
+                uint32_t code = 0;
+
+                if (end != last && *end == ';' && reference(cursor + 1, end, code)) {
+                    out    = put(out, code);
+                    cursor = const_cast<pointer_t>(end + 1);
+                } else {
+                    invalid(static_cast<const_pointer_t>(cursor));
+
+                    *out++ = *cursor++;
+                }
+
+                pointer_t next = const_cast<pointer_t>(find(cursor, last));
+
+                out    = std::copy(cursor, next, out);
+                cursor = next;
+            }
+
+            return out;
+        }
+
+        //! \brief Decode the references of a value into a string.
+        /*!
+         *  \param [in]  value     The value to decode.
+         *  \param [out] out       The decoded value.
+         *  \param [in]  reference Whether \c out may reference \c value when
+         *                         it holds no reference.
+         *
+         *  \return \c false if a reference is malformed, \c true otherwise.
+         */
+        static bool decode(const view_t& value, string_ref_t& out, bool reference)
+        {
+            const_pointer_t first = find(value.begin(), value.end());
+
+            if (first == value.end()) {
+                out = reference ? string_ref_t(value) : string_ref_t(value.str());
+                return true;
+            }
+
+            string_t decoded = value.str();
+            pointer_t data   = &decoded[0];
+            pointer_t last   = decode(data + (first - value.begin()), data + decoded.size());
+
+            if (last == nullptr)
+                return false;
+
+            decoded.resize(last - data);
+            out = string_ref_t(std::move(decoded));
+
+            return true;
+        }
+
+    private:
+        //! \brief Get the character designated by a reference.
+        /*!
+         *  \param [in]  first A pointer past the \c '&'.
+         *  \param [in]  last  A pointer to the \c ';'.
+         *  \param [out] code  The code point of the character.
+         *
+         *  \return \c false if the reference is malformed.
+         */
+        static bool reference(const_pointer_t first, const_pointer_t last, uint32_t& code)
+        {
+            const view_t name(first, last);
+
+            if (name.equals("lt"))
+                code = '<';
+            else if (name.equals("gt"))
+                code = '>';
+            else if (name.equals("amp"))
+                code = '&';
+            else if (name.equals("apos"))
+                code = '\'';
+            else if (name.equals("quot"))
+                code = '"';
+            else if (first == last || *first != '#')
+                return false;
+            else
+                return number(first + 1, last, code);
+
+            return true;
+        }
+
+        //! \brief Get the character designated by a character reference.
+        /*!
+         *  \param [in]  first A pointer past the \c '#'.
+         *  \param [in]  last  A pointer to the \c ';'.
+         *  \param [out] code  The code point of the character.
+         *
+         *  \return \c false if the reference is malformed or designates a
+         *          character that is not allowed.
+         */
+        static bool number(const_pointer_t first, const_pointer_t last, uint32_t& code)
+        {
+            const uint32_t base = first != last && *first == 'x' ? 16 : 10;
+
+            if (base == 16)
+                ++first;
+
+            if (first == last)
+                return false;
+
+            for (code = 0; first != last; ++first) {
+                const uint32_t c = scanner_t::code(*first);
+                uint32_t digit;
+
+                if (c >= '0' && c <= '9')
+                    digit = c - '0';
+                else if (base == 16 && (c | 0x20) >= 'a' && (c | 0x20) <= 'f')
+                    digit = (c | 0x20) - 'a' + 10;
+                else
+                    return false;
+
+                code = code * base + digit;
+
+                if (code > 0x10FFFF)
+                    return false;
+            }
+
+            return code == 0x9 || code == 0xA || code == 0xD ||
+                (code >= 0x20 && code <= 0xD7FF) ||
+                (code >= 0xE000 && code <= 0xFFFD) ||
+                code >= 0x10000;
+        }
+
+        //! \brief Write a character.
+        /*!
+         *  \param [out] out  A pointer to the first character to write.
+         *  \param [in]  code The code point of the character.
+         *
+         *  \return A pointer past the last character written.
+         */
+        static pointer_t put(pointer_t out, uint32_t code)
+        {
+            if (sizeof(charT) == 1 && code >= 0x80) {
+                if (code < 0x800) {
+                    *out++ = static_cast<charT>(0xC0 | code >> 6);
+                } else if (code < 0x10000) {
+                    *out++ = static_cast<charT>(0xE0 | code >> 12);
+                    *out++ = static_cast<charT>(0x80 | (code >> 6 & 0x3F));
+                } else {
+                    *out++ = static_cast<charT>(0xF0 | code >> 18);
+                    *out++ = static_cast<charT>(0x80 | (code >> 12 & 0x3F));
+                    *out++ = static_cast<charT>(0x80 | (code >> 6 & 0x3F));
+                }
+
+                code = 0x80 | (code & 0x3F);
+            } else if (sizeof(charT) == 2 && code >= 0x10000) {
+                *out++ = static_cast<charT>(0xD800 + ((code - 0x10000) >> 10));
+
+                code = 0xDC00 + (code & 0x3FF);
+            }
+
+            *out++ = static_cast<charT>(code);
+
+            return out;
+        }
+    };
+
+    typedef basic_entity_decoder<char>    entity_decoder;  //!< A specialized \c basic_entity_decoder for char.
+    typedef basic_entity_decoder<wchar_t> wentity_decoder; //!< A specialized \c basic_entity_decoder for wchar_t.
+}
+
+#endif /* ENTITY_DECODER_H_INCLUDED */
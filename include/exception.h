@@ -0,0 +1,252 @@
+#ifndef EXCEPTION_H_INCLUDED
+#define EXCEPTION_H_INCLUDED
+
+#include <string>
+#include <memory>
+#include <ostream>
+#include <cstddef>
+#include <stdexcept>
+
+#include <reader.h>
+
+namespace xml {
+    //! \brief A compact description of a parse error.
+    /*!
+     *  This class only holds an error code, the offset of the faulty
+     *  character, and a static description : it is copied without
+     *  allocating memory. The line and the column of the error are only
+     *  computed when they are asked for, from the parsed buffer.
+     *
+     *  \sa xml::basic_exception
+     *
+     *  \tparam charT The type of character used in the XML document.
+     *                By default, char and wchar_t are supported.
+     */
+    template <typename charT>
+    class basic_parse_error {
+    public:
+        //! \name Member types
+        //!@{
+        typedef          basic_reader<charT>       reader_t;        //!< The reader type.
+        typedef typename reader_t::error_t         error_t;         //!< The error code type.
+        typedef typename reader_t::scanner_t       scanner_t;       //!< The scanner type.
+        typedef typename reader_t::const_pointer_t const_pointer_t; //!< Pointer to a constant character.
+
+        //!@}
+
+        //! \brief Constructor.
+        /*!
+         *  \param [in] what   A static description of the error.
+         *  \param [in] code   The error code.
+         *  \param [in] offset The offset of the faulty character, in characters.
+         */
+        basic_parse_error(const char* what, error_t code, size_t offset)
+        :
+            mWhat(what),
+            mOffset(offset),
+            mCode(code)
+        {}
+
+        //! \brief Get the description of the error.
+        /*!
+         *  \return A static null-terminated string.
+         */
+        const char* what() const { return mWhat; }
+
+        //! \brief Get the error code.
+        /*!
+         *  \return The error code, or \c reader_t::no_error if the error has
+         *          been found by a handler.
+         */
+        error_t code() const { return mCode; }
+
+        //! \brief Get the offset of the error.
+        /*!
+         *  \return The offset of the faulty character from the beginning of
+         *          the document, in characters.
+         */
+        size_t offset() const { return mOffset; }
+
+        //! \brief Get the line of the error.
+        /*!
+         *  Lines are counted by searching line feeds with
+         *  \c basic_scanner::find().
+         *
+         *  \param [in] first A pointer to the first character of the parsed
+         *                    document.
+         *
+         *  \return The line of the faulty character, starting at 1.
+         */
+        size_t line(const_pointer_t first) const
+        {
+            const_pointer_t last = first + mOffset;
+            size_t count = 1;
+
+            for (first = scanner_t::find(first, last, '\n'); first != last; first = scanner_t::find(first + 1, last, '\n'))
+                ++count;
+
+            return count;
+        }
+
+        //! \brief Get the column of the error.
+        /*!
+         *  \param [in] first A pointer to the first character of the parsed
+         *                    document.
+         *
+         *  \return The column of the faulty character, in characters,
+         *          starting at 1.
+         */
+        size_t column(const_pointer_t first) const
+        {
+            const_pointer_t cursor = first + mOffset;
+
+            while (cursor != first && cursor[-1] != '\n')
+                --cursor;
+
+            return first + mOffset - cursor + 1;
+        }
+
+    private:
+        const char* mWhat;   //!< The static description of the error.
+        size_t      mOffset; //!< The offset of the faulty character.
+        error_t     mCode;   //!< The error code.
+    };
+
+    //! \brief An exception describing a parse error.
+    /*!
+     *  This exception is thrown by the builders when a document is not
+     *  well-formed. It is a \c std::runtime_error, which can be caught as
+     *  such. It holds a \c basic_parse_error, and the line and the column
+     *  of the error, which are counted in the parsed buffer when the
+     *  exception is built : the buffer is not read afterwards. The message
+     *  is formatted at the same time, so that \c what() only reads it. The
+     *  buffers owned by the builders, such as mapped files and converted
+     *  UTF-8 documents, are kept alive by the exception.
+     *
+     *  The functions that do not throw, such as \c basic_builder::try_parse(),
+     *  return the \c basic_parse_error itself, and do not pay for counting
+     *  lines nor formatting messages.
+     *
+     *  \sa xml::basic_parse_error
+     *
+     *  \tparam charT The type of character used in the XML document.
+     *                By default, char and wchar_t are supported.
+     */
+    template <typename charT>
+    class basic_exception : public std::runtime_error {
+    public:
+        //! \name Member types
+        //!@{
+        typedef          basic_parse_error<charT>       parse_error_t;   //!< The parse error type.
+        typedef typename parse_error_t::error_t         error_t;         //!< The error code type.
+        typedef typename parse_error_t::const_pointer_t const_pointer_t; //!< Pointer to a constant character.
+
+        //!@}
+
+        //! \brief Constructor.
+        /*!
+         *  \param [in] error  The parse error.
+         *  \param [in] first  A pointer to the first character of the parsed
+         *                     document, or \c nullptr if the line and the
+         *                     column are unknown.
+         *  \param [in] source The owner of the parsed document, kept alive by
+         *                     the exception, or \c nullptr.
+         */
+        basic_exception(const parse_error_t& error, const_pointer_t first, std::shared_ptr<const void> source = nullptr)
+        :
+            std::runtime_error(""),
+            mError(error),
+            mLine(first != nullptr ? error.line(first) : 0),
+            mColumn(first != nullptr ? error.column(first) : 0),
+            mSource(std::move(source)),
+            mMessage(std::string(error.what()) + " (error " + std::to_string(static_cast<int>(error.code())) +
+                     (first != nullptr
+                        ? " at line " + std::to_string(mLine) + ", column " + std::to_string(mColumn) + ")"
+                        : " at offset " + std::to_string(error.offset()) + ")"))
+        {}
+
+        //! \brief Destructor.
+        /*!
+         *  This destructor does nothing.
+         */
+        virtual ~basic_exception() noexcept
+        {}
+
+        //! \brief Get the full message of the exception.
+        /*!
+         *  The message is \c "<description> (error <code> at line <line>,
+         *  column <column>)", or \c "<description> (error <code> at offset
+         *  <offset>)" if the line is unknown.
+         *
+         *  \return A null-terminated string, valid as long as the exception.
+         */
+        virtual const char* what() const noexcept
+        {
+            return mMessage.c_str();
+        }
+
+        //! \brief Get the parse error.
+        /*!
+         *  \return A constant reference to the parse error.
+         */
+        const parse_error_t& error() const { return mError; }
+
+        //! \brief Get the error code.
+        /*!
+         *  \return The error code, or \c no_error if the error has been
+         *          found by a handler.
+         */
+        error_t errCode() const { return mError.code(); }
+
+        //! \brief Get the offset of the error.
+        /*!
+         *  \return The offset of the faulty character, in characters.
+         */
+        size_t offset() const { return mError.offset(); }
+
+        //! \brief Get the line of the error.
+        /*!
+         *  \return The line of the faulty character, starting at 1, or 0
+         *          if it is unknown.
+         */
+        size_t line() const { return mLine; }
+
+        //! \brief Get the column of the error.
+        /*!
+         *  \return The column of the faulty character, starting at 1, or 0
+         *          if it is unknown.
+         */
+        size_t column() const { return mColumn; }
+
+    private:
+        parse_error_t               mError;   //!< The parse error.
+        size_t                      mLine;    //!< The line of the error, or 0.
+        size_t                      mColumn;  //!< The column of the error, or 0.
+        std::shared_ptr<const void> mSource;  //!< The owner of the parsed document, or \c nullptr.
+        std::string                 mMessage; //!< The full message.
+    };
+
+    //! \brief Write the message of an exception to a stream.
+    /*!
+     *  \param [in] os The stream to write to.
+     *  \param [in] e  The exception to write.
+     *
+     *  \return \c os.
+     */
+    template <typename charT, typename traits>
+    std::basic_ostream<charT, traits>& operator<<(std::basic_ostream<charT, traits>& os, const basic_exception<charT>& e)
+    {
+        for (const char* c = e.what(); *c != '\0'; ++c)
+            os.put(static_cast<charT>(*c));
+
+        return os;
+    }
+
+    typedef basic_parse_error<char>    parse_error;  //!< A specialized \c basic_parse_error for char.
+    typedef basic_parse_error<wchar_t> wparse_error; //!< A specialized \c basic_parse_error for wchar_t.
+
+    typedef basic_exception<char>    exception;  //!< A specialized \c basic_exception for char.
+    typedef basic_exception<wchar_t> wexception; //!< A specialized \c basic_exception for wchar_t.
+}
+
+#endif /* EXCEPTION_H_INCLUDED */
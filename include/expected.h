@@ -0,0 +1,124 @@
+#ifndef EXPECTED_H_INCLUDED
+#define EXPECTED_H_INCLUDED
+
+#include <new>
+#include <utility>
+
+namespace xml {
+    //! \brief A value or the error that prevented computing it.
+    /*!
+     *  This class is returned by the functions that report errors without
+     *  throwing exceptions, so that they can be used in programs built
+     *  without exception support, and so that failures cost no more than
+     *  a return. The value and the error share the same storage.
+     *
+     *  Calling \c value() when there is an error, or \c error() when there
+     *  is a value, causes undefined behaviour.
+     *
+     *  \tparam valueT The type of the value.
+     *  \tparam errorT The type of the error.
+     */
+    template <typename valueT, typename errorT>
+    class expected {
+    public:
+        //! \name Member types
+        //!@{
+        typedef valueT value_t; //!< The type of the value.
+        typedef errorT error_t; //!< The type of the error.
+
+        //!@}
+
+        //! \brief Constructor.
+        /*!
+         *  Builds a successful result.
+         *
+         *  \param [in] value The value, which is moved.
+         */
+        expected(value_t&& value)
+        :
+            mHasValue(true)
+        {
+            new (&mValue) value_t(std::move(value));
+        }
+
+        //! \brief Constructor.
+        /*!
+         *  Builds a failed result.
+         *
+         *  \param [in] error The error.
+         */
+        expected(const error_t& error)
+        :
+            mHasValue(false)
+        {
+            new (&mError) error_t(error);
+        }
+
+        //! \brief Move constructor.
+        /*!
+         *  \param [in] other The result to move.
+         */
+        expected(expected&& other)
+        :
+            mHasValue(other.mHasValue)
+        {
+            if (mHasValue)
+                new (&mValue) value_t(std::move(other.mValue));
+            else
+                new (&mError) error_t(std::move(other.mError));
+        }
+
+        expected(const expected&) = delete;
+        expected& operator=(const expected&) = delete;
+
+        //! \brief Destructor.
+        /*!
+         *  Destroys the value or the error.
+         */
+        ~expected()
+        {
+            if (mHasValue)
+                mValue.~value_t();
+            else
+                mError.~error_t();
+        }
+
+        //! \brief Whether the result holds a value.
+        /*!
+         *  \return \c true if the result holds a value, \c false if it holds
+         *          an error.
+         */
+        bool has_value() const { return mHasValue; }
+
+        //! \brief Whether the result holds a value.
+        explicit operator bool() const { return mHasValue; }
+
+        //! \brief Get the value.
+        /*!
+         *  \return A reference to the value.
+         */
+        value_t& value() { return mValue; }
+
+        //! \brief Get the value.
+        /*!
+         *  \return A constant reference to the value.
+         */
+        const value_t& value() const { return mValue; }
+
+        //! \brief Get the error.
+        /*!
+         *  \return A constant reference to the error.
+         */
+        const error_t& error() const { return mError; }
+
+    private:
+        union {
+            value_t mValue; //!< The value, if any.
+            error_t mError; //!< The error, if any.
+        };
+
+        bool mHasValue; //!< Whether \c mValue is the active member.
+    };
+}
+
+#endif /* EXPECTED_H_INCLUDED */
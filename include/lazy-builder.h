@@ -0,0 +1,325 @@
+#ifndef LAZY_BUILDER_H_INCLUDED
+#define LAZY_BUILDER_H_INCLUDED
+
+#include <memory>
+#include <vector>
+#include <string>
+#include <stdexcept>
+
+#include <structural-index.h>
+#include <entity-decoder.h>
+#include <namespace-resolver.h>
+#include <mapped-file.h>
+
+namespace xml {
+    //! \brief A XML tree builder creating elements on first access.
+    /*!
+     *  This class builds a \c basic_document whose elements only hold the
+     *  position of their start tag in a \c basic_structural_index. The
+     *  attributes and the direct children of an element are created the
+     *  first time they are accessed, through \c begin(), \c size(),
+     *  \c front(), \c attributes() or any modification. The children of
+     *  the new elements are deferred in turn, so that only the parts of
+     *  the document that are visited are ever built.
+     *
+     *  The builder holds the index and the parsed buffer, and is kept
+     *  alive as the source of the document. Names, values and texts
+     *  reference the buffer. Elements must not outlive their document,
+     *  unless they are copied : a copy is fully built.
+     *
+     *  The structure of the document is checked when it is built, but
+     *  names and attributes are only checked when an element is loaded,
+     *  in which case a \c basic_exception is thrown by the function
+     *  accessing it. A document that is not fully built must not be read
+     *  concurrently.
+     *
+     *  The namespaces of an element are resolved when it is loaded, from
+     *  the declarations of its ancestors, so that \c namespace_id() loads
+     *  the element too. An element detached from its document before being
+     *  loaded keeps no namespace.
+     *
+     *  \sa xml::basic_structural_index
+     *  \sa xml::basic_builder
+     *
+     *  \tparam charT The type of character used in the XML document.
+     *                By default, char and wchar_t are supported.
+     */
+    template <typename charT>
+    class basic_lazy_builder : public basic_parent_node<charT>::loader_t {
+    public:
+        //! \name Member types
+        //!@{
+        typedef          basic_structural_index<charT> index_t;         //!< The index type.
+        typedef typename index_t::builder_t            builder_t;       //!< The builder type.
+        typedef typename index_t::reader_t             reader_t;        //!< The reader type.
+        typedef typename index_t::token_t              token_t;         //!< The token type.
+        typedef typename index_t::view_t               view_t;          //!< The type of names and values.
+        typedef typename index_t::const_pointer_t      const_pointer_t; //!< Pointer to a constant character.
+        typedef typename index_t::scanner_t            scanner_t;       //!< The scanner type.
+        typedef          basic_entity_decoder<charT>   decoder_t;       //!< The reference decoder type.
+        typedef typename builder_t::parse_error_t      parse_error_t;   //!< The parse error type.
+        typedef typename builder_t::exception_t        exception_t;     //!< The type of exception thrown on parse errors.
+
+        typedef typename builder_t::document_t        document_t;        //!< The document type.
+        typedef typename builder_t::string_t          string_t;          //!< The string type.
+        typedef typename builder_t::string_ref_t      string_ref_t;      //!< The type of string stored in nodes.
+        typedef typename builder_t::element_t         element_t;         //!< The element type.
+        typedef typename element_t::element_pointer_t element_pointer_t; //!< Pointer to \c element_t.
+
+        typedef          basic_parent_node<charT>         parent_t;           //!< The parent node type.
+        typedef typename parent_t::parent_reference_t     parent_reference_t; //!< Reference to \c parent_t.
+        typedef typename parent_t::loader_t               loader_t;           //!< The loader type.
+        typedef typename parent_t::node_interface_t       node_interface_t;   //!< The base type of nodes.
+
+        typedef basic_namespace_resolver<charT> resolver_t; //!< The namespace resolver type.
+
+        //!@}
+
+        //! \brief Destructor.
+        /*!
+         *  This destructor does nothing.
+         */
+        virtual ~basic_lazy_builder()
+        {}
+
+        //! \brief Create the attributes and the children of an element.
+        /*!
+         *  \param [in] parent   The element to fill.
+         *  \param [in] position The index of its start tag.
+         *
+         *  \throw exception_t If the element is not well-formed.
+         */
+        virtual void load(parent_reference_t parent, size_t position) const
+        {
+            element_t& element = static_cast<element_t&>(parent);
+            reader_t   reader(mIndex.data(), mIndex.data(), reader_t::parse_fragment);
+
+            open(reader, position);
+
+            token_t token = reader.next();
+
+            for (; token == reader_t::attribute; token = reader.next())
+                element.attributes().emplace(string_ref_t(reader.name()), decode(reader.value(), position));
+
+            if (token == reader_t::error)
+                raise(reader, position);
+
+            resolve(element, position);
+
+            const size_t last = mIndex.last_child(position);
+
+            if (mIndex.next(position) != position + 1 && mIndex.name(last) != mIndex.name(position))
+                raise("malformed XML element", reader_t::mismatched_tag, mIndex[last].first);
+
+            for (size_t i = mIndex.first_child(position); i < last; i = mIndex.next(i)) {
+                const view_t view = mIndex.view(i);
+
+                switch (mIndex[i].kind) {
+                case reader_t::start_element:
+                    open(reader, i);
+                    loader_t::defer(
+                        *static_cast<element_pointer_t>(&*element.emplace_element_back(string_ref_t(reader.name()))),
+                        this, i);
+                    break;
+
+                case reader_t::text:
+                    element.emplace_text_back(decode(view, i));
+                    break;
+
+                case reader_t::cdata:
+                    element.emplace_text_back(string_ref_t(view.substr(9, view.size() - 12)));
+                    break;
+
+                default:
+                    break;
+                }
+            }
+        }
+
+        //! \brief Parse a document.
+        /*!
+         *  Only the structure of the document and its root element are read.
+         *
+         *  \param [in] first A pointer to the first character of the document.
+         *  \param [in] last  A pointer past the last character of the document,
+         *                    which must outlive the document.
+         *
+         *  \throw exception_t If the structure of the document or its prolog
+         *                     is not well-formed.
+         *
+         *  \return The document.
+         */
+        static document_t parse(const_pointer_t first, const_pointer_t last)
+        {
+            return build(std::shared_ptr<basic_lazy_builder>(new basic_lazy_builder(first, last, nullptr)));
+        }
+
+        //! \brief Load a document from a file.
+        /*!
+         *  The file is mapped in memory and kept alive with the builder.
+         *  It holds characters of type \c charT in native byte order.
+         *
+         *  \param [in] path The path of the file.
+         *
+         *  \throw std::runtime_error If the file cannot be mapped, or if the
+         *                            structure of the document or its prolog
+         *                            is not well-formed.
+         *
+         *  \return The document.
+         */
+        static document_t load(const std::string& path)
+        {
+            std::shared_ptr<const mapped_file> file = std::make_shared<const mapped_file>(path);
+
+            const_pointer_t first = static_cast<const_pointer_t>(file->data());
+            const_pointer_t last  = first + file->size() / sizeof(charT);
+
+            return build(std::shared_ptr<basic_lazy_builder>(new basic_lazy_builder(first, last, std::move(file))));
+        }
+
+    private:
+        //! \brief Constructor.
+        /*!
+         *  Builds the index of a document.
+         *
+         *  \param [in] first A pointer to the first character of the document.
+         *  \param [in] last  A pointer past the last character of the document.
+         *  \param [in] file  The mapped file holding the document, if any.
+         */
+        basic_lazy_builder(const_pointer_t first, const_pointer_t last, std::shared_ptr<const mapped_file> file)
+        :
+            mFile(std::move(file)),
+            mIndex(first, last, mFile)
+        {}
+
+        //! \brief Build a document with a deferred root element.
+        /*!
+         *  \param [in] builder The lazy builder, which becomes the source
+         *                      of the document.
+         *
+         *  \return The document.
+         */
+        static document_t build(std::shared_ptr<basic_lazy_builder> builder)
+        {
+            const index_t& index = builder->mIndex;
+            builder_t prolog(true);
+            size_t where = 0;
+
+            if (index.replay(prolog, 0, index.root(), &where) != reader_t::end_document)
+                builder->raise(prolog.error() ? prolog.error() : "malformed XML document", prolog.error_code(), where);
+
+            reader_t reader(index.data(), index.data(), reader_t::parse_fragment);
+
+            builder->open(reader, index.root());
+            prolog.start_element(reader.name());
+
+            document_t document = prolog.release();
+
+            loader_t::defer(document.root(), builder.get(), index.root());
+            document.source(std::move(builder));
+
+            return document;
+        }
+
+        //! \brief Read the name of an element.
+        /*!
+         *  \param [out] reader   The reader, left on the \c start_element token.
+         *  \param [in]  position The index of the start tag.
+         *
+         *  \throw exception_t If the name is not valid.
+         */
+        void open(reader_t& reader, size_t position) const
+        {
+            reader.reset(mIndex.data() + mIndex[position].first, mIndex.data() + mIndex[position].last, reader_t::parse_fragment);
+
+            if (reader.next() != reader_t::start_element)
+                raise(reader, position);
+        }
+
+        //! \brief Resolve the namespaces of an element being loaded.
+        /*!
+         *  The declarations of its ancestors, which are loaded, are bound
+         *  first.
+         *
+         *  \param [in] element  The element, whose attributes are stored.
+         *  \param [in] position The index of its start tag.
+         *
+         *  \throw exception_t If the namespaces cannot be resolved.
+         */
+        void resolve(element_t& element, size_t position) const
+        {
+            std::vector<element_pointer_t> ancestors;
+            element_pointer_t               it = &element;
+
+            while (it->has_parent() && it->parent().kind() == node_interface_t::element_kind) {
+                it = &static_cast<element_t&>(it->parent());
+                ancestors.push_back(it);
+            }
+
+            if (!it->has_parent() || it->parent().kind() != node_interface_t::document_kind)
+                return;
+
+            resolver_t resolver(static_cast<document_t&>(it->parent()).namespaces());
+
+            for (size_t i = ancestors.size(); i > 0; --i)
+                resolver.enter(*ancestors[i - 1]);
+
+            if (!resolver.resolve(element))
+                raise(resolver.error(), reader_t::invalid_namespace, mIndex[position].first);
+        }
+
+        //! \brief Decode the references of a value.
+        /*!
+         *  \param [in] value    The value to decode.
+         *  \param [in] position The index of the entry holding the value.
+         *
+         *  \throw exception_t If a reference is malformed.
+         *
+         *  \return The decoded value, referencing \c value if it holds no
+         *          reference.
+         */
+        string_ref_t decode(const view_t& value, size_t position) const
+        {
+            string_ref_t decoded;
+
+            if (!decoder_t::decode(value, decoded, true))
+                raise("malformed XML element", reader_t::invalid_reference, mIndex[position].first);
+
+            return decoded;
+        }
+
+        //! \brief Throw an exception describing an error in a tag.
+        /*!
+         *  \param [in] reader   The reader that stopped.
+         *  \param [in] position The index of the tag.
+         *
+         *  \throw exception_t Always.
+         */
+        void raise(const reader_t& reader, size_t position) const
+        {
+            raise("malformed XML element", reader.error_code(), mIndex[position].first + reader.offset());
+        }
+
+        //! \brief Throw an exception describing an error.
+        /*!
+         *  \param [in] what   A description of the error.
+         *  \param [in] code   The error code.
+         *  \param [in] offset The offset of the faulty character.
+         *
+         *  \throw exception_t Always.
+         */
+        void raise(const char* what, typename reader_t::error_t code, size_t offset) const
+        {
+            throw exception_t(parse_error_t(what, code, offset), mIndex.data(), mFile);
+        }
+
+        std::shared_ptr<const mapped_file> mFile; //!< The mapped file, if any.
+
+        index_t mIndex; //!< The index of the document.
+    };
+
+    typedef basic_lazy_builder<char>    lazy_builder;  //!< A specialized \c basic_lazy_builder for char.
+    typedef basic_lazy_builder<wchar_t> wlazy_builder; //!< A specialized \c basic_lazy_builder for wchar_t.
+}
+
+#endif /* LAZY_BUILDER_H_INCLUDED */
@@ -0,0 +1,56 @@
+#ifndef MAPPED_FILE_H_INCLUDED
+#define MAPPED_FILE_H_INCLUDED
+
+#include <string>
+#include <cstddef>
+
+namespace xml {
+    //! \brief A read-only memory mapping of a file.
+    /*!
+     *  This class maps the whole content of a file in memory, so that it
+     *  can be parsed without being copied. The mapping is released when
+     *  the object is destroyed.
+     *
+     *  A \c basic_document loaded from a file holds its \c mapped_file,
+     *  and its names and values reference the mapped characters.
+     */
+    class mapped_file {
+    public:
+        //! \brief Constructor.
+        /*!
+         *  Maps the file at \c path.
+         *
+         *  \param [in] path The path of the file to map.
+         *
+         *  \throw std::runtime_error If the file cannot be opened or mapped.
+         */
+        explicit mapped_file(const std::string& path);
+
+        mapped_file(const mapped_file&) = delete;
+        mapped_file& operator=(const mapped_file&) = delete;
+
+        //! \brief Destructor.
+        /*!
+         *  Releases the mapping.
+         */
+        ~mapped_file();
+
+        //! \brief Get the content of the file.
+        /*!
+         *  \return A pointer to the first byte of the file.
+         */
+        const void* data() const noexcept { return mData; }
+
+        //! \brief Get the size of the file.
+        /*!
+         *  \return The number of bytes of the file.
+         */
+        size_t size() const noexcept { return mSize; }
+
+    private:
+        void*  mData; //!< The address of the mapping.
+        size_t mSize; //!< The size of the mapping.
+    };
+}
+
+#endif /* MAPPED_FILE_H_INCLUDED */
@@ -0,0 +1,227 @@
+#ifndef NAMESPACE_RESOLVER_H_INCLUDED
+#define NAMESPACE_RESOLVER_H_INCLUDED
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+#include <element.h>
+#include <namespace-table.h>
+
+namespace xml {
+    //! \brief Resolves the namespaces of elements built without them.
+    /*!
+     *  The builders that do not see the start tags of a document in order,
+     *  or that create elements out of a fixed scope, build elements whose
+     *  attributes are already stored. This class binds the namespace
+     *  declarations of such elements, and gives them and their attributes
+     *  the identifier of their namespace, with the same rules as
+     *  \c basic_builder. An element must be resolved, or entered if it is
+     *  already resolved, after all of its ancestors, and left before its
+     *  next sibling.
+     *
+     *  Identifiers are interned in the order the declarations are found,
+     *  which is the order of the attribute names within a start tag.
+     *
+     *  \sa xml::basic_builder
+     *  \sa xml::basic_namespace_scope
+     *
+     *  \tparam charT The type of character used in the elements.
+     *                By default, char and wchar_t are supported.
+     */
+    template <typename charT>
+    class basic_namespace_resolver {
+    public:
+        //! \name Member types
+        //!@{
+        typedef basic_element<charT>         element_t;   //!< The element type.
+        typedef basic_attribute<charT>       attribute_t; //!< The attribute type.
+        typedef basic_string_view<charT>     view_t;      //!< The type of names.
+        typedef basic_namespace_table<charT> table_t;     //!< The namespace table type.
+        typedef basic_namespace_scope<charT> scope_t;     //!< The type of the prefixes in scope.
+
+        //!@}
+
+        //! \brief Constructor.
+        /*!
+         *  \param [in] table The namespace table of the document, which must
+         *                    outlive the resolver.
+         */
+        explicit basic_namespace_resolver(table_t& table)
+        :
+            mTable(table),
+            mScope(),
+            mExpanded(),
+            mError(nullptr)
+        {}
+
+        //! \brief Open the scope of an element and resolve its namespaces.
+        /*!
+         *  The scope is opened even if the element cannot be resolved.
+         *
+         *  \param [in] element The element, whose attributes have no namespace.
+         *
+         *  \return \c false if a declaration is forbidden, if a prefix is not
+         *          bound, or if two attributes have the same namespace and
+         *          local name.
+         */
+        bool resolve(element_t& element)
+        {
+            bool prefixed = false;
+
+            mScope.push();
+
+            for (const attribute_t& attribute : element.attributes()) {
+                const view_t       name  = attribute.name().view();
+                const charT* const colon = std::find(name.begin(), name.end(), charT(':'));
+                const view_t       prefix(name.begin(), colon);
+
+                if (colon == name.end() && !name.equals("xmlns"))
+                    continue;
+
+                if (colon != name.end() && !prefix.equals("xmlns")) {
+                    prefixed = true;
+                    continue;
+                }
+
+                if (!declare(colon == name.end() ? view_t() : view_t(colon + 1, name.end()), attribute.value().view()))
+                    return false;
+
+                assign(attribute, table_t::xmlns_namespace);
+            }
+
+            const namespace_id_t id = lookup(element.name().view());
+
+            if (id == table_t::npos || id == table_t::xmlns_namespace)
+                return fail("unbound namespace prefix");
+
+            element.namespace_id() = id;
+
+            if (!prefixed)
+                return true;
+
+            mExpanded.clear();
+
+            for (const attribute_t& attribute : element.attributes()) {
+                const view_t name = attribute.name().view();
+
+                if (attribute.namespace_id() == table_t::xmlns_namespace || std::find(name.begin(), name.end(), charT(':')) == name.end())
+                    continue;
+
+                const namespace_id_t ns = lookup(name);
+
+                if (ns == table_t::npos)
+                    return fail("unbound namespace prefix");
+
+                assign(attribute, ns);
+                mExpanded.emplace_back(ns, attribute.local_name());
+            }
+
+            if (mExpanded.size() == 1)
+                return true;
+
+            std::sort(mExpanded.begin(), mExpanded.end());
+
+            if (std::adjacent_find(mExpanded.begin(), mExpanded.end()) != mExpanded.end())
+                return fail("duplicate namespaced attribute");
+
+            return true;
+        }
+
+        //! \brief Open the scope of an element whose namespaces are resolved.
+        /*!
+         *  \param [in] element The element, whose declarations are in the
+         *                      namespace table.
+         */
+        void enter(const element_t& element)
+        {
+            mScope.push();
+
+            for (const attribute_t& attribute : element.attributes()) {
+                if (attribute.namespace_id() != table_t::xmlns_namespace)
+                    continue;
+
+                const view_t       name  = attribute.name().view();
+                const charT* const colon = std::find(name.begin(), name.end(), charT(':'));
+
+                mScope.bind(colon == name.end() ? view_t() : view_t(colon + 1, name.end()), mTable.find(attribute.value().view()));
+            }
+        }
+
+        //! \brief Close the scope of the innermost element.
+        void leave()
+        {
+            mScope.pop();
+        }
+
+        //! \brief Get the error found by the resolver.
+        /*!
+         *  \return A description of the last error, or \c nullptr.
+         */
+        const char* error() const { return mError; }
+
+    private:
+        //! \brief Bind a declared prefix.
+        /*!
+         *  \param [in] prefix The declared prefix, or an empty view for the
+         *                     default namespace.
+         *  \param [in] uri    The namespace URI.
+         *
+         *  \return \c false if the declaration is forbidden.
+         */
+        bool declare(const view_t& prefix, const view_t& uri)
+        {
+            const namespace_id_t id = mTable.intern(uri);
+
+            if (prefix.equals("xmlns") || (!prefix.empty() && uri.empty()) ||
+                id == table_t::xmlns_namespace ||
+                prefix.equals("xml") != (id == table_t::xml_namespace))
+                return fail("invalid namespace declaration");
+
+            mScope.bind(prefix, id);
+
+            return true;
+        }
+
+        //! \brief Find the namespace bound to the prefix of a name.
+        namespace_id_t lookup(const view_t& name) const
+        {
+            const charT* const colon = std::find(name.begin(), name.end(), charT(':'));
+
+            return mScope.find(colon != name.end() ? view_t(name.begin(), colon) : view_t());
+        }
+
+        //! \brief Set the namespace of a stored attribute.
+        /*!
+         *  Attributes are ordered by name only, so that the namespace can be
+         *  changed in place.
+         */
+        static void assign(const attribute_t& attribute, namespace_id_t ns)
+        {
+            const_cast<attribute_t&>(attribute).namespace_id() = ns;
+        }
+
+        //! \brief Record an error.
+        /*!
+         *  \return \c false.
+         */
+        bool fail(const char* what)
+        {
+            mError = what;
+
+            return false;
+        }
+
+        table_t& mTable; //!< The namespace table of the document.
+        scope_t  mScope; //!< The prefixes in scope.
+
+        std::vector<std::pair<namespace_id_t, view_t> > mExpanded; //!< The expanded names of the prefixed attributes.
+
+        const char* mError; //!< A description of the last error.
+    };
+
+    typedef basic_namespace_resolver<char>    namespace_resolver;  //!< A specialized \c basic_namespace_resolver for char.
+    typedef basic_namespace_resolver<wchar_t> wnamespace_resolver; //!< A specialized \c basic_namespace_resolver for wchar_t.
+}
+
+#endif /* NAMESPACE_RESOLVER_H_INCLUDED */
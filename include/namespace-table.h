@@ -0,0 +1,342 @@
+#ifndef NAMESPACE_TABLE_H_INCLUDED
+#define NAMESPACE_TABLE_H_INCLUDED
+
+#include <deque>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+
+#include <string-view.h>
+
+namespace xml {
+    typedef uint32_t namespace_id_t; //!< The identifier of a namespace interned in a \c basic_namespace_table.
+
+    //! \brief The namespaces of a XML document.
+    /*!
+     *  This class interns the namespace URIs used in a document : each URI
+     *  is stored once, and identified by a small integer that elements and
+     *  attributes store next to their name. Comparing the namespaces of two
+     *  names of the same document is then an integer comparison.
+     *
+     *  The identifiers \c no_namespace, \c xml_namespace and
+     *  \c xmlns_namespace are reserved for the empty URI, the namespace
+     *  bound to the \c xml prefix and the namespace of the namespace
+     *  declarations. Identifiers are only meaningful in the table that
+     *  produced them.
+     *
+     *  \sa xml::basic_namespace_scope
+     *
+     *  \tparam charT The type of character used in the URIs.
+     *                By default, char and wchar_t are supported.
+     */
+    template <typename charT>
+    class basic_namespace_table {
+    public:
+        //! \name Member types
+        //!@{
+        typedef std::basic_string<charT>  string_t; //!< The type of stored URIs.
+        typedef basic_string_view<charT>  view_t;   //!< The type of URIs to intern.
+
+        typedef basic_namespace_table<charT> table_t;                 //!< The type of namespace table.
+        typedef const table_t&               table_const_reference_t; //!< Constant reference to \c table_t.
+        typedef table_t&&                    table_move_t;            //!< Move a \c table_t.
+
+        //!@}
+
+        //! The reserved namespace identifiers.
+        enum : namespace_id_t {
+            no_namespace    = 0,                //!< The identifier of names that have no namespace.
+            xml_namespace   = 1,                //!< The identifier of \c "http://www.w3.org/XML/1998/namespace".
+            xmlns_namespace = 2,                //!< The identifier of \c "http://www.w3.org/2000/xmlns/".
+            npos            = namespace_id_t(-1) //!< The identifier of an unknown namespace.
+        };
+
+        //! \brief Constructor.
+        /*!
+         *  Builds a table holding the reserved namespaces.
+         */
+        basic_namespace_table()
+        :
+            mUris(),
+            mIds()
+        {
+            intern(string_t());
+            intern(ascii("http://www.w3.org/XML/1998/namespace"));
+            intern(ascii("http://www.w3.org/2000/xmlns/"));
+        }
+
+        //! \brief Copy constructor.
+        /*!
+         *  The copy interns the same URIs, which keep their identifiers.
+         *
+         *  \param [in] rhs A constant reference to a \c table_t.
+         */
+        basic_namespace_table(table_const_reference_t rhs)
+        :
+            mUris(),
+            mIds()
+        {
+            for (const string_t& uri : rhs.mUris)
+                intern(uri);
+        }
+
+        //! \brief Move constructor.
+        /*!
+         *  Moving the stored URIs does not move their characters, so the
+         *  index keeps referencing them.
+         *
+         *  \param [in] rhs A rvalue reference to a \c table_t.
+         */
+        basic_namespace_table(table_move_t rhs) = default;
+
+        //! \brief Copy assignment operator.
+        /*!
+         *  \param [in] rhs A constant reference to a \c table_t.
+         *
+         *  \return A reference to this table.
+         */
+        table_t& operator=(table_const_reference_t rhs)
+        {
+            if (this != &rhs) {
+                mIds.clear();
+                mUris.clear();
+
+                for (const string_t& uri : rhs.mUris)
+                    intern(uri);
+            }
+
+            return *this;
+        }
+
+        //! \brief Move assignment operator.
+        /*!
+         *  \param [in] rhs A rvalue reference to a \c table_t.
+         *
+         *  \return A reference to this table.
+         */
+        table_t& operator=(table_move_t rhs) = default;
+
+        //! \brief Intern a namespace URI.
+        /*!
+         *  \param [in] uri The URI, which is copied the first time it is
+         *                  interned.
+         *
+         *  \return The identifier of \c uri.
+         */
+        namespace_id_t intern(const view_t& uri)
+        {
+            typename index_t::const_iterator it = mIds.find(uri);
+
+            if (it != mIds.end())
+                return it->second;
+
+            const namespace_id_t id = static_cast<namespace_id_t>(mUris.size());
+
+            mUris.push_back(uri.str());
+            mIds.emplace(view_t(mUris.back()), id);
+
+            return id;
+        }
+
+        //! \brief Find the identifier of a namespace URI.
+        /*!
+         *  \param [in] uri The URI to look for.
+         *
+         *  \return The identifier of \c uri, or \c npos if it has not been
+         *          interned.
+         */
+        namespace_id_t find(const view_t& uri) const
+        {
+            typename index_t::const_iterator it = mIds.find(uri);
+
+            return it != mIds.end() ? it->second : npos;
+        }
+
+        //! \brief Get a namespace URI.
+        /*!
+         *  \param [in] id The identifier of an interned namespace.
+         *
+         *  \return A constant reference to the URI identified by \c id.
+         */
+        const string_t& uri(namespace_id_t id) const { return mUris[id]; }
+
+        //! \brief Get the number of interned namespaces.
+        /*!
+         *  \return The number of interned namespaces, including the reserved ones.
+         */
+        size_t size() const { return mUris.size(); }
+
+    private:
+        typedef std::unordered_map<view_t, namespace_id_t, typename view_t::hash_t> index_t; //!< The type of the URI index.
+
+        //! \brief Widen an ASCII string.
+        static string_t ascii(const char* str)
+        {
+            string_t result;
+
+            while (*str != '\0')
+                result.push_back(static_cast<charT>(*str++));
+
+            return result;
+        }
+
+        std::deque<string_t> mUris; //!< The interned URIs, indexed by identifier. A deque never moves them.
+        index_t              mIds;  //!< The identifiers of the interned URIs.
+    };
+
+    //! \brief The namespace prefixes in scope while parsing.
+    /*!
+     *  This class binds prefixes to namespace identifiers in nested scopes,
+     *  one per open element. Each prefix maps to its innermost binding, so
+     *  a lookup is a single hash lookup whatever the depth ; closing a scope
+     *  restores the bindings it hid. The empty prefix stands for the default
+     *  namespace, whose innermost binding is kept aside so that unprefixed
+     *  names are resolved without hashing.
+     *
+     *  The prefixes \c xml and \c xmlns are always bound, and the default
+     *  namespace is initially bound to \c no_namespace. Prefixes are
+     *  referenced, not copied : they must outlive their scope.
+     *
+     *  \sa xml::basic_namespace_table
+     *
+     *  \tparam charT The type of character used in the prefixes.
+     *                By default, char and wchar_t are supported.
+     */
+    template <typename charT>
+    class basic_namespace_scope {
+    public:
+        //! \name Member types
+        //!@{
+        typedef basic_namespace_table<charT> table_t; //!< The namespace table type.
+        typedef basic_string_view<charT>     view_t;  //!< The type of prefixes.
+
+        //!@}
+
+        //! \brief Constructor.
+        /*!
+         *  Builds a scope holding the predefined bindings.
+         */
+        basic_namespace_scope()
+        :
+            mBindings(),
+            mMarks(),
+            mCurrent(),
+            mDefault(npos)
+        {
+            static const charT xml[]   = { 'x', 'm', 'l' };
+            static const charT xmlns[] = { 'x', 'm', 'l', 'n', 's' };
+
+            bind(view_t(), table_t::no_namespace);
+            bind(view_t(xml, 3), table_t::xml_namespace);
+            bind(view_t(xmlns, 5), table_t::xmlns_namespace);
+        }
+
+        //! \brief Open a scope.
+        /*!
+         *  The bindings made until the matching \c pop() are undone by it.
+         */
+        void push()
+        {
+            mMarks.push_back(mBindings.size());
+        }
+
+        //! \brief Close the innermost scope.
+        /*!
+         *  Calling this function without a matching \c push() causes
+         *  undefined behaviour.
+         */
+        void pop()
+        {
+            const size_t mark = mMarks.back();
+
+            mMarks.pop_back();
+
+            while (mBindings.size() > mark) {
+                const binding_t& binding = mBindings.back();
+
+                if (binding.prefix.empty())
+                    mDefault = binding.previous;
+                else if (binding.previous == npos)
+                    mCurrent.erase(binding.prefix);
+                else
+                    mCurrent[binding.prefix] = binding.previous;
+
+                mBindings.pop_back();
+            }
+        }
+
+        //! \brief Bind a prefix in the innermost scope.
+        /*!
+         *  \param [in] prefix The prefix, or an empty view for the default
+         *                     namespace.
+         *  \param [in] id     The identifier of the namespace.
+         */
+        void bind(const view_t& prefix, namespace_id_t id)
+        {
+            if (prefix.empty()) {
+                mBindings.push_back(binding_t { prefix, id, mDefault });
+                mDefault = mBindings.size() - 1;
+
+                return;
+            }
+
+            std::pair<typename index_t::iterator, bool> inserted = mCurrent.emplace(prefix, mBindings.size());
+
+            mBindings.push_back(binding_t { prefix, id, inserted.second ? npos : inserted.first->second });
+
+            inserted.first->second = mBindings.size() - 1;
+        }
+
+        //! \brief Find the namespace bound to a prefix.
+        /*!
+         *  \param [in] prefix The prefix, or an empty view for the default
+         *                     namespace.
+         *
+         *  \return The identifier of the namespace, or \c table_t::npos if
+         *          \c prefix is not bound.
+         */
+        namespace_id_t find(const view_t& prefix) const
+        {
+            if (prefix.empty())
+                return mBindings[mDefault].id;
+
+            typename index_t::const_iterator it = mCurrent.find(prefix);
+
+            return it != mCurrent.end() ? mBindings[it->second].id : table_t::npos;
+        }
+
+        //! \brief Get the depth of the scope.
+        /*!
+         *  \return The number of open scopes.
+         */
+        size_t depth() const { return mMarks.size(); }
+
+    private:
+        enum : size_t { npos = size_t(-1) }; //!< No previous binding.
+
+        //! \brief A binding of a prefix.
+        class binding_t {
+        public:
+            view_t         prefix;   //!< The bound prefix.
+            namespace_id_t id;       //!< The namespace the prefix is bound to.
+            size_t         previous; //!< The binding hidden by this one, or \c npos.
+        };
+
+        typedef std::unordered_map<view_t, size_t, typename view_t::hash_t> index_t; //!< The type of the prefix index.
+
+        std::vector<binding_t> mBindings; //!< The bindings of all open scopes, innermost last.
+        std::vector<size_t>    mMarks;    //!< The number of bindings when each scope was opened.
+        index_t                mCurrent;  //!< The innermost binding of each bound prefix.
+        size_t                 mDefault;  //!< The innermost binding of the default namespace.
+    };
+
+    typedef basic_namespace_table<char>    namespace_table;  //!< A specialized \c basic_namespace_table for char.
+    typedef basic_namespace_table<wchar_t> wnamespace_table; //!< A specialized \c basic_namespace_table for wchar_t.
+
+    typedef basic_namespace_scope<char>    namespace_scope;  //!< A specialized \c basic_namespace_scope for char.
+    typedef basic_namespace_scope<wchar_t> wnamespace_scope; //!< A specialized \c basic_namespace_scope for wchar_t.
+}
+
+#endif /* NAMESPACE_TABLE_H_INCLUDED */
@@ -27,6 +27,14 @@ namespace xml {
 
         //!@}
 
+        //! The kinds of nodes, which can be told apart without building their type.
+        enum kind_t {
+            other_kind,    //!< A node of another kind.
+            document_kind, //!< A \c basic_document.
+            element_kind,  //!< A \c basic_element.
+            text_kind      //!< A \c basic_text.
+        };
+
         //! \brief Default constructor
         /*!
          *  This constructor does nothing.
@@ -69,6 +77,15 @@ namespace xml {
          */
         virtual type_t type() const = 0;
 
+        //! \brief Returns the kind of a node.
+        /*!
+         *  Unlike \c type(), this function does not allocate memory, so that
+         *  the nodes can be told apart while walking large trees.
+         *
+         *  \return The kind of this node.
+         */
+        virtual kind_t kind() const { return other_kind; }
+
     protected:
 
         //! \brief Convert a standard string to a node type.
@@ -78,6 +78,13 @@ namespace xml {
         virtual ~basic_node()
         {}
 
+    protected:
+        //! \brief Forward a change to the parent of the node.
+        virtual void modified()
+        {
+            if (this->mParent != nullptr)
+                this->mParent->touch();
+        }
     };
 
     typedef basic_node<char>    node;  //!< A specialized \c basic_node for char.
@@ -0,0 +1,731 @@
+#ifndef PARALLEL_BUILDER_H_INCLUDED
+#define PARALLEL_BUILDER_H_INCLUDED
+
+#include <memory>
+#include <vector>
+#include <string>
+#include <thread>
+#include <utility>
+#include <algorithm>
+#include <system_error>
+
+#include <builder.h>
+#include <namespace-resolver.h>
+
+namespace xml {
+    //! \brief A XML tree builder parsing a single document on several threads.
+    /*!
+     *  The document is split at \c '<' characters into one chunk per thread.
+     *  Each chunk is parsed as a fragment on its own thread, with the
+     *  nesting of elements left unresolved : end tags closing elements
+     *  opened in a previous chunk are recorded, and elements left open at
+     *  the end of a chunk keep receiving the content of the next chunks.
+     *  The partial subtrees are then stitched together in order, without
+     *  copying any node.
+     *
+     *  A split is speculative : it may land inside a comment, a CDATA
+     *  section, a processing instruction or a document type declaration.
+     *  The chunk preceding such a split does not end on a token boundary,
+     *  so it is parsed again from its beginning until the next split that
+     *  is reached on a token boundary, and the chunks in between are
+     *  discarded. Any other error makes the document be parsed again by a
+     *  \c basic_builder, which reports it.
+     *
+     *  A document declared as UTF-8 is validated by the threads, each of
+     *  them checking the chunk it parsed : since chunks start at a \c '<',
+     *  no sequence is split.
+     *
+     *  The flags of the reader are given to every chunk, and to the
+     *  \c basic_builder parsing the document again. Since a chunk does not
+     *  know the \c xml:space attributes of the elements opened before it,
+     *  the texts made of white spaces are dropped once the document is
+     *  stitched when \c reader_t::parse_strip_whitespace is given.
+     *
+     *  Namespaces are resolved once the document is stitched, with a
+     *  \c basic_namespace_resolver walking the tree, unless no chunk holds
+     *  a prefixed name or a default namespace declaration. Namespace
+     *  identifiers may then be numbered differently than by a
+     *  \c basic_builder, since the declarations of a start tag are interned
+     *  in the order of their names.
+     *
+     *  \sa xml::basic_builder
+     *  \sa xml::basic_namespace_resolver
+     *
+     *  \tparam charT The type of character used in the XML document.
+     *                By default, char and wchar_t are supported.
+     */
+    template <typename charT>
+    class basic_parallel_builder {
+    public:
+        //! \name Member types
+        //!@{
+        typedef          basic_builder<charT>         builder_t;         //!< The sequential builder type.
+        typedef typename builder_t::parser_t          parser_t;          //!< The parser type.
+        typedef typename builder_t::reader_t          reader_t;          //!< The reader type.
+        typedef typename builder_t::token_t           token_t;           //!< The token type.
+        typedef typename builder_t::view_t            view_t;            //!< The type of names and values.
+        typedef typename builder_t::const_pointer_t   const_pointer_t;   //!< Pointer to a constant character.
+        typedef typename builder_t::scanner_t         scanner_t;         //!< The scanner type.
+        typedef typename builder_t::decoder_t         decoder_t;         //!< The reference decoder type.
+        typedef typename builder_t::document_t        document_t;        //!< The document type.
+        typedef typename builder_t::exception_t       exception_t;       //!< The type of exception thrown on parse errors.
+        typedef typename builder_t::string_t          string_t;          //!< The string type.
+        typedef typename builder_t::string_ref_t      string_ref_t;      //!< The type of string stored in nodes.
+        typedef typename builder_t::element_t         element_t;         //!< The element type.
+        typedef typename builder_t::element_pointer_t element_pointer_t; //!< Pointer to \c element_t.
+        typedef typename element_t::child_t           child_t;           //!< The type of nodes of the tree.
+        typedef typename element_t::node_interface_t  node_interface_t;  //!< The base type of nodes.
+        typedef          basic_text<charT>            text_t;            //!< The text type.
+
+        typedef basic_namespace_resolver<charT> resolver_t; //!< The namespace resolver type.
+
+        //!@}
+
+        //! \brief Parse a document.
+        /*!
+         *  \param [in] first     A pointer to the first character of the document.
+         *  \param [in] last      A pointer past the last character of the document.
+         *  \param [in] threads   The number of threads to use, or \c 0 to use
+         *                        one thread per hardware core.
+         *  \param [in] reference Whether the nodes reference the parsed buffer,
+         *                        which must then outlive the document.
+         *  \param [in] flags     A combination of \c reader_t::flags_t, such as
+         *                        \c reader_t::parse_trusted.
+         *
+         *  \throw std::runtime_error If the document is not well-formed.
+         *
+         *  \return The parsed document.
+         */
+        static document_t parse(const_pointer_t first, const_pointer_t last, size_t threads = 0, bool reference = false,
+                                unsigned flags = reader_t::parse_default)
+        {
+            builder_t builder(reference, flags);
+            reader_t  reader(first, last, flags | reader_t::parse_unchecked_encoding);
+            bool      validating = false;
+
+            token_t token;
+
+            while ((token = reader.next()) != reader_t::start_element) {
+                if (token == reader_t::attribute
+                        ? !builder.declaration(reader.name(), reader.value())
+                        : token == reader_t::error || token == reader_t::end_document)
+                    return builder_t::parse(first, last, reference, flags);
+
+                if (token == reader_t::attribute && reader.name().equals("encoding"))
+                    validating = sizeof(charT) == 1 && utf8::is_utf8(reader.value().begin(), reader.value().end()) &&
+                                 (flags & (reader_t::parse_unchecked_encoding | reader_t::parse_trusted)) == 0;
+            }
+
+            const_pointer_t root = reader.data() + reader.offset();
+
+            if (validating && !valid(first, root))
+                return builder_t::parse(first, last, reference, flags);
+
+            const std::vector<const_pointer_t> splits = split(root, last, threads);
+            std::vector<fragment> fragments(splits.size(), fragment(reference, validating, flags));
+            std::vector<std::thread> workers;
+
+            for (size_t i = 1; i < splits.size(); ++i) {
+                try {
+                    workers.push_back(std::thread([&fragments, &splits, i, last]() {
+                        fragments[i].parse(splits[i], end(splits, i, last));
+                    }));
+                } catch (const std::system_error&) {
+                    fragments[i].parse(splits[i], end(splits, i, last));
+                }
+            }
+
+            fragments[0].parse(splits[0], end(splits, 0, last));
+
+            for (std::thread& worker : workers)
+                worker.join();
+
+            stitcher tree(builder);
+            bool     namespaced = false;
+
+            for (size_t i = 0; i < splits.size(); ) {
+                if (fragments[i].complete()) {
+                    if (!tree.stitch(fragments[i]))
+                        return builder_t::parse(first, last, reference, flags);
+
+                    namespaced = namespaced || fragments[i].namespaced();
+                    ++i;
+                    continue;
+                }
+
+                fragment repaired(reference, validating, flags);
+
+                repaired.parse(splits[i], last, splits.data() + i + 1, splits.data() + splits.size());
+
+                if (!repaired.complete() || !tree.stitch(repaired))
+                    return builder_t::parse(first, last, reference, flags);
+
+                namespaced = namespaced || repaired.namespaced();
+
+                i = repaired.resumed() - splits.data();
+            }
+
+            if (!tree.complete())
+                return builder_t::parse(first, last, reference, flags);
+
+            document_t document = tree.release();
+
+            if (namespaced && (flags & reader_t::parse_no_namespaces) == 0 && !resolve(document))
+                return builder_t::parse(first, last, reference, flags);
+
+            if (flags & reader_t::parse_strip_whitespace)
+                strip(document);
+
+            return document;
+        }
+
+        //! \brief Parse a document.
+        /*!
+         *  \param [in] str     The content of the document.
+         *  \param [in] threads The number of threads to use, or \c 0 to use
+         *                      one thread per hardware core.
+         *  \param [in] flags   A combination of \c reader_t::flags_t.
+         *
+         *  \throw std::runtime_error If the document is not well-formed.
+         *
+         *  \return The parsed document.
+         */
+        static document_t parse(const string_t& str, size_t threads = 0, unsigned flags = reader_t::parse_default)
+        {
+            return parse(str.data(), str.data() + str.size(), threads, false, flags);
+        }
+
+        //! \brief Load a document from a file.
+        /*!
+         *  The file is mapped in memory and becomes the source of the
+         *  document, as with \c basic_builder::load().
+         *
+         *  \param [in] path    The path of the file.
+         *  \param [in] threads The number of threads to use, or \c 0 to use
+         *                      one thread per hardware core.
+         *  \param [in] flags   A combination of \c reader_t::flags_t.
+         *
+         *  \throw std::runtime_error If the file cannot be mapped or if the
+         *                            document is not well-formed.
+         *
+         *  \return The loaded document.
+         */
+        static document_t load(const std::string& path, size_t threads = 0, unsigned flags = reader_t::parse_default)
+        {
+            std::shared_ptr<const mapped_file> file = std::make_shared<const mapped_file>(path);
+
+            const_pointer_t first = static_cast<const_pointer_t>(file->data());
+            const_pointer_t last  = first + file->size() / sizeof(charT);
+
+            try {
+                document_t document = parse(first, last, threads, true, flags);
+
+                document.source(std::move(file));
+
+                return document;
+            } catch (const exception_t& e) {
+                throw exception_t(e.error(), first, file);
+            }
+        }
+
+    private:
+        //! The minimal number of characters parsed by a thread.
+        static const size_t sMinChunkSize = 1 << 16;
+
+        //! \brief The partial subtrees of a chunk.
+        /*!
+         *  The top level nodes of a chunk are children of a nameless element.
+         *  The end tags found at the top level are recorded along with the
+         *  number of top level nodes preceding them, and the elements still
+         *  open at the end of the chunk are kept on a stack.
+         */
+        class fragment : public basic_sax_handler<charT> {
+        public:
+            //! \brief Constructor.
+            /*!
+             *  \param [in] reference  Whether the nodes reference the parsed buffer.
+             *  \param [in] validating Whether the chunk is validated as UTF-8.
+             *  \param [in] flags      The flags of the reader.
+             */
+            fragment(bool reference, bool validating, unsigned flags)
+            :
+                mRoot(string_ref_t()),
+                mStack(),
+                mCloses(),
+                mFlags(flags),
+                mReference(reference),
+                mValidating(validating),
+                mComplete(false),
+                mRejected(false),
+                mNamespaced(false),
+                mSplit(nullptr),
+                mSplitEnd(nullptr),
+                mReader(nullptr)
+            {}
+
+            //! \brief Copy constructor.
+            /*!
+             *  Only an empty fragment can be copied.
+             */
+            fragment(const fragment& rhs)
+            :
+                fragment(rhs.mReference, rhs.mValidating, rhs.mFlags)
+            {}
+
+            //! \brief Parse a chunk.
+            /*!
+             *  When a range of splits is given, the parsing stops at the first
+             *  of them reached on a token boundary.
+             *
+             *  \param [in] first    A pointer to the first character of the chunk.
+             *  \param [in] last     A pointer past the last character of the chunk.
+             *  \param [in] split    A pointer to the first split to stop at.
+             *  \param [in] splitEnd A pointer past the last split to stop at.
+             */
+            void parse(const_pointer_t first, const_pointer_t last,
+                       const const_pointer_t* split = nullptr, const const_pointer_t* splitEnd = nullptr)
+            {
+                parser_t parser(first, last, mFlags | reader_t::parse_fragment);
+
+                mStack.assign(1, &mRoot);
+                mSplit    = split;
+                mSplitEnd = splitEnd;
+                mReader   = &parser.reader();
+
+                try {
+                    const token_t token = parser.parse(*this);
+
+                    if (token == reader_t::end_document) {
+                        mComplete = true;
+                        mSplit    = mSplitEnd;
+                    } else {
+                        mComplete = token != reader_t::error && !mRejected &&
+                                    mSplit != mSplitEnd && *mSplit == mReader->position();
+                    }
+                } catch (...) {
+                    mComplete = false;
+                }
+
+                if (mComplete && mValidating)
+                    mComplete = valid(first, mSplit != mSplitEnd ? *mSplit : last);
+
+                mReader = nullptr;
+            }
+
+            //! \brief Whether the chunk has been parsed up to its end.
+            bool complete() const { return mComplete; }
+
+            //! \brief Get the split the parsing stopped at.
+            /*!
+             *  \return A pointer to the split, or past the last split if the
+             *          parsing reached the end of the chunk.
+             */
+            const const_pointer_t* resumed() const { return mSplit; }
+
+            //! \brief Whether the chunk holds a prefixed name or a default namespace declaration.
+            bool namespaced() const { return mNamespaced; }
+
+            //! \brief Create an element.
+            bool start_element(const view_t& name)
+            {
+                mNamespaced = mNamespaced || scanner_t::find(name.begin(), name.end(), ':') != name.end();
+
+                mStack.push_back(static_cast<element_pointer_t>(
+                    &*mStack.back()->emplace_element_back(store(name))));
+
+                return true;
+            }
+
+            //! \brief Add an attribute to the current element.
+            bool attribute(const view_t& name, const view_t& value)
+            {
+                string_ref_t decoded;
+
+                if (!decoder_t::decode(value, decoded, mReference))
+                    return reject();
+
+                mNamespaced = mNamespaced || name.equals("xmlns") || scanner_t::find(name.begin(), name.end(), ':') != name.end();
+
+                mStack.back()->attributes().emplace(store(name), std::move(decoded));
+
+                return true;
+            }
+
+            //! \brief Close the current element, or record an end tag.
+            bool end_element(const view_t& name)
+            {
+                if (mStack.size() > 1)
+                    mStack.pop_back();
+                else
+                    mCloses.push_back(std::make_pair(mRoot.size(), name));
+
+                return proceed();
+            }
+
+            //! \brief Add a text node to the current element.
+            /*!
+             *  When white spaces are stripped, a text made of white spaces
+             *  once decoded but not before is rejected : it is kept by a
+             *  \c basic_builder, while the stitched document drops it.
+             */
+            bool text(const view_t& value)
+            {
+                string_ref_t decoded;
+
+                if (!decoder_t::decode(value, decoded, mReference))
+                    return reject();
+
+                if (stripping() && !scanner_t::all_whitespace(value.begin(), value.end()) &&
+                        scanner_t::all_whitespace(decoded.begin(), decoded.end()))
+                    return reject();
+
+                mStack.back()->emplace_text_back(std::move(decoded));
+
+                return proceed();
+            }
+
+            //! \brief Add a CDATA section as a text node to the current element.
+            /*!
+             *  When white spaces are stripped, a section made of white
+             *  spaces is rejected, since a \c basic_builder keeps it.
+             */
+            bool cdata(const view_t& value)
+            {
+                if (stripping() && scanner_t::all_whitespace(value.begin(), value.end()))
+                    return reject();
+
+                mStack.back()->emplace_text_back(store(value));
+
+                return proceed();
+            }
+
+            //! \brief Skip a comment.
+            bool comment(const view_t& value) { return proceed(); }
+
+            //! \brief Skip a processing instruction.
+            bool processing_instruction(const view_t& target, const view_t& value) { return proceed(); }
+
+            //! \brief Reject a document type declaration found after the root element.
+            bool doctype(const view_t& name, const view_t& value) { return reject(); }
+
+            element_t mRoot; //!< The parent of the top level nodes.
+
+            std::vector<element_pointer_t> mStack; //!< The elements currently open.
+
+            std::vector<std::pair<size_t, view_t> > mCloses; //!< The top level end tags.
+
+        private:
+            //! \brief Store a name or a value in a node.
+            string_ref_t store(const view_t& view) const
+            {
+                return mReference ? string_ref_t(view) : string_ref_t(view.str());
+            }
+
+            //! \brief Whether the texts made of white spaces are dropped.
+            bool stripping() const { return (mFlags & reader_t::parse_strip_whitespace) != 0; }
+
+            //! \brief Reject the chunk, which is then parsed sequentially.
+            /*!
+             *  \return \c false.
+             */
+            bool reject()
+            {
+                mRejected = true;
+
+                return false;
+            }
+
+            //! \brief Whether the parsing goes on after a token.
+            /*!
+             *  \return \c false if a split has been reached.
+             */
+            bool proceed()
+            {
+                if (mSplit == mSplitEnd)
+                    return true;
+
+                const_pointer_t position = mReader->position();
+
+                while (mSplit != mSplitEnd && *mSplit < position)
+                    ++mSplit;
+
+                return mSplit == mSplitEnd || *mSplit != position;
+            }
+
+            unsigned mFlags; //!< The flags of the reader.
+
+            bool mReference;  //!< Whether the nodes reference the parsed buffer.
+            bool mValidating; //!< Whether the chunk is validated as UTF-8.
+            bool mComplete;   //!< Whether the chunk has been parsed up to its end.
+            bool mRejected;   //!< Whether the chunk holds a token that must be parsed sequentially.
+            bool mNamespaced; //!< Whether the chunk holds a prefixed name or a default namespace declaration.
+
+            const const_pointer_t* mSplit;    //!< The next split to stop at.
+            const const_pointer_t* mSplitEnd; //!< Past the last split to stop at.
+
+            const reader_t* mReader; //!< The reader of the chunk being parsed.
+        };
+
+        //! \brief The document being stitched.
+        class stitcher {
+        public:
+            //! \brief Constructor.
+            /*!
+             *  \param [in] builder The builder that read the XML declaration.
+             */
+            stitcher(builder_t& builder)
+            :
+                mBuilder(builder),
+                mDocument(),
+                mStack(),
+                mRootSource(nullptr)
+            {}
+
+            //! \brief Append the subtrees of a fragment.
+            /*!
+             *  \param [in] part The fragment to append.
+             *
+             *  \return \c false if the fragment does not fit in the document.
+             */
+            bool stitch(fragment& part)
+            {
+                size_t adopted = 0;
+
+                mRootSource = nullptr;
+
+                for (const std::pair<size_t, view_t>& close : part.mCloses) {
+                    if (!adopt(part, close.first - adopted))
+                        return false;
+
+                    adopted = close.first;
+
+                    if (mStack.empty() || mStack.back()->name() != close.second)
+                        return false;
+
+                    mStack.pop_back();
+                }
+
+                if (!adopt(part, part.mRoot.size()))
+                    return false;
+
+                for (size_t i = 1; i < part.mStack.size(); ++i)
+                    mStack.push_back(part.mStack[i] == mRootSource ? &mDocument->root() : part.mStack[i]);
+
+                return true;
+            }
+
+            //! \brief Whether the root element has been parsed and closed.
+            bool complete() const { return mDocument && mStack.empty(); }
+
+            //! \brief Get the stitched document.
+            document_t release() { return std::move(*mDocument); }
+
+        private:
+            //! \brief Move the first top level nodes of a fragment.
+            /*!
+             *  \param [in] part  The fragment owning the nodes.
+             *  \param [in] count The number of nodes to move.
+             *
+             *  \return \c false if a node cannot be placed.
+             */
+            bool adopt(fragment& part, size_t count)
+            {
+                for (; count > 0; --count) {
+                    if (!mStack.empty()) {
+                        element_t& parent = *mStack.back();
+
+                        parent.splice(parent.end(), part.mRoot, part.mRoot.begin(), ++part.mRoot.begin());
+                        continue;
+                    }
+
+                    if (mDocument || part.mRoot.front().kind() != node_interface_t::element_kind)
+                        return false;
+
+                    element_t& root = static_cast<element_t&>(part.mRoot.front());
+
+                    mBuilder.start_element(root.name());
+                    mDocument.reset(new document_t(mBuilder.release()));
+
+                    mDocument->root().attributes() = std::move(root.attributes());
+                    mDocument->root().splice(mDocument->root().end(), root, root.begin(), root.end());
+
+                    mRootSource = &root;
+                    part.mRoot.pop_front();
+                }
+
+                return true;
+            }
+
+            builder_t& mBuilder; //!< The builder holding the XML declaration.
+
+            std::unique_ptr<document_t> mDocument; //!< The document being stitched.
+
+            std::vector<element_pointer_t> mStack; //!< The elements currently open.
+
+            element_pointer_t mRootSource; //!< The fragment element the root element has been moved from.
+        };
+
+        //! \brief Whether a part of a document is valid UTF-8.
+        /*!
+         *  \param [in] first A pointer to the first character of the part.
+         *  \param [in] last  A pointer past the last character of the part.
+         *
+         *  \return \c false if the part holds an invalid sequence.
+         */
+        static bool valid(const_pointer_t first, const_pointer_t last)
+        {
+            const char* bytes = reinterpret_cast<const char*>(first);
+
+            return utf8::validate(bytes, bytes + (last - first)) == bytes + (last - first);
+        }
+
+        //! \brief Resolve the namespaces of a stitched document.
+        /*!
+         *  The elements are visited in document order, without recursion.
+         *
+         *  \param [in] document The document.
+         *
+         *  \return \c false if the namespaces of an element cannot be resolved.
+         */
+        static bool resolve(document_t& document)
+        {
+            typedef typename element_t::template iterator<> iterator_t;
+
+            resolver_t              resolver(document.namespaces());
+            std::vector<iterator_t> stack;
+            const iterator_t        last = document.root().end();
+
+            if (!resolver.resolve(document.root()))
+                return false;
+
+            stack.push_back(document.root().begin());
+
+            while (!stack.empty()) {
+                if (stack.back() == last) {
+                    stack.pop_back();
+                    resolver.leave();
+                    continue;
+                }
+
+                child_t& child = *stack.back();
+
+                ++stack.back();
+
+                if (child.kind() != node_interface_t::element_kind)
+                    continue;
+
+                element_t& element = static_cast<element_t&>(child);
+
+                if (!resolver.resolve(element))
+                    return false;
+
+                stack.push_back(element.begin());
+            }
+
+            return true;
+        }
+
+        //! \brief Drop the texts made of white spaces of a stitched document.
+        /*!
+         *  The texts in the scope of \c xml:space="preserve" are kept, as by
+         *  a \c basic_builder. The elements are visited in document order,
+         *  without recursion.
+         *
+         *  \param [in] document The document.
+         */
+        static void strip(document_t& document)
+        {
+            typedef typename element_t::template iterator<> iterator_t;
+
+            //! \brief An element whose children are being visited.
+            class entry_t {
+            public:
+                element_t* element;  //!< The element.
+                iterator_t next;     //!< Its next child.
+                bool       preserve; //!< Whether its white spaces are significant.
+            };
+
+            std::vector<entry_t> stack;
+
+            stack.push_back(entry_t { &document.root(), document.root().begin(), document.root().preserves_space() });
+
+            while (!stack.empty()) {
+                entry_t& top = stack.back();
+
+                if (top.next == top.element->end()) {
+                    stack.pop_back();
+                    continue;
+                }
+
+                child_t& child = *top.next;
+
+                if (child.kind() == node_interface_t::text_kind) {
+                    const string_ref_t& data = static_cast<text_t&>(child).data();
+
+                    if (!top.preserve && scanner_t::all_whitespace(data.begin(), data.end()))
+                        top.next = top.element->erase(top.next);
+                    else
+                        ++top.next;
+
+                    continue;
+                }
+
+                ++top.next;
+
+                if (child.kind() != node_interface_t::element_kind)
+                    continue;
+
+                element_t& element  = static_cast<element_t&>(child);
+                bool       preserve = top.preserve;
+
+                for (const typename element_t::attribute_t& attribute : element.attributes())
+                    if (attribute.name().view().equals("xml:space"))
+                        preserve = attribute.value().view().equals("preserve");
+
+                stack.push_back(entry_t { &element, element.begin(), preserve });
+            }
+        }
+
+        //! \brief Split a document at \c '<' characters.
+        /*!
+         *  \param [in] first   A pointer to the root element.
+         *  \param [in] last    A pointer past the last character of the document.
+         *  \param [in] threads The number of threads, or \c 0.
+         *
+         *  \return The beginning of each chunk.
+         */
+        static std::vector<const_pointer_t> split(const_pointer_t first, const_pointer_t last, size_t threads)
+        {
+            if (threads == 0)
+                threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+
+            const size_t size  = last - first;
+            const size_t count = std::max<size_t>(1, std::min(threads, size / sMinChunkSize));
+
+            std::vector<const_pointer_t> splits(1, first);
+
+            for (size_t i = 1; i < count; ++i) {
+                const_pointer_t cursor = scanner_t::find(
+                    std::max(first + size / count * i, splits.back() + 1), last, '<');
+
+                if (cursor == last)
+                    break;
+
+                splits.push_back(cursor);
+            }
+
+            return splits;
+        }
+
+        //! \brief Get the end of a chunk.
+        static const_pointer_t end(const std::vector<const_pointer_t>& splits, size_t i, const_pointer_t last)
+        {
+            return i + 1 < splits.size() ? splits[i + 1] : last;
+        }
+    };
+
+    typedef basic_parallel_builder<char>    parallel_builder;  //!< A specialized \c basic_parallel_builder for char.
+    typedef basic_parallel_builder<wchar_t> wparallel_builder; //!< A specialized \c basic_parallel_builder for wchar_t.
+}
+
+#endif /* PARALLEL_BUILDER_H_INCLUDED */
@@ -8,6 +8,15 @@
 namespace xml {
     template <typename charT>
     class basic_parent_node;
+
+    template <typename charT>
+    class basic_node;
+
+    template <typename charT>
+    class basic_attribute_index;
+
+    template <typename charT>
+    class basic_attribute_set;
 }
 
 #include <node-interface.h>
@@ -91,6 +100,40 @@ namespace xml {
 
         //!@}
 
+        //! \brief A source of children created on first access.
+        /*!
+         *  A parent node can defer the creation of its children to a
+         *  loader, which is called the first time the children are
+         *  accessed or modified. A loader must outlive the nodes it has
+         *  been given to, and must create all the children at once.
+         */
+        class loader_t {
+        public:
+            //! \brief Destructor.
+            virtual ~loader_t()
+            {}
+
+            //! \brief Create the children of a parent node.
+            /*!
+             *  \param [in] parent   The parent node to fill.
+             *  \param [in] position The position given to \c defer().
+             */
+            virtual void load(parent_reference_t parent, size_t position) const = 0;
+
+        protected:
+            //! \brief Defer the creation of the children of a parent node.
+            /*!
+             *  \param [in] parent   An empty parent node.
+             *  \param [in] loader   The loader creating its children.
+             *  \param [in] position A position in the loader, given back to \c load().
+             */
+            static void defer(parent_reference_t parent, const loader_t* loader, size_t position)
+            {
+                parent.mLoader   = loader;
+                parent.mPosition = position;
+            }
+        };
+
         //! \brief Default constructor
         /*!
          *  This constructor initialise the internals of a parent node
@@ -101,7 +144,10 @@ namespace xml {
             node_interface_t(),
             mSize(0),
             mFirst(nullptr),
-            mLast(nullptr)
+            mLast(nullptr),
+            mLoader(nullptr),
+            mPosition(0),
+            mIndexed(false)
         {}
 
         //! \brief Copy constructor
@@ -117,7 +163,10 @@ namespace xml {
             node_interface_t(rhs),
             mSize(0),
             mFirst(nullptr),
-            mLast(nullptr)
+            mLast(nullptr),
+            mLoader(nullptr),
+            mPosition(0),
+            mIndexed(false)
         {
             insert(cbegin(), rhs.cbegin(), rhs.cend());
         }
@@ -134,13 +183,16 @@ namespace xml {
             node_interface_t(rhs),
             mSize(0),
             mFirst(nullptr),
-            mLast(nullptr)
+            mLast(nullptr),
+            mLoader(nullptr),
+            mPosition(0),
+            mIndexed(false)
         {
             while (rhs.size() > 0)
             {
                 auto ptr = rhs.mFirst;
 
-                remove(ptr);
+                rhs.remove(ptr);
                 insert(cend(), ptr);
             }
         }
@@ -151,6 +203,8 @@ namespace xml {
          */
         virtual ~basic_parent_node ()
         {
+            mLoader = nullptr;
+
             clear();
 
             mSize  = 0;
@@ -165,8 +219,10 @@ namespace xml {
          *  \tparam classT The type of object to iterate through.
          */
         template <class classT = child_t>
-        iterator<classT> begin () noexcept
+        iterator<classT> begin ()
         {
+            expand();
+
             return iterator<classT>(mFirst);
         }
 
@@ -177,8 +233,10 @@ namespace xml {
          *  \tparam classT The type of object to iterate through.
          */
         template <class classT = child_t>
-        const_iterator<classT> begin () const noexcept
+        const_iterator<classT> begin () const
         {
+            expand();
+
             return const_iterator<classT>(mFirst);
         }
 
@@ -213,8 +271,10 @@ namespace xml {
          *  \tparam classT The type of object to iterate through.
          */
         template <class classT = child_t>
-        reverse_iterator<classT> rbegin () noexcept
+        reverse_iterator<classT> rbegin ()
         {
+            expand();
+
             return reverse_iterator<classT>(nullptr);
         }
 
@@ -225,8 +285,10 @@ namespace xml {
          *  \tparam classT The type of object to iterate through.
          */
         template <class classT = child_t>
-        const_reverse_iterator<classT> rbegin () const noexcept
+        const_reverse_iterator<classT> rbegin () const
         {
+            expand();
+
             return const_reverse_iterator<classT>(nullptr);
         }
 
@@ -237,8 +299,10 @@ namespace xml {
          *  \tparam classT The type of object to iterate through.
          */
         template <class classT = child_t>
-        reverse_iterator<classT> rend () noexcept
+        reverse_iterator<classT> rend ()
         {
+            expand();
+
             return reverse_iterator<classT>(mFirst);
         }
 
@@ -249,8 +313,10 @@ namespace xml {
          *  \tparam classT The type of object to iterate through.
          */
         template <class classT = child_t>
-        const_reverse_iterator<classT> rend () const noexcept
+        const_reverse_iterator<classT> rend () const
         {
+            expand();
+
             return const_reverse_iterator<classT>(mFirst);
         }
 
@@ -261,7 +327,7 @@ namespace xml {
          *  \tparam classT The type of object to iterate through.
          */
         template <class classT = child_t>
-        const_iterator<classT> cbegin () const noexcept
+        const_iterator<classT> cbegin () const
         {
             return begin();
         }
@@ -285,7 +351,7 @@ namespace xml {
          *  \tparam classT The type of object to iterate through.
          */
         template <class classT = child_t>
-        const_reverse_iterator<classT> crbegin () const noexcept
+        const_reverse_iterator<classT> crbegin () const
         {
             return rbegin();
         }
@@ -297,7 +363,7 @@ namespace xml {
          *  \tparam classT The type of object to iterate through.
          */
         template <class classT = child_t>
-        const_reverse_iterator<classT> crend () const noexcept
+        const_reverse_iterator<classT> crend () const
         {
             return rend();
         }
@@ -311,6 +377,8 @@ namespace xml {
          */
         size_t size () const
         {
+            expand();
+
             return mSize;
         }
 
@@ -321,7 +389,7 @@ namespace xml {
          *
          *  \return \c true if the current node is empty, \c false otherwise.
          */
-        bool empty() const noexcept
+        bool empty() const
         {
             return size() == 0;
         }
@@ -337,6 +405,8 @@ namespace xml {
          */
         child_reference_t front()
         {
+            expand();
+
             return *mFirst;
         }
 
@@ -351,6 +421,8 @@ namespace xml {
          */
         child_const_reference_t front() const
         {
+            expand();
+
             return *mFirst;
         }
 
@@ -365,6 +437,8 @@ namespace xml {
          */
         child_reference_t back()
         {
+            expand();
+
             return *mLast;
         }
 
@@ -379,6 +453,8 @@ namespace xml {
          */
         child_const_reference_t back() const
         {
+            expand();
+
             return *mLast;
         }
 
@@ -591,6 +667,22 @@ namespace xml {
             return emplace<classU>(cend(), std::forward<Args>(args) ...);
         }
 
+        //! \brief Insert an allocated \c child_t after the last element.
+        /*!
+         *  The \c basic_parent_node takes the ownership of the \c child_t,
+         *  and deletes it when it is erased. It lets nodes be allocated by
+         *  a placement \c new, such as an \c arena_node.
+         *
+         *  \param [in] ptr A pointer to the \c child_t to insert.
+         *
+         *  \return An \c iterator pointing to the inserted element.
+         */
+        template <class classT = child_t>
+        iterator<classT> adopt_back (child_pointer_t ptr)
+        {
+            return insert<classT>(cend(), ptr);
+        }
+
         //! \brief Erase element.
         /*!
          *  The element pointed by the \c iterator will be erased.
@@ -651,9 +743,37 @@ namespace xml {
          */
         void clear () noexcept
         {
+            mLoader = nullptr;
+
             erase(cbegin(), cend());
         }
 
+        //! \brief Move elements from another parent node.
+        /*!
+         *  The elements in between \c first (included) and \c last (excluded)
+         *  are unlinked from \c other and inserted before \c position. They
+         *  are neither copied nor reallocated.
+         *
+         *  \param [in] position An iterator before which the elements are inserted.
+         *  \param [in] other    The parent node owning the elements.
+         *  \param [in] first    An iterator to the first element to move.
+         *  \param [in] last     An iterator past the last element to move.
+         */
+        void splice (iterator<> position, parent_reference_t other, iterator<> first, iterator<> last)
+        {
+            child_pointer_t ptr = first.mPtr;
+
+            while (ptr != last.mPtr)
+            {
+                child_pointer_t next = ptr->mNext;
+
+                other.remove(ptr);
+                insert(position, ptr);
+
+                ptr = next;
+            }
+        }
+
     private:
         //! \brief Insert a \c child_t into the inserted elements.
         /*!
@@ -668,6 +788,8 @@ namespace xml {
         template <class classT = child_t>
         iterator<classT> insert (iterator<classT> position, child_pointer_t ptr)
         {
+            expand();
+
             child_pointer_t after = position.mPtr;
             child_pointer_t before = after == nullptr ? mLast : after->mPrevious;
 
@@ -687,6 +809,8 @@ namespace xml {
 
             ++mSize;
 
+            touch();
+
             return iterator<classT>(ptr);
         }
 
@@ -704,6 +828,8 @@ namespace xml {
         {
             assert(ptr->mParent == this);
 
+            expand();
+
             child_pointer_t next = ptr->mNext;
             child_pointer_t previous = ptr->mPrevious;
 
@@ -719,16 +845,68 @@ namespace xml {
 
             --mSize;
 
+            touch();
+
             return iterator<classT>(next);
         }
 
     protected:
+        //! \brief Report that the node or one of its descendants changed.
+        /*!
+         *  Elements forward the report to their parent, and a document
+         *  drops its attribute index. It is only called on the nodes seen
+         *  by the attribute index of their document.
+         *
+         *  \sa touch()
+         */
+        virtual void modified()
+        {}
+
+        //! \brief Report a change of the children or of the attributes.
+        /*!
+         *  The nodes are marked when the attribute index of their document
+         *  is built, and unmarked by the first change reported : the
+         *  changes of trees without index cost a test, and a change only
+         *  walks up to the document once per build of its index.
+         */
+        void touch()
+        {
+            if (mIndexed) {
+                mIndexed = false;
+                modified();
+            }
+        }
+
+        //! \brief Create the children deferred to a loader, if any.
+        /*!
+         *  This function is called by every function accessing or modifying
+         *  the children. It is not thread-safe : a tree that has not been
+         *  fully loaded must not be read concurrently.
+         */
+        void expand() const
+        {
+            if (mLoader != nullptr) {
+                const loader_t* loader = mLoader;
+
+                mLoader = nullptr;
+                loader->load(const_cast<parent_reference_t>(*this), mPosition);
+            }
+        }
+
         size_t mSize; //!< The number of children owned by this node.
 
         child_pointer_t mFirst; //!< A pointer to the first element.
         child_pointer_t mLast;  //!< A pointer to the last element.
 
+        mutable const loader_t* mLoader;   //!< The loader of the children, until they are created.
+        size_t                  mPosition; //!< The position of the children in the loader.
+
+        mutable bool mIndexed; //!< Whether the node is seen by the attribute index of its document.
+
         friend class basic_child_node<charT>;
+        friend class basic_node<charT>;
+        friend class basic_attribute_index<charT>;
+        friend class basic_attribute_set<charT>;
     };
 
     typedef basic_parent_node<char>    parent_node;  //!< A specialized \c basic_parent_node for char.
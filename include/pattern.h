@@ -0,0 +1,994 @@
+#ifndef PATTERN_H_INCLUDED
+#define PATTERN_H_INCLUDED
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+
+#include <reader.h>
+#include <exception.h>
+#include <expected.h>
+
+namespace xml {
+    //! \brief A compiled XML Schema regular expression.
+    /*!
+     *  This class compiles the regular expressions of the \c pattern facet
+     *  of XML Schema (appendix F of XML Schema part 2) once, into the
+     *  program of a Thompson automaton. A value is matched by simulating
+     *  every thread of the automaton in lockstep, so that the time taken is
+     *  linear in the length of the value whatever the expression, and no
+     *  memory is allocated once the working memory given by the caller has
+     *  grown to the size of the program.
+     *
+     *  As in XML Schema, an expression is implicitly anchored : it matches
+     *  whole values. The values are read as code points, decoded from
+     *  UTF-8 when \c charT is \c char, and from UTF-16 when it is 16 bits
+     *  wide. Character categories (\c \\p{...}) are exact in the Latin-1
+     *  range ; above it, code points are letters, except for a few
+     *  punctuation, separator and private use ranges. Only the main
+     *  Unicode blocks are known.
+     *
+     *  A compiled pattern is immutable : it can be shared by threads, each
+     *  matching with its own working memory.
+     *
+     *  \tparam charT The type of character used in the expressions and values.
+     *                By default, char and wchar_t are supported.
+     */
+    template <typename charT>
+    class basic_pattern {
+    public:
+        //! \name Member types
+        //!@{
+        typedef          basic_reader<charT>       reader_t;        //!< The reader type, whose error codes are used.
+        typedef typename reader_t::scanner_t       scanner_t;       //!< The scanner type.
+        typedef typename reader_t::view_t          view_t;          //!< The type of expressions and values.
+        typedef typename reader_t::const_pointer_t const_pointer_t; //!< Pointer to a constant character.
+        typedef          std::basic_string<charT>  string_t;        //!< The string type.
+
+        typedef basic_pattern<charT>                   pattern_t;     //!< The pattern type.
+        typedef basic_parse_error<charT>               parse_error_t; //!< The compilation error type.
+        typedef basic_exception<charT>                 exception_t;   //!< The type of exception thrown on compilation errors.
+        typedef expected<pattern_t, parse_error_t>     result_t;      //!< The result of a compilation that does not throw.
+        typedef std::vector<uint32_t>                  scratch_t;     //!< The working memory of a match.
+
+        //!@}
+
+        //! \brief Compile a regular expression without throwing exceptions.
+        /*!
+         *  \param [in] expression The regular expression.
+         *
+         *  \return The compiled pattern, or an \c invalid_attribute_value
+         *          error at the offset of the faulty character.
+         */
+        static result_t try_compile(const view_t& expression)
+        {
+            pattern_t pattern;
+            compiler_t compiler(pattern, expression);
+
+            if (!compiler.compile())
+                return result_t(parse_error_t(compiler.error, reader_t::invalid_attribute_value, compiler.offset()));
+
+            return result_t(std::move(pattern));
+        }
+
+        //! \brief Compile a regular expression.
+        /*!
+         *  \param [in] expression The regular expression.
+         *
+         *  \throw exception_t If the expression is malformed.
+         *
+         *  \return The compiled pattern.
+         */
+        static pattern_t compile(const view_t& expression)
+        {
+            result_t result = try_compile(expression);
+
+            if (!result)
+                throw exception_t(result.error(), expression.data());
+
+            return std::move(result.value());
+        }
+
+        //! \brief Whether a value matches the pattern.
+        /*!
+         *  \param [in]     value   The value.
+         *  \param [in,out] scratch The working memory, which is grown to the
+         *                          size of the program on first use and can
+         *                          be reused by later matches.
+         *
+         *  \return \c true if the whole value matches.
+         */
+        bool matches(const view_t& value, scratch_t& scratch) const
+        {
+            const size_t size = mProgram.size();
+
+            if (scratch.size() < 5 * size + 2)
+                scratch.resize(5 * size + 2);
+
+            uint32_t* seen    = scratch.data();
+            uint32_t* current = seen + size;
+            uint32_t* next    = current + size;
+            uint32_t* stack   = next + size;
+
+            std::fill(seen, seen + size, 0);
+
+            uint32_t mark  = 1;
+            size_t   count = spawn(current, 0, 0, seen, stack, mark);
+
+            const_pointer_t first = value.begin();
+            const_pointer_t last  = value.end();
+
+            while (first != last) {
+                if (count == 0)
+                    return false;
+
+                const uint32_t c = decode(first, last);
+                size_t following = 0;
+
+                ++mark;
+
+                for (size_t i = 0; i != count; ++i) {
+                    const instruction_t& instruction = mProgram[current[i]];
+
+                    if (instruction.op == op_class && mClasses[instruction.x].contains(c, mClasses))
+                        following = spawn(next, following, current[i] + 1, seen, stack, mark);
+                }
+
+                std::swap(current, next);
+                count = following;
+            }
+
+            for (size_t i = 0; i != count; ++i)
+                if (mProgram[current[i]].op == op_match)
+                    return true;
+
+            return false;
+        }
+
+        //! \brief Whether a value matches the pattern.
+        /*!
+         *  This overload allocates its working memory.
+         *
+         *  \param [in] value The value.
+         *
+         *  \return \c true if the whole value matches.
+         */
+        bool matches(const view_t& value) const
+        {
+            scratch_t scratch;
+
+            return matches(value, scratch);
+        }
+
+    private:
+        enum : uint32_t {
+            unbounded    = uint32_t(-1),  //!< The maximum of an unbounded repetition.
+            max_program  = 1 << 16,       //!< The maximum number of instructions of a program.
+            max_code     = 0x10FFFF       //!< The greatest code point.
+        };
+
+        //! The operations of the program.
+        enum op_t : uint8_t {
+            op_class, //!< Consume a character of the class \c x.
+            op_split, //!< Go on at both \c x and \c y.
+            op_jump,  //!< Go on at \c x.
+            op_match  //!< The value matches if it has been consumed.
+        };
+
+        //! \brief An instruction of the program.
+        class instruction_t {
+        public:
+            op_t     op; //!< The operation.
+            uint32_t x;  //!< The first operand.
+            uint32_t y;  //!< The second operand.
+        };
+
+        //! The general categories of characters, as bits of a property mask.
+        enum category_t : uint32_t {
+            category_lu = 1 << 0, //!< Uppercase letters.
+            category_ll = 1 << 1, //!< Lowercase letters.
+            category_lo = 1 << 2, //!< Other letters.
+            category_nd = 1 << 3, //!< Decimal digits.
+            category_no = 1 << 4, //!< Other numbers.
+            category_p  = 1 << 5, //!< Punctuation.
+            category_s  = 1 << 6, //!< Symbols.
+            category_z  = 1 << 7, //!< Separators.
+            category_c  = 1 << 8, //!< Control, format, surrogate and private use characters.
+
+            property_space      = 1 << 9,  //!< \c \\s : XML white spaces.
+            property_name_start = 1 << 10, //!< \c \\i : characters starting a XML name.
+            property_name_char  = 1 << 11  //!< \c \\c : characters of a XML name.
+        };
+
+        //! \brief An item of a character class : a range, or a property.
+        class item_t {
+        public:
+            uint32_t first;    //!< The first code point of a range.
+            uint32_t last;     //!< The last code point of a range.
+            uint32_t mask;     //!< The properties matched, or 0 for a range.
+            bool     negated;  //!< Whether the item matches the characters outside the range or property.
+
+            //! \brief Whether a code point matches the item.
+            bool contains(uint32_t c) const
+            {
+                bool found;
+
+                if (mask == 0)
+                    found = first <= c && c <= last;
+                else
+                    found = (mask & category(c)) != 0 ||
+                            ((mask & property_space) != 0 && (c == ' ' || c == '\t' || c == '\n' || c == '\r')) ||
+                            ((mask & property_name_start) != 0 && (c >= 0x80 || scanner_t::is_name_start(static_cast<charT>(c)))) ||
+                            ((mask & property_name_char) != 0 && (c >= 0x80 || scanner_t::is_name_char(static_cast<charT>(c))));
+
+                return found != negated;
+            }
+        };
+
+        //! \brief A character class.
+        class class_t {
+        public:
+            std::vector<item_t> items;    //!< The items, any of which matches.
+            bool                negated;  //!< Whether the class matches the characters no item matches.
+            uint32_t            subtract; //!< The index of the subtracted class, or \c unbounded.
+
+            //! \brief Whether a code point belongs to the class.
+            bool contains(uint32_t c, const std::vector<class_t>& classes) const
+            {
+                bool found = false;
+
+                for (const item_t& item : items)
+                    if (item.contains(c)) {
+                        found = true;
+                        break;
+                    }
+
+                if (found == negated)
+                    return false;
+
+                return subtract == unbounded || !classes[subtract].contains(c, classes);
+            }
+        };
+
+        //! The kinds of nodes of a parsed expression.
+        enum node_kind_t {
+            node_empty,     //!< Matches the empty string.
+            node_class,     //!< Matches a character of a class.
+            node_concat,    //!< Matches its children in sequence.
+            node_alternate, //!< Matches one of its children.
+            node_repeat     //!< Matches its child between \c min and \c max times.
+        };
+
+        //! \brief A node of a parsed expression.
+        class node_t {
+        public:
+            node_kind_t         kind;     //!< The kind of node.
+            uint32_t            value;    //!< The class of a \c node_class.
+            uint32_t            min;      //!< The minimum count of a \c node_repeat.
+            uint32_t            max;      //!< The maximum count of a \c node_repeat, or \c unbounded.
+            std::vector<size_t> children; //!< The children of the node.
+        };
+
+        //! \brief The compiler of an expression.
+        class compiler_t {
+        public:
+            //! \brief Constructor.
+            compiler_t(pattern_t& target, const view_t& expression)
+            :
+                error(nullptr),
+                pattern(target),
+                codes(),
+                offsets(),
+                nodes(),
+                position(0)
+            {
+                const_pointer_t first = expression.begin();
+                const_pointer_t last  = expression.end();
+
+                while (first != last) {
+                    offsets.push_back(first - expression.begin());
+                    codes.push_back(decode(first, last));
+                }
+
+                offsets.push_back(expression.size());
+            }
+
+            //! \brief Compile the expression into the pattern.
+            bool compile()
+            {
+                size_t root;
+
+                if (!parseRegExp(root))
+                    return false;
+
+                if (position != codes.size())
+                    return fail("unbalanced parenthesis in pattern");
+
+                if (!emit(root))
+                    return false;
+
+                pattern.mProgram.push_back(instruction_t { op_match, 0, 0 });
+
+                return true;
+            }
+
+            //! \brief Get the offset of the faulty character.
+            size_t offset() const { return offsets[std::min(position, codes.size())]; }
+
+            const char* error; //!< A description of the compilation error.
+
+        private:
+            //! \brief Record an error.
+            bool fail(const char* what)
+            {
+                error = what;
+
+                return false;
+            }
+
+            //! \brief Whether the expression goes on with a code point.
+            bool next(uint32_t c) const { return position != codes.size() && codes[position] == c; }
+
+            //! \brief Add a node.
+            size_t add(node_kind_t kind, uint32_t value = 0)
+            {
+                nodes.push_back(node_t { kind, value, 1, 1, std::vector<size_t>() });
+
+                return nodes.size() - 1;
+            }
+
+            //! \brief Add a character class.
+            uint32_t addClass(std::vector<item_t> items, bool negated)
+            {
+                pattern.mClasses.push_back(class_t { std::move(items), negated, unbounded });
+
+                return static_cast<uint32_t>(pattern.mClasses.size() - 1);
+            }
+
+            //! \brief Parse \c regExp ::= branch ( '|' branch )*.
+            bool parseRegExp(size_t& index)
+            {
+                size_t branch;
+
+                if (!parseBranch(branch))
+                    return false;
+
+                if (!next('|')) {
+                    index = branch;
+
+                    return true;
+                }
+
+                index = add(node_alternate);
+                nodes[index].children.push_back(branch);
+
+                while (next('|')) {
+                    ++position;
+
+                    if (!parseBranch(branch))
+                        return false;
+
+                    nodes[index].children.push_back(branch);
+                }
+
+                return true;
+            }
+
+            //! \brief Parse \c branch ::= piece*.
+            bool parseBranch(size_t& index)
+            {
+                index = add(node_concat);
+
+                while (position != codes.size() && !next('|') && !next(')')) {
+                    size_t piece;
+
+                    if (!parsePiece(piece))
+                        return false;
+
+                    nodes[index].children.push_back(piece);
+                }
+
+                return true;
+            }
+
+            //! \brief Parse \c piece ::= atom quantifier?.
+            bool parsePiece(size_t& index)
+            {
+                size_t atom;
+
+                if (!parseAtom(atom))
+                    return false;
+
+                uint32_t min = 1;
+                uint32_t max = 1;
+
+                if (next('?'))
+                    min = 0;
+                else if (next('*'))
+                    min = 0, max = unbounded;
+                else if (next('+'))
+                    max = unbounded;
+                else if (next('{')) {
+                    ++position;
+
+                    if (!parseNumber(min))
+                        return false;
+
+                    max = min;
+
+                    if (next(',')) {
+                        ++position;
+                        max = unbounded;
+
+                        if (!next('}') && !parseNumber(max))
+                            return false;
+                    }
+
+                    if (!next('}'))
+                        return fail("invalid quantifier in pattern");
+
+                    if (max < min)
+                        return fail("invalid quantity in pattern");
+                } else {
+                    index = atom;
+
+                    return true;
+                }
+
+                ++position;
+
+                index = add(node_repeat);
+                nodes[index].min = min;
+                nodes[index].max = max;
+                nodes[index].children.push_back(atom);
+
+                return true;
+            }
+
+            //! \brief Parse a decimal quantity.
+            bool parseNumber(uint32_t& value)
+            {
+                if (position == codes.size() || codes[position] < '0' || codes[position] > '9')
+                    return fail("invalid quantity in pattern");
+
+                value = 0;
+
+                while (position != codes.size() && codes[position] >= '0' && codes[position] <= '9') {
+                    value = value * 10 + (codes[position++] - '0');
+
+                    if (value > max_program)
+                        return fail("pattern too large");
+                }
+
+                return true;
+            }
+
+            //! \brief Parse \c atom ::= NormalChar | charClass | '(' regExp ')'.
+            bool parseAtom(size_t& index)
+            {
+                const uint32_t c = codes[position++];
+
+                switch (c) {
+                case '(':
+                    if (!parseRegExp(index))
+                        return false;
+
+                    if (!next(')'))
+                        return fail("unbalanced parenthesis in pattern");
+
+                    ++position;
+
+                    return true;
+
+                case '[': {
+                    uint32_t value;
+
+                    if (!parseClassExpr(value))
+                        return false;
+
+                    index = add(node_class, value);
+
+                    return true;
+                }
+
+                case '.':
+                    index = add(node_class, addClass(std::vector<item_t> {
+                        item_t { '\n', '\n', 0, false }, item_t { '\r', '\r', 0, false } }, true));
+
+                    return true;
+
+                case '\\': {
+                    std::vector<item_t> items;
+
+                    if (!parseEscape(items))
+                        return false;
+
+                    index = add(node_class, addClass(std::move(items), false));
+
+                    return true;
+                }
+
+                case '?': case '*': case '+': case '{': case '}': case ']':
+                    --position;
+
+                    return fail("unexpected meta character in pattern");
+
+                default:
+                    index = add(node_class, addClass(std::vector<item_t> { item_t { c, c, 0, false } }, false));
+
+                    return true;
+                }
+            }
+
+            //! \brief Parse a character class expression, after its \c '['.
+            bool parseClassExpr(uint32_t& index)
+            {
+                std::vector<item_t> items;
+                bool negated = false;
+
+                if (next('^')) {
+                    negated = true;
+                    ++position;
+                }
+
+                do {
+                    if (position == codes.size())
+                        return fail("unterminated character class in pattern");
+
+                    if (next('-') && position + 1 != codes.size() && codes[position + 1] == '[') {
+                        if (items.empty())
+                            return fail("invalid character class subtraction in pattern");
+
+                        break;
+                    }
+
+                    if (next('['))
+                        return fail("unescaped '[' in character class");
+
+                    uint32_t first;
+                    const bool escaped = next('\\');
+
+                    if (escaped) {
+                        ++position;
+
+                        if (!isSingleEscape()) {
+                            if (!parseEscape(items))
+                                return false;
+
+                            continue;
+                        }
+
+                        first = singleEscape(codes[position++]);
+                    } else
+                        first = codes[position++];
+
+                    uint32_t last = first;
+
+                    if (next('-') && position + 1 != codes.size() && codes[position + 1] != ']' && codes[position + 1] != '[') {
+                        ++position;
+
+                        if (next('\\')) {
+                            ++position;
+
+                            if (!isSingleEscape())
+                                return fail("invalid character range in pattern");
+
+                            last = singleEscape(codes[position++]);
+                        } else
+                            last = codes[position++];
+
+                        if (last < first)
+                            return fail("invalid character range in pattern");
+                    } else if (!escaped && first == '-' && !items.empty() && !next(']'))
+                        return fail("unescaped '-' in character class");
+
+                    items.push_back(item_t { first, last, 0, false });
+                } while (!next(']'));
+
+                index = addClass(std::move(items), negated);
+
+                if (next('-')) {
+                    position += 2;
+
+                    uint32_t subtracted;
+
+                    if (!parseClassExpr(subtracted))
+                        return false;
+
+                    pattern.mClasses[index].subtract = subtracted;
+
+                    if (!next(']'))
+                        return fail("unterminated character class in pattern");
+                }
+
+                ++position;
+
+                return true;
+            }
+
+            //! \brief Whether the next character is a single character escape.
+            bool isSingleEscape() const
+            {
+                if (position == codes.size())
+                    return false;
+
+                switch (codes[position]) {
+                case 'n': case 'r': case 't': case '\\': case '|': case '.': case '?': case '*': case '+':
+                case '(': case ')': case '{': case '}': case '-': case '[': case ']': case '^':
+                    return true;
+
+                default:
+                    return false;
+                }
+            }
+
+            //! \brief Get the character of a single character escape.
+            static uint32_t singleEscape(uint32_t c)
+            {
+                return c == 'n' ? '\n' : c == 'r' ? '\r' : c == 't' ? '\t' : c;
+            }
+
+            //! \brief Parse an escape, after its \c '\\'.
+            bool parseEscape(std::vector<item_t>& items)
+            {
+                if (position == codes.size())
+                    return fail("unterminated escape in pattern");
+
+                if (isSingleEscape()) {
+                    const uint32_t c = singleEscape(codes[position++]);
+
+                    items.push_back(item_t { c, c, 0, false });
+
+                    return true;
+                }
+
+                const uint32_t c = codes[position++];
+                const uint32_t lower = c | 0x20;
+                const bool     negated = c != lower && c != 'p';
+
+                switch (lower) {
+                case 's':
+                    items.push_back(item_t { 0, 0, property_space, negated });
+                    return true;
+
+                case 'i':
+                    items.push_back(item_t { 0, 0, property_name_start, negated });
+                    return true;
+
+                case 'c':
+                    items.push_back(item_t { 0, 0, property_name_char, negated });
+                    return true;
+
+                case 'd':
+                    items.push_back(item_t { 0, 0, category_nd, negated });
+                    return true;
+
+                case 'w':
+                    items.push_back(item_t { 0, 0, category_p | category_z | category_c, !negated });
+                    return true;
+
+                case 'p':
+                    return parseProperty(items, c == 'P');
+
+                default:
+                    --position;
+
+                    return fail("invalid escape in pattern");
+                }
+            }
+
+            //! \brief Parse a category or block escape, after its \c 'p' or \c 'P'.
+            bool parseProperty(std::vector<item_t>& items, bool negated)
+            {
+                if (!next('{'))
+                    return fail("invalid character property in pattern");
+
+                const size_t first = ++position;
+
+                while (position != codes.size() && !next('}'))
+                    ++position;
+
+                if (position == codes.size())
+                    return fail("invalid character property in pattern");
+
+                std::string name;
+
+                for (size_t i = first; i != position; ++i)
+                    name.push_back(codes[i] < 0x80 ? static_cast<char>(codes[i]) : '?');
+
+                ++position;
+
+                static const struct { const char* name; uint32_t mask; } categories[] = {
+                    { "L",  category_lu | category_ll | category_lo }, { "Lu", category_lu }, { "Ll", category_ll },
+                    { "Lo", category_lo }, { "N", category_nd | category_no }, { "Nd", category_nd }, { "No", category_no },
+                    { "P",  category_p }, { "S", category_s }, { "Z", category_z }, { "C", category_c }
+                };
+
+                static const struct { const char* name; uint32_t first, last; } blocks[] = {
+                    { "IsBasicLatin", 0x0000, 0x007F }, { "IsLatin-1Supplement", 0x0080, 0x00FF },
+                    { "IsLatinExtended-A", 0x0100, 0x017F }, { "IsLatinExtended-B", 0x0180, 0x024F },
+                    { "IsGreek", 0x0370, 0x03FF }, { "IsCyrillic", 0x0400, 0x04FF }, { "IsHebrew", 0x0590, 0x05FF },
+                    { "IsArabic", 0x0600, 0x06FF }, { "IsGeneralPunctuation", 0x2000, 0x206F },
+                    { "IsCJKUnifiedIdeographs", 0x4E00, 0x9FFF }
+                };
+
+                for (const auto& category : categories)
+                    if (name == category.name) {
+                        items.push_back(item_t { 0, 0, category.mask, negated });
+
+                        return true;
+                    }
+
+                for (const auto& block : blocks)
+                    if (name == block.name) {
+                        items.push_back(item_t { block.first, block.last, 0, negated });
+
+                        return true;
+                    }
+
+                return fail("unsupported character property in pattern");
+            }
+
+            //! \brief Emit the instructions of a node.
+            bool emit(size_t index)
+            {
+                std::vector<instruction_t>& program = pattern.mProgram;
+
+                if (program.size() > max_program)
+                    return fail("pattern too large");
+
+                const node_t& node = nodes[index];
+
+                switch (node.kind) {
+                case node_empty:
+                    return true;
+
+                case node_class:
+                    program.push_back(instruction_t { op_class, node.value, 0 });
+                    return true;
+
+                case node_concat:
+                    for (size_t child : node.children)
+                        if (!emit(child))
+                            return false;
+
+                    return true;
+
+                case node_alternate: {
+                    std::vector<size_t> jumps;
+
+                    for (size_t i = 0; i != node.children.size(); ++i) {
+                        const size_t split = program.size();
+
+                        if (i + 1 != node.children.size())
+                            program.push_back(instruction_t { op_split, uint32_t(split + 1), 0 });
+
+                        if (!emit(node.children[i]))
+                            return false;
+
+                        if (i + 1 != node.children.size()) {
+                            jumps.push_back(program.size());
+                            program.push_back(instruction_t { op_jump, 0, 0 });
+                            program[split].y = static_cast<uint32_t>(program.size());
+                        }
+                    }
+
+                    for (size_t jump : jumps)
+                        program[jump].x = static_cast<uint32_t>(program.size());
+
+                    return true;
+                }
+
+                case node_repeat: {
+                    for (uint32_t i = 0; i != node.min; ++i)
+                        if (!emit(node.children[0]))
+                            return false;
+
+                    if (node.max == unbounded) {
+                        const size_t split = program.size();
+
+                        program.push_back(instruction_t { op_split, uint32_t(split + 1), 0 });
+
+                        if (!emit(node.children[0]))
+                            return false;
+
+                        program.push_back(instruction_t { op_jump, uint32_t(split), 0 });
+                        program[split].y = static_cast<uint32_t>(program.size());
+
+                        return true;
+                    }
+
+                    std::vector<size_t> splits;
+
+                    for (uint32_t i = node.min; i != node.max; ++i) {
+                        splits.push_back(program.size());
+                        program.push_back(instruction_t { op_split, uint32_t(program.size() + 1), 0 });
+
+                        if (!emit(node.children[0]))
+                            return false;
+                    }
+
+                    for (size_t split : splits)
+                        program[split].y = static_cast<uint32_t>(program.size());
+
+                    return true;
+                }
+                }
+
+                return true;
+            }
+
+            pattern_t&            pattern;  //!< The compiled pattern.
+            std::vector<uint32_t> codes;    //!< The code points of the expression.
+            std::vector<size_t>   offsets;  //!< The offset of each code point in the expression.
+            std::vector<node_t>   nodes;    //!< The nodes of the parsed expression.
+            size_t                position; //!< The index of the next code point to parse.
+        };
+
+        //! \brief Constructor.
+        /*!
+         *  Builds an empty program, filled by \c compiler_t.
+         */
+        basic_pattern()
+        :
+            mProgram(),
+            mClasses()
+        {}
+
+        //! \brief Decode the next code point of a value.
+        /*!
+         *  Malformed sequences are read one code unit at a time.
+         *
+         *  \param [in,out] first The next character, moved past the code point.
+         *  \param [in]     last  The end of the value.
+         *
+         *  \return The code point.
+         */
+        static uint32_t decode(const_pointer_t& first, const_pointer_t last)
+        {
+            const uint32_t c = scanner_t::code(*first++);
+
+            if (sizeof(charT) == 1 && c >= 0xC0) {
+                const size_t   length = c >= 0xF0 ? 3 : c >= 0xE0 ? 2 : 1;
+                uint32_t       value  = c & (0x3F >> length);
+
+                if (static_cast<size_t>(last - first) < length)
+                    return c;
+
+                for (size_t i = 0; i != length; ++i) {
+                    const uint32_t next = scanner_t::code(first[i]);
+
+                    if ((next & 0xC0) != 0x80)
+                        return c;
+
+                    value = (value << 6) | (next & 0x3F);
+                }
+
+                first += length;
+
+                return value;
+            }
+
+            if (sizeof(charT) == 2 && c >= 0xD800 && c < 0xDC00 && first != last) {
+                const uint32_t low = scanner_t::code(*first);
+
+                if (low >= 0xDC00 && low < 0xE000) {
+                    ++first;
+
+                    return 0x10000 + ((c - 0xD800) << 10) + (low - 0xDC00);
+                }
+            }
+
+            return c;
+        }
+
+        //! \brief Get the general category of a code point.
+        /*!
+         *  \return One of the \c category_t bits.
+         */
+        static uint32_t category(uint32_t c)
+        {
+            if (c < 0x20 || (c >= 0x7F && c < 0xA0) || c == 0xAD)
+                return category_c;
+
+            if (c < 0x80) {
+                if ((c | 0x20) >= 'a' && (c | 0x20) <= 'z')
+                    return c <= 'Z' ? category_lu : category_ll;
+
+                if (c >= '0' && c <= '9')
+                    return category_nd;
+
+                if (c == ' ')
+                    return category_z;
+
+                return c == '$' || c == '+' || c == '<' || c == '=' || c == '>' || c == '^' || c == '`' ||
+                       c == '|' || c == '~' ? category_s : category_p;
+            }
+
+            if (c < 0x100) {
+                if (c == 0xA0)
+                    return category_z;
+
+                if (c == 0xAA || c == 0xBA)
+                    return category_lo;
+
+                if (c == 0xB5 || (c >= 0xDF && c != 0xF7))
+                    return category_ll;
+
+                if (c >= 0xC0 && c != 0xD7)
+                    return category_lu;
+
+                if (c == 0xB2 || c == 0xB3 || c == 0xB9 || (c >= 0xBC && c <= 0xBE))
+                    return category_no;
+
+                return c == 0xA1 || c == 0xA7 || c == 0xAB || c == 0xB6 || c == 0xB7 || c == 0xBB || c == 0xBF ?
+                       category_p : category_s;
+            }
+
+            if ((c >= 0x2000 && c <= 0x200A) || c == 0x2028 || c == 0x2029 || c == 0x202F || c == 0x205F || c == 0x3000)
+                return category_z;
+
+            if ((c >= 0x200B && c <= 0x200F) || (c >= 0x202A && c <= 0x202E) || (c >= 0x2060 && c <= 0x206F) ||
+                (c >= 0xD800 && c <= 0xF8FF) || c == 0xFEFF || c > max_code)
+                return category_c;
+
+            if ((c >= 0x2010 && c <= 0x2027) || (c >= 0x2030 && c <= 0x205E) || (c >= 0x3001 && c <= 0x3003))
+                return category_p;
+
+            return category_lo;
+        }
+
+        //! \brief Add the threads reached from an instruction.
+        /*!
+         *  The jumps and splits are followed with an explicit stack, so that
+         *  each instruction is visited once per step.
+         *
+         *  \return The new number of threads in \c list.
+         */
+        size_t spawn(uint32_t* list, size_t count, uint32_t pc, uint32_t* seen, uint32_t* stack, uint32_t mark) const
+        {
+            size_t top = 0;
+
+            stack[top++] = pc;
+
+            while (top != 0) {
+                pc = stack[--top];
+
+                if (seen[pc] == mark)
+                    continue;
+
+                seen[pc] = mark;
+
+                const instruction_t& instruction = mProgram[pc];
+
+                switch (instruction.op) {
+                case op_jump:
+                    stack[top++] = instruction.x;
+                    break;
+
+                case op_split:
+                    stack[top++] = instruction.y;
+                    stack[top++] = instruction.x;
+                    break;
+
+                case op_class:
+                case op_match:
+                    list[count++] = pc;
+                    break;
+                }
+            }
+
+            return count;
+        }
+
+        std::vector<instruction_t> mProgram; //!< The instructions, starting at 0.
+        std::vector<class_t>       mClasses; //!< The character classes of the instructions.
+    };
+
+    typedef basic_pattern<char>    pattern;  //!< A specialized \c basic_pattern for char.
+    typedef basic_pattern<wchar_t> wpattern; //!< A specialized \c basic_pattern for wchar_t.
+}
+
+#endif /* PATTERN_H_INCLUDED */
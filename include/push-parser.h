@@ -0,0 +1,992 @@
+#ifndef PUSH_PARSER_H_INCLUDED
+#define PUSH_PARSER_H_INCLUDED
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include <reader.h>
+#include <sax.h>
+
+namespace xml {
+    //! \brief An incremental XML parser.
+    /*!
+     *  This class parses a XML document given as a sequence of chunks of
+     *  arbitrary size, and reports the same events as a \c basic_sax_parser.
+     *  Parsing can be suspended anywhere, including in the middle of a name,
+     *  of an attribute value or of a reference, and resumes with the next
+     *  call to \c feed() from where it stopped : characters are never
+     *  scanned twice.
+     *
+     *  The resume state is a handful of scalar members. The only buffers
+     *  are the names of the open elements, needed to match end tags, the
+     *  attribute names of the current tag, and the beginning of a token
+     *  split across two chunks. Tokens that fit in one chunk are reported
+     *  as views into that chunk.
+     *
+     *  A leading byte order mark is skipped as by \c basic_reader, even
+     *  when it is split across the first chunks.
+     *
+     *  Character and entity references are not decoded. The internal
+     *  subset of a document type declaration is only tracked for quotes
+     *  and brackets.
+     *
+     *  When the XML declaration of a \c char document declares the UTF-8
+     *  encoding, the rest of the document is validated chunk by chunk
+     *  before it is tokenized. A sequence split across two chunks is kept
+     *  until the next chunk completes it.
+     *
+     *  \sa xml::basic_sax_parser
+     *  \sa xml::basic_sax_handler
+     *
+     *  \tparam charT    The type of character used in the XML document.
+     *                   By default, char and wchar_t are supported.
+     *  \tparam handlerT The type of handler events are reported to.
+     */
+    template <typename charT, class handlerT = basic_sax_handler<charT> >
+    class basic_push_parser {
+    public:
+        //! \name Member types
+        //!@{
+        typedef          basic_reader<charT>       reader_t;        //!< The reader type.
+        typedef typename reader_t::error_t         error_t;         //!< The error type.
+        typedef typename reader_t::view_t          view_t;          //!< The type of names and values.
+        typedef typename reader_t::scanner_t       scanner_t;       //!< The scanner type.
+        typedef typename reader_t::const_pointer_t const_pointer_t; //!< Pointer to a constant character.
+
+        typedef std::basic_string<charT> string_t; //!< The string type.
+
+        //!@}
+
+        //! \brief Constructor.
+        /*!
+         *  Builds a parser reporting events to \c handler.
+         *
+         *  \param [in] handler The handler events are reported to.
+         */
+        basic_push_parser(handlerT& handler)
+        :
+            mHandler(handler),
+            mPending(),
+            mNames(),
+            mNameEnds(),
+            mTagNames(),
+            mTagNameEnds()
+        {
+            reset();
+        }
+
+        //! \brief Destructor.
+        /*!
+         *  This destructor does nothing.
+         */
+        virtual ~basic_push_parser()
+        {}
+
+        //! \brief Restart the parser for a new document.
+        /*!
+         *  The internal buffers are kept, so that parsing several documents
+         *  does not allocate memory.
+         */
+        void reset()
+        {
+            mState    = state_content;
+            mCount    = 0;
+            mQuote    = 0;
+            mKeyword  = 0;
+            mSpace    = false;
+            mSubset   = false;
+            mRootSeen = false;
+            mDone     = false;
+
+            mDoctypeSeen = false;
+
+            mValidating = false;
+            mCarried    = 0;
+
+            mError         = reader_t::no_error;
+            mConsumed      = 0;
+            mByteOrderMark = 0;
+            mErrorAt    = 0;
+            mChunkStart = nullptr;
+            mChunkEnd   = nullptr;
+            mMark       = nullptr;
+
+            mPending.clear();
+            mNames.clear();
+            mNameEnds.clear();
+            mTagNames.clear();
+            mTagNameEnds.clear();
+        }
+
+        //! \brief Parse a chunk of the document.
+        /*!
+         *  The chunk does not need to outlive this call.
+         *
+         *  \param [in] data A pointer to the first character of the chunk.
+         *  \param [in] size The number of characters of the chunk.
+         *
+         *  \return \c false if an error has been found or if the handler
+         *          stopped the parsing, \c true otherwise.
+         */
+        bool feed(const_pointer_t data, size_t size)
+        {
+            if (mState == state_finished)
+                return false;
+
+            const_pointer_t p   = data;
+            const_pointer_t end = data + size;
+
+            mChunkStart = data;
+            mChunkEnd   = end;
+            mMark       = data;
+
+            if (mValidating && !validateEncoding(p, end))
+                return false;
+
+            if (!skipByteOrderMark(p, end))
+                return false;
+
+            while (p != end) {
+                switch (mState) {
+                case state_content:
+                    if (*p == '<') {
+                        mState = state_open;
+                        ++p;
+                        break;
+                    }
+
+                    begin(p);
+                    mState = state_text;
+
+                    // no break
+
+                case state_text: {
+                    const_pointer_t q = scanner_t::find(p, end, '<');
+
+                    if (q == end) {
+                        p = end;
+                        break;
+                    }
+
+                    if (!reportText(take(q), q))
+                        return false;
+
+                    mState = state_open;
+                    p = q + 1;
+                    break;
+                }
+
+                case state_open: {
+                    const charT c = *p;
+
+                    if (c == '/') {
+                        mState = state_end_name;
+                        begin(++p);
+                    } else if (c == '!') {
+                        mState = state_bang;
+                        mCount = 0;
+                        ++p;
+                    } else if (c == '?') {
+                        mState = state_pi;
+                        mCount = 0;
+                        begin(++p);
+                        mPending.push_back('<');
+                        mPending.push_back('?');
+                    } else {
+                        if (mRootSeen && mNameEnds.empty())
+                            return fail(reader_t::multiple_roots, p - 1);
+
+                        if (!scanner_t::is_name_start(c))
+                            return fail(reader_t::invalid_name, p);
+
+                        mState = state_start_name;
+                        begin(p++);
+                    }
+                    break;
+                }
+
+                case state_start_name: {
+                    const_pointer_t q = scanner_t::find_name_end(p, end);
+
+                    if (q == end) {
+                        p = end;
+                        break;
+                    }
+
+                    if (!scanner_t::is_name_delimiter(*q))
+                        return fail(reader_t::invalid_name, q);
+
+                    const view_t name = take(q);
+
+                    mNames.append(name.begin(), name.end());
+                    mNameEnds.push_back(mNames.size());
+                    mTagNames.clear();
+                    mTagNameEnds.clear();
+                    mRootSeen = true;
+
+                    mState = state_tag;
+                    mSpace = false;
+                    p = q;
+
+                    if (!mHandler.start_element(top()))
+                        return stop();
+                    break;
+                }
+
+                case state_tag: {
+                    const charT c = *p;
+
+                    if (scanner_t::is_whitespace(c)) {
+                        mSpace = true;
+                        ++p;
+                    } else if (c == '>') {
+                        mState = state_content;
+                        ++p;
+                    } else if (c == '/') {
+                        mState = state_empty;
+                        ++p;
+                    } else if (!mSpace) {
+                        return fail(reader_t::invalid_attribute, p);
+                    } else if (!scanner_t::is_name_start(c)) {
+                        return fail(reader_t::invalid_name, p);
+                    } else {
+                        mState = state_attribute_name;
+                        begin(p++);
+                    }
+                    break;
+                }
+
+                case state_empty:
+                    if (*p != '>')
+                        return fail(reader_t::invalid_tag, p);
+
+                    mState = state_content;
+                    ++p;
+
+                    if (!closeElement())
+                        return stop();
+                    break;
+
+                case state_attribute_name: {
+                    const_pointer_t q = scanner_t::find_name_end(p, end);
+
+                    if (q == end) {
+                        p = end;
+                        break;
+                    }
+
+                    if (!scanner_t::is_name_delimiter(*q))
+                        return fail(reader_t::invalid_name, q);
+
+                    const view_t name = take(q);
+
+                    for (size_t i = 0, first = 0; i < mTagNameEnds.size(); first = mTagNameEnds[i++])
+                        if (view_t(mTagNames.data() + first, mTagNameEnds[i] - first) == name)
+                            return fail(reader_t::duplicate_attribute, q - name.size());
+
+                    mTagNames.append(name.begin(), name.end());
+                    mTagNameEnds.push_back(mTagNames.size());
+
+                    mState = state_attribute_equal;
+                    p = q;
+                    break;
+                }
+
+                case state_attribute_equal:
+                    if (*p == '=')
+                        mState = state_attribute_quote;
+                    else if (!scanner_t::is_whitespace(*p))
+                        return fail(reader_t::invalid_attribute, p);
+                    ++p;
+                    break;
+
+                case state_attribute_quote:
+                    if (*p == '"' || *p == '\'') {
+                        mState = state_attribute_value;
+                        mQuote = *p;
+                        begin(++p);
+                    } else if (scanner_t::is_whitespace(*p)) {
+                        ++p;
+                    } else {
+                        return fail(reader_t::invalid_attribute, p);
+                    }
+                    break;
+
+                case state_attribute_value: {
+                    const_pointer_t q = scanner_t::find_first_of(p, end, static_cast<charT>(mQuote), '<');
+
+                    if (q == end) {
+                        p = end;
+                        break;
+                    }
+
+                    if (*q == '<')
+                        return fail(reader_t::invalid_attribute_value, q);
+
+                    const size_t first = mTagNameEnds.size() > 1 ? mTagNameEnds[mTagNameEnds.size() - 2] : 0;
+                    const view_t name(mTagNames.data() + first, mTagNames.size() - first);
+
+                    mState = state_tag;
+                    mSpace = false;
+                    p = q + 1;
+
+                    if (!mHandler.attribute(name, take(q)))
+                        return stop();
+                    break;
+                }
+
+                case state_end_name: {
+                    const_pointer_t q = scanner_t::find_name_end(p, end);
+
+                    if (q == end) {
+                        p = end;
+                        break;
+                    }
+
+                    const view_t name = take(q);
+
+                    if (name.empty() || !scanner_t::is_name_start(name[0]))
+                        return fail(reader_t::invalid_name, q - name.size());
+
+                    if (mNameEnds.empty() || top() != name)
+                        return fail(reader_t::mismatched_tag, q - name.size());
+
+                    mState = state_end_tail;
+                    p = q;
+                    break;
+                }
+
+                case state_end_tail:
+                    if (*p == '>') {
+                        mState = state_content;
+                        ++p;
+
+                        if (!closeElement())
+                            return stop();
+                    } else if (scanner_t::is_whitespace(*p)) {
+                        ++p;
+                    } else {
+                        return fail(reader_t::invalid_tag, p);
+                    }
+                    break;
+
+                case state_bang:
+                    if (!readKeyword(p))
+                        return false;
+                    ++p;
+                    break;
+
+                case state_comment:
+                    if (mCount == 0) {
+                        const_pointer_t q = scanner_t::find(p, end, '-');
+
+                        if (q == end) {
+                            p = end;
+                            break;
+                        }
+
+                        mCount = 1;
+                        p = q + 1;
+                    } else if (mCount == 1) {
+                        mCount = *p == '-' ? 2 : 0;
+                        ++p;
+                    } else {
+                        if (*p != '>')
+                            return fail(reader_t::invalid_comment, p);
+
+                        const view_t value = take(p + 1);
+
+                        mState = state_content;
+                        ++p;
+
+                        if (!mHandler.comment(value.substr(0, value.size() - 3)))
+                            return stop();
+                    }
+                    break;
+
+                case state_cdata:
+                    if (mCount == 0) {
+                        const_pointer_t q = scanner_t::find(p, end, ']');
+
+                        if (q == end) {
+                            p = end;
+                            break;
+                        }
+
+                        mCount = 1;
+                        p = q + 1;
+                    } else if (*p == ']') {
+                        mCount = 2;
+                        ++p;
+                    } else if (*p == '>' && mCount == 2) {
+                        const view_t value = take(p + 1);
+
+                        mState = state_content;
+                        ++p;
+
+                        if (!mHandler.cdata(value.substr(0, value.size() - 3)))
+                            return stop();
+                    } else {
+                        mCount = 0;
+                        ++p;
+                    }
+                    break;
+
+                case state_pi:
+                    if (mCount == 0) {
+                        const_pointer_t q = scanner_t::find(p, end, '?');
+
+                        if (q == end) {
+                            p = end;
+                            break;
+                        }
+
+                        mCount = 1;
+                        p = q + 1;
+                    } else if (*p == '>') {
+                        mState = state_content;
+                        ++p;
+
+                        if (!reportProcessingInstruction(take(p), p))
+                            return false;
+                    } else {
+                        mCount = *p == '?' ? 1 : 0;
+                        ++p;
+                    }
+                    break;
+
+                case state_doctype: {
+                    const charT c = *p++;
+
+                    if (mQuote != 0) {
+                        if (c == static_cast<charT>(mQuote))
+                            mQuote = 0;
+                    } else if (skipSubsetMarkup(c)) {
+                        break;
+                    } else if (c == '"' || c == '\'') {
+                        mQuote = c;
+                    } else if (c == '[') {
+                        mSubset = true;
+                    } else if (c == ']') {
+                        mSubset = false;
+                    } else if (c == '>' && !mSubset) {
+                        mState = state_content;
+
+                        if (!reportDoctype(take(p), p))
+                            return false;
+                    }
+                    break;
+                }
+
+                default:
+                    return false;
+                }
+            }
+
+            if (isCapturing())
+                mPending.append(mMark, end);
+
+            mConsumed += size;
+
+            return true;
+        }
+
+        //! \brief Signal the end of the document.
+        /*!
+         *  \return \c true if the whole document has been parsed and is
+         *          well-formed, \c false otherwise.
+         */
+        bool finish()
+        {
+            if (mState == state_finished)
+                return mDone;
+
+            mChunkStart = nullptr;
+            mChunkEnd   = nullptr;
+            mMark       = nullptr;
+
+            if (mCarried != 0) {
+                fail(reader_t::invalid_encoding, nullptr);
+                mErrorAt -= mCarried;
+
+                return false;
+            }
+
+            if (mState == state_text) {
+                if (!mNameEnds.empty())
+                    return fail(reader_t::unclosed_element, nullptr);
+
+                if (!scanner_t::all_whitespace(mPending.data(), mPending.data() + mPending.size()))
+                    return fail(reader_t::text_outside_root, nullptr);
+
+                mState = state_content;
+            }
+
+            if (mState != state_content)
+                return fail(reader_t::unexpected_end, nullptr);
+
+            if (!mNameEnds.empty())
+                return fail(reader_t::unclosed_element, nullptr);
+
+            if (!mRootSeen)
+                return fail(reader_t::no_root, nullptr);
+
+            mState = state_finished;
+            mDone  = true;
+
+            return true;
+        }
+
+        //! \brief Get the error code.
+        /*!
+         *  \return The error found in the document, or \c reader_t::no_error.
+         */
+        error_t error_code() const { return mError; }
+
+        //! \brief Get the offset of the error.
+        /*!
+         *  \return The offset of the faulty character from the beginning of
+         *          the document, in characters.
+         */
+        size_t offset() const { return mErrorAt; }
+
+        //! \brief Get the current depth.
+        /*!
+         *  \return The number of elements currently open.
+         */
+        size_t depth() const { return mNameEnds.size(); }
+
+    private:
+        //! The internal states of the parser.
+        enum state_t {
+            state_content,         //!< In between two tokens.
+            state_text,            //!< Reading character data.
+            state_open,            //!< After a \c '<'.
+            state_start_name,      //!< Reading the name of a start tag.
+            state_tag,             //!< Inside a start tag, after the name or an attribute.
+            state_empty,           //!< After the \c '/' of an empty element tag.
+            state_attribute_name,  //!< Reading an attribute name.
+            state_attribute_equal, //!< Waiting for the \c '=' of an attribute.
+            state_attribute_quote, //!< Waiting for the opening quote of an attribute value.
+            state_attribute_value, //!< Reading an attribute value.
+            state_end_name,        //!< Reading the name of an end tag.
+            state_end_tail,        //!< Waiting for the \c '>' of an end tag.
+            state_bang,            //!< Reading the keyword following \c "<!".
+            state_comment,         //!< Reading a comment.
+            state_cdata,           //!< Reading a CDATA section.
+            state_pi,              //!< Reading a processing instruction.
+            state_doctype,         //!< Reading a document type declaration.
+            state_finished         //!< The end of the document or an error has been reached.
+        };
+
+        //! \brief Start capturing a token.
+        /*!
+         *  \param [in] p A pointer to the first character of the token.
+         */
+        void begin(const_pointer_t p)
+        {
+            mMark = p;
+            mPending.clear();
+        }
+
+        //! \brief Get the token captured so far.
+        /*!
+         *  \param [in] last A pointer past the last character of the token.
+         *
+         *  \return A view into the current chunk if the whole token is in it,
+         *          or a view into the pending buffer otherwise.
+         */
+        view_t take(const_pointer_t last)
+        {
+            if (mPending.empty())
+                return view_t(mMark, last);
+
+            mPending.append(mMark, last);
+
+            return view_t(mPending);
+        }
+
+        //! \brief Whether a token is being captured.
+        bool isCapturing() const
+        {
+            switch (mState) {
+            case state_text:
+            case state_start_name:
+            case state_attribute_name:
+            case state_attribute_value:
+            case state_end_name:
+            case state_comment:
+            case state_cdata:
+            case state_pi:
+            case state_doctype:
+                return true;
+            default:
+                return false;
+            }
+        }
+
+        //! \brief Get the name of the current element.
+        view_t top() const
+        {
+            const size_t first = mNameEnds.size() > 1 ? mNameEnds[mNameEnds.size() - 2] : 0;
+
+            return view_t(mNames.data() + first, mNames.size() - first);
+        }
+
+        //! \brief Report the end of the current element and close it.
+        /*!
+         *  \return The value returned by the handler.
+         */
+        bool closeElement()
+        {
+            const bool proceed = mHandler.end_element(top());
+
+            mNameEnds.pop_back();
+            mNames.resize(mNameEnds.empty() ? 0 : mNameEnds.back());
+
+            return proceed;
+        }
+
+        //! \brief Report character data.
+        /*!
+         *  \param [in] value The character data.
+         *  \param [in] where A pointer past the character data.
+         *
+         *  \return \c false if an error has been found or if the handler
+         *          stopped the parsing.
+         */
+        bool reportText(const view_t& value, const_pointer_t where)
+        {
+            if (mNameEnds.empty()) {
+                if (!scanner_t::all_whitespace(value.begin(), value.end()))
+                    return fail(reader_t::text_outside_root, where - value.size());
+
+                return true;
+            }
+
+            return mHandler.text(value) || stop();
+        }
+
+        //! \brief Match the keyword following \c "<!".
+        /*!
+         *  \param [in] p A pointer to the character to match.
+         *
+         *  \return \c false if the keyword is invalid.
+         */
+        bool readKeyword(const_pointer_t p)
+        {
+            static const char* const keywords[] = { "--", "[CDATA[", "DOCTYPE" };
+
+            if (mCount == 0) {
+                if (*p == '-')
+                    mKeyword = 0;
+                else if (*p == '[')
+                    mKeyword = 1;
+                else if (*p == 'D')
+                    mKeyword = 2;
+                else
+                    return fail(reader_t::invalid_tag, p);
+            } else if (*p != static_cast<charT>(keywords[mKeyword][mCount])) {
+                return fail(reader_t::invalid_tag, p);
+            }
+
+            if (keywords[mKeyword][++mCount] != '\0')
+                return true;
+
+            mCount = 0;
+
+            switch (mKeyword) {
+            case 0:
+                mState = state_comment;
+                begin(p + 1);
+                break;
+
+            case 1:
+                if (mNameEnds.empty())
+                    return fail(reader_t::invalid_tag, p);
+
+                mState = state_cdata;
+                begin(p + 1);
+                break;
+
+            default:
+                if (mRootSeen || mDoctypeSeen)
+                    return fail(reader_t::invalid_doctype, p);
+
+                mDoctypeSeen = true;
+
+                mState  = state_doctype;
+                mQuote  = 0;
+                mSubset = false;
+                begin(p + 1);
+
+                for (const char* c = "<!DOCTYPE"; *c != '\0'; ++c)
+                    mPending.push_back(*c);
+                break;
+            }
+
+            return true;
+        }
+
+        //! \brief Track the comments and processing instructions of an internal subset.
+        /*!
+         *  Their content is skipped as \c basic_reader does, so that it can
+         *  hold quotes and brackets. \c mCount holds the progress : 1 to 3
+         *  while \c "<!--" is matched, 4 to 6 inside a comment, and 7 and 8
+         *  inside a processing instruction.
+         *
+         *  \param [in] c The character read.
+         *
+         *  \return \c true if \c c belongs to such markup.
+         */
+        bool skipSubsetMarkup(charT c)
+        {
+            switch (mCount) {
+            case 1:
+                mCount = c == '!' ? 2 : c == '?' ? 7 : 0;
+                return mCount != 0;
+
+            case 2:
+            case 3:
+                mCount = c == '-' ? mCount + 1 : 0;
+                return mCount != 0;
+
+            case 4:
+            case 5:
+                mCount = c == '-' ? mCount + 1 : 4;
+                return true;
+
+            case 6:
+                mCount = c == '>' ? 0 : c == '-' ? 6 : 4;
+                return true;
+
+            case 7:
+            case 8:
+                mCount = c == '?' ? 8 : c == '>' && mCount == 8 ? 0 : 7;
+                return true;
+
+            default:
+                mCount = mSubset && c == '<' ? 1 : 0;
+                return mCount != 0;
+            }
+        }
+
+        //! \brief Skip the byte order mark at the start of the document.
+        /*!
+         *  A byte order mark held by the first chunk is skipped by
+         *  \c reader_t::skip_byte_order_mark(). The bytes of a UTF-8 byte
+         *  order mark split across the first chunks are matched one by one.
+         *
+         *  \param [in,out] p   A pointer to the next character of the chunk.
+         *  \param [in]     end A pointer past the last character of the chunk.
+         *
+         *  \return \c false if the document starts with an incomplete byte
+         *          order mark, \c true otherwise.
+         */
+        bool skipByteOrderMark(const_pointer_t& p, const_pointer_t end)
+        {
+            static const uint32_t mark[3] = { 0xEF, 0xBB, 0xBF };
+
+            const size_t length = sizeof(charT) == 1 ? 3 : 1;
+
+            if (mConsumed != mByteOrderMark || mByteOrderMark == length)
+                return true;
+
+            if (mConsumed == 0 && size_t(end - p) >= length) {
+                const_pointer_t first = p;
+
+                p = reader_t::skip_byte_order_mark(first, end);
+                mByteOrderMark = p - first;
+
+                return true;
+            }
+
+            while (mByteOrderMark < length && p != end && scanner_t::code(*p) == mark[mByteOrderMark]) {
+                ++mByteOrderMark;
+                ++p;
+            }
+
+            if (mByteOrderMark != 0 && mByteOrderMark < length && p != end)
+                return fail(reader_t::text_outside_root, p);
+
+            return true;
+        }
+
+        //! \brief Report a processing instruction or the XML declaration.
+        /*!
+         *  The whole instruction has been captured, and it is tokenized with
+         *  a \c basic_reader.
+         *
+         *  \param [in] markup The whole processing instruction.
+         *  \param [in] where  A pointer past the processing instruction.
+         *
+         *  \return \c false if an error has been found or if the handler
+         *          stopped the parsing.
+         */
+        bool reportProcessingInstruction(const view_t& markup, const_pointer_t where)
+        {
+            const bool atStart = mConsumed + (where - mChunkStart) == mByteOrderMark + markup.size();
+
+            reader_t reader(markup.begin(), markup.end());
+
+            switch (reader.next()) {
+            case reader_t::declaration:
+                if (!atStart)
+                    return fail(reader_t::invalid_declaration, where - markup.size());
+
+                while (reader.next() == reader_t::attribute) {
+                    if (!mHandler.declaration(reader.name(), reader.value()))
+                        return stop();
+
+                    if (reader.name().equals("encoding") && utf8::is_utf8(reader.value().begin(), reader.value().end()))
+                        mValidating = sizeof(charT) == 1;
+                }
+
+                if (reader.position() != reader.data() + markup.size())
+                    return fail(reader_t::invalid_declaration, where - markup.size() + reader.offset());
+
+                return !mValidating || validateEncoding(where, mChunkEnd);
+
+            case reader_t::processing_instruction:
+                return mHandler.processing_instruction(reader.name(), reader.value()) || stop();
+
+            default:
+                return fail(reader.error_code(), where - markup.size() + reader.offset());
+            }
+        }
+
+        //! \brief Validate a part of a document declared as UTF-8.
+        /*!
+         *  The sequence cut by the end of the previous chunk is completed
+         *  first, and the sequence cut by the end of this part is kept.
+         *
+         *  \param [in] first A pointer to the first character to check.
+         *  \param [in] last  A pointer past the last character of the chunk.
+         *
+         *  \return \c false if an invalid sequence has been found.
+         */
+        bool validateEncoding(const_pointer_t first, const_pointer_t last)
+        {
+            if (mCarried != 0) {
+                const uint8_t carried = mCarried;
+                const size_t  size    = utf8::length(mCarry[0]);
+
+                while (mCarried < size && first != last)
+                    mCarry[mCarried++] = static_cast<char>(*first++);
+
+                if (mCarried < size)
+                    return true;
+
+                mCarried = 0;
+
+                if (utf8::validate(mCarry, mCarry + size) != mCarry + size) {
+                    fail(reader_t::invalid_encoding, mChunkStart);
+                    mErrorAt -= carried;
+
+                    return false;
+                }
+            }
+
+            const char* begin   = reinterpret_cast<const char*>(first);
+            const char* end     = reinterpret_cast<const char*>(last);
+            const char* cut     = utf8::truncated(begin, end);
+            const char* invalid = utf8::validate(begin, cut);
+
+            if (invalid != cut)
+                return fail(reader_t::invalid_encoding, first + (invalid - begin));
+
+            while (cut != end)
+                mCarry[mCarried++] = *cut++;
+
+            return true;
+        }
+
+        //! \brief Report a document type declaration.
+        /*!
+         *  The whole declaration has been captured, and it is tokenized with
+         *  a \c basic_reader.
+         *
+         *  \param [in] markup The whole document type declaration.
+         *  \param [in] where  A pointer past the declaration.
+         *
+         *  \return \c false if an error has been found or if the handler
+         *          stopped the parsing.
+         */
+        bool reportDoctype(const view_t& markup, const_pointer_t where)
+        {
+            reader_t reader(markup.begin(), markup.end());
+
+            if (reader.next() != reader_t::doctype)
+                return fail(reader_t::invalid_doctype, where - markup.size() + reader.offset());
+
+            return mHandler.doctype(reader.name(), reader.value()) || stop();
+        }
+
+        //! \brief Report an error.
+        /*!
+         *  \param [in] code  The error code.
+         *  \param [in] where A pointer to the faulty character in the current
+         *                    chunk, or \c nullptr for the end of the document.
+         *
+         *  \return \c false.
+         */
+        bool fail(error_t code, const_pointer_t where)
+        {
+            mError   = code;
+            mErrorAt = mConsumed + (where != nullptr ? where - mChunkStart : 0);
+            mState   = state_finished;
+
+            return false;
+        }
+
+        //! \brief Stop parsing at the request of the handler.
+        /*!
+         *  \return \c false.
+         */
+        bool stop()
+        {
+            mState = state_finished;
+
+            return false;
+        }
+
+        handlerT& mHandler; //!< The handler events are reported to.
+
+        state_t  mState;       //!< The current internal state.
+        uint8_t  mCount;       //!< The number of characters matched in a delimiter or keyword.
+        uint32_t mQuote;       //!< The quote delimiting the current value, if any.
+        uint8_t  mKeyword;     //!< The keyword being matched after \c "<!".
+        bool     mSpace;       //!< Whether a white space followed the last name or value of a tag.
+        bool     mSubset;      //!< Whether the internal subset of a doctype is being read.
+        bool     mRootSeen;    //!< Whether the root element has been found.
+        bool     mDoctypeSeen; //!< Whether a document type declaration has been found.
+        bool     mDone;        //!< Whether the whole document has been parsed successfully.
+
+        bool    mValidating; //!< Whether the document is validated as UTF-8.
+        char    mCarry[4];   //!< The beginning of a UTF-8 sequence split across chunks.
+        uint8_t mCarried;    //!< The number of bytes in \c mCarry.
+
+        error_t mError;         //!< The error found in the document.
+        size_t  mConsumed;      //!< The number of characters in the previous chunks.
+        size_t  mByteOrderMark; //!< The number of characters of the byte order mark skipped.
+        size_t  mErrorAt;       //!< The offset of the error.
+
+        const_pointer_t mChunkStart; //!< A pointer to the first character of the current chunk.
+        const_pointer_t mChunkEnd;   //!< A pointer past the last character of the current chunk.
+        const_pointer_t mMark;       //!< A pointer to the beginning of the current token in the chunk.
+
+        string_t mPending; //!< The beginning of a token split across chunks.
+
+        string_t            mNames;    //!< The names of the open elements.
+        std::vector<size_t> mNameEnds; //!< The end offset of each name in \c mNames.
+
+        string_t            mTagNames;    //!< The attribute names of the current tag.
+        std::vector<size_t> mTagNameEnds; //!< The end offset of each name in \c mTagNames.
+    };
+
+    typedef basic_push_parser<char>    push_parser;  //!< A specialized \c basic_push_parser for char.
+    typedef basic_push_parser<wchar_t> wpush_parser; //!< A specialized \c basic_push_parser for wchar_t.
+}
+
+#endif /* PUSH_PARSER_H_INCLUDED */
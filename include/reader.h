@@ -0,0 +1,861 @@
+#ifndef READER_H_INCLUDED
+#define READER_H_INCLUDED
+
+#include <vector>
+#include <cstddef>
+
+#include <string-view.h>
+#include <scanner.h>
+#include <utf8.h>
+
+namespace xml {
+    //! \brief A XML pull tokenizer.
+    /*!
+     *  This class reads a XML document from a contiguous buffer of
+     *  characters and returns one token each time \c next() is called.
+     *  It never copies the input : names and values are reported as
+     *  \c basic_string_view referencing the buffer, which must outlive the
+     *  reader.
+     *
+     *  A start tag is reported as a \c start_element token followed by one
+     *  \c attribute token per attribute. An empty element tag is reported
+     *  as a \c start_element token followed by an \c end_element token.
+     *  The XML declaration is reported as a \c declaration token followed
+     *  by one \c attribute token per pseudo-attribute. Character and
+     *  entity references are not decoded.
+     *
+     *  When the XML declaration of a \c char document declares the UTF-8
+     *  encoding, the rest of the document is validated in blocks as the
+     *  reader advances, one block ahead of the cursor, and an
+     *  \c invalid_encoding error is reported in place of the token that
+     *  holds a malformed sequence. A document that does not declare
+     *  \c encoding="UTF-8" explicitly, including one without an XML
+     *  declaration, is not validated : its bytes are reported as they are.
+     *
+     *  With \c parse_trusted, the reader only checks what it needs to
+     *  split the document into tokens without reading past its end : names
+     *  are not validated, duplicate attributes are not detected, end tags
+     *  are not matched against start tags, and the encoding is not
+     *  validated. It is meant for documents produced by trusted writers.
+     *
+     *  Once an error has been found, the reader stays on the \c error token.
+     *
+     *  \sa xml::basic_scanner
+     *
+     *  \tparam charT The type of character used in the XML document.
+     *                By default, char and wchar_t are supported.
+     */
+    template <typename charT>
+    class basic_reader {
+    public:
+        //! \name Member types
+        //!@{
+        typedef basic_scanner<charT>     scanner_t; //!< The scanner type.
+        typedef basic_string_view<charT> view_t;    //!< The type of names and values.
+
+        typedef const charT* const_pointer_t; //!< Pointer to a constant character.
+
+        typedef basic_reader<charT> reader_t;                 //!< The type of reader.
+        typedef reader_t&           reader_reference_t;       //!< Reference to \c reader_t.
+        typedef const reader_t&     reader_const_reference_t; //!< Constant reference to \c reader_t.
+
+        //!@}
+
+        //! The available token types.
+        enum token_t {
+            none,                   //!< No token has been read yet.
+            declaration,            //!< The XML declaration.
+            doctype,                //!< A document type declaration.
+            start_element,          //!< A start tag or an empty element tag.
+            attribute,              //!< An attribute of the last start tag or declaration.
+            end_element,            //!< An end tag, or the end of an empty element tag.
+            text,                   //!< Character data.
+            cdata,                  //!< A CDATA section.
+            comment,                //!< A comment.
+            processing_instruction, //!< A processing instruction.
+            end_document,           //!< The end of the document.
+            error                   //!< The document is not well-formed.
+        };
+
+        //! The available error codes.
+        enum error_t {
+            no_error,                //!< No error has been found.
+            unexpected_end,          //!< The document ends in the middle of a token.
+            invalid_name,            //!< A name contains an invalid character.
+            invalid_tag,             //!< A tag is malformed.
+            invalid_attribute,       //!< An attribute is malformed.
+            invalid_attribute_value, //!< An attribute value contains a \c '<'.
+            duplicate_attribute,     //!< An attribute is defined twice in a tag.
+            invalid_comment,         //!< A comment contains \c "--".
+            invalid_declaration,     //!< The XML declaration is misplaced or malformed.
+            invalid_doctype,         //!< The document type declaration is misplaced or malformed.
+            mismatched_tag,          //!< An end tag does not match the current start tag.
+            unclosed_element,        //!< The document ends before the root element is closed.
+            no_root,                 //!< The document has no root element.
+            multiple_roots,          //!< The document has more than one root element.
+            text_outside_root,       //!< Character data is found outside of the root element.
+            invalid_encoding,        //!< The document is not valid in its declared encoding.
+            invalid_reference,       //!< A character or entity reference is malformed, when values are decoded.
+            invalid_namespace        //!< A prefix is not bound or a namespace is misdeclared, when namespaces are resolved.
+        };
+
+        //! The available parsing options, that can be combined.
+        enum flags_t {
+            parse_default            = 0,      //!< Read a whole document.
+            parse_fragment           = 1 << 0, //!< Read a slice of a document, starting at a \c '<'.
+            parse_unchecked_encoding = 1 << 1, //!< Do not validate a document declared as UTF-8.
+            parse_trusted            = 1 << 2, //!< Skip the well-formedness checks of names, attributes and end tags.
+            parse_no_namespaces      = 1 << 3, //!< Do not resolve namespace prefixes, when a tree is built.
+            parse_strip_whitespace   = 1 << 4  //!< Drop the texts made of white spaces outside \c xml:space="preserve", when a tree is built.
+        };
+
+        //! \brief Constructor.
+        /*!
+         *  Builds a reader over the characters in between \c first (included)
+         *  and \c last (excluded). A leading byte order mark is skipped.
+         *
+         *  \param [in] first A pointer to the first character of the document.
+         *  \param [in] last  A pointer past the last character of the document.
+         *  \param [in] flags A combination of \c flags_t.
+         */
+        basic_reader(const_pointer_t first, const_pointer_t last, unsigned flags = parse_default)
+        :
+            mStack(),
+            mAttributes()
+        {
+            reset(first, last, flags);
+        }
+
+        //! \brief Destructor.
+        /*!
+         *  This destructor does nothing.
+         */
+        virtual ~basic_reader()
+        {}
+
+        //! \brief Restart the reader on a new buffer.
+        /*!
+         *  This function allows to reuse the internal buffers of a reader
+         *  to read several documents without allocating memory.
+         *
+         *  With \c parse_fragment, the buffer is a slice of a document : end
+         *  tags may close elements opened before the slice, elements may be
+         *  left open at its end, and several elements and character data may
+         *  appear at its top level. The XML declaration is rejected.
+         *
+         *  \param [in] first A pointer to the first character of the document.
+         *  \param [in] last  A pointer past the last character of the document.
+         *  \param [in] flags A combination of \c flags_t.
+         */
+        void reset(const_pointer_t first, const_pointer_t last, unsigned flags = parse_default)
+        {
+            mFlags  = flags;
+            mBegin  = (flags & parse_fragment) ? first : skip_byte_order_mark(first, last);
+            mCursor = mBegin;
+            mEnd    = last;
+
+            mToken      = none;
+            mState      = state_content;
+            mName       = view_t();
+            mValue      = view_t();
+            mTokenStart = mBegin;
+
+            mError     = no_error;
+            mValidated = nullptr;
+
+            mRootSeen    = false;
+            mDoctypeSeen = false;
+
+            mStack.clear();
+            mAttributes.clear();
+        }
+
+        //! \brief Read the next token.
+        /*!
+         *  \return The type of the token that has been read.
+         */
+        token_t next()
+        {
+            const token_t token = read();
+
+            if (mValidated == nullptr || mCursor <= mValidated)
+                return token;
+
+            return validateEncoding(token);
+        }
+
+        //! \brief Get the current token type.
+        /*!
+         *  \return The type of the last token read.
+         */
+        token_t token() const { return mToken; }
+
+        //! \brief Get the name of the current token.
+        /*!
+         *  It is the element name for \c start_element and \c end_element,
+         *  the attribute name for \c attribute, the target for
+         *  \c processing_instruction and the root name for \c doctype.
+         *
+         *  \return A view over the name of the current token.
+         */
+        const view_t& name() const { return mName; }
+
+        //! \brief Get the value of the current token.
+        /*!
+         *  It is the attribute value for \c attribute, the content for
+         *  \c text, \c cdata, \c comment and \c processing_instruction, and
+         *  everything after the root name for \c doctype.
+         *
+         *  \return A view over the value of the current token.
+         */
+        const view_t& value() const { return mValue; }
+
+        //! \brief Get the current depth.
+        /*!
+         *  \return The number of elements currently open.
+         */
+        size_t depth() const { return mStack.size(); }
+
+        //! \brief Get the error code.
+        /*!
+         *  \return The error found in the document, or \c no_error.
+         */
+        error_t error_code() const { return mError; }
+
+        //! \brief Get the offset of the current token.
+        /*!
+         *  If an error has been found, this is the offset of the character
+         *  that caused it.
+         *
+         *  \return The offset of the current token from the beginning of
+         *          the document, in characters.
+         */
+        size_t offset() const { return mTokenStart - mBegin; }
+
+        //! \brief Get a pointer to the beginning of the document.
+        /*!
+         *  \return A pointer to the first character of the document.
+         */
+        const_pointer_t data() const { return mBegin; }
+
+        //! \brief Skip a leading byte order mark.
+        /*!
+         *  The byte order mark is EF BB BF for \c char, and U+FEFF for the
+         *  wider character types.
+         *
+         *  \param [in] first A pointer to the first character of the document.
+         *  \param [in] last  A pointer past the last character of the document.
+         *
+         *  \return A pointer to the first character after the byte order mark.
+         */
+        static const_pointer_t skip_byte_order_mark(const_pointer_t first, const_pointer_t last)
+        {
+            if (sizeof(charT) == 1) {
+                if (last - first >= 3 &&
+                    scanner_t::code(first[0]) == 0xEF &&
+                    scanner_t::code(first[1]) == 0xBB &&
+                    scanner_t::code(first[2]) == 0xBF)
+                    return first + 3;
+            } else if (first != last && scanner_t::code(*first) == 0xFEFF) {
+                return first + 1;
+            }
+
+            return first;
+        }
+
+        //! \brief Whether the encoding of the document is validated.
+        /*!
+         *  \return \c true once the XML declaration of a \c char document
+         *          has declared the UTF-8 encoding, unless validation has
+         *          been disabled by the flags.
+         */
+        bool checks_encoding() const { return mValidated != nullptr; }
+
+        //! \brief Get a pointer to the next character to read.
+        /*!
+         *  \return A pointer to the character following the current token.
+         */
+        const_pointer_t position() const { return mCursor; }
+
+    private:
+        //! The internal states of the reader.
+        enum state_t {
+            state_content,     //!< Reading the content of an element.
+            state_start_tag,   //!< Reading the attributes of a start tag.
+            state_declaration, //!< Reading the pseudo-attributes of the XML declaration.
+            state_finished     //!< The end of the document or an error has been reached.
+        };
+
+        //! The number of characters validated ahead of the cursor.
+        static const size_t sValidationBlock = 1 << 16;
+
+        //! \brief Read the next token, whatever its encoding.
+        /*!
+         *  \return The type of the token that has been read.
+         */
+        token_t read()
+        {
+            switch (mState) {
+            case state_start_tag:
+                return readAttribute(false);
+            case state_declaration:
+                return readAttribute(true);
+            case state_finished:
+                return mToken;
+            default:
+                return readContent();
+            }
+        }
+
+        //! \brief Set the current token.
+        /*!
+         *  \param [in] token The token type.
+         *  \param [in] start A pointer to the beginning of the token.
+         *  \param [in] name  The name of the token.
+         *  \param [in] value The value of the token.
+         *
+         *  \return \c token.
+         */
+        token_t emit(token_t token, const_pointer_t start, const view_t& name, const view_t& value)
+        {
+            mToken      = token;
+            mTokenStart = start;
+            mName       = name;
+            mValue      = value;
+
+            return token;
+        }
+
+        //! \brief Report an error.
+        /*!
+         *  \param [in] code  The error code.
+         *  \param [in] where A pointer to the faulty character.
+         *
+         *  \return \c error.
+         */
+        token_t fail(error_t code, const_pointer_t where)
+        {
+            mError = code;
+            mState = state_finished;
+
+            return emit(error, where, view_t(), view_t());
+        }
+
+        //! \brief Whether the buffer holds an ASCII keyword at a given position.
+        /*!
+         *  \param [in] first A pointer to the first character to compare.
+         *  \param [in] str   A null-terminated ASCII keyword.
+         *
+         *  \return \c true if the buffer holds \c str at \c first.
+         */
+        bool matches(const_pointer_t first, const char* str) const
+        {
+            for (; *str != '\0'; ++first, ++str)
+                if (first == mEnd || *first != static_cast<charT>(*str))
+                    return false;
+
+            return true;
+        }
+
+        //! \brief Validate a document declared as UTF-8 up to the cursor.
+        /*!
+         *  The next block after the cursor is validated along, so that the
+         *  validation is not restarted for each token. A sequence cut by
+         *  the end of the block is left to the next one, and an invalid
+         *  sequence found past the cursor is reported once the cursor
+         *  has passed it.
+         *
+         *  \param [in] token The type of the token that has been read.
+         *
+         *  \return \c token, or \c error if the characters read hold an
+         *          invalid sequence.
+         */
+        token_t validateEncoding(token_t token)
+        {
+            const_pointer_t last  = size_t(mEnd - mCursor) > sValidationBlock ? mCursor + sValidationBlock : mEnd;
+            const char*     first = reinterpret_cast<const char*>(mValidated);
+            const char*     cut   = reinterpret_cast<const char*>(last);
+
+            if (last != mEnd)
+                cut = utf8::truncated(first, cut);
+
+            mValidated += utf8::validate(first, cut) - first;
+
+            if (mValidated < mCursor && token != error)
+                return fail(invalid_encoding, mValidated);
+
+            return token;
+        }
+
+        //! \brief Read a name.
+        /*!
+         *  \param [in] first A pointer to the first character of the name.
+         *
+         *  \return A pointer past the name, or \c nullptr if it is invalid.
+         */
+        const_pointer_t readName(const_pointer_t first)
+        {
+            if (first == mEnd) {
+                fail(unexpected_end, first);
+                return nullptr;
+            }
+
+            if (mFlags & parse_trusted) {
+                const_pointer_t last = scanner_t::find_name_delimiter(first, mEnd);
+
+                if (last == mEnd) {
+                    fail(unexpected_end, last);
+                    return nullptr;
+                }
+
+                return last;
+            }
+
+            if (!scanner_t::is_name_start(*first)) {
+                fail(invalid_name, first);
+                return nullptr;
+            }
+
+            const_pointer_t last = scanner_t::find_name_end(first + 1, mEnd);
+
+            if (last == mEnd) {
+                fail(unexpected_end, last);
+                return nullptr;
+            }
+
+            if (!scanner_t::is_name_delimiter(*last)) {
+                fail(invalid_name, last);
+                return nullptr;
+            }
+
+            return last;
+        }
+
+        //! \brief Read the content of an element until the next token.
+        /*!
+         *  White spaces outside of the root element are skipped.
+         *
+         *  \return The type of the token that has been read.
+         */
+        token_t readContent()
+        {
+            for (;;) {
+                if (mCursor == mEnd) {
+                    if (mFlags & parse_fragment) {
+                        mState = state_finished;
+                        return emit(end_document, mCursor, view_t(), view_t());
+                    }
+
+                    if (!mStack.empty())
+                        return fail(unclosed_element, mCursor);
+
+                    if (!mRootSeen)
+                        return fail(no_root, mCursor);
+
+                    mState = state_finished;
+                    return emit(end_document, mCursor, view_t(), view_t());
+                }
+
+                if (*mCursor != '<') {
+                    const_pointer_t first = mCursor;
+
+                    mCursor = scanner_t::find(mCursor, mEnd, '<');
+
+                    if (!mStack.empty() || (mFlags & parse_fragment))
+                        return emit(text, first, view_t(), view_t(first, mCursor));
+
+                    if (!scanner_t::all_whitespace(first, mCursor))
+                        return fail(text_outside_root, first);
+
+                    continue;
+                }
+
+                if (mEnd - mCursor < 2)
+                    return fail(unexpected_end, mEnd);
+
+                switch (mCursor[1]) {
+                case '/':
+                    return readEndTag();
+                case '!':
+                    return readMarkupDeclaration();
+                case '?':
+                    return readProcessingInstruction();
+                default:
+                    return readStartTag();
+                }
+            }
+        }
+
+        //! \brief Read the name of a start tag.
+        /*!
+         *  \return The type of the token that has been read.
+         */
+        token_t readStartTag()
+        {
+            const_pointer_t start = mCursor;
+
+            if (mRootSeen && mStack.empty() && !(mFlags & parse_fragment))
+                return fail(multiple_roots, start);
+
+            const_pointer_t last = readName(start + 1);
+
+            if (last == nullptr)
+                return mToken;
+
+            const view_t name(start + 1, last);
+
+            mStack.push_back(name);
+            mAttributes.clear();
+
+            mRootSeen = true;
+            mCursor   = last;
+            mState    = state_start_tag;
+
+            return emit(start_element, start, name, view_t());
+        }
+
+        //! \brief Read an attribute, or the end of a tag.
+        /*!
+         *  \param [in] isDeclaration Whether the pseudo-attributes of the
+         *                            XML declaration are being read.
+         *
+         *  \return The type of the token that has been read.
+         */
+        token_t readAttribute(bool isDeclaration)
+        {
+            const_pointer_t first = scanner_t::skip_whitespace(mCursor, mEnd);
+
+            if (first == mEnd)
+                return fail(unexpected_end, first);
+
+            if (isDeclaration) {
+                if (*first == '?') {
+                    if (first + 1 == mEnd || first[1] != '>')
+                        return fail(invalid_declaration, first);
+
+                    mCursor = first + 2;
+                    mState  = state_content;
+
+                    return readContent();
+                }
+            } else if (*first == '>') {
+                mCursor = first + 1;
+                mState  = state_content;
+
+                return readContent();
+            } else if (*first == '/') {
+                if (first + 1 == mEnd || first[1] != '>')
+                    return fail(invalid_tag, first);
+
+                const view_t name = mStack.back();
+
+                mStack.pop_back();
+                mCursor = first + 2;
+                mState  = state_content;
+
+                return emit(end_element, first, name, view_t());
+            }
+
+            if (first == mCursor)
+                return fail(invalid_attribute, first);
+
+            const_pointer_t nameLast = readName(first);
+
+            if (nameLast == nullptr)
+                return mToken;
+
+            const view_t name(first, nameLast);
+
+            const_pointer_t cursor = scanner_t::skip_whitespace(nameLast, mEnd);
+
+            if (cursor == mEnd)
+                return fail(unexpected_end, cursor);
+
+            if (*cursor != '=')
+                return fail(invalid_attribute, cursor);
+
+            cursor = scanner_t::skip_whitespace(cursor + 1, mEnd);
+
+            if (cursor == mEnd)
+                return fail(unexpected_end, cursor);
+
+            const charT quote = *cursor;
+
+            if (quote != '"' && quote != '\'')
+                return fail(invalid_attribute, cursor);
+
+            const_pointer_t valueFirst = cursor + 1;
+            const_pointer_t valueLast  = scanner_t::find_first_of(valueFirst, mEnd, quote, '<');
+
+            if (valueLast == mEnd)
+                return fail(unexpected_end, valueLast);
+
+            if (*valueLast == '<')
+                return fail(invalid_attribute_value, valueLast);
+
+            if (!(mFlags & parse_trusted)) {
+                for (const view_t& previous : mAttributes)
+                    if (previous == name)
+                        return fail(duplicate_attribute, first);
+
+                mAttributes.push_back(name);
+            }
+
+            if (isDeclaration && sizeof(charT) == 1 && !(mFlags & (parse_unchecked_encoding | parse_trusted)) &&
+                name.equals("encoding") && utf8::is_utf8(valueFirst, valueLast))
+                mValidated = valueLast + 1;
+
+            mCursor = valueLast + 1;
+
+            return emit(attribute, first, name, view_t(valueFirst, valueLast));
+        }
+
+        //! \brief Read an end tag.
+        /*!
+         *  \return The type of the token that has been read.
+         */
+        token_t readEndTag()
+        {
+            const_pointer_t start = mCursor;
+            const_pointer_t last  = readName(start + 2);
+
+            if (last == nullptr)
+                return mToken;
+
+            const view_t name(start + 2, last);
+
+            const_pointer_t cursor = scanner_t::skip_whitespace(last, mEnd);
+
+            if (cursor == mEnd)
+                return fail(unexpected_end, cursor);
+
+            if (*cursor != '>')
+                return fail(invalid_tag, cursor);
+
+            if (mStack.empty() && (mFlags & parse_fragment)) {
+                mCursor = cursor + 1;
+                return emit(end_element, start, name, view_t());
+            }
+
+            if (mStack.empty() || (!(mFlags & parse_trusted) && mStack.back() != name))
+                return fail(mismatched_tag, start);
+
+            mStack.pop_back();
+            mCursor = cursor + 1;
+
+            return emit(end_element, start, name, view_t());
+        }
+
+        //! \brief Read a comment, a CDATA section or a document type declaration.
+        /*!
+         *  \return The type of the token that has been read.
+         */
+        token_t readMarkupDeclaration()
+        {
+            const_pointer_t start = mCursor;
+
+            if (matches(start, "<!--")) {
+                const_pointer_t first  = start + 4;
+                const_pointer_t cursor = first;
+
+                for (;;) {
+                    cursor = scanner_t::find(cursor, mEnd, '-');
+
+                    if (mEnd - cursor < 3)
+                        return fail(unexpected_end, mEnd);
+
+                    if (cursor[1] == '-') {
+                        if (cursor[2] != '>')
+                            return fail(invalid_comment, cursor);
+
+                        mCursor = cursor + 3;
+                        return emit(comment, start, view_t(), view_t(first, cursor));
+                    }
+
+                    ++cursor;
+                }
+            }
+
+            if (matches(start, "<![CDATA[")) {
+                if (mStack.empty() && !(mFlags & parse_fragment))
+                    return fail(invalid_tag, start);
+
+                const_pointer_t first  = start + 9;
+                const_pointer_t cursor = first;
+
+                for (;;) {
+                    cursor = scanner_t::find(cursor, mEnd, ']');
+
+                    if (mEnd - cursor < 3)
+                        return fail(unexpected_end, mEnd);
+
+                    if (cursor[1] == ']' && cursor[2] == '>') {
+                        mCursor = cursor + 3;
+                        return emit(cdata, start, view_t(), view_t(first, cursor));
+                    }
+
+                    ++cursor;
+                }
+            }
+
+            if (matches(start, "<!DOCTYPE"))
+                return readDoctype();
+
+            return fail(invalid_tag, start);
+        }
+
+        //! \brief Read a document type declaration.
+        /*!
+         *  The internal subset is not interpreted, but quoted strings,
+         *  comments and processing instructions are skipped so that they
+         *  can hold \c '>' characters.
+         *
+         *  \return The type of the token that has been read.
+         */
+        token_t readDoctype()
+        {
+            const_pointer_t start = mCursor;
+
+            if (mRootSeen || mDoctypeSeen)
+                return fail(invalid_doctype, start);
+
+            const_pointer_t first = start + 9;
+
+            if (first == mEnd || !scanner_t::is_whitespace(*first))
+                return fail(invalid_doctype, first);
+
+            first = scanner_t::skip_whitespace(first, mEnd);
+
+            const_pointer_t nameLast = readName(first);
+
+            if (nameLast == nullptr)
+                return mToken;
+
+            const_pointer_t cursor = nameLast;
+            bool subset = false;
+
+            while (cursor != mEnd) {
+                const charT c = *cursor;
+
+                if (c == '"' || c == '\'') {
+                    cursor = scanner_t::find(cursor + 1, mEnd, c);
+
+                    if (cursor == mEnd)
+                        break;
+                } else if (subset) {
+                    if (c == ']') {
+                        subset = false;
+                    } else if (matches(cursor, "<!--")) {
+                        cursor += 4;
+
+                        while (cursor != mEnd && !matches(cursor, "-->"))
+                            cursor = scanner_t::find(cursor + 1, mEnd, '-');
+
+                        if (cursor == mEnd)
+                            break;
+
+                        cursor += 2;
+                    } else if (matches(cursor, "<?")) {
+                        cursor += 2;
+
+                        while (cursor != mEnd && !matches(cursor, "?>"))
+                            cursor = scanner_t::find(cursor + 1, mEnd, '?');
+
+                        if (cursor == mEnd)
+                            break;
+
+                        cursor += 1;
+                    }
+                } else if (c == '[') {
+                    subset = true;
+                } else if (c == '>') {
+                    break;
+                }
+
+                ++cursor;
+            }
+
+            if (cursor == mEnd)
+                return fail(unexpected_end, mEnd);
+
+            mDoctypeSeen = true;
+            mCursor      = cursor + 1;
+
+            return emit(doctype, start, view_t(first, nameLast), view_t(nameLast, cursor));
+        }
+
+        //! \brief Read a processing instruction or the XML declaration.
+        /*!
+         *  \return The type of the token that has been read.
+         */
+        token_t readProcessingInstruction()
+        {
+            const_pointer_t start = mCursor;
+            const_pointer_t last  = readName(start + 2);
+
+            if (last == nullptr)
+                return mToken;
+
+            const view_t target(start + 2, last);
+
+            if (target.size() == 3 &&
+                (scanner_t::code(target[0]) | 0x20) == 'x' &&
+                (scanner_t::code(target[1]) | 0x20) == 'm' &&
+                (scanner_t::code(target[2]) | 0x20) == 'l') {
+
+                if (start != mBegin || !target.equals("xml") || (mFlags & parse_fragment))
+                    return fail(invalid_declaration, start);
+
+                mAttributes.clear();
+
+                mCursor = last;
+                mState  = state_declaration;
+
+                return emit(declaration, start, target, view_t());
+            }
+
+            const_pointer_t first  = scanner_t::skip_whitespace(last, mEnd);
+            const_pointer_t cursor = first;
+
+            for (;;) {
+                cursor = scanner_t::find(cursor, mEnd, '?');
+
+                if (mEnd - cursor < 2)
+                    return fail(unexpected_end, mEnd);
+
+                if (cursor[1] == '>') {
+                    mCursor = cursor + 2;
+                    return emit(processing_instruction, start, target, view_t(first, cursor));
+                }
+
+                ++cursor;
+            }
+        }
+
+        unsigned mFlags; //!< The parsing options.
+
+        const_pointer_t mBegin;  //!< A pointer to the first character of the document.
+        const_pointer_t mCursor; //!< A pointer to the next character to read.
+        const_pointer_t mEnd;    //!< A pointer past the last character of the document.
+
+        token_t         mToken;      //!< The current token type.
+        state_t         mState;      //!< The current internal state.
+        view_t          mName;       //!< The name of the current token.
+        view_t          mValue;      //!< The value of the current token.
+        const_pointer_t mTokenStart; //!< A pointer to the beginning of the current token.
+
+        error_t         mError;     //!< The error found in the document.
+        const_pointer_t mValidated; //!< A pointer past the characters validated as UTF-8, or \c nullptr if the encoding is not validated.
+
+        bool mRootSeen;    //!< Whether the root element has been found.
+        bool mDoctypeSeen; //!< Whether a document type declaration has been found.
+
+        std::vector<view_t> mStack;      //!< The names of the open elements.
+        std::vector<view_t> mAttributes; //!< The attribute names of the current tag.
+    };
+
+    typedef basic_reader<char>    reader;  //!< A specialized \c basic_reader for char.
+    typedef basic_reader<wchar_t> wreader; //!< A specialized \c basic_reader for wchar_t.
+}
+
+#endif /* READER_H_INCLUDED */
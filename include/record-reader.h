@@ -0,0 +1,525 @@
+#ifndef RECORD_READER_H_INCLUDED
+#define RECORD_READER_H_INCLUDED
+
+#include <memory>
+#include <vector>
+#include <string>
+#include <iterator>
+#include <cstdlib>
+#include <stdexcept>
+
+#include <sax.h>
+#include <entity-decoder.h>
+#include <element.h>
+#include <namespace-resolver.h>
+#include <arena.h>
+#include <mapped-file.h>
+#include <exception.h>
+
+namespace xml {
+    //! \brief A reader returning the children of the root element one at a time.
+    /*!
+     *  This class reads documents made of a root element holding a long
+     *  sequence of records, and builds each element child of the root as a
+     *  standalone \c basic_element, one at a time. The previous record is
+     *  released when the next one is read, so that memory stays
+     *  proportional to the largest record.
+     *
+     *  Records are built as \c arena_node in a scratch \c arena, which is
+     *  reset for each of them, and their names and values reference the parsed buffer. Once
+     *  the arena has grown to the size of the largest record, reading a
+     *  record does not allocate memory, unless a value holds character or
+     *  entity references, which are decoded in a copy, or the record
+     *  declares namespace prefixes. A record must not be moved out of the
+     *  reader : it should be copied instead.
+     *
+     *  The namespaces of the root element and of the records are resolved
+     *  as by \c basic_builder, in the namespace table of the reader.
+     *
+     *  Text found in between records is skipped.
+     *
+     *  \sa xml::basic_sax_parser
+     *  \sa xml::arena
+     *
+     *  \tparam charT The type of character used in the XML document.
+     *                By default, char and wchar_t are supported.
+     */
+    template <typename charT>
+    class basic_record_reader {
+    public:
+        //! \name Member types
+        //!@{
+        typedef          basic_sax_parser<charT>   parser_t;        //!< The parser type.
+        typedef typename parser_t::reader_t        reader_t;        //!< The reader type.
+        typedef typename parser_t::token_t         token_t;         //!< The token type.
+        typedef typename parser_t::view_t          view_t;          //!< The type of names and values.
+        typedef typename parser_t::const_pointer_t const_pointer_t; //!< Pointer to a constant character.
+        typedef typename reader_t::scanner_t       scanner_t;       //!< The scanner type.
+        typedef typename reader_t::error_t         error_t;         //!< The error code type.
+        typedef          basic_entity_decoder<charT> decoder_t;     //!< The reference decoder type.
+        typedef          basic_parse_error<charT>  parse_error_t;   //!< The parse error type.
+        typedef          basic_exception<charT>    exception_t;     //!< The type of exception thrown on parse errors.
+
+        typedef          basic_element<charT>         element_t;         //!< The element type.
+        typedef typename element_t::element_pointer_t element_pointer_t; //!< Pointer to \c element_t.
+        typedef typename element_t::string_ref_t      string_ref_t;      //!< The type of string stored in nodes.
+        typedef typename element_t::text_t            text_t;            //!< The text type.
+        typedef typename element_t::table_t           namespace_table_t; //!< The namespace table type.
+
+        typedef basic_namespace_resolver<charT> resolver_t; //!< The namespace resolver type.
+
+        //!@}
+
+        //! \brief An input iterator over the records.
+        class iterator : public std::iterator<std::input_iterator_tag, element_t> {
+        public:
+            //! \brief Constructor.
+            /*!
+             *  \param [in] reader The reader to iterate, or \c nullptr for the end.
+             */
+            explicit iterator(basic_record_reader* reader = nullptr)
+            :
+                mReader(reader)
+            {}
+
+            //! \brief Get the current record.
+            element_t& operator*() const { return mReader->record(); }
+
+            //! \brief Get the current record.
+            element_t* operator->() const { return &mReader->record(); }
+
+            //! \brief Read the next record.
+            iterator& operator++()
+            {
+                if (!mReader->next())
+                    mReader = nullptr;
+
+                return *this;
+            }
+
+            //! \brief Whether two iterators are equal.
+            bool operator==(const iterator& rhs) const { return mReader == rhs.mReader; }
+
+            //! \brief Whether two iterators are different.
+            bool operator!=(const iterator& rhs) const { return mReader != rhs.mReader; }
+
+        private:
+            basic_record_reader* mReader; //!< The reader iterated, or \c nullptr at the end.
+        };
+
+        //! \brief Constructor.
+        /*!
+         *  Reads the prolog and the start tag of the root element of the
+         *  characters in between \c first (included) and \c last (excluded),
+         *  which must outlive the reader.
+         *
+         *  \param [in] first A pointer to the first character of the document.
+         *  \param [in] last  A pointer past the last character of the document.
+         *
+         *  \throw exception_t If the prolog or the root start tag is not
+         *                     well-formed.
+         */
+        basic_record_reader(const_pointer_t first, const_pointer_t last)
+        :
+            mFile(),
+            mParser(first, last),
+            mRoot(string_ref_t()),
+            mArena(),
+            mNamespaces(),
+            mHandler(mRoot, mNamespaces, mArena)
+        {
+            start();
+        }
+
+        //! \brief Constructor.
+        /*!
+         *  Maps the file at \c path, and reads its prolog and the start tag
+         *  of its root element. The file holds characters of type \c charT
+         *  in native byte order.
+         *
+         *  \param [in] path The path of the file.
+         *
+         *  \throw std::runtime_error If the file cannot be mapped, or if the
+         *                            prolog or the root start tag is not
+         *                            well-formed.
+         */
+        explicit basic_record_reader(const std::string& path)
+        :
+            mFile(std::make_shared<const mapped_file>(path)),
+            mParser(begin(*mFile), end(*mFile)),
+            mRoot(string_ref_t()),
+            mArena(),
+            mNamespaces(),
+            mHandler(mRoot, mNamespaces, mArena)
+        {
+            start();
+        }
+
+        basic_record_reader(const basic_record_reader&) = delete;
+        basic_record_reader& operator=(const basic_record_reader&) = delete;
+
+        //! \brief Destructor.
+        /*!
+         *  Releases the current record.
+         */
+        virtual ~basic_record_reader()
+        {
+            release();
+        }
+
+        //! \brief Read the next record.
+        /*!
+         *  The previous record is released.
+         *
+         *  \throw exception_t If the document is not well-formed.
+         *
+         *  \return \c false if there is no record left.
+         */
+        bool next()
+        {
+            release();
+
+            if (mHandler.finished())
+                return false;
+
+            if (mHandler.pending())
+                mHandler.open(mParser.reader().name());
+
+            const token_t token = mParser.parse(mHandler);
+
+            if (token == reader_t::end_element && mHandler.record() != nullptr && !mHandler.invalid())
+                return true;
+
+            mHandler.close();
+
+            if (token == reader_t::end_document)
+                return false;
+
+            mHandler.discard();
+            raise();
+
+            return false;
+        }
+
+        //! \brief Get the current record.
+        /*!
+         *  Calling this function before \c next() returned \c true causes
+         *  undefined behaviour.
+         *
+         *  \return A reference to the current record, valid until the next
+         *          call to \c next().
+         */
+        element_t& record() { return *mHandler.record(); }
+
+        //! \brief Get the current record.
+        /*!
+         *  \return A constant reference to the current record.
+         */
+        const element_t& record() const { return *mHandler.record(); }
+
+        //! \brief Get the root element.
+        /*!
+         *  \return A constant reference to the root element, holding its
+         *          name and attributes but no children.
+         */
+        const element_t& root() const { return mRoot; }
+
+        //! \brief Get the scratch arena records are built in.
+        /*!
+         *  \return A constant reference to the arena.
+         */
+        const arena& scratch() const { return mArena; }
+
+        //! \brief Get the namespace table of the root element and of the records.
+        /*!
+         *  \return A constant reference to the namespace table.
+         */
+        const namespace_table_t& namespaces() const { return mNamespaces; }
+
+        //! \brief Read the first record.
+        /*!
+         *  \return An iterator to the first record, or \c end().
+         */
+        iterator begin() { return next() ? iterator(this) : iterator(); }
+
+        //! \brief Get the end of the records.
+        /*!
+         *  \return An iterator past the last record.
+         */
+        iterator end() { return iterator(); }
+
+    private:
+        //! \brief The handler building records.
+        class handler : public basic_sax_handler<charT> {
+        public:
+            //! \brief Constructor.
+            /*!
+             *  \param [in] root       The element receiving the root name and attributes.
+             *  \param [in] namespaces The namespace table of the reader.
+             *  \param [in] memory     The arena records are built in.
+             */
+            handler(element_t& root, namespace_table_t& namespaces, arena& memory)
+            :
+                mRoot(root),
+                mArena(memory),
+                mRecord(nullptr),
+                mUnresolved(nullptr),
+                mStack(),
+                mResolver(namespaces),
+                mDepth(0),
+                mPrologue(true),
+                mPending(false),
+                mFinished(false),
+                mError(reader_t::no_error)
+            {}
+
+            //! \brief Open an element.
+            bool start_element(const view_t& name)
+            {
+                if (mUnresolved != nullptr && !resolve())
+                    return false;
+
+                ++mDepth;
+
+                if (mDepth == 1) {
+                    mRoot.name() = string_ref_t(name);
+                    mUnresolved  = &mRoot;
+                } else if (mDepth == 2 && mPrologue) {
+                    mPending = true;
+                    return false;
+                } else {
+                    open(name);
+                }
+
+                return true;
+            }
+
+            //! \brief Add an attribute to the current element.
+            bool attribute(const view_t& name, const view_t& value)
+            {
+                element_t& element = mDepth == 1 ? mRoot : *mStack.back();
+                string_ref_t decoded;
+
+                if (!decoder_t::decode(value, decoded, true))
+                    return reject(reader_t::invalid_reference);
+
+                element.attributes().emplace(string_ref_t(name), std::move(decoded));
+
+                return true;
+            }
+
+            //! \brief Close the current element.
+            bool end_element(const view_t& name)
+            {
+                if (mUnresolved != nullptr && !resolve())
+                    return false;
+
+                --mDepth;
+                mResolver.leave();
+
+                if (mDepth == 1)
+                    return false;
+
+                if (mDepth > 1)
+                    mStack.pop_back();
+
+                return true;
+            }
+
+            //! \brief Add a text node to the current element.
+            bool text(const view_t& value)
+            {
+                if (mDepth <= 1)
+                    return true;
+
+                string_ref_t decoded;
+
+                if (!decoder_t::decode(value, decoded, true))
+                    return reject(reader_t::invalid_reference);
+
+                mStack.back()->adopt_back(make<text_t>(std::move(decoded)));
+
+                return true;
+            }
+
+            //! \brief Add a CDATA section as a text node to the current element.
+            bool cdata(const view_t& value)
+            {
+                if (mDepth > 1)
+                    mStack.back()->adopt_back(make<text_t>(string_ref_t(value)));
+
+                return true;
+            }
+
+            //! \brief Open an element, creating a record at depth 2.
+            /*!
+             *  \param [in] name The name of the element.
+             */
+            void open(const view_t& name)
+            {
+                const element_pointer_t element = make<element_t>(string_ref_t(name), mArena);
+
+                if (mStack.empty()) {
+                    mPrologue = false;
+                    mPending  = false;
+                    mRecord   = element;
+                } else {
+                    mStack.back()->adopt_back(element);
+                }
+
+                mStack.push_back(element);
+                mUnresolved = element;
+            }
+
+            //! \brief Build a node of the record in the arena.
+            /*!
+             *  \param [in] args The arguments of the constructor of the node.
+             *
+             *  \return A pointer to the node.
+             */
+            template <typename nodeT, typename... argsT>
+            nodeT* make(argsT&&... args)
+            {
+                return new (mArena) arena_node<nodeT>(std::forward<argsT>(args)...);
+            }
+
+            //! \brief Resolve the namespaces of the element whose start tag has been read.
+            /*!
+             *  \return \c false if they cannot be resolved.
+             */
+            bool resolve()
+            {
+                element_t& element = *mUnresolved;
+
+                mUnresolved = nullptr;
+
+                return mResolver.resolve(element) || reject(reader_t::invalid_namespace);
+            }
+
+            //! \brief Stop at an error found by the handler.
+            /*!
+             *  \param [in] code The code of the error.
+             *
+             *  \return \c false.
+             */
+            bool reject(error_t code)
+            {
+                mError = code;
+
+                return false;
+            }
+
+            //! \brief Record that no record is left.
+            void close() { mFinished = true; }
+
+            //! \brief Delete the record being built.
+            /*!
+             *  Its nodes are left to the arena.
+             */
+            void discard()
+            {
+                delete mRecord;
+
+                mRecord     = nullptr;
+                mUnresolved = nullptr;
+                mStack.clear();
+            }
+
+            //! \brief Whether a record has been started and not built yet.
+            bool pending() const { return mPending; }
+
+            //! \brief Whether no record is left.
+            bool finished() const { return mFinished; }
+
+            //! \brief Whether the handler found an error.
+            bool invalid() const { return mError != reader_t::no_error; }
+
+            //! \brief Get the code of the error found by the handler.
+            error_t error_code() const { return mError; }
+
+            //! \brief Get the current record.
+            element_pointer_t record() const { return mRecord; }
+
+        private:
+            element_t&        mRoot;       //!< The root element.
+            arena&            mArena;      //!< The arena records are built in.
+            element_pointer_t mRecord;     //!< The current record.
+            element_pointer_t mUnresolved; //!< The element whose start tag is being read, if any.
+
+            std::vector<element_pointer_t> mStack; //!< The elements of the record currently open.
+
+            resolver_t mResolver; //!< The namespace resolver of the open elements.
+
+            size_t  mDepth;    //!< The number of elements currently open.
+            bool    mPrologue; //!< Whether no record has been started yet.
+            bool    mPending;  //!< Whether a record start tag has been read but not built.
+            bool    mFinished; //!< Whether no record is left.
+            error_t mError;    //!< The code of the error found by the handler, or \c reader_t::no_error.
+        };
+
+        //! \brief Read the prolog and the root start tag.
+        void start()
+        {
+            const token_t token = mParser.parse(mHandler);
+
+            if (token == reader_t::error || mHandler.invalid())
+                raise();
+
+            if (!mHandler.pending())
+                mHandler.close();
+        }
+
+        //! \brief Release the current record and reset the arena.
+        void release()
+        {
+            if (mHandler.record() == nullptr)
+                return;
+
+            mHandler.discard();
+            mArena.reset();
+        }
+
+        //! \brief Get the first character of a mapped file.
+        static const_pointer_t begin(const mapped_file& file)
+        {
+            return static_cast<const_pointer_t>(file.data());
+        }
+
+        //! \brief Get a pointer past the last character of a mapped file.
+        static const_pointer_t end(const mapped_file& file)
+        {
+            return begin(file) + file.size() / sizeof(charT);
+        }
+
+        //! \brief Throw an exception describing a parse error.
+        /*!
+         *  Without exception support, the program is aborted.
+         *
+         *  \throw exception_t Always.
+         */
+        void raise() const
+        {
+            const error_t code = mHandler.invalid() ? mHandler.error_code() : mParser.error_code();
+
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS)
+            throw exception_t(parse_error_t("malformed XML document", code, mParser.offset()), mParser.reader().data(), mFile);
+#else
+            (void) code;
+            std::abort();
+#endif
+        }
+
+        std::shared_ptr<const mapped_file> mFile; //!< The mapped file, if any.
+
+        parser_t          mParser;     //!< The parser reading the document.
+        element_t         mRoot;       //!< The root element, without children.
+        arena             mArena;      //!< The scratch arena records are built in.
+        namespace_table_t mNamespaces; //!< The namespace table of the root element and of the records.
+        handler           mHandler;    //!< The handler building records.
+    };
+
+    typedef basic_record_reader<char>    record_reader;  //!< A specialized \c basic_record_reader for char.
+    typedef basic_record_reader<wchar_t> wrecord_reader; //!< A specialized \c basic_record_reader for wchar_t.
+}
+
+#endif /* RECORD_READER_H_INCLUDED */
@@ -0,0 +1,224 @@
+#ifndef SAX_H_INCLUDED
+#define SAX_H_INCLUDED
+
+#include <reader.h>
+
+namespace xml {
+    //! \brief A default XML event handler.
+    /*!
+     *  This class defines every event a \c basic_sax_parser can report,
+     *  and ignores all of them. Handlers are not called through virtual
+     *  functions : a handler should inherit from this class and hide the
+     *  functions it is interested in.
+     *
+     *  Every function returns \c true to continue parsing, or \c false to
+     *  stop it. All views reference the parsed buffer and are only valid
+     *  until the parsed buffer is released.
+     *
+     *  \sa xml::basic_sax_parser
+     *
+     *  \tparam charT The type of character used in the XML document.
+     *                By default, char and wchar_t are supported.
+     */
+    template <typename charT>
+    class basic_sax_handler {
+    public:
+        //! \name Member types
+        //!@{
+        typedef basic_string_view<charT> view_t; //!< The type of names and values.
+
+        //!@}
+
+        //! \brief A pseudo-attribute of the XML declaration.
+        bool declaration(const view_t& name, const view_t& value) { return true; }
+
+        //! \brief A document type declaration.
+        bool doctype(const view_t& name, const view_t& value) { return true; }
+
+        //! \brief A start tag.
+        bool start_element(const view_t& name) { return true; }
+
+        //! \brief An attribute of the last start tag.
+        bool attribute(const view_t& name, const view_t& value) { return true; }
+
+        //! \brief An end tag, or the end of an empty element tag.
+        bool end_element(const view_t& name) { return true; }
+
+        //! \brief Character data. References are not decoded.
+        bool text(const view_t& value) { return true; }
+
+        //! \brief A CDATA section.
+        bool cdata(const view_t& value) { return true; }
+
+        //! \brief A comment.
+        bool comment(const view_t& value) { return true; }
+
+        //! \brief A processing instruction.
+        bool processing_instruction(const view_t& target, const view_t& value) { return true; }
+    };
+
+    //! \brief An event-driven XML parser.
+    /*!
+     *  This class pulls tokens from a \c basic_reader and reports them to
+     *  a handler, without building any node. The handler type is a template
+     *  parameter of \c parse(), so that the calls can be inlined.
+     *
+     *  \sa xml::basic_sax_handler
+     *  \sa xml::basic_reader
+     *
+     *  \tparam charT The type of character used in the XML document.
+     *                By default, char and wchar_t are supported.
+     */
+    template <typename charT>
+    class basic_sax_parser {
+    public:
+        //! \name Member types
+        //!@{
+        typedef          basic_reader<charT>       reader_t;        //!< The reader type.
+        typedef typename reader_t::token_t         token_t;         //!< The token type.
+        typedef typename reader_t::error_t         error_t;         //!< The error type.
+        typedef typename reader_t::view_t          view_t;          //!< The type of names and values.
+        typedef typename reader_t::const_pointer_t const_pointer_t; //!< Pointer to a constant character.
+
+        //!@}
+
+        //! \brief Constructor.
+        /*!
+         *  Builds a parser reading the characters in between \c first
+         *  (included) and \c last (excluded).
+         *
+         *  \param [in] first A pointer to the first character of the document.
+         *  \param [in] last  A pointer past the last character of the document.
+         *  \param [in] flags A combination of \c reader_t::flags_t.
+         */
+        basic_sax_parser(const_pointer_t first, const_pointer_t last, unsigned flags = reader_t::parse_default)
+        :
+            mReader(first, last, flags)
+        {}
+
+        //! \brief Destructor.
+        /*!
+         *  This destructor does nothing.
+         */
+        virtual ~basic_sax_parser()
+        {}
+
+        //! \brief Restart the parser on a new buffer.
+        /*!
+         *  The internal buffers of the reader are kept, so that parsing
+         *  several documents does not allocate memory.
+         *
+         *  \param [in] first A pointer to the first character of the document.
+         *  \param [in] last  A pointer past the last character of the document.
+         *  \param [in] flags A combination of \c reader_t::flags_t.
+         */
+        void reset(const_pointer_t first, const_pointer_t last, unsigned flags = reader_t::parse_default)
+        {
+            mReader.reset(first, last, flags);
+        }
+
+        //! \brief Parse the document.
+        /*!
+         *  This function reports every token of the document to \c handler,
+         *  until the end of the document, an error, or until the handler
+         *  asks to stop.
+         *
+         *  \tparam handlerT The type of handler.
+         *
+         *  \param [in] handler The handler events are reported to.
+         *
+         *  \return \c reader_t::end_document if the whole document has been
+         *          parsed, \c reader_t::error if it is not well-formed, or
+         *          the last token read if the handler stopped the parsing.
+         */
+        template <class handlerT>
+        token_t parse(handlerT& handler)
+        {
+            bool inDeclaration = false;
+
+            for (;;) {
+                const token_t token = mReader.next();
+                bool proceed = true;
+
+                switch (token) {
+                case reader_t::declaration:
+                    inDeclaration = true;
+                    break;
+
+                case reader_t::attribute:
+                    proceed = inDeclaration
+                        ? handler.declaration(mReader.name(), mReader.value())
+                        : handler.attribute(mReader.name(), mReader.value());
+                    break;
+
+                case reader_t::start_element:
+                    inDeclaration = false;
+                    proceed = handler.start_element(mReader.name());
+                    break;
+
+                case reader_t::end_element:
+                    proceed = handler.end_element(mReader.name());
+                    break;
+
+                case reader_t::text:
+                    proceed = handler.text(mReader.value());
+                    break;
+
+                case reader_t::cdata:
+                    proceed = handler.cdata(mReader.value());
+                    break;
+
+                case reader_t::comment:
+                    inDeclaration = false;
+                    proceed = handler.comment(mReader.value());
+                    break;
+
+                case reader_t::processing_instruction:
+                    inDeclaration = false;
+                    proceed = handler.processing_instruction(mReader.name(), mReader.value());
+                    break;
+
+                case reader_t::doctype:
+                    inDeclaration = false;
+                    proceed = handler.doctype(mReader.name(), mReader.value());
+                    break;
+
+                default:
+                    return token;
+                }
+
+                if (!proceed)
+                    return token;
+            }
+        }
+
+        //! \brief Get the underlying reader.
+        /*!
+         *  \return A constant reference to the reader tokens are pulled from.
+         */
+        const reader_t& reader() const { return mReader; }
+
+        //! \brief Get the error code.
+        /*!
+         *  \return The error found in the document, or \c reader_t::no_error.
+         */
+        error_t error_code() const { return mReader.error_code(); }
+
+        //! \brief Get the offset of the current token.
+        /*!
+         *  \return The offset of the last token read, or of the error.
+         */
+        size_t offset() const { return mReader.offset(); }
+
+    private:
+        reader_t mReader; //!< The reader tokens are pulled from.
+    };
+
+    typedef basic_sax_handler<char>    sax_handler;  //!< A specialized \c basic_sax_handler for char.
+    typedef basic_sax_handler<wchar_t> wsax_handler; //!< A specialized \c basic_sax_handler for wchar_t.
+
+    typedef basic_sax_parser<char>    sax_parser;  //!< A specialized \c basic_sax_parser for char.
+    typedef basic_sax_parser<wchar_t> wsax_parser; //!< A specialized \c basic_sax_parser for wchar_t.
+}
+
+#endif /* SAX_H_INCLUDED */
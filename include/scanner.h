@@ -0,0 +1,865 @@
+#ifndef SCANNER_H_INCLUDED
+#define SCANNER_H_INCLUDED
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace xml {
+    //! \brief Character classification and searching functions.
+    /*!
+     *  This class gathers the low level functions used by the tokenizers
+     *  to classify characters and to find the next markup delimiter in a
+     *  buffer. The generic implementation works one character at a time.
+     *  The \c char specialization scans 32 bytes at a time with AVX2 or
+     *  16 bytes at a time with SSE2, depending on the compilation flags,
+     *  to find delimiters, to skip white spaces and to find the end of
+     *  names.
+     *  Single characters, and the characters escaped by serializers, are
+     *  also searched 16 bytes at a time in buffers of wider characters
+     *  with SSE2.
+     *
+     *  All search functions return \c last when nothing was found.
+     *
+     *  \tparam charT The type of character to scan.
+     *                By default, char and wchar_t are supported.
+     */
+    template <typename charT>
+    class basic_scanner {
+    public:
+        //! \name Member types
+        //!@{
+        typedef const charT* const_pointer_t; //!< Pointer to a constant character.
+
+        //!@}
+
+        //! \brief Get the code point value of a character.
+        /*!
+         *  \param [in] c A character.
+         *
+         *  \return The unsigned value of \c c.
+         */
+        static uint32_t code(charT c)
+        {
+            return static_cast<uint32_t>(static_cast<typename std::make_unsigned<charT>::type>(c));
+        }
+
+        //! \brief Whether a character is a XML white space.
+        /*!
+         *  \param [in] c A character.
+         *
+         *  \return \c true if \c c is a space, a tabulation, a carriage return
+         *          or a line feed, \c false otherwise.
+         */
+        static bool is_whitespace(charT c)
+        {
+            return c == ' ' || c == '\n' || c == '\t' || c == '\r';
+        }
+
+        //! \brief Whether a character can start a XML name.
+        /*!
+         *  Every character above the ASCII range is accepted.
+         *
+         *  \param [in] c A character.
+         *
+         *  \return \c true if \c c can start a name, \c false otherwise.
+         */
+        static bool is_name_start(charT c)
+        {
+            const uint32_t u = code(c);
+
+            return u >= 0x80 || (sNameTable[u] & 0x01) != 0;
+        }
+
+        //! \brief Whether a character can be part of a XML name.
+        /*!
+         *  Every character above the ASCII range is accepted.
+         *
+         *  \param [in] c A character.
+         *
+         *  \return \c true if \c c can be part of a name, \c false otherwise.
+         */
+        static bool is_name_char(charT c)
+        {
+            const uint32_t u = code(c);
+
+            return u >= 0x80 || (sNameTable[u] & 0x02) != 0;
+        }
+
+        //! \brief Whether a character ends a XML name inside a tag.
+        /*!
+         *  \param [in] c A character.
+         *
+         *  \return \c true if \c c is a white space, \c '/', \c '>', \c '=' or \c '?'.
+         */
+        static bool is_name_delimiter(charT c)
+        {
+            return is_whitespace(c) || c == '/' || c == '>' || c == '=' || c == '?';
+        }
+
+        //! \brief Skip white spaces.
+        /*!
+         *  \param [in] first The first character to check.
+         *  \param [in] last  The end of the buffer.
+         *
+         *  \return A pointer to the first character that is not a white space.
+         */
+        static const_pointer_t skip_whitespace(const_pointer_t first, const_pointer_t last)
+        {
+            for (const_pointer_t stop = last - first > sPrefix ? first + sPrefix : last; first != stop; ++first)
+                if (!is_whitespace(*first))
+                    return first;
+
+            return skipWhitespaceBlocks(first, last);
+        }
+
+        //! \brief Whether a range only contains white spaces.
+        /*!
+         *  \param [in] first The first character to check.
+         *  \param [in] last  The end of the range.
+         *
+         *  \return \c true if the range is empty or only contains white spaces.
+         */
+        static bool all_whitespace(const_pointer_t first, const_pointer_t last)
+        {
+            return skip_whitespace(first, last) == last;
+        }
+
+        //! \brief Find the end of a name.
+        /*!
+         *  This function validates each character of a name and stops at the
+         *  first character that cannot be part of it.
+         *
+         *  \param [in] first The first character of the name.
+         *  \param [in] last  The end of the buffer.
+         *
+         *  \return A pointer past the last name character.
+         */
+        static const_pointer_t find_name_end(const_pointer_t first, const_pointer_t last)
+        {
+            for (const_pointer_t stop = last - first > sPrefix ? first + sPrefix : last; first != stop; ++first)
+                if (!is_name_char(*first))
+                    return first;
+
+            return findNameEndBlocks(first, last);
+        }
+
+        //! \brief Find the end of a name without validating it.
+        /*!
+         *  \param [in] first The first character of the name.
+         *  \param [in] last  The end of the buffer.
+         *
+         *  \return A pointer to the first name delimiter.
+         */
+        static const_pointer_t find_name_delimiter(const_pointer_t first, const_pointer_t last)
+        {
+            for (const_pointer_t stop = last - first > sPrefix ? first + sPrefix : last; first != stop; ++first)
+                if (is_name_delimiter(*first))
+                    return first;
+
+            return findNameDelimiterBlocks(first, last);
+        }
+
+        //! \brief Find a character.
+        /*!
+         *  \param [in] first The first character to check.
+         *  \param [in] last  The end of the buffer.
+         *  \param [in] a     The character to find.
+         *
+         *  \return A pointer to the first occurrence of \c a.
+         */
+        static const_pointer_t find(const_pointer_t first, const_pointer_t last, charT a)
+        {
+            while (first != last && *first != a)
+                ++first;
+
+            return first;
+        }
+
+        //! \brief Find the first of two characters.
+        /*!
+         *  \param [in] first The first character to check.
+         *  \param [in] last  The end of the buffer.
+         *  \param [in] a     A character to find.
+         *  \param [in] b     A character to find.
+         *
+         *  \return A pointer to the first occurrence of either \c a or \c b.
+         */
+        static const_pointer_t find_first_of(const_pointer_t first, const_pointer_t last, charT a, charT b)
+        {
+            while (first != last && *first != a && *first != b)
+                ++first;
+
+            return first;
+        }
+
+        //! \brief Find the first of three characters.
+        /*!
+         *  \param [in] first The first character to check.
+         *  \param [in] last  The end of the buffer.
+         *  \param [in] a     A character to find.
+         *  \param [in] b     A character to find.
+         *  \param [in] c     A character to find.
+         *
+         *  \return A pointer to the first occurrence of either \c a, \c b or \c c.
+         */
+        static const_pointer_t find_first_of(const_pointer_t first, const_pointer_t last, charT a, charT b, charT c)
+        {
+            while (first != last && *first != a && *first != b && *first != c)
+                ++first;
+
+            return first;
+        }
+
+        //! \brief Find the first character escaped by serializers.
+        /*!
+         *  \param [in] first The first character to check.
+         *  \param [in] last  The end of the buffer.
+         *
+         *  \return A pointer to the first \c '<', \c '>', \c '&', \c '"' or
+         *          control character below U+0020, such as a tab or a line
+         *          break.
+         */
+        static const_pointer_t find_escaped(const_pointer_t first, const_pointer_t last)
+        {
+            typedef typename std::make_unsigned<charT>::type unsigned_t;
+
+            while (first != last && *first != '<' && *first != '>' && *first != '&' && *first != '"' && static_cast<unsigned_t>(*first) >= 0x20)
+                ++first;
+
+            return first;
+        }
+
+        //! \brief Find the positions of the markup delimiters in a block.
+        /*!
+         *  This function looks at up to 64 characters, and sets bit \c i of
+         *  each mask when the character at \c first + \c i is a delimiter.
+         *
+         *  \param [in]  first  The first character of the block.
+         *  \param [in]  last   The end of the buffer.
+         *  \param [out] lt     The positions of the \c '<' characters.
+         *  \param [out] gt     The positions of the \c '>' characters.
+         *  \param [out] quotes The positions of the \c '"' and \c '\\'' characters.
+         */
+        static void classify(const_pointer_t first, const_pointer_t last, uint64_t& lt, uint64_t& gt, uint64_t& quotes)
+        {
+            const size_t size = last - first < 64 ? last - first : 64;
+
+            lt = gt = quotes = 0;
+
+            for (size_t i = 0; i < size; ++i) {
+                const charT c = first[i];
+
+                if (c == '<')
+                    lt |= uint64_t(1) << i;
+                else if (c == '>')
+                    gt |= uint64_t(1) << i;
+                else if (c == '"' || c == '\'')
+                    quotes |= uint64_t(1) << i;
+            }
+        }
+
+    private:
+        //! \brief The number of characters checked one at a time before a scan by blocks.
+        /*!
+         *  Most white space runs and names are shorter. The scans by blocks
+         *  of the \c char specialization are kept out of line, so that the
+         *  inlined checks of short runs stay small.
+         */
+        static const ptrdiff_t sPrefix = 16;
+
+        //! \brief Skip white spaces, past the first characters of a run.
+        /*!
+         *  \param [in] first The first character to check.
+         *  \param [in] last  The end of the buffer.
+         *
+         *  \return A pointer to the first character that is not a white space.
+         */
+        static const_pointer_t skipWhitespaceBlocks(const_pointer_t first, const_pointer_t last)
+        {
+            while (first != last && is_whitespace(*first))
+                ++first;
+
+            return first;
+        }
+
+        //! \brief Find the end of a name, past its first characters.
+        /*!
+         *  \param [in] first The first character to check.
+         *  \param [in] last  The end of the buffer.
+         *
+         *  \return A pointer past the last name character.
+         */
+        static const_pointer_t findNameEndBlocks(const_pointer_t first, const_pointer_t last)
+        {
+            while (first != last && is_name_char(*first))
+                ++first;
+
+            return first;
+        }
+
+        //! \brief Find the end of a name without validating it, past its first characters.
+        /*!
+         *  \param [in] first The first character to check.
+         *  \param [in] last  The end of the buffer.
+         *
+         *  \return A pointer to the first name delimiter.
+         */
+        static const_pointer_t findNameDelimiterBlocks(const_pointer_t first, const_pointer_t last)
+        {
+            while (first != last && !is_name_delimiter(*first))
+                ++first;
+
+            return first;
+        }
+
+        //! \brief ASCII name character table.
+        /*!
+         *  Bit 0 is set for characters that can start a name,
+         *  bit 1 for characters that can be part of a name.
+         */
+        static const uint8_t sNameTable[128];
+    };
+
+    template <typename charT>
+    const uint8_t basic_scanner<charT>::sNameTable[128] = {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+     // sp  !  "  #  $  %  &  '  (  )  *  +  ,  -  .  /
+        0,  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 2, 0,
+     // 0  1  2  3  4  5  6  7  8  9  :  ;  <  =  >  ?
+        2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 3, 0, 0, 0, 0, 0,
+     // @  A-O
+        0, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+     // P-Z                                   [  \  ]  ^  _
+        3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 0, 0, 0, 0, 3,
+     // `  a-o
+        0, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+     // p-z                                   {  |  }  ~  del
+        3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 0, 0, 0, 0, 0
+    };
+
+    //! \brief Find a character in a byte buffer.
+    /*!
+     *  The C library \c memchr is already vectorized on every platform
+     *  we care about.
+     */
+    template <>
+    inline basic_scanner<char>::const_pointer_t basic_scanner<char>::find(const_pointer_t first, const_pointer_t last, char a)
+    {
+        const void* ptr = std::memchr(first, a, last - first);
+
+        return ptr == nullptr ? last : static_cast<const_pointer_t>(ptr);
+    }
+
+    //! \brief Find the first of two characters in a byte buffer.
+    template <>
+    inline basic_scanner<char>::const_pointer_t basic_scanner<char>::find_first_of(const_pointer_t first, const_pointer_t last, char a, char b)
+    {
+#if defined(__AVX2__)
+        const __m256i wa = _mm256_set1_epi8(a);
+        const __m256i wb = _mm256_set1_epi8(b);
+
+        for (; last - first >= 32; first += 32) {
+            const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+            const uint32_t mask = _mm256_movemask_epi8(
+                _mm256_or_si256(_mm256_cmpeq_epi8(x, wa), _mm256_cmpeq_epi8(x, wb)));
+
+            if (mask != 0)
+                return first + __builtin_ctz(mask);
+        }
+#endif
+#if defined(__SSE2__)
+        const __m128i va = _mm_set1_epi8(a);
+        const __m128i vb = _mm_set1_epi8(b);
+
+        for (; last - first >= 16; first += 16) {
+            const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+            const uint32_t mask = _mm_movemask_epi8(
+                _mm_or_si128(_mm_cmpeq_epi8(x, va), _mm_cmpeq_epi8(x, vb)));
+
+            if (mask != 0)
+                return first + __builtin_ctz(mask);
+        }
+#endif
+        while (first != last && *first != a && *first != b)
+            ++first;
+
+        return first;
+    }
+
+    //! \brief Find the first of three characters in a byte buffer.
+    template <>
+    inline basic_scanner<char>::const_pointer_t basic_scanner<char>::find_first_of(const_pointer_t first, const_pointer_t last, char a, char b, char c)
+    {
+#if defined(__AVX2__)
+        const __m256i wa = _mm256_set1_epi8(a);
+        const __m256i wb = _mm256_set1_epi8(b);
+        const __m256i wc = _mm256_set1_epi8(c);
+
+        for (; last - first >= 32; first += 32) {
+            const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+            const uint32_t mask = _mm256_movemask_epi8(
+                _mm256_or_si256(
+                    _mm256_or_si256(_mm256_cmpeq_epi8(x, wa), _mm256_cmpeq_epi8(x, wb)),
+                    _mm256_cmpeq_epi8(x, wc)));
+
+            if (mask != 0)
+                return first + __builtin_ctz(mask);
+        }
+#endif
+#if defined(__SSE2__)
+        const __m128i va = _mm_set1_epi8(a);
+        const __m128i vb = _mm_set1_epi8(b);
+        const __m128i vc = _mm_set1_epi8(c);
+
+        for (; last - first >= 16; first += 16) {
+            const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+            const uint32_t mask = _mm_movemask_epi8(
+                _mm_or_si128(
+                    _mm_or_si128(_mm_cmpeq_epi8(x, va), _mm_cmpeq_epi8(x, vb)),
+                    _mm_cmpeq_epi8(x, vc)));
+
+            if (mask != 0)
+                return first + __builtin_ctz(mask);
+        }
+#endif
+        while (first != last && *first != a && *first != b && *first != c)
+            ++first;
+
+        return first;
+    }
+
+    //! \brief Find the first character escaped by serializers in a byte buffer.
+    template <>
+    inline basic_scanner<char>::const_pointer_t basic_scanner<char>::find_escaped(const_pointer_t first, const_pointer_t last)
+    {
+#if defined(__AVX2__)
+        const __m256i wlt = _mm256_set1_epi8('<');
+        const __m256i wgt = _mm256_set1_epi8('>');
+        const __m256i wam = _mm256_set1_epi8('&');
+        const __m256i wqt = _mm256_set1_epi8('"');
+        const __m256i wct = _mm256_set1_epi8(static_cast<char>(~0x1F));
+
+        for (; last - first >= 32; first += 32) {
+            const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+            const uint32_t mask = _mm256_movemask_epi8(
+                _mm256_or_si256(
+                    _mm256_or_si256(
+                        _mm256_or_si256(_mm256_cmpeq_epi8(x, wlt), _mm256_cmpeq_epi8(x, wgt)),
+                        _mm256_or_si256(_mm256_cmpeq_epi8(x, wam), _mm256_cmpeq_epi8(x, wqt))),
+                    _mm256_cmpeq_epi8(_mm256_and_si256(x, wct), _mm256_setzero_si256())));
+
+            if (mask != 0)
+                return first + __builtin_ctz(mask);
+        }
+#endif
+#if defined(__SSE2__)
+        const __m128i vlt = _mm_set1_epi8('<');
+        const __m128i vgt = _mm_set1_epi8('>');
+        const __m128i vam = _mm_set1_epi8('&');
+        const __m128i vqt = _mm_set1_epi8('"');
+        const __m128i vct = _mm_set1_epi8(static_cast<char>(~0x1F));
+
+        for (; last - first >= 16; first += 16) {
+            const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+            const uint32_t mask = _mm_movemask_epi8(
+                _mm_or_si128(
+                    _mm_or_si128(
+                        _mm_or_si128(_mm_cmpeq_epi8(x, vlt), _mm_cmpeq_epi8(x, vgt)),
+                        _mm_or_si128(_mm_cmpeq_epi8(x, vam), _mm_cmpeq_epi8(x, vqt))),
+                    _mm_cmpeq_epi8(_mm_and_si128(x, vct), _mm_setzero_si128())));
+
+            if (mask != 0)
+                return first + __builtin_ctz(mask);
+        }
+#endif
+        while (first != last && *first != '<' && *first != '>' && *first != '&' && *first != '"' && static_cast<unsigned char>(*first) >= 0x20)
+            ++first;
+
+        return first;
+    }
+
+    //! \brief Skip white spaces in a byte buffer, past its first characters.
+    template <>
+    __attribute__((noinline))
+    inline basic_scanner<char>::const_pointer_t basic_scanner<char>::skipWhitespaceBlocks(const_pointer_t first, const_pointer_t last)
+    {
+#if defined(__AVX2__)
+        const __m256i wsp = _mm256_set1_epi8(' ');
+        const __m256i wlf = _mm256_set1_epi8('\n');
+        const __m256i wtb = _mm256_set1_epi8('\t');
+        const __m256i wcr = _mm256_set1_epi8('\r');
+
+        for (; last - first >= 32; first += 32) {
+            const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+            const uint32_t mask = ~uint32_t(_mm256_movemask_epi8(
+                _mm256_or_si256(
+                    _mm256_or_si256(_mm256_cmpeq_epi8(x, wsp), _mm256_cmpeq_epi8(x, wlf)),
+                    _mm256_or_si256(_mm256_cmpeq_epi8(x, wtb), _mm256_cmpeq_epi8(x, wcr)))));
+
+            if (mask != 0)
+                return first + __builtin_ctz(mask);
+        }
+#endif
+#if defined(__SSE2__)
+        const __m128i vsp = _mm_set1_epi8(' ');
+        const __m128i vlf = _mm_set1_epi8('\n');
+        const __m128i vtb = _mm_set1_epi8('\t');
+        const __m128i vcr = _mm_set1_epi8('\r');
+
+        for (; last - first >= 16; first += 16) {
+            const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+            const uint32_t mask = ~uint32_t(_mm_movemask_epi8(
+                _mm_or_si128(
+                    _mm_or_si128(_mm_cmpeq_epi8(x, vsp), _mm_cmpeq_epi8(x, vlf)),
+                    _mm_or_si128(_mm_cmpeq_epi8(x, vtb), _mm_cmpeq_epi8(x, vcr))))) & 0xFFFF;
+
+            if (mask != 0)
+                return first + __builtin_ctz(mask);
+        }
+#endif
+        while (first != last && is_whitespace(*first))
+            ++first;
+
+        return first;
+    }
+
+    //! \brief Find the end of a name in a byte buffer, past its first characters.
+    /*!
+     *  The name characters are the bytes above the ASCII range, the
+     *  letters, once folded to lower case, the digits and \c ':', \c '-'
+     *  and \c '.', and \c '_'.
+     */
+    template <>
+    __attribute__((noinline))
+    inline basic_scanner<char>::const_pointer_t basic_scanner<char>::findNameEndBlocks(const_pointer_t first, const_pointer_t last)
+    {
+#if defined(__AVX2__)
+        const __m256i wcase = _mm256_set1_epi8(0x20);
+        const __m256i wa    = _mm256_set1_epi8('a' - 1);
+        const __m256i wz    = _mm256_set1_epi8('z' + 1);
+        const __m256i w0    = _mm256_set1_epi8('0' - 1);
+        const __m256i wcl   = _mm256_set1_epi8(':' + 1);
+        const __m256i wdash = _mm256_set1_epi8('-' - 1);
+        const __m256i wdot  = _mm256_set1_epi8('.' + 1);
+        const __m256i wus   = _mm256_set1_epi8('_');
+
+        for (; last - first >= 32; first += 32) {
+            const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+            const __m256i l = _mm256_or_si256(x, wcase);
+            const uint32_t mask = ~uint32_t(_mm256_movemask_epi8(
+                _mm256_or_si256(
+                    _mm256_or_si256(
+                        _mm256_or_si256(x, _mm256_cmpeq_epi8(x, wus)),
+                        _mm256_and_si256(_mm256_cmpgt_epi8(l, wa), _mm256_cmpgt_epi8(wz, l))),
+                    _mm256_or_si256(
+                        _mm256_and_si256(_mm256_cmpgt_epi8(x, w0), _mm256_cmpgt_epi8(wcl, x)),
+                        _mm256_and_si256(_mm256_cmpgt_epi8(x, wdash), _mm256_cmpgt_epi8(wdot, x))))));
+
+            if (mask != 0)
+                return first + __builtin_ctz(mask);
+        }
+#endif
+#if defined(__SSE2__)
+        const __m128i vcase = _mm_set1_epi8(0x20);
+        const __m128i va    = _mm_set1_epi8('a' - 1);
+        const __m128i vz    = _mm_set1_epi8('z' + 1);
+        const __m128i v0    = _mm_set1_epi8('0' - 1);
+        const __m128i vcl   = _mm_set1_epi8(':' + 1);
+        const __m128i vdash = _mm_set1_epi8('-' - 1);
+        const __m128i vdot  = _mm_set1_epi8('.' + 1);
+        const __m128i vus   = _mm_set1_epi8('_');
+
+        for (; last - first >= 16; first += 16) {
+            const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+            const __m128i l = _mm_or_si128(x, vcase);
+            const uint32_t mask = ~uint32_t(_mm_movemask_epi8(
+                _mm_or_si128(
+                    _mm_or_si128(
+                        _mm_or_si128(x, _mm_cmpeq_epi8(x, vus)),
+                        _mm_and_si128(_mm_cmpgt_epi8(l, va), _mm_cmpgt_epi8(vz, l))),
+                    _mm_or_si128(
+                        _mm_and_si128(_mm_cmpgt_epi8(x, v0), _mm_cmpgt_epi8(vcl, x)),
+                        _mm_and_si128(_mm_cmpgt_epi8(x, vdash), _mm_cmpgt_epi8(vdot, x)))))) & 0xFFFF;
+
+            if (mask != 0)
+                return first + __builtin_ctz(mask);
+        }
+#endif
+        while (first != last && is_name_char(*first))
+            ++first;
+
+        return first;
+    }
+
+    //! \brief Find the end of a name without validating it in a byte buffer, past its first characters.
+    template <>
+    __attribute__((noinline))
+    inline basic_scanner<char>::const_pointer_t basic_scanner<char>::findNameDelimiterBlocks(const_pointer_t first, const_pointer_t last)
+    {
+#if defined(__AVX2__)
+        const __m256i wsp = _mm256_set1_epi8(' ');
+        const __m256i wlf = _mm256_set1_epi8('\n');
+        const __m256i wtb = _mm256_set1_epi8('\t');
+        const __m256i wcr = _mm256_set1_epi8('\r');
+        const __m256i wsl = _mm256_set1_epi8('/');
+        const __m256i wgt = _mm256_set1_epi8('>');
+        const __m256i weq = _mm256_set1_epi8('=');
+        const __m256i wqm = _mm256_set1_epi8('?');
+
+        for (; last - first >= 32; first += 32) {
+            const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+            const uint32_t mask = _mm256_movemask_epi8(
+                _mm256_or_si256(
+                    _mm256_or_si256(
+                        _mm256_or_si256(_mm256_cmpeq_epi8(x, wsp), _mm256_cmpeq_epi8(x, wlf)),
+                        _mm256_or_si256(_mm256_cmpeq_epi8(x, wtb), _mm256_cmpeq_epi8(x, wcr))),
+                    _mm256_or_si256(
+                        _mm256_or_si256(_mm256_cmpeq_epi8(x, wsl), _mm256_cmpeq_epi8(x, wgt)),
+                        _mm256_or_si256(_mm256_cmpeq_epi8(x, weq), _mm256_cmpeq_epi8(x, wqm)))));
+
+            if (mask != 0)
+                return first + __builtin_ctz(mask);
+        }
+#endif
+#if defined(__SSE2__)
+        const __m128i vsp = _mm_set1_epi8(' ');
+        const __m128i vlf = _mm_set1_epi8('\n');
+        const __m128i vtb = _mm_set1_epi8('\t');
+        const __m128i vcr = _mm_set1_epi8('\r');
+        const __m128i vsl = _mm_set1_epi8('/');
+        const __m128i vgt = _mm_set1_epi8('>');
+        const __m128i veq = _mm_set1_epi8('=');
+        const __m128i vqm = _mm_set1_epi8('?');
+
+        for (; last - first >= 16; first += 16) {
+            const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+            const uint32_t mask = _mm_movemask_epi8(
+                _mm_or_si128(
+                    _mm_or_si128(
+                        _mm_or_si128(_mm_cmpeq_epi8(x, vsp), _mm_cmpeq_epi8(x, vlf)),
+                        _mm_or_si128(_mm_cmpeq_epi8(x, vtb), _mm_cmpeq_epi8(x, vcr))),
+                    _mm_or_si128(
+                        _mm_or_si128(_mm_cmpeq_epi8(x, vsl), _mm_cmpeq_epi8(x, vgt)),
+                        _mm_or_si128(_mm_cmpeq_epi8(x, veq), _mm_cmpeq_epi8(x, vqm)))));
+
+            if (mask != 0)
+                return first + __builtin_ctz(mask);
+        }
+#endif
+        while (first != last && !is_name_delimiter(*first))
+            ++first;
+
+        return first;
+    }
+
+    //! \brief Find the positions of the markup delimiters in a block of bytes.
+    template <>
+    inline void basic_scanner<char>::classify(const_pointer_t first, const_pointer_t last, uint64_t& lt, uint64_t& gt, uint64_t& quotes)
+    {
+#if defined(__AVX2__)
+        if (last - first >= 64) {
+            const __m256i wlt = _mm256_set1_epi8('<');
+            const __m256i wgt = _mm256_set1_epi8('>');
+            const __m256i wqt = _mm256_set1_epi8('"');
+            const __m256i wap = _mm256_set1_epi8('\'');
+
+            const __m256i x0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+            const __m256i x1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first + 32));
+
+            lt = uint64_t(uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(x0, wlt)))) |
+                 uint64_t(uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(x1, wlt)))) << 32;
+            gt = uint64_t(uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(x0, wgt)))) |
+                 uint64_t(uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(x1, wgt)))) << 32;
+            quotes =
+                uint64_t(uint32_t(_mm256_movemask_epi8(
+                    _mm256_or_si256(_mm256_cmpeq_epi8(x0, wqt), _mm256_cmpeq_epi8(x0, wap))))) |
+                uint64_t(uint32_t(_mm256_movemask_epi8(
+                    _mm256_or_si256(_mm256_cmpeq_epi8(x1, wqt), _mm256_cmpeq_epi8(x1, wap))))) << 32;
+
+            return;
+        }
+#elif defined(__SSE2__)
+        if (last - first >= 64) {
+            const __m128i vlt = _mm_set1_epi8('<');
+            const __m128i vgt = _mm_set1_epi8('>');
+            const __m128i vqt = _mm_set1_epi8('"');
+            const __m128i vap = _mm_set1_epi8('\'');
+
+            lt = gt = quotes = 0;
+
+            for (unsigned i = 0; i < 4; ++i) {
+                const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first + 16 * i));
+
+                lt |= uint64_t(uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(x, vlt)))) << (16 * i);
+                gt |= uint64_t(uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(x, vgt)))) << (16 * i);
+                quotes |= uint64_t(uint32_t(_mm_movemask_epi8(
+                    _mm_or_si128(_mm_cmpeq_epi8(x, vqt), _mm_cmpeq_epi8(x, vap))))) << (16 * i);
+            }
+
+            return;
+        }
+#endif
+        const size_t size = last - first < 64 ? last - first : 64;
+
+        lt = gt = quotes = 0;
+
+        for (size_t i = 0; i < size; ++i) {
+            const char c = first[i];
+
+            if (c == '<')
+                lt |= uint64_t(1) << i;
+            else if (c == '>')
+                gt |= uint64_t(1) << i;
+            else if (c == '"' || c == '\'')
+                quotes |= uint64_t(1) << i;
+        }
+    }
+
+    //! \brief Find a character in a buffer of 16-bit characters.
+    template <>
+    inline basic_scanner<char16_t>::const_pointer_t basic_scanner<char16_t>::find(const_pointer_t first, const_pointer_t last, char16_t a)
+    {
+#if defined(__SSE2__)
+        const __m128i va = _mm_set1_epi16(static_cast<short>(a));
+
+        for (; last - first >= 8; first += 8) {
+            const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+            const uint32_t mask = _mm_movemask_epi8(_mm_cmpeq_epi16(x, va));
+
+            if (mask != 0)
+                return first + __builtin_ctz(mask) / 2;
+        }
+#endif
+        while (first != last && *first != a)
+            ++first;
+
+        return first;
+    }
+
+    //! \brief Find a character in a buffer of 32-bit characters.
+    template <>
+    inline basic_scanner<char32_t>::const_pointer_t basic_scanner<char32_t>::find(const_pointer_t first, const_pointer_t last, char32_t a)
+    {
+#if defined(__SSE2__)
+        const __m128i va = _mm_set1_epi32(static_cast<int>(a));
+
+        for (; last - first >= 4; first += 4) {
+            const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+            const uint32_t mask = _mm_movemask_epi8(_mm_cmpeq_epi32(x, va));
+
+            if (mask != 0)
+                return first + __builtin_ctz(mask) / 4;
+        }
+#endif
+        while (first != last && *first != a)
+            ++first;
+
+        return first;
+    }
+
+    //! \brief Find the first character escaped by serializers in a buffer of 16-bit characters.
+    template <>
+    inline basic_scanner<char16_t>::const_pointer_t basic_scanner<char16_t>::find_escaped(const_pointer_t first, const_pointer_t last)
+    {
+#if defined(__SSE2__)
+        const __m128i vlt = _mm_set1_epi16('<');
+        const __m128i vgt = _mm_set1_epi16('>');
+        const __m128i vam = _mm_set1_epi16('&');
+        const __m128i vqt = _mm_set1_epi16('"');
+        const __m128i vct = _mm_set1_epi16(static_cast<short>(~0x1F));
+
+        for (; last - first >= 8; first += 8) {
+            const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+            const uint32_t mask = _mm_movemask_epi8(
+                _mm_or_si128(
+                    _mm_or_si128(
+                        _mm_or_si128(_mm_cmpeq_epi16(x, vlt), _mm_cmpeq_epi16(x, vgt)),
+                        _mm_or_si128(_mm_cmpeq_epi16(x, vam), _mm_cmpeq_epi16(x, vqt))),
+                    _mm_cmpeq_epi16(_mm_and_si128(x, vct), _mm_setzero_si128())));
+
+            if (mask != 0)
+                return first + __builtin_ctz(mask) / 2;
+        }
+#endif
+        while (first != last && *first != '<' && *first != '>' && *first != '&' && *first != '"' && *first >= 0x20)
+            ++first;
+
+        return first;
+    }
+
+    //! \brief Find the first character escaped by serializers in a buffer of 32-bit characters.
+    template <>
+    inline basic_scanner<char32_t>::const_pointer_t basic_scanner<char32_t>::find_escaped(const_pointer_t first, const_pointer_t last)
+    {
+#if defined(__SSE2__)
+        const __m128i vlt = _mm_set1_epi32('<');
+        const __m128i vgt = _mm_set1_epi32('>');
+        const __m128i vam = _mm_set1_epi32('&');
+        const __m128i vqt = _mm_set1_epi32('"');
+        const __m128i vct = _mm_set1_epi32(~0x1F);
+
+        for (; last - first >= 4; first += 4) {
+            const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+            const uint32_t mask = _mm_movemask_epi8(
+                _mm_or_si128(
+                    _mm_or_si128(
+                        _mm_or_si128(_mm_cmpeq_epi32(x, vlt), _mm_cmpeq_epi32(x, vgt)),
+                        _mm_or_si128(_mm_cmpeq_epi32(x, vam), _mm_cmpeq_epi32(x, vqt))),
+                    _mm_cmpeq_epi32(_mm_and_si128(x, vct), _mm_setzero_si128())));
+
+            if (mask != 0)
+                return first + __builtin_ctz(mask) / 4;
+        }
+#endif
+        while (first != last && *first != '<' && *first != '>' && *first != '&' && *first != '"' && *first >= 0x20)
+            ++first;
+
+        return first;
+    }
+
+    //! \brief Find a character in a buffer of wide characters.
+    /*!
+     *  The search is forwarded to the scanner of the same size.
+     */
+    template <>
+    inline basic_scanner<wchar_t>::const_pointer_t basic_scanner<wchar_t>::find(const_pointer_t first, const_pointer_t last, wchar_t a)
+    {
+        typedef typename std::conditional<sizeof(wchar_t) == 2, char16_t, char32_t>::type unit_t;
+
+        const unit_t* found = basic_scanner<unit_t>::find(
+            reinterpret_cast<const unit_t*>(first), reinterpret_cast<const unit_t*>(last), static_cast<unit_t>(a));
+
+        return first + (found - reinterpret_cast<const unit_t*>(first));
+    }
+
+    //! \brief Find the first character escaped by serializers in a buffer of wide characters.
+    /*!
+     *  The search is forwarded to the scanner of the same size.
+     */
+    template <>
+    inline basic_scanner<wchar_t>::const_pointer_t basic_scanner<wchar_t>::find_escaped(const_pointer_t first, const_pointer_t last)
+    {
+        typedef typename std::conditional<sizeof(wchar_t) == 2, char16_t, char32_t>::type unit_t;
+
+        const unit_t* found = basic_scanner<unit_t>::find_escaped(
+            reinterpret_cast<const unit_t*>(first), reinterpret_cast<const unit_t*>(last));
+
+        return first + (found - reinterpret_cast<const unit_t*>(first));
+    }
+
+    typedef basic_scanner<char>    scanner;  //!< A specialized \c basic_scanner for char.
+    typedef basic_scanner<wchar_t> wscanner; //!< A specialized \c basic_scanner for wchar_t.
+}
+
+#endif /* SCANNER_H_INCLUDED */
@@ -0,0 +1,2228 @@
+#ifndef SCHEMA_H_INCLUDED
+#define SCHEMA_H_INCLUDED
+
+#include <map>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <reader.h>
+#include <exception.h>
+#include <expected.h>
+#include <namespace-table.h>
+#include <simple-type.h>
+#include <document.h>
+#include <builder.h>
+
+namespace xml {
+    template <typename charT>
+    class basic_schema_validator;
+
+    //! \brief A compiled XML Schema.
+    /*!
+     *  This class compiles a XML Schema document once into an immutable
+     *  set of components : element declarations, complex types whose
+     *  content models are deterministic automata over interned expanded
+     *  names, and simple types whose facets are precompiled into
+     *  \c basic_simple_type. Validating an element is then a hash lookup
+     *  of its name, one transition of the automaton of its parent, a
+     *  linear scan of the few attribute uses of its type, and a check of
+     *  its text if its content is simple.
+     *
+     *  A compiled schema is only handed out through a \c std::shared_ptr
+     *  to a constant object : it can be cached, and shared by any number
+     *  of threads validating documents concurrently, each validation
+     *  keeping its state in its own \c basic_schema_validator.
+     *
+     *  A schema is a single document : \c import, \c include, \c redefine
+     *  and \c override are not supported, nor are identity constraints,
+     *  substitution groups and \c xsi:type. \c ID values are not checked
+     *  for uniqueness, and attributes of the \c xml namespace are always
+     *  accepted. Content models are expanded into their Glushkov automaton,
+     *  so that occurrence bounds are unrolled : models with more than
+     *  16384 positions are rejected.
+     *
+     *  \sa xml::basic_simple_type
+     *  \sa xml::basic_schema_validator
+     *
+     *  \tparam charT The type of character used in the schema.
+     *                By default, char and wchar_t are supported.
+     */
+    template <typename charT>
+    class basic_compiled_schema {
+    public:
+        //! \name Member types
+        //!@{
+        typedef          basic_reader<charT>       reader_t;        //!< The reader type, whose error codes are used.
+        typedef typename reader_t::scanner_t       scanner_t;       //!< The scanner type.
+        typedef typename reader_t::view_t          view_t;          //!< The type of names and values.
+        typedef typename reader_t::const_pointer_t const_pointer_t; //!< Pointer to a constant character.
+
+        typedef          basic_document<charT>       document_t;       //!< The document type.
+        typedef          basic_element<charT>        element_t;        //!< The element type.
+        typedef          basic_text<charT>           text_t;           //!< The text type.
+        typedef typename element_t::attribute_t      attribute_t;      //!< The attribute type.
+        typedef typename element_t::string_t         string_t;         //!< The string type.
+        typedef typename element_t::node_interface_t node_interface_t; //!< The base type of nodes.
+        typedef          basic_builder<charT>        builder_t;        //!< The builder used to parse schemas.
+        typedef          basic_namespace_table<charT> table_t;         //!< The namespace table type.
+
+        typedef          basic_simple_type<charT>      simple_type_t;  //!< The simple type type.
+        typedef typename simple_type_t::type_pointer_t type_pointer_t; //!< A shared pointer to a simple type.
+
+        typedef basic_compiled_schema<charT>              schema_t;         //!< The compiled schema type.
+        typedef std::shared_ptr<const schema_t>           schema_pointer_t; //!< A shared pointer to a compiled schema.
+        typedef basic_schema_validator<charT>             validator_t;      //!< The validator type.
+        typedef basic_parse_error<charT>                  parse_error_t;    //!< The compilation error type.
+        typedef basic_exception<charT>                    exception_t;      //!< The type of exception thrown on compilation errors.
+        typedef expected<schema_pointer_t, parse_error_t> result_t;         //!< The result of a compilation that does not throw.
+
+        //!@}
+
+        //! The validity errors.
+        enum error_t {
+            undeclared_element,      //!< An element is not declared.
+            invalid_content,         //!< The children of an element do not match its content model.
+            invalid_value,           //!< The text of an element does not match its simple type or its fixed value.
+            undeclared_attribute,    //!< An attribute is not declared for its element.
+            missing_attribute,       //!< A required attribute is missing.
+            invalid_attribute_value  //!< An attribute value does not match its type or its fixed value.
+        };
+
+        //! \brief A validity error.
+        class violation_t {
+        public:
+            error_t          code;    //!< The error.
+            const element_t* element; //!< The invalid element, or \c nullptr in a validated stream.
+            size_t           offset;  //!< The index of the invalid element in document order, in a validated stream.
+            view_t           name;    //!< The local name of the invalid attribute, if any.
+        };
+
+        typedef std::vector<violation_t> violations_t; //!< A list of validity errors.
+
+        basic_compiled_schema(const basic_compiled_schema&) = delete;
+        basic_compiled_schema& operator=(const basic_compiled_schema&) = delete;
+
+        //! \brief Compile a schema without throwing exceptions.
+        /*!
+         *  The schema document must have been parsed with namespaces. The
+         *  names and values used by the components are copied, so that the
+         *  document does not need to outlive the compiled schema.
+         *
+         *  \param [in] schema The schema document.
+         *
+         *  \return The compiled schema, or the first error found, with a
+         *          \c no_error code since the document itself is well-formed.
+         */
+        static result_t try_compile(const document_t& schema)
+        {
+            std::shared_ptr<schema_t> compiled(new schema_t());
+            compiler_t compiler(*compiled, schema);
+
+            if (!compiler.compile())
+                return result_t(parse_error_t(compiler.error, reader_t::no_error, 0));
+
+            return result_t(schema_pointer_t(std::move(compiled)));
+        }
+
+        //! \brief Compile a schema.
+        /*!
+         *  \param [in] schema The schema document.
+         *
+         *  \throw exception_t If the schema is invalid or unsupported.
+         *
+         *  \return The compiled schema.
+         */
+        static schema_pointer_t compile(const document_t& schema)
+        {
+            result_t result = try_compile(schema);
+
+            if (!result)
+                throw exception_t(result.error(), nullptr);
+
+            return std::move(result.value());
+        }
+
+        //! \brief Parse and compile a schema.
+        /*!
+         *  \param [in] str The schema document.
+         *
+         *  \throw exception_t If the document is malformed, or the schema
+         *                     is invalid or unsupported.
+         *
+         *  \return The compiled schema.
+         */
+        static schema_pointer_t compile(const string_t& str)
+        {
+            return compile(builder_t::parse(str));
+        }
+
+        //! \brief Whether a global element is declared.
+        /*!
+         *  \param [in] uri   The namespace of the element.
+         *  \param [in] local The local name of the element.
+         *
+         *  \return \c true if the schema declares the element at top level.
+         */
+        bool declares(const view_t& uri, const view_t& local) const
+        {
+            return global(symbol(mNamespaces.find(uri), local)) != npos;
+        }
+
+        //! \brief Get the namespaces of the schema.
+        /*!
+         *  \return The table interning the namespaces the schema refers to.
+         */
+        const table_t& namespaces() const { return mNamespaces; }
+
+        //! \brief Validate a document.
+        /*!
+         *  The namespaces of the document are mapped once to those of the
+         *  schema, then its tree is walked iteratively, so that its depth
+         *  does not matter. When no list of violations is given, the
+         *  validation stops at the first error.
+         *
+         *  \param [in]  document   The document, parsed with namespaces.
+         *  \param [out] violations The list the validity errors are
+         *                          appended to, or \c nullptr.
+         *
+         *  \return \c true if the document is valid.
+         */
+        bool validate(const document_t& document, violations_t* violations = nullptr) const
+        {
+            return walk(document, violations, false);
+        }
+
+        //! \brief Validate a document, and annotate it with typed values.
+        /*!
+         *  The document is validated as by \c validate(), and the values of
+         *  its attributes and of its elements with simple content are
+         *  converted once by the simple types that check them : the typed
+         *  value of an attribute is set on it, and the one of an element
+         *  on its text, when it has a single text node. Values that are
+         *  invalid, not validated, or of types that are not converted are
+         *  \c untyped. When the validation stops at the first error, the
+         *  nodes that follow it keep their previous typed values.
+         *
+         *  \param [in,out] document   The document, parsed with namespaces.
+         *  \param [out]    violations The list the validity errors are
+         *                             appended to, or \c nullptr.
+         *
+         *  \return \c true if the document is valid.
+         */
+        bool annotate(document_t& document, violations_t* violations = nullptr) const
+        {
+            return walk(document, violations, true);
+        }
+
+    private:
+        friend class basic_schema_validator<charT>;
+
+        //! \brief Validate a document, and annotate it if requested.
+        /*!
+         *  The typed values are only set when the document has been given
+         *  to \c annotate(), that is when it is not constant : they do not
+         *  take part in the strings, so that they can be set on the
+         *  attributes of a set.
+         */
+        bool walk(const document_t& document, violations_t* violations, bool annotate) const
+        {
+            typedef typename element_t::template const_iterator<> iterator_t;
+
+            //! \brief An element whose children are being validated.
+            class entry_t {
+            public:
+                const element_t* element; //!< The element.
+                iterator_t       next;    //!< Its next child.
+            };
+
+            std::vector<namespace_id_t> ids(document.namespaces().size());
+
+            for (size_t i = 0; i != ids.size(); ++i)
+                ids[i] = i <= table_t::xmlns_namespace ?
+                         static_cast<namespace_id_t>(i) : mNamespaces.find(document.namespaces().uri(static_cast<namespace_id_t>(i)));
+
+            validator_t         validator(*this, violations);
+            std::vector<entry_t> stack;
+            const element_t*    element = &document.root();
+
+            for (;;) {
+                if (element != nullptr) {
+                    if (!validator.start_element(ids[element->namespace_id()], element->local_name(), element))
+                        return false;
+
+                    for (const attribute_t& attribute : element->attributes())
+                        if (!validator.attribute(ids[attribute.namespace_id()], attribute.local_name(), attribute.value().view(),
+                                                 annotate ? &attribute.value().annotation() : nullptr))
+                            return false;
+
+                    if (!validator.end_attributes())
+                        return false;
+
+                    stack.push_back(entry_t { element, element->begin() });
+                    element = nullptr;
+                }
+
+                entry_t& top = stack.back();
+
+                if (top.next == top.element->end()) {
+                    if (!validator.end_element())
+                        return false;
+
+                    stack.pop_back();
+
+                    if (stack.empty())
+                        break;
+
+                    continue;
+                }
+
+                const typename node_interface_t::kind_t kind = top.next->kind();
+
+                if (kind == node_interface_t::element_kind)
+                    element = &static_cast<const element_t&>(*top.next);
+                else if (kind == node_interface_t::text_kind) {
+                    const text_t& text = static_cast<const text_t&>(*top.next);
+
+                    if (!validator.text(text.data().view(), annotate ? &text.data().annotation() : nullptr))
+                        return false;
+                }
+
+                ++top.next;
+            }
+
+            return validator.valid();
+        }
+
+        typedef uint32_t symbol_t; //!< The type of interned expanded names.
+
+        enum : uint32_t {
+            npos            = uint32_t(-1),  //!< No symbol, declaration or type.
+            wildcard_symbol = 0x80000000u,   //!< The flag of the symbols of wildcard transitions.
+            any_type        = 0,             //!< The index of \c xs:anyType.
+            max_positions   = 1 << 14        //!< The maximum number of positions of a content model.
+        };
+
+        //! The kinds of content of complex types.
+        enum content_t {
+            content_empty,    //!< No element and no text, except if the type is mixed.
+            content_simple,   //!< Text matching a simple type.
+            content_children, //!< Elements matching a deterministic automaton.
+            content_all,      //!< Elements of an \c all group, in any order.
+            content_any       //!< Anything, validated laxly : the content of \c xs:anyType.
+        };
+
+        //! The processing of the elements matched by a wildcard.
+        enum process_t {
+            process_strict, //!< The elements must be declared.
+            process_lax,    //!< The elements are validated if they are declared.
+            process_skip    //!< The elements are not validated.
+        };
+
+        //! \brief An expanded name.
+        class name_t {
+        public:
+            namespace_id_t ns;    //!< The namespace, in the schema namespace table.
+            view_t         local; //!< The local name.
+
+            //! \brief Compare expanded names.
+            bool operator==(const name_t& rhs) const { return ns == rhs.ns && local == rhs.local; }
+        };
+
+        //! \brief The hash function of expanded names.
+        class name_hash_t {
+        public:
+            //! \brief Hash an expanded name.
+            size_t operator()(const name_t& name) const { return name.local.hash() * 31 + name.ns; }
+        };
+
+        //! \brief A wildcard : \c xs:any or \c xs:anyAttribute.
+        class wildcard_t {
+        public:
+            bool                        any;        //!< Whether any namespace is allowed.
+            bool                        other;      //!< Whether the namespaces other than the target and none are allowed.
+            std::vector<namespace_id_t> namespaces; //!< The allowed namespaces otherwise.
+            process_t                   process;    //!< The processing of the matched items.
+
+            //! \brief Whether a namespace is allowed.
+            bool allows(namespace_id_t ns, namespace_id_t target) const
+            {
+                if (any)
+                    return true;
+
+                if (other)
+                    return ns != target && ns != table_t::no_namespace;
+
+                return std::find(namespaces.begin(), namespaces.end(), ns) != namespaces.end();
+            }
+        };
+
+        //! \brief The use of an attribute by a complex type.
+        class attribute_use_t {
+        public:
+            name_t         name;     //!< The expanded name of the attribute.
+            type_pointer_t type;     //!< The type of the attribute.
+            bool           required; //!< Whether the attribute is required.
+            bool           fixed;    //!< Whether the attribute has a fixed value.
+            string_t       value;    //!< The fixed value, if any.
+        };
+
+        //! \brief The declaration of an element.
+        class element_decl_t {
+        public:
+            symbol_t       symbol;   //!< The expanded name of the element.
+            uint32_t       complex;  //!< The complex type of the element, or \c npos.
+            type_pointer_t simple;   //!< The simple type of the element, if it is not complex.
+            bool           nillable; //!< Whether \c xsi:nil is allowed.
+            bool           fixed;    //!< Whether the element has a fixed value.
+            bool           preset;   //!< Whether the element has a default or fixed value.
+            string_t       value;    //!< The default or fixed value.
+        };
+
+        //! \brief An element of an \c all group.
+        class all_entry_t {
+        public:
+            symbol_t symbol;   //!< The expanded name of the element.
+            uint32_t decl;     //!< The declaration of the element.
+            bool     required; //!< Whether the element is required.
+        };
+
+        //! \brief A complex type.
+        class complex_type_t {
+        public:
+            content_t                     content;    //!< The kind of content.
+            bool                          mixed;      //!< Whether text is allowed between the children.
+            bool                          optional;   //!< Whether an \c all group may be empty.
+            uint32_t                      start;      //!< The initial state of the automaton of \c content_children.
+            uint32_t                      wildcard;   //!< The attribute wildcard, or \c npos.
+            type_pointer_t                simple;     //!< The type of \c content_simple.
+            std::vector<attribute_use_t>  attributes; //!< The attribute uses.
+            std::vector<all_entry_t>      all;        //!< The elements of \c content_all.
+        };
+
+        //! \brief A state of a content model automaton.
+        class state_t {
+        public:
+            uint32_t first;     //!< The index of the first transition leaving this state.
+            uint32_t last;      //!< Past the index of the last transition leaving this state.
+            bool     accepting; //!< Whether the content may end in this state.
+        };
+
+        //! \brief A transition of a content model automaton.
+        class transition_t {
+        public:
+            symbol_t symbol; //!< The name of the child element, or \c wildcard_symbol and the wildcard index.
+            uint32_t target; //!< The state reached.
+            uint32_t decl;   //!< The declaration of the child, or the index of the wildcard.
+
+            //! \brief Order transitions by symbol.
+            bool operator<(const transition_t& rhs) const { return symbol < rhs.symbol; }
+        };
+
+        typedef std::unordered_map<name_t, symbol_t, name_hash_t> symbols_t; //!< The type of the symbol table.
+
+        //! \brief The compiler of a schema document.
+        class compiler_t {
+        public:
+            //! \brief Constructor.
+            compiler_t(schema_t& target, const document_t& document)
+            :
+                error(nullptr),
+                schema(target),
+                root(document.root()),
+                xsd(document.namespaces().find(ascii("http://www.w3.org/2001/XMLSchema"))),
+                qualifiedElements(false),
+                qualifiedAttributes(false),
+                complexSources(),
+                complexStates(),
+                complexNames(),
+                simpleSources(),
+                simpleTypes(),
+                simpleStates(),
+                simpleNames(),
+                elementSources(),
+                groups(),
+                attributeGroups(),
+                attributes(),
+                expanding()
+            {}
+
+            //! \brief Compile the schema document.
+            bool compile()
+            {
+                view_t value;
+
+                if (xsd == table_t::npos || !isXsd(root, "schema"))
+                    return fail("the root element is not a schema");
+
+                if (attribute(root, "targetNamespace", value))
+                    schema.mTarget = schema.mNamespaces.intern(value);
+
+                qualifiedElements   = attribute(root, "elementFormDefault", value) && value.equals("qualified");
+                qualifiedAttributes = attribute(root, "attributeFormDefault", value) && value.equals("qualified");
+
+                schema.mXsi = schema.mNamespaces.intern(ascii("http://www.w3.org/2001/XMLSchema-instance"));
+
+                schema.mComplexTypes.push_back(complex_type_t {
+                    content_any, true, true, 0, static_cast<uint32_t>(schema.mWildcards.size()), type_pointer_t(),
+                    std::vector<attribute_use_t>(), std::vector<all_entry_t>() });
+                schema.mWildcards.push_back(wildcard_t { true, false, std::vector<namespace_id_t>(), process_lax });
+                complexSources.push_back(nullptr);
+                complexStates.push_back(state_done);
+
+                if (!registerComponents())
+                    return false;
+
+                for (size_t i = 0; i != simpleSources.size(); ++i)
+                    if (!ensureSimple(i))
+                        return false;
+
+                for (size_t i = 0; i != complexSources.size(); ++i)
+                    if (!ensureComplex(static_cast<uint32_t>(i)))
+                        return false;
+
+                for (const std::pair<const element_t*, uint32_t>& source : elementSources) {
+                    element_decl_t decl;
+
+                    decl.symbol = schema.mElements[source.second].symbol;
+
+                    if (!compileElement(*source.first, decl))
+                        return false;
+
+                    schema.mElements[source.second] = std::move(decl);
+                }
+
+                return true;
+            }
+
+            const char* error; //!< A description of the compilation error.
+
+        private:
+            //! The compilation states of named types.
+            enum state_t {
+                state_pending,   //!< Not compiled yet.
+                state_compiling, //!< Being compiled : a reference to it is circular.
+                state_done       //!< Compiled.
+            };
+
+            //! The kinds of particles of a content model.
+            enum particle_kind_t {
+                particle_element,  //!< An element declaration.
+                particle_wildcard, //!< An \c xs:any wildcard.
+                particle_sequence, //!< A sequence of particles.
+                particle_choice,   //!< A choice of particles.
+                particle_all       //!< An \c all group.
+            };
+
+            //! \brief A particle of a content model being compiled.
+            class particle_t {
+            public:
+                particle_kind_t     kind;     //!< The kind of particle.
+                uint32_t            min;      //!< The minimum number of occurrences.
+                uint32_t            max;      //!< The maximum number of occurrences, or \c npos.
+                symbol_t            symbol;   //!< The symbol of an element or wildcard.
+                uint32_t            decl;     //!< The declaration of an element, or the index of a wildcard.
+                std::vector<size_t> children; //!< The particles of a group.
+            };
+
+            //! \brief The position sets of a particle, in the Glushkov construction.
+            class positions_t {
+            public:
+                bool                  nullable; //!< Whether the particle matches an empty content.
+                std::vector<uint32_t> first;    //!< The positions that can start the particle.
+                std::vector<uint32_t> last;     //!< The positions that can end the particle.
+            };
+
+            //! \brief The positions of a content model.
+            class model_t {
+            public:
+                std::vector<symbol_t>               symbols; //!< The symbol at each position.
+                std::vector<uint32_t>               decls;   //!< The declaration or wildcard at each position.
+                std::vector<std::vector<uint32_t> > follow;  //!< The positions that can follow each position.
+            };
+
+            typedef std::unordered_map<symbol_t, const element_t*> sources_t; //!< The type of named component tables.
+
+            //! \brief Widen an ASCII string.
+            static string_t ascii(const char* str)
+            {
+                string_t result;
+
+                while (*str != '\0')
+                    result.push_back(static_cast<charT>(*str++));
+
+                return result;
+            }
+
+            //! \brief Record an error.
+            bool fail(const char* what)
+            {
+                if (error == nullptr)
+                    error = what;
+
+                return false;
+            }
+
+            //! \brief Whether an element is a given XML Schema element.
+            bool isXsd(const element_t& element, const char* local) const
+            {
+                return element.namespace_id() == xsd && element.local_name().equals(local);
+            }
+
+            //! \brief Get the XML Schema children of an element, without annotations.
+            std::vector<const element_t*> children(const element_t& element) const
+            {
+                std::vector<const element_t*> result;
+
+                for (auto it = element.begin(); it != element.end(); ++it)
+                    if (it->kind() == node_interface_t::element_kind) {
+                        const element_t& child = static_cast<const element_t&>(*it);
+
+                        if (child.namespace_id() == xsd && !child.local_name().equals("annotation"))
+                            result.push_back(&child);
+                    }
+
+                return result;
+            }
+
+            //! \brief Get an unqualified attribute.
+            static bool attribute(const element_t& element, const char* name, view_t& value)
+            {
+                for (const attribute_t& attribute : element.attributes())
+                    if (attribute.namespace_id() == table_t::no_namespace && attribute.local_name().equals(name)) {
+                        value = attribute.value().view();
+
+                        return true;
+                    }
+
+                return false;
+            }
+
+            //! \brief Get an attribute that is \c "true" or \c "1".
+            static bool flag(const element_t& element, const char* name)
+            {
+                view_t value;
+
+                return attribute(element, name, value) && (value.equals("true") || value.equals("1"));
+            }
+
+            //! \brief Intern an expanded name.
+            symbol_t intern(namespace_id_t ns, const view_t& local)
+            {
+                typename symbols_t::const_iterator it = schema.mSymbols.find(name_t { ns, local });
+
+                if (it != schema.mSymbols.end())
+                    return it->second;
+
+                schema.mStrings.push_back(local.str());
+
+                const name_t   name   = { ns, view_t(schema.mStrings.back()) };
+                const symbol_t symbol = static_cast<symbol_t>(schema.mNames.size());
+
+                schema.mNames.push_back(name);
+                schema.mSymbols.emplace(name, symbol);
+
+                return symbol;
+            }
+
+            //! \brief Get the symbol of the \c name attribute of a component.
+            /*!
+             *  \param [in] qualified Whether the name is in the target namespace.
+             */
+            bool declaredName(const element_t& element, bool qualified, symbol_t& symbol)
+            {
+                view_t name;
+
+                if (!attribute(element, "name", name))
+                    return fail("missing component name");
+
+                symbol = intern(qualified ? schema.mTarget : table_t::no_namespace, name);
+
+                return true;
+            }
+
+            //! \brief Resolve a qualified name in an attribute value.
+            /*!
+             *  The prefix is looked up in the namespace declarations of the
+             *  element and its ancestors.
+             *
+             *  \param [out] builtin Whether the name is in the XML Schema namespace.
+             *  \param [out] local   The local name.
+             *  \param [out] symbol  The symbol of the name, if it is not built in.
+             */
+            bool resolve(const element_t& element, const view_t& qname, bool& builtin, view_t& local, symbol_t& symbol)
+            {
+                const_pointer_t first = scanner_t::skip_whitespace(qname.begin(), qname.end());
+                const_pointer_t last  = qname.end();
+
+                while (last != first && scanner_t::is_whitespace(last[-1]))
+                    --last;
+
+                const_pointer_t colon  = std::find(first, last, ':');
+                const view_t    prefix = colon != last ? view_t(first, colon) : view_t();
+                view_t          uri;
+
+                local = colon != last ? view_t(colon + 1, last) : view_t(first, last);
+
+                if (local.empty() || !lookup(element, prefix, uri))
+                    return fail("unresolved qualified name");
+
+                builtin = uri.equals("http://www.w3.org/2001/XMLSchema");
+                symbol  = builtin ? npos : intern(schema.mNamespaces.intern(uri), local);
+
+                return true;
+            }
+
+            //! \brief Find the namespace bound to a prefix.
+            bool lookup(const element_t& element, const view_t& prefix, view_t& uri) const
+            {
+                for (const element_t* current = &element; ; ) {
+                    for (const attribute_t& attribute : current->attributes())
+                        if (attribute.namespace_id() == table_t::xmlns_namespace &&
+                            (prefix.empty() ? attribute.name().view().equals("xmlns") :
+                             !attribute.name().view().equals("xmlns") && attribute.local_name() == prefix)) {
+                            uri = attribute.value().view();
+
+                            return true;
+                        }
+
+                    if (current == &root)
+                        break;
+
+                    current = &static_cast<const element_t&>(current->parent());
+                }
+
+                uri = view_t();
+
+                return prefix.empty();
+            }
+
+            //! \brief Register the top-level components.
+            bool registerComponents()
+            {
+                for (const element_t* component : children(root)) {
+                    const view_t kind = component->local_name();
+                    symbol_t     symbol;
+
+                    if (kind.equals("import") || kind.equals("include") || kind.equals("redefine") || kind.equals("override"))
+                        return fail("schema composition is not supported");
+
+                    if (kind.equals("notation"))
+                        continue;
+
+                    if (!declaredName(*component, true, symbol))
+                        return false;
+
+                    if (kind.equals("element")) {
+                        if (schema.mGlobals.count(symbol) != 0)
+                            return fail("duplicate element declaration");
+
+                        schema.mGlobals.emplace(symbol, static_cast<uint32_t>(schema.mElements.size()));
+                        elementSources.emplace_back(component, static_cast<uint32_t>(schema.mElements.size()));
+                        schema.mElements.push_back(element_decl_t { symbol, any_type, type_pointer_t(), false, false, false, string_t() });
+                    } else if (kind.equals("complexType") || kind.equals("simpleType")) {
+                        if (complexNames.count(symbol) != 0 || simpleNames.count(symbol) != 0)
+                            return fail("duplicate type definition");
+
+                        if (kind.equals("complexType"))
+                            complexNames.emplace(symbol, reserveComplex(component));
+                        else {
+                            simpleNames.emplace(symbol, simpleSources.size());
+                            simpleSources.push_back(component);
+                            simpleTypes.push_back(type_pointer_t());
+                            simpleStates.push_back(state_pending);
+                        }
+                    } else if (kind.equals("group")) {
+                        if (!groups.emplace(symbol, component).second)
+                            return fail("duplicate group definition");
+                    } else if (kind.equals("attributeGroup")) {
+                        if (!attributeGroups.emplace(symbol, component).second)
+                            return fail("duplicate attribute group definition");
+                    } else if (kind.equals("attribute")) {
+                        if (!attributes.emplace(symbol, component).second)
+                            return fail("duplicate attribute declaration");
+                    } else
+                        return fail("unexpected schema component");
+                }
+
+                return true;
+            }
+
+            //! \brief Reserve a complex type, compiled later.
+            uint32_t reserveComplex(const element_t* source)
+            {
+                schema.mComplexTypes.push_back(complex_type_t {
+                    content_empty, false, false, 0, npos, type_pointer_t(),
+                    std::vector<attribute_use_t>(), std::vector<all_entry_t>() });
+                complexSources.push_back(source);
+                complexStates.push_back(state_pending);
+
+                return static_cast<uint32_t>(schema.mComplexTypes.size() - 1);
+            }
+
+            //! \brief Compile a named simple type, if it has not been compiled yet.
+            bool ensureSimple(size_t index)
+            {
+                if (simpleStates[index] == state_done)
+                    return true;
+
+                if (simpleStates[index] == state_compiling)
+                    return fail("circular simple type definition");
+
+                simpleStates[index] = state_compiling;
+
+                type_pointer_t type;
+
+                if (!compileSimple(*simpleSources[index], type))
+                    return false;
+
+                simpleTypes[index]  = std::move(type);
+                simpleStates[index] = state_done;
+
+                return true;
+            }
+
+            //! \brief Compile a complex type, if it has not been compiled yet.
+            bool ensureComplex(uint32_t index)
+            {
+                if (complexStates[index] == state_done)
+                    return true;
+
+                if (complexStates[index] == state_compiling)
+                    return fail("circular complex type definition");
+
+                complexStates[index] = state_compiling;
+
+                complex_type_t type;
+
+                if (!compileComplex(*complexSources[index], type))
+                    return false;
+
+                schema.mComplexTypes[index] = std::move(type);
+                complexStates[index]        = state_done;
+
+                return true;
+            }
+
+            //! \brief Resolve a reference to a simple type.
+            bool resolveSimple(const element_t& element, const view_t& qname, type_pointer_t& type)
+            {
+                bool     builtin;
+                view_t   local;
+                symbol_t symbol;
+
+                if (!resolve(element, qname, builtin, local, symbol))
+                    return false;
+
+                if (builtin) {
+                    type = simple_type_t::builtin(local);
+
+                    return type ? true : fail("unknown built-in simple type");
+                }
+
+                typename std::unordered_map<symbol_t, size_t>::const_iterator it = simpleNames.find(symbol);
+
+                if (it == simpleNames.end())
+                    return fail("unresolved simple type reference");
+
+                if (!ensureSimple(it->second))
+                    return false;
+
+                type = simpleTypes[it->second];
+
+                return true;
+            }
+
+            //! \brief Resolve a reference to a simple or complex type.
+            /*!
+             *  \param [out] complex The complex type, or \c npos.
+             *  \param [out] simple  The simple type, if it is not complex.
+             */
+            bool resolveType(const element_t& element, const view_t& qname, uint32_t& complex, type_pointer_t& simple)
+            {
+                bool     builtin;
+                view_t   local;
+                symbol_t symbol;
+
+                if (!resolve(element, qname, builtin, local, symbol))
+                    return false;
+
+                complex = npos;
+
+                if (builtin && local.equals("anyType")) {
+                    complex = any_type;
+
+                    return true;
+                }
+
+                if (!builtin) {
+                    typename std::unordered_map<symbol_t, uint32_t>::const_iterator it = complexNames.find(symbol);
+
+                    if (it != complexNames.end()) {
+                        complex = it->second;
+
+                        return true;
+                    }
+                }
+
+                return resolveSimple(element, qname, simple);
+            }
+
+            //! \brief Compile a \c simpleType element.
+            bool compileSimple(const element_t& element, type_pointer_t& type)
+            {
+                for (const element_t* child : children(element)) {
+                    view_t value;
+
+                    if (isXsd(*child, "restriction")) {
+                        type_pointer_t base;
+
+                        if (!simpleBase(*child, base))
+                            return false;
+
+                        std::shared_ptr<simple_type_t> derived(new simple_type_t(*base));
+
+                        if (!restrictSimple(*child, *derived))
+                            return false;
+
+                        type = std::move(derived);
+
+                        return true;
+                    }
+
+                    if (isXsd(*child, "list")) {
+                        type_pointer_t item;
+
+                        if (!simpleBase(*child, item, "itemType"))
+                            return false;
+
+                        type = simple_type_t::list_of(item);
+
+                        return true;
+                    }
+
+                    if (isXsd(*child, "union")) {
+                        std::vector<type_pointer_t> members;
+
+                        if (attribute(*child, "memberTypes", value)) {
+                            const_pointer_t first = scanner_t::skip_whitespace(value.begin(), value.end());
+
+                            while (first != value.end()) {
+                                const_pointer_t last = first;
+
+                                while (last != value.end() && !scanner_t::is_whitespace(*last))
+                                    ++last;
+
+                                members.push_back(type_pointer_t());
+
+                                if (!resolveSimple(*child, view_t(first, last), members.back()))
+                                    return false;
+
+                                first = scanner_t::skip_whitespace(last, value.end());
+                            }
+                        }
+
+                        for (const element_t* member : children(*child)) {
+                            members.push_back(type_pointer_t());
+
+                            if (!isXsd(*member, "simpleType") || !compileSimple(*member, members.back()))
+                                return fail("invalid union member type");
+                        }
+
+                        if (members.empty())
+                            return fail("union without member types");
+
+                        type = simple_type_t::union_of(std::move(members));
+
+                        return true;
+                    }
+                }
+
+                return fail("invalid simple type definition");
+            }
+
+            //! \brief Get the base type of a restriction, or the item type of a list.
+            /*!
+             *  The type is named by an attribute, or defined by a nested
+             *  \c simpleType element.
+             */
+            bool simpleBase(const element_t& element, type_pointer_t& type, const char* name = "base")
+            {
+                view_t value;
+
+                if (attribute(element, name, value))
+                    return resolveSimple(element, value, type);
+
+                for (const element_t* child : children(element))
+                    if (isXsd(*child, "simpleType"))
+                        return compileSimple(*child, type);
+
+                return fail("simple type without base type");
+            }
+
+            //! \brief Add the facets of a restriction to a simple type.
+            bool restrictSimple(const element_t& restriction, simple_type_t& type)
+            {
+                std::vector<string_t> enumeration;
+                std::vector<view_t>   patterns;
+                std::vector<std::pair<view_t, view_t> > facets;
+
+                for (const element_t* child : children(restriction)) {
+                    const view_t kind = child->local_name();
+                    view_t       value;
+
+                    if (kind.equals("simpleType") || kind.equals("attribute") || kind.equals("attributeGroup") ||
+                        kind.equals("anyAttribute"))
+                        continue;
+
+                    if (!attribute(*child, "value", value))
+                        return fail("facet without value");
+
+                    if (kind.equals("enumeration"))
+                        enumeration.push_back(value.str());
+                    else if (kind.equals("pattern"))
+                        patterns.push_back(value);
+                    else
+                        facets.emplace_back(kind, value);
+                }
+
+                const char* message = nullptr;
+
+                if (!enumeration.empty())
+                    message = type.add_enumeration(std::move(enumeration));
+
+                for (size_t i = 0; message == nullptr && i != facets.size(); ++i)
+                    message = type.add_facet(facets[i].first, facets[i].second);
+
+                if (message == nullptr && !patterns.empty())
+                    message = type.add_pattern(patterns);
+
+                return message == nullptr || fail(message);
+            }
+
+            //! \brief Compile an element declaration.
+            /*!
+             *  \param [in]     element The \c element element.
+             *  \param [in,out] decl    The declaration, whose symbol is set.
+             */
+            bool compileElement(const element_t& element, element_decl_t& decl)
+            {
+                view_t value;
+
+                decl.complex  = npos;
+                decl.nillable = flag(element, "nillable");
+                decl.fixed    = attribute(element, "fixed", value);
+                decl.preset   = decl.fixed || attribute(element, "default", value);
+                decl.value    = decl.preset ? value.str() : string_t();
+
+                if (attribute(element, "type", value)) {
+                    if (!resolveType(element, value, decl.complex, decl.simple))
+                        return false;
+                } else {
+                    decl.complex = any_type;
+
+                    for (const element_t* child : children(element))
+                        if (isXsd(*child, "complexType")) {
+                            decl.complex = reserveComplex(child);
+
+                            if (!ensureComplex(decl.complex))
+                                return false;
+                        } else if (isXsd(*child, "simpleType")) {
+                            decl.complex = npos;
+
+                            if (!compileSimple(*child, decl.simple))
+                                return false;
+                        }
+                }
+
+                if (decl.preset) {
+                    const type_pointer_t& type = decl.complex == npos ? decl.simple : schema.mComplexTypes[decl.complex].simple;
+
+                    if (type && !type->check(decl.value))
+                        return fail("invalid element value constraint");
+                }
+
+                return true;
+            }
+
+            //! \brief Compile a complex type.
+            bool compileComplex(const element_t& element, complex_type_t& type)
+            {
+                type = complex_type_t {
+                    content_empty, flag(element, "mixed"), false, 0, npos, type_pointer_t(),
+                    std::vector<attribute_use_t>(), std::vector<all_entry_t>() };
+
+                std::vector<particle_t> particles;
+                size_t                  model = npos;
+
+                for (const element_t* child : children(element))
+                    if (isXsd(*child, "simpleContent")) {
+                        if (!readSimpleContent(*child, type))
+                            return false;
+
+                        type.content = content_simple;
+
+                        return true;
+                    }
+
+                if (!readComplexContent(element, type, particles, model))
+                    return false;
+
+                if (model == npos)
+                    return true;
+
+                if (particles[model].kind == particle_all)
+                    return compileAll(particles, model, type);
+
+                type.content = content_children;
+
+                return compileModel(particles, model, type.start);
+            }
+
+            //! \brief Read the content model and attributes of a complex type.
+            /*!
+             *  \param [in]     element   A \c complexType, or the \c extension or
+             *                            \c restriction of a complex content.
+             *  \param [in,out] type      The type, whose attributes are added.
+             *  \param [in,out] particles The particles read.
+             *  \param [out]    model     The root particle, or \c npos if the
+             *                            content is empty.
+             */
+            bool readComplexContent(const element_t& element, complex_type_t& type, std::vector<particle_t>& particles, size_t& model)
+            {
+                model = npos;
+
+                for (const element_t* child : children(element)) {
+                    const view_t kind = child->local_name();
+
+                    if (kind.equals("complexContent")) {
+                        view_t value;
+
+                        if (attribute(*child, "mixed", value))
+                            type.mixed = value.equals("true") || value.equals("1");
+
+                        const std::vector<const element_t*> derivation = children(*child);
+
+                        if (derivation.size() != 1 || !attribute(*derivation[0], "base", value))
+                            return fail("invalid complex content");
+
+                        uint32_t       base;
+                        type_pointer_t simple;
+
+                        if (!resolveType(*derivation[0], value, base, simple))
+                            return false;
+
+                        if (base == npos)
+                            return fail("complex content derived from a simple type");
+
+                        size_t inherited = npos;
+
+                        if (base != any_type) {
+                            if (!expanding.insert(complexSources[base]).second)
+                                return fail("circular complex type derivation");
+
+                            if (!readComplexContent(*complexSources[base], type, particles, inherited))
+                                return false;
+
+                            expanding.erase(complexSources[base]);
+                        }
+
+                        if (!readComplexContent(*derivation[0], type, particles, model))
+                            return false;
+
+                        if (isXsd(*derivation[0], "extension") && inherited != npos) {
+                            if (model != npos) {
+                                if (particles[model].kind == particle_all || particles[inherited].kind == particle_all)
+                                    return fail("extension of an all group");
+
+                                particles.push_back(particle_t { particle_sequence, 1, 1, npos, npos,
+                                    std::vector<size_t> { inherited, model } });
+                                model = particles.size() - 1;
+                            } else
+                                model = inherited;
+                        }
+                    } else if (kind.equals("simpleContent"))
+                        return fail("simple content in a complex content derivation");
+                    else if (kind.equals("sequence") || kind.equals("choice") || kind.equals("all") || kind.equals("group")) {
+                        if (model != npos)
+                            return fail("several content models");
+
+                        if (!readParticle(*child, particles, model))
+                            return false;
+                    } else if (!readAttribute(*child, type))
+                        return false;
+                }
+
+                return true;
+            }
+
+            //! \brief Read the simple content of a complex type.
+            bool readSimpleContent(const element_t& element, complex_type_t& type)
+            {
+                const std::vector<const element_t*> derivation = children(element);
+                view_t value;
+
+                if (derivation.size() != 1 || !attribute(*derivation[0], "base", value))
+                    return fail("invalid simple content");
+
+                uint32_t base;
+
+                if (!resolveType(*derivation[0], value, base, type.simple))
+                    return false;
+
+                if (base != npos) {
+                    if (base == any_type || !ensureComplex(base) || schema.mComplexTypes[base].content != content_simple)
+                        return fail("simple content derived from a complex type without simple content");
+
+                    type.simple     = schema.mComplexTypes[base].simple;
+                    type.attributes = schema.mComplexTypes[base].attributes;
+                    type.wildcard   = schema.mComplexTypes[base].wildcard;
+                }
+
+                if (isXsd(*derivation[0], "restriction")) {
+                    std::shared_ptr<simple_type_t> derived(new simple_type_t(*type.simple));
+
+                    if (!restrictSimple(*derivation[0], *derived))
+                        return false;
+
+                    type.simple = std::move(derived);
+                }
+
+                for (const element_t* child : children(*derivation[0]))
+                    if (!isXsd(*child, "simpleType") && !isFacet(child->local_name()) && !readAttribute(*child, type))
+                        return false;
+
+                return true;
+            }
+
+            //! \brief Whether a name is the name of a facet.
+            static bool isFacet(const view_t& name)
+            {
+                static const char* const facets[] = {
+                    "enumeration", "pattern", "length", "minLength", "maxLength", "minInclusive", "minExclusive",
+                    "maxInclusive", "maxExclusive", "totalDigits", "fractionDigits", "whiteSpace"
+                };
+
+                for (const char* facet : facets)
+                    if (name.equals(facet))
+                        return true;
+
+                return false;
+            }
+
+            //! \brief Read an attribute use, attribute group reference or attribute wildcard.
+            bool readAttribute(const element_t& element, complex_type_t& type)
+            {
+                if (isXsd(element, "anyAttribute"))
+                    return readWildcard(element, type.wildcard);
+
+                if (isXsd(element, "attributeGroup")) {
+                    view_t   value;
+                    bool     builtin;
+                    view_t   local;
+                    symbol_t symbol;
+
+                    if (!attribute(element, "ref", value) || !resolve(element, value, builtin, local, symbol))
+                        return fail("invalid attribute group reference");
+
+                    typename sources_t::const_iterator it = attributeGroups.find(symbol);
+
+                    if (it == attributeGroups.end())
+                        return fail("unresolved attribute group reference");
+
+                    if (!expanding.insert(it->second).second)
+                        return fail("circular attribute group reference");
+
+                    for (const element_t* child : children(*it->second))
+                        if (!readAttribute(*child, type))
+                            return false;
+
+                    expanding.erase(it->second);
+
+                    return true;
+                }
+
+                if (!isXsd(element, "attribute"))
+                    return fail("unexpected element in a complex type");
+
+                attribute_use_t use;
+                bool            prohibited;
+
+                if (!compileAttribute(element, false, use, prohibited))
+                    return false;
+
+                typename std::vector<attribute_use_t>::iterator it = type.attributes.begin();
+
+                while (it != type.attributes.end() && !(it->name == use.name))
+                    ++it;
+
+                if (prohibited) {
+                    if (it != type.attributes.end())
+                        type.attributes.erase(it);
+                } else if (it != type.attributes.end())
+                    *it = std::move(use);
+                else
+                    type.attributes.push_back(std::move(use));
+
+                return true;
+            }
+
+            //! \brief Compile an attribute declaration or reference.
+            /*!
+             *  \param [in]  element    The \c attribute element.
+             *  \param [in]  global     Whether the declaration is at top level.
+             *  \param [out] use        The attribute use.
+             *  \param [out] prohibited Whether the attribute is prohibited.
+             */
+            bool compileAttribute(const element_t& element, bool global, attribute_use_t& use, bool& prohibited)
+            {
+                view_t value;
+
+                if (attribute(element, "ref", value)) {
+                    bool     builtin;
+                    view_t   local;
+                    symbol_t symbol;
+
+                    if (!resolve(element, value, builtin, local, symbol))
+                        return false;
+
+                    typename sources_t::const_iterator it = attributes.find(symbol);
+
+                    if (it == attributes.end())
+                        return fail("unresolved attribute reference");
+
+                    if (!compileAttribute(*it->second, true, use, prohibited))
+                        return false;
+                } else {
+                    symbol_t symbol;
+                    const bool qualified = global || (attribute(element, "form", value) ?
+                                                      value.equals("qualified") : qualifiedAttributes);
+
+                    if (!declaredName(element, qualified, symbol))
+                        return false;
+
+                    use.name     = schema.mNames[symbol];
+                    use.required = false;
+                    use.fixed    = false;
+
+                    if (attribute(element, "type", value)) {
+                        if (!resolveSimple(element, value, use.type))
+                            return false;
+                    } else if (!simpleBase(element, use.type)) {
+                        error    = nullptr;
+                        use.type = simple_type_t::builtin(ascii("anySimpleType"));
+                    }
+                }
+
+                prohibited = false;
+
+                if (attribute(element, "use", value)) {
+                    use.required = value.equals("required");
+                    prohibited   = value.equals("prohibited");
+                }
+
+                if (attribute(element, "fixed", value)) {
+                    use.fixed = true;
+                    use.value = value.str();
+                }
+
+                if ((attribute(element, "fixed", value) || attribute(element, "default", value)) && !use.type->check(value))
+                    return fail("invalid attribute value constraint");
+
+                return true;
+            }
+
+            //! \brief Read a wildcard.
+            /*!
+             *  \param [out] index The index of the wildcard.
+             */
+            bool readWildcard(const element_t& element, uint32_t& index)
+            {
+                wildcard_t wildcard = { false, false, std::vector<namespace_id_t>(), process_strict };
+                view_t     value;
+
+                if (!attribute(element, "namespace", value) || value.equals("##any"))
+                    wildcard.any = true;
+                else if (value.equals("##other"))
+                    wildcard.other = true;
+                else {
+                    const_pointer_t first = scanner_t::skip_whitespace(value.begin(), value.end());
+
+                    while (first != value.end()) {
+                        const_pointer_t last = first;
+
+                        while (last != value.end() && !scanner_t::is_whitespace(*last))
+                            ++last;
+
+                        const view_t token(first, last);
+
+                        if (token.equals("##targetNamespace"))
+                            wildcard.namespaces.push_back(schema.mTarget);
+                        else if (token.equals("##local"))
+                            wildcard.namespaces.push_back(table_t::no_namespace);
+                        else
+                            wildcard.namespaces.push_back(schema.mNamespaces.intern(token));
+
+                        first = scanner_t::skip_whitespace(last, value.end());
+                    }
+                }
+
+                if (attribute(element, "processContents", value))
+                    wildcard.process = value.equals("lax") ? process_lax : value.equals("skip") ? process_skip : process_strict;
+
+                index = static_cast<uint32_t>(schema.mWildcards.size());
+                schema.mWildcards.push_back(std::move(wildcard));
+
+                return true;
+            }
+
+            //! \brief Read the occurrence bounds of a particle.
+            bool readOccurs(const element_t& element, uint32_t& min, uint32_t& max)
+            {
+                view_t value;
+
+                min = max = 1;
+
+                if (attribute(element, "minOccurs", value) && !readCount(value, min))
+                    return fail("invalid minOccurs");
+
+                if (attribute(element, "maxOccurs", value)) {
+                    if (value.equals("unbounded"))
+                        max = npos;
+                    else if (!readCount(value, max))
+                        return fail("invalid maxOccurs");
+                }
+
+                return min <= max || fail("minOccurs greater than maxOccurs");
+            }
+
+            //! \brief Read a count.
+            static bool readCount(const view_t& value, uint32_t& count)
+            {
+                count = 0;
+
+                if (value.empty())
+                    return false;
+
+                for (charT c : value) {
+                    if (c < '0' || c > '9' || count > max_positions)
+                        return false;
+
+                    count = count * 10 + (c - '0');
+                }
+
+                return true;
+            }
+
+            //! \brief Read a particle.
+            /*!
+             *  \param [in]     element   An \c element, \c any, \c sequence,
+             *                            \c choice, \c all or \c group element.
+             *  \param [in,out] particles The particles read.
+             *  \param [out]    index     The index of the particle read.
+             */
+            bool readParticle(const element_t& element, std::vector<particle_t>& particles, size_t& index)
+            {
+                particle_t particle = { particle_sequence, 1, 1, npos, npos, std::vector<size_t>() };
+                view_t     value;
+
+                if (!readOccurs(element, particle.min, particle.max))
+                    return false;
+
+                if (isXsd(element, "element")) {
+                    particle.kind = particle_element;
+
+                    if (attribute(element, "ref", value)) {
+                        bool   builtin;
+                        view_t local;
+
+                        if (!resolve(element, value, builtin, local, particle.symbol))
+                            return false;
+
+                        typename std::unordered_map<symbol_t, uint32_t>::const_iterator it = schema.mGlobals.find(particle.symbol);
+
+                        if (it == schema.mGlobals.end())
+                            return fail("unresolved element reference");
+
+                        particle.decl = it->second;
+                    } else {
+                        element_decl_t decl;
+                        const bool qualified = attribute(element, "form", value) ? value.equals("qualified") : qualifiedElements;
+
+                        if (!declaredName(element, qualified, decl.symbol) || !compileElement(element, decl))
+                            return false;
+
+                        particle.symbol = decl.symbol;
+                        particle.decl   = static_cast<uint32_t>(schema.mElements.size());
+                        schema.mElements.push_back(std::move(decl));
+                    }
+                } else if (isXsd(element, "any")) {
+                    particle.kind = particle_wildcard;
+
+                    if (!readWildcard(element, particle.decl))
+                        return false;
+
+                    particle.symbol = wildcard_symbol | particle.decl;
+                } else if (isXsd(element, "group")) {
+                    bool     builtin;
+                    view_t   local;
+                    symbol_t symbol;
+
+                    if (!attribute(element, "ref", value) || !resolve(element, value, builtin, local, symbol))
+                        return fail("invalid group reference");
+
+                    typename sources_t::const_iterator it = groups.find(symbol);
+
+                    if (it == groups.end())
+                        return fail("unresolved group reference");
+
+                    const std::vector<const element_t*> model = children(*it->second);
+
+                    if (model.size() != 1)
+                        return fail("invalid group definition");
+
+                    if (!expanding.insert(it->second).second)
+                        return fail("circular group reference");
+
+                    if (!readParticle(*model[0], particles, index))
+                        return false;
+
+                    expanding.erase(it->second);
+
+                    particles[index].min = particle.min;
+                    particles[index].max = particle.max;
+
+                    return true;
+                } else if (isXsd(element, "sequence") || isXsd(element, "choice") || isXsd(element, "all")) {
+                    particle.kind = isXsd(element, "sequence") ? particle_sequence :
+                                    isXsd(element, "choice")   ? particle_choice   : particle_all;
+
+                    for (const element_t* child : children(element)) {
+                        size_t item;
+
+                        if (particle.kind == particle_all && !isXsd(*child, "element"))
+                            return fail("all group with a particle that is not an element");
+
+                        if (!readParticle(*child, particles, item))
+                            return false;
+
+                        if (particle.kind == particle_all ? particles[item].max > 1 : particles[item].kind == particle_all)
+                            return fail("invalid all group");
+
+                        particle.children.push_back(item);
+                    }
+                } else
+                    return fail("unexpected element in a content model");
+
+                index = particles.size();
+                particles.push_back(std::move(particle));
+
+                return true;
+            }
+
+            //! \brief Compile an \c all group.
+            bool compileAll(const std::vector<particle_t>& particles, size_t index, complex_type_t& type)
+            {
+                const particle_t& all = particles[index];
+
+                if (all.children.size() > 64)
+                    return fail("all group with more than 64 elements");
+
+                type.content  = content_all;
+                type.optional = all.min == 0;
+
+                for (size_t child : all.children)
+                    type.all.push_back(all_entry_t { particles[child].symbol, particles[child].decl, particles[child].min != 0 });
+
+                return true;
+            }
+
+            //! \brief Compile a content model into a deterministic automaton.
+            /*!
+             *  The particles are expanded into the Glushkov automaton of the
+             *  model, with one state per position, then the subset
+             *  construction makes it deterministic. The positions reached
+             *  by a name from a state must all be the same declaration : a
+             *  model where a child could match two particles is rejected.
+             *
+             *  \param [out] start The initial state of the automaton.
+             */
+            bool compileModel(const std::vector<particle_t>& particles, size_t root, uint32_t& start)
+            {
+                model_t     model;
+                positions_t positions;
+
+                if (!analyze(particles, root, model, positions))
+                    return false;
+
+                for (std::vector<uint32_t>& follow : model.follow) {
+                    std::sort(follow.begin(), follow.end());
+                    follow.erase(std::unique(follow.begin(), follow.end()), follow.end());
+                }
+
+                std::vector<bool> accepting(model.symbols.size() + 1, false);
+
+                accepting[0] = positions.nullable;
+
+                for (uint32_t position : positions.last)
+                    accepting[position + 1] = true;
+
+                std::map<std::vector<uint32_t>, uint32_t> ids;
+                std::vector<std::vector<uint32_t> >       sets(1, std::vector<uint32_t>(1, 0));
+
+                start = static_cast<uint32_t>(schema.mStates.size());
+                ids[sets[0]] = start;
+
+                for (size_t i = 0; i != sets.size(); ++i) {
+                    std::map<symbol_t, std::vector<uint32_t> > targets;
+                    bool accepts = false;
+
+                    for (uint32_t state : sets[i]) {
+                        accepts = accepts || accepting[state];
+
+                        for (uint32_t position : state == 0 ? positions.first : model.follow[state - 1])
+                            targets[model.symbols[position]].push_back(position + 1);
+                    }
+
+                    schema.mStates.push_back(typename schema_t::state_t {
+                        static_cast<uint32_t>(schema.mTransitions.size()),
+                        static_cast<uint32_t>(schema.mTransitions.size() + targets.size()),
+                        accepts });
+
+                    for (std::pair<const symbol_t, std::vector<uint32_t> >& target : targets) {
+                        std::sort(target.second.begin(), target.second.end());
+                        target.second.erase(std::unique(target.second.begin(), target.second.end()), target.second.end());
+
+                        const uint32_t decl = model.decls[target.second[0] - 1];
+
+                        for (uint32_t state : target.second)
+                            if (model.decls[state - 1] != decl)
+                                return fail("content model violates the unique particle attribution");
+
+                        std::pair<typename std::map<std::vector<uint32_t>, uint32_t>::iterator, bool> inserted =
+                            ids.emplace(target.second, static_cast<uint32_t>(start + sets.size()));
+
+                        if (inserted.second)
+                            sets.push_back(target.second);
+
+                        schema.mTransitions.push_back(transition_t { target.first, inserted.first->second, decl });
+                    }
+                }
+
+                return true;
+            }
+
+            //! \brief Append the positions of a particle to a sequence.
+            static void concatenate(positions_t& result, positions_t next, model_t& model)
+            {
+                for (uint32_t position : result.last)
+                    model.follow[position].insert(model.follow[position].end(), next.first.begin(), next.first.end());
+
+                if (result.nullable)
+                    result.first.insert(result.first.end(), next.first.begin(), next.first.end());
+
+                if (next.nullable)
+                    next.last.insert(next.last.end(), result.last.begin(), result.last.end());
+
+                result.last     = std::move(next.last);
+                result.nullable = result.nullable && next.nullable;
+            }
+
+            //! \brief Compute the position sets of a particle, with its occurrences.
+            /*!
+             *  Occurrence bounds are unrolled : a particle occurring from
+             *  \c min to \c max times is its model \c min times, followed by
+             *  \c max - \c min optional copies, or a repeated copy if it is
+             *  unbounded.
+             */
+            bool analyze(const std::vector<particle_t>& particles, size_t index, model_t& model, positions_t& result)
+            {
+                const uint32_t min = particles[index].min;
+                const uint32_t max = particles[index].max;
+
+                result = positions_t { true, std::vector<uint32_t>(), std::vector<uint32_t>() };
+
+                for (uint32_t i = 0; i != (max == npos ? std::max(min, 1u) : max); ++i) {
+                    positions_t copy;
+
+                    if (!analyzeOnce(particles, index, model, copy))
+                        return false;
+
+                    if (max == npos && i + 1 == std::max(min, 1u))
+                        for (uint32_t position : copy.last)
+                            model.follow[position].insert(model.follow[position].end(), copy.first.begin(), copy.first.end());
+
+                    if (i >= min)
+                        copy.nullable = true;
+
+                    concatenate(result, std::move(copy), model);
+                }
+
+                return true;
+            }
+
+            //! \brief Compute the position sets of one occurrence of a particle.
+            bool analyzeOnce(const std::vector<particle_t>& particles, size_t index, model_t& model, positions_t& result)
+            {
+                const particle_t& particle = particles[index];
+
+                if (particle.kind == particle_element || particle.kind == particle_wildcard) {
+                    if (model.symbols.size() == max_positions)
+                        return fail("content model too large");
+
+                    const uint32_t position = static_cast<uint32_t>(model.symbols.size());
+
+                    model.symbols.push_back(particle.symbol);
+                    model.decls.push_back(particle.decl);
+                    model.follow.push_back(std::vector<uint32_t>());
+
+                    result = positions_t { false, std::vector<uint32_t>(1, position), std::vector<uint32_t>(1, position) };
+
+                    return true;
+                }
+
+                const bool choice = particle.kind == particle_choice;
+
+                result = positions_t { !choice, std::vector<uint32_t>(), std::vector<uint32_t>() };
+
+                for (size_t child : particle.children) {
+                    positions_t next;
+
+                    if (!analyze(particles, child, model, next))
+                        return false;
+
+                    if (!choice) {
+                        concatenate(result, std::move(next), model);
+                        continue;
+                    }
+
+                    result.nullable = result.nullable || next.nullable;
+                    result.first.insert(result.first.end(), next.first.begin(), next.first.end());
+                    result.last.insert(result.last.end(), next.last.begin(), next.last.end());
+                }
+
+                return true;
+            }
+
+            schema_t&        schema; //!< The schema being compiled.
+            const element_t& root;   //!< The \c schema element.
+            namespace_id_t   xsd;    //!< The XML Schema namespace in the schema document.
+
+            bool qualifiedElements;   //!< Whether local elements are qualified by default.
+            bool qualifiedAttributes; //!< Whether local attributes are qualified by default.
+
+            std::vector<const element_t*>          complexSources; //!< The definition of each complex type.
+            std::vector<state_t>                   complexStates;  //!< The compilation state of each complex type.
+            std::unordered_map<symbol_t, uint32_t> complexNames;   //!< The named complex types.
+
+            std::vector<const element_t*>        simpleSources; //!< The definition of each named simple type.
+            std::vector<type_pointer_t>          simpleTypes;   //!< The compiled named simple types.
+            std::vector<state_t>                 simpleStates;  //!< The compilation state of each named simple type.
+            std::unordered_map<symbol_t, size_t> simpleNames;   //!< The named simple types.
+
+            std::vector<std::pair<const element_t*, uint32_t> > elementSources; //!< The global element declarations.
+
+            sources_t groups;          //!< The model group definitions.
+            sources_t attributeGroups; //!< The attribute group definitions.
+            sources_t attributes;      //!< The global attribute declarations.
+
+            std::unordered_set<const element_t*> expanding; //!< The groups and types being expanded, to detect cycles.
+        };
+
+        //! \brief Constructor.
+        /*!
+         *  Builds an empty schema, filled by \c compiler_t.
+         */
+        basic_compiled_schema()
+        :
+            mNamespaces(),
+            mTarget(table_t::no_namespace),
+            mXsi(table_t::npos),
+            mStrings(),
+            mNames(),
+            mSymbols(),
+            mGlobals(),
+            mElements(),
+            mComplexTypes(),
+            mWildcards(),
+            mStates(),
+            mTransitions()
+        {}
+
+        //! \brief Get the symbol of an expanded name.
+        /*!
+         *  \return The symbol, or \c npos if the name does not appear in
+         *          the schema.
+         */
+        symbol_t symbol(namespace_id_t ns, const view_t& local) const
+        {
+            if (ns == table_t::npos)
+                return npos;
+
+            typename symbols_t::const_iterator it = mSymbols.find(name_t { ns, local });
+
+            return it != mSymbols.end() ? it->second : npos;
+        }
+
+        //! \brief Get the global declaration of an element.
+        /*!
+         *  \return The index of the declaration, or \c npos.
+         */
+        uint32_t global(symbol_t symbol) const
+        {
+            if (symbol == npos)
+                return npos;
+
+            typename std::unordered_map<symbol_t, uint32_t>::const_iterator it = mGlobals.find(symbol);
+
+            return it != mGlobals.end() ? it->second : npos;
+        }
+
+        //! \brief Follow the transition of a child element.
+        /*!
+         *  The child is looked up among the element transitions first, then
+         *  among the wildcards.
+         *
+         *  \param [in,out] state  The current state, updated.
+         *  \param [in]     symbol The symbol of the child, or \c npos.
+         *  \param [in]     ns     The namespace of the child.
+         *
+         *  \return The transition followed, or \c nullptr if the child is not allowed.
+         */
+        const transition_t* advance(uint32_t& state, symbol_t symbol, namespace_id_t ns) const
+        {
+            const transition_t* first = mTransitions.data() + mStates[state].first;
+            const transition_t* last  = mTransitions.data() + mStates[state].last;
+
+            if (symbol != npos) {
+                const transition_t* found = std::lower_bound(first, last, transition_t { symbol, 0, 0 });
+
+                if (found != last && found->symbol == symbol) {
+                    state = found->target;
+
+                    return found;
+                }
+            }
+
+            for (first = std::lower_bound(first, last, transition_t { wildcard_symbol, 0, 0 }); first != last; ++first)
+                if (mWildcards[first->decl].allows(ns, mTarget)) {
+                    state = first->target;
+
+                    return first;
+                }
+
+            return nullptr;
+        }
+
+        table_t        mNamespaces; //!< The namespaces the schema refers to.
+        namespace_id_t mTarget;     //!< The target namespace.
+        namespace_id_t mXsi;        //!< The XML Schema instance namespace.
+
+        std::deque<string_t>  mStrings; //!< The local names, referenced by the symbols. A deque never moves them.
+        std::vector<name_t>   mNames;   //!< The expanded name of each symbol.
+        symbols_t             mSymbols; //!< The expanded names, interned.
+
+        std::unordered_map<symbol_t, uint32_t> mGlobals;      //!< The global element declarations, by symbol.
+        std::vector<element_decl_t>            mElements;     //!< The global and local element declarations.
+        std::vector<complex_type_t>            mComplexTypes; //!< The complex types, starting with \c xs:anyType.
+        std::vector<wildcard_t>                mWildcards;    //!< The element and attribute wildcards.
+        std::vector<state_t>                   mStates;       //!< The states of all the content model automata.
+        std::vector<transition_t>              mTransitions;  //!< The transitions of all the automata, sorted by symbol in each state.
+    };
+
+    //! \brief The state of one validation against a compiled schema.
+    /*!
+     *  This class validates a document given as a sequence of events :
+     *  the start of an element, its attributes, the end of its attributes,
+     *  its text and its end. It keeps one frame per open element, so that
+     *  its memory is bounded by the depth of the document and the length
+     *  of the text of the innermost element with simple content.
+     *
+     *  Names are given as namespace identifiers of the schema namespace
+     *  table, or \c table_t::npos for namespaces the schema does not know,
+     *  and local names. A validator holds a reference to its schema, which
+     *  must outlive it, and is used by one thread at a time.
+     *
+     *  \sa xml::basic_compiled_schema
+     *
+     *  \tparam charT The type of character used in the schema.
+     *                By default, char and wchar_t are supported.
+     */
+    template <typename charT>
+    class basic_schema_validator {
+    public:
+        //! \name Member types
+        //!@{
+        typedef          basic_compiled_schema<charT> schema_t;     //!< The compiled schema type.
+        typedef typename schema_t::view_t             view_t;       //!< The type of names and values.
+        typedef typename schema_t::string_t           string_t;     //!< The string type.
+        typedef typename schema_t::scanner_t          scanner_t;    //!< The scanner type.
+        typedef typename schema_t::element_t          element_t;    //!< The element type.
+        typedef typename schema_t::table_t            table_t;      //!< The namespace table type.
+        typedef typename schema_t::error_t            error_t;      //!< The type of validity errors.
+        typedef typename schema_t::violations_t       violations_t; //!< A list of validity errors.
+        typedef typename schema_t::simple_type_t      simple_type_t; //!< The simple type type.
+
+        //!@}
+
+        //! \brief Constructor.
+        /*!
+         *  \param [in]  schema     The compiled schema.
+         *  \param [out] violations The list the validity errors are
+         *                          appended to, or \c nullptr to stop at
+         *                          the first error.
+         */
+        basic_schema_validator(const schema_t& schema, violations_t* violations = nullptr)
+        :
+            mSchema(schema),
+            mViolations(violations),
+            mFrames(),
+            mSeen(),
+            mText(),
+            mScratch(),
+            mValid(true)
+        {}
+
+        //! \brief Restart the validation for a new document.
+        /*!
+         *  The internal buffers are kept, so that validating several
+         *  documents does not allocate memory.
+         */
+        void reset()
+        {
+            mFrames.clear();
+            mText.clear();
+            mValid = true;
+        }
+
+        //! \brief Start an element.
+        /*!
+         *  \param [in] ns      The namespace of the element, in the schema table.
+         *  \param [in] local   The local name of the element.
+         *  \param [in] element The element, reported in violations, if any.
+         *  \param [in] offset  The index of the element in document order, reported in violations.
+         *
+         *  \return \c false if the validation stops.
+         */
+        bool start_element(namespace_id_t ns, const view_t& local, const element_t* element, size_t offset = 0)
+        {
+            const typename schema_t::symbol_t symbol = mSchema.symbol(ns, local);
+
+            frame_t frame = { nullptr, nullptr, nullptr, element, offset, 0, 0, mText.size(), nullptr, mode_strict, false, false, false };
+            uint32_t decl = schema_t::npos;
+
+            if (mFrames.empty()) {
+                decl = mSchema.global(symbol);
+
+                if (decl == schema_t::npos && !report(schema_t::undeclared_element, frame))
+                    return false;
+            } else {
+                frame_t& parent = mFrames.back();
+
+                parent.children = true;
+
+                if (parent.mode == mode_skip)
+                    frame.mode = mode_skip;
+                else if (parent.mode == mode_lax || (parent.type != nullptr && parent.type->content == schema_t::content_any))
+                    decl = mSchema.global(symbol);
+                else if (!child(parent, symbol, ns, decl, frame))
+                    return false;
+            }
+
+            if (decl != schema_t::npos) {
+                const typename schema_t::element_decl_t& declaration = mSchema.mElements[decl];
+
+                frame.decl   = &declaration;
+                frame.type   = declaration.complex != schema_t::npos ? &mSchema.mComplexTypes[declaration.complex] : nullptr;
+                frame.simple = frame.type != nullptr ? frame.type->simple.get() : declaration.simple.get();
+                frame.state  = frame.type != nullptr ? frame.type->start : 0;
+                frame.mode   = mode_strict;
+            } else if (frame.mode == mode_strict)
+                frame.mode = mode_lax;
+
+            mSeen.assign(frame.type != nullptr && frame.mode == mode_strict ? frame.type->attributes.size() : 0, 0);
+            mFrames.push_back(frame);
+
+            return true;
+        }
+
+        //! \brief Validate an attribute of the current element.
+        /*!
+         *  Namespace declarations, attributes of the \c xml namespace and
+         *  \c xsi attributes other than \c xsi:nil are ignored.
+         *
+         *  \param [in]  ns    The namespace of the attribute, in the schema table.
+         *  \param [in]  local The local name of the attribute.
+         *  \param [in]  value The value of the attribute.
+         *  \param [out] typed The typed value of the attribute, or \c nullptr.
+         *
+         *  \return \c false if the validation stops.
+         */
+        bool attribute(namespace_id_t ns, const view_t& local, const view_t& value, typed_value* typed = nullptr)
+        {
+            frame_t& frame = mFrames.back();
+
+            if (typed != nullptr)
+                *typed = typed_value();
+
+            if (frame.mode != mode_strict || ns == table_t::xmlns_namespace || ns == table_t::xml_namespace)
+                return true;
+
+            if (ns == mSchema.mXsi) {
+                if (!local.equals("nil"))
+                    return true;
+
+                frame.nil = value.equals("true") || value.equals("1");
+
+                return frame.decl->nillable || (!frame.nil && value.equals("false")) || value.equals("0") ||
+                       report(schema_t::invalid_attribute_value, frame, local);
+            }
+
+            const std::vector<typename schema_t::attribute_use_t>* uses = frame.type != nullptr ? &frame.type->attributes : nullptr;
+
+            for (size_t i = 0; uses != nullptr && i != uses->size(); ++i) {
+                const typename schema_t::attribute_use_t& use = (*uses)[i];
+
+                if (use.name.ns != ns || use.name.local != local)
+                    continue;
+
+                mSeen[i] = 1;
+
+                if ((use.fixed && value != view_t(use.value)) || !use.type->check(value, mScratch, typed))
+                    return report(schema_t::invalid_attribute_value, frame, local);
+
+                return true;
+            }
+
+            if (frame.type != nullptr && frame.type->wildcard != schema_t::npos &&
+                mSchema.mWildcards[frame.type->wildcard].allows(ns, mSchema.mTarget))
+                return true;
+
+            return report(schema_t::undeclared_attribute, frame, local);
+        }
+
+        //! \brief End the attributes of the current element.
+        /*!
+         *  \return \c false if the validation stops.
+         */
+        bool end_attributes()
+        {
+            const frame_t& frame = mFrames.back();
+
+            for (size_t i = 0; i != mSeen.size(); ++i)
+                if (!mSeen[i] && frame.type->attributes[i].required &&
+                    !report(schema_t::missing_attribute, frame, frame.type->attributes[i].name.local))
+                    return false;
+
+            return true;
+        }
+
+        //! \brief Validate text in the current element.
+        /*!
+         *  The text of an element with simple content is gathered until
+         *  the end of the element. When it is given in a single piece,
+         *  its typed value is set at the end of the element.
+         *
+         *  \param [in]  data  The decoded text.
+         *  \param [out] typed The typed value of the text, or \c nullptr.
+         *
+         *  \return \c false if the validation stops.
+         */
+        bool text(const view_t& data, typed_value* typed = nullptr)
+        {
+            frame_t& frame = mFrames.back();
+
+            if (typed != nullptr)
+                *typed = typed_value();
+
+            if (frame.mode != mode_strict)
+                return true;
+
+            if (frame.simple != nullptr && !frame.nil) {
+                frame.typed = mText.size() == frame.text ? typed : nullptr;
+                mText.append(data.begin(), data.end());
+
+                return true;
+            }
+
+            if ((frame.type != nullptr && frame.type->mixed && !frame.nil) || scanner_t::all_whitespace(data.begin(), data.end()))
+                return true;
+
+            return failContent(frame);
+        }
+
+        //! \brief End the current element.
+        /*!
+         *  \return \c false if the validation stops.
+         */
+        bool end_element()
+        {
+            const frame_t frame = mFrames.back();
+            bool          valid = true;
+
+            mFrames.pop_back();
+
+            if (frame.mode == mode_strict && !frame.nil && !frame.failed) {
+                if (frame.simple != nullptr && !frame.children) {
+                    view_t value(mText.data() + frame.text, mText.size() - frame.text);
+
+                    if (value.empty() && frame.decl->preset)
+                        value = view_t(frame.decl->value);
+
+                    if ((frame.decl->fixed && value != view_t(frame.decl->value)) || !frame.simple->check(value, mScratch, frame.typed))
+                        valid = report(schema_t::invalid_value, frame);
+                } else if (frame.type != nullptr && frame.type->content == schema_t::content_children) {
+                    if (!mSchema.mStates[frame.state].accepting)
+                        valid = report(schema_t::invalid_content, frame);
+                } else if (frame.type != nullptr && frame.type->content == schema_t::content_all && (frame.seen != 0 || !frame.type->optional)) {
+                    for (size_t i = 0; i != frame.type->all.size(); ++i)
+                        if (frame.type->all[i].required && (frame.seen & (uint64_t(1) << i)) == 0) {
+                            valid = report(schema_t::invalid_content, frame);
+                            break;
+                        }
+                }
+            }
+
+            mText.resize(frame.text);
+
+            return valid;
+        }
+
+        //! \brief Whether no error has been found.
+        bool valid() const { return mValid; }
+
+    private:
+        //! The validation modes of elements.
+        enum mode_t {
+            mode_strict, //!< The element is declared, and validated.
+            mode_lax,    //!< The element is not declared : its declared descendants are validated.
+            mode_skip    //!< The element and its descendants are not validated.
+        };
+
+        //! \brief An open element.
+        class frame_t {
+        public:
+            const typename schema_t::element_decl_t* decl;     //!< The declaration of the element, if any.
+            const typename schema_t::complex_type_t* type;     //!< Its complex type, if any.
+            const simple_type_t*                     simple;   //!< The type of its text, if its content is simple.
+            const element_t*                         element;  //!< The element, reported in violations.
+            size_t                                   offset;   //!< The index of the element, reported in violations.
+            uint32_t                                 state;    //!< The state of the automaton of its children.
+            uint64_t                                 seen;     //!< The children of an \c all group found.
+            size_t                                   text;     //!< The offset of its text in the text buffer.
+            typed_value*                             typed;    //!< The typed value of its only text, or \c nullptr.
+            mode_t                                   mode;     //!< How the element is validated.
+            bool                                     nil;      //!< Whether the element is nil.
+            bool                                     children; //!< Whether the element has child elements.
+            bool                                     failed;   //!< Whether an error has been found in its content.
+        };
+
+        //! \brief Record a validity error.
+        /*!
+         *  \return \c true if the validation goes on.
+         */
+        bool report(error_t code, const frame_t& frame, const view_t& name = view_t())
+        {
+            mValid = false;
+
+            if (mViolations == nullptr)
+                return false;
+
+            mViolations->push_back(typename schema_t::violation_t { code, frame.element, frame.offset, name });
+
+            return true;
+        }
+
+        //! \brief Record an error in the content of an element, once.
+        bool failContent(frame_t& frame)
+        {
+            if (frame.failed)
+                return true;
+
+            frame.failed = true;
+
+            return report(schema_t::invalid_content, frame);
+        }
+
+        //! \brief Find the declaration of a child of a validated element.
+        /*!
+         *  \param [in,out] parent The parent frame.
+         *  \param [in]     symbol The symbol of the child.
+         *  \param [in]     ns     The namespace of the child.
+         *  \param [out]    decl   The declaration of the child, or \c npos.
+         *  \param [in,out] frame  The frame of the child, whose mode is set
+         *                         if it is not declared.
+         */
+        bool child(frame_t& parent, typename schema_t::symbol_t symbol, namespace_id_t ns, uint32_t& decl, frame_t& frame)
+        {
+            const typename schema_t::complex_type_t* type = parent.type;
+
+            if (parent.nil || type == nullptr || type->content == schema_t::content_empty || type->content == schema_t::content_simple) {
+                frame.mode = mode_skip;
+
+                return failContent(parent);
+            }
+
+            if (type->content == schema_t::content_all) {
+                for (size_t i = 0; i != type->all.size(); ++i)
+                    if (type->all[i].symbol == symbol && (parent.seen & (uint64_t(1) << i)) == 0) {
+                        parent.seen |= uint64_t(1) << i;
+                        decl = type->all[i].decl;
+
+                        return true;
+                    }
+            } else {
+                const typename schema_t::transition_t* transition = mSchema.advance(parent.state, symbol, ns);
+
+                if (transition != nullptr && (transition->symbol & schema_t::wildcard_symbol) == 0) {
+                    decl = transition->decl;
+
+                    return true;
+                }
+
+                if (transition != nullptr) {
+                    const typename schema_t::process_t process = mSchema.mWildcards[transition->decl].process;
+
+                    decl = process == schema_t::process_skip ? schema_t::npos : mSchema.global(symbol);
+
+                    if (process == schema_t::process_skip)
+                        frame.mode = mode_skip;
+                    else if (decl == schema_t::npos && process == schema_t::process_strict && !report(schema_t::undeclared_element, frame))
+                        return false;
+
+                    return true;
+                }
+            }
+
+            decl = mSchema.global(symbol);
+
+            if (decl == schema_t::npos)
+                frame.mode = mode_skip;
+
+            return failContent(parent);
+        }
+
+        const schema_t& mSchema;     //!< The compiled schema.
+        violations_t*   mViolations; //!< The list of errors, or \c nullptr.
+
+        std::vector<frame_t>                   mFrames;  //!< The open elements, innermost last.
+        std::vector<char>                      mSeen;    //!< The attribute uses found on the current element.
+        string_t                               mText;    //!< The text of the open elements with simple content.
+        typename simple_type_t::scratch_t      mScratch; //!< The working memory of the simple types.
+        bool                                   mValid;   //!< Whether no error has been found.
+    };
+
+    typedef basic_compiled_schema<char>    compiled_schema;  //!< A specialized \c basic_compiled_schema for char.
+    typedef basic_compiled_schema<wchar_t> wcompiled_schema; //!< A specialized \c basic_compiled_schema for wchar_t.
+
+    typedef basic_schema_validator<char>    schema_validator;  //!< A specialized \c basic_schema_validator for char.
+    typedef basic_schema_validator<wchar_t> wschema_validator; //!< A specialized \c basic_schema_validator for wchar_t.
+}
+
+#endif /* SCHEMA_H_INCLUDED */
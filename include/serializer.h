@@ -0,0 +1,427 @@
+#ifndef SERIALIZER_H_INCLUDED
+#define SERIALIZER_H_INCLUDED
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include <utf8.h>
+#include <scanner.h>
+#include <string-view.h>
+#include <document.h>
+#include <element.h>
+#include <text.h>
+
+namespace xml {
+    //! \brief Writes XML trees to a stream.
+    /*!
+     *  The tree is walked iteratively, from each node to its first child,
+     *  its next sibling or the next sibling of its nearest ancestor that
+     *  has one, so that the depth of the tree does not use the call
+     *  stack. The markup is written into a buffer, that is written to the
+     *  stream in blocks of \c block_size characters. The buffer grows with
+     *  the output and keeps its capacity between blocks, so that writing a
+     *  small element only allocates what it needs. Texts and attribute
+     *  values are copied in runs between the characters to escape, which
+     *  are found by \c basic_scanner::find_escaped(). The tabs and line
+     *  breaks of attribute values, and the carriage returns of texts, are
+     *  written as character references, so that they survive the
+     *  normalization of a parser reading the output.
+     *
+     *  Elements without children are written as empty element tags. When
+     *  indenting, each element whose parent has no text is started on a
+     *  new line. Namespace declarations are attributes of the tree, and
+     *  are written as such. White spaces in attribute values are written
+     *  as is.
+     *
+     *  The wider character types can also be written to a byte stream :
+     *  each block is then converted to UTF-8 by \c utf8::encode() when it
+     *  is flushed. Blocks end between nodes, so that surrogate pairs are
+     *  never split.
+     *
+     *  \sa xml::operator<<(std::basic_ostream<charT>&, const basic_document<charT>&)
+     *
+     *  \tparam charT The type of character used in the tree.
+     *                By default, char and wchar_t are supported.
+     */
+    template <typename charT>
+    class basic_serializer {
+    public:
+        //! \name Member types
+        //!@{
+        typedef          basic_document<charT>        document_t;       //!< The document type.
+        typedef          basic_element<charT>         element_t;        //!< The element type.
+        typedef          basic_text<charT>            text_t;           //!< The text type.
+        typedef typename element_t::attribute_t       attribute_t;      //!< The attribute type.
+        typedef typename element_t::node_interface_t  node_interface_t; //!< The base type of nodes.
+        typedef typename element_t::child_t           child_t;          //!< The type of nodes that have a parent.
+        typedef          basic_scanner<charT>         scanner_t;        //!< The scanner finding the characters to escape.
+        typedef          basic_string_view<charT>     view_t;           //!< The type of names and values.
+        typedef typename view_t::string_t             string_t;         //!< The string type.
+        typedef          std::basic_ostream<charT>    stream_t;         //!< The output stream type.
+
+        //!@}
+
+        //! \brief The settings of the output.
+        class settings_t {
+        public:
+            bool indent;      //!< Whether to indent the elements.
+            bool declaration; //!< Whether to write the XML declaration of documents.
+        };
+
+        static const size_t block_size = 65536; //!< The number of characters written at once.
+
+        //! \brief Constructor.
+        /*!
+         *  \param [in] stream   The stream to write to.
+         *  \param [in] settings The output settings.
+         */
+        explicit basic_serializer(stream_t& stream, const settings_t& settings = settings_t { false, true })
+        :
+            mStream(&stream),
+            mBytes(nullptr),
+            mSettings(settings),
+            mBuffer(),
+            mEncoded(),
+            mMixed()
+        {
+        }
+
+        //! \brief Constructor writing UTF-8.
+        /*!
+         *  This constructor is only available for the wider character
+         *  types : with char, the characters are written as is.
+         *
+         *  \param [in] stream   The byte stream to write to.
+         *  \param [in] settings The output settings.
+         */
+        template <typename byteT, typename = typename std::enable_if<std::is_same<byteT, char>::value && !std::is_same<charT, char>::value>::type>
+        explicit basic_serializer(std::basic_ostream<byteT>& stream, const settings_t& settings = settings_t { false, true })
+        :
+            mStream(nullptr),
+            mBytes(&stream),
+            mSettings(settings),
+            mBuffer(),
+            mEncoded(),
+            mMixed()
+        {
+        }
+
+        basic_serializer(const basic_serializer&) = delete;
+        basic_serializer& operator=(const basic_serializer&) = delete;
+
+        //! \brief Destructor.
+        /*!
+         *  Writes the buffered characters.
+         */
+        ~basic_serializer()
+        {
+            flush();
+        }
+
+        //! \brief Write a document.
+        /*!
+         *  The XML declaration holds the version, encoding and standalone
+         *  status of the document.
+         *
+         *  \param [in] document The document.
+         */
+        void write(const document_t& document)
+        {
+            if (mSettings.declaration) {
+                put("<?xml version=\"");
+                number(document.version().major);
+                mBuffer.push_back('.');
+                number(document.version().minor);
+                mBuffer.push_back('"');
+
+                if (document.encoding().value == document_t::encoding_t::UTF8)
+                    put(" encoding=\"UTF-8\"");
+
+                if (document.standalone().value != document_t::standalone_t::undefined)
+                    put(document.standalone().value == document_t::standalone_t::yes ? " standalone=\"yes\"" : " standalone=\"no\"");
+
+                put(mSettings.indent ? "?>\n" : "?>");
+            }
+
+            write(document.root());
+        }
+
+        //! \brief Write an element and its descendants.
+        /*!
+         *  \param [in] root The element.
+         */
+        void write(const element_t& root)
+        {
+            const child_t* child = &root;
+
+            mMixed.clear();
+
+            for (;;) {
+                if (child->kind() == node_interface_t::element_kind) {
+                    const element_t& element = static_cast<const element_t&>(*child);
+
+                    start(element);
+
+                    if (!element.empty()) {
+                        mMixed.push_back(mixed(element));
+                        child = &element.front();
+                        continue;
+                    }
+
+                    put("/>");
+                } else if (child->kind() == node_interface_t::text_kind) {
+                    escape(static_cast<const text_t&>(*child).data().view(), false);
+                }
+
+                check();
+
+                while (child != &root && child->next_sibling() == nullptr) {
+                    const element_t& parent = static_cast<const element_t&>(child->parent());
+
+                    end(parent);
+                    child = &parent;
+                }
+
+                if (child == &root)
+                    break;
+
+                child = child->next_sibling();
+            }
+        }
+
+        //! \brief Write the buffered characters to the stream.
+        void flush()
+        {
+            if (mBuffer.empty())
+                return;
+
+            if (mStream != nullptr) {
+                mStream->write(mBuffer.data(), static_cast<std::streamsize>(mBuffer.size()));
+            } else {
+                mEncoded.resize(mBuffer.size() * (sizeof(charT) == 2 ? 3 : 4));
+
+                const char* last = utf8::encode(mBuffer.data(), mBuffer.data() + mBuffer.size(), &mEncoded[0]);
+
+                mBytes->write(mEncoded.data(), static_cast<std::streamsize>(last - mEncoded.data()));
+            }
+
+            mBuffer.clear();
+        }
+
+    private:
+        //! \brief Whether an element has texts.
+        static bool mixed(const element_t& element)
+        {
+            for (const child_t* it = &element.front(); it != nullptr; it = it->next_sibling())
+                if (it->kind() == node_interface_t::text_kind)
+                    return true;
+
+            return false;
+        }
+
+        //! \brief Write a start tag, left open.
+        void start(const element_t& element)
+        {
+            if (mSettings.indent && !mMixed.empty() && !mMixed.back())
+                newline(mMixed.size());
+
+            mBuffer.push_back('<');
+            append(element.name().view());
+
+            for (const attribute_t& attribute : element.attributes()) {
+                mBuffer.push_back(' ');
+                append(attribute.name().view());
+                put("=\"");
+                escape(attribute.value().view(), true);
+                mBuffer.push_back('"');
+            }
+
+            if (!element.empty())
+                mBuffer.push_back('>');
+        }
+
+        //! \brief Write the end tag of an element that has children.
+        void end(const element_t& element)
+        {
+            const bool mixed = mMixed.back();
+
+            mMixed.pop_back();
+
+            if (mSettings.indent && !mixed)
+                newline(mMixed.size());
+
+            put("</");
+            append(element.name().view());
+            mBuffer.push_back('>');
+            check();
+        }
+
+        //! \brief Start a new line, indented by two spaces per level.
+        void newline(size_t level)
+        {
+            mBuffer.push_back('\n');
+            mBuffer.append(2 * level, charT(' '));
+        }
+
+        //! \brief Append characters to the buffer.
+        void append(const view_t& value)
+        {
+            mBuffer.append(value.begin(), value.end());
+        }
+
+        //! \brief Append an ASCII string to the buffer.
+        void put(const char* str)
+        {
+            while (*str != '\0')
+                mBuffer.push_back(static_cast<charT>(*str++));
+        }
+
+        //! \brief Append the decimal digits of a number to the buffer.
+        void number(unsigned value)
+        {
+            if (value >= 10)
+                number(value / 10);
+
+            mBuffer.push_back(static_cast<charT>('0' + value % 10));
+        }
+
+        //! \brief Append escaped characters to the buffer.
+        /*!
+         *  \param [in] value     The characters.
+         *  \param [in] attribute Whether \c value is an attribute value, in
+         *                        which quotes and white spaces are escaped.
+         */
+        void escape(const view_t& value, bool attribute)
+        {
+            const charT* first = value.begin();
+            const charT* last  = value.end();
+
+            for (;;) {
+                const charT* found = scanner_t::find_escaped(first, last);
+
+                mBuffer.append(first, found);
+
+                if (found == last)
+                    return;
+
+                switch (*found) {
+                case '&': put("&amp;"); break;
+                case '<': put("&lt;"); break;
+                case '>': put("&gt;"); break;
+                case '"': put(attribute ? "&quot;" : "\""); break;
+                case '\t': attribute ? put("&#9;") : mBuffer.push_back(*found); break;
+                case '\n': attribute ? put("&#10;") : mBuffer.push_back(*found); break;
+                case '\r': put("&#13;"); break;
+                default: mBuffer.push_back(*found); break;
+                }
+
+                first = found + 1;
+            }
+        }
+
+        //! \brief Write the buffer to the stream if it holds a block.
+        void check()
+        {
+            if (mBuffer.size() >= block_size)
+                flush();
+        }
+
+        stream_t*         mStream;   //!< The output stream, or \c nullptr when writing UTF-8.
+        std::ostream*     mBytes;    //!< The byte stream, or \c nullptr.
+        settings_t        mSettings; //!< The output settings.
+        string_t          mBuffer;   //!< The characters not written yet.
+        std::string       mEncoded;  //!< The UTF-8 bytes of the last block written to \c mBytes.
+        std::vector<bool> mMixed;    //!< Whether each open element has texts.
+    };
+
+    //! \brief Write a document to a stream, without indentation.
+    /*!
+     *  \param [in] os       The stream to write to.
+     *  \param [in] document The document to write.
+     *
+     *  \return \c os.
+     *
+     *  \sa xml::basic_serializer
+     */
+    template <typename charT>
+    std::basic_ostream<charT>& operator<<(std::basic_ostream<charT>& os, const basic_document<charT>& document)
+    {
+        basic_serializer<charT> serializer(os);
+
+        serializer.write(document);
+        serializer.flush();
+
+        return os;
+    }
+
+    //! \brief Write an element and its descendants to a stream, without indentation.
+    /*!
+     *  \param [in] os      The stream to write to.
+     *  \param [in] element The element to write.
+     *
+     *  \return \c os.
+     *
+     *  \sa xml::basic_serializer
+     */
+    template <typename charT>
+    std::basic_ostream<charT>& operator<<(std::basic_ostream<charT>& os, const basic_element<charT>& element)
+    {
+        basic_serializer<charT> serializer(os);
+
+        serializer.write(element);
+        serializer.flush();
+
+        return os;
+    }
+
+    //! \brief Write a document of a wide character type to a byte stream, in UTF-8.
+    /*!
+     *  \param [in] os       The stream to write to.
+     *  \param [in] document The document to write.
+     *
+     *  \return \c os.
+     *
+     *  \sa xml::basic_serializer
+     */
+    template <typename charT>
+    typename std::enable_if<!std::is_same<charT, char>::value, std::ostream&>::type
+    operator<<(std::ostream& os, const basic_document<charT>& document)
+    {
+        basic_serializer<charT> serializer(os);
+
+        serializer.write(document);
+        serializer.flush();
+
+        return os;
+    }
+
+    //! \brief Write an element of a wide character type and its descendants to a byte stream, in UTF-8.
+    /*!
+     *  \param [in] os      The stream to write to.
+     *  \param [in] element The element to write.
+     *
+     *  \return \c os.
+     *
+     *  \sa xml::basic_serializer
+     */
+    template <typename charT>
+    typename std::enable_if<!std::is_same<charT, char>::value, std::ostream&>::type
+    operator<<(std::ostream& os, const basic_element<charT>& element)
+    {
+        basic_serializer<charT> serializer(os);
+
+        serializer.write(element);
+        serializer.flush();
+
+        return os;
+    }
+
+    typedef basic_serializer<char>    serializer;  //!< A specialized \c basic_serializer for char.
+    typedef basic_serializer<wchar_t> wserializer; //!< A specialized \c basic_serializer for wchar_t.
+}
+
+#endif /* SERIALIZER_H_INCLUDED */
@@ -0,0 +1,1249 @@
+#ifndef SIMPLE_TYPE_H_INCLUDED
+#define SIMPLE_TYPE_H_INCLUDED
+
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <unordered_map>
+
+#include <reader.h>
+#include <pattern.h>
+#include <typed-value.h>
+
+namespace xml {
+    //! \brief A XML Schema simple type, with precompiled facets.
+    /*!
+     *  This class checks the values of attributes and of elements with
+     *  simple content against a simple type : a built-in type of XML
+     *  Schema, or a type derived from one by restriction, list or union.
+     *  The facets of a type are compiled once, when the type is built :
+     *  numeric bounds are parsed, patterns are compiled into
+     *  \c basic_pattern, and the restrictions of all the ancestors are
+     *  merged, so that checking a value reads it once, normalizes its
+     *  white spaces, checks its lexical form and then the merged facets.
+     *
+     *  Numeric values and bounds are compared as \c long double. The
+     *  prefixes of \c QName values are not resolved, and the bounds of
+     *  dates, times and durations are not supported.
+     *
+     *  Built types are immutable and shared through \c std::shared_ptr :
+     *  a type can be checked by several threads, each with its own
+     *  \c scratch_t.
+     *
+     *  \sa xml::basic_pattern
+     *
+     *  \tparam charT The type of character used in the values.
+     *                By default, char and wchar_t are supported.
+     */
+    template <typename charT>
+    class basic_simple_type {
+    public:
+        //! \name Member types
+        //!@{
+        typedef          basic_reader<charT>       reader_t;        //!< The reader type.
+        typedef typename reader_t::scanner_t       scanner_t;       //!< The scanner type.
+        typedef typename reader_t::view_t          view_t;          //!< The type of values.
+        typedef typename reader_t::const_pointer_t const_pointer_t; //!< Pointer to a constant character.
+        typedef          std::basic_string<charT>  string_t;        //!< The string type.
+        typedef          basic_pattern<charT>      pattern_t;       //!< The type of compiled patterns.
+
+        typedef basic_simple_type<charT>             type_t;         //!< The simple type type.
+        typedef std::shared_ptr<const type_t>        type_pointer_t; //!< A shared pointer to a built type.
+
+        //!@}
+
+        //! \brief The working memory of a check.
+        /*!
+         *  Reusing the same scratch for successive checks avoids allocating
+         *  memory once it has grown.
+         */
+        class scratch_t {
+        public:
+            string_t                        text;   //!< The normalized value, when it differs from the checked one.
+            typename pattern_t::scratch_t   states; //!< The working memory of the patterns.
+        };
+
+        //! The varieties of simple types.
+        enum variety_t {
+            variety_atomic, //!< A single value.
+            variety_list,   //!< A list of values separated by white spaces.
+            variety_union   //!< A value of one of several types.
+        };
+
+        //! The primitive types, from which the atomic types are derived.
+        enum primitive_t {
+            primitive_any,          //!< \c anySimpleType : any value.
+            primitive_string,       //!< \c string and the types derived from it.
+            primitive_boolean,      //!< \c boolean.
+            primitive_decimal,      //!< \c decimal and the integer types.
+            primitive_float,        //!< \c float.
+            primitive_double,       //!< \c double.
+            primitive_duration,     //!< \c duration.
+            primitive_datetime,     //!< \c dateTime.
+            primitive_time,         //!< \c time.
+            primitive_date,         //!< \c date.
+            primitive_gyearmonth,   //!< \c gYearMonth.
+            primitive_gyear,        //!< \c gYear.
+            primitive_gmonthday,    //!< \c gMonthDay.
+            primitive_gday,         //!< \c gDay.
+            primitive_gmonth,       //!< \c gMonth.
+            primitive_hexbinary,    //!< \c hexBinary.
+            primitive_base64binary, //!< \c base64Binary.
+            primitive_anyuri,       //!< \c anyURI.
+            primitive_qname,        //!< \c QName.
+            primitive_notation      //!< \c NOTATION.
+        };
+
+        //! The white space normalizations.
+        enum whitespace_t {
+            whitespace_preserve, //!< Values are kept as is.
+            whitespace_replace,  //!< Tabulations, carriage returns and line feeds are replaced by spaces.
+            whitespace_collapse  //!< White spaces are replaced, then trimmed, and their runs are reduced to one space.
+        };
+
+        //! \brief Get a built-in type.
+        /*!
+         *  The built-in types are built once, the first time this function
+         *  is called.
+         *
+         *  \param [in] name The local name of the type in the XML Schema namespace.
+         *
+         *  \return The type, or an empty pointer if \c name is not a
+         *          built-in simple type.
+         */
+        static type_pointer_t builtin(const view_t& name)
+        {
+            static const builtins_t types = makeBuiltins();
+
+            std::string key;
+
+            for (charT c : name)
+                key.push_back(scanner_t::code(c) < 0x80 ? static_cast<char>(c) : '?');
+
+            typename builtins_t::const_iterator it = types.find(key);
+
+            return it != types.end() ? it->second : type_pointer_t();
+        }
+
+        //! \brief Build a list type.
+        /*!
+         *  \param [in] item The type of the items.
+         *
+         *  \return The list type.
+         */
+        static type_pointer_t list_of(const type_pointer_t& item)
+        {
+            std::shared_ptr<type_t> type(new type_t(variety_list, primitive_any, whitespace_collapse));
+
+            type->mMembers.push_back(item);
+
+            return type;
+        }
+
+        //! \brief Build a union type.
+        /*!
+         *  \param [in] members The member types, tried in order.
+         *
+         *  \return The union type.
+         */
+        static type_pointer_t union_of(std::vector<type_pointer_t> members)
+        {
+            std::shared_ptr<type_t> type(new type_t(variety_union, primitive_any, whitespace_collapse));
+
+            type->mMembers = std::move(members);
+
+            return type;
+        }
+
+        //! \brief Add a facet to a type being derived by restriction.
+        /*!
+         *  The facets \c length, \c minLength, \c maxLength,
+         *  \c minInclusive, \c minExclusive, \c maxInclusive,
+         *  \c maxExclusive, \c totalDigits, \c fractionDigits and
+         *  \c whiteSpace are added with this function. A facet given again
+         *  replaces the inherited one.
+         *
+         *  \param [in] facet The local name of the facet.
+         *  \param [in] value The value of the facet.
+         *
+         *  \return \c nullptr, or a description of the error if the facet
+         *          is unknown, does not apply to the type, or has an
+         *          invalid value.
+         */
+        const char* add_facet(const view_t& facet, const view_t& value)
+        {
+            if (facet.equals("whiteSpace")) {
+                if (value.equals("preserve"))
+                    mWhitespace = whitespace_preserve;
+                else if (value.equals("replace"))
+                    mWhitespace = whitespace_replace;
+                else if (value.equals("collapse"))
+                    mWhitespace = whitespace_collapse;
+                else
+                    return "invalid whiteSpace facet";
+
+                return nullptr;
+            }
+
+            if (facet.equals("length") || facet.equals("minLength") || facet.equals("maxLength")) {
+                size_t length;
+
+                if (!hasLength())
+                    return "length facet on a type without length";
+
+                if (!readCount(value, length))
+                    return "invalid length facet";
+
+                if (facet.equals("length"))
+                    mMinLength = mMaxLength = length;
+                else if (facet.equals("minLength"))
+                    mMinLength = length;
+                else
+                    mMaxLength = length;
+
+                return nullptr;
+            }
+
+            if (facet.equals("totalDigits") || facet.equals("fractionDigits")) {
+                size_t digits;
+
+                if (mVariety != variety_atomic || mPrimitive != primitive_decimal)
+                    return "digits facet on a type that is not decimal";
+
+                if (!readCount(value, digits))
+                    return "invalid digits facet";
+
+                (facet.equals("totalDigits") ? mTotalDigits : mFractionDigits) = digits;
+
+                return nullptr;
+            }
+
+            const bool min = facet.equals("minInclusive") || facet.equals("minExclusive");
+            const bool max = facet.equals("maxInclusive") || facet.equals("maxExclusive");
+
+            if (!min && !max)
+                return "unsupported facet";
+
+            if (!isNumeric())
+                return "bound facet on a type that is not numeric";
+
+            scratch_t   scratch;
+            long double bound;
+            const view_t normalized = normalize(value, scratch);
+
+            if (!checkNumber(normalized, bound))
+                return "invalid bound facet";
+
+            const bool inclusive = facet.equals("minInclusive") || facet.equals("maxInclusive");
+
+            if (min) {
+                mMin          = bound;
+                mMinInclusive = inclusive;
+                mHasMin       = true;
+            } else {
+                mMax          = bound;
+                mMaxInclusive = inclusive;
+                mHasMax       = true;
+            }
+
+            return nullptr;
+        }
+
+        //! \brief Add the \c enumeration facets of a restriction step.
+        /*!
+         *  The values replace the inherited enumeration.
+         *
+         *  \param [in] values The enumerated values.
+         *
+         *  \return \c nullptr, or a description of the error if a value does
+         *          not belong to the type.
+         */
+        const char* add_enumeration(std::vector<string_t> values)
+        {
+            scratch_t scratch;
+
+            for (string_t& value : values) {
+                if (!check(value, scratch))
+                    return "invalid enumeration facet";
+
+                value = normalize(value, scratch).str();
+            }
+
+            mEnumeration    = std::move(values);
+            mHasEnumeration = true;
+
+            return nullptr;
+        }
+
+        //! \brief Add the \c pattern facets of a restriction step.
+        /*!
+         *  The patterns of a step are alternatives : they are compiled into
+         *  one pattern, which values must match on top of the inherited
+         *  patterns.
+         *
+         *  \param [in] expressions The regular expressions.
+         *
+         *  \return \c nullptr, or a description of the error if an
+         *          expression is malformed.
+         */
+        const char* add_pattern(const std::vector<view_t>& expressions)
+        {
+            string_t alternatives;
+
+            for (const view_t& expression : expressions) {
+                if (!alternatives.empty())
+                    alternatives.push_back('|');
+
+                alternatives.push_back('(');
+                alternatives.append(expression.begin(), expression.end());
+                alternatives.push_back(')');
+            }
+
+            typename pattern_t::result_t result = pattern_t::try_compile(alternatives);
+
+            if (!result)
+                return "invalid pattern facet";
+
+            mPatterns.push_back(std::move(result.value()));
+
+            return nullptr;
+        }
+
+        //! \brief Check a value.
+        /*!
+         *  The value of an atomic type is converted to \c typed when it
+         *  belongs to the type, from the number or the fields read by the
+         *  check ; the value of a union takes the type of the member it
+         *  matches, and lists are \c untyped.
+         *
+         *  \param [in]     value   The value, before white space normalization.
+         *  \param [in,out] scratch The working memory.
+         *  \param [out]    typed   The converted value, or \c nullptr.
+         *
+         *  \return \c true if the value belongs to the type.
+         */
+        bool check(const view_t& value, scratch_t& scratch, typed_value* typed = nullptr) const
+        {
+            if (typed != nullptr)
+                *typed = typed_value();
+
+            if (mVariety == variety_union) {
+                typed_value converted;
+                bool        matched = false;
+
+                for (const type_pointer_t& member : mMembers)
+                    if (member->check(value, scratch, typed != nullptr ? &converted : nullptr)) {
+                        matched = true;
+                        break;
+                    }
+
+                if (!matched || !checkFacets(normalize(value, scratch), 0, scratch))
+                    return false;
+
+                if (typed != nullptr)
+                    *typed = converted;
+
+                return true;
+            }
+
+            const view_t normalized = normalize(value, scratch);
+            long double  number     = 0;
+
+            if (mVariety == variety_list) {
+                const type_t&   item  = *mMembers[0];
+                const_pointer_t first = normalized.begin();
+                const_pointer_t last  = normalized.end();
+                size_t          count = 0;
+
+                while (first != last) {
+                    const_pointer_t end = first;
+
+                    while (end != last && *end != ' ')
+                        ++end;
+
+                    if (!item.check(view_t(first, end), scratch))
+                        return false;
+
+                    ++count;
+                    first = end == last ? end : end + 1;
+                }
+
+                return checkFacets(normalized, count, scratch);
+            }
+
+            if (!checkLexical(normalized, number))
+                return false;
+
+            if (mHasMin && (number < mMin || (!mMinInclusive && number == mMin)))
+                return false;
+
+            if (mHasMax && (number > mMax || (!mMaxInclusive && number == mMax)))
+                return false;
+
+            if (mHasEnumeration && isNumeric()) {
+                bool found = false;
+
+                for (const string_t& enumerated : mEnumeration) {
+                    long double other;
+
+                    if (checkNumber(enumerated, other) && other == number) {
+                        found = true;
+                        break;
+                    }
+                }
+
+                if (!found)
+                    return false;
+            }
+
+            if (!checkFacets(normalized, hasLength() ? length(normalized) : 0, scratch))
+                return false;
+
+            if (typed != nullptr)
+                *typed = convert(normalized, number);
+
+            return true;
+        }
+
+        //! \brief Check a value.
+        /*!
+         *  This overload allocates its working memory.
+         *
+         *  \param [in] value The value, before white space normalization.
+         *
+         *  \return \c true if the value belongs to the type.
+         */
+        bool check(const view_t& value) const
+        {
+            scratch_t scratch;
+
+            return check(value, scratch);
+        }
+
+        //! \brief Get the variety of the type.
+        variety_t variety() const { return mVariety; }
+
+        //! \brief Get the primitive type of an atomic type.
+        primitive_t primitive() const { return mPrimitive; }
+
+        //! \brief Get the white space normalization of the type.
+        whitespace_t whitespace() const { return mWhitespace; }
+
+    private:
+        //! The lexical constraints of the built-in types derived from \c string.
+        enum lexical_t {
+            lexical_none,     //!< No constraint.
+            lexical_language, //!< A language tag.
+            lexical_name,     //!< A XML name.
+            lexical_ncname,   //!< A XML name without colon.
+            lexical_nmtoken,  //!< A XML name token.
+            lexical_integer   //!< A decimal without fraction.
+        };
+
+        typedef std::unordered_map<std::string, type_pointer_t> builtins_t; //!< The type of the built-in type table.
+
+        //! \brief Constructor.
+        basic_simple_type(variety_t variety, primitive_t primitive, whitespace_t whitespace, lexical_t lexical = lexical_none)
+        :
+            mVariety(variety),
+            mPrimitive(primitive),
+            mWhitespace(whitespace),
+            mLexical(lexical),
+            mMembers(),
+            mMinLength(0),
+            mMaxLength(size_t(-1)),
+            mTotalDigits(size_t(-1)),
+            mFractionDigits(size_t(-1)),
+            mMin(0),
+            mMax(0),
+            mHasMin(false),
+            mHasMax(false),
+            mMinInclusive(true),
+            mMaxInclusive(true),
+            mHasEnumeration(false),
+            mEnumeration(),
+            mPatterns()
+        {}
+
+        //! \brief Build the table of built-in types.
+        static builtins_t makeBuiltins()
+        {
+            builtins_t types;
+
+            const struct { const char* name; primitive_t primitive; } primitives[] = {
+                { "anySimpleType", primitive_any }, { "string", primitive_string }, { "boolean", primitive_boolean },
+                { "decimal", primitive_decimal }, { "float", primitive_float }, { "double", primitive_double },
+                { "duration", primitive_duration }, { "dateTime", primitive_datetime }, { "time", primitive_time },
+                { "date", primitive_date }, { "gYearMonth", primitive_gyearmonth }, { "gYear", primitive_gyear },
+                { "gMonthDay", primitive_gmonthday }, { "gDay", primitive_gday }, { "gMonth", primitive_gmonth },
+                { "hexBinary", primitive_hexbinary }, { "base64Binary", primitive_base64binary },
+                { "anyURI", primitive_anyuri }, { "QName", primitive_qname }, { "NOTATION", primitive_notation }
+            };
+
+            for (const auto& primitive : primitives)
+                types[primitive.name] = type_pointer_t(new type_t(variety_atomic, primitive.primitive,
+                    primitive.primitive == primitive_string || primitive.primitive == primitive_any ?
+                    whitespace_preserve : whitespace_collapse));
+
+            types["normalizedString"] = type_pointer_t(new type_t(variety_atomic, primitive_string, whitespace_replace));
+            types["token"]            = type_pointer_t(new type_t(variety_atomic, primitive_string, whitespace_collapse));
+
+            const struct { const char* name; lexical_t lexical; } tokens[] = {
+                { "language", lexical_language }, { "Name", lexical_name }, { "NCName", lexical_ncname },
+                { "ID", lexical_ncname }, { "IDREF", lexical_ncname }, { "ENTITY", lexical_ncname },
+                { "NMTOKEN", lexical_nmtoken }
+            };
+
+            for (const auto& token : tokens)
+                types[token.name] = type_pointer_t(new type_t(variety_atomic, primitive_string, whitespace_collapse, token.lexical));
+
+            const struct { const char* name; const char* item; } lists[] = {
+                { "NMTOKENS", "NMTOKEN" }, { "IDREFS", "IDREF" }, { "ENTITIES", "ENTITY" }
+            };
+
+            for (const auto& list : lists) {
+                std::shared_ptr<type_t> type(new type_t(variety_list, primitive_any, whitespace_collapse));
+
+                type->mMembers.push_back(types[list.item]);
+                type->mMinLength = 1;
+                types[list.name] = type;
+            }
+
+            const long double two63 = std::ldexp(1.0L, 63);
+            const long double two64 = std::ldexp(1.0L, 64);
+
+            const struct { const char* name; bool min; long double lower; bool max; long double upper; } integers[] = {
+                { "integer",            false, 0,          false, 0 },
+                { "nonPositiveInteger", false, 0,          true,  0 },
+                { "negativeInteger",    false, 0,          true,  -1 },
+                { "long",               true,  -two63,     true,  two63 - 1 },
+                { "int",                true,  -2147483648.0L, true, 2147483647.0L },
+                { "short",              true,  -32768,     true,  32767 },
+                { "byte",               true,  -128,       true,  127 },
+                { "nonNegativeInteger", true,  0,          false, 0 },
+                { "unsignedLong",       true,  0,          true,  two64 - 1 },
+                { "unsignedInt",        true,  0,          true,  4294967295.0L },
+                { "unsignedShort",      true,  0,          true,  65535 },
+                { "unsignedByte",       true,  0,          true,  255 },
+                { "positiveInteger",    true,  1,          false, 0 }
+            };
+
+            for (const auto& integer : integers) {
+                std::shared_ptr<type_t> type(new type_t(variety_atomic, primitive_decimal, whitespace_collapse, lexical_integer));
+
+                type->mHasMin = integer.min;
+                type->mMin    = integer.lower;
+                type->mHasMax = integer.max;
+                type->mMax    = integer.upper;
+                type->mFractionDigits = 0;
+                types[integer.name] = type;
+            }
+
+            return types;
+        }
+
+        //! \brief Whether the type is compared by numeric value.
+        bool isNumeric() const
+        {
+            return mVariety == variety_atomic &&
+                   (mPrimitive == primitive_decimal || mPrimitive == primitive_float || mPrimitive == primitive_double);
+        }
+
+        //! \brief Whether the length facets apply to the type.
+        bool hasLength() const
+        {
+            return mVariety == variety_list ||
+                   (mVariety == variety_atomic && (mPrimitive == primitive_string || mPrimitive == primitive_hexbinary ||
+                    mPrimitive == primitive_base64binary || mPrimitive == primitive_anyuri ||
+                    mPrimitive == primitive_qname || mPrimitive == primitive_notation));
+        }
+
+        //! \brief Read a non-negative facet value.
+        static bool readCount(const view_t& value, size_t& count)
+        {
+            const_pointer_t first = scanner_t::skip_whitespace(value.begin(), value.end());
+            const_pointer_t last  = value.end();
+
+            while (last != first && scanner_t::is_whitespace(last[-1]))
+                --last;
+
+            if (first == last)
+                return false;
+
+            count = 0;
+
+            for (; first != last; ++first) {
+                if (*first < '0' || *first > '9')
+                    return false;
+
+                count = count * 10 + (*first - '0');
+            }
+
+            return true;
+        }
+
+        //! \brief Normalize the white spaces of a value.
+        /*!
+         *  The value is copied into the scratch only if normalizing it
+         *  changes more than its ends.
+         *
+         *  \return The normalized value.
+         */
+        view_t normalize(const view_t& value, scratch_t& scratch) const
+        {
+            if (mWhitespace == whitespace_preserve)
+                return value;
+
+            const_pointer_t first = value.begin();
+            const_pointer_t last  = value.end();
+
+            if (mWhitespace == whitespace_collapse) {
+                first = scanner_t::skip_whitespace(first, last);
+
+                while (last != first && scanner_t::is_whitespace(last[-1]))
+                    --last;
+            }
+
+            const_pointer_t it = first;
+
+            while (it != last && (*it == ' ' ? mWhitespace == whitespace_replace || it[1] != ' ' : !scanner_t::is_whitespace(*it)))
+                ++it;
+
+            if (it == last)
+                return view_t(first, last);
+
+            scratch.text.assign(first, it);
+
+            for (; it != last; ++it) {
+                if (!scanner_t::is_whitespace(*it))
+                    scratch.text.push_back(*it);
+                else if (mWhitespace == whitespace_replace || scratch.text.back() != ' ')
+                    scratch.text.push_back(' ');
+            }
+
+            return view_t(scratch.text);
+        }
+
+        //! \brief Check the facets shared by every variety.
+        /*!
+         *  \param [in]     value   The normalized value.
+         *  \param [in]     length  The length of the value, or its number of items.
+         *  \param [in,out] scratch The working memory.
+         */
+        bool checkFacets(const view_t& value, size_t length, scratch_t& scratch) const
+        {
+            if (length < mMinLength || length > mMaxLength)
+                return false;
+
+            if (mHasEnumeration && !isNumeric()) {
+                bool found = false;
+
+                for (const string_t& enumerated : mEnumeration)
+                    if (view_t(enumerated) == value) {
+                        found = true;
+                        break;
+                    }
+
+                if (!found)
+                    return false;
+            }
+
+            for (const pattern_t& pattern : mPatterns)
+                if (!pattern.matches(value, scratch.states))
+                    return false;
+
+            return true;
+        }
+
+        //! \brief Get the length of an atomic value.
+        /*!
+         *  \return The number of octets of binary values, and the number of
+         *          code points of other values.
+         */
+        size_t length(const view_t& value) const
+        {
+            if (mPrimitive == primitive_hexbinary)
+                return value.size() / 2;
+
+            if (mPrimitive == primitive_base64binary) {
+                size_t count = 0;
+                size_t padding = 0;
+
+                for (charT c : value)
+                    if (c == '=')
+                        ++padding;
+                    else if (c != ' ')
+                        ++count;
+
+                return (count + padding) / 4 * 3 - padding;
+            }
+
+            size_t count = 0;
+
+            for (charT c : value) {
+                const uint32_t u = scanner_t::code(c);
+
+                if (!(sizeof(charT) == 1 && (u & 0xC0) == 0x80) && !(sizeof(charT) == 2 && u >= 0xDC00 && u < 0xE000))
+                    ++count;
+            }
+
+            return count;
+        }
+
+        //! \brief Check the lexical form of an atomic value.
+        /*!
+         *  \param [in]  value  The normalized value.
+         *  \param [out] number The value of numeric types.
+         */
+        bool checkLexical(const view_t& value, long double& number) const
+        {
+            const_pointer_t first = value.begin();
+            const_pointer_t last  = value.end();
+
+            switch (mPrimitive) {
+            case primitive_any:
+            case primitive_anyuri:
+                return true;
+
+            case primitive_string:
+                switch (mLexical) {
+                case lexical_language: {
+                    size_t part    = 0;
+                    bool   primary = true;
+
+                    for (; first != last; ++first) {
+                        if (*first == '-') {
+                            if (part == 0)
+                                return false;
+
+                            part    = 0;
+                            primary = false;
+                        } else if (++part > 8 || !(isAlpha(*first) || (!primary && *first >= '0' && *first <= '9')))
+                            return false;
+                    }
+
+                    return part != 0;
+                }
+
+                case lexical_name:
+                    return first != last && scanner_t::is_name_start(*first) && isNameChars(first + 1, last, true);
+
+                case lexical_ncname:
+                    return isNCName(first, last);
+
+                case lexical_nmtoken:
+                    return first != last && isNameChars(first, last, true);
+
+                case lexical_none:
+                case lexical_integer:
+                    return true;
+                }
+
+                return true;
+
+            case primitive_boolean:
+                return value.equals("true") || value.equals("false") || value.equals("1") || value.equals("0");
+
+            case primitive_decimal:
+            case primitive_float:
+            case primitive_double:
+                return checkNumber(value, number);
+
+            case primitive_duration:
+                return checkDuration(first, last);
+
+            case primitive_datetime: {
+                const_pointer_t t = std::find(first, last, 'T');
+
+                return t != last && checkDate(first, t, true, true, true, false) && checkTime(t + 1, last, true);
+            }
+
+            case primitive_time:
+                return checkTime(first, last, true);
+
+            case primitive_date:
+                return checkDate(first, last, true, true, true, true);
+
+            case primitive_gyearmonth:
+                return checkDate(first, last, true, true, false, true);
+
+            case primitive_gyear:
+                return checkDate(first, last, true, false, false, true);
+
+            case primitive_gmonthday:
+                return readLiteral(first, last, "--") && checkDate(first, last, false, true, true, true);
+
+            case primitive_gday:
+                return readLiteral(first, last, "---") && checkDate(first, last, false, false, true, true);
+
+            case primitive_gmonth:
+                return readLiteral(first, last, "--") && checkDate(first, last, false, true, false, true);
+
+            case primitive_hexbinary:
+                if (value.size() % 2 != 0)
+                    return false;
+
+                for (; first != last; ++first)
+                    if (!isHex(*first))
+                        return false;
+
+                return true;
+
+            case primitive_base64binary: {
+                size_t count   = 0;
+                size_t padding = 0;
+
+                for (; first != last; ++first) {
+                    const charT c = *first;
+
+                    if (c == ' ')
+                        continue;
+
+                    if (c == '=')
+                        ++padding;
+                    else if (padding != 0 || !(isAlpha(c) || (c >= '0' && c <= '9') || c == '+' || c == '/'))
+                        return false;
+
+                    ++count;
+                }
+
+                return count % 4 == 0 && padding <= 2;
+            }
+
+            case primitive_qname:
+            case primitive_notation: {
+                const_pointer_t colon = std::find(first, last, ':');
+
+                return isNCName(first, colon) && (colon == last || isNCName(colon + 1, last));
+            }
+            }
+
+            return false;
+        }
+
+        //! \brief Convert a valid atomic value.
+        /*!
+         *  \param [in] value  The normalized value.
+         *  \param [in] number The value of numeric types.
+         */
+        typed_value convert(const view_t& value, long double number) const
+        {
+            switch (mPrimitive) {
+            case primitive_boolean:
+                return typed_value::from_boolean(value.equals("true") || value.equals("1"));
+
+            case primitive_decimal:
+                if (mLexical == lexical_integer && number >= -std::ldexp(1.0L, 63) && number < std::ldexp(1.0L, 63))
+                    return typed_value::from_integer(static_cast<int64_t>(number));
+
+                return typed_value::from_number(typed_value::decimal_type, static_cast<double>(number));
+
+            case primitive_float:
+                return typed_value::from_number(typed_value::float_type, static_cast<double>(static_cast<float>(number)));
+
+            case primitive_double:
+                return typed_value::from_number(typed_value::double_type, static_cast<double>(number));
+
+            case primitive_datetime:
+            case primitive_date:
+            case primitive_time:
+                return convertTime(value.begin(), value.end());
+
+            default:
+                return typed_value();
+            }
+        }
+
+        //! \brief Convert a valid \c dateTime, \c date or \c time value.
+        typed_value convertTime(const_pointer_t first, const_pointer_t last) const
+        {
+            int64_t  year     = 1970;
+            unsigned month    = 1;
+            unsigned day      = 1;
+            unsigned hour     = 0;
+            unsigned minute   = 0;
+            unsigned second   = 0;
+            int64_t  micro    = 0;
+            bool     timezone = false;
+            int      offset   = 0;
+
+            if (mPrimitive != primitive_time) {
+                const bool negative = *first == '-';
+
+                if (negative)
+                    ++first;
+
+                for (year = 0; *first != '-'; ++first)
+                    year = year * 10 + (*first - '0');
+
+                if (negative)
+                    year = -year;
+
+                readDigits(++first, last, 2, month);
+                readDigits(++first, last, 2, day);
+
+                if (mPrimitive == primitive_datetime)
+                    ++first;
+            }
+
+            if (mPrimitive != primitive_date) {
+                readDigits(first, last, 2, hour);
+                readDigits(++first, last, 2, minute);
+                readDigits(++first, last, 2, second);
+
+                if (first != last && *first == '.') {
+                    int64_t scale = 100000;
+
+                    for (++first; first != last && *first >= '0' && *first <= '9'; ++first, scale /= 10)
+                        micro += (*first - '0') * scale;
+                }
+            }
+
+            if (first != last) {
+                unsigned h = 0, m = 0;
+
+                timezone = true;
+
+                if (*first != 'Z') {
+                    const bool negative = *first == '-';
+
+                    readDigits(++first, last, 2, h);
+                    readDigits(++first, last, 2, m);
+
+                    offset = static_cast<int>(h * 60 + m) * (negative ? -1 : 1);
+                }
+            }
+
+            const typed_value::type_t type = mPrimitive == primitive_datetime ? typed_value::datetime_type :
+                                             mPrimitive == primitive_date     ? typed_value::date_type :
+                                                                                typed_value::time_type;
+
+            return typed_value::from_time(type, year, month, day, hour, minute,
+                                          int64_t(second) * 1000000 + micro, timezone, offset);
+        }
+
+        //! \brief Check a number, and get its value.
+        /*!
+         *  Decimals are read for every numeric type ; exponents and the
+         *  special values only for \c float and \c double, and fractions
+         *  only for non-integer types.
+         */
+        bool checkNumber(const view_t& value, long double& number) const
+        {
+            const_pointer_t first = value.begin();
+            const_pointer_t last  = value.end();
+            const bool      real  = mPrimitive == primitive_float || mPrimitive == primitive_double;
+
+            if (real && (value.equals("INF") || value.equals("+INF") || value.equals("-INF") || value.equals("NaN"))) {
+                number = value.equals("NaN") ? NAN : value.begin()[0] == '-' ? -HUGE_VALL : HUGE_VALL;
+
+                return true;
+            }
+
+            const bool negative = first != last && *first == '-';
+
+            if (first != last && (*first == '-' || *first == '+'))
+                ++first;
+
+            long double mantissa = 0;
+            size_t      digits   = 0;
+            size_t      total    = 0;
+            size_t      fraction = 0;
+            long        exponent = 0;
+            bool        leading  = true;
+
+            for (; first != last && *first >= '0' && *first <= '9'; ++first, ++digits) {
+                mantissa = mantissa * 10 + (*first - '0');
+
+                if (*first != '0' || !leading) {
+                    leading = false;
+                    ++total;
+                }
+            }
+
+            if (first != last && *first == '.') {
+                if (mLexical == lexical_integer)
+                    return false;
+
+                size_t zeros = 0;
+
+                for (++first; first != last && *first >= '0' && *first <= '9'; ++first, ++digits) {
+                    mantissa = mantissa * 10 + (*first - '0');
+                    --exponent;
+
+                    if (*first == '0')
+                        ++zeros;
+                    else {
+                        fraction += zeros + 1;
+                        total    += zeros + 1;
+                        zeros     = 0;
+                    }
+                }
+            }
+
+            if (digits == 0)
+                return false;
+
+            if (real && first != last && (*first == 'e' || *first == 'E')) {
+                const bool negativeExponent = ++first != last && *first == '-';
+                long       power = 0;
+
+                if (first != last && (*first == '-' || *first == '+'))
+                    ++first;
+
+                if (first == last)
+                    return false;
+
+                for (; first != last && *first >= '0' && *first <= '9'; ++first)
+                    power = std::min(power * 10 + (*first - '0'), 100000L);
+
+                exponent += negativeExponent ? -power : power;
+            }
+
+            if (first != last || total > mTotalDigits || fraction > mFractionDigits)
+                return false;
+
+            number = mantissa * std::pow(10.0L, static_cast<long double>(exponent));
+
+            if (negative)
+                number = -number;
+
+            return true;
+        }
+
+        //! \brief Check a duration.
+        static bool checkDuration(const_pointer_t first, const_pointer_t last)
+        {
+            static const char designators[] = "YMDHMS";
+
+            if (first != last && *first == '-')
+                ++first;
+
+            if (first == last || *first++ != 'P')
+                return false;
+
+            size_t next  = 0;
+            bool   date  = false;
+            bool   time  = false;
+            bool   clock = false;
+
+            while (first != last) {
+                if (*first == 'T' && !time) {
+                    time = true;
+                    next = 3;
+                    ++first;
+
+                    continue;
+                }
+
+                const_pointer_t digits = first;
+
+                while (first != last && *first >= '0' && *first <= '9')
+                    ++first;
+
+                bool decimal = false;
+
+                if (first != last && *first == '.') {
+                    const_pointer_t fraction = ++first;
+
+                    while (first != last && *first >= '0' && *first <= '9')
+                        ++first;
+
+                    if (first == fraction)
+                        return false;
+
+                    decimal = true;
+                }
+
+                if (first == digits || first == last)
+                    return false;
+
+                size_t index = next;
+
+                while (index != (time ? 6 : 3) && static_cast<charT>(designators[index]) != *first)
+                    ++index;
+
+                if (index == (time ? 6 : 3) || (decimal && index != 5))
+                    return false;
+
+                (time ? clock : date) = true;
+                next = index + 1;
+                ++first;
+            }
+
+            return time ? clock : date;
+        }
+
+        //! \brief Check the date part of a date or time value.
+        /*!
+         *  \param [in] year     Whether the value has a year.
+         *  \param [in] month    Whether the value has a month.
+         *  \param [in] day      Whether the value has a day.
+         *  \param [in] timezone Whether the value may end with a time zone.
+         */
+        static bool checkDate(const_pointer_t first, const_pointer_t last, bool year, bool month, bool day, bool timezone)
+        {
+            unsigned value = 0;
+            unsigned y     = 2000;
+            unsigned m     = 1;
+
+            if (year) {
+                if (first != last && *first == '-')
+                    ++first;
+
+                const_pointer_t digits = first;
+
+                while (first != last && *first >= '0' && *first <= '9')
+                    y = (y * 10 + (*first++ - '0')) % 400;
+
+                if (first - digits < 4 || (first - digits > 4 && *digits == '0'))
+                    return false;
+            }
+
+            if (month) {
+                if ((year && !readLiteral(first, last, "-")) || !readDigits(first, last, 2, value) || value < 1 || value > 12)
+                    return false;
+
+                m = value;
+            }
+
+            if (day) {
+                static const unsigned days[] = { 31, 29, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+
+                if (((year || month) && !readLiteral(first, last, "-")) || !readDigits(first, last, 2, value) ||
+                    value < 1 || value > days[m - 1])
+                    return false;
+
+                if (year && m == 2 && value == 29 && (y % 4 != 0 || (y % 100 == 0 && y % 400 != 0)))
+                    return false;
+            }
+
+            return timezone ? checkTimezone(first, last) : first == last;
+        }
+
+        //! \brief Check a time, with an optional time zone.
+        static bool checkTime(const_pointer_t first, const_pointer_t last, bool timezone)
+        {
+            unsigned hour, minute, second;
+
+            if (!readDigits(first, last, 2, hour) || !readLiteral(first, last, ":") ||
+                !readDigits(first, last, 2, minute) || !readLiteral(first, last, ":") ||
+                !readDigits(first, last, 2, second))
+                return false;
+
+            bool zero = minute == 0 && second == 0;
+
+            if (first != last && *first == '.') {
+                const_pointer_t fraction = ++first;
+
+                for (; first != last && *first >= '0' && *first <= '9'; ++first)
+                    zero = zero && *first == '0';
+
+                if (first == fraction)
+                    return false;
+            }
+
+            if ((hour > 23 && !(hour == 24 && zero)) || minute > 59 || second > 59)
+                return false;
+
+            return timezone ? checkTimezone(first, last) : first == last;
+        }
+
+        //! \brief Check an optional time zone, ending a value.
+        static bool checkTimezone(const_pointer_t first, const_pointer_t last)
+        {
+            if (first == last)
+                return true;
+
+            if (*first == 'Z')
+                return first + 1 == last;
+
+            unsigned hour, minute;
+
+            if ((*first != '+' && *first != '-') || !readDigits(++first, last, 2, hour) ||
+                !readLiteral(first, last, ":") || !readDigits(first, last, 2, minute))
+                return false;
+
+            return first == last && minute <= 59 && (hour < 14 || (hour == 14 && minute == 0));
+        }
+
+        //! \brief Read a number of decimal digits.
+        static bool readDigits(const_pointer_t& first, const_pointer_t last, size_t count, unsigned& value)
+        {
+            value = 0;
+
+            for (size_t i = 0; i != count; ++i, ++first) {
+                if (first == last || *first < '0' || *first > '9')
+                    return false;
+
+                value = value * 10 + (*first - '0');
+            }
+
+            return true;
+        }
+
+        //! \brief Read an ASCII literal.
+        static bool readLiteral(const_pointer_t& first, const_pointer_t last, const char* literal)
+        {
+            for (; *literal != '\0'; ++literal, ++first)
+                if (first == last || *first != static_cast<charT>(*literal))
+                    return false;
+
+            return true;
+        }
+
+        //! \brief Whether a character is an ASCII letter.
+        static bool isAlpha(charT c) { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'); }
+
+        //! \brief Whether a character is an hexadecimal digit.
+        static bool isHex(charT c) { return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F'); }
+
+        //! \brief Whether characters can all be part of a name.
+        static bool isNameChars(const_pointer_t first, const_pointer_t last, bool colon)
+        {
+            for (; first != last; ++first)
+                if (!scanner_t::is_name_char(*first) || (!colon && *first == ':'))
+                    return false;
+
+            return true;
+        }
+
+        //! \brief Whether characters are a name without colon.
+        static bool isNCName(const_pointer_t first, const_pointer_t last)
+        {
+            return first != last && *first != ':' && scanner_t::is_name_start(*first) && isNameChars(first + 1, last, false);
+        }
+
+        variety_t    mVariety;    //!< The variety of the type.
+        primitive_t  mPrimitive;  //!< The primitive type of an atomic type.
+        whitespace_t mWhitespace; //!< The white space normalization.
+        lexical_t    mLexical;    //!< The lexical constraint of a built-in type.
+
+        std::vector<type_pointer_t> mMembers; //!< The item type of a list, or the member types of a union.
+
+        size_t mMinLength;      //!< The minimum length.
+        size_t mMaxLength;      //!< The maximum length.
+        size_t mTotalDigits;    //!< The maximum number of significant digits.
+        size_t mFractionDigits; //!< The maximum number of fraction digits.
+
+        long double mMin;          //!< The lower bound.
+        long double mMax;          //!< The upper bound.
+        bool        mHasMin;       //!< Whether there is a lower bound.
+        bool        mHasMax;       //!< Whether there is an upper bound.
+        bool        mMinInclusive; //!< Whether the lower bound is allowed.
+        bool        mMaxInclusive; //!< Whether the upper bound is allowed.
+
+        bool                  mHasEnumeration; //!< Whether the values are enumerated.
+        std::vector<string_t> mEnumeration;    //!< The enumerated values, normalized.
+        std::vector<pattern_t> mPatterns;      //!< The patterns of each restriction step, all of which must match.
+    };
+
+    typedef basic_simple_type<char>    simple_type;  //!< A specialized \c basic_simple_type for char.
+    typedef basic_simple_type<wchar_t> wsimple_type; //!< A specialized \c basic_simple_type for wchar_t.
+}
+
+#endif /* SIMPLE_TYPE_H_INCLUDED */
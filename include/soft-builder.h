@@ -0,0 +1,683 @@
+#ifndef SOFT_BUILDER_H_INCLUDED
+#define SOFT_BUILDER_H_INCLUDED
+
+#include <memory>
+#include <vector>
+#include <string>
+#include <unordered_map>
+
+#include <builder.h>
+
+namespace xml {
+    //! \brief A XML tree builder repairing malformed documents.
+    /*!
+     *  This class builds a \c basic_document from a document that may not
+     *  be well-formed, in a single pass and without throwing exceptions.
+     *  Each problem is repaired on the spot and recorded as a
+     *  \c diagnostic_t, holding a \c reader_t::error_t code and the offset
+     *  of the faulty character :
+     *
+     *  - an end tag closes every element opened since the element it
+     *    names, and is ignored if no such element is open. Elements left
+     *    open at the end of the document are closed.
+     *  - an attribute value may be unquoted, in which case it ends at the
+     *    first white space or at the end of the tag, and an attribute may
+     *    have no value at all, in which case its value is empty. A duplicate
+     *    attribute is ignored.
+     *  - a malformed character or entity reference, such as a stray \c '&',
+     *    is kept as is.
+     *  - a \c '<' that does not start a tag is kept as character data, and
+     *    a tag that is not closed ends at the next \c '<'.
+     *  - an invalid character in a name is kept in the name.
+     *  - character data outside of the root element is skipped, and the
+     *    elements and texts following the root element are appended to it.
+     *  - a document without any element gets a root element with an empty
+     *    name.
+     *
+     *  The open elements are indexed by name, so that closing an element is
+     *  done in constant time whatever the depth is, and a malformed
+     *  reference does not make the rest of the value be searched again :
+     *  the document is parsed in linear time whatever its errors are.
+     *  Comments, processing instructions and the document type declaration
+     *  are skipped, and CDATA sections are stored as text nodes, as with
+     *  \c basic_builder.
+     *
+     *  \sa xml::basic_builder
+     *  \sa xml::basic_entity_decoder
+     *
+     *  \tparam charT The type of character used in the XML document.
+     *                By default, char and wchar_t are supported.
+     */
+    template <typename charT>
+    class basic_soft_builder {
+    public:
+        //! \name Member types
+        //!@{
+        typedef          basic_builder<charT>         builder_t;         //!< The builder type, used for the prolog.
+        typedef typename builder_t::reader_t          reader_t;          //!< The reader type.
+        typedef typename reader_t::error_t            error_t;           //!< The error type.
+        typedef typename builder_t::view_t            view_t;            //!< The type of names and values.
+        typedef typename builder_t::const_pointer_t   const_pointer_t;   //!< Pointer to a constant character.
+        typedef typename builder_t::scanner_t         scanner_t;         //!< The scanner type.
+        typedef typename builder_t::decoder_t         decoder_t;         //!< The reference decoder type.
+        typedef typename decoder_t::pointer_t         pointer_t;         //!< Pointer to a character.
+        typedef typename builder_t::document_t        document_t;        //!< The document type.
+        typedef typename builder_t::string_t          string_t;          //!< The string type.
+        typedef typename builder_t::string_ref_t      string_ref_t;      //!< The type of string stored in nodes.
+        typedef typename builder_t::element_t         element_t;         //!< The element type.
+        typedef typename builder_t::element_pointer_t element_pointer_t; //!< Pointer to \c element_t.
+
+        //!@}
+
+        //! \brief A problem repaired in a document.
+        class diagnostic_t {
+        public:
+            error_t code;   //!< The kind of problem.
+            size_t  offset; //!< The offset of the faulty character, in characters.
+        };
+
+        typedef std::vector<diagnostic_t> diagnostics_t; //!< The list of problems of a document.
+
+        //! \brief Parse a document, repairing it if needed.
+        /*!
+         *  \param [in]  first       A pointer to the first character of the document.
+         *  \param [in]  last        A pointer past the last character of the document.
+         *  \param [out] diagnostics The problems repaired, in document order.
+         *  \param [in]  reference   Whether the nodes reference the parsed buffer,
+         *                           which must then outlive the document.
+         *
+         *  \return The parsed document.
+         */
+        static document_t parse(const_pointer_t first, const_pointer_t last, diagnostics_t& diagnostics, bool reference = false)
+        {
+            basic_soft_builder builder(first, last, diagnostics, reference);
+
+            return builder.build();
+        }
+
+        //! \brief Parse a document, repairing it if needed.
+        /*!
+         *  \param [in]  str         The content of the document.
+         *  \param [out] diagnostics The problems repaired, in document order.
+         *
+         *  \return The parsed document.
+         */
+        static document_t parse(const string_t& str, diagnostics_t& diagnostics)
+        {
+            return parse(str.data(), str.data() + str.size(), diagnostics);
+        }
+
+    private:
+        //! \brief Constructor.
+        /*!
+         *  A leading byte order mark is skipped, as with \c basic_reader.
+         *
+         *  \param [in]  first       A pointer to the first character of the document.
+         *  \param [in]  last        A pointer past the last character of the document.
+         *  \param [out] diagnostics The list problems are appended to.
+         *  \param [in]  reference   Whether the nodes reference the parsed buffer.
+         */
+        basic_soft_builder(const_pointer_t first, const_pointer_t last, diagnostics_t& diagnostics, bool reference)
+        :
+            mBegin(reader_t(first, last).data()),
+            mCursor(mBegin),
+            mEnd(last),
+            mProlog(reference),
+            mDocument(),
+            mStack(),
+            mNames(),
+            mOpen(),
+            mDiagnostics(diagnostics),
+            mReference(reference)
+        {}
+
+        //! \brief Parse the whole document.
+        /*!
+         *  \return The parsed document.
+         */
+        document_t build()
+        {
+            if (matches(mCursor, "<?xml") && mCursor + 5 != mEnd && scanner_t::is_name_delimiter(mCursor[5])) {
+                mCursor += 5;
+                readAttributes(nullptr);
+            }
+
+            while (mCursor != mEnd) {
+                const_pointer_t first = mCursor;
+
+                for (;;) {
+                    mCursor = scanner_t::find(mCursor, mEnd, '<');
+
+                    if (mCursor == mEnd || isMarkup(mCursor))
+                        break;
+
+                    report(reader_t::invalid_tag, mCursor++);
+                }
+
+                if (first != mCursor)
+                    addText(first, mCursor, true);
+
+                if (mCursor == mEnd)
+                    break;
+
+                switch (mCursor[1]) {
+                case '/':
+                    readEndTag();
+                    break;
+                case '!':
+                    readMarkupDeclaration();
+                    break;
+                case '?':
+                    readProcessingInstruction();
+                    break;
+                default:
+                    readStartTag();
+                    break;
+                }
+            }
+
+            if (!mDocument) {
+                report(reader_t::no_root, mEnd);
+                open(view_t(), mEnd);
+            }
+
+            if (!mStack.empty())
+                report(reader_t::unclosed_element, mEnd);
+
+            return std::move(*mDocument);
+        }
+
+        //! \brief Whether the buffer holds an ASCII keyword at a given position.
+        /*!
+         *  \param [in] first A pointer to the first character to compare.
+         *  \param [in] str   A null-terminated ASCII keyword.
+         *
+         *  \return \c true if the buffer holds \c str at \c first.
+         */
+        bool matches(const_pointer_t first, const char* str) const
+        {
+            for (; *str != '\0'; ++first, ++str)
+                if (first == mEnd || *first != static_cast<charT>(*str))
+                    return false;
+
+            return true;
+        }
+
+        //! \brief Whether a \c '<' starts a tag.
+        /*!
+         *  \param [in] first A pointer to the \c '<'.
+         *
+         *  \return \c true if \c '<' is followed by \c '/', \c '!', \c '?'
+         *          or a character that can start a name.
+         */
+        bool isMarkup(const_pointer_t first) const
+        {
+            if (mEnd - first < 2)
+                return false;
+
+            const charT c = first[1];
+
+            return c == '/' || c == '!' || c == '?' || scanner_t::is_name_start(c);
+        }
+
+        //! \brief Whether a character ends a tag or an unquoted value.
+        /*!
+         *  \param [in] first A pointer to the character, before \c mEnd.
+         *
+         *  \return \c true if it is a white space, \c '<', \c '>', or the
+         *          \c '/' or \c '?' of \c "/>" or \c "?>".
+         */
+        bool isTagDelimiter(const_pointer_t first) const
+        {
+            const charT c = *first;
+
+            if (c == '/' || c == '?')
+                return first + 1 != mEnd && first[1] == '>';
+
+            return scanner_t::is_whitespace(c) || c == '<' || c == '>';
+        }
+
+        //! \brief Record a problem.
+        /*!
+         *  \param [in] code  The kind of problem.
+         *  \param [in] where A pointer to the faulty character.
+         */
+        void report(error_t code, const_pointer_t where)
+        {
+            diagnostic_t diagnostic;
+
+            diagnostic.code   = code;
+            diagnostic.offset = where - mBegin;
+
+            mDiagnostics.push_back(diagnostic);
+        }
+
+        //! \brief Read a name.
+        /*!
+         *  Invalid characters are kept in the name, up to the next name or
+         *  tag delimiter.
+         *
+         *  \param [in] first A pointer to the first character of the name,
+         *                    which can start a name.
+         *
+         *  \return A pointer past the name.
+         */
+        const_pointer_t readName(const_pointer_t first)
+        {
+            const_pointer_t last = scanner_t::find_name_end(first + 1, mEnd);
+
+            if (last != mEnd && !scanner_t::is_name_delimiter(*last) && *last != '<') {
+                report(reader_t::invalid_name, last);
+
+                while (last != mEnd && !scanner_t::is_name_delimiter(*last) && *last != '<')
+                    ++last;
+            }
+
+            return last;
+        }
+
+        //! \brief Read a start tag.
+        void readStartTag()
+        {
+            const_pointer_t start = mCursor;
+            const_pointer_t last  = readName(start + 1);
+
+            mCursor = last;
+
+            readAttributes(open(view_t(start + 1, last), start));
+        }
+
+        //! \brief Read the attributes of a start tag or of the XML declaration.
+        /*!
+         *  \param [in] element The element of the start tag, or \c nullptr
+         *                      for the pseudo-attributes of the declaration.
+         */
+        void readAttributes(element_pointer_t element)
+        {
+            const_pointer_t cursor = mCursor;
+
+            for (;;) {
+                cursor = scanner_t::skip_whitespace(cursor, mEnd);
+
+                if (cursor == mEnd) {
+                    report(reader_t::unexpected_end, cursor);
+                    break;
+                }
+
+                if (*cursor == '>') {
+                    ++cursor;
+                    break;
+                }
+
+                if (*cursor == '<') {
+                    report(reader_t::invalid_tag, cursor);
+                    break;
+                }
+
+                if (isTagDelimiter(cursor)) {
+                    if ((*cursor == '/') == (element != nullptr)) {
+                        if (element != nullptr)
+                            close();
+
+                        cursor += 2;
+                        break;
+                    }
+
+                    report(reader_t::invalid_tag, cursor++);
+                    continue;
+                }
+
+                if (!scanner_t::is_name_start(*cursor)) {
+                    report(reader_t::invalid_attribute, cursor);
+
+                    while (cursor != mEnd && !isTagDelimiter(cursor) && !scanner_t::is_name_start(*cursor))
+                        ++cursor;
+
+                    continue;
+                }
+
+                const_pointer_t nameFirst = cursor;
+                const_pointer_t nameLast  = readName(cursor);
+
+                const_pointer_t valueFirst = nameLast;
+                const_pointer_t valueLast  = nameLast;
+
+                cursor = scanner_t::skip_whitespace(nameLast, mEnd);
+
+                if (cursor == mEnd || *cursor != '=') {
+                    report(reader_t::invalid_attribute, nameLast);
+                } else if ((cursor = scanner_t::skip_whitespace(cursor + 1, mEnd)) != mEnd && (*cursor == '"' || *cursor == '\'')) {
+                    valueFirst = cursor + 1;
+                    valueLast  = scanner_t::find_first_of(valueFirst, mEnd, *cursor, '<');
+                    cursor     = valueLast;
+
+                    if (valueLast == mEnd)
+                        report(reader_t::unexpected_end, valueLast);
+                    else if (*valueLast == '<')
+                        report(reader_t::invalid_attribute_value, valueLast);
+                    else
+                        ++cursor;
+                } else {
+                    report(reader_t::invalid_attribute, cursor);
+
+                    valueFirst = cursor;
+
+                    while (cursor != mEnd && !isTagDelimiter(cursor))
+                        ++cursor;
+
+                    valueLast = cursor;
+                }
+
+                const view_t name(nameFirst, nameLast);
+                const view_t value(valueFirst, valueLast);
+
+                if (element == nullptr) {
+                    if (!mProlog.declaration(name, value))
+                        report(reader_t::invalid_declaration, nameFirst);
+                } else if (!element->attributes().emplace(store(name), decode(value)).second) {
+                    report(reader_t::duplicate_attribute, nameFirst);
+                }
+
+                if (cursor != mEnd && *cursor == '<' && valueLast == cursor)
+                    break;
+            }
+
+            mCursor = cursor;
+        }
+
+        //! \brief Read an end tag.
+        void readEndTag()
+        {
+            const_pointer_t start = mCursor;
+            const_pointer_t first = start + 2;
+            const_pointer_t last  = first;
+
+            if (first != mEnd && scanner_t::is_name_start(*first))
+                last = readName(first);
+
+            const_pointer_t cursor = scanner_t::find_first_of(last, mEnd, '>', '<');
+
+            if (cursor == mEnd) {
+                report(reader_t::unexpected_end, cursor);
+            } else if (*cursor == '<') {
+                report(reader_t::invalid_tag, cursor);
+            } else {
+                if (first == last || !scanner_t::all_whitespace(last, cursor))
+                    report(reader_t::invalid_tag, last);
+
+                ++cursor;
+            }
+
+            mCursor = cursor;
+
+            const view_t name(first, last);
+            typename open_map_t::const_iterator it = mOpen.find(name);
+
+            if (it == mOpen.end()) {
+                report(reader_t::mismatched_tag, start);
+                return;
+            }
+
+            if (mNames.back() != name)
+                report(reader_t::mismatched_tag, start);
+
+            while (mNames.back() != name)
+                close();
+
+            close();
+        }
+
+        //! \brief Skip a comment, a CDATA section, a document type declaration or an unknown declaration.
+        void readMarkupDeclaration()
+        {
+            const_pointer_t start = mCursor;
+
+            if (matches(start, "<!--")) {
+                bool reported = false;
+
+                for (const_pointer_t cursor = start + 4;; ++cursor) {
+                    cursor = scanner_t::find(cursor, mEnd, '-');
+
+                    if (mEnd - cursor < 3) {
+                        report(reader_t::unexpected_end, mEnd);
+                        mCursor = mEnd;
+                        return;
+                    }
+
+                    if (cursor[1] == '-') {
+                        if (cursor[2] == '>') {
+                            mCursor = cursor + 3;
+                            return;
+                        }
+
+                        if (!reported)
+                            report(reader_t::invalid_comment, cursor);
+
+                        reported = true;
+                    }
+                }
+            }
+
+            if (matches(start, "<![CDATA[")) {
+                const_pointer_t cursor = start + 9;
+
+                for (;; ++cursor) {
+                    cursor = scanner_t::find(cursor, mEnd, ']');
+
+                    if (mEnd - cursor < 3) {
+                        report(reader_t::unexpected_end, mEnd);
+                        cursor = mEnd;
+                        break;
+                    }
+
+                    if (cursor[1] == ']' && cursor[2] == '>')
+                        break;
+                }
+
+                addText(start + 9, cursor, false);
+                mCursor = cursor == mEnd ? mEnd : cursor + 3;
+                return;
+            }
+
+            if (matches(start, "<!DOCTYPE")) {
+                if (mDocument)
+                    report(reader_t::invalid_doctype, start);
+
+                bool subset = false;
+                const_pointer_t cursor = start + 9;
+
+                for (; cursor != mEnd; ++cursor) {
+                    const charT c = *cursor;
+
+                    if (c == '"' || c == '\'') {
+                        cursor = scanner_t::find(cursor + 1, mEnd, c);
+
+                        if (cursor == mEnd)
+                            break;
+                    } else if (c == '[' || c == ']') {
+                        subset = c == '[';
+                    } else if (c == '>' && !subset) {
+                        break;
+                    }
+                }
+
+                if (cursor == mEnd)
+                    report(reader_t::unexpected_end, mEnd);
+
+                mCursor = cursor == mEnd ? mEnd : cursor + 1;
+                return;
+            }
+
+            report(reader_t::invalid_tag, start);
+
+            const_pointer_t cursor = scanner_t::find_first_of(start + 2, mEnd, '>', '<');
+
+            mCursor = cursor != mEnd && *cursor == '>' ? cursor + 1 : cursor;
+        }
+
+        //! \brief Skip a processing instruction.
+        /*!
+         *  A misplaced XML declaration is skipped as well.
+         */
+        void readProcessingInstruction()
+        {
+            const_pointer_t start = mCursor;
+
+            if (matches(start, "<?xml") && (start + 5 == mEnd || scanner_t::is_name_delimiter(start[5])))
+                report(reader_t::invalid_declaration, start);
+
+            for (const_pointer_t cursor = start + 2;; ++cursor) {
+                cursor = scanner_t::find(cursor, mEnd, '?');
+
+                if (mEnd - cursor < 2) {
+                    report(reader_t::unexpected_end, mEnd);
+                    mCursor = mEnd;
+                    return;
+                }
+
+                if (cursor[1] == '>') {
+                    mCursor = cursor + 2;
+                    return;
+                }
+            }
+        }
+
+        //! \brief Open an element.
+        /*!
+         *  The first element becomes the root of the document.
+         *
+         *  \param [in] name  The name of the element.
+         *  \param [in] start A pointer to the \c '<' of its start tag.
+         *
+         *  \return The new element.
+         */
+        element_pointer_t open(const view_t& name, const_pointer_t start)
+        {
+            element_pointer_t element;
+
+            if (!mDocument) {
+                mProlog.start_element(name);
+                mDocument.reset(new document_t(mProlog.release()));
+
+                element = &mDocument->root();
+            } else {
+                if (mStack.empty())
+                    report(reader_t::multiple_roots, start);
+
+                element = static_cast<element_pointer_t>(&*parent()->emplace_element_back(store(name)));
+            }
+
+            mStack.push_back(element);
+            mNames.push_back(name);
+            ++mOpen[name];
+
+            return element;
+        }
+
+        //! \brief Get the element receiving new content.
+        /*!
+         *  \return The current element, or the root element once it has
+         *          been closed.
+         */
+        element_pointer_t parent() const
+        {
+            return mStack.empty() ? &mDocument->root() : mStack.back();
+        }
+
+        //! \brief Close the current element.
+        void close()
+        {
+            typename open_map_t::iterator it = mOpen.find(mNames.back());
+
+            if (--it->second == 0)
+                mOpen.erase(it);
+
+            mStack.pop_back();
+            mNames.pop_back();
+        }
+
+        //! \brief Add character data to the current element.
+        /*!
+         *  \param [in] first  A pointer to the first character.
+         *  \param [in] last   A pointer past the last character.
+         *  \param [in] decode Whether references are decoded, and white
+         *                     spaces outside of the root element skipped, as
+         *                     in texts but not in CDATA sections.
+         */
+        void addText(const_pointer_t first, const_pointer_t last, bool decode)
+        {
+            if (decode && mStack.empty() && scanner_t::all_whitespace(first, last))
+                return;
+
+            if (mStack.empty()) {
+                report(reader_t::text_outside_root, first);
+
+                if (!mDocument)
+                    return;
+            }
+
+            const view_t value(first, last);
+
+            parent()->emplace_text_back(decode ? this->decode(value) : store(value));
+        }
+
+        //! \brief Store a name or a value in a node.
+        /*!
+         *  \param [in] view The characters to store.
+         *
+         *  \return A string referencing \c view, or a copy of it.
+         */
+        string_ref_t store(const view_t& view) const
+        {
+            return mReference ? string_ref_t(view) : string_ref_t(view.str());
+        }
+
+        //! \brief Decode the references of a value, keeping the malformed ones.
+        /*!
+         *  \param [in] value The value to decode.
+         *
+         *  \return The decoded value, referencing \c value if it holds no
+         *          reference and the nodes reference the parsed buffer.
+         */
+        string_ref_t decode(const view_t& value)
+        {
+            const_pointer_t first = decoder_t::find(value.begin(), value.end());
+
+            if (first == value.end())
+                return store(value);
+
+            string_t  decoded = value.str();
+            pointer_t data    = &decoded[0];
+            pointer_t last    = decoder_t::repair(data + (first - value.begin()), data + decoded.size(),
+                [this, &value, data](const_pointer_t where) {
+                    report(reader_t::invalid_reference, value.begin() + (where - data));
+                });
+
+            decoded.resize(last - data);
+
+            return string_ref_t(std::move(decoded));
+        }
+
+        typedef std::unordered_map<view_t, size_t, typename view_t::hash_t> open_map_t; //!< The number of open elements per name.
+
+        const_pointer_t mBegin;  //!< A pointer to the first character of the document.
+        const_pointer_t mCursor; //!< A pointer to the next character to read.
+        const_pointer_t mEnd;    //!< A pointer past the last character of the document.
+
+        builder_t                   mProlog;   //!< The builder reading the XML declaration and creating the document.
+        std::unique_ptr<document_t> mDocument; //!< The document being built.
+
+        std::vector<element_pointer_t> mStack; //!< The elements currently open.
+        std::vector<view_t>            mNames; //!< The names of the elements currently open.
+        open_map_t                     mOpen;  //!< The number of open elements per name.
+
+        diagnostics_t& mDiagnostics; //!< The problems repaired.
+
+        bool mReference; //!< Whether the nodes reference the parsed buffer.
+    };
+
+    typedef basic_soft_builder<char>    soft_builder;  //!< A specialized \c basic_soft_builder for char.
+    typedef basic_soft_builder<wchar_t> wsoft_builder; //!< A specialized \c basic_soft_builder for wchar_t.
+}
+
+#endif /* SOFT_BUILDER_H_INCLUDED */
@@ -0,0 +1,386 @@
+#ifndef STREAM_VALIDATOR_H_INCLUDED
+#define STREAM_VALIDATOR_H_INCLUDED
+
+#include <deque>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <algorithm>
+
+#include <sax.h>
+#include <entity-decoder.h>
+#include <namespace-table.h>
+#include <schema.h>
+
+namespace xml {
+    //! \brief A streaming XML Schema validator.
+    /*!
+     *  This class is a handler for \c basic_sax_parser and
+     *  \c basic_push_parser, that validates the events of a document
+     *  against a \c basic_compiled_schema as they are produced, without
+     *  building any node. A document can be rejected as soon as its first
+     *  invalid element is read, before the rest of it is even available.
+     *
+     *  A start tag is held until its last attribute has been read, since
+     *  its namespace declarations may follow the attributes they apply to.
+     *  Prefixes are then resolved with a \c basic_namespace_scope, values
+     *  are decoded, and the events are forwarded to a
+     *  \c basic_schema_validator. Names and values are copied when they
+     *  are held, so that chunks given to a push parser do not need to
+     *  outlive it.
+     *
+     *  The memory used is bounded by the depth of the document, the size
+     *  of its largest start tag, the number of distinct namespaces it
+     *  declares and the length of the text of the innermost element with
+     *  simple content : it does not depend on the size of the document.
+     *
+     *  Violations report the index of the invalid element in document
+     *  order, starting from 0 for the root element, instead of a node.
+     *  The names they report are copied, and live as long as the
+     *  validator.
+     *
+     *  \sa xml::basic_compiled_schema
+     *  \sa xml::basic_schema_validator
+     *  \sa xml::basic_sax_parser
+     *  \sa xml::basic_push_parser
+     *
+     *  \tparam charT The type of character used in the XML document.
+     *                By default, char and wchar_t are supported.
+     */
+    template <typename charT>
+    class basic_stream_validator : public basic_sax_handler<charT> {
+    public:
+        //! \name Member types
+        //!@{
+        typedef          basic_compiled_schema<charT> schema_t;     //!< The compiled schema type.
+        typedef          basic_schema_validator<charT> validator_t; //!< The validator events are forwarded to.
+        typedef          basic_entity_decoder<charT>  decoder_t;    //!< The reference decoder type.
+        typedef          basic_namespace_scope<charT> scope_t;      //!< The namespace scope type.
+        typedef typename schema_t::reader_t           reader_t;     //!< The reader type, whose error codes are used.
+        typedef typename schema_t::table_t            table_t;      //!< The namespace table type.
+        typedef typename schema_t::view_t             view_t;       //!< The type of names and values.
+        typedef typename schema_t::string_t           string_t;     //!< The string type.
+        typedef typename schema_t::violations_t       violations_t; //!< A list of validity errors.
+        typedef typename reader_t::error_t            error_t;      //!< The type of well-formedness errors.
+
+        //!@}
+
+        //! \brief Constructor.
+        /*!
+         *  \param [in]  schema     The compiled schema, that must outlive
+         *                          the validator.
+         *  \param [out] violations The list the validity errors are
+         *                          appended to, or \c nullptr to stop the
+         *                          parsing at the first error.
+         */
+        basic_stream_validator(const schema_t& schema, violations_t* violations = nullptr)
+        :
+            mSchema(schema),
+            mViolations(violations),
+            mValidator(schema, violations),
+            mTable(),
+            mIds(),
+            mScope(),
+            mPrefixes(),
+            mMarks(),
+            mTag(),
+            mAttributes(),
+            mValue(),
+            mNames(),
+            mPending(false),
+            mStarted(false),
+            mCount(0),
+            mError(reader_t::no_error)
+        {
+            mapNamespaces();
+        }
+
+        //! \brief Restart the validation for a new document.
+        /*!
+         *  The internal buffers are kept, so that validating several
+         *  documents does not allocate memory. The names reported in
+         *  violations are kept too, since they may still be referenced.
+         */
+        void reset()
+        {
+            mScope   = scope_t();
+            mPending = false;
+            mStarted = false;
+            mCount   = 0;
+            mError   = reader_t::no_error;
+
+            mValidator.reset();
+            mPrefixes.clear();
+            mMarks.clear();
+            mAttributes.clear();
+        }
+
+        //! \brief A start tag.
+        bool start_element(const view_t& name)
+        {
+            if (!flush())
+                return false;
+
+            mTag.assign(name.begin(), name.end());
+            mAttributes.clear();
+            mPending = true;
+
+            return true;
+        }
+
+        //! \brief An attribute of the last start tag.
+        bool attribute(const view_t& name, const view_t& value)
+        {
+            const size_t first = mTag.size();
+
+            mTag.append(name.begin(), name.end());
+            mTag.append(value.begin(), value.end());
+
+            charT* const begin = &mTag[first + name.size()];
+            charT* const end   = decoder_t::decode(begin, begin + value.size());
+
+            if (end == nullptr)
+                return fail(reader_t::invalid_reference);
+
+            mTag.resize(end - mTag.data());
+            mAttributes.push_back(attribute_t { first, first + name.size(), mTag.size() });
+
+            return true;
+        }
+
+        //! \brief An end tag, or the end of an empty element tag.
+        bool end_element(const view_t&)
+        {
+            if (!flush())
+                return false;
+
+            mScope.pop();
+            mPrefixes.resize(mMarks.back());
+            mMarks.pop_back();
+
+            return mValidator.end_element();
+        }
+
+        //! \brief Character data, whose references are decoded.
+        bool text(const view_t& value)
+        {
+            if (!flush())
+                return false;
+
+            if (mMarks.empty())
+                return true;
+
+            mValue.assign(value.begin(), value.end());
+
+            charT* const end = decoder_t::decode(&mValue[0], &mValue[0] + mValue.size());
+
+            if (end == nullptr)
+                return fail(reader_t::invalid_reference);
+
+            return mValidator.text(view_t(mValue.data(), end - mValue.data()));
+        }
+
+        //! \brief A CDATA section.
+        bool cdata(const view_t& value)
+        {
+            return flush() && mValidator.text(value);
+        }
+
+        //! \brief A comment.
+        bool comment(const view_t&)
+        {
+            return flush();
+        }
+
+        //! \brief A processing instruction.
+        bool processing_instruction(const view_t&, const view_t&)
+        {
+            return flush();
+        }
+
+        //! \brief Whether the document is valid.
+        /*!
+         *  \return \c true if the root element has been closed, and no
+         *          validity or namespace error has been found.
+         */
+        bool valid() const
+        {
+            return mStarted && mMarks.empty() && mError == reader_t::no_error && mValidator.valid();
+        }
+
+        //! \brief Get the well-formedness error found by the validator.
+        /*!
+         *  Errors that are not checked by the parser, since it does not
+         *  resolve namespaces nor decode references, are found here and
+         *  stop the parsing.
+         *
+         *  \return \c reader_t::invalid_namespace, \c reader_t::invalid_reference,
+         *          or \c reader_t::no_error.
+         */
+        error_t error_code() const { return mError; }
+
+    private:
+        //! \brief An attribute of the held start tag.
+        class attribute_t {
+        public:
+            size_t name;  //!< The offset of its name in the tag buffer.
+            size_t value; //!< The offset of its decoded value in the tag buffer.
+            size_t end;   //!< The offset past its value in the tag buffer.
+        };
+
+        //! \brief Record a well-formedness error, and stop the parsing.
+        bool fail(error_t code)
+        {
+            mError = code;
+
+            return false;
+        }
+
+        //! \brief Map the namespaces of the local table to those of the schema.
+        void mapNamespaces()
+        {
+            for (size_t i = mIds.size(); i != mTable.size(); ++i)
+                mIds.push_back(i <= table_t::xmlns_namespace ?
+                               static_cast<namespace_id_t>(i) : mSchema.namespaces().find(mTable.uri(static_cast<namespace_id_t>(i))));
+        }
+
+        //! \brief Get a view of part of the tag buffer.
+        view_t slice(size_t first, size_t last) const
+        {
+            return view_t(mTag.data() + first, last - first);
+        }
+
+        //! \brief Split a qualified name.
+        /*!
+         *  \param [out] prefix The prefix, or an empty view.
+         *
+         *  \return The local name.
+         */
+        static view_t split(const view_t& qname, view_t& prefix)
+        {
+            const charT* colon = std::find(qname.begin(), qname.end(), ':');
+
+            if (colon == qname.end()) {
+                prefix = view_t();
+
+                return qname;
+            }
+
+            prefix = view_t(qname.begin(), colon);
+
+            return view_t(colon + 1, qname.end());
+        }
+
+        //! \brief Forward the held start tag to the validator.
+        /*!
+         *  The namespace declarations of the tag are bound first, then the
+         *  names of the element and its attributes are resolved.
+         */
+        bool flush()
+        {
+            if (!mPending)
+                return true;
+
+            mPending = false;
+            mStarted = true;
+
+            mScope.push();
+            mMarks.push_back(mPrefixes.size());
+
+            for (const attribute_t& attribute : mAttributes) {
+                const view_t name = slice(attribute.name, attribute.value);
+                view_t       prefix;
+                const view_t local = split(name, prefix);
+
+                if (!prefix.equals("xmlns") && !name.equals("xmlns"))
+                    continue;
+
+                const namespace_id_t id = mTable.intern(slice(attribute.value, attribute.end));
+
+                mapNamespaces();
+
+                if (prefix.empty())
+                    mScope.bind(view_t(), id);
+                else {
+                    mPrefixes.push_back(local.str());
+                    mScope.bind(view_t(mPrefixes.back()), id);
+                }
+            }
+
+            const size_t length = mAttributes.empty() ? mTag.size() : mAttributes.front().name;
+            view_t       prefix;
+            const view_t local = split(slice(0, length), prefix);
+            const namespace_id_t ns = mScope.find(prefix);
+
+            if (ns == table_t::npos)
+                return fail(reader_t::invalid_namespace);
+
+            const size_t reported = mViolations != nullptr ? mViolations->size() : 0;
+
+            if (!mValidator.start_element(mIds[ns], local, nullptr, mCount++))
+                return false;
+
+            for (const attribute_t& attribute : mAttributes) {
+                const view_t   name  = slice(attribute.name, attribute.value);
+                const view_t   local = split(name, prefix);
+                namespace_id_t ns    = table_t::no_namespace;
+
+                if (prefix.equals("xmlns") || name.equals("xmlns"))
+                    ns = table_t::xmlns_namespace;
+                else if (!prefix.empty() && (ns = mScope.find(prefix)) == table_t::npos)
+                    return fail(reader_t::invalid_namespace);
+
+                if (!mValidator.attribute(mIds[ns], local, slice(attribute.value, attribute.end)))
+                    return false;
+            }
+
+            const bool valid = mValidator.end_attributes();
+
+            keep(reported);
+
+            return valid;
+        }
+
+        //! \brief Copy the names reported since a violation, that reference the tag buffer.
+        /*!
+         *  \param [in] first The index of the first violation to look at.
+         */
+        void keep(size_t first)
+        {
+            for (size_t i = first; mViolations != nullptr && i != mViolations->size(); ++i) {
+                view_t& name = (*mViolations)[i].name;
+
+                if (name.empty() || name.begin() < mTag.data() || name.end() > mTag.data() + mTag.size())
+                    continue;
+
+                mNames.push_back(name.str());
+                name = view_t(mNames.back());
+            }
+        }
+
+        const schema_t& mSchema;     //!< The compiled schema.
+        violations_t*   mViolations; //!< The list of errors, or \c nullptr.
+        validator_t     mValidator;  //!< The validator events are forwarded to.
+
+        table_t                     mTable;    //!< The namespaces declared in the document.
+        std::vector<namespace_id_t> mIds;      //!< The schema identifier of each namespace of \c mTable.
+        scope_t                     mScope;    //!< The prefixes in scope.
+        std::deque<string_t>        mPrefixes; //!< The bound prefixes, referenced by \c mScope. A deque never moves them.
+        std::vector<size_t>         mMarks;    //!< The number of prefixes when each open element was started.
+
+        string_t                 mTag;        //!< The name, then the attribute names and decoded values, of the held start tag.
+        std::vector<attribute_t> mAttributes; //!< The attributes of the held start tag.
+        string_t                 mValue;      //!< The decoded text.
+        std::deque<string_t>     mNames;      //!< The names reported in violations, that outlive the tag buffer.
+
+        bool    mPending; //!< Whether a start tag is held.
+        bool    mStarted; //!< Whether the root element has been started.
+        size_t  mCount;   //!< The number of elements started.
+        error_t mError;   //!< The well-formedness error found, if any.
+    };
+
+    typedef basic_stream_validator<char>    stream_validator;  //!< A specialized \c basic_stream_validator for char.
+    typedef basic_stream_validator<wchar_t> wstream_validator; //!< A specialized \c basic_stream_validator for wchar_t.
+}
+
+#endif /* STREAM_VALIDATOR_H_INCLUDED */
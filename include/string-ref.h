@@ -0,0 +1,312 @@
+#ifndef STRING_REF_H_INCLUDED
+#define STRING_REF_H_INCLUDED
+
+#include <string>
+#include <ostream>
+
+#include <string-view.h>
+
+namespace xml {
+    //! \brief A string that either references or owns its characters.
+    /*!
+     *  This class stores the names and values of the nodes. When a document
+     *  keeps its source buffer alive, a string can reference the characters
+     *  of that buffer instead of copying them. The characters are copied
+     *  into an owned string only when they are modified, through
+     *  \c modify() or an assignment.
+     *
+     *  Copying a \c basic_string_ref always produces an owned string, so
+     *  that a copied node never depends on the source of another document.
+     *  Moving it keeps the reference.
+     *
+     *  \tparam charT The type of character used in the string.
+     *                By default, char and wchar_t are supported.
+     */
+    template <typename charT>
+    class basic_string_ref {
+    public:
+        //! \name Member types
+        //!@{
+        typedef std::basic_string<charT>  string_t; //!< The owning string type.
+        typedef basic_string_view<charT>  view_t;   //!< The view type.
+
+        typedef const charT* const_pointer_t;  //!< Pointer to a constant character.
+        typedef const charT* const_iterator_t; //!< Iterator over the characters of a string.
+
+        typedef basic_string_ref<charT> string_ref_t;                 //!< The type of string reference.
+        typedef const string_ref_t&     string_ref_const_reference_t; //!< Constant reference to \c string_ref_t.
+        typedef string_ref_t&&          string_ref_move_t;            //!< Move a \c string_ref_t.
+
+        //!@}
+
+        //! \brief Default constructor.
+        /*!
+         *  Builds an empty owned string.
+         */
+        basic_string_ref()
+        :
+            mView(),
+            mString()
+        {}
+
+        //! \brief Constructor.
+        /*!
+         *  Builds an owned copy of \c str.
+         *
+         *  \param [in] str A null-terminated string.
+         */
+        basic_string_ref(const_pointer_t str)
+        :
+            mView(),
+            mString(str)
+        {}
+
+        //! \brief Constructor.
+        /*!
+         *  Builds an owned copy of \c str.
+         *
+         *  \param [in] str The string to copy.
+         */
+        basic_string_ref(const string_t& str)
+        :
+            mView(),
+            mString(str)
+        {}
+
+        //! \brief Constructor.
+        /*!
+         *  Builds an owned string taking the content of \c str.
+         *
+         *  \param [in] str The string to move.
+         */
+        basic_string_ref(string_t&& str)
+        :
+            mView(),
+            mString(std::move(str))
+        {}
+
+        //! \brief Constructor.
+        /*!
+         *  Builds a string referencing the characters of \c view, which
+         *  must outlive it.
+         *
+         *  \param [in] view The characters to reference.
+         */
+        explicit basic_string_ref(const view_t& view)
+        :
+            mView(view),
+            mString()
+        {}
+
+        //! \brief Copy constructor.
+        /*!
+         *  Builds an owned copy of the characters of \c rhs.
+         *
+         *  \param [in] rhs A constant reference to a \c string_ref_t.
+         */
+        basic_string_ref(string_ref_const_reference_t rhs)
+        :
+            mView(),
+            mString(rhs.data(), rhs.size())
+        {}
+
+        //! \brief Move constructor.
+        /*!
+         *  Takes the place of \c rhs, keeping its reference if any.
+         *
+         *  \param [in] rhs A rvalue reference to a \c string_ref_t.
+         */
+        basic_string_ref(string_ref_move_t rhs)
+        :
+            mView(rhs.mView),
+            mString(std::move(rhs.mString))
+        {
+            rhs.mView = view_t();
+        }
+
+        //! \brief Copy assignment.
+        /*!
+         *  \param [in] rhs A constant reference to a \c string_ref_t.
+         *
+         *  \return A reference to this string.
+         */
+        string_ref_t& operator=(string_ref_const_reference_t rhs)
+        {
+            if (this != &rhs) {
+                mString.assign(rhs.data(), rhs.size());
+                mView = view_t();
+            }
+
+            return *this;
+        }
+
+        //! \brief Move assignment.
+        /*!
+         *  \param [in] rhs A rvalue reference to a \c string_ref_t.
+         *
+         *  \return A reference to this string.
+         */
+        string_ref_t& operator=(string_ref_move_t rhs)
+        {
+            mView   = rhs.mView;
+            mString = std::move(rhs.mString);
+
+            rhs.mView = view_t();
+
+            return *this;
+        }
+
+        //! \brief Assign an owned copy of \c str.
+        /*!
+         *  \param [in] str The string to copy.
+         *
+         *  \return A reference to this string.
+         */
+        string_ref_t& operator=(const string_t& str)
+        {
+            mString = str;
+            mView   = view_t();
+
+            return *this;
+        }
+
+        //! \brief Assign an owned string taking the content of \c str.
+        /*!
+         *  \param [in] str The string to move.
+         *
+         *  \return A reference to this string.
+         */
+        string_ref_t& operator=(string_t&& str)
+        {
+            mString = std::move(str);
+            mView   = view_t();
+
+            return *this;
+        }
+
+        //! \brief Assign an owned copy of \c str.
+        /*!
+         *  \param [in] str A null-terminated string.
+         *
+         *  \return A reference to this string.
+         */
+        string_ref_t& operator=(const_pointer_t str)
+        {
+            mString = str;
+            mView   = view_t();
+
+            return *this;
+        }
+
+        //! \brief Whether this string references an external buffer.
+        /*!
+         *  \return \c true if the characters are not owned by this string.
+         */
+        bool references() const noexcept { return mView.data() != nullptr; }
+
+        //! \brief Get the characters of this string.
+        /*!
+         *  The characters are not null-terminated when they are referenced.
+         *
+         *  \return A pointer to the first character.
+         */
+        const_pointer_t data() const noexcept { return references() ? mView.data() : mString.data(); }
+
+        //! \brief Get the size of this string.
+        /*!
+         *  \return The number of characters.
+         */
+        size_t size() const noexcept { return references() ? mView.size() : mString.size(); }
+
+        //! \brief Whether this string is empty.
+        /*!
+         *  \return \c true if this string has no character.
+         */
+        bool empty() const noexcept { return size() == 0; }
+
+        //! \brief Get an iterator to the first character.
+        const_iterator_t begin() const noexcept { return data(); }
+
+        //! \brief Get an iterator past the last character.
+        const_iterator_t end() const noexcept { return data() + size(); }
+
+        //! \brief Get a character.
+        /*!
+         *  \param [in] pos The position of the character.
+         *
+         *  \return The character at position \c pos.
+         */
+        charT operator[](size_t pos) const { return data()[pos]; }
+
+        //! \brief Get a view over this string.
+        /*!
+         *  \return A view valid until this string is modified.
+         */
+        view_t view() const noexcept { return view_t(data(), size()); }
+
+        //! \brief Get a view over this string.
+        operator view_t() const noexcept { return view(); }
+
+        //! \brief Get a copy of this string.
+        /*!
+         *  \return An owning string holding the same characters.
+         */
+        string_t str() const { return string_t(data(), size()); }
+
+        //! \brief Get a modifiable string.
+        /*!
+         *  The referenced characters are copied into an owned string first.
+         *
+         *  \return A reference to the owned string.
+         */
+        string_t& modify()
+        {
+            if (references()) {
+                mString.assign(mView.data(), mView.size());
+                mView = view_t();
+            }
+
+            return mString;
+        }
+
+        //! \brief Compare with a sequence of characters.
+        bool operator==(const view_t& rhs) const { return view() == rhs; }
+
+        //! \brief Compare with a sequence of characters.
+        bool operator!=(const view_t& rhs) const { return view() != rhs; }
+
+        //! \brief Compare with a sequence of characters.
+        bool operator<(const view_t& rhs) const { return view() < rhs; }
+
+        //! \brief Compare with another string.
+        bool operator==(string_ref_const_reference_t rhs) const { return view() == rhs.view(); }
+
+        //! \brief Compare with another string.
+        bool operator!=(string_ref_const_reference_t rhs) const { return view() != rhs.view(); }
+
+        //! \brief Compare with another string.
+        bool operator<(string_ref_const_reference_t rhs) const { return view() < rhs.view(); }
+
+        //! \brief Compare with an owning string.
+        bool operator==(const string_t& rhs) const { return view() == view_t(rhs); }
+
+        //! \brief Compare with an owning string.
+        bool operator!=(const string_t& rhs) const { return view() != view_t(rhs); }
+
+    private:
+        view_t   mView;   //!< The referenced characters, if any.
+        string_t mString; //!< The owned characters, if nothing is referenced.
+    };
+
+    //! \brief Write a \c basic_string_ref to an output stream.
+    template <typename charT, typename traits>
+    std::basic_ostream<charT, traits>& operator<<(std::basic_ostream<charT, traits>& os, const basic_string_ref<charT>& str)
+    {
+        return os.write(str.data(), str.size());
+    }
+
+    typedef basic_string_ref<char>    string_ref;  //!< A specialized \c basic_string_ref for char.
+    typedef basic_string_ref<wchar_t> wstring_ref; //!< A specialized \c basic_string_ref for wchar_t.
+}
+
+#endif /* STRING_REF_H_INCLUDED */
@@ -0,0 +1,229 @@
+#ifndef STRING_VIEW_H_INCLUDED
+#define STRING_VIEW_H_INCLUDED
+
+#include <string>
+#include <cstddef>
+#include <algorithm>
+#include <type_traits>
+
+namespace xml {
+    //! \brief A non-owning view over a sequence of characters.
+    /*!
+     *  This class references a contiguous sequence of characters without
+     *  owning it. It is used by the parsers to report names and values
+     *  directly from the input buffer, without any copy.
+     *  The referenced characters must outlive the view.
+     *
+     *  \tparam charT The type of character used in the view.
+     *                By default, char and wchar_t are supported.
+     */
+    template <typename charT>
+    class basic_string_view {
+    public:
+        //! \name Member types
+        //!@{
+        typedef std::basic_string<charT> string_t; //!< The owning string type.
+
+        typedef const charT* const_pointer_t;  //!< Pointer to a constant character.
+        typedef const charT* const_iterator_t; //!< Iterator over the characters of a view.
+
+        typedef basic_string_view<charT> view_t;                 //!< The type of view.
+        typedef const view_t&            view_const_reference_t; //!< Constant reference to \c view_t.
+
+        //!@}
+
+        //! \brief A hash function, to use views as keys of unordered containers.
+        class hash_t {
+        public:
+            //! \brief Hash a view.
+            size_t operator()(view_const_reference_t view) const { return view.hash(); }
+        };
+
+        //! \brief Default constructor.
+        /*!
+         *  Builds an empty view.
+         */
+        basic_string_view()
+        :
+            mData(nullptr),
+            mSize(0)
+        {}
+
+        //! \brief Constructor.
+        /*!
+         *  Builds a view over \c size characters starting at \c data.
+         *
+         *  \param [in] data A pointer to the first character.
+         *  \param [in] size The number of characters.
+         */
+        basic_string_view(const_pointer_t data, size_t size)
+        :
+            mData(data),
+            mSize(size)
+        {}
+
+        //! \brief Constructor.
+        /*!
+         *  Builds a view over the characters in between \c first (included)
+         *  and \c last (excluded).
+         *
+         *  \param [in] first A pointer to the first character.
+         *  \param [in] last  A pointer past the last character.
+         */
+        basic_string_view(const_pointer_t first, const_pointer_t last)
+        :
+            mData(first),
+            mSize(last - first)
+        {}
+
+        //! \brief Constructor.
+        /*!
+         *  Builds a view over the content of a string.
+         *
+         *  \param [in] str The string to reference.
+         */
+        basic_string_view(const string_t& str)
+        :
+            mData(str.data()),
+            mSize(str.size())
+        {}
+
+        //! \brief Get a pointer to the first character.
+        /*!
+         *  \return A pointer to the first character of the view.
+         */
+        const_pointer_t data() const noexcept { return mData; }
+
+        //! \brief Get the number of characters.
+        /*!
+         *  \return The number of characters of the view.
+         */
+        size_t size() const noexcept { return mSize; }
+
+        //! \brief Whether the view is empty.
+        /*!
+         *  \return \c true if the view has no character, \c false otherwise.
+         */
+        bool empty() const noexcept { return mSize == 0; }
+
+        //! \brief Return iterator to beginning.
+        const_iterator_t begin() const noexcept { return mData; }
+
+        //! \brief Return iterator to past-the-end.
+        const_iterator_t end() const noexcept { return mData + mSize; }
+
+        //! \brief Access a character.
+        /*!
+         *  Accessing a character out of the view causes undefined behaviour.
+         *
+         *  \param [in] pos The position of the character.
+         *
+         *  \return The character at position \c pos.
+         */
+        charT operator[](size_t pos) const { return mData[pos]; }
+
+        //! \brief Get a sub-view.
+        /*!
+         *  \param [in] pos   The position of the first character.
+         *  \param [in] count The maximum number of characters.
+         *
+         *  \return A view over the requested characters.
+         */
+        view_t substr(size_t pos, size_t count = size_t(-1)) const
+        {
+            pos = std::min(pos, mSize);
+            return view_t(mData + pos, std::min(count, mSize - pos));
+        }
+
+        //! \brief Copy the view into an owning string.
+        /*!
+         *  \return A string holding a copy of the referenced characters.
+         */
+        string_t str() const
+        {
+            return string_t(mData, mSize);
+        }
+
+        //! \brief Compare two views.
+        /*!
+         *  \param [in] rhs The view to compare with.
+         *
+         *  \return A negative value, zero or a positive value if this view is
+         *          respectively lower, equal or greater than \c rhs.
+         */
+        int compare(view_const_reference_t rhs) const
+        {
+            const size_t n = std::min(mSize, rhs.mSize);
+
+            for (size_t i = 0; i < n; ++i)
+                if (mData[i] != rhs.mData[i])
+                    return mData[i] < rhs.mData[i] ? -1 : 1;
+
+            return mSize == rhs.mSize ? 0 : (mSize < rhs.mSize ? -1 : 1);
+        }
+
+        //! \brief Compare with a null-terminated ASCII literal.
+        /*!
+         *  This function is used to compare a view with XML keywords,
+         *  whatever the type of character of the view is.
+         *
+         *  \param [in] str A null-terminated ASCII string.
+         *
+         *  \return \c true if the view holds exactly \c str.
+         */
+        bool equals(const char* str) const
+        {
+            size_t i = 0;
+
+            for (; i < mSize; ++i)
+                if (str[i] == '\0' || mData[i] != static_cast<charT>(str[i]))
+                    return false;
+
+            return str[i] == '\0';
+        }
+
+        //! \brief Hash the characters of the view.
+        /*!
+         *  This function computes the FNV-1a hash of the code points of the
+         *  characters, so that equal views always have the same hash.
+         *
+         *  \return The hash of the view.
+         */
+        size_t hash() const
+        {
+            size_t value = 2166136261u;
+
+            for (size_t i = 0; i < mSize; ++i)
+                value = (value ^ static_cast<size_t>(static_cast<typename std::make_unsigned<charT>::type>(mData[i]))) * 16777619u;
+
+            return value;
+        }
+
+        //! \brief Equality operator.
+        bool operator==(view_const_reference_t rhs) const
+        {
+            return mSize == rhs.mSize && std::equal(begin(), end(), rhs.begin());
+        }
+
+        //! \brief Inequality operator.
+        bool operator!=(view_const_reference_t rhs) const
+        {
+            return !(*this == rhs);
+        }
+
+        //! \brief Lower than operator.
+        bool operator<(view_const_reference_t rhs) const
+        {
+            return compare(rhs) < 0;
+        }
+
+    private:
+        const_pointer_t mData; //!< A pointer to the first character.
+        size_t          mSize; //!< The number of characters.
+    };
+
+    typedef basic_string_view<char>    string_view;  //!< A specialized \c basic_string_view for char.
+    typedef basic_string_view<wchar_t> wstring_view; //!< A specialized \c basic_string_view for wchar_t.
+}
+
+#endif /* STRING_VIEW_H_INCLUDED */
@@ -0,0 +1,645 @@
+#ifndef STRUCTURAL_INDEX_H_INCLUDED
+#define STRUCTURAL_INDEX_H_INCLUDED
+
+#include <memory>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <stdexcept>
+
+#include <builder.h>
+
+namespace xml {
+    //! \brief A flat index of the structure of a XML document.
+    /*!
+     *  This class parses a document in two stages. The first stage only
+     *  finds the boundaries of the tags, texts, comments, CDATA sections
+     *  and processing instructions, and records them in a flat array of
+     *  entries. It looks at 64 characters at a time, using the masks of
+     *  the \c '<', \c '>' and quote characters computed by
+     *  \c basic_scanner::classify(), and only checks that tags are
+     *  balanced. A document declared as UTF-8 is also validated by this
+     *  stage, when the XML declaration is found.
+     *
+     *  The second stage turns a range of entries into events of a
+     *  \c basic_sax_handler, or into nodes with \c materialize(). Names
+     *  and attributes are validated by this stage, which only pays for the
+     *  entries it is given. Each element entry knows the index of the entry
+     *  following its subtree, so that subtrees can be skipped in constant
+     *  time.
+     *
+     *  \sa xml::basic_scanner
+     *  \sa xml::basic_builder
+     *
+     *  \tparam charT The type of character used in the XML document.
+     *                By default, char and wchar_t are supported.
+     */
+    template <typename charT>
+    class basic_structural_index {
+    public:
+        //! \name Member types
+        //!@{
+        typedef          basic_builder<charT>       builder_t;       //!< The builder type.
+        typedef typename builder_t::parser_t        parser_t;        //!< The parser type.
+        typedef typename builder_t::reader_t        reader_t;        //!< The reader type.
+        typedef typename builder_t::token_t         token_t;         //!< The token type.
+        typedef typename builder_t::view_t          view_t;          //!< The type of names and values.
+        typedef typename builder_t::const_pointer_t const_pointer_t; //!< Pointer to a constant character.
+        typedef typename builder_t::scanner_t       scanner_t;       //!< The scanner type.
+        typedef typename builder_t::document_t      document_t;      //!< The document type.
+        typedef typename builder_t::element_t       element_t;       //!< The element type.
+        typedef typename reader_t::error_t          error_t;         //!< The error code type.
+        typedef typename builder_t::parse_error_t   parse_error_t;   //!< The parse error type.
+        typedef typename builder_t::exception_t     exception_t;     //!< The type of exception thrown on parse errors.
+
+        //! An entry of the index.
+        struct entry_t {
+            token_t kind;  //!< The type of token : \c declaration, \c doctype, \c start_element,
+                           //!< \c end_element, \c text, \c cdata, \c comment or \c processing_instruction.
+            size_t  first; //!< The offset of the first character of the token.
+            size_t  last;  //!< The offset past the last character of the token.
+            size_t  next;  //!< The index of the entry following this one and its descendants.
+        };
+
+        //!@}
+
+        //! The index returned when an entry does not exist.
+        static const size_t npos = static_cast<size_t>(-1);
+
+        //! \brief Default constructor.
+        /*!
+         *  Builds an empty index, to be filled with \c build().
+         */
+        basic_structural_index()
+        :
+            mEntries(),
+            mStack()
+        {
+            clear(nullptr, nullptr);
+        }
+
+        //! \brief Constructor.
+        /*!
+         *  Builds the index of the characters in between \c first (included)
+         *  and \c last (excluded), which must outlive the index.
+         *
+         *  \param [in] first  A pointer to the first character of the document.
+         *  \param [in] last   A pointer past the last character of the document.
+         *  \param [in] source The owner of the characters, kept alive by the
+         *                     exception thrown on errors, or \c nullptr.
+         *
+         *  \throw exception_t If the structure of the document is not
+         *                     well-formed.
+         */
+        basic_structural_index(const_pointer_t first, const_pointer_t last, std::shared_ptr<const void> source = nullptr)
+        :
+            mEntries(),
+            mStack()
+        {
+            if (!build(first, last))
+                raise("malformed XML document", mError, mOffset, std::move(source));
+        }
+
+        //! \brief Destructor.
+        /*!
+         *  This destructor does nothing.
+         */
+        virtual ~basic_structural_index()
+        {}
+
+        //! \brief Build the index of a document.
+        /*!
+         *  The previous entries are discarded, but their memory is reused.
+         *
+         *  \param [in] first A pointer to the first character of the document.
+         *  \param [in] last  A pointer past the last character of the document.
+         *
+         *  \return \c true if the structure of the document is well-formed,
+         *          \c false otherwise. In that case, \c error_code() and
+         *          \c offset() describe the error.
+         */
+        bool build(const_pointer_t first, const_pointer_t last)
+        {
+            clear(first, last);
+
+            const_pointer_t cursor = mBegin;
+            const_pointer_t text   = mBegin;
+            const_pointer_t tag    = nullptr;
+
+            state_t state = state_content;
+            charT   quote = 0;
+
+            while (cursor < mEnd) {
+                const_pointer_t base = cursor;
+                const size_t    size = mEnd - base < 64 ? mEnd - base : 64;
+
+                uint64_t lt, gt, quotes;
+
+                scanner_t::classify(base, mEnd, lt, gt, quotes);
+
+                cursor = base + size;
+
+                for (size_t pos = 0; pos < size; ) {
+                    const uint64_t live = ~uint64_t(0) << pos;
+                    const uint64_t bits = live & (
+                        state == state_content ? lt :
+                        state == state_tag     ? gt | quotes :
+                                                 quotes);
+
+                    if (bits == 0)
+                        break;
+
+                    pos = __builtin_ctzll(bits);
+
+                    const_pointer_t p = base + pos++;
+
+                    if (state == state_content) {
+                        if (!addText(text, p))
+                            return false;
+
+                        if (mEnd - p < 2)
+                            return fail(reader_t::unexpected_end, mEnd);
+
+                        if (p[1] == '!' || p[1] == '?') {
+                            const_pointer_t end = addMarkup(p);
+
+                            if (end == nullptr)
+                                return false;
+
+                            cursor = text = end;
+                            break;
+                        }
+
+                        tag   = p;
+                        state = state_tag;
+                    } else if (state == state_tag) {
+                        if (*p == '>') {
+                            if (!addTag(tag, p + 1))
+                                return false;
+
+                            text  = p + 1;
+                            state = state_content;
+                        } else {
+                            quote = *p;
+                            state = state_quoted;
+                        }
+                    } else if (*p == quote) {
+                        state = state_tag;
+                    }
+                }
+            }
+
+            if (state != state_content)
+                return fail(reader_t::unexpected_end, mEnd);
+
+            if (!addText(text, mEnd))
+                return false;
+
+            if (!mStack.empty())
+                return fail(reader_t::unclosed_element, mEnd);
+
+            if (mRoot == npos)
+                return fail(reader_t::no_root, mEnd);
+
+            return true;
+        }
+
+        //! \brief Get the number of entries.
+        size_t size() const { return mEntries.size(); }
+
+        //! \brief Get an entry.
+        /*!
+         *  \param [in] i The index of the entry.
+         *
+         *  \return A constant reference to the entry.
+         */
+        const entry_t& operator[](size_t i) const { return mEntries[i]; }
+
+        //! \brief Get the index of the root element.
+        /*!
+         *  \return The index of the start tag of the root element, or
+         *          \c npos if the index is empty.
+         */
+        size_t root() const { return mRoot; }
+
+        //! \brief Get the entry following a subtree.
+        /*!
+         *  \param [in] i The index of an entry.
+         *
+         *  \return The index of the entry following entry \c i and its
+         *          descendants, which is \c size() at the end.
+         */
+        size_t next(size_t i) const { return mEntries[i].next; }
+
+        //! \brief Get the first child of an element.
+        /*!
+         *  The children of the element \c i are the entries from
+         *  \c first_child(i) to \c last_child(i), stepping with \c next().
+         *
+         *  \param [in] i The index of a start tag.
+         *
+         *  \return The index of the first child of the element.
+         */
+        size_t first_child(size_t i) const { return i + 1; }
+
+        //! \brief Get the end of the children of an element.
+        /*!
+         *  \param [in] i The index of a start tag.
+         *
+         *  \return The index of the end tag of the element, or \c i + 1 for
+         *          an empty element tag.
+         */
+        size_t last_child(size_t i) const { return mEntries[i].next == i + 1 ? i + 1 : mEntries[i].next - 1; }
+
+        //! \brief Get a pointer to the beginning of the document.
+        /*!
+         *  \return A pointer to the character at offset 0, after the byte
+         *          order mark if any.
+         */
+        const_pointer_t data() const { return mBegin; }
+
+        //! \brief Get the characters of an entry.
+        /*!
+         *  \param [in] i The index of the entry.
+         *
+         *  \return A view over the whole token, markup included.
+         */
+        view_t view(size_t i) const
+        {
+            return view_t(mBegin + mEntries[i].first, mBegin + mEntries[i].last);
+        }
+
+        //! \brief Get the name of an element.
+        /*!
+         *  The name is not validated.
+         *
+         *  \param [in] i The index of a start or end tag.
+         *
+         *  \return A view over the name of the element.
+         */
+        view_t name(size_t i) const
+        {
+            const_pointer_t first = mBegin + mEntries[i].first + (mEntries[i].kind == reader_t::end_element ? 2 : 1);
+
+            return view_t(first, scanner_t::find_name_end(first, mBegin + mEntries[i].last));
+        }
+
+        //! \brief Get the error code.
+        /*!
+         *  \return The error found by the last call to \c build(), or \c no_error.
+         */
+        error_t error_code() const { return mError; }
+
+        //! \brief Get the offset of the error.
+        /*!
+         *  \return The offset of the faulty character from the beginning of
+         *          the document, in characters.
+         */
+        size_t offset() const { return mOffset; }
+
+        //! \brief Report a range of entries to a handler.
+        /*!
+         *  Tags, comments, processing instructions and declarations are read
+         *  again with a \c basic_sax_parser, which validates their names and
+         *  attributes. End tags are matched against the start tags of the
+         *  range.
+         *
+         *  \tparam handlerT The type of handler.
+         *
+         *  \param [in]  handler The handler events are reported to.
+         *  \param [in]  first   The index of the first entry to report.
+         *  \param [in]  last    The index past the last entry to report.
+         *  \param [out] where   If not \c nullptr, receives the offset of the
+         *                       faulty character when an error is found.
+         *
+         *  \return \c reader_t::end_document if all the entries have been
+         *          reported, \c reader_t::error if one of them is not
+         *          well-formed, or the last token read if the handler
+         *          stopped.
+         */
+        template <class handlerT>
+        token_t replay(handlerT& handler, size_t first, size_t last, size_t* where = nullptr) const
+        {
+            parser_t parser(mBegin, mBegin);
+            std::vector<view_t> names;
+
+            for (size_t i = first; i < last; ++i) {
+                const entry_t& entry = mEntries[i];
+                const_pointer_t tokenFirst = mBegin + entry.first;
+                const_pointer_t tokenLast  = mBegin + entry.last;
+
+                if (entry.kind == reader_t::text) {
+                    if (!handler.text(view_t(tokenFirst, tokenLast)))
+                        return reader_t::text;
+
+                    continue;
+                }
+
+                if (entry.kind == reader_t::start_element) {
+                    if (entry.next != i + 1)
+                        names.push_back(name(i));
+                } else if (entry.kind == reader_t::end_element) {
+                    if (names.empty() || names.back() != name(i)) {
+                        if (where != nullptr)
+                            *where = entry.first;
+
+                        return reader_t::error;
+                    }
+
+                    names.pop_back();
+                }
+
+                const bool prolog = entry.kind == reader_t::declaration || entry.kind == reader_t::doctype;
+
+                parser.reset(tokenFirst, tokenLast, prolog ? reader_t::parse_default : reader_t::parse_fragment);
+
+                const token_t token = parser.parse(handler);
+
+                if (token == reader_t::error) {
+                    if (prolog && parser.error_code() == reader_t::no_root)
+                        continue;
+
+                    if (where != nullptr)
+                        *where = entry.first + parser.offset();
+
+                    return token;
+                }
+
+                if (token != reader_t::end_document)
+                    return token;
+            }
+
+            return reader_t::end_document;
+        }
+
+        //! \brief Build the whole document.
+        /*!
+         *  \param [in] reference Whether the nodes reference the indexed
+         *                        buffer, which must then outlive the document.
+         *
+         *  \throw exception_t If the document is not well-formed.
+         *
+         *  \return The document.
+         */
+        document_t materialize(bool reference = false) const
+        {
+            builder_t builder(reference);
+            size_t where = 0;
+
+            if (replay(builder, 0, size(), &where) != reader_t::end_document)
+                raise(builder.error() ? builder.error() : "malformed XML document", builder.error_code(), where);
+
+            return builder.release();
+        }
+
+        //! \brief Build the subtree of an element.
+        /*!
+         *  Its prefixes are not resolved, since the namespace declarations
+         *  may belong to its ancestors.
+         *
+         *  \param [in] i         The index of the start tag of the element.
+         *  \param [in] reference Whether the nodes reference the indexed
+         *                        buffer, which must then outlive the element.
+         *
+         *  \throw exception_t If the element is not well-formed.
+         *
+         *  \return The element, without parent.
+         */
+        element_t materialize_element(size_t i, bool reference = false) const
+        {
+            builder_t builder(reference, reader_t::parse_no_namespaces);
+            size_t where = 0;
+
+            if (replay(builder, i, next(i), &where) != reader_t::end_document)
+                raise(builder.error() ? builder.error() : "malformed XML element", builder.error_code(), where);
+
+            document_t document = builder.release();
+
+            return element_t(std::move(document.root()));
+        }
+
+    private:
+        //! The states of the first stage.
+        enum state_t {
+            state_content, //!< Looking for the next tag.
+            state_tag,     //!< Looking for the end of a tag.
+            state_quoted   //!< Looking for the end of an attribute value.
+        };
+
+        //! \brief Reset the index on a new buffer.
+        /*!
+         *  \param [in] first A pointer to the first character of the document.
+         *  \param [in] last  A pointer past the last character of the document.
+         */
+        void clear(const_pointer_t first, const_pointer_t last)
+        {
+            mBegin = first;
+            mEnd   = last;
+
+            if (first != nullptr) {
+                reader_t reader(first, last);
+
+                mBegin = reader.data();
+            }
+
+            mRoot   = npos;
+            mError  = reader_t::no_error;
+            mOffset = 0;
+
+            mEntries.clear();
+            mStack.clear();
+        }
+
+        //! \brief Add an entry.
+        void add(token_t kind, const_pointer_t first, const_pointer_t last)
+        {
+            const size_t i = mEntries.size();
+            const entry_t entry = { kind, static_cast<size_t>(first - mBegin), static_cast<size_t>(last - mBegin), i + 1 };
+
+            mEntries.push_back(entry);
+        }
+
+        //! \brief Add the character data found in between two tokens.
+        /*!
+         *  Outside of the root element, only white spaces are accepted and
+         *  no entry is added.
+         *
+         *  \return \c false if an error has been found.
+         */
+        bool addText(const_pointer_t first, const_pointer_t last)
+        {
+            if (first == last)
+                return true;
+
+            if (mStack.empty()) {
+                if (!scanner_t::all_whitespace(first, last))
+                    return fail(reader_t::text_outside_root, scanner_t::skip_whitespace(first, last));
+
+                return true;
+            }
+
+            add(reader_t::text, first, last);
+
+            return true;
+        }
+
+        //! \brief Add a start tag, an empty element tag or an end tag.
+        /*!
+         *  \param [in] first A pointer to the \c '<' of the tag.
+         *  \param [in] last  A pointer past the \c '>' of the tag.
+         *
+         *  \return \c false if an error has been found.
+         */
+        bool addTag(const_pointer_t first, const_pointer_t last)
+        {
+            if (first[1] == '/') {
+                if (mStack.empty())
+                    return fail(reader_t::mismatched_tag, first);
+
+                add(reader_t::end_element, first, last);
+
+                mEntries[mStack.back()].next = mEntries.size();
+                mStack.pop_back();
+
+                return true;
+            }
+
+            if (mStack.empty()) {
+                if (mRoot != npos)
+                    return fail(reader_t::multiple_roots, first);
+
+                mRoot = mEntries.size();
+            }
+
+            add(reader_t::start_element, first, last);
+
+            if (last[-2] != '/')
+                mStack.push_back(mEntries.size() - 1);
+
+            return true;
+        }
+
+        //! \brief Add a comment, a CDATA section, a processing instruction or a declaration.
+        /*!
+         *  \param [in] first A pointer to the \c '<' of the token.
+         *
+         *  \return A pointer past the token, or \c nullptr if an error has
+         *          been found.
+         */
+        const_pointer_t addMarkup(const_pointer_t first)
+        {
+            if (first == mBegin && mEnd - first > 5 &&
+                view_t(first, first + 5).equals("<?xml") && scanner_t::is_whitespace(first[5])) {
+                const_pointer_t cursor = first + 5;
+
+                for (;;) {
+                    cursor = scanner_t::find(cursor, mEnd, '?');
+
+                    if (mEnd - cursor < 2) {
+                        fail(reader_t::unexpected_end, mEnd);
+                        return nullptr;
+                    }
+
+                    if (cursor[1] == '>')
+                        break;
+
+                    ++cursor;
+                }
+
+                reader_t reader(first, mEnd);
+
+                if (reader.next() == reader_t::declaration)
+                    while (reader.next() == reader_t::attribute);
+
+                if (reader.error_code() == reader_t::invalid_encoding) {
+                    fail(reader_t::invalid_encoding, first + reader.offset());
+                    return nullptr;
+                }
+
+                if (reader.checks_encoding()) {
+                    const char* begin   = reinterpret_cast<const char*>(cursor + 2);
+                    const char* invalid = utf8::validate(begin, reinterpret_cast<const char*>(mEnd));
+
+                    if (invalid != reinterpret_cast<const char*>(mEnd)) {
+                        fail(reader_t::invalid_encoding, cursor + 2 + (invalid - begin));
+                        return nullptr;
+                    }
+                }
+
+                add(reader_t::declaration, first, cursor + 2);
+
+                return cursor + 2;
+            }
+
+            reader_t reader(first, mEnd, reader_t::parse_fragment);
+
+            const token_t token = reader.next();
+
+            if (token == reader_t::error) {
+                fail(reader.error_code(), first + reader.offset());
+                return nullptr;
+            }
+
+            if (token == reader_t::cdata && mStack.empty()) {
+                fail(reader_t::invalid_tag, first);
+                return nullptr;
+            }
+
+            if (token == reader_t::doctype && mRoot != npos) {
+                fail(reader_t::invalid_doctype, first);
+                return nullptr;
+            }
+
+            add(token, first, reader.position());
+
+            return reader.position();
+        }
+
+        //! \brief Record an error.
+        /*!
+         *  \param [in] code  The error code.
+         *  \param [in] where A pointer to the faulty character.
+         *
+         *  \return \c false.
+         */
+        bool fail(error_t code, const_pointer_t where)
+        {
+            mError  = code;
+            mOffset = where - mBegin;
+
+            return false;
+        }
+
+        //! \brief Throw an exception describing an error.
+        /*!
+         *  \param [in] what   A description of the error.
+         *  \param [in] code   The error code.
+         *  \param [in] offset The offset of the faulty character.
+         *  \param [in] source The owner of the indexed characters, or \c nullptr.
+         *
+         *  \throw exception_t Always.
+         */
+        void raise(const char* what, error_t code, size_t offset, std::shared_ptr<const void> source = nullptr) const
+        {
+            throw exception_t(parse_error_t(what, code, offset), mBegin, std::move(source));
+        }
+
+        std::vector<entry_t> mEntries; //!< The entries, in document order.
+        std::vector<size_t>  mStack;   //!< The indices of the start tags currently open.
+
+        const_pointer_t mBegin; //!< A pointer to the first character of the document.
+        const_pointer_t mEnd;   //!< A pointer past the last character of the document.
+
+        size_t  mRoot;   //!< The index of the root element.
+        error_t mError;  //!< The error found in the document.
+        size_t  mOffset; //!< The offset of the error.
+    };
+
+    template <typename charT>
+    const size_t basic_structural_index<charT>::npos;
+
+    typedef basic_structural_index<char>    structural_index;  //!< A specialized \c basic_structural_index for char.
+    typedef basic_structural_index<wchar_t> wstructural_index; //!< A specialized \c basic_structural_index for wchar_t.
+}
+
+#endif /* STRUCTURAL_INDEX_H_INCLUDED */
@@ -6,11 +6,14 @@
 
 #include <parent-node.h>
 #include <child-node.h>
+#include <typed-string.h>
 
 namespace xml {
     //! \brief A XML text node.
     /*!
-     *  This class represents a XML text node.
+     *  This class represents a XML text node. When the document is
+     *  annotated by a schema, the only text of an element with simple
+     *  content also holds the typed value of the element.
      *
      *  \tparam charT The type of character used in the XML node.
      *                By default, char and wchar_t are supported.
@@ -36,7 +39,9 @@ namespace xml {
         typedef const text_t&     text_const_reference_t; //!< Constant reference to \c text_t.
         typedef text_t&&          text_move_t;            //!< Move a \c text_t.
 
-        typedef std::basic_string<charT> string_t; //!< The type of string stored.
+        typedef std::basic_string<charT>  string_t;       //!< The owning string type.
+        typedef basic_string_ref<charT>   string_ref_t;   //!< The type of string given.
+        typedef basic_typed_string<charT> typed_string_t; //!< The type of string stored.
 
         //!@}
 
@@ -49,11 +54,11 @@ namespace xml {
          *  \param [in] parent The parent node of this \c text_t.
          */
         basic_text(
-            string_t data,
+            string_ref_t data,
             parent_pointer_t parent = nullptr)
         :
             child_t(parent),
-            mData(data)
+            mData(std::move(data))
         {}
 
         //! \brief Copy constructor.
@@ -98,6 +103,15 @@ namespace xml {
             return node_interface_t::stringToType("text");
         }
 
+        //! \brief Get the kind of a \c text_t.
+        /*!
+         *  \return \c node_interface_t::text_kind.
+         */
+        virtual typename node_interface_t::kind_t kind() const
+        {
+            return node_interface_t::text_kind;
+        }
+
         //! \brief Clone the current \c basic_child_node.
         /*!
          *  This function creates a deep copy of this \c basic_child_node,
@@ -124,22 +138,45 @@ namespace xml {
         /*!
          *  \return A constant reference to text content.
          */
-        const string_t& data() const
+        const typed_string_t& data() const
         {
             return mData;
         }
 
         //! \brief Get text content.
         /*!
+         *  Content referencing the source of the document is copied when it
+         *  is modified, and its typed value is dropped.
+         *
          *  \return A reference to text content.
          */
-        string_t& data()
+        typed_string_t& data()
         {
             return mData;
         }
 
+        //! \brief Get the typed value of the text.
+        /*!
+         *  \return The value of the parent element converted by the last
+         *          schema annotation of the document, or an \c untyped value.
+         */
+        const typed_value& typed() const
+        {
+            return mData.typed();
+        }
+
+        //! \brief Get the typed value of the text.
+        /*!
+         *  \return A reference to the typed value, set by the schema
+         *          annotation of the document.
+         */
+        typed_value& typed()
+        {
+            return mData.annotation();
+        }
+
     private:
-        string_t mData; //!< The content of a \c basic_text object.
+        typed_string_t mData; //!< The content of a \c basic_text object, and the typed value of its element if it is its only text.
     };
 
     typedef basic_text<char>    text;  //!< A specialized \c basic_text for char.
@@ -0,0 +1,154 @@
+#ifndef TYPED_STRING_H_INCLUDED
+#define TYPED_STRING_H_INCLUDED
+
+#include <string>
+#include <utility>
+
+#include <string-ref.h>
+#include <typed-value.h>
+
+namespace xml {
+    //! \brief A string with the typed value of its characters.
+    /*!
+     *  This class stores the values of the attributes and the texts. It
+     *  is a \c basic_string_ref that also holds the value converted from
+     *  its characters by the schema annotation of the document. The typed
+     *  value is dropped when the characters are modified, through
+     *  \c modify() or an assignment : getting a reference to the string
+     *  without modifying it keeps the typed value.
+     *
+     *  The typed value is not part of the string : it is mutable, so that
+     *  it can be set on constant strings, such as the values of the
+     *  attributes of a set.
+     *
+     *  \tparam charT The type of character used in the string.
+     *                By default, char and wchar_t are supported.
+     */
+    template <typename charT>
+    class basic_typed_string : public basic_string_ref<charT> {
+    public:
+        //! \name Member types
+        //!@{
+        typedef          basic_string_ref<charT>  string_ref_t; //!< The base string type.
+        typedef typename string_ref_t::string_t   string_t;     //!< The owning string type.
+
+        typedef basic_typed_string<charT> typed_string_t;                 //!< The type of typed string.
+        typedef const typed_string_t&     typed_string_const_reference_t; //!< Constant reference to \c typed_string_t.
+        typedef typed_string_t&&          typed_string_move_t;            //!< Move a \c typed_string_t.
+
+        //!@}
+
+        //! \brief Constructor.
+        /*!
+         *  Builds an \c untyped string.
+         *
+         *  \param [in] str The characters of the string.
+         */
+        basic_typed_string(string_ref_t str = string_ref_t())
+        :
+            string_ref_t(std::move(str)),
+            mTyped()
+        {}
+
+        //! \brief Copy constructor.
+        /*!
+         *  Builds an owned copy of the characters of \c rhs, with its
+         *  typed value.
+         *
+         *  \param [in] rhs A constant reference to a \c typed_string_t.
+         */
+        basic_typed_string(typed_string_const_reference_t rhs) = default;
+
+        //! \brief Move constructor.
+        /*!
+         *  Takes the place of \c rhs, keeping its reference and its typed
+         *  value.
+         *
+         *  \param [in] rhs A rvalue reference to a \c typed_string_t.
+         */
+        basic_typed_string(typed_string_move_t rhs) = default;
+
+        //! \brief Copy assignment.
+        /*!
+         *  The typed value of \c rhs is not copied : the string has to be
+         *  annotated again.
+         *
+         *  \param [in] rhs A constant reference to a \c typed_string_t.
+         *
+         *  \return A reference to this string.
+         */
+        typed_string_t& operator=(typed_string_const_reference_t rhs)
+        {
+            string_ref_t::operator=(rhs);
+            mTyped = typed_value();
+
+            return *this;
+        }
+
+        //! \brief Move assignment.
+        /*!
+         *  \param [in] rhs A rvalue reference to a \c typed_string_t.
+         *
+         *  \return A reference to this string.
+         */
+        typed_string_t& operator=(typed_string_move_t rhs)
+        {
+            string_ref_t::operator=(std::move(rhs));
+            mTyped = typed_value();
+
+            return *this;
+        }
+
+        //! \brief Assign new characters, as the assignments of \c string_ref_t.
+        /*!
+         *  \param [in] rhs The new characters.
+         *
+         *  \return A reference to this string.
+         */
+        template <typename T>
+        typed_string_t& operator=(T&& rhs)
+        {
+            string_ref_t::operator=(std::forward<T>(rhs));
+            mTyped = typed_value();
+
+            return *this;
+        }
+
+        //! \brief Get a modifiable string.
+        /*!
+         *  The typed value is dropped, since the characters may be modified.
+         *
+         *  \return A reference to the owned string.
+         */
+        string_t& modify()
+        {
+            mTyped = typed_value();
+
+            return string_ref_t::modify();
+        }
+
+        //! \brief Get the typed value of the string.
+        /*!
+         *  \return The value converted by the last schema annotation of the
+         *          document, or an \c untyped value.
+         */
+        const typed_value& typed() const
+        {
+            return mTyped;
+        }
+
+        //! \brief Get the typed value of the string, to annotate it.
+        /*!
+         *  \return A reference to the typed value.
+         */
+        typed_value& annotation() const
+        {
+            return mTyped;
+        }
+
+    private:
+        mutable typed_value mTyped; //!< The typed value of the characters.
+    };
+}
+
+#endif /* TYPED_STRING_H_INCLUDED */
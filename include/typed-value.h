@@ -0,0 +1,140 @@
+#ifndef TYPED_VALUE_H_INCLUDED
+#define TYPED_VALUE_H_INCLUDED
+
+#include <cstdint>
+
+namespace xml {
+    //! \brief The typed value of an attribute or a text.
+    /*!
+     *  This class holds the value of an attribute or of the text of an
+     *  element with simple content, converted once by the schema
+     *  validation from its lexical form : reading it again does not parse
+     *  any string.
+     *
+     *  Booleans, integers, floating point numbers, dates and times are
+     *  converted. Integers are exact in the range of \c int64_t, and
+     *  other decimals are held as \c double. Dates and times are held as
+     *  a number of microseconds : since 1970-01-01T00:00:00Z for
+     *  \c dateTime and \c date values, and since midnight for \c time
+     *  values, normalized to UTC when they have a time zone. Values of
+     *  other types are \c untyped.
+     *
+     *  The accessors are defined in the header, so that reading a typed
+     *  value costs no more than reading a member.
+     */
+    class typed_value {
+    public:
+        //! The types of values.
+        enum type_t : uint8_t {
+            untyped,       //!< No converted value.
+            boolean_type,  //!< \c xs:boolean.
+            integer_type,  //!< \c xs:integer and its derived types, within the range of \c int64_t.
+            decimal_type,  //!< \c xs:decimal, and integers out of the range of \c int64_t.
+            float_type,    //!< \c xs:float.
+            double_type,   //!< \c xs:double.
+            datetime_type, //!< \c xs:dateTime.
+            date_type,     //!< \c xs:date.
+            time_type      //!< \c xs:time.
+        };
+
+        //! \brief Constructor.
+        /*!
+         *  Builds an \c untyped value.
+         */
+        typed_value()
+        :
+            mInteger(0),
+            mType(untyped),
+            mTimezone(false)
+        {}
+
+        //! \brief Build a boolean value.
+        static typed_value from_boolean(bool value);
+
+        //! \brief Build an integer value.
+        static typed_value from_integer(int64_t value);
+
+        //! \brief Build a number.
+        /*!
+         *  \param [in] type  \c decimal_type, \c float_type or \c double_type.
+         *  \param [in] value The value.
+         */
+        static typed_value from_number(type_t type, double value);
+
+        //! \brief Build a date, a time, or both.
+        /*!
+         *  The fields are those of a valid lexical form. A date without
+         *  time has \c hour, \c minute and \c microsecond set to 0, and a
+         *  time without date has \c year, \c month and \c day set to 1970,
+         *  1 and 1.
+         *
+         *  \param [in] type        \c datetime_type, \c date_type or \c time_type.
+         *  \param [in] year        The year, that may be negative.
+         *  \param [in] month       The month, from 1.
+         *  \param [in] day         The day of the month, from 1.
+         *  \param [in] hour        The hour, up to 24.
+         *  \param [in] minute      The minute.
+         *  \param [in] microsecond The microseconds in the minute.
+         *  \param [in] timezone    Whether the value has a time zone.
+         *  \param [in] offset      The offset of the time zone from UTC, in minutes.
+         */
+        static typed_value from_time(type_t type, int64_t year, unsigned month, unsigned day,
+                                     unsigned hour, unsigned minute, int64_t microsecond,
+                                     bool timezone, int offset);
+
+        //! \brief Get the type of the value.
+        type_t type() const { return mType; }
+
+        //! \brief Whether a value has been converted.
+        bool typed() const { return mType != untyped; }
+
+        //! \brief Get a boolean value.
+        /*!
+         *  \return The value, or \c false if it is not a boolean.
+         */
+        bool as_boolean() const { return mType == boolean_type && mInteger != 0; }
+
+        //! \brief Get an integer value.
+        /*!
+         *  \return The value, or \c 0 if it is not an integer.
+         */
+        int64_t as_integer() const { return mType == integer_type ? mInteger : 0; }
+
+        //! \brief Get a numeric value.
+        /*!
+         *  Integers are converted to \c double.
+         *
+         *  \return The value, or \c 0 if it is not a number.
+         */
+        double as_double() const
+        {
+            return mType == integer_type ? static_cast<double>(mInteger) :
+                   mType == decimal_type || mType == float_type || mType == double_type ? mNumber : 0;
+        }
+
+        //! \brief Get a date or time value.
+        /*!
+         *  \return The number of microseconds since the epoch, or since
+         *          midnight for a \c time, or \c 0 if the value is not a
+         *          date or a time.
+         */
+        int64_t as_time() const
+        {
+            return mType == datetime_type || mType == date_type || mType == time_type ? mInteger : 0;
+        }
+
+        //! \brief Whether a date or time value has a time zone.
+        bool has_timezone() const { return mTimezone; }
+
+    private:
+        union {
+            int64_t mInteger; //!< The value of booleans, integers, dates and times.
+            double  mNumber;  //!< The value of other numbers.
+        };
+
+        type_t mType;     //!< The type of the value.
+        bool   mTimezone; //!< Whether a date or time has a time zone.
+    };
+}
+
+#endif /* TYPED_VALUE_H_INCLUDED */
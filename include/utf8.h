@@ -0,0 +1,132 @@
+#ifndef UTF8_H_INCLUDED
+#define UTF8_H_INCLUDED
+
+#include <cstddef>
+
+namespace xml {
+    //! \brief UTF-8 validation functions.
+    /*!
+     *  This class checks that a buffer holds well-formed UTF-8, as defined
+     *  by RFC 3629 : overlong forms, surrogates, code points above U+10FFFF
+     *  and truncated sequences are rejected.
+     *
+     *  With AVX2, blocks of 64 ASCII bytes are skipped with a single test,
+     *  and the other blocks are checked 32 bytes at a time with the lookup
+     *  algorithm of Keiser and Lemire, which classifies each pair of
+     *  consecutive bytes with three nibble tables. With SSSE3, the same
+     *  algorithm checks blocks of 32 bytes, 16 bytes at a time. When the
+     *  library is not built for AVX2, both versions are built with GCC or
+     *  Clang and the one matching the processor is selected at run time.
+     *  With SSE2 only, blocks of 32 ASCII bytes are skipped, and the other
+     *  blocks are checked one sequence at a time.
+     *
+     *  This class also converts UTF-8 to and from the encodings of the
+     *  wider character types : UTF-16 for \c char16_t, UTF-32 for
+     *  \c char32_t, and either of them for \c wchar_t depending on its
+     *  size. Runs of ASCII are converted 16 characters at a time with
+     *  SSE2, by widening or narrowing whole registers. With SSSE3 or AVX2,
+     *  selected at run time like the validator, the 2 and 3 bytes
+     *  sequences are converted by kernels too : the characters are
+     *  computed in the lane of each leading byte or character, and
+     *  shuffles indexed by the lengths of the sequences gather them. The
+     *  encoding kernels also write the surrogate pairs of UTF-16, and the
+     *  decoding ones leave the blocks holding 4 bytes sequences to the
+     *  conversion of one sequence at a time.
+     */
+    class utf8 {
+    public:
+        //! \brief Find the first invalid sequence of a buffer.
+        /*!
+         *  \param [in] first A pointer to the first byte of the buffer.
+         *  \param [in] last  A pointer past the last byte of the buffer.
+         *
+         *  \return A pointer to the first byte of the first invalid or
+         *          truncated sequence, or \c last if the buffer is valid.
+         */
+        static const char* validate(const char* first, const char* last);
+
+        //! \brief Find a sequence cut by the end of a buffer.
+        /*!
+         *  This function allows to validate a document split in several
+         *  buffers : the bytes it points to are kept and validated with the
+         *  beginning of the next buffer.
+         *
+         *  \param [in] first A pointer to the first byte of the buffer.
+         *  \param [in] last  A pointer past the last byte of the buffer.
+         *
+         *  \return A pointer to the leading byte of the last sequence if it
+         *          needs more bytes than the buffer holds, \c last otherwise.
+         */
+        static const char* truncated(const char* first, const char* last);
+
+        //! \brief Get the length of a sequence from its leading byte.
+        /*!
+         *  \param [in] lead The first byte of a sequence.
+         *
+         *  \return The number of bytes of the sequence, or 0 if \c lead is
+         *          a continuation byte or cannot start a sequence.
+         */
+        static size_t length(char lead);
+
+        //! \brief Convert UTF-8 to the encoding of a character type.
+        /*!
+         *  The input must have been validated with \c validate(). The
+         *  output buffer must hold at least as many characters as there are
+         *  bytes in the input. With \c char, the bytes are copied.
+         *
+         *  \param [in]  first A pointer to the first byte of the input.
+         *  \param [in]  last  A pointer past the last byte of the input.
+         *  \param [out] out   A pointer to the first character of the output.
+         *
+         *  \return A pointer past the last character written.
+         */
+        static char*     decode(const char* first, const char* last, char*     out);
+        static char16_t* decode(const char* first, const char* last, char16_t* out); //!< \copydoc decode(const char*, const char*, char*)
+        static char32_t* decode(const char* first, const char* last, char32_t* out); //!< \copydoc decode(const char*, const char*, char*)
+        static wchar_t*  decode(const char* first, const char* last, wchar_t*  out); //!< \copydoc decode(const char*, const char*, char*)
+
+        //! \brief Convert characters to UTF-8.
+        /*!
+         *  Unpaired surrogates and values above U+10FFFF are replaced with
+         *  U+FFFD. The output buffer must hold at least 3 bytes per UTF-16
+         *  character and 4 bytes per UTF-32 character. With \c char, the
+         *  bytes are copied.
+         *
+         *  \param [in]  first A pointer to the first character of the input.
+         *  \param [in]  last  A pointer past the last character of the input.
+         *  \param [out] out   A pointer to the first byte of the output.
+         *
+         *  \return A pointer past the last byte written.
+         */
+        static char* encode(const char*     first, const char*     last, char* out);
+        static char* encode(const char16_t* first, const char16_t* last, char* out); //!< \copydoc encode(const char*, const char*, char*)
+        static char* encode(const char32_t* first, const char32_t* last, char* out); //!< \copydoc encode(const char*, const char*, char*)
+        static char* encode(const wchar_t*  first, const wchar_t*  last, char* out); //!< \copydoc encode(const char*, const char*, char*)
+
+        //! \brief Whether an encoding name designates UTF-8.
+        /*!
+         *  Encoding names are case-insensitive.
+         *
+         *  \param [in] first A pointer to the first character of the name.
+         *  \param [in] last  A pointer past the last character of the name.
+         *
+         *  \return \c true if the name is \c "UTF-8", \c false otherwise.
+         */
+        template <typename charT>
+        static bool is_utf8(const charT* first, const charT* last)
+        {
+            static const char name[] = "utf-8";
+
+            if (last - first != sizeof(name) - 1)
+                return false;
+
+            for (const char* c = name; first != last; ++first, ++c)
+                if (*first != static_cast<charT>(*c) && (*c < 'a' || *first != static_cast<charT>(*c - 'a' + 'A')))
+                    return false;
+
+            return true;
+        }
+    };
+}
+
+#endif /* UTF8_H_INCLUDED */
@@ -0,0 +1,305 @@
+#ifndef XPATH_CACHE_H_INCLUDED
+#define XPATH_CACHE_H_INCLUDED
+
+#include <list>
+#include <mutex>
+#include <memory>
+#include <chrono>
+#include <vector>
+#include <iterator>
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <cstdint>
+#include <unordered_map>
+
+#include <xpath.h>
+
+namespace xml {
+    //! \brief A cache of compiled XPath expressions.
+    /*!
+     *  This class maps the text of an expression and the namespaces bound
+     *  to its prefixes to the compiled expression, so that an expression
+     *  built at run time is only compiled the first time it is seen.
+     *  Compiled expressions are immutable, and shared by all the threads
+     *  asking for them.
+     *
+     *  The entries are spread over shards by the hash of their key, each
+     *  shard having its own lock and its own least recently used list :
+     *  lookups of different expressions rarely wait for each other, and a
+     *  shard that is full evicts its least recently used entry. A missing
+     *  expression is compiled without holding the lock. Expressions that
+     *  fail to compile are not cached.
+     *
+     *  \c instance() is a cache shared by the whole process.
+     *
+     *  \sa xml::basic_xpath_expression
+     *
+     *  \tparam charT The type of character used in the expressions.
+     *                By default, char and wchar_t are supported.
+     */
+    template <typename charT>
+    class basic_xpath_cache {
+    public:
+        //! \name Member types
+        //!@{
+        typedef          basic_xpath_expression<charT>        expression_t;         //!< The compiled expression type.
+        typedef typename expression_t::expression_pointer_t   expression_pointer_t; //!< A shared pointer to a compiled expression.
+        typedef typename expression_t::bindings_t             bindings_t;           //!< The namespace URI bound to each prefix of an expression.
+        typedef typename expression_t::result_t               result_t;             //!< The result of a compilation that does not throw.
+        typedef typename expression_t::exception_t            exception_t;          //!< The type of exception thrown on compilation errors.
+        typedef typename expression_t::view_t                 view_t;               //!< The type of views of strings.
+        typedef typename expression_t::string_t               string_t;             //!< The string type.
+
+        //!@}
+
+        //! \brief The counters of a cache.
+        class statistics_t {
+        public:
+            uint64_t hits;         //!< The number of lookups that found their expression.
+            uint64_t misses;       //!< The number of lookups that compiled their expression.
+            uint64_t failures;     //!< The number of expressions that did not compile.
+            uint64_t evictions;    //!< The number of entries evicted to make room for others.
+            uint64_t compile_time; //!< The time spent compiling expressions, in nanoseconds.
+            size_t   size;         //!< The number of cached expressions.
+        };
+
+        static const size_t default_capacity = 1024; //!< The default number of cached expressions.
+        static const size_t default_shards   = 16;   //!< The default number of shards.
+
+        //! \brief Constructor.
+        /*!
+         *  \param [in] capacity The maximum number of cached expressions.
+         *  \param [in] shards   The number of independently locked shards.
+         *                       There are no more shards than entries.
+         */
+        explicit basic_xpath_cache(size_t capacity = default_capacity, size_t shards = default_shards)
+        :
+            mShards(std::max<size_t>(1, std::min(shards, capacity))),
+            mCapacity(std::max<size_t>(1, capacity / mShards.size()))
+        {}
+
+        basic_xpath_cache(const basic_xpath_cache&) = delete;
+        basic_xpath_cache& operator=(const basic_xpath_cache&) = delete;
+
+        //! \brief Get the cache shared by the process.
+        /*!
+         *  It holds up to \c default_capacity expressions.
+         */
+        static basic_xpath_cache& instance()
+        {
+            static basic_xpath_cache cache;
+
+            return cache;
+        }
+
+        //! \brief Get a compiled expression, compiling it if it is not cached.
+        /*!
+         *  \param [in] expression The text of the expression.
+         *  \param [in] namespaces The namespace URI bound to each prefix used in the expression.
+         *
+         *  \return The compiled expression, or the error that stopped its compilation.
+         */
+        result_t try_compile(const view_t& expression, const bindings_t& namespaces = bindings_t())
+        {
+            const size_t hash  = key(expression, namespaces);
+            shard_t&     shard = mShards[hash % mShards.size()];
+
+            {
+                std::lock_guard<std::mutex> lock(shard.mutex);
+
+                if (expression_pointer_t found = find(shard, hash, expression, namespaces)) {
+                    ++shard.hits;
+
+                    return result_t(std::move(found));
+                }
+            }
+
+            const std::chrono::steady_clock::time_point start  = std::chrono::steady_clock::now();
+            result_t                                     result = expression_t::try_compile(expression, namespaces);
+            const uint64_t                               time   = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+            std::lock_guard<std::mutex> lock(shard.mutex);
+
+            ++shard.misses;
+            shard.time += time;
+
+            if (!result) {
+                ++shard.failures;
+
+                return result;
+            }
+
+            if (expression_pointer_t found = find(shard, hash, expression, namespaces))
+                return result_t(std::move(found));
+
+            shard.entries.push_front(entry_t { hash, namespaces, result.value() });
+            shard.index.emplace(hash, shard.entries.begin());
+
+            if (shard.entries.size() > mCapacity) {
+                typename list_t::iterator last = std::prev(shard.entries.end());
+                auto                      range = shard.index.equal_range(last->hash);
+
+                for (auto it = range.first; it != range.second; ++it)
+                    if (it->second == last) {
+                        shard.index.erase(it);
+                        break;
+                    }
+
+                shard.entries.erase(last);
+                ++shard.evictions;
+            }
+
+            return result;
+        }
+
+        //! \brief Get a compiled expression, compiling it if it is not cached.
+        /*!
+         *  \param [in] expression The text of the expression.
+         *  \param [in] namespaces The namespace URI bound to each prefix used in the expression.
+         *
+         *  \return The compiled expression.
+         *
+         *  The exception owns a copy of the text of the expression, which
+         *  may not outlive the call. Without exception support, the program
+         *  is aborted if the expression does not compile : only
+         *  \c try_compile() reports errors then.
+         *
+         *  \throw exception_t If the expression does not compile.
+         */
+        expression_pointer_t compile(const view_t& expression, const bindings_t& namespaces = bindings_t())
+        {
+            result_t result = try_compile(expression, namespaces);
+
+            if (!result) {
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS)
+                const std::shared_ptr<string_t> source = std::make_shared<string_t>(expression.data(), expression.size());
+
+                throw exception_t(result.error(), source->data(), source);
+#else
+                std::abort();
+#endif
+            }
+
+            return std::move(result.value());
+        }
+
+        //! \brief Get the counters of the cache.
+        /*!
+         *  The counters of each shard are read under its lock : they are
+         *  consistent for each shard, not for the whole cache.
+         */
+        statistics_t statistics() const
+        {
+            statistics_t total = statistics_t();
+
+            for (const shard_t& shard : mShards) {
+                std::lock_guard<std::mutex> lock(shard.mutex);
+
+                total.hits         += shard.hits;
+                total.misses       += shard.misses;
+                total.failures     += shard.failures;
+                total.evictions    += shard.evictions;
+                total.compile_time += shard.time;
+                total.size         += shard.entries.size();
+            }
+
+            return total;
+        }
+
+        //! \brief Get the maximum number of cached expressions.
+        size_t capacity() const { return mCapacity * mShards.size(); }
+
+        //! \brief Remove all the cached expressions.
+        /*!
+         *  The counters are kept. Expressions handed out stay valid.
+         */
+        void clear()
+        {
+            for (shard_t& shard : mShards) {
+                std::lock_guard<std::mutex> lock(shard.mutex);
+
+                shard.index.clear();
+                shard.entries.clear();
+            }
+        }
+
+    private:
+        //! \brief A cached expression.
+        class entry_t {
+        public:
+            size_t               hash;       //!< The hash of the key of the entry.
+            bindings_t           namespaces; //!< The namespaces the expression was compiled with.
+            expression_pointer_t expression; //!< The compiled expression, that holds its text.
+        };
+
+        typedef std::list<entry_t> list_t; //!< The entries, from the most to the least recently used.
+
+        //! \brief A part of the cache, with its own lock.
+        class shard_t {
+        public:
+            shard_t()
+            :
+                mutex(),
+                entries(),
+                index(),
+                hits(0),
+                misses(0),
+                failures(0),
+                evictions(0),
+                time(0)
+            {}
+
+            mutable std::mutex                                         mutex;     //!< Protects the shard.
+            list_t                                                     entries;   //!< The entries, most recently used first.
+            std::unordered_multimap<size_t, typename list_t::iterator> index;     //!< The entries, by hash of their key.
+            uint64_t                                                   hits;      //!< The lookups that found their expression.
+            uint64_t                                                   misses;    //!< The lookups that compiled their expression.
+            uint64_t                                                   failures;  //!< The expressions that did not compile.
+            uint64_t                                                   evictions; //!< The evicted entries.
+            uint64_t                                                   time;      //!< The time spent compiling, in nanoseconds.
+        };
+
+        //! \brief Hash the text and the namespaces of an expression.
+        static size_t key(const view_t& expression, const bindings_t& namespaces)
+        {
+            size_t hash = expression.hash();
+
+            for (const std::pair<string_t, string_t>& binding : namespaces)
+                hash = ((hash * 31 + view_t(binding.first).hash()) * 31) + view_t(binding.second).hash();
+
+            return hash;
+        }
+
+        //! \brief Find an expression in a shard, and mark it as the most recently used.
+        /*!
+         *  The lock of the shard must be held.
+         *
+         *  \return The expression, or an empty pointer.
+         */
+        static expression_pointer_t find(shard_t& shard, size_t hash, const view_t& expression, const bindings_t& namespaces)
+        {
+            auto range = shard.index.equal_range(hash);
+
+            for (auto it = range.first; it != range.second; ++it) {
+                const entry_t& entry = *it->second;
+
+                if (view_t(entry.expression->str()) == expression && entry.namespaces == namespaces) {
+                    shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+
+                    return entry.expression;
+                }
+            }
+
+            return expression_pointer_t();
+        }
+
+        std::vector<shard_t> mShards;   //!< The shards.
+        size_t               mCapacity; //!< The maximum number of entries of each shard.
+    };
+
+    typedef basic_xpath_cache<char>    xpath_cache;  //!< A specialized \c basic_xpath_cache for char.
+    typedef basic_xpath_cache<wchar_t> wxpath_cache; //!< A specialized \c basic_xpath_cache for wchar_t.
+}
+
+#endif /* XPATH_CACHE_H_INCLUDED */
@@ -0,0 +1,607 @@
+#ifndef XPATH_STREAM_H_INCLUDED
+#define XPATH_STREAM_H_INCLUDED
+
+#include <deque>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+#include <stdexcept>
+#include <functional>
+
+#include <sax.h>
+#include <arena.h>
+#include <entity-decoder.h>
+#include <namespace-table.h>
+#include <xpath.h>
+
+namespace xml {
+    //! \brief Evaluates a streamable XPath expression on parser events.
+    /*!
+     *  This class is a handler for \c basic_sax_parser and
+     *  \c basic_push_parser, that selects the elements of a streamable
+     *  \c basic_xpath_expression as the document is read, without
+     *  building it. Each selected element is built on its own, with its
+     *  attributes and descendants, and handed to a callback when its end
+     *  tag is read; it is released right after.
+     *
+     *  Each open element only keeps the set of steps of the path it has
+     *  reached, as a bit mask. The subtree of an element that cannot lead
+     *  to a match is skipped without holding its tags, resolving its
+     *  namespaces nor allocating anything. Predicates are checked on the
+     *  start tag, on a stack element whose attributes reference the tag
+     *  buffer.
+     *
+     *  The memory used is bounded by the depth of the document, the size
+     *  of its largest start tag and the size of the largest selected
+     *  element : selected elements are built in a scratch \c arena, which
+     *  is reused for each of them.
+     *
+     *  A selected element nested in another one is part of the fragment
+     *  of the outer element, and is not handed to the callback on its
+     *  own. The namespace identifiers of the fragments refer to the table
+     *  returned by \c namespaces().
+     *
+     *  \sa xml::basic_xpath_expression
+     *  \sa xml::basic_sax_parser
+     *  \sa xml::basic_push_parser
+     *
+     *  \tparam charT The type of character used in the XML document.
+     *                By default, char and wchar_t are supported.
+     */
+    template <typename charT>
+    class basic_xpath_stream : public basic_sax_handler<charT> {
+    public:
+        //! \name Member types
+        //!@{
+        typedef          basic_xpath_expression<charT>        expression_t;         //!< The expression type.
+        typedef typename expression_t::expression_pointer_t   expression_pointer_t; //!< A shared pointer to a compiled expression.
+        typedef typename expression_t::variables_t            variables_t;          //!< The values of the variables.
+        typedef typename expression_t::reader_t               reader_t;             //!< The reader type, whose error codes are used.
+        typedef typename expression_t::table_t                table_t;              //!< The namespace table type.
+        typedef typename expression_t::view_t                 view_t;               //!< The type of names and values.
+        typedef typename expression_t::string_t               string_t;             //!< The string type.
+        typedef typename expression_t::element_t              element_t;            //!< The element type.
+        typedef typename element_t::string_ref_t              string_ref_t;         //!< The type of names and values stored.
+        typedef typename element_t::text_t                    text_t;               //!< The text type.
+        typedef          basic_entity_decoder<charT>          decoder_t;            //!< The reference decoder type.
+        typedef          basic_namespace_scope<charT>         scope_t;              //!< The namespace scope type.
+        typedef typename reader_t::error_t                    error_t;              //!< The type of well-formedness errors.
+        typedef          std::function<bool(const element_t&)> callback_t;          //!< The function selected elements are handed to.
+
+        //!@}
+
+        //! \brief Constructor.
+        /*!
+         *  \param [in] expression The compiled expression.
+         *  \param [in] callback   The function each selected element is
+         *                         handed to, that returns \c false to stop
+         *                         the parsing.
+         *  \param [in] variables  The values of the variables, or \c nullptr.
+         *                         They must outlive the stream.
+         *
+         *  \throw std::invalid_argument If the expression is not streamable.
+         */
+        basic_xpath_stream(expression_pointer_t expression, callback_t callback, const variables_t* variables = nullptr)
+        :
+            mExpression(check(std::move(expression))),
+            mSteps(mExpression->mPaths[mExpression->mExprs[mExpression->mRoot].path].steps),
+            mCallback(std::move(callback)),
+            mTable(intern(*mExpression)),
+            mContext(*mExpression, node_t(), &mTable, variables),
+            mScope(),
+            mPrefixes(),
+            mMarks(),
+            mStates(1, 1),
+            mTag(),
+            mAttributes(),
+            mValue(),
+            mProbeArena(),
+            mProbe(string_ref_t(), mProbeArena),
+            mArena(),
+            mRecord(nullptr),
+            mStack(),
+            mDead(0),
+            mCount(0),
+            mPending(false),
+            mError(reader_t::no_error)
+        {}
+
+        basic_xpath_stream(const basic_xpath_stream&) = delete;
+        basic_xpath_stream& operator=(const basic_xpath_stream&) = delete;
+
+        //! \brief Destructor.
+        /*!
+         *  Releases the element being built, if any.
+         */
+        ~basic_xpath_stream()
+        {
+            release();
+        }
+
+        //! \brief Restart the evaluation for a new document.
+        /*!
+         *  The internal buffers and arenas are kept, so that streaming
+         *  several documents does not allocate memory.
+         */
+        void reset()
+        {
+            release();
+
+            mScope   = scope_t();
+            mDead    = 0;
+            mCount   = 0;
+            mPending = false;
+            mError   = reader_t::no_error;
+
+            mPrefixes.clear();
+            mMarks.clear();
+            mStates.assign(1, 1);
+        }
+
+        //! \brief A start tag.
+        bool start_element(const view_t& name)
+        {
+            if (!flush())
+                return false;
+
+            if (mDead != 0) {
+                ++mDead;
+
+                return true;
+            }
+
+            mTag.assign(name.begin(), name.end());
+            mAttributes.clear();
+            mPending = true;
+
+            return true;
+        }
+
+        //! \brief An attribute of the last start tag.
+        bool attribute(const view_t& name, const view_t& value)
+        {
+            if (mDead != 0)
+                return true;
+
+            const size_t first = mTag.size();
+
+            mTag.append(name.begin(), name.end());
+            mTag.append(value.begin(), value.end());
+
+            charT* const begin = &mTag[first + name.size()];
+            charT* const end   = decoder_t::decode(begin, begin + value.size());
+
+            if (end == nullptr)
+                return fail(reader_t::invalid_reference);
+
+            mTag.resize(end - mTag.data());
+            mAttributes.push_back(attribute_t { first, first + name.size(), mTag.size() });
+
+            return true;
+        }
+
+        //! \brief An end tag, or the end of an empty element tag.
+        bool end_element(const view_t&)
+        {
+            if (!flush())
+                return false;
+
+            if (mDead != 0) {
+                --mDead;
+
+                return true;
+            }
+
+            mScope.pop();
+            mPrefixes.resize(mMarks.back());
+            mMarks.pop_back();
+
+            if (mStack.empty()) {
+                mStates.pop_back();
+
+                return true;
+            }
+
+            mStack.pop_back();
+
+            if (!mStack.empty())
+                return true;
+
+            mStates.pop_back();
+            ++mCount;
+
+            const bool proceed = mCallback(*mRecord);
+
+            release();
+
+            return proceed;
+        }
+
+        //! \brief Character data, whose references are decoded.
+        bool text(const view_t& value)
+        {
+            if (!flush())
+                return false;
+
+            if (mStack.empty())
+                return true;
+
+            mValue.assign(value.begin(), value.end());
+
+            charT* const end = decoder_t::decode(&mValue[0], &mValue[0] + mValue.size());
+
+            if (end == nullptr)
+                return fail(reader_t::invalid_reference);
+
+            mValue.resize(end - mValue.data());
+
+            mStack.back()->adopt_back(make<text_t>(string_ref_t(std::move(mValue))));
+
+            return true;
+        }
+
+        //! \brief A CDATA section.
+        bool cdata(const view_t& value)
+        {
+            if (!flush())
+                return false;
+
+            if (!mStack.empty())
+                mStack.back()->adopt_back(make<text_t>(string_ref_t(value.str())));
+
+            return true;
+        }
+
+        //! \brief A comment.
+        bool comment(const view_t&)
+        {
+            return flush();
+        }
+
+        //! \brief A processing instruction.
+        bool processing_instruction(const view_t&, const view_t&)
+        {
+            return flush();
+        }
+
+        //! \brief Get the number of elements handed to the callback.
+        size_t count() const { return mCount; }
+
+        //! \brief Get the well-formedness error found by the stream.
+        /*!
+         *  \return \c reader_t::invalid_namespace, \c reader_t::invalid_reference,
+         *          or \c reader_t::no_error.
+         */
+        error_t error_code() const { return mError; }
+
+        //! \brief Get the namespaces of the selected elements.
+        /*!
+         *  \return The table the namespace identifiers of the elements
+         *          handed to the callback refer to.
+         */
+        const table_t& namespaces() const { return mTable; }
+
+    private:
+        typedef typename expression_t::node_t    node_t;    //!< The node type.
+        typedef typename expression_t::step_t    step_t;    //!< The type of location steps.
+        typedef typename expression_t::focus_t   focus_t;   //!< The focus of an evaluation.
+        typedef typename expression_t::context_t context_t; //!< The state of an evaluation.
+
+        //! \brief An attribute of the held start tag.
+        class attribute_t {
+        public:
+            size_t name;  //!< The offset of its name in the tag buffer.
+            size_t value; //!< The offset of its decoded value in the tag buffer.
+            size_t end;   //!< The offset past its value in the tag buffer.
+        };
+
+        //! \brief Check that an expression is streamable.
+        /*!
+         *  Without exception support, the program is aborted if it is not.
+         */
+        static expression_pointer_t check(expression_pointer_t expression)
+        {
+            if (!expression || !expression->streamable()) {
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS)
+                throw std::invalid_argument("the XPath expression is not streamable");
+#else
+                std::abort();
+#endif
+            }
+
+            return expression;
+        }
+
+        //! \brief Build a table holding the namespaces of an expression.
+        static table_t intern(const expression_t& expression)
+        {
+            table_t table;
+
+            for (const string_t& uri : expression.mUris)
+                table.intern(view_t(uri));
+
+            return table;
+        }
+
+        //! \brief Record a well-formedness error, and stop the parsing.
+        bool fail(error_t code)
+        {
+            mError = code;
+
+            return false;
+        }
+
+        //! \brief Get a view of part of the tag buffer.
+        view_t slice(size_t first, size_t last) const
+        {
+            return view_t(mTag.data() + first, last - first);
+        }
+
+        //! \brief Split a qualified name.
+        /*!
+         *  \param [out] prefix The prefix, or an empty view.
+         *
+         *  \return The local name.
+         */
+        static view_t split(const view_t& qname, view_t& prefix)
+        {
+            const charT* colon = std::find(qname.begin(), qname.end(), ':');
+
+            if (colon == qname.end()) {
+                prefix = view_t();
+
+                return qname;
+            }
+
+            prefix = view_t(qname.begin(), colon);
+
+            return view_t(colon + 1, qname.end());
+        }
+
+        //! \brief Get the namespace of an attribute of the held start tag.
+        /*!
+         *  \return The namespace, or \c table_t::npos if its prefix is not
+         *          bound.
+         */
+        namespace_id_t resolve(const attribute_t& attribute) const
+        {
+            const view_t name = slice(attribute.name, attribute.value);
+            view_t       prefix;
+
+            split(name, prefix);
+
+            if (prefix.equals("xmlns") || name.equals("xmlns"))
+                return table_t::xmlns_namespace;
+
+            return prefix.empty() ? namespace_id_t(table_t::no_namespace) : mScope.find(prefix);
+        }
+
+        //! \brief Process the held start tag.
+        /*!
+         *  The namespace declarations of the tag are bound first, then the
+         *  name of the element is resolved and matched against the steps
+         *  its parent has reached.
+         */
+        bool flush()
+        {
+            if (!mPending)
+                return true;
+
+            mPending = false;
+
+            mScope.push();
+            mMarks.push_back(mPrefixes.size());
+
+            for (const attribute_t& attribute : mAttributes) {
+                const view_t name = slice(attribute.name, attribute.value);
+                view_t       prefix;
+                const view_t local = split(name, prefix);
+
+                if (!prefix.equals("xmlns") && !name.equals("xmlns"))
+                    continue;
+
+                const namespace_id_t id = mTable.intern(slice(attribute.value, attribute.end));
+
+                if (prefix.empty())
+                    mScope.bind(view_t(), id);
+                else {
+                    mPrefixes.push_back(local.str());
+                    mScope.bind(view_t(mPrefixes.back()), id);
+                }
+            }
+
+            const size_t length = mAttributes.empty() ? mTag.size() : mAttributes.front().name;
+            view_t       prefix;
+            const view_t local = split(slice(0, length), prefix);
+            const namespace_id_t ns = mScope.find(prefix);
+
+            if (ns == table_t::npos)
+                return fail(reader_t::invalid_namespace);
+
+            if (!mStack.empty())
+                return open(slice(0, length), ns);
+
+            const uint64_t parent = mStates.back();
+            const size_t   last   = mSteps.size();
+            uint64_t       state  = 0;
+            bool           probed = false;
+
+            for (size_t i = 0; i != last; ++i) {
+                if ((parent & (uint64_t(1) << i)) == 0)
+                    continue;
+
+                const step_t& step = mSteps[i];
+
+                if (step.axis == expression_t::axis_descendant)
+                    state |= uint64_t(1) << i;
+
+                if (!matches(step, ns, local))
+                    continue;
+
+                bool accepted = true;
+
+                for (size_t j = 0; accepted && j != step.predicates.size(); ++j) {
+                    if (!probed && !probe(slice(0, length), ns))
+                        return false;
+
+                    probed   = true;
+                    accepted = mExpression->truth(step.predicates[j], focus_t(node_t(mProbe)), mContext);
+                }
+
+                if (accepted)
+                    state |= uint64_t(1) << (i + 1);
+            }
+
+            if (probed) {
+                mProbe.attributes().clear();
+                mProbeArena.reset();
+            }
+
+            if ((state & (uint64_t(1) << last)) != 0) {
+                mStates.push_back(state);
+
+                return open(slice(0, length), ns);
+            }
+
+            if (state == 0) {
+                mScope.pop();
+                mPrefixes.resize(mMarks.back());
+                mMarks.pop_back();
+                mDead = 1;
+
+                return true;
+            }
+
+            mStates.push_back(state);
+
+            return true;
+        }
+
+        //! \brief Whether an element matches the node test of a step.
+        bool matches(const step_t& step, namespace_id_t ns, const view_t& local) const
+        {
+            switch (step.test) {
+            case expression_t::test_any:
+                return true;
+
+            case expression_t::test_namespace:
+                return ns == mContext.ids[step.uri];
+
+            default:
+                return ns == mContext.ids[step.uri] && local == view_t(step.local);
+            }
+        }
+
+        //! \brief Fill the stack element with the held start tag.
+        /*!
+         *  Its name and attributes reference the tag buffer.
+         */
+        bool probe(const view_t& name, namespace_id_t ns)
+        {
+            mProbe.name()         = string_ref_t(name);
+            mProbe.namespace_id() = ns;
+
+            for (const attribute_t& attribute : mAttributes) {
+                const namespace_id_t id = resolve(attribute);
+
+                if (id == table_t::npos)
+                    return fail(reader_t::invalid_namespace);
+
+                if (id != table_t::xmlns_namespace)
+                    mProbe.attributes().emplace(string_ref_t(slice(attribute.name, attribute.value)),
+                                                string_ref_t(slice(attribute.value, attribute.end)), id);
+            }
+
+            return true;
+        }
+
+        //! \brief Build a selected element, or a descendant of one.
+        /*!
+         *  Its name and attributes are copied, so that the parsed chunks
+         *  do not need to outlive it.
+         */
+        bool open(const view_t& name, namespace_id_t ns)
+        {
+            element_t* const element = make<element_t>(string_ref_t(name.str()), mArena);
+
+            if (mStack.empty())
+                mRecord = element;
+            else
+                mStack.back()->adopt_back(element);
+
+            element->namespace_id() = ns;
+            mStack.push_back(element);
+
+            for (const attribute_t& attribute : mAttributes) {
+                const namespace_id_t id = resolve(attribute);
+
+                if (id == table_t::npos)
+                    return fail(reader_t::invalid_namespace);
+
+                element->attributes().emplace(string_ref_t(slice(attribute.name, attribute.value).str()),
+                                              string_ref_t(slice(attribute.value, attribute.end).str()), id);
+            }
+
+            return true;
+        }
+
+        //! \brief Build a node of a selected element in the arena.
+        /*!
+         *  \param [in] args The arguments of the constructor of the node.
+         *
+         *  \return A pointer to the node.
+         */
+        template <typename nodeT, typename... argsT>
+        nodeT* make(argsT&&... args)
+        {
+            return new (mArena) arena_node<nodeT>(std::forward<argsT>(args)...);
+        }
+
+        //! \brief Release the element being built, and reset the arena.
+        void release()
+        {
+            if (mRecord == nullptr)
+                return;
+
+            delete mRecord;
+
+            mRecord = nullptr;
+            mStack.clear();
+            mArena.reset();
+        }
+
+        expression_pointer_t       mExpression; //!< The compiled expression.
+        const std::vector<step_t>& mSteps;      //!< The steps of its path.
+        callback_t                 mCallback;   //!< The function selected elements are handed to.
+
+        table_t               mTable;    //!< The namespaces of the expression, then those declared in the document.
+        context_t             mContext;  //!< The state predicates are evaluated with.
+        scope_t               mScope;    //!< The prefixes in scope.
+        std::deque<string_t>  mPrefixes; //!< The bound prefixes, referenced by \c mScope. A deque never moves them.
+        std::vector<size_t>   mMarks;    //!< The number of prefixes when each open element was started.
+        std::vector<uint64_t> mStates;   //!< The steps reached by each open element that is not part of a selected one.
+
+        string_t                 mTag;        //!< The name, then the attribute names and decoded values, of the held start tag.
+        std::vector<attribute_t> mAttributes; //!< The attributes of the held start tag.
+        string_t                 mValue;      //!< The decoded text.
+        arena                    mProbeArena; //!< The arena the attributes of \c mProbe are allocated in.
+        element_t                mProbe;      //!< The element predicates are checked on.
+
+        arena                   mArena;  //!< The scratch arena selected elements are built in.
+        element_t*              mRecord; //!< The selected element being built, or \c nullptr.
+        std::vector<element_t*> mStack;  //!< The open elements of \c mRecord.
+
+        size_t  mDead;    //!< The depth in a subtree that cannot be selected, or 0.
+        size_t  mCount;   //!< The number of elements handed to the callback.
+        bool    mPending; //!< Whether a start tag is held.
+        error_t mError;   //!< The well-formedness error found, if any.
+    };
+
+    typedef basic_xpath_stream<char>    xpath_stream;  //!< A specialized \c basic_xpath_stream for char.
+    typedef basic_xpath_stream<wchar_t> wxpath_stream; //!< A specialized \c basic_xpath_stream for wchar_t.
+}
+
+#endif /* XPATH_STREAM_H_INCLUDED */
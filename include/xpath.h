@@ -0,0 +1,3907 @@
+#ifndef XPATH_H_INCLUDED
+#define XPATH_H_INCLUDED
+
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+#include <utility>
+#include <cstdio>
+#include <cstdlib>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <reader.h>
+#include <exception.h>
+#include <expected.h>
+#include <namespace-table.h>
+#include <typed-value.h>
+#include <document.h>
+
+namespace xml {
+    template <typename charT>
+    class basic_xpath_stream;
+
+    //! \brief A node of the XPath data model.
+    /*!
+     *  This class refers, without owning it, to a document, an element, a
+     *  text or an attribute of a tree. Attributes are not children of
+     *  their element, so that an attribute node also refers to the
+     *  element that owns it.
+     *
+     *  Nodes are small values : they are copied into node-sets, and two
+     *  nodes are equal when they refer to the same node of the tree.
+     *
+     *  \tparam charT The type of character used in the XML document.
+     *                By default, char and wchar_t are supported.
+     */
+    template <typename charT>
+    class basic_xpath_node {
+    public:
+        //! \name Member types
+        //!@{
+        typedef          basic_document<charT>       document_t;       //!< The document type.
+        typedef          basic_element<charT>        element_t;        //!< The element type.
+        typedef          basic_text<charT>           text_t;           //!< The text type.
+        typedef typename element_t::attribute_t      attribute_t;      //!< The attribute type.
+        typedef typename element_t::parent_t         parent_t;         //!< The type of nodes that have children.
+        typedef typename element_t::child_t          child_t;          //!< The type of nodes that have a parent.
+        typedef typename element_t::node_interface_t node_interface_t; //!< The base type of nodes.
+        typedef typename element_t::string_t         string_t;         //!< The string type.
+
+        //!@}
+
+        //! The kinds of nodes.
+        enum kind_t {
+            null_kind,      //!< No node.
+            document_kind,  //!< A document, the root node of a tree.
+            element_kind,   //!< An element.
+            text_kind,      //!< A text.
+            attribute_kind  //!< An attribute.
+        };
+
+        //! \brief Constructor.
+        /*!
+         *  Builds a null node.
+         */
+        basic_xpath_node()
+        :
+            mKind(null_kind),
+            mNode(nullptr),
+            mAttribute(nullptr)
+        {}
+
+        //! \brief Build a document node.
+        basic_xpath_node(const document_t& document)
+        :
+            mKind(document_kind),
+            mNode(&document),
+            mAttribute(nullptr)
+        {}
+
+        //! \brief Build an element node.
+        basic_xpath_node(const element_t& element)
+        :
+            mKind(element_kind),
+            mNode(&element),
+            mAttribute(nullptr)
+        {}
+
+        //! \brief Build a text node.
+        basic_xpath_node(const text_t& text)
+        :
+            mKind(text_kind),
+            mNode(&text),
+            mAttribute(nullptr)
+        {}
+
+        //! \brief Build an attribute node.
+        /*!
+         *  \param [in] owner     The element of the attribute.
+         *  \param [in] attribute The attribute, that belongs to \c owner.
+         */
+        basic_xpath_node(const element_t& owner, const attribute_t& attribute)
+        :
+            mKind(attribute_kind),
+            mNode(&owner),
+            mAttribute(&attribute)
+        {}
+
+        //! \brief Build the node of a child.
+        /*!
+         *  \return The node of an element or a text, or a null node for
+         *          children of other types.
+         */
+        static basic_xpath_node from_child(const child_t& child)
+        {
+            switch (child.kind()) {
+            case node_interface_t::element_kind:
+                return basic_xpath_node(static_cast<const element_t&>(child));
+
+            case node_interface_t::text_kind:
+                return basic_xpath_node(static_cast<const text_t&>(child));
+
+            default:
+                return basic_xpath_node();
+            }
+        }
+
+        //! \brief Build the node of a parent.
+        /*!
+         *  \return The node of a document or an element, or a null node for
+         *          parents of other types.
+         */
+        static basic_xpath_node from_parent(const parent_t& parent)
+        {
+            switch (parent.kind()) {
+            case node_interface_t::document_kind:
+                return basic_xpath_node(static_cast<const document_t&>(parent));
+
+            case node_interface_t::element_kind:
+                return basic_xpath_node(static_cast<const element_t&>(parent));
+
+            default:
+                return basic_xpath_node();
+            }
+        }
+
+        //! \brief Get the kind of the node.
+        kind_t kind() const { return mKind; }
+
+        //! \brief Whether the node is not null.
+        explicit operator bool() const { return mKind != null_kind; }
+
+        //! \brief Get the document, or \c nullptr if the node is not a document.
+        const document_t* document() const
+        {
+            return mKind == document_kind ? static_cast<const document_t*>(mNode) : nullptr;
+        }
+
+        //! \brief Get the element, or \c nullptr if the node is not an element.
+        const element_t* element() const
+        {
+            return mKind == element_kind ? static_cast<const element_t*>(mNode) : nullptr;
+        }
+
+        //! \brief Get the text, or \c nullptr if the node is not a text.
+        const text_t* text() const
+        {
+            return mKind == text_kind ? static_cast<const text_t*>(mNode) : nullptr;
+        }
+
+        //! \brief Get the attribute, or \c nullptr if the node is not an attribute.
+        const attribute_t* attribute() const { return mAttribute; }
+
+        //! \brief Get the element of an attribute, or \c nullptr if the node is not an attribute.
+        const element_t* owner() const
+        {
+            return mKind == attribute_kind ? static_cast<const element_t*>(mNode) : nullptr;
+        }
+
+        //! \brief Get the node as a parent.
+        /*!
+         *  \return The document or the element, or \c nullptr for other
+         *          kinds of nodes.
+         */
+        const parent_t* parent_node() const
+        {
+            return mKind == document_kind ? static_cast<const parent_t*>(document()) :
+                   mKind == element_kind  ? static_cast<const parent_t*>(element()) : nullptr;
+        }
+
+        //! \brief Get the node as a child.
+        /*!
+         *  \return The element or the text, or \c nullptr for other kinds
+         *          of nodes.
+         */
+        const child_t* child_node() const
+        {
+            return mKind == element_kind ? static_cast<const child_t*>(element()) :
+                   mKind == text_kind    ? static_cast<const child_t*>(text()) : nullptr;
+        }
+
+        //! \brief Get the parent of the node.
+        /*!
+         *  The parent of an attribute is its element.
+         *
+         *  \return The parent, or a null node for documents and for nodes
+         *          that have not been inserted in a tree.
+         */
+        basic_xpath_node parent() const
+        {
+            if (mKind == attribute_kind)
+                return basic_xpath_node(*owner());
+
+            const child_t* child = child_node();
+
+            return child != nullptr && child->has_parent() ? from_parent(child->parent()) : basic_xpath_node();
+        }
+
+        //! \brief Get an address that identifies the node.
+        const void* key() const { return mAttribute != nullptr ? static_cast<const void*>(mAttribute) : mNode; }
+
+        //! \brief Append the string-value of the node to a string.
+        /*!
+         *  The string-value of a document or an element is the
+         *  concatenation of its descendant texts, in document order.
+         */
+        void append_string_value(string_t& str) const
+        {
+            switch (mKind) {
+            case text_kind:
+                str.append(text()->data().begin(), text()->data().end());
+                break;
+
+            case attribute_kind:
+                str.append(mAttribute->value().begin(), mAttribute->value().end());
+                break;
+
+            case document_kind:
+            case element_kind: {
+                const parent_t* top = parent_node();
+
+                for (const child_t* child = first_child(*top); child != nullptr; child = following(child, top))
+                    if (child->kind() == node_interface_t::text_kind) {
+                        const text_t& text = static_cast<const text_t&>(*child);
+
+                        str.append(text.data().begin(), text.data().end());
+                    }
+
+                break;
+            }
+
+            default:
+                break;
+            }
+        }
+
+        //! \brief Get the string-value of the node.
+        string_t string_value() const
+        {
+            string_t str;
+
+            append_string_value(str);
+
+            return str;
+        }
+
+        //! \brief Get the first child of a parent.
+        /*!
+         *  \return A pointer to the first child, or \c nullptr.
+         */
+        static const child_t* first_child(const parent_t& parent)
+        {
+            return parent.empty() ? nullptr : &parent.front();
+        }
+
+        //! \brief Get the child that follows a subtree in document order.
+        /*!
+         *  \param [in] child The root of the subtree.
+         *  \param [in] top   The node the walk does not go above, or
+         *                    \c nullptr to walk up to the top of the tree.
+         *
+         *  \return The next sibling of \c child, or of its nearest ancestor
+         *          below \c top that has one, or \c nullptr.
+         */
+        static const child_t* skip(const child_t* child, const parent_t* top)
+        {
+            while (child->next_sibling() == nullptr) {
+                if (!child->has_parent())
+                    return nullptr;
+
+                const parent_t& parent = child->parent();
+
+                if (&parent == top || parent.kind() != node_interface_t::element_kind)
+                    return nullptr;
+
+                child = &static_cast<const element_t&>(parent);
+            }
+
+            return child->next_sibling();
+        }
+
+        //! \brief Get the child that follows another in document order.
+        /*!
+         *  \param [in] child The current child.
+         *  \param [in] top   The node the walk does not go above, or
+         *                    \c nullptr to walk up to the top of the tree.
+         *
+         *  \return The first child of \c child, or the child that follows
+         *          its subtree, or \c nullptr.
+         */
+        static const child_t* following(const child_t* child, const parent_t* top)
+        {
+            if (child->kind() == node_interface_t::element_kind) {
+                const child_t* first = first_child(static_cast<const element_t&>(*child));
+
+                if (first != nullptr)
+                    return first;
+            }
+
+            return skip(child, top);
+        }
+
+        //! \brief Equality operator.
+        bool operator==(const basic_xpath_node& rhs) const
+        {
+            return mNode == rhs.mNode && mAttribute == rhs.mAttribute;
+        }
+
+        //! \brief Inequality operator.
+        bool operator!=(const basic_xpath_node& rhs) const
+        {
+            return !(*this == rhs);
+        }
+
+    private:
+        kind_t             mKind;      //!< The kind of node.
+        const void*        mNode;      //!< The node, or the element of an attribute.
+        const attribute_t* mAttribute; //!< The attribute, if any.
+    };
+
+    //! \brief The value of an XPath expression.
+    /*!
+     *  A value is a node-set, a boolean, a number or a string, and is
+     *  converted to the other types with the rules of XPath 1.0. The
+     *  node-sets returned by expressions are in document order, without
+     *  duplicates.
+     *
+     *  \tparam charT The type of character used in the XML document.
+     *                By default, char and wchar_t are supported.
+     */
+    template <typename charT>
+    class basic_xpath_value {
+    public:
+        //! \name Member types
+        //!@{
+        typedef          basic_xpath_node<charT>   node_t;     //!< The node type.
+        typedef          std::vector<node_t>       node_set_t; //!< The node-set type.
+        typedef typename node_t::string_t          string_t;   //!< The string type.
+        typedef          basic_string_view<charT>  view_t;     //!< The type of views of strings.
+        typedef typename basic_reader<charT>::scanner_t scanner_t; //!< The scanner type.
+
+        //!@}
+
+        //! The types of values.
+        enum type_t {
+            node_set_type, //!< An unordered collection of nodes, without duplicates.
+            boolean_type,  //!< \c true or \c false.
+            number_type,   //!< A double precision floating point number.
+            string_type    //!< A string.
+        };
+
+        //! \brief Constructor.
+        /*!
+         *  Builds an empty node-set.
+         */
+        basic_xpath_value()
+        :
+            mType(node_set_type),
+            mNumber(0),
+            mString(),
+            mNodes()
+        {}
+
+        //! \brief Build a node-set.
+        explicit basic_xpath_value(node_set_t nodes)
+        :
+            mType(node_set_type),
+            mNumber(0),
+            mString(),
+            mNodes(std::move(nodes))
+        {}
+
+        //! \brief Build a boolean.
+        explicit basic_xpath_value(bool boolean)
+        :
+            mType(boolean_type),
+            mNumber(boolean ? 1 : 0),
+            mString(),
+            mNodes()
+        {}
+
+        //! \brief Build a number.
+        explicit basic_xpath_value(double number)
+        :
+            mType(number_type),
+            mNumber(number),
+            mString(),
+            mNodes()
+        {}
+
+        //! \brief Build a string.
+        explicit basic_xpath_value(string_t str)
+        :
+            mType(string_type),
+            mNumber(0),
+            mString(std::move(str)),
+            mNodes()
+        {}
+
+        //! \brief Get the type of the value.
+        type_t type() const { return mType; }
+
+        //! \brief Get the nodes of a node-set.
+        /*!
+         *  \return The nodes, or an empty list if the value is not a
+         *          node-set.
+         */
+        const node_set_t& nodes() const { return mNodes; }
+
+        //! \brief Get the nodes of a node-set.
+        node_set_t& nodes() { return mNodes; }
+
+        //! \brief Convert the value to a boolean.
+        /*!
+         *  A node-set is \c true if it is not empty, a number if it is
+         *  neither zero nor NaN, and a string if it is not empty.
+         */
+        bool boolean() const
+        {
+            switch (mType) {
+            case node_set_type:
+                return !mNodes.empty();
+
+            case string_type:
+                return !mString.empty();
+
+            default:
+                return mNumber != 0 && !std::isnan(mNumber);
+            }
+        }
+
+        //! \brief Convert the value to a number.
+        /*!
+         *  A node-set is converted through the string-value of its first
+         *  node, and a string that is not a number is NaN.
+         */
+        double number() const
+        {
+            switch (mType) {
+            case node_set_type:
+                return mNodes.empty() ? std::numeric_limits<double>::quiet_NaN() : to_number(mNodes.front());
+
+            case string_type:
+                return to_number(view_t(mString));
+
+            default:
+                return mNumber;
+            }
+        }
+
+        //! \brief Convert the value to a string.
+        /*!
+         *  A node-set is converted to the string-value of its first node,
+         *  or to an empty string if it is empty.
+         */
+        string_t string() const
+        {
+            switch (mType) {
+            case node_set_type:
+                return mNodes.empty() ? string_t() : mNodes.front().string_value();
+
+            case boolean_type:
+                return ascii(mNumber != 0 ? "true" : "false");
+
+            case number_type:
+                return to_string(mNumber);
+
+            default:
+                return mString;
+            }
+        }
+
+        //! \brief Convert a string to a number.
+        /*!
+         *  \return The number, or NaN if the string, without its leading
+         *          and trailing whitespace, is not an optional minus sign
+         *          followed by digits with an optional decimal point.
+         */
+        static double to_number(const view_t& str)
+        {
+            const charT* first = scanner_t::skip_whitespace(str.begin(), str.end());
+            const charT* last  = str.end();
+
+            while (last != first && scanner_t::is_whitespace(*(last - 1)))
+                --last;
+
+            std::string digits;
+            bool        any = false;
+            bool        dot = false;
+
+            if (first != last && *first == '-') {
+                digits += '-';
+                ++first;
+            }
+
+            for (; first != last; ++first) {
+                if (*first >= '0' && *first <= '9')
+                    any = true;
+                else if (*first != '.' || dot)
+                    return std::numeric_limits<double>::quiet_NaN();
+                else
+                    dot = true;
+
+                digits += static_cast<char>(*first);
+            }
+
+            return any ? std::strtod(digits.c_str(), nullptr) : std::numeric_limits<double>::quiet_NaN();
+        }
+
+        //! \brief Convert the string-value of a node to a number.
+        /*!
+         *  Integers and decimals typed by a schema validation are read
+         *  without parsing the text again.
+         */
+        static double to_number(const node_t& node)
+        {
+            const typed_value* typed = nullptr;
+
+            if (node.kind() == node_t::attribute_kind)
+                typed = &node.attribute()->typed();
+            else if (node.kind() == node_t::text_kind)
+                typed = &node.text()->typed();
+            else if (node.kind() == node_t::element_kind) {
+                const typename node_t::child_t* child = node_t::first_child(*node.element());
+
+                if (child != nullptr && child->next_sibling() == nullptr && child->kind() == node_t::node_interface_t::text_kind)
+                    typed = &static_cast<const typename node_t::text_t&>(*child).typed();
+            }
+
+            if (typed != nullptr && (typed->type() == typed_value::integer_type || typed->type() == typed_value::decimal_type))
+                return typed->as_double();
+
+            if (node.kind() == node_t::attribute_kind)
+                return to_number(node.attribute()->value().view());
+
+            if (node.kind() == node_t::text_kind)
+                return to_number(node.text()->data().view());
+
+            const string_t str = node.string_value();
+
+            return to_number(view_t(str));
+        }
+
+        //! \brief Convert a number to a string.
+        /*!
+         *  Integers are written without decimal point, other numbers with
+         *  the fewest decimals that read back as the same number, and none
+         *  of them with an exponent.
+         */
+        static string_t to_string(double number)
+        {
+            if (std::isnan(number))
+                return ascii("NaN");
+
+            if (std::isinf(number))
+                return ascii(number > 0 ? "Infinity" : "-Infinity");
+
+            if (number == 0)
+                return ascii("0");
+
+            char buffer[512];
+
+            if (std::floor(number) == number) {
+                std::snprintf(buffer, sizeof(buffer), "%.0f", number);
+
+                return ascii(buffer);
+            }
+
+            int precision = 1;
+
+            for (; precision < 17; ++precision) {
+                std::snprintf(buffer, sizeof(buffer), "%.*e", precision - 1, number);
+
+                if (std::strtod(buffer, nullptr) == number)
+                    break;
+            }
+
+            std::snprintf(buffer, sizeof(buffer), "%.*e", precision - 1, number);
+
+            const int exponent = std::atoi(std::strchr(buffer, 'e') + 1);
+            const int decimals = std::max(0, precision - 1 - exponent);
+
+            std::snprintf(buffer, sizeof(buffer), "%.*f", std::min(decimals, 400), number);
+
+            string_t str = ascii(buffer);
+
+            if (str.find(charT('.')) != string_t::npos) {
+                while (str.back() == '0')
+                    str.pop_back();
+
+                if (str.back() == '.')
+                    str.pop_back();
+            }
+
+            return str;
+        }
+
+        //! \brief Widen an ASCII string.
+        static string_t ascii(const char* str)
+        {
+            string_t result;
+
+            while (*str != '\0')
+                result += static_cast<charT>(*str++);
+
+            return result;
+        }
+
+    private:
+        type_t     mType;   //!< The type of the value.
+        double     mNumber; //!< The value of a number, or 1 or 0 for a boolean.
+        string_t   mString; //!< The value of a string.
+        node_set_t mNodes;  //!< The nodes of a node-set.
+    };
+
+    //! \brief A compiled XPath 1.0 expression.
+    /*!
+     *  This class compiles an expression once into an immutable tree of
+     *  operations, that is optimized before it is evaluated :
+     *
+     *  - constant sub-expressions, including constant predicates, are
+     *    folded, and predicates that are always true are removed ;
+     *  - a \c // followed by a child step without positional predicate
+     *    is fused into a single \c descendant step ;
+     *  - predicates that are constant positions, such as \c [1], stop
+     *    walking their axis as soon as the position is reached ;
+     *  - paths whose steps cannot produce a node twice nor out of
+     *    document order are marked, so that their nodes are neither
+     *    sorted nor deduplicated ;
+     *  - descendant steps with a predicate such as \c [@id='123'] or
+     *    \c [@sku=$x] take their candidates from the attribute index of
+     *    the document, when it has one, instead of walking the tree.
+     *
+     *  Location paths are then evaluated as nested loops over the axes of
+     *  the tree, each node reaching the last step being handed to the
+     *  consumer : testing a path for emptiness, comparing it to a value,
+     *  counting its nodes or taking its first one does not build any
+     *  intermediate node-set. Only the steps whose predicates depend on
+     *  the size of the context or on a non constant position build the
+     *  list of their candidates.
+     *
+     *  A compiled expression is only handed out through a
+     *  \c std::shared_ptr to a constant object, and keeps all the state
+     *  of an evaluation on the stack : it can be cached, and evaluated by
+     *  any number of threads at the same time, on the same or on
+     *  different documents. Lazily loaded documents must have been
+     *  expanded before they are shared between threads.
+     *
+     *  The tree has no comment, processing instruction nor namespace
+     *  nodes : the \c comment() and \c processing-instruction() node
+     *  tests and the \c namespace axis never match, and namespace
+     *  declarations are not attributes. Name tests match the namespace
+     *  and local name of nodes, and require a document parsed with
+     *  namespaces for prefixed names. The \c id() function looks for
+     *  \c xml:id attributes, since there is no type information on
+     *  attributes. An undefined variable is an empty node-set.
+     *
+     *  \sa xml::basic_xpath_node
+     *  \sa xml::basic_xpath_value
+     *
+     *  \tparam charT The type of character used in the expression and the
+     *                XML document. By default, char and wchar_t are
+     *                supported.
+     */
+    template <typename charT>
+    class basic_xpath_expression {
+    public:
+        //! \name Member types
+        //!@{
+        typedef          basic_reader<charT>       reader_t;        //!< The reader type, whose error codes are used.
+        typedef typename reader_t::scanner_t       scanner_t;       //!< The scanner type.
+        typedef typename reader_t::view_t          view_t;          //!< The type of views of strings.
+        typedef typename reader_t::const_pointer_t const_pointer_t; //!< Pointer to a constant character.
+
+        typedef          basic_xpath_node<charT>      node_t;           //!< The node type.
+        typedef          basic_xpath_value<charT>     value_t;          //!< The value type.
+        typedef typename value_t::node_set_t          node_set_t;       //!< The node-set type.
+        typedef typename node_t::document_t           document_t;       //!< The document type.
+        typedef typename node_t::element_t            element_t;        //!< The element type.
+        typedef typename node_t::text_t               text_t;           //!< The text type.
+        typedef typename node_t::attribute_t          attribute_t;      //!< The attribute type.
+        typedef typename node_t::parent_t             parent_t;         //!< The type of nodes that have children.
+        typedef typename node_t::child_t              child_t;          //!< The type of nodes that have a parent.
+        typedef typename node_t::node_interface_t     node_interface_t; //!< The base type of nodes.
+        typedef typename node_t::string_t             string_t;         //!< The string type.
+        typedef          basic_namespace_table<charT> table_t;          //!< The namespace table type.
+
+        typedef std::vector<std::pair<string_t, string_t> > bindings_t;  //!< The namespace URI bound to each prefix of an expression.
+        typedef std::unordered_map<string_t, value_t>       variables_t; //!< The value of each variable, by name.
+
+        typedef basic_xpath_expression<charT>                 expression_t;         //!< The compiled expression type.
+        typedef std::shared_ptr<const expression_t>           expression_pointer_t; //!< A shared pointer to a compiled expression.
+        typedef basic_parse_error<charT>                      parse_error_t;        //!< The compilation error type.
+        typedef basic_exception<charT>                        exception_t;          //!< The type of exception thrown on compilation errors.
+        typedef expected<expression_pointer_t, parse_error_t> result_t;             //!< The result of a compilation that does not throw.
+
+        //!@}
+
+        basic_xpath_expression(const basic_xpath_expression&) = delete;
+        basic_xpath_expression& operator=(const basic_xpath_expression&) = delete;
+
+        //! \brief Compile an expression without throwing exceptions.
+        /*!
+         *  \param [in] expression The expression.
+         *  \param [in] namespaces The namespace URI bound to each prefix
+         *                         used in the expression. The \c xml
+         *                         prefix is always bound.
+         *
+         *  \return The compiled expression, or the first error found,
+         *          with a \c no_error code and the offset of the faulty
+         *          token in the expression.
+         */
+        static result_t try_compile(const view_t& expression, const bindings_t& namespaces = bindings_t())
+        {
+            std::shared_ptr<expression_t> compiled(new expression_t(expression));
+            compiler_t compiler(*compiled, namespaces);
+
+            if (!compiler.compile())
+                return result_t(parse_error_t(compiler.error, reader_t::no_error, compiler.offset));
+
+            return result_t(expression_pointer_t(std::move(compiled)));
+        }
+
+        //! \brief Compile an expression.
+        /*!
+         *  \param [in] expression The expression.
+         *  \param [in] namespaces The namespace URI bound to each prefix
+         *                         used in the expression.
+         *
+         *  \throw exception_t If the expression is invalid.
+         *
+         *  \return The compiled expression.
+         */
+        static expression_pointer_t compile(const view_t& expression, const bindings_t& namespaces = bindings_t())
+        {
+            result_t result = try_compile(expression, namespaces);
+
+            if (!result)
+                throw exception_t(result.error(), expression.data());
+
+            return std::move(result.value());
+        }
+
+        //! \brief Get the source of the expression.
+        const string_t& str() const { return mSource; }
+
+        //! \brief Whether the expression always evaluates to a node-set.
+        bool returns_nodes() const { return mTypes[mRoot] == result_node_set; }
+
+        //! \brief Whether the expression can be evaluated on parser events.
+        /*!
+         *  Streamable expressions are absolute location paths of \c child
+         *  and \c descendant steps selecting elements, with predicates
+         *  that only read the attributes and the name of the element they
+         *  filter, such as \c /a/b[@k='v']/c or \c //item/price.
+         *
+         *  \sa xml::basic_xpath_stream
+         */
+        bool streamable() const { return mStreamable; }
+
+        //! \brief Evaluate the expression.
+        /*!
+         *  The namespaces of the nodes are those of the document that
+         *  contains \c context.
+         *
+         *  \param [in] context   The context node.
+         *  \param [in] variables The values of the variables, or \c nullptr.
+         *
+         *  \return The value, whose nodes are in document order if it is a
+         *          node-set.
+         */
+        value_t evaluate(const node_t& context, const variables_t* variables = nullptr) const
+        {
+            context_t state(*this, context, nullptr, variables);
+
+            return eval(mRoot, focus_t(context), state);
+        }
+
+        //! \brief Evaluate the expression on nodes that are not in a document.
+        /*!
+         *  \param [in] context    The context node.
+         *  \param [in] namespaces The table the namespace identifiers of the
+         *                         nodes refer to.
+         *  \param [in] variables  The values of the variables, or \c nullptr.
+         *
+         *  \return The value, whose nodes are in document order if it is a
+         *          node-set.
+         */
+        value_t evaluate(const node_t& context, const table_t& namespaces, const variables_t* variables = nullptr) const
+        {
+            context_t state(*this, context, &namespaces, variables);
+
+            return eval(mRoot, focus_t(context), state);
+        }
+
+        //! \brief Select the nodes of the expression.
+        /*!
+         *  \param [in] context   The context node.
+         *  \param [in] variables The values of the variables, or \c nullptr.
+         *
+         *  \return The nodes in document order, or an empty list if the
+         *          expression is not a node-set.
+         */
+        node_set_t select(const node_t& context, const variables_t* variables = nullptr) const
+        {
+            context_t state(*this, context, nullptr, variables);
+
+            return nodes(mRoot, focus_t(context), state);
+        }
+
+        //! \brief Select the first node of the expression.
+        /*!
+         *  The walk stops at the first node found, when the expression
+         *  produces its nodes in document order.
+         *
+         *  \param [in] context   The context node.
+         *  \param [in] variables The values of the variables, or \c nullptr.
+         *
+         *  \return The first node in document order, or a null node.
+         */
+        node_t select_first(const node_t& context, const variables_t* variables = nullptr) const
+        {
+            context_t state(*this, context, nullptr, variables);
+
+            return first(mRoot, focus_t(context), state);
+        }
+
+        //! \brief Call a function for each node of the expression.
+        /*!
+         *  The nodes are handed to \c function as they are found, without
+         *  building a node-set, when the expression produces them in
+         *  document order.
+         *
+         *  \param [in] context   The context node.
+         *  \param [in] function  The function called with each node, in
+         *                        document order, that returns \c false to
+         *                        stop.
+         *  \param [in] variables The values of the variables, or \c nullptr.
+         *
+         *  \return \c false if \c function stopped the walk.
+         */
+        template <typename functionT>
+        bool for_each(const node_t& context, functionT function, const variables_t* variables = nullptr) const
+        {
+            context_t state(*this, context, nullptr, variables);
+
+            return visit(mRoot, focus_t(context), state, function, true);
+        }
+
+        //! \brief Evaluate the expression as a boolean.
+        /*!
+         *  A location path stops at its first node.
+         *
+         *  \param [in] context   The context node.
+         *  \param [in] variables The values of the variables, or \c nullptr.
+         */
+        bool test(const node_t& context, const variables_t* variables = nullptr) const
+        {
+            context_t state(*this, context, nullptr, variables);
+
+            return truth(mRoot, focus_t(context), state);
+        }
+
+        //! \brief Evaluate the expression at a position of a list of nodes.
+        /*!
+         *  The \c position() and \c last() functions return \c position
+         *  and \c size, as in the body of a XSLT \c for-each.
+         *
+         *  \param [in] context   The context node.
+         *  \param [in] position  The position of \c context in the list, from 1.
+         *  \param [in] size      The size of the list.
+         *  \param [in] variables The values of the variables, or \c nullptr.
+         *
+         *  \return The value, whose nodes are in document order if it is a
+         *          node-set.
+         */
+        value_t evaluate(const node_t& context, size_t position, size_t size, const variables_t* variables = nullptr) const
+        {
+            return evaluate(context, position, size, nullptr, variables);
+        }
+
+        //! \brief Evaluate the expression at a position of a list of nodes, with a namespace table.
+        /*!
+         *  \param [in] context    The context node.
+         *  \param [in] position   The position of \c context in the list, from 1.
+         *  \param [in] size       The size of the list.
+         *  \param [in] namespaces The namespace table of the nodes, or \c nullptr
+         *                         for the table of their document.
+         *  \param [in] variables  The values of the variables, or \c nullptr.
+         *
+         *  \sa evaluate(const node_t&, const table_t&, const variables_t*) const
+         */
+        value_t evaluate(const node_t& context, size_t position, size_t size, const table_t* namespaces, const variables_t* variables) const
+        {
+            context_t state(*this, context, namespaces, variables);
+
+            return eval(mRoot, focus_t(context, position, size), state);
+        }
+
+        //! \brief Evaluate the expression as a boolean at a position of a list of nodes.
+        /*!
+         *  \sa evaluate(const node_t&, size_t, size_t, const variables_t*) const
+         */
+        bool test(const node_t& context, size_t position, size_t size, const variables_t* variables = nullptr) const
+        {
+            return test(context, position, size, nullptr, variables);
+        }
+
+        //! \brief Evaluate the expression as a boolean at a position of a list of nodes, with a namespace table.
+        /*!
+         *  \sa evaluate(const node_t&, size_t, size_t, const table_t*, const variables_t*) const
+         */
+        bool test(const node_t& context, size_t position, size_t size, const table_t* namespaces, const variables_t* variables) const
+        {
+            context_t state(*this, context, namespaces, variables);
+
+            return truth(mRoot, focus_t(context, position, size), state);
+        }
+
+        //! \brief Whether the expression is a literal.
+        /*!
+         *  Constant sub-expressions are folded when the expression is
+         *  compiled : a constant expression does not depend on its context
+         *  nor on variables.
+         */
+        bool constant() const
+        {
+            return constant(mRoot);
+        }
+
+        //! \brief Whether the expression only reads below its context node.
+        /*!
+         *  Its location paths are relative, and only use the \c child,
+         *  \c attribute, \c descendant, \c descendant-or-self and \c self
+         *  axes, and it does not call \c id(). Its value on an element is
+         *  then the same on a copy of the element and its descendants.
+         */
+        bool downward() const
+        {
+            for (const path_t& path : mPaths) {
+                if (path.absolute)
+                    return false;
+
+                for (const step_t& step : path.steps)
+                    if (step.axis != axis_child && step.axis != axis_attribute && step.axis != axis_descendant &&
+                        step.axis != axis_descendant_or_self && step.axis != axis_self)
+                        return false;
+            }
+
+            for (const expr_t& e : mExprs)
+                if (e.op == op_function && e.function == fn_id)
+                    return false;
+
+            return true;
+        }
+
+        //! \name Patterns
+        //!@{
+
+        //! \brief The nodes the last step of a pattern may match.
+        class target_t {
+        public:
+            typename node_t::kind_t kind;  //!< The kind of the matched nodes, or \c null_kind for elements and texts.
+            const string_t*         uri;   //!< The namespace of the matched names, or \c nullptr for any.
+            const string_t*         local; //!< The local name of the matched names, or \c nullptr for any.
+        };
+
+        //! \brief Whether the expression is a XSLT pattern.
+        /*!
+         *  A pattern is a union of location paths made of \c child and
+         *  \c attribute steps, separated by \c / or \c //, that may start
+         *  with \c / or \c //. \c id() and \c key() patterns are not
+         *  supported.
+         */
+        bool pattern() const
+        {
+            return pattern(mRoot);
+        }
+
+        //! \brief Whether a node matches the expression, taken as a XSLT pattern.
+        /*!
+         *  The path is matched from its last step up the ancestors of the
+         *  node, instead of being evaluated from every ancestor. Predicates
+         *  that do not depend on positions are checked on the node alone ;
+         *  the others build the list of siblings the step selects. An
+         *  element without parent, such as the fragments built by
+         *  \c basic_xpath_stream, matches a relative pattern of one \c child
+         *  step whose predicates do not depend on positions.
+         *
+         *  \param [in] node      The node.
+         *  \param [in] variables The values of the variables, or \c nullptr.
+         *
+         *  \return \c true if the node matches, \c false if it does not or
+         *          if the expression is not a pattern.
+         */
+        bool matches(const node_t& node, const variables_t* variables = nullptr) const
+        {
+            return matches(node, nullptr, variables);
+        }
+
+        //! \brief Whether a node matches the expression, with a namespace table.
+        /*!
+         *  \param [in] node       The node.
+         *  \param [in] namespaces The namespace table of the node, or \c nullptr
+         *                         for the table of its document.
+         *  \param [in] variables  The values of the variables, or \c nullptr.
+         */
+        bool matches(const node_t& node, const table_t* namespaces, const variables_t* variables) const
+        {
+            if (!node)
+                return false;
+
+            context_t state(*this, node, namespaces, variables);
+
+            return match(mRoot, node, state);
+        }
+
+        //! \brief Whether a pattern only looks at the node it matches.
+        /*!
+         *  The pattern is a single \c child or \c attribute step, whose
+         *  predicates do not depend on positions and only read below the
+         *  node : it matches a node the same way on a copy of the node and
+         *  its descendants.
+         */
+        bool shallow() const
+        {
+            const expr_t& e = mExprs[mRoot];
+
+            if (e.op != op_path || !downward())
+                return false;
+
+            const path_t& path = mPaths[e.path];
+
+            if (path.filter != npos || path.steps.size() != 1)
+                return false;
+
+            const step_t& step = path.steps.front();
+
+            return (step.axis == axis_child || step.axis == axis_attribute) && !positional(step);
+        }
+
+        //! \brief Get the default priority of a pattern that is not a union.
+        /*!
+         *  \return 0 for a single name test, -0.25 for \c prefix:*, -0.5
+         *          for other single node tests, and 0.5 otherwise.
+         */
+        double priority() const
+        {
+            const expr_t& e = mExprs[mRoot];
+
+            if (e.op != op_path)
+                return 0.5;
+
+            const path_t& path = mPaths[e.path];
+
+            if (path.filter != npos || path.absolute || path.steps.size() != 1)
+                return 0.5;
+
+            const step_t& step = path.steps.front();
+
+            if ((step.axis != axis_child && step.axis != axis_attribute) || !step.predicates.empty())
+                return 0.5;
+
+            return step.test == test_name ? 0 : step.test == test_namespace ? -0.25 : -0.5;
+        }
+
+        //! \brief Get the nodes the last step of a pattern that is not a union may match.
+        target_t target() const
+        {
+            target_t      result = { node_t::null_kind, nullptr, nullptr };
+            const expr_t& e      = mExprs[mRoot];
+
+            if (e.op != op_path || mPaths[e.path].filter != npos)
+                return result;
+
+            const path_t& path = mPaths[e.path];
+
+            if (path.steps.empty()) {
+                result.kind = node_t::document_kind;
+
+                return result;
+            }
+
+            const step_t& step = path.steps.back();
+
+            if (step.axis == axis_attribute)
+                result.kind = node_t::attribute_kind;
+            else if (step.test == test_text)
+                result.kind = node_t::text_kind;
+            else if (step.test == test_name || step.test == test_namespace || step.test == test_any)
+                result.kind = node_t::element_kind;
+
+            if (step.test == test_name || step.test == test_namespace)
+                result.uri = &mUris[step.uri];
+
+            if (step.test == test_name)
+                result.local = &step.local;
+
+            return result;
+        }
+
+        //!@}
+
+    private:
+        //! The operations of the expression tree.
+        enum op_t {
+            op_string,   //!< A literal string.
+            op_number,   //!< A literal number.
+            op_boolean,  //!< A constant boolean.
+            op_variable, //!< A variable reference.
+            op_path,     //!< A location path, or a filter expression.
+            op_union,    //!< \c |
+            op_or,       //!< \c or
+            op_and,      //!< \c and
+            op_equal,    //!< \c =
+            op_unequal,  //!< \c !=
+            op_less,     //!< \c <
+            op_lessEq,   //!< \c <=
+            op_greater,  //!< \c >
+            op_greaterEq,//!< \c >=
+            op_add,      //!< \c +
+            op_subtract, //!< \c -
+            op_multiply, //!< \c *
+            op_divide,   //!< \c div
+            op_modulo,   //!< \c mod
+            op_negate,   //!< Unary \c -
+            op_function  //!< A function call.
+        };
+
+        //! The functions of the core library.
+        enum function_t {
+            fn_last, fn_position, fn_count, fn_id, fn_local_name, fn_namespace_uri, fn_name,
+            fn_string, fn_concat, fn_starts_with, fn_contains, fn_substring_before, fn_substring_after,
+            fn_substring, fn_string_length, fn_normalize_space, fn_translate,
+            fn_boolean, fn_not, fn_true, fn_false, fn_lang,
+            fn_number, fn_sum, fn_floor, fn_ceiling, fn_round
+        };
+
+        //! The axes.
+        enum axis_t {
+            axis_child, axis_descendant, axis_descendant_or_self, axis_self, axis_parent,
+            axis_ancestor, axis_ancestor_or_self, axis_attribute, axis_following_sibling,
+            axis_preceding_sibling, axis_following, axis_preceding, axis_namespace
+        };
+
+        //! The node tests.
+        enum test_t {
+            test_name,      //!< A qualified name.
+            test_any,       //!< \c *
+            test_namespace, //!< \c prefix:*
+            test_node,      //!< \c node()
+            test_text,      //!< \c text()
+            test_other      //!< \c comment() and \c processing-instruction(), that never match.
+        };
+
+        //! The static types of the sub-expressions.
+        enum type_t {
+            result_node_set, //!< Always a node-set.
+            result_boolean,  //!< Always a boolean.
+            result_number,   //!< Always a number.
+            result_string,   //!< Always a string.
+            result_any       //!< Known at evaluation only.
+        };
+
+        //! The order in which a path produces its nodes.
+        enum order_t {
+            order_single,    //!< At most one node.
+            order_disjoint,  //!< Document order, and no node is an ancestor of another.
+            order_document,  //!< Document order.
+            order_unordered  //!< Any order, possibly with duplicates.
+        };
+
+        static const uint32_t npos          = uint32_t(-1); //!< An invalid index.
+        static const size_t   max_positions = 8;            //!< The most constant positions a step checks without building its candidates.
+
+        //! \brief A sub-expression.
+        class expr_t {
+        public:
+            op_t                  op;       //!< The operation.
+            function_t            function; //!< The function called by \c op_function.
+            std::vector<uint32_t> args;     //!< The operands or arguments.
+            double                number;   //!< The value of a number, or of a boolean.
+            string_t              text;     //!< The value of a string, or the name of a variable.
+            uint32_t              path;     //!< The index of the path of \c op_path.
+        };
+
+        //! \brief A location step.
+        class step_t {
+        public:
+            axis_t                axis;        //!< The axis.
+            test_t                test;        //!< The node test.
+            uint32_t              uri;         //!< The index of the namespace of a name test.
+            string_t              local;       //!< The local name of a name test.
+            std::vector<uint32_t> predicates;  //!< The predicates.
+            std::vector<size_t>   positions;   //!< The constant position of each predicate, or 0.
+            bool                  materialize; //!< Whether the candidates must be collected before the predicates are checked.
+            bool                  empty;       //!< Whether the step never selects any node.
+            uint32_t              key;         //!< The predicate comparing an attribute to a string, that an attribute index answers, or \c npos.
+        };
+
+        //! \brief A location path, or a filter expression followed by steps.
+        class path_t {
+        public:
+            uint32_t              filter;     //!< The filtered expression, or \c npos.
+            std::vector<uint32_t> predicates; //!< The predicates of the filter expression.
+            bool                  absolute;   //!< Whether the path starts at the root.
+            std::vector<step_t>   steps;      //!< The steps.
+            bool                  ordered;    //!< Whether the nodes are produced in document order, without duplicates.
+        };
+
+        //! \brief The focus of an evaluation.
+        class focus_t {
+        public:
+            focus_t(const node_t& n, size_t p = 1, size_t s = 1)
+            :
+                node(n),
+                position(p),
+                size(s)
+            {}
+
+            node_t node;     //!< The context node.
+            size_t position; //!< The context position.
+            size_t size;     //!< The context size.
+        };
+
+        //! \brief The state of one evaluation.
+        class context_t {
+        public:
+            context_t(const expression_t& expression, const node_t& context, const table_t* namespaces, const variables_t* values)
+            :
+                root(context),
+                table(namespaces),
+                ids(),
+                variables(values),
+                order()
+            {
+                for (node_t parent = root.parent(); parent; parent = parent.parent())
+                    root = parent;
+
+                if (table == nullptr)
+                    table = root.document() != nullptr ? &root.document()->namespaces() : &empty();
+
+                ids.reserve(expression.mUris.size());
+
+                for (const string_t& uri : expression.mUris)
+                    ids.push_back(table->find(view_t(uri)));
+            }
+
+            //! \brief Get a table without namespace, for nodes that are not in a document.
+            static const table_t& empty()
+            {
+                static const table_t table;
+
+                return table;
+            }
+
+            node_t                                  root;      //!< The root of the tree of the context node.
+            const table_t*                          table;     //!< The namespaces of the nodes.
+            std::vector<namespace_id_t>             ids;       //!< The identifier of each namespace of the expression in \c table.
+            const variables_t*                      variables; //!< The values of the variables, or \c nullptr.
+            std::unordered_map<const void*, size_t> order;     //!< The rank of each node in document order, built when a node-set is sorted.
+        };
+
+        //! \brief Compiles an expression.
+        class compiler_t {
+        public:
+            //! \brief Constructor.
+            compiler_t(expression_t& target, const bindings_t& namespaces)
+            :
+                error(nullptr),
+                offset(0),
+                expression(target),
+                bindings(namespaces),
+                tokens(),
+                current(0)
+            {}
+
+            //! \brief Compile the expression.
+            bool compile()
+            {
+                if (!tokenize())
+                    return false;
+
+                const uint32_t root = parseOr();
+
+                if (root == npos)
+                    return false;
+
+                if (peek().kind != tk_end)
+                    return fail("unexpected token", peek().offset);
+
+                expression.mRoot = root;
+                expression.optimize();
+
+                return true;
+            }
+
+            const char* error;  //!< The first error found.
+            size_t      offset; //!< The offset of the first error found.
+
+        private:
+            //! The tokens.
+            enum token_kind_t {
+                tk_end, tk_lparen, tk_rparen, tk_lbracket, tk_rbracket, tk_dot, tk_dotdot, tk_at, tk_comma,
+                tk_slash, tk_double_slash, tk_pipe, tk_plus, tk_minus, tk_equal, tk_unequal,
+                tk_less, tk_less_equal, tk_greater, tk_greater_equal, tk_multiply, tk_and, tk_or, tk_mod, tk_div,
+                tk_star, tk_name, tk_axis, tk_node_type, tk_function, tk_variable, tk_literal, tk_number
+            };
+
+            //! \brief A token.
+            class token_t {
+            public:
+                token_kind_t kind;   //!< The kind of token.
+                view_t       text;   //!< The name, literal or number.
+                size_t       offset; //!< The offset of the token in the expression.
+            };
+
+            //! \brief Record an error.
+            bool fail(const char* what, size_t where)
+            {
+                if (error == nullptr) {
+                    error  = what;
+                    offset = where;
+                }
+
+                return false;
+            }
+
+            //! \brief Record an error, in a function returning an index.
+            uint32_t failed(const char* what, size_t where)
+            {
+                fail(what, where);
+
+                return npos;
+            }
+
+            //! \brief Whether a character may appear in an \c NCName.
+            static bool isNameChar(charT c)
+            {
+                return c != ':' && scanner_t::is_name_char(c);
+            }
+
+            //! \brief Whether a character may start an \c NCName.
+            static bool isNameStart(charT c)
+            {
+                return c != ':' && scanner_t::is_name_start(c);
+            }
+
+            //! \brief Split the expression into tokens.
+            /*!
+             *  A \c * or a name that follows an operand is an operator, as
+             *  required by the lexical rules of XPath.
+             */
+            bool tokenize()
+            {
+                const view_t  source(expression.mSource);
+                const charT*  begin = source.begin();
+                const charT*  end   = source.end();
+                const charT*  ptr   = begin;
+
+                while (true) {
+                    ptr = scanner_t::skip_whitespace(ptr, end);
+
+                    token_t token = { tk_end, view_t(), static_cast<size_t>(ptr - begin) };
+
+                    if (ptr == end) {
+                        tokens.push_back(token);
+
+                        return true;
+                    }
+
+                    const bool   operand = !tokens.empty() && isOperand(tokens.back().kind);
+                    const charT  c       = *ptr;
+                    const charT* start   = ptr++;
+
+                    switch (c) {
+                    case '(': token.kind = tk_lparen;   break;
+                    case ')': token.kind = tk_rparen;   break;
+                    case '[': token.kind = tk_lbracket; break;
+                    case ']': token.kind = tk_rbracket; break;
+                    case '@': token.kind = tk_at;       break;
+                    case ',': token.kind = tk_comma;    break;
+                    case '|': token.kind = tk_pipe;     break;
+                    case '+': token.kind = tk_plus;     break;
+                    case '-': token.kind = tk_minus;    break;
+                    case '=': token.kind = tk_equal;    break;
+
+                    case '*':
+                        token.kind = operand ? tk_multiply : tk_star;
+                        break;
+
+                    case '/':
+                        token.kind = ptr != end && *ptr == '/' ? (++ptr, tk_double_slash) : tk_slash;
+                        break;
+
+                    case '!':
+                        if (ptr == end || *ptr != '=')
+                            return fail("unexpected character", token.offset);
+
+                        ++ptr;
+                        token.kind = tk_unequal;
+                        break;
+
+                    case '<':
+                        token.kind = ptr != end && *ptr == '=' ? (++ptr, tk_less_equal) : tk_less;
+                        break;
+
+                    case '>':
+                        token.kind = ptr != end && *ptr == '=' ? (++ptr, tk_greater_equal) : tk_greater;
+                        break;
+
+                    case '"':
+                    case '\'': {
+                        const charT* close = std::find(ptr, end, c);
+
+                        if (close == end)
+                            return fail("unterminated literal", token.offset);
+
+                        token.kind = tk_literal;
+                        token.text = view_t(ptr, close);
+                        ptr = close + 1;
+                        break;
+                    }
+
+                    case '$': {
+                        const charT* name = ptr;
+
+                        if (ptr == end || !isNameStart(*ptr))
+                            return fail("a variable name is expected", token.offset);
+
+                        ptr = scanQName(ptr, end);
+                        token.kind = tk_variable;
+                        token.text = view_t(name, ptr);
+                        break;
+                    }
+
+                    default:
+                        if (c == '.' && ptr != end && *ptr == '.') {
+                            ++ptr;
+                            token.kind = tk_dotdot;
+                        } else if ((c >= '0' && c <= '9') || (c == '.' && ptr != end && *ptr >= '0' && *ptr <= '9')) {
+                            while (ptr != end && *ptr >= '0' && *ptr <= '9')
+                                ++ptr;
+
+                            if (c != '.' && ptr != end && *ptr == '.')
+                                for (++ptr; ptr != end && *ptr >= '0' && *ptr <= '9'; ++ptr)
+                                    ;
+
+                            token.kind = tk_number;
+                            token.text = view_t(start, ptr);
+                        } else if (c == '.') {
+                            token.kind = tk_dot;
+                        } else if (isNameStart(c)) {
+                            while (ptr != end && isNameChar(*ptr))
+                                ++ptr;
+
+                            const view_t name(start, ptr);
+
+                            if (operand) {
+                                if (name.equals("and"))
+                                    token.kind = tk_and;
+                                else if (name.equals("or"))
+                                    token.kind = tk_or;
+                                else if (name.equals("mod"))
+                                    token.kind = tk_mod;
+                                else if (name.equals("div"))
+                                    token.kind = tk_div;
+                                else
+                                    return fail("an operator is expected", token.offset);
+
+                                break;
+                            }
+
+                            const charT* next = scanner_t::skip_whitespace(ptr, end);
+
+                            if (next + 1 < end && next[0] == ':' && next[1] == ':') {
+                                token.kind = tk_axis;
+                                token.text = name;
+                                ptr = next + 2;
+                                break;
+                            }
+
+                            if (ptr + 1 < end && *ptr == ':' && ptr[1] == '*')
+                                ptr += 2;
+                            else if (ptr + 1 < end && *ptr == ':' && isNameStart(ptr[1]))
+                                ptr = scanQName(start, end);
+
+                            token.text = view_t(start, ptr);
+                            next = scanner_t::skip_whitespace(ptr, end);
+
+                            if (next != end && *next == '(')
+                                token.kind = name.size() == token.text.size() &&
+                                             (name.equals("node") || name.equals("text") || name.equals("comment") ||
+                                              name.equals("processing-instruction")) ? tk_node_type : tk_function;
+                            else
+                                token.kind = tk_name;
+                        } else {
+                            return fail("unexpected character", token.offset);
+                        }
+                    }
+
+                    tokens.push_back(token);
+                }
+            }
+
+            //! \brief Whether a token ends an operand.
+            static bool isOperand(token_kind_t kind)
+            {
+                switch (kind) {
+                case tk_rparen:
+                case tk_rbracket:
+                case tk_dot:
+                case tk_dotdot:
+                case tk_star:
+                case tk_name:
+                case tk_variable:
+                case tk_literal:
+                case tk_number:
+                    return true;
+
+                default:
+                    return false;
+                }
+            }
+
+            //! \brief Find the end of a qualified name.
+            static const charT* scanQName(const charT* first, const charT* last)
+            {
+                while (first != last && isNameChar(*first))
+                    ++first;
+
+                if (first + 1 < last && *first == ':' && isNameStart(first[1]))
+                    for (++first; first != last && isNameChar(*first); ++first)
+                        ;
+
+                return first;
+            }
+
+            //! \brief Get the current token.
+            const token_t& peek() const { return tokens[current]; }
+
+            //! \brief Consume the current token.
+            const token_t& next() { return tokens[current == tokens.size() - 1 ? current : current++]; }
+
+            //! \brief Consume a token of a given kind.
+            bool expect(token_kind_t kind, const char* what)
+            {
+                if (peek().kind != kind)
+                    return fail(what, peek().offset);
+
+                next();
+
+                return true;
+            }
+
+            //! \brief Add a sub-expression, and fold it if it is constant.
+            uint32_t add(op_t op, std::vector<uint32_t> args = std::vector<uint32_t>())
+            {
+                expr_t e;
+
+                e.op       = op;
+                e.function = fn_last;
+                e.args     = std::move(args);
+                e.number   = 0;
+                e.path     = npos;
+
+                return expression.add(std::move(e));
+            }
+
+            //! \brief Add a binary operation.
+            uint32_t binary(op_t op, uint32_t lhs, uint32_t rhs)
+            {
+                return add(op, std::vector<uint32_t> { lhs, rhs });
+            }
+
+            //! \brief Whether a sub-expression may be a node-set.
+            bool nodeSet(uint32_t index) const
+            {
+                return expression.mTypes[index] == result_node_set || expression.mTypes[index] == result_any;
+            }
+
+            //! \brief Parse \c OrExpr.
+            uint32_t parseOr()
+            {
+                uint32_t lhs = parseAnd();
+
+                while (lhs != npos && peek().kind == tk_or) {
+                    next();
+
+                    const uint32_t rhs = parseAnd();
+
+                    lhs = rhs == npos ? npos : binary(op_or, lhs, rhs);
+                }
+
+                return lhs;
+            }
+
+            //! \brief Parse \c AndExpr.
+            uint32_t parseAnd()
+            {
+                uint32_t lhs = parseEquality();
+
+                while (lhs != npos && peek().kind == tk_and) {
+                    next();
+
+                    const uint32_t rhs = parseEquality();
+
+                    lhs = rhs == npos ? npos : binary(op_and, lhs, rhs);
+                }
+
+                return lhs;
+            }
+
+            //! \brief Parse \c EqualityExpr.
+            uint32_t parseEquality()
+            {
+                uint32_t lhs = parseRelational();
+
+                while (lhs != npos && (peek().kind == tk_equal || peek().kind == tk_unequal)) {
+                    const op_t op = next().kind == tk_equal ? op_equal : op_unequal;
+                    const uint32_t rhs = parseRelational();
+
+                    lhs = rhs == npos ? npos : binary(op, lhs, rhs);
+                }
+
+                return lhs;
+            }
+
+            //! \brief Parse \c RelationalExpr.
+            uint32_t parseRelational()
+            {
+                uint32_t lhs = parseAdditive();
+
+                while (lhs != npos) {
+                    op_t op;
+
+                    switch (peek().kind) {
+                    case tk_less:          op = op_less;      break;
+                    case tk_less_equal:    op = op_lessEq;    break;
+                    case tk_greater:       op = op_greater;   break;
+                    case tk_greater_equal: op = op_greaterEq; break;
+                    default:               return lhs;
+                    }
+
+                    next();
+
+                    const uint32_t rhs = parseAdditive();
+
+                    lhs = rhs == npos ? npos : binary(op, lhs, rhs);
+                }
+
+                return lhs;
+            }
+
+            //! \brief Parse \c AdditiveExpr.
+            uint32_t parseAdditive()
+            {
+                uint32_t lhs = parseMultiplicative();
+
+                while (lhs != npos && (peek().kind == tk_plus || peek().kind == tk_minus)) {
+                    const op_t op = next().kind == tk_plus ? op_add : op_subtract;
+                    const uint32_t rhs = parseMultiplicative();
+
+                    lhs = rhs == npos ? npos : binary(op, lhs, rhs);
+                }
+
+                return lhs;
+            }
+
+            //! \brief Parse \c MultiplicativeExpr.
+            uint32_t parseMultiplicative()
+            {
+                uint32_t lhs = parseUnary();
+
+                while (lhs != npos && (peek().kind == tk_multiply || peek().kind == tk_div || peek().kind == tk_mod)) {
+                    const token_kind_t kind = next().kind;
+                    const op_t op = kind == tk_multiply ? op_multiply : kind == tk_div ? op_divide : op_modulo;
+                    const uint32_t rhs = parseUnary();
+
+                    lhs = rhs == npos ? npos : binary(op, lhs, rhs);
+                }
+
+                return lhs;
+            }
+
+            //! \brief Parse \c UnaryExpr.
+            uint32_t parseUnary()
+            {
+                if (peek().kind != tk_minus)
+                    return parseUnion();
+
+                next();
+
+                const uint32_t operand = parseUnary();
+
+                return operand == npos ? npos : add(op_negate, std::vector<uint32_t> { operand });
+            }
+
+            //! \brief Parse \c UnionExpr.
+            uint32_t parseUnion()
+            {
+                uint32_t lhs = parsePath();
+
+                while (lhs != npos && peek().kind == tk_pipe) {
+                    const size_t where = next().offset;
+                    const uint32_t rhs = parsePath();
+
+                    if (rhs == npos)
+                        return npos;
+
+                    if (!nodeSet(lhs) || !nodeSet(rhs))
+                        return failed("a node-set is expected", where);
+
+                    lhs = binary(op_union, lhs, rhs);
+                }
+
+                return lhs;
+            }
+
+            //! \brief Whether a token starts a location step.
+            static bool startsStep(token_kind_t kind)
+            {
+                return kind == tk_name || kind == tk_star || kind == tk_dot || kind == tk_dotdot ||
+                       kind == tk_at || kind == tk_axis || kind == tk_node_type;
+            }
+
+            //! \brief Build a step.
+            static step_t makeStep(axis_t axis, test_t test)
+            {
+                step_t step;
+
+                step.axis        = axis;
+                step.test        = test;
+                step.uri         = npos;
+                step.materialize = false;
+                step.empty       = false;
+                step.key         = npos;
+
+                return step;
+            }
+
+            //! \brief Parse \c PathExpr.
+            uint32_t parsePath()
+            {
+                path_t path;
+
+                path.filter   = npos;
+                path.absolute = false;
+                path.ordered  = true;
+
+                const token_kind_t kind = peek().kind;
+
+                if (kind == tk_slash || kind == tk_double_slash || startsStep(kind)) {
+                    if (kind == tk_slash) {
+                        next();
+                        path.absolute = true;
+
+                        if (!startsStep(peek().kind))
+                            return expression.addPath(std::move(path));
+                    } else if (kind == tk_double_slash) {
+                        next();
+                        path.absolute = true;
+                        path.steps.push_back(makeStep(axis_descendant_or_self, test_node));
+                    }
+
+                    return parseRelative(path) ? expression.addPath(std::move(path)) : npos;
+                }
+
+                const size_t   where   = peek().offset;
+                const uint32_t primary = parsePrimary();
+
+                if (primary == npos || !parsePredicates(path.predicates))
+                    return npos;
+
+                if (path.predicates.empty() && peek().kind != tk_slash && peek().kind != tk_double_slash)
+                    return primary;
+
+                if (!nodeSet(primary))
+                    return failed("a node-set is expected", where);
+
+                path.filter = primary;
+
+                if (peek().kind == tk_slash) {
+                    next();
+
+                    if (!parseRelative(path))
+                        return npos;
+                } else if (peek().kind == tk_double_slash) {
+                    next();
+                    path.steps.push_back(makeStep(axis_descendant_or_self, test_node));
+
+                    if (!parseRelative(path))
+                        return npos;
+                }
+
+                return expression.addPath(std::move(path));
+            }
+
+            //! \brief Parse \c RelativeLocationPath.
+            bool parseRelative(path_t& path)
+            {
+                while (true) {
+                    if (!parseStep(path))
+                        return false;
+
+                    if (peek().kind == tk_slash)
+                        next();
+                    else if (peek().kind == tk_double_slash) {
+                        next();
+                        path.steps.push_back(makeStep(axis_descendant_or_self, test_node));
+                    } else
+                        return true;
+                }
+            }
+
+            //! \brief Parse \c Step.
+            bool parseStep(path_t& path)
+            {
+                token_t token = next();
+
+                if (token.kind == tk_dot) {
+                    path.steps.push_back(makeStep(axis_self, test_node));
+
+                    return true;
+                }
+
+                if (token.kind == tk_dotdot) {
+                    path.steps.push_back(makeStep(axis_parent, test_node));
+
+                    return true;
+                }
+
+                step_t step = makeStep(axis_child, test_any);
+
+                if (token.kind == tk_at) {
+                    step.axis = axis_attribute;
+                    token = next();
+                } else if (token.kind == tk_axis) {
+                    static const char* const names[] = {
+                        "child", "descendant", "descendant-or-self", "self", "parent",
+                        "ancestor", "ancestor-or-self", "attribute", "following-sibling",
+                        "preceding-sibling", "following", "preceding", "namespace"
+                    };
+
+                    size_t i = 0;
+
+                    while (i != sizeof(names) / sizeof(*names) && !token.text.equals(names[i]))
+                        ++i;
+
+                    if (i == sizeof(names) / sizeof(*names))
+                        return fail("unknown axis", token.offset);
+
+                    step.axis = static_cast<axis_t>(i);
+                    token = next();
+                }
+
+                switch (token.kind) {
+                case tk_star:
+                    step.test = test_any;
+                    break;
+
+                case tk_name: {
+                    const charT* colon = std::find(token.text.begin(), token.text.end(), ':');
+                    const view_t prefix = colon != token.text.end() ? view_t(token.text.begin(), colon) : view_t();
+                    const view_t local  = colon != token.text.end() ? view_t(colon + 1, token.text.end()) : token.text;
+
+                    step.uri = resolve(prefix, token.offset);
+
+                    if (step.uri == npos)
+                        return false;
+
+                    if (local.equals("*"))
+                        step.test = test_namespace;
+                    else {
+                        step.test  = test_name;
+                        step.local = local.str();
+                    }
+
+                    break;
+                }
+
+                case tk_node_type: {
+                    step.test = token.text.equals("node") ? test_node : token.text.equals("text") ? test_text : test_other;
+
+                    if (!expect(tk_lparen, "( is expected"))
+                        return false;
+
+                    if (token.text.equals("processing-instruction") && peek().kind == tk_literal)
+                        next();
+
+                    if (!expect(tk_rparen, ") is expected"))
+                        return false;
+
+                    break;
+                }
+
+                default:
+                    return fail("a node test is expected", token.offset);
+                }
+
+                if (step.axis == axis_namespace)
+                    step.empty = true;
+
+                if (!parsePredicates(step.predicates))
+                    return false;
+
+                path.steps.push_back(std::move(step));
+
+                return true;
+            }
+
+            //! \brief Parse a list of \c Predicate.
+            bool parsePredicates(std::vector<uint32_t>& predicates)
+            {
+                while (peek().kind == tk_lbracket) {
+                    next();
+
+                    const uint32_t predicate = parseOr();
+
+                    if (predicate == npos || !expect(tk_rbracket, "] is expected"))
+                        return false;
+
+                    predicates.push_back(predicate);
+                }
+
+                return true;
+            }
+
+            //! \brief Resolve a prefix to the index of its namespace URI.
+            uint32_t resolve(const view_t& prefix, size_t where)
+            {
+                if (prefix.empty())
+                    return expression.uri(view_t());
+
+                if (prefix.equals("xml"))
+                    return expression.uri(view_t(table_t().uri(table_t::xml_namespace)));
+
+                for (const std::pair<string_t, string_t>& binding : bindings)
+                    if (view_t(binding.first) == prefix)
+                        return expression.uri(view_t(binding.second));
+
+                return failed("unbound namespace prefix", where);
+            }
+
+            //! \brief Parse \c PrimaryExpr.
+            uint32_t parsePrimary()
+            {
+                const token_t token = next();
+
+                switch (token.kind) {
+                case tk_variable: {
+                    const uint32_t index = add(op_variable);
+
+                    expression.mExprs[index].text = token.text.str();
+
+                    return index;
+                }
+
+                case tk_lparen: {
+                    const uint32_t index = parseOr();
+
+                    if (index == npos || !expect(tk_rparen, ") is expected"))
+                        return npos;
+
+                    return index;
+                }
+
+                case tk_literal: {
+                    const uint32_t index = add(op_string);
+
+                    expression.mExprs[index].text = token.text.str();
+
+                    return index;
+                }
+
+                case tk_number: {
+                    const uint32_t index = add(op_number);
+                    std::string    digits;
+
+                    for (charT c : token.text)
+                        digits += static_cast<char>(c);
+
+                    expression.mExprs[index].number = std::strtod(digits.c_str(), nullptr);
+
+                    return index;
+                }
+
+                case tk_function:
+                    return parseFunction(token);
+
+                default:
+                    return failed("an expression is expected", token.offset);
+                }
+            }
+
+            //! \brief Parse \c FunctionCall.
+            uint32_t parseFunction(const token_t& token)
+            {
+                //! A function of the core library.
+                struct signature_t {
+                    const char* name;     //!< The name.
+                    function_t  function; //!< The function.
+                    unsigned    min;      //!< The least number of arguments.
+                    unsigned    max;      //!< The most number of arguments.
+                    bool        nodes;    //!< Whether the arguments are node-sets.
+                };
+
+                static const signature_t functions[] = {
+                    { "last",             fn_last,             0, 0,       false },
+                    { "position",         fn_position,         0, 0,       false },
+                    { "count",            fn_count,            1, 1,       true  },
+                    { "id",               fn_id,               1, 1,       false },
+                    { "local-name",       fn_local_name,       0, 1,       true  },
+                    { "namespace-uri",    fn_namespace_uri,    0, 1,       true  },
+                    { "name",             fn_name,             0, 1,       true  },
+                    { "string",           fn_string,           0, 1,       false },
+                    { "concat",           fn_concat,           2, ~0u,     false },
+                    { "starts-with",      fn_starts_with,      2, 2,       false },
+                    { "contains",         fn_contains,         2, 2,       false },
+                    { "substring-before", fn_substring_before, 2, 2,       false },
+                    { "substring-after",  fn_substring_after,  2, 2,       false },
+                    { "substring",        fn_substring,        2, 3,       false },
+                    { "string-length",    fn_string_length,    0, 1,       false },
+                    { "normalize-space",  fn_normalize_space,  0, 1,       false },
+                    { "translate",        fn_translate,        3, 3,       false },
+                    { "boolean",          fn_boolean,          1, 1,       false },
+                    { "not",              fn_not,              1, 1,       false },
+                    { "true",             fn_true,             0, 0,       false },
+                    { "false",            fn_false,            0, 0,       false },
+                    { "lang",             fn_lang,             1, 1,       false },
+                    { "number",           fn_number,           0, 1,       false },
+                    { "sum",              fn_sum,              1, 1,       true  },
+                    { "floor",            fn_floor,            1, 1,       false },
+                    { "ceiling",          fn_ceiling,          1, 1,       false },
+                    { "round",            fn_round,            1, 1,       false }
+                };
+
+                const signature_t* signature = nullptr;
+
+                for (const signature_t& candidate : functions)
+                    if (token.text.equals(candidate.name))
+                        signature = &candidate;
+
+                if (signature == nullptr)
+                    return failed("unknown function", token.offset);
+
+                std::vector<uint32_t> args;
+
+                next();
+
+                if (peek().kind != tk_rparen)
+                    while (true) {
+                        const size_t   where = peek().offset;
+                        const uint32_t arg   = parseOr();
+
+                        if (arg == npos)
+                            return npos;
+
+                        if (signature->nodes && !nodeSet(arg))
+                            return failed("a node-set is expected", where);
+
+                        args.push_back(arg);
+
+                        if (peek().kind != tk_comma)
+                            break;
+
+                        next();
+                    }
+
+                if (!expect(tk_rparen, ") is expected"))
+                    return npos;
+
+                if (args.size() < signature->min || args.size() > signature->max)
+                    return failed("wrong number of arguments", token.offset);
+
+                expr_t e;
+
+                e.op       = op_function;
+                e.function = signature->function;
+                e.args     = std::move(args);
+                e.number   = 0;
+                e.path     = npos;
+
+                return expression.add(std::move(e));
+            }
+
+            expression_t&        expression; //!< The expression compiled.
+            const bindings_t&    bindings;   //!< The namespace bindings.
+            std::vector<token_t> tokens;     //!< The tokens of the expression.
+            size_t               current;    //!< The index of the current token.
+        };
+
+        //! \brief Constructor.
+        explicit basic_xpath_expression(const view_t& source)
+        :
+            mSource(source.str()),
+            mExprs(),
+            mTypes(),
+            mPaths(),
+            mUris(),
+            mRoot(npos),
+            mStreamable(false)
+        {}
+
+        //! \brief Get the index of a namespace URI, adding it if needed.
+        uint32_t uri(const view_t& uri)
+        {
+            for (size_t i = 0; i != mUris.size(); ++i)
+                if (view_t(mUris[i]) == uri)
+                    return static_cast<uint32_t>(i);
+
+            mUris.push_back(uri.str());
+
+            return static_cast<uint32_t>(mUris.size() - 1);
+        }
+
+        //! \brief Add a path.
+        uint32_t addPath(path_t&& path)
+        {
+            mPaths.push_back(std::move(path));
+
+            expr_t e;
+
+            e.op       = op_path;
+            e.function = fn_last;
+            e.number   = 0;
+            e.path     = static_cast<uint32_t>(mPaths.size() - 1);
+
+            return add(std::move(e));
+        }
+
+        //! \brief Add a sub-expression.
+        /*!
+         *  A sub-expression whose operands are all constant, and whose
+         *  value does not depend on the context, is replaced by its value.
+         */
+        uint32_t add(expr_t&& e)
+        {
+            const uint32_t index = static_cast<uint32_t>(mExprs.size());
+
+            mExprs.push_back(std::move(e));
+            mTypes.push_back(typeOf(mExprs.back()));
+
+            fold(index);
+
+            return index;
+        }
+
+        //! \brief Whether a sub-expression is a literal.
+        bool constant(uint32_t index) const
+        {
+            const op_t op = mExprs[index].op;
+
+            return op == op_string || op == op_number || op == op_boolean;
+        }
+
+        //! \brief Get the static type of a sub-expression.
+        type_t typeOf(const expr_t& e) const
+        {
+            switch (e.op) {
+            case op_string:
+                return result_string;
+
+            case op_number:
+            case op_add:
+            case op_subtract:
+            case op_multiply:
+            case op_divide:
+            case op_modulo:
+            case op_negate:
+                return result_number;
+
+            case op_variable:
+                return result_any;
+
+            case op_path:
+            case op_union:
+                return result_node_set;
+
+            case op_function:
+                switch (e.function) {
+                case fn_id:
+                    return result_node_set;
+
+                case fn_local_name:
+                case fn_namespace_uri:
+                case fn_name:
+                case fn_string:
+                case fn_concat:
+                case fn_substring_before:
+                case fn_substring_after:
+                case fn_substring:
+                case fn_normalize_space:
+                case fn_translate:
+                    return result_string;
+
+                case fn_starts_with:
+                case fn_contains:
+                case fn_boolean:
+                case fn_not:
+                case fn_true:
+                case fn_false:
+                case fn_lang:
+                    return result_boolean;
+
+                default:
+                    return result_number;
+                }
+
+            default:
+                return result_boolean;
+            }
+        }
+
+        //! \brief Fold a constant sub-expression.
+        void fold(uint32_t index)
+        {
+            const expr_t& e = mExprs[index];
+
+            switch (e.op) {
+            case op_string:
+            case op_number:
+            case op_boolean:
+            case op_variable:
+            case op_path:
+            case op_union:
+                return;
+
+            case op_or:
+            case op_and:
+                for (uint32_t arg : e.args)
+                    if (constant(arg) && value(arg).boolean() == (e.op == op_or)) {
+                        literal(index, value_t(e.op == op_or));
+
+                        return;
+                    }
+
+                break;
+
+            case op_function:
+                switch (e.function) {
+                case fn_last:
+                case fn_position:
+                case fn_count:
+                case fn_id:
+                case fn_local_name:
+                case fn_namespace_uri:
+                case fn_name:
+                case fn_lang:
+                case fn_sum:
+                    return;
+
+                case fn_true:
+                case fn_false:
+                    break;
+
+                default:
+                    if (e.args.empty())
+                        return;
+                }
+
+                break;
+
+            default:
+                break;
+            }
+
+            for (uint32_t arg : e.args)
+                if (!constant(arg))
+                    return;
+
+            literal(index, value(index));
+        }
+
+        //! \brief Evaluate a sub-expression that does not depend on the context.
+        value_t value(uint32_t index) const
+        {
+            const node_t none;
+            context_t    state(*this, none, &context_t::empty(), nullptr);
+
+            return eval(index, focus_t(none), state);
+        }
+
+        //! \brief Replace a sub-expression by a literal.
+        void literal(uint32_t index, const value_t& value)
+        {
+            expr_t& e = mExprs[index];
+
+            e.args.clear();
+
+            switch (value.type()) {
+            case value_t::boolean_type:
+                e.op     = op_boolean;
+                e.number = value.boolean() ? 1 : 0;
+                mTypes[index] = result_boolean;
+                break;
+
+            case value_t::number_type:
+                e.op     = op_number;
+                e.number = value.number();
+                mTypes[index] = result_number;
+                break;
+
+            default:
+                e.op   = op_string;
+                e.text = value.string();
+                mTypes[index] = result_string;
+                break;
+            }
+        }
+
+        //! \brief Whether a sub-expression reads the context position or size.
+        bool positional(uint32_t index) const
+        {
+            const expr_t& e = mExprs[index];
+
+            if (e.op == op_function && (e.function == fn_last || e.function == fn_position))
+                return true;
+
+            if (e.op == op_path)
+                return mPaths[e.path].filter != npos && positional(mPaths[e.path].filter);
+
+            for (uint32_t arg : e.args)
+                if (positional(arg))
+                    return true;
+
+            return false;
+        }
+
+        //! \brief Optimize the paths of the expression.
+        void optimize()
+        {
+            for (path_t& path : mPaths) {
+                for (step_t& step : path.steps)
+                    classify(step);
+
+                fuse(path);
+
+                for (step_t& step : path.steps)
+                    key(step);
+
+                path.ordered = order(path) != order_unordered;
+            }
+
+            mStreamable = streams();
+        }
+
+        //! \brief Remove the constant predicates of a step, and find how to check the others.
+        void classify(step_t& step) const
+        {
+            std::vector<uint32_t> predicates;
+            size_t                constants = 0;
+
+            step.positions.clear();
+
+            for (uint32_t predicate : step.predicates) {
+                const expr_t& e = mExprs[predicate];
+
+                if (e.op == op_number) {
+                    if (e.number < 1 || std::floor(e.number) != e.number)
+                        step.empty = true;
+
+                    predicates.push_back(predicate);
+                    step.positions.push_back(static_cast<size_t>(std::min(e.number, 1e18)));
+                    ++constants;
+                } else if (constant(predicate)) {
+                    if (!value(predicate).boolean())
+                        step.empty = true;
+                } else {
+                    predicates.push_back(predicate);
+                    step.positions.push_back(0);
+
+                    if (mTypes[predicate] == result_number || mTypes[predicate] == result_any || positional(predicate))
+                        step.materialize = true;
+                }
+            }
+
+            if (constants > max_positions)
+                step.materialize = true;
+
+            step.predicates.swap(predicates);
+        }
+
+        //! \brief Find the predicate of a descendant step that an attribute index can answer.
+        void key(step_t& step) const
+        {
+            step.key = npos;
+
+            if ((step.axis != axis_descendant && step.axis != axis_descendant_or_self) || step.test == test_node ||
+                step.test == test_text || step.materialize ||
+                std::count(step.positions.begin(), step.positions.end(), size_t(0)) != ptrdiff_t(step.positions.size()))
+                return;
+
+            for (uint32_t predicate : step.predicates) {
+                const step_t* attribute = nullptr;
+                uint32_t      operand   = npos;
+
+                if (keyed(predicate, attribute, operand)) {
+                    step.key = predicate;
+                    return;
+                }
+            }
+        }
+
+        //! \brief Whether a predicate compares an attribute to a literal or a variable.
+        /*!
+         *  \param [in]  index     The predicate.
+         *  \param [out] attribute The attribute step of the predicate.
+         *  \param [out] operand   The literal or the variable.
+         */
+        bool keyed(uint32_t index, const step_t*& attribute, uint32_t& operand) const
+        {
+            const expr_t& e = mExprs[index];
+
+            if (e.op != op_equal)
+                return false;
+
+            for (size_t i = 0; i != 2; ++i) {
+                const expr_t& lhs = mExprs[e.args[i]];
+                const expr_t& rhs = mExprs[e.args[1 - i]];
+
+                if (lhs.op != op_path || (rhs.op != op_string && rhs.op != op_variable))
+                    continue;
+
+                const path_t& path = mPaths[lhs.path];
+
+                if (path.filter == npos && !path.absolute && path.steps.size() == 1 &&
+                    path.steps.front().axis == axis_attribute && path.steps.front().test == test_name &&
+                    path.steps.front().predicates.empty()) {
+                    attribute = &path.steps.front();
+                    operand   = e.args[1 - i];
+
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        //! \brief Fuse the steps of a path.
+        /*!
+         *  \c descendant-or-self::node()/child::x becomes \c descendant::x
+         *  when the predicates of \c x do not depend on positions, and
+         *  \c self::node() steps between others are removed.
+         */
+        static void fuse(path_t& path)
+        {
+            std::vector<step_t>& steps = path.steps;
+
+            for (size_t i = 0; i + 1 < steps.size(); ) {
+                step_t& a = steps[i];
+                step_t& b = steps[i + 1];
+
+                const bool any = a.test == test_node && a.predicates.empty() && !a.empty;
+
+                if (any && a.axis == axis_descendant_or_self && (b.axis == axis_child || b.axis == axis_descendant) &&
+                    !b.materialize && std::count(b.positions.begin(), b.positions.end(), size_t(0)) == ptrdiff_t(b.positions.size())) {
+                    b.axis = axis_descendant;
+                    steps.erase(steps.begin() + i);
+                } else if (b.axis == axis_self && b.test == test_node && b.predicates.empty() && !b.empty) {
+                    steps.erase(steps.begin() + i + 1);
+                } else if (i == 0 && any && a.axis == axis_self && path.filter == npos && !path.absolute) {
+                    steps.erase(steps.begin());
+                } else {
+                    ++i;
+                }
+            }
+        }
+
+        //! \brief Find the order in which a path produces its nodes.
+        static order_t order(const path_t& path)
+        {
+            order_t current = path.filter != npos ? order_document : order_single;
+
+            for (const step_t& step : path.steps) {
+                if (step.empty)
+                    return order_single;
+
+                switch (step.axis) {
+                case axis_self:
+                    break;
+
+                case axis_child:
+                case axis_attribute:
+                    current = current == order_document && step.axis == axis_attribute ? order_disjoint :
+                              current == order_single || current == order_disjoint ? order_disjoint : order_unordered;
+                    break;
+
+                case axis_descendant:
+                case axis_descendant_or_self:
+                    current = current == order_single || current == order_disjoint ? order_document : order_unordered;
+                    break;
+
+                case axis_parent:
+                    current = current == order_single ? order_single : order_unordered;
+                    break;
+
+                case axis_following_sibling:
+                    current = current == order_single ? order_disjoint : order_unordered;
+                    break;
+
+                case axis_following:
+                    current = current == order_single ? order_document : order_unordered;
+                    break;
+
+                default:
+                    current = order_unordered;
+                    break;
+                }
+            }
+
+            return current;
+        }
+
+        //! \brief Whether the expression can be evaluated on parser events.
+        bool streams() const
+        {
+            if (mExprs[mRoot].op != op_path)
+                return false;
+
+            const path_t& path = mPaths[mExprs[mRoot].path];
+
+            if (path.filter != npos || !path.absolute || path.steps.empty() || path.steps.size() >= 64)
+                return false;
+
+            for (const step_t& step : path.steps) {
+                if (step.axis != axis_child && step.axis != axis_descendant)
+                    return false;
+
+                if (step.test != test_name && step.test != test_any && step.test != test_namespace)
+                    return false;
+
+                if (step.materialize)
+                    return false;
+
+                for (size_t i = 0; i != step.predicates.size(); ++i)
+                    if (step.positions[i] != 0 || !local(step.predicates[i]))
+                        return false;
+            }
+
+            return true;
+        }
+
+        //! \brief Whether a predicate only reads the attributes and the name of its context element.
+        bool local(uint32_t index) const
+        {
+            const expr_t& e = mExprs[index];
+
+            if (e.op == op_path) {
+                const path_t& path = mPaths[e.path];
+
+                return path.filter == npos && !path.absolute && path.steps.size() == 1 &&
+                       path.steps.front().axis == axis_attribute && path.steps.front().predicates.empty();
+            }
+
+            if (e.op == op_function)
+                switch (e.function) {
+                case fn_last:
+                case fn_position:
+                case fn_id:
+                case fn_lang:
+                    return false;
+
+                case fn_string:
+                case fn_number:
+                case fn_string_length:
+                case fn_normalize_space:
+                    if (e.args.empty())
+                        return false;
+
+                    break;
+
+                default:
+                    break;
+                }
+
+            for (uint32_t arg : e.args)
+                if (!local(arg))
+                    return false;
+
+            return true;
+        }
+
+        //! \brief Whether a sub-expression is a pattern.
+        bool pattern(uint32_t index) const
+        {
+            const expr_t& e = mExprs[index];
+
+            if (e.op == op_union)
+                return pattern(e.args[0]) && pattern(e.args[1]);
+
+            if (e.op != op_path || mPaths[e.path].filter != npos)
+                return false;
+
+            const std::vector<step_t>& steps = mPaths[e.path].steps;
+
+            for (size_t i = 0; i != steps.size(); ++i) {
+                const step_t& step = steps[i];
+
+                switch (step.axis) {
+                case axis_child:
+                    break;
+
+                case axis_attribute:
+                    if (i + 1 != steps.size())
+                        return false;
+
+                    break;
+
+                case axis_descendant:
+                    if (step.materialize || std::count(step.positions.begin(), step.positions.end(), size_t(0)) != ptrdiff_t(step.positions.size()))
+                        return false;
+
+                    break;
+
+                case axis_descendant_or_self:
+                    if (step.test != test_node || !step.predicates.empty() || i + 1 == steps.size())
+                        return false;
+
+                    break;
+
+                default:
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        //! \brief Whether a node matches a pattern.
+        bool match(uint32_t index, const node_t& node, context_t& context) const
+        {
+            const expr_t& e = mExprs[index];
+
+            if (e.op == op_union)
+                return match(e.args[0], node, context) || match(e.args[1], node, context);
+
+            if (e.op != op_path || mPaths[e.path].filter != npos)
+                return false;
+
+            const path_t& path = mPaths[e.path];
+
+            if (path.steps.empty())
+                return path.absolute && node == context.root;
+
+            return match(path, path.steps.size() - 1, node, context);
+        }
+
+        //! \brief Whether a node matches the steps of a pattern, up to a step.
+        bool match(const path_t& path, size_t index, const node_t& node, context_t& context) const
+        {
+            const step_t& step = path.steps[index];
+
+            if (step.empty)
+                return false;
+
+            if (step.axis == axis_descendant_or_self) {
+                if (index == 0)
+                    return true;
+
+                for (node_t up = node; up; up = up.parent())
+                    if (match(path, index - 1, up, context))
+                        return true;
+
+                return false;
+            }
+
+            if (step.axis != axis_attribute && (node.kind() == node_t::attribute_kind || node.kind() == node_t::document_kind))
+                return false;
+
+            if (!test(step, node, context))
+                return false;
+
+            if (step.axis == axis_child || step.axis == axis_attribute) {
+                const node_t parent = node.parent();
+
+                if (!parent)
+                    return index == 0 && !path.absolute && step.axis == axis_child && !positional(step) && check(step, node, parent, context);
+
+                if (!check(step, node, parent, context))
+                    return false;
+
+                return index == 0 ? !path.absolute || parent == context.root : match(path, index - 1, parent, context);
+            }
+
+            for (uint32_t predicate : step.predicates)
+                if (!truth(predicate, focus_t(node), context))
+                    return false;
+
+            if (index == 0)
+                return path.absolute ? node != context.root : bool(node.parent());
+
+            for (node_t up = node.parent(); up; up = up.parent())
+                if (match(path, index - 1, up, context))
+                    return true;
+
+            return false;
+        }
+
+        //! \brief Whether the predicates of a step depend on the position of the nodes.
+        static bool positional(const step_t& step)
+        {
+            return step.materialize || std::count(step.positions.begin(), step.positions.end(), size_t(0)) != ptrdiff_t(step.positions.size());
+        }
+
+        //! \brief Whether a node satisfies the predicates of a child or attribute step of a pattern.
+        bool check(const step_t& step, const node_t& node, const node_t& parent, context_t& context) const
+        {
+            if (step.predicates.empty())
+                return true;
+
+            if (!positional(step)) {
+                for (uint32_t predicate : step.predicates)
+                    if (!truth(predicate, focus_t(node), context))
+                        return false;
+
+                return true;
+            }
+
+            node_set_t candidates;
+            auto       collect = [&](const node_t& candidate) {
+                if (test(step, candidate, context))
+                    candidates.push_back(candidate);
+
+                return true;
+            };
+
+            axis(step.axis, parent, collect);
+            filter(step.predicates, candidates, context);
+
+            return std::find(candidates.begin(), candidates.end(), node) != candidates.end();
+        }
+
+        //! \brief Evaluate a sub-expression.
+        value_t eval(uint32_t index, const focus_t& focus, context_t& context) const
+        {
+            const expr_t& e = mExprs[index];
+
+            switch (e.op) {
+            case op_string:
+                return value_t(e.text);
+
+            case op_number:
+                return value_t(e.number);
+
+            case op_boolean:
+                return value_t(e.number != 0);
+
+            case op_variable:
+                if (context.variables != nullptr) {
+                    typename variables_t::const_iterator it = context.variables->find(e.text);
+
+                    if (it != context.variables->end())
+                        return it->second;
+                }
+
+                return value_t();
+
+            case op_path:
+            case op_union:
+                return value_t(nodes(index, focus, context));
+
+            case op_add:
+                return value_t(number(e.args[0], focus, context) + number(e.args[1], focus, context));
+
+            case op_subtract:
+                return value_t(number(e.args[0], focus, context) - number(e.args[1], focus, context));
+
+            case op_multiply:
+                return value_t(number(e.args[0], focus, context) * number(e.args[1], focus, context));
+
+            case op_divide:
+                return value_t(number(e.args[0], focus, context) / number(e.args[1], focus, context));
+
+            case op_modulo:
+                return value_t(std::fmod(number(e.args[0], focus, context), number(e.args[1], focus, context)));
+
+            case op_negate:
+                return value_t(-number(e.args[0], focus, context));
+
+            case op_function:
+                return call(e, focus, context);
+
+            default:
+                return value_t(truth(index, focus, context));
+            }
+        }
+
+        //! \brief Evaluate a sub-expression as a boolean.
+        bool truth(uint32_t index, const focus_t& focus, context_t& context) const
+        {
+            const expr_t& e = mExprs[index];
+
+            switch (e.op) {
+            case op_boolean:
+                return e.number != 0;
+
+            case op_path:
+            case op_union: {
+                bool found = false;
+                auto stop  = [&found](const node_t&) { found = true; return false; };
+
+                visit(index, focus, context, stop, false);
+
+                return found;
+            }
+
+            case op_or:
+                return truth(e.args[0], focus, context) || truth(e.args[1], focus, context);
+
+            case op_and:
+                return truth(e.args[0], focus, context) && truth(e.args[1], focus, context);
+
+            case op_equal:
+            case op_unequal:
+            case op_less:
+            case op_lessEq:
+            case op_greater:
+            case op_greaterEq:
+                return compare(e.op, e.args[0], e.args[1], focus, context);
+
+            case op_function:
+                switch (e.function) {
+                case fn_boolean:
+                    return truth(e.args[0], focus, context);
+
+                case fn_not:
+                    return !truth(e.args[0], focus, context);
+
+                default:
+                    break;
+                }
+
+                break;
+
+            default:
+                break;
+            }
+
+            return eval(index, focus, context).boolean();
+        }
+
+        //! \brief Evaluate a sub-expression as a number.
+        double number(uint32_t index, const focus_t& focus, context_t& context) const
+        {
+            if (mTypes[index] == result_node_set) {
+                const node_t node = first(index, focus, context);
+
+                return node ? value_t::to_number(node) : std::numeric_limits<double>::quiet_NaN();
+            }
+
+            return mExprs[index].op == op_number ? mExprs[index].number : eval(index, focus, context).number();
+        }
+
+        //! \brief Evaluate a sub-expression as a string.
+        string_t string(uint32_t index, const focus_t& focus, context_t& context) const
+        {
+            if (mTypes[index] == result_node_set)
+                return first(index, focus, context).string_value();
+
+            return mExprs[index].op == op_string ? mExprs[index].text : eval(index, focus, context).string();
+        }
+
+        //! \brief Evaluate a sub-expression as a node-set.
+        /*!
+         *  \return The nodes in document order, or an empty list if the
+         *          value is not a node-set.
+         */
+        node_set_t nodes(uint32_t index, const focus_t& focus, context_t& context) const
+        {
+            const expr_t& e = mExprs[index];
+            node_set_t    result;
+
+            if (e.op == op_path) {
+                auto collect = [&result](const node_t& node) { result.push_back(node); return true; };
+
+                visit(mPaths[e.path], focus, context, collect);
+
+                if (!mPaths[e.path].ordered)
+                    sort(result, context);
+            } else if (e.op == op_union) {
+                result = nodes(e.args[0], focus, context);
+
+                const node_set_t rhs = nodes(e.args[1], focus, context);
+
+                result.insert(result.end(), rhs.begin(), rhs.end());
+                sort(result, context);
+            } else {
+                value_t value = eval(index, focus, context);
+
+                result.swap(value.nodes());
+
+                if (e.op == op_variable)
+                    sort(result, context);
+            }
+
+            return result;
+        }
+
+        //! \brief Get the first node of a sub-expression in document order.
+        node_t first(uint32_t index, const focus_t& focus, context_t& context) const
+        {
+            node_t result;
+            auto   stop = [&result](const node_t& node) { result = node; return false; };
+
+            visit(index, focus, context, stop, true);
+
+            return result;
+        }
+
+        //! \brief Hand the nodes of a sub-expression to a function.
+        /*!
+         *  \param [in] ordered Whether the nodes must be handed in document
+         *                      order, without duplicates.
+         *
+         *  \return \c false if \c function stopped the walk.
+         */
+        template <typename functionT>
+        bool visit(uint32_t index, const focus_t& focus, context_t& context, functionT& function, bool ordered) const
+        {
+            const expr_t& e = mExprs[index];
+
+            if (e.op == op_path && (!ordered || mPaths[e.path].ordered))
+                return visit(mPaths[e.path], focus, context, function);
+
+            if (e.op == op_union && !ordered)
+                return visit(e.args[0], focus, context, function, false) && visit(e.args[1], focus, context, function, false);
+
+            for (const node_t& node : nodes(index, focus, context))
+                if (!function(node))
+                    return false;
+
+            return true;
+        }
+
+        //! \brief Hand the nodes of a path to a function.
+        template <typename functionT>
+        bool visit(const path_t& path, const focus_t& focus, context_t& context, functionT& function) const
+        {
+            if (path.filter == npos)
+                return walk(path, 0, path.absolute ? context.root : focus.node, context, function);
+
+            node_set_t start = nodes(path.filter, focus, context);
+
+            filter(path.predicates, start, context);
+
+            for (const node_t& node : start)
+                if (!walk(path, 0, node, context, function))
+                    return false;
+
+            return true;
+        }
+
+        //! \brief Walk the steps of a path from a node.
+        /*!
+         *  \param [in] path     The path.
+         *  \param [in] index    The index of the next step.
+         *  \param [in] node     The node the step starts from.
+         *  \param [in] context  The state of the evaluation.
+         *  \param [in] function The function the nodes of the last step are handed to.
+         *
+         *  \return \c false if \c function stopped the walk.
+         */
+        template <typename functionT>
+        bool walk(const path_t& path, size_t index, const node_t& node, context_t& context, functionT& function) const
+        {
+            if (index == path.steps.size())
+                return function(node);
+
+            const step_t& step = path.steps[index];
+
+            if (step.empty || !node)
+                return true;
+
+            bool proceed = true;
+
+            if (step.key != npos && lookup(path, index, node, context, function, proceed))
+                return proceed;
+
+            if (step.materialize) {
+                node_set_t candidates;
+                auto       collect = [&](const node_t& candidate) {
+                    if (test(step, candidate, context))
+                        candidates.push_back(candidate);
+
+                    return true;
+                };
+
+                axis(step.axis, node, collect);
+                filter(step.predicates, candidates, context);
+
+                for (const node_t& candidate : candidates)
+                    if (!walk(path, index + 1, candidate, context, function))
+                        return false;
+
+                return true;
+            }
+
+            size_t counts[max_positions] = {};
+
+            auto next = [&](const node_t& candidate) {
+                if (!test(step, candidate, context))
+                    return true;
+
+                bool last = false;
+
+                for (size_t i = 0, k = 0; i != step.predicates.size(); ++i) {
+                    if (step.positions[i] != 0) {
+                        const size_t count = ++counts[k++];
+
+                        if (count != step.positions[i])
+                            return count < step.positions[i];
+
+                        last = true;
+                    } else if (!truth(step.predicates[i], focus_t(candidate), context))
+                        return !last;
+                }
+
+                proceed = walk(path, index + 1, candidate, context, function);
+
+                return proceed && !last;
+            };
+
+            axis(step.axis, node, next);
+
+            return proceed;
+        }
+
+        //! \brief Walk a step through the attribute index of the document.
+        /*!
+         *  The candidates of the step are the elements carrying the
+         *  attribute its key predicate compares, that are descendants of
+         *  \c node. They are checked against all the predicates.
+         *
+         *  \param [out] proceed Set to \c false if \c function stopped the walk.
+         *
+         *  \return \c false if the document has no index, or if the key
+         *          predicate does not compare the attribute to a string.
+         */
+        template <typename functionT>
+        bool lookup(const path_t& path, size_t index, const node_t& node, context_t& context, functionT& function, bool& proceed) const
+        {
+            const step_t&     step     = path.steps[index];
+            const document_t* document = context.root.document();
+            const parent_t*   top      = node.parent_node();
+
+            if (document == nullptr || top == nullptr || !document->indexes_attributes() || context.table != &document->namespaces())
+                return false;
+
+            const step_t* attribute = nullptr;
+            uint32_t      operand   = npos;
+
+            keyed(step.key, attribute, operand);
+
+            const value_t value = eval(operand, focus_t(node), context);
+
+            if (value.type() != value_t::string_type)
+                return false;
+
+            const string_t str = value.string();
+
+            for (const element_t* element : document->attribute_index()->find(context.ids[attribute->uri], view_t(attribute->local), view_t(str))) {
+                const node_t candidate(*element);
+
+                if (!descends(*element, top, step.axis == axis_descendant_or_self) || !test(step, candidate, context))
+                    continue;
+
+                bool accepted = true;
+
+                for (uint32_t predicate : step.predicates)
+                    if (!truth(predicate, focus_t(candidate), context)) {
+                        accepted = false;
+                        break;
+                    }
+
+                if (accepted && !walk(path, index + 1, candidate, context, function)) {
+                    proceed = false;
+                    break;
+                }
+            }
+
+            return true;
+        }
+
+        //! \brief Whether an element is a descendant of a node, or the node itself if \c self.
+        static bool descends(const element_t& element, const parent_t* top, bool self)
+        {
+            const parent_t* it = self ? &element : &element.parent();
+
+            while (it != top) {
+                if (it->kind() != node_interface_t::element_kind)
+                    return false;
+
+                it = &static_cast<const element_t*>(it)->parent();
+            }
+
+            return true;
+        }
+
+        //! \brief Hand the nodes of an axis to a function, in the order of the axis.
+        /*!
+         *  \return \c false if \c function stopped the walk.
+         */
+        template <typename functionT>
+        static bool axis(axis_t axis, const node_t& node, functionT& function)
+        {
+            const parent_t* parent = node.parent_node();
+            const child_t*  child  = node.child_node();
+
+            switch (axis) {
+            case axis_self:
+                return function(node);
+
+            case axis_child:
+                for (const child_t* it = parent != nullptr ? node_t::first_child(*parent) : nullptr; it != nullptr; it = it->next_sibling())
+                    if (!emit(*it, function))
+                        return false;
+
+                return true;
+
+            case axis_descendant_or_self:
+                if (!function(node))
+                    return false;
+
+                return descendants(parent, function);
+
+            case axis_descendant:
+                return descendants(parent, function);
+
+            case axis_parent: {
+                const node_t up = node.parent();
+
+                return !up || function(up);
+            }
+
+            case axis_ancestor_or_self:
+                if (!function(node))
+                    return false;
+
+                return ancestors(node, function);
+
+            case axis_ancestor:
+                return ancestors(node, function);
+
+            case axis_attribute:
+                if (node.element() != nullptr)
+                    for (const attribute_t& attribute : node.element()->attributes())
+                        if (!declaration(attribute) && !function(node_t(*node.element(), attribute)))
+                            return false;
+
+                return true;
+
+            case axis_following_sibling:
+                for (const child_t* it = child != nullptr ? child->next_sibling() : nullptr; it != nullptr; it = it->next_sibling())
+                    if (!emit(*it, function))
+                        return false;
+
+                return true;
+
+            case axis_preceding_sibling:
+                for (const child_t* it = child != nullptr ? child->previous_sibling() : nullptr; it != nullptr; it = it->previous_sibling())
+                    if (!emit(*it, function))
+                        return false;
+
+                return true;
+
+            case axis_following:
+                if (node.owner() != nullptr) {
+                    if (!descendants(node.owner(), function))
+                        return false;
+
+                    child = node.owner();
+                }
+
+                for (const child_t* it = child != nullptr ? node_t::skip(child, nullptr) : nullptr; it != nullptr; it = node_t::following(it, nullptr))
+                    if (!emit(*it, function))
+                        return false;
+
+                return true;
+
+            case axis_preceding:
+                if (node.owner() != nullptr)
+                    child = node.owner();
+
+                while (child != nullptr) {
+                    for (const child_t* it = child->previous_sibling(); it != nullptr; it = it->previous_sibling())
+                        if (!reverse(*it, function))
+                            return false;
+
+                    const node_t up = node_t::from_child(*child).parent();
+
+                    child = up.element();
+                }
+
+                return true;
+
+            default:
+                return true;
+            }
+        }
+
+        //! \brief Hand a child to a function, if it is a node of the data model.
+        template <typename functionT>
+        static bool emit(const child_t& child, functionT& function)
+        {
+            const node_t node = node_t::from_child(child);
+
+            return !node || function(node);
+        }
+
+        //! \brief Hand the descendants of a node to a function, in document order.
+        template <typename functionT>
+        static bool descendants(const parent_t* parent, functionT& function)
+        {
+            if (parent == nullptr)
+                return true;
+
+            for (const child_t* it = node_t::first_child(*parent); it != nullptr; it = node_t::following(it, parent))
+                if (!emit(*it, function))
+                    return false;
+
+            return true;
+        }
+
+        //! \brief Hand the ancestors of a node to a function, from its parent up.
+        template <typename functionT>
+        static bool ancestors(const node_t& node, functionT& function)
+        {
+            for (node_t up = node.parent(); up; up = up.parent())
+                if (!function(up))
+                    return false;
+
+            return true;
+        }
+
+        //! \brief Hand a child and its descendants to a function, in reverse document order.
+        template <typename functionT>
+        static bool reverse(const child_t& child, functionT& function)
+        {
+            if (child.kind() == node_interface_t::element_kind) {
+                const element_t& element = static_cast<const element_t&>(child);
+
+                if (!element.empty())
+                    for (const child_t* it = &element.back(); it != nullptr; it = it->previous_sibling())
+                        if (!reverse(*it, function))
+                            return false;
+            }
+
+            return emit(child, function);
+        }
+
+        //! \brief Whether an attribute is a namespace declaration.
+        static bool declaration(const attribute_t& attribute)
+        {
+            const view_t name = attribute.name().view();
+
+            return attribute.namespace_id() == table_t::xmlns_namespace ||
+                   (name.size() >= 5 && name.substr(0, 5).equals("xmlns") && (name.size() == 5 || name[5] == ':'));
+        }
+
+        //! \brief Whether a node matches the node test of a step.
+        bool test(const step_t& step, const node_t& node, const context_t& context) const
+        {
+            switch (step.test) {
+            case test_node:
+                return true;
+
+            case test_text:
+                return node.kind() == node_t::text_kind;
+
+            case test_other:
+                return false;
+
+            default:
+                break;
+            }
+
+            view_t         local;
+            namespace_id_t ns;
+
+            if (step.axis == axis_attribute) {
+                if (node.kind() != node_t::attribute_kind)
+                    return false;
+
+                local = node.attribute()->local_name();
+                ns    = node.attribute()->namespace_id();
+            } else {
+                if (node.kind() != node_t::element_kind)
+                    return false;
+
+                local = node.element()->local_name();
+                ns    = node.element()->namespace_id();
+            }
+
+            if (step.test == test_any)
+                return true;
+
+            if (ns != context.ids[step.uri])
+                return false;
+
+            return step.test == test_namespace || local == view_t(step.local);
+        }
+
+        //! \brief Filter a list of nodes with predicates.
+        /*!
+         *  The position of each node is its index in the list, from 1.
+         */
+        void filter(const std::vector<uint32_t>& predicates, node_set_t& nodes, context_t& context) const
+        {
+            for (uint32_t predicate : predicates) {
+                node_set_t   kept;
+                const size_t size = nodes.size();
+
+                for (size_t i = 0; i != size; ++i)
+                    if (accept(predicate, focus_t(nodes[i], i + 1, size), context))
+                        kept.push_back(nodes[i]);
+
+                nodes.swap(kept);
+            }
+        }
+
+        //! \brief Whether a node satisfies a predicate.
+        /*!
+         *  A number is compared to the context position.
+         */
+        bool accept(uint32_t predicate, const focus_t& focus, context_t& context) const
+        {
+            if (mTypes[predicate] != result_number && mTypes[predicate] != result_any)
+                return truth(predicate, focus, context);
+
+            const value_t value = eval(predicate, focus, context);
+
+            return value.type() == value_t::number_type ? value.number() == static_cast<double>(focus.position) : value.boolean();
+        }
+
+        //! \brief Sort a list of nodes in document order, and remove duplicates.
+        void sort(node_set_t& nodes, context_t& context) const
+        {
+            if (nodes.size() < 2)
+                return;
+
+            if (context.order.empty())
+                rank(context);
+
+            const std::unordered_map<const void*, size_t>& order = context.order;
+
+            auto position = [&order](const node_t& node) {
+                typename std::unordered_map<const void*, size_t>::const_iterator it = order.find(node.key());
+
+                return it != order.end() ? it->second : order.size();
+            };
+
+            std::stable_sort(nodes.begin(), nodes.end(), [&position](const node_t& a, const node_t& b) {
+                return position(a) < position(b);
+            });
+
+            nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+        }
+
+        //! \brief Number the nodes of the tree of the context in document order.
+        static void rank(context_t& context)
+        {
+            size_t count = 0;
+
+            auto numbering = [&context, &count](const node_t& node) {
+                context.order.emplace(node.key(), count++);
+
+                if (node.element() != nullptr)
+                    for (const attribute_t& attribute : node.element()->attributes())
+                        context.order.emplace(node_t(*node.element(), attribute).key(), count++);
+
+                return true;
+            };
+
+            axis(axis_descendant_or_self, context.root, numbering);
+        }
+
+        //! \brief Get the string-value of a node, without copying attributes and texts.
+        static view_t view(const node_t& node, string_t& buffer)
+        {
+            switch (node.kind()) {
+            case node_t::attribute_kind:
+                return node.attribute()->value().view();
+
+            case node_t::text_kind:
+                return node.text()->data().view();
+
+            default:
+                buffer.clear();
+                node.append_string_value(buffer);
+
+                return view_t(buffer);
+            }
+        }
+
+        //! \brief Swap the operands of a relational operator.
+        static op_t mirror(op_t op)
+        {
+            switch (op) {
+            case op_less:      return op_greater;
+            case op_lessEq:    return op_greaterEq;
+            case op_greater:   return op_less;
+            case op_greaterEq: return op_lessEq;
+            default:           return op;
+            }
+        }
+
+        //! \brief Compare two numbers.
+        static bool compareNumbers(op_t op, double lhs, double rhs)
+        {
+            switch (op) {
+            case op_equal:     return lhs == rhs;
+            case op_unequal:   return lhs != rhs;
+            case op_less:      return lhs < rhs;
+            case op_lessEq:    return lhs <= rhs;
+            case op_greater:   return lhs > rhs;
+            default:           return lhs >= rhs;
+            }
+        }
+
+        //! \brief Compare a node to a value that is not a node-set.
+        static bool compareNode(op_t op, const node_t& node, const value_t& value, string_t& buffer)
+        {
+            if ((op == op_equal || op == op_unequal) && value.type() == value_t::string_type) {
+                const string_t str = value.string();
+
+                return (view(node, buffer) == view_t(str)) == (op == op_equal);
+            }
+
+            return compareNumbers(op, value_t::to_number(node), value.number());
+        }
+
+        //! \brief Compare two values that are not node-sets.
+        static bool compareScalars(op_t op, const value_t& lhs, const value_t& rhs)
+        {
+            if (op != op_equal && op != op_unequal)
+                return compareNumbers(op, lhs.number(), rhs.number());
+
+            if (lhs.type() == value_t::boolean_type || rhs.type() == value_t::boolean_type)
+                return (lhs.boolean() == rhs.boolean()) == (op == op_equal);
+
+            if (lhs.type() == value_t::number_type || rhs.type() == value_t::number_type)
+                return compareNumbers(op, lhs.number(), rhs.number());
+
+            return (lhs.string() == rhs.string()) == (op == op_equal);
+        }
+
+        //! \brief Evaluate a comparison.
+        /*!
+         *  A node-set compared to a string or a number is walked until a
+         *  node satisfies the comparison, without building the node-set.
+         */
+        bool compare(op_t op, uint32_t lhs, uint32_t rhs, const focus_t& focus, context_t& context) const
+        {
+            const bool left  = mTypes[lhs] == result_node_set;
+            const bool right = mTypes[rhs] == result_node_set;
+
+            if (left != right && mTypes[left ? rhs : lhs] != result_any) {
+                const uint32_t set    = left ? lhs : rhs;
+                const op_t     facing = left ? op : mirror(op);
+                const value_t  scalar = eval(left ? rhs : lhs, focus, context);
+
+                if (scalar.type() == value_t::boolean_type)
+                    return compareScalars(facing, value_t(truth(set, focus, context)), scalar);
+
+                const value_t operand = op == op_equal || op == op_unequal ? scalar : value_t(scalar.number());
+                string_t      buffer;
+                bool          found = false;
+
+                auto check = [&](const node_t& node) {
+                    found = compareNode(facing, node, operand, buffer);
+
+                    return !found;
+                };
+
+                visit(set, focus, context, check, false);
+
+                return found;
+            }
+
+            return compareValues(op, eval(lhs, focus, context), eval(rhs, focus, context));
+        }
+
+        //! \brief Compare two values.
+        static bool compareValues(op_t op, const value_t& lhs, const value_t& rhs)
+        {
+            const bool left  = lhs.type() == value_t::node_set_type;
+            const bool right = rhs.type() == value_t::node_set_type;
+
+            if (!left && !right)
+                return compareScalars(op, lhs, rhs);
+
+            if (left && right) {
+                string_t buffer;
+
+                for (const node_t& a : lhs.nodes())
+                    for (const node_t& b : rhs.nodes()) {
+                        if (op == op_equal || op == op_unequal) {
+                            const string_t str = view(a, buffer).str();
+
+                            if ((view(b, buffer) == view_t(str)) == (op == op_equal))
+                                return true;
+                        } else if (compareNumbers(op, value_t::to_number(a), value_t::to_number(b)))
+                            return true;
+                    }
+
+                return false;
+            }
+
+            const value_t& set    = left ? lhs : rhs;
+            const value_t& scalar = left ? rhs : lhs;
+            const op_t     facing = left ? op : mirror(op);
+
+            if (scalar.type() == value_t::boolean_type)
+                return compareScalars(facing, value_t(set.boolean()), scalar);
+
+            const value_t operand = op == op_equal || op == op_unequal ? scalar : value_t(scalar.number());
+            string_t      buffer;
+
+            for (const node_t& node : set.nodes())
+                if (compareNode(facing, node, operand, buffer))
+                    return true;
+
+            return false;
+        }
+
+        //! \brief Get the number of code units of the character at a position.
+        static size_t width(const charT* first, const charT* last)
+        {
+            const uint32_t code = scanner_t::code(*first);
+            size_t         size = 1;
+
+            if (sizeof(charT) == 1)
+                size = code >= 0xF0 ? 4 : code >= 0xE0 ? 3 : code >= 0xC0 ? 2 : 1;
+            else if (sizeof(charT) == 2)
+                size = code >= 0xD800 && code < 0xDC00 ? 2 : 1;
+
+            return std::min(size, static_cast<size_t>(last - first));
+        }
+
+        //! \brief Get the number of characters of a string.
+        static size_t length(const view_t& str)
+        {
+            size_t count = 0;
+
+            for (const charT* it = str.begin(); it != str.end(); it += width(it, str.end()))
+                ++count;
+
+            return count;
+        }
+
+        //! \brief Round a number as XPath does.
+        static double round(double number)
+        {
+            if (std::isnan(number) || std::isinf(number))
+                return number;
+
+            if (number < 0 && number >= -0.5)
+                return -0.0;
+
+            return std::floor(number + 0.5);
+        }
+
+        //! \brief Get the value of the \c xml:lang attribute in scope of a node.
+        static const attribute_t* language(node_t node)
+        {
+            if (node.owner() != nullptr || node.text() != nullptr)
+                node = node.parent();
+
+            for (; node.element() != nullptr; node = node.parent())
+                for (const attribute_t& attribute : node.element()->attributes())
+                    if (attribute.name().view().equals("xml:lang"))
+                        return &attribute;
+
+            return nullptr;
+        }
+
+        //! \brief Convert an ASCII upper case letter to lower case.
+        static charT lower(charT c)
+        {
+            return c >= 'A' && c <= 'Z' ? static_cast<charT>(c - 'A' + 'a') : c;
+        }
+
+        //! \brief Widen an ASCII string.
+        static string_t ascii(const char* str)
+        {
+            return value_t::ascii(str);
+        }
+
+        //! \brief Call a function of the core library.
+        value_t call(const expr_t& e, const focus_t& focus, context_t& context) const
+        {
+            const std::vector<uint32_t>& args = e.args;
+
+            switch (e.function) {
+            case fn_last:
+                return value_t(static_cast<double>(focus.size));
+
+            case fn_position:
+                return value_t(static_cast<double>(focus.position));
+
+            case fn_count: {
+                if (mExprs[args[0]].op == op_path && mPaths[mExprs[args[0]].path].ordered) {
+                    size_t count = 0;
+                    auto   counter = [&count](const node_t&) { ++count; return true; };
+
+                    visit(args[0], focus, context, counter, false);
+
+                    return value_t(static_cast<double>(count));
+                }
+
+                return value_t(static_cast<double>(nodes(args[0], focus, context).size()));
+            }
+
+            case fn_id:
+                return value_t(ids(args[0], focus, context));
+
+            case fn_local_name:
+            case fn_namespace_uri:
+            case fn_name: {
+                const node_t node = args.empty() ? focus.node : first(args[0], focus, context);
+                const element_t*   element   = node.element();
+                const attribute_t* attribute = node.attribute();
+
+                if (element == nullptr && attribute == nullptr)
+                    return value_t(string_t());
+
+                if (e.function == fn_local_name)
+                    return value_t((element != nullptr ? element->local_name() : attribute->local_name()).str());
+
+                if (e.function == fn_name)
+                    return value_t((element != nullptr ? element->name() : attribute->name()).str());
+
+                const namespace_id_t ns = element != nullptr ? element->namespace_id() : attribute->namespace_id();
+
+                return value_t(ns < context.table->size() ? context.table->uri(ns) : string_t());
+            }
+
+            case fn_string:
+                return value_t(args.empty() ? focus.node.string_value() : string(args[0], focus, context));
+
+            case fn_concat: {
+                string_t result;
+
+                for (uint32_t arg : args)
+                    result += string(arg, focus, context);
+
+                return value_t(std::move(result));
+            }
+
+            case fn_starts_with: {
+                const string_t str    = string(args[0], focus, context);
+                const string_t prefix = string(args[1], focus, context);
+
+                return value_t(str.compare(0, prefix.size(), prefix) == 0);
+            }
+
+            case fn_contains:
+                return value_t(string(args[0], focus, context).find(string(args[1], focus, context)) != string_t::npos);
+
+            case fn_substring_before:
+            case fn_substring_after: {
+                const string_t str     = string(args[0], focus, context);
+                const string_t pattern = string(args[1], focus, context);
+                const size_t   found   = str.find(pattern);
+
+                if (found == string_t::npos)
+                    return value_t(string_t());
+
+                return value_t(e.function == fn_substring_before ? str.substr(0, found) : str.substr(found + pattern.size()));
+            }
+
+            case fn_substring: {
+                const string_t str    = string(args[0], focus, context);
+                const double   start  = round(number(args[1], focus, context));
+                const double   end    = args.size() == 3 ? start + round(number(args[2], focus, context)) : HUGE_VAL;
+                const charT*   it     = str.data();
+                const charT*   last   = it + str.size();
+                string_t       result;
+
+                for (double position = 1; it != last; position += 1) {
+                    const size_t size = width(it, last);
+
+                    if (position >= start && position < end)
+                        result.append(it, size);
+
+                    it += size;
+                }
+
+                return value_t(std::move(result));
+            }
+
+            case fn_string_length: {
+                const string_t str = args.empty() ? focus.node.string_value() : string(args[0], focus, context);
+
+                return value_t(static_cast<double>(length(view_t(str))));
+            }
+
+            case fn_normalize_space: {
+                const string_t str = args.empty() ? focus.node.string_value() : string(args[0], focus, context);
+                const charT*   it  = str.data();
+                const charT*   end = it + str.size();
+                string_t       result;
+
+                while ((it = scanner_t::skip_whitespace(it, end)) != end) {
+                    const charT* word = it;
+
+                    while (it != end && !scanner_t::is_whitespace(*it))
+                        ++it;
+
+                    if (!result.empty())
+                        result += charT(' ');
+
+                    result.append(word, it);
+                }
+
+                return value_t(std::move(result));
+            }
+
+            case fn_translate: {
+                const string_t str  = string(args[0], focus, context);
+                const string_t from = string(args[1], focus, context);
+                const string_t to   = string(args[2], focus, context);
+                const charT*   it   = str.data();
+                const charT*   last = it + str.size();
+                string_t       result;
+
+                while (it != last) {
+                    const size_t size = width(it, last);
+                    const charT* f    = from.data();
+                    const charT* t    = to.data();
+                    bool         found = false;
+
+                    while (f != from.data() + from.size()) {
+                        const size_t fs = width(f, from.data() + from.size());
+
+                        if (fs == size && std::equal(f, f + fs, it)) {
+                            found = true;
+                            break;
+                        }
+
+                        f += fs;
+
+                        if (t != to.data() + to.size())
+                            t += width(t, to.data() + to.size());
+                    }
+
+                    if (!found)
+                        result.append(it, size);
+                    else if (t != to.data() + to.size())
+                        result.append(t, width(t, to.data() + to.size()));
+
+                    it += size;
+                }
+
+                return value_t(std::move(result));
+            }
+
+            case fn_boolean:
+            case fn_not:
+                return value_t(truth(args[0], focus, context) == (e.function == fn_boolean));
+
+            case fn_true:
+                return value_t(true);
+
+            case fn_false:
+                return value_t(false);
+
+            case fn_lang: {
+                const attribute_t* attribute = language(focus.node);
+
+                if (attribute == nullptr)
+                    return value_t(false);
+
+                const string_t wanted = string(args[0], focus, context);
+                const view_t   actual = attribute->value().view();
+
+                if (actual.size() < wanted.size() || (actual.size() > wanted.size() && actual[wanted.size()] != '-'))
+                    return value_t(false);
+
+                for (size_t i = 0; i != wanted.size(); ++i)
+                    if (lower(actual[i]) != lower(wanted[i]))
+                        return value_t(false);
+
+                return value_t(true);
+            }
+
+            case fn_number:
+                return value_t(args.empty() ? value_t::to_number(focus.node) : number(args[0], focus, context));
+
+            case fn_sum: {
+                double sum = 0;
+                auto   adder = [&sum](const node_t& node) { sum += value_t::to_number(node); return true; };
+
+                visit(args[0], focus, context, adder, true);
+
+                return value_t(sum);
+            }
+
+            case fn_floor:
+                return value_t(std::floor(number(args[0], focus, context)));
+
+            case fn_ceiling:
+                return value_t(std::ceil(number(args[0], focus, context)));
+
+            default:
+                return value_t(round(number(args[0], focus, context)));
+            }
+        }
+
+        //! \brief Find the elements whose \c xml:id is one of a list of identifiers.
+        node_set_t ids(uint32_t arg, const focus_t& focus, context_t& context) const
+        {
+            std::unordered_set<string_t> wanted;
+
+            auto split = [&wanted](const string_t& str) {
+                const charT* it  = str.data();
+                const charT* end = it + str.size();
+
+                while ((it = scanner_t::skip_whitespace(it, end)) != end) {
+                    const charT* word = it;
+
+                    while (it != end && !scanner_t::is_whitespace(*it))
+                        ++it;
+
+                    wanted.insert(string_t(word, it));
+                }
+            };
+
+            if (mTypes[arg] == result_node_set || mTypes[arg] == result_any) {
+                const value_t value = eval(arg, focus, context);
+
+                if (value.type() == value_t::node_set_type)
+                    for (const node_t& node : value.nodes())
+                        split(node.string_value());
+                else
+                    split(value.string());
+            } else
+                split(string(arg, focus, context));
+
+            node_set_t result;
+
+            auto find = [&](const node_t& node) {
+                if (node.element() != nullptr)
+                    for (const attribute_t& attribute : node.element()->attributes())
+                        if (attribute.name().view().equals("xml:id") &&
+                            wanted.count(attribute.value().str()) != 0) {
+                            result.push_back(node);
+                            break;
+                        }
+
+                return true;
+            };
+
+            if (!wanted.empty())
+                axis(axis_descendant_or_self, context.root, find);
+
+            return result;
+        }
+
+        string_t              mSource;     //!< The source of the expression.
+        std::vector<expr_t>   mExprs;      //!< The sub-expressions.
+        std::vector<type_t>   mTypes;      //!< The static type of each sub-expression.
+        std::vector<path_t>   mPaths;      //!< The paths.
+        std::vector<string_t> mUris;       //!< The namespace URIs of the name tests.
+        uint32_t              mRoot;       //!< The index of the whole expression.
+        bool                  mStreamable; //!< Whether the expression can be evaluated on parser events.
+
+        friend class basic_xpath_stream<charT>;
+    };
+
+    typedef basic_xpath_node<char>    xpath_node;  //!< A specialized \c basic_xpath_node for char.
+    typedef basic_xpath_node<wchar_t> wxpath_node; //!< A specialized \c basic_xpath_node for wchar_t.
+
+    typedef basic_xpath_value<char>    xpath_value;  //!< A specialized \c basic_xpath_value for char.
+    typedef basic_xpath_value<wchar_t> wxpath_value; //!< A specialized \c basic_xpath_value for wchar_t.
+
+    typedef basic_xpath_expression<char>    xpath_expression;  //!< A specialized \c basic_xpath_expression for char.
+    typedef basic_xpath_expression<wchar_t> wxpath_expression; //!< A specialized \c basic_xpath_expression for wchar_t.
+}
+
+#endif /* XPATH_H_INCLUDED */
@@ -0,0 +1,209 @@
+#ifndef XSLT_STREAM_H_INCLUDED
+#define XSLT_STREAM_H_INCLUDED
+
+#include <memory>
+#include <cstddef>
+#include <cstdlib>
+#include <stdexcept>
+
+#include <sax.h>
+#include <xpath-stream.h>
+#include <xslt.h>
+
+namespace xml {
+    //! \brief Runs a streamable XSLT stylesheet on parser events.
+    /*!
+     *  This class is a handler for \c basic_sax_parser and
+     *  \c basic_push_parser, that transforms the document as it is read,
+     *  without building it. The template of the root is started on the
+     *  first start tag, down to the instruction selecting the records;
+     *  each record is then built on its own by a \c basic_xpath_stream,
+     *  transformed, and released, and the rest of the template of the
+     *  root is instantiated on the last end tag. The result is reported
+     *  to the handler as it is produced : with a \c basic_result_writer,
+     *  it is written in blocks while the input is read.
+     *
+     *  The memory used is bounded by the depth of the document and the
+     *  size of its largest record, whatever the number of records.
+     *
+     *  Records are processed in document order. Since the number of
+     *  records is not known before the end of the document, \c last() is
+     *  the position of the current record. A record nested in another
+     *  record is only processed as part of the outer one.
+     *
+     *  \sa xml::basic_stylesheet::streamable()
+     *  \sa xml::basic_xpath_stream
+     *  \sa xml::basic_sax_parser
+     *  \sa xml::basic_push_parser
+     *
+     *  \tparam charT    The type of character used in the stylesheet and the document.
+     *                   By default, char and wchar_t are supported.
+     *  \tparam handlerT The receiver of the result, with the member
+     *                   functions of \c basic_xslt_handler.
+     */
+    template <typename charT, typename handlerT = basic_result_writer<charT> >
+    class basic_xslt_stream : public basic_sax_handler<charT> {
+    public:
+        //! \name Member types
+        //!@{
+        typedef          basic_stylesheet<charT>                stylesheet_t;         //!< The compiled stylesheet type.
+        typedef typename stylesheet_t::stylesheet_pointer_t     stylesheet_pointer_t; //!< A shared pointer to a compiled stylesheet.
+        typedef typename stylesheet_t::parameters_t             parameters_t;         //!< The value of each global parameter, by name.
+        typedef typename stylesheet_t::exception_t              exception_t;          //!< The type of exception thrown on errors.
+        typedef typename stylesheet_t::node_t                   node_t;               //!< The node type.
+        typedef          basic_xpath_stream<charT>              records_t;            //!< The stream selecting the records.
+        typedef typename records_t::reader_t                    reader_t;             //!< The reader type, whose error codes are used.
+        typedef typename records_t::view_t                      view_t;               //!< The type of names and values.
+        typedef typename records_t::element_t                   element_t;            //!< The element type.
+        typedef typename records_t::error_t                     error_t;              //!< The type of well-formedness errors.
+        typedef          handlerT                               handler_t;            //!< The receiver of the result.
+
+        //!@}
+
+        //! \brief Constructor.
+        /*!
+         *  \param [in] stylesheet The compiled stylesheet.
+         *  \param [in] handler    The receiver of the result.
+         *  \param [in] parameters The values of the global parameters, or
+         *                         \c nullptr. They must outlive the stream.
+         *
+         *  \throw std::invalid_argument If the stylesheet is not streamable.
+         */
+        basic_xslt_stream(stylesheet_pointer_t stylesheet, handlerT& handler, const parameters_t* parameters = nullptr)
+        :
+            mStylesheet(check(std::move(stylesheet))),
+            mHandler(handler),
+            mParameters(parameters),
+            mState(),
+            mRecords(mStylesheet->mRecords, [this](const element_t& element) { return record(element); }, &mState.variables),
+            mProcessor(),
+            mDepth(0)
+        {
+            mState.source = &mRecords.namespaces();
+        }
+
+        basic_xslt_stream(const basic_xslt_stream&) = delete;
+        basic_xslt_stream& operator=(const basic_xslt_stream&) = delete;
+
+        //! \brief Restart the transformation for a new document.
+        void reset()
+        {
+            mRecords.reset();
+            mProcessor.reset();
+            mState.variables.clear();
+            mState.shadows.clear();
+            mDepth = 0;
+        }
+
+        //! \brief A start tag.
+        /*!
+         *  \throw exception_t If the transformation fails.
+         */
+        bool start_element(const view_t& name)
+        {
+            if (mDepth++ == 0) {
+                mProcessor.reset(new processor_t(*mStylesheet, mHandler, mState, 0));
+                mProcessor->open(mParameters);
+            }
+
+            return mRecords.start_element(name);
+        }
+
+        //! \brief An attribute of the last start tag.
+        bool attribute(const view_t& name, const view_t& value)
+        {
+            return mRecords.attribute(name, value);
+        }
+
+        //! \brief An end tag, or the end of an empty element tag.
+        /*!
+         *  \throw exception_t If the transformation fails.
+         */
+        bool end_element(const view_t& name)
+        {
+            if (!mRecords.end_element(name))
+                return false;
+
+            if (--mDepth == 0)
+                mProcessor->close();
+
+            return true;
+        }
+
+        //! \brief Character data, whose references are decoded.
+        bool text(const view_t& value)
+        {
+            return mRecords.text(value);
+        }
+
+        //! \brief A CDATA section.
+        bool cdata(const view_t& value)
+        {
+            return mRecords.cdata(value);
+        }
+
+        //! \brief A comment.
+        bool comment(const view_t& value)
+        {
+            return mRecords.comment(value);
+        }
+
+        //! \brief A processing instruction.
+        bool processing_instruction(const view_t& target, const view_t& value)
+        {
+            return mRecords.processing_instruction(target, value);
+        }
+
+        //! \brief Get the number of records transformed.
+        size_t count() const { return mRecords.count(); }
+
+        //! \brief Get the well-formedness error found by the stream.
+        /*!
+         *  \return \c reader_t::invalid_namespace, \c reader_t::invalid_reference,
+         *          or \c reader_t::no_error.
+         */
+        error_t error_code() const { return mRecords.error_code(); }
+
+    private:
+        typedef typename stylesheet_t::state_t                             state_t;     //!< The state of a transformation.
+        typedef typename stylesheet_t::template processor_t<handlerT>      processor_t; //!< The executor of templates.
+
+        //! \brief Check that a stylesheet is streamable.
+        /*!
+         *  Without exception support, the program is aborted if it is not.
+         */
+        static stylesheet_pointer_t check(stylesheet_pointer_t stylesheet)
+        {
+            if (!stylesheet || !stylesheet->streamable()) {
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS)
+                throw std::invalid_argument("the XSLT stylesheet is not streamable");
+#else
+                std::abort();
+#endif
+            }
+
+            return stylesheet;
+        }
+
+        //! \brief Transform a record.
+        bool record(const element_t& element)
+        {
+            mProcessor->record(node_t(element), mRecords.count());
+
+            return true;
+        }
+
+        stylesheet_pointer_t         mStylesheet; //!< The stylesheet.
+        handlerT&                    mHandler;    //!< The receiver of the result.
+        const parameters_t*          mParameters; //!< The values of the global parameters, or \c nullptr.
+        state_t                      mState;      //!< The state of the transformation.
+        records_t                    mRecords;    //!< The selection of the records.
+        std::unique_ptr<processor_t> mProcessor;  //!< The executor of the template of the root, once the document has started.
+        size_t                       mDepth;      //!< The number of open elements.
+    };
+
+    typedef basic_xslt_stream<char>    xslt_stream;  //!< A specialized \c basic_xslt_stream for char.
+    typedef basic_xslt_stream<wchar_t> wxslt_stream; //!< A specialized \c basic_xslt_stream for wchar_t.
+}
+
+#endif /* XSLT_STREAM_H_INCLUDED */
@@ -0,0 +1,2909 @@
+#ifndef XSLT_H_INCLUDED
+#define XSLT_H_INCLUDED
+
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+#include <ostream>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <reader.h>
+#include <exception.h>
+#include <expected.h>
+#include <namespace-table.h>
+#include <document.h>
+#include <builder.h>
+#include <xpath.h>
+
+namespace xml {
+    template <typename charT, typename handlerT>
+    class basic_xslt_stream;
+
+    //! \brief The receiver of the result of a XSLT transformation.
+    /*!
+     *  A transformation reports the result tree to its handler in document
+     *  order, without building it. This handler ignores everything : a
+     *  handler derives from it and hides the functions it needs. The
+     *  handler type is a template parameter of the transformation, so that
+     *  the calls can be inlined.
+     *
+     *  Names are qualified names. The \c xmlns attributes declaring their
+     *  prefixes are reported first, with the \c http://www.w3.org/2000/xmlns/
+     *  namespace. The views are only valid during the call.
+     *
+     *  \tparam charT The type of character used in the result.
+     *                By default, char and wchar_t are supported.
+     */
+    template <typename charT>
+    class basic_xslt_handler {
+    public:
+        //! \name Member types
+        //!@{
+        typedef basic_string_view<charT> view_t; //!< The type of names and values.
+
+        //!@}
+
+        //! \brief The start of an element.
+        void start_element(const view_t& uri, const view_t& name) {}
+
+        //! \brief An attribute of the last started element.
+        void attribute(const view_t& uri, const view_t& name, const view_t& value) {}
+
+        //! \brief The end of an element.
+        void end_element(const view_t& uri, const view_t& name) {}
+
+        //! \brief Character data, not escaped.
+        void text(const view_t& value) {}
+
+        //! \brief A comment.
+        void comment(const view_t& value) {}
+
+        //! \brief A processing instruction.
+        void processing_instruction(const view_t& target, const view_t& value) {}
+    };
+
+    //! \brief A XSLT handler building the result tree.
+    /*!
+     *  The elements are created directly in a new document, with their
+     *  namespaces interned in its table : the result is never copied.
+     *  Adjacent texts are merged into a single text node. Comments,
+     *  processing instructions, and texts outside of the root element
+     *  are dropped, since a document has no node for them.
+     *
+     *  \tparam charT The type of character used in the result.
+     *                By default, char and wchar_t are supported.
+     */
+    template <typename charT>
+    class basic_result_builder : public basic_xslt_handler<charT> {
+    public:
+        //! \name Member types
+        //!@{
+        typedef          basic_reader<charT>        reader_t;     //!< The reader type, whose error codes are used.
+        typedef typename reader_t::view_t           view_t;       //!< The type of names and values.
+        typedef          basic_document<charT>      document_t;   //!< The document type.
+        typedef          basic_element<charT>       element_t;    //!< The element type.
+        typedef typename element_t::string_t        string_t;     //!< The string type.
+        typedef typename element_t::string_ref_t    string_ref_t; //!< The type of string stored in nodes.
+        typedef          basic_parse_error<charT>   parse_error_t; //!< The error type.
+        typedef          basic_exception<charT>     exception_t;  //!< The type of exception thrown when the result is not a document.
+
+        //!@}
+
+        //! \brief Constructor.
+        basic_result_builder()
+        :
+            mDocument(),
+            mStack(),
+            mText()
+        {}
+
+        //! \brief Create an element, or the document if it is the root element.
+        /*!
+         *  \throw exception_t If the result has several root elements.
+         */
+        void start_element(const view_t& uri, const view_t& name)
+        {
+            flush();
+
+            if (mStack.empty()) {
+                if (mDocument)
+                    fail("the result has several root elements");
+
+                mDocument.reset(new document_t(string_ref_t(name.str())));
+                mStack.push_back(&mDocument->root());
+            } else {
+                mStack.push_back(static_cast<element_t*>(&*mStack.back()->emplace_element_back(string_ref_t(name.str()))));
+            }
+
+            mStack.back()->namespace_id() = mDocument->namespaces().intern(uri);
+        }
+
+        //! \brief Add an attribute to the current element.
+        void attribute(const view_t& uri, const view_t& name, const view_t& value)
+        {
+            if (!mStack.empty())
+                mStack.back()->attributes().emplace(string_ref_t(name.str()), string_ref_t(value.str()), mDocument->namespaces().intern(uri));
+        }
+
+        //! \brief Close the current element.
+        void end_element(const view_t& uri, const view_t& name)
+        {
+            flush();
+            mStack.pop_back();
+        }
+
+        //! \brief Add characters to the current element.
+        void text(const view_t& value)
+        {
+            if (!mStack.empty())
+                mText.append(value.begin(), value.end());
+        }
+
+        //! \brief Get the result.
+        /*!
+         *  \throw exception_t If the result has no root element.
+         *
+         *  \return The document, that is moved out of the builder.
+         */
+        document_t document()
+        {
+            if (!mDocument)
+                fail("the result has no root element");
+
+            document_t result(std::move(*mDocument));
+
+            mDocument.reset();
+
+            return result;
+        }
+
+    private:
+        //! \brief Add the pending characters as a text node.
+        void flush()
+        {
+            if (mText.empty())
+                return;
+
+            mStack.back()->emplace_text_back(string_ref_t(std::move(mText)));
+            mText.clear();
+        }
+
+        //! \brief Throw an exception.
+        static void fail(const char* what)
+        {
+            throw exception_t(parse_error_t(what, reader_t::no_error, 0), nullptr);
+        }
+
+        std::unique_ptr<document_t> mDocument; //!< The document being built.
+        std::vector<element_t*>     mStack;    //!< The open elements.
+        string_t                    mText;     //!< The characters not added yet.
+    };
+
+    //! \brief A XSLT handler serializing the result.
+    /*!
+     *  The markup is written into a buffer, that is written to the stream
+     *  in blocks of \c block_size characters. Elements without content are
+     *  written as empty element tags. When indenting, each element that
+     *  has no text is started on a new line.
+     *
+     *  \tparam charT The type of character used in the result.
+     *                By default, char and wchar_t are supported.
+     */
+    template <typename charT>
+    class basic_result_writer : public basic_xslt_handler<charT> {
+    public:
+        //! \name Member types
+        //!@{
+        typedef          basic_string_view<charT>  view_t;   //!< The type of names and values.
+        typedef typename view_t::string_t          string_t; //!< The string type.
+        typedef          std::basic_ostream<charT> stream_t; //!< The output stream type.
+
+        //!@}
+
+        //! The output methods.
+        enum method_t {
+            xml_method, //!< Markup.
+            text_method //!< The characters of the texts only.
+        };
+
+        //! \brief The settings of the output.
+        class settings_t {
+        public:
+            method_t method;      //!< The output method.
+            bool     indent;      //!< Whether to indent the elements.
+            bool     declaration; //!< Whether to write a XML declaration.
+        };
+
+        static const size_t block_size = 65536; //!< The number of characters written at once.
+
+        //! \brief Constructor.
+        /*!
+         *  \param [in] stream   The stream to write to.
+         *  \param [in] settings The output settings.
+         */
+        explicit basic_result_writer(stream_t& stream, const settings_t& settings = settings_t { xml_method, false, true })
+        :
+            mStream(stream),
+            mSettings(settings),
+            mBuffer(),
+            mLevels(),
+            mOpen(false),
+            mStarted(false),
+            mProlog(false)
+        {
+            mBuffer.reserve(block_size + block_size / 4);
+        }
+
+        basic_result_writer(const basic_result_writer&) = delete;
+        basic_result_writer& operator=(const basic_result_writer&) = delete;
+
+        //! \brief Destructor.
+        /*!
+         *  Writes the buffered characters.
+         */
+        ~basic_result_writer()
+        {
+            flush();
+        }
+
+        //! \brief Write a start tag, left open for the attributes.
+        void start_element(const view_t& uri, const view_t& name)
+        {
+            if (mSettings.method != xml_method)
+                return;
+
+            prolog();
+            close();
+
+            if (mSettings.indent && mStarted && (mLevels.empty() || !mLevels.back().mixed))
+                newline(mLevels.size());
+
+            if (!mLevels.empty())
+                mLevels.back().elements = true;
+
+            mBuffer.push_back('<');
+            append(name);
+            mLevels.push_back(level_t { false, false });
+            mOpen    = true;
+            mStarted = true;
+        }
+
+        //! \brief Write an attribute of the open start tag.
+        void attribute(const view_t& uri, const view_t& name, const view_t& value)
+        {
+            if (mSettings.method != xml_method || !mOpen)
+                return;
+
+            mBuffer.push_back(' ');
+            append(name);
+            mBuffer.push_back('=');
+            mBuffer.push_back('"');
+            escape(value, true);
+            mBuffer.push_back('"');
+        }
+
+        //! \brief Write an end tag, or end an empty element tag.
+        void end_element(const view_t& uri, const view_t& name)
+        {
+            if (mSettings.method != xml_method)
+                return;
+
+            const level_t level = mLevels.back();
+
+            mLevels.pop_back();
+
+            if (mOpen) {
+                mBuffer.push_back('/');
+                mBuffer.push_back('>');
+                mOpen = false;
+            } else {
+                if (mSettings.indent && level.elements && !level.mixed)
+                    newline(mLevels.size());
+
+                mBuffer.push_back('<');
+                mBuffer.push_back('/');
+                append(name);
+                mBuffer.push_back('>');
+            }
+
+            check();
+        }
+
+        //! \brief Write characters, escaped with the xml method.
+        void text(const view_t& value)
+        {
+            if (mSettings.method != xml_method) {
+                append(value);
+                check();
+
+                return;
+            }
+
+            prolog();
+            close();
+
+            if (!mLevels.empty())
+                mLevels.back().mixed = true;
+
+            escape(value, false);
+            check();
+        }
+
+        //! \brief Write a comment.
+        void comment(const view_t& value)
+        {
+            if (mSettings.method != xml_method)
+                return;
+
+            markup();
+            put("<!--");
+            append(value);
+            put("-->");
+            check();
+        }
+
+        //! \brief Write a processing instruction.
+        void processing_instruction(const view_t& target, const view_t& value)
+        {
+            if (mSettings.method != xml_method)
+                return;
+
+            markup();
+            put("<?");
+            append(target);
+
+            if (!value.empty()) {
+                mBuffer.push_back(' ');
+                append(value);
+            }
+
+            put("?>");
+            check();
+        }
+
+        //! \brief Write the buffered characters to the stream.
+        void flush()
+        {
+            if (!mBuffer.empty()) {
+                mStream.write(mBuffer.data(), static_cast<std::streamsize>(mBuffer.size()));
+                mBuffer.clear();
+            }
+        }
+
+        //! \brief Write the buffered characters, and flush the stream.
+        void finish()
+        {
+            flush();
+            mStream.flush();
+        }
+
+    private:
+        //! \brief The state of an open element.
+        class level_t {
+        public:
+            bool elements; //!< Whether the element has child elements.
+            bool mixed;    //!< Whether the element has texts.
+        };
+
+        //! \brief Write the XML declaration before the first markup.
+        void prolog()
+        {
+            if (mProlog)
+                return;
+
+            mProlog = true;
+
+            if (mSettings.declaration)
+                put("<?xml version=\"1.0\"?>\n");
+        }
+
+        //! \brief End the open start tag.
+        void close()
+        {
+            if (mOpen) {
+                mBuffer.push_back('>');
+                mOpen = false;
+            }
+        }
+
+        //! \brief Start a comment or a processing instruction.
+        void markup()
+        {
+            prolog();
+            close();
+
+            if (mSettings.indent && mStarted && (mLevels.empty() || !mLevels.back().mixed))
+                newline(mLevels.size());
+
+            if (!mLevels.empty())
+                mLevels.back().elements = true;
+
+            mStarted = true;
+        }
+
+        //! \brief Start a new line, indented by two spaces per level.
+        void newline(size_t level)
+        {
+            mBuffer.push_back('\n');
+            mBuffer.append(2 * level, charT(' '));
+        }
+
+        //! \brief Append characters to the buffer.
+        void append(const view_t& value)
+        {
+            mBuffer.append(value.begin(), value.end());
+        }
+
+        //! \brief Append an ASCII string to the buffer.
+        void put(const char* str)
+        {
+            while (*str != '\0')
+                mBuffer.push_back(static_cast<charT>(*str++));
+        }
+
+        //! \brief Append escaped characters to the buffer.
+        /*!
+         *  \param [in] value     The characters.
+         *  \param [in] attribute Whether \c value is an attribute value, in
+         *                        which quotes and white spaces are escaped.
+         */
+        void escape(const view_t& value, bool attribute)
+        {
+            const charT* run = value.begin();
+
+            for (const charT* it = value.begin(); it != value.end(); ++it) {
+                const char* replacement = nullptr;
+
+                switch (*it) {
+                case '&': replacement = "&amp;"; break;
+                case '<': replacement = "&lt;"; break;
+                case '>': replacement = "&gt;"; break;
+                case '"': replacement = attribute ? "&quot;" : nullptr; break;
+                case '\t': replacement = attribute ? "&#9;" : nullptr; break;
+                case '\n': replacement = attribute ? "&#10;" : nullptr; break;
+                case '\r': replacement = "&#13;"; break;
+                default: break;
+                }
+
+                if (replacement != nullptr) {
+                    mBuffer.append(run, it);
+                    put(replacement);
+                    run = it + 1;
+                }
+            }
+
+            mBuffer.append(run, value.end());
+        }
+
+        //! \brief Write the buffer to the stream if it holds a block.
+        void check()
+        {
+            if (mBuffer.size() >= block_size)
+                flush();
+        }
+
+        stream_t&            mStream;   //!< The output stream.
+        settings_t           mSettings; //!< The output settings.
+        string_t             mBuffer;   //!< The characters not written yet.
+        std::vector<level_t> mLevels;   //!< The open elements.
+        bool                 mOpen;     //!< Whether a start tag is open.
+        bool                 mStarted;  //!< Whether some markup has been written.
+        bool                 mProlog;   //!< Whether the XML declaration has been handled.
+    };
+
+    //! \brief A compiled XSLT 1.0 stylesheet.
+    /*!
+     *  This class compiles a stylesheet document once into an immutable
+     *  program : a flat list of instructions whose XPath expressions and
+     *  attribute value templates are compiled, and per mode dispatch tables
+     *  mapping the expanded names of elements and attributes to the
+     *  template rules that may match them, sorted by import precedence,
+     *  priority and position. Finding the template of a node is then a
+     *  hash lookup and the match of the few candidate patterns, which are
+     *  matched from the node up its ancestors.
+     *
+     *  A transformation reports the result tree to a handler : the result
+     *  is built directly into a new document by \c basic_result_builder,
+     *  or serialized by \c basic_result_writer, without intermediate tree.
+     *  A compiled stylesheet is only handed out through a \c std::shared_ptr
+     *  to a constant object, and can run any number of transformations
+     *  concurrently, each keeping its state on its own stack.
+     *
+     *  A stylesheet is a single document : \c xsl:import, \c xsl:include,
+     *  \c xsl:key, \c xsl:number, attribute sets, decimal formats and
+     *  namespace aliases are not supported, nor are the XSLT functions
+     *  \c current(), \c key(), \c document(), \c format-number() and
+     *  \c generate-id(). Result tree fragments are converted to strings.
+     *  The trees of this library have no comments, no processing
+     *  instructions, and no white space only texts, so that \c xsl:strip-space
+     *  and \c xsl:preserve-space are ignored. Global variables are evaluated
+     *  in document order. The namespaces of the result are declared where
+     *  names use them, instead of copying the namespace nodes of literal
+     *  result elements.
+     *
+     *  A stylesheet that only reads one record at a time is streamable,
+     *  and can be run on parser events by \c basic_xslt_stream.
+     *
+     *  \sa xml::basic_xpath_expression
+     *  \sa xml::basic_result_builder
+     *  \sa xml::basic_result_writer
+     *  \sa xml::basic_xslt_stream
+     *
+     *  \tparam charT The type of character used in the stylesheet.
+     *                By default, char and wchar_t are supported.
+     */
+    template <typename charT>
+    class basic_stylesheet {
+    public:
+        //! \name Member types
+        //!@{
+        typedef          basic_reader<charT>       reader_t;        //!< The reader type, whose error codes are used.
+        typedef typename reader_t::view_t          view_t;          //!< The type of names and values.
+
+        typedef          basic_document<charT>        document_t;       //!< The document type.
+        typedef          basic_element<charT>         element_t;        //!< The element type.
+        typedef          basic_text<charT>            text_t;           //!< The text type.
+        typedef typename element_t::attribute_t       attribute_t;      //!< The attribute type.
+        typedef typename element_t::string_t          string_t;         //!< The string type.
+        typedef typename element_t::node_interface_t  node_interface_t; //!< The base type of nodes.
+        typedef typename element_t::child_t           child_t;          //!< The type of nodes that have a parent.
+        typedef          basic_builder<charT>         builder_t;        //!< The builder used to parse stylesheets.
+        typedef          basic_namespace_table<charT> table_t;          //!< The namespace table type.
+
+        typedef          basic_xpath_expression<charT>       expression_t;         //!< The compiled XPath expression type.
+        typedef typename expression_t::expression_pointer_t  expression_pointer_t; //!< A shared pointer to a compiled expression.
+        typedef typename expression_t::bindings_t            bindings_t;           //!< The namespace URI bound to each prefix of an expression.
+        typedef typename expression_t::node_t                node_t;               //!< The node type.
+        typedef typename expression_t::value_t               value_t;              //!< The XPath value type.
+        typedef typename expression_t::node_set_t            node_set_t;           //!< The node-set type.
+        typedef typename expression_t::variables_t           parameters_t;         //!< The value of each global parameter, by name.
+
+        typedef          basic_xslt_handler<charT>   handler_t; //!< The handler that ignores the result.
+        typedef          basic_result_builder<charT> builder_handler_t; //!< The handler building the result tree.
+        typedef          basic_result_writer<charT>  writer_t;  //!< The handler serializing the result.
+        typedef typename writer_t::settings_t        output_t;  //!< The output settings.
+
+        typedef basic_stylesheet<charT>                       stylesheet_t;         //!< The compiled stylesheet type.
+        typedef std::shared_ptr<const stylesheet_t>           stylesheet_pointer_t; //!< A shared pointer to a compiled stylesheet.
+        typedef basic_parse_error<charT>                      parse_error_t;        //!< The compilation error type.
+        typedef basic_exception<charT>                        exception_t;          //!< The type of exception thrown on errors.
+        typedef expected<stylesheet_pointer_t, parse_error_t> result_t;             //!< The result of a compilation that does not throw.
+
+        //!@}
+
+        static const size_t max_depth = 4096; //!< The maximum number of nested template calls.
+
+        basic_stylesheet(const basic_stylesheet&) = delete;
+        basic_stylesheet& operator=(const basic_stylesheet&) = delete;
+
+        //! \brief Compile a stylesheet without throwing exceptions.
+        /*!
+         *  The stylesheet document must have been parsed with namespaces.
+         *  The names, values and expressions it contains are copied, so
+         *  that the document does not need to outlive the compiled
+         *  stylesheet. A literal result element carrying \c xsl:version is
+         *  a simplified stylesheet, that is the template of the root.
+         *
+         *  \param [in] stylesheet The stylesheet document.
+         *
+         *  \return The compiled stylesheet, or the first error found, with
+         *          a \c no_error code since the document itself is well-formed.
+         */
+        static result_t try_compile(const document_t& stylesheet)
+        {
+            std::shared_ptr<stylesheet_t> compiled(new stylesheet_t());
+            compiler_t compiler(*compiled, stylesheet);
+
+            if (!compiler.compile())
+                return result_t(parse_error_t(compiler.error, reader_t::no_error, 0));
+
+            return result_t(stylesheet_pointer_t(std::move(compiled)));
+        }
+
+        //! \brief Compile a stylesheet.
+        /*!
+         *  \param [in] stylesheet The stylesheet document.
+         *
+         *  \throw exception_t If the stylesheet is invalid or unsupported.
+         *
+         *  \return The compiled stylesheet.
+         */
+        static stylesheet_pointer_t compile(const document_t& stylesheet)
+        {
+            result_t result = try_compile(stylesheet);
+
+            if (!result)
+                throw exception_t(result.error(), nullptr);
+
+            return std::move(result.value());
+        }
+
+        //! \brief Parse and compile a stylesheet.
+        /*!
+         *  \param [in] str The stylesheet document.
+         *
+         *  \throw exception_t If the document is malformed, or the
+         *                     stylesheet is invalid or unsupported.
+         *
+         *  \return The compiled stylesheet.
+         */
+        static stylesheet_pointer_t compile(const string_t& str)
+        {
+            return compile(builder_t::parse(str));
+        }
+
+        //! \brief Get the output settings of the stylesheet.
+        /*!
+         *  They are read from \c xsl:output : the \c xml and \c html methods
+         *  write markup, the \c text method the characters of the texts.
+         */
+        const output_t& output() const { return mOutput; }
+
+        //! \brief Whether the stylesheet can be run on parser events.
+        /*!
+         *  A stylesheet is streamable when the template of the root
+         *  outputs fixed content around a single \c xsl:apply-templates or
+         *  \c xsl:for-each without \c xsl:sort, whose selection is a
+         *  streamable XPath expression, such as \c catalog/item. The
+         *  fixed content is literal result elements, \c xsl:element,
+         *  texts, and instructions whose expressions are literals. The
+         *  selected records must then be processed on their own : the
+         *  expressions of the instructions they reach only read below
+         *  their context node, and the patterns of the modes they reach
+         *  are a single \c child or \c attribute step, such as \c item or
+         *  \c item[@type='book'], whose predicates do not depend on
+         *  positions. The global variables must be literals.
+         *
+         *  \sa xml::basic_xpath_expression::streamable()
+         */
+        bool streamable() const { return !mChain.empty(); }
+
+        //! \brief Transform a tree, reporting the result to a handler.
+        /*!
+         *  The handler has the member functions of \c basic_xslt_handler.
+         *
+         *  \param [in] source     The source node, usually a document, to
+         *                         which templates are applied first.
+         *  \param [in] handler    The receiver of the result.
+         *  \param [in] parameters The values of the global parameters, or \c nullptr.
+         *
+         *  \throw exception_t If \c xsl:message terminates the
+         *                     transformation, if a computed name uses an
+         *                     unbound prefix, or if templates are nested
+         *                     deeper than \c max_depth.
+         */
+        template <typename handlerT>
+        void transform(const node_t& source, handlerT& handler, const parameters_t* parameters = nullptr) const
+        {
+            state_t state;
+            node_t  root = source;
+
+            while (root.parent())
+                root = root.parent();
+
+            state.source = root.document() != nullptr ? &root.document()->namespaces() : nullptr;
+
+            if (state.source == nullptr)
+                state.ids.push_back(table_t::no_namespace);
+
+            processor_t<handlerT> processor(*this, handler, state, 0);
+
+            processor.run(source, parameters);
+        }
+
+        //! \brief Transform a tree into a new document.
+        /*!
+         *  \param [in] source     The source node, usually a document.
+         *  \param [in] parameters The values of the global parameters, or \c nullptr.
+         *
+         *  \throw exception_t If the transformation fails, or if the result
+         *                     does not have a single root element.
+         *
+         *  \return The result document.
+         */
+        document_t transform(const node_t& source, const parameters_t* parameters = nullptr) const
+        {
+            builder_handler_t builder;
+
+            transform(source, builder, parameters);
+
+            return builder.document();
+        }
+
+        //! \brief Transform a tree into a stream, with the output settings of the stylesheet.
+        /*!
+         *  \param [in] source     The source node, usually a document.
+         *  \param [out] stream    The stream the result is written to.
+         *  \param [in] parameters The values of the global parameters, or \c nullptr.
+         *
+         *  \throw exception_t If the transformation fails.
+         */
+        void write(const node_t& source, std::basic_ostream<charT>& stream, const parameters_t* parameters = nullptr) const
+        {
+            writer_t writer(stream, mOutput);
+
+            transform(source, writer, parameters);
+            writer.finish();
+        }
+
+    private:
+        template <typename, typename>
+        friend class basic_xslt_stream;
+
+        static const uint32_t npos = uint32_t(-1); //!< An invalid index.
+
+        //! The instructions of templates.
+        enum op_t {
+            op_literal,   //!< A literal result element.
+            op_text,      //!< A literal text.
+            op_value_of,  //!< \c xsl:value-of.
+            op_apply,     //!< \c xsl:apply-templates.
+            op_call,      //!< \c xsl:call-template.
+            op_for_each,  //!< \c xsl:for-each.
+            op_if,        //!< \c xsl:if.
+            op_choose,    //!< \c xsl:choose.
+            op_when,      //!< \c xsl:when, or \c xsl:otherwise without test.
+            op_copy,      //!< \c xsl:copy.
+            op_copy_of,   //!< \c xsl:copy-of.
+            op_element,   //!< \c xsl:element.
+            op_attribute, //!< \c xsl:attribute.
+            op_variable,  //!< \c xsl:variable, \c xsl:param and \c xsl:with-param.
+            op_comment,   //!< \c xsl:comment.
+            op_pi,        //!< \c xsl:processing-instruction.
+            op_message    //!< \c xsl:message.
+        };
+
+        //! \brief A part of an attribute value template.
+        class part_t {
+        public:
+            string_t             text;       //!< The literal text, if \c expression is empty.
+            expression_pointer_t expression; //!< The expression between braces.
+        };
+
+        typedef std::vector<part_t> avt_t; //!< An attribute value template.
+
+        //! \brief An attribute of a literal result element.
+        class literal_attribute_t {
+        public:
+            string_t uri;   //!< The namespace of the attribute.
+            string_t name;  //!< The qualified name of the attribute.
+            avt_t    value; //!< The value of the attribute.
+        };
+
+        //! \brief A sort key of \c xsl:apply-templates or \c xsl:for-each.
+        class sort_t {
+        public:
+            expression_pointer_t select;     //!< The key of each node.
+            bool                 descending; //!< Whether the order is descending.
+            bool                 number;     //!< Whether keys are compared as numbers.
+        };
+
+        //! \brief An instruction.
+        class instruction_t {
+        public:
+            //! \brief Build an instruction without operands.
+            explicit instruction_t(op_t o)
+            :
+                op(o),
+                body(),
+                select(),
+                text(),
+                uri(),
+                name(),
+                ns(),
+                flag(false),
+                attributes(),
+                params(),
+                sorts(),
+                bindings(),
+                target(0)
+            {}
+
+            op_t                             op;         //!< The instruction.
+            std::vector<uint32_t>            body;       //!< The instructions of the content.
+            expression_pointer_t             select;     //!< The \c select or \c test expression.
+            string_t                         text;       //!< The literal text, the qualified name of a literal element, or the name of a variable or of a called template.
+            string_t                         uri;        //!< The namespace of a literal element.
+            avt_t                            name;       //!< The computed name of an element, attribute or processing instruction.
+            avt_t                            ns;         //!< The computed namespace of an element or attribute.
+            bool                             flag;       //!< Whether \c ns is set, a variable is a parameter, or a message terminates.
+            std::vector<literal_attribute_t> attributes; //!< The attributes of a literal element.
+            std::vector<uint32_t>            params;     //!< The \c xsl:with-param of a call.
+            std::vector<sort_t>              sorts;      //!< The sort keys.
+            bindings_t                       bindings;   //!< The namespaces in scope, for computed names and streamed selections.
+            uint32_t                         target;     //!< The mode of \c xsl:apply-templates, or the called template.
+        };
+
+        //! \brief A template.
+        class template_t {
+        public:
+            string_t              name;   //!< The name of the template, if any.
+            uint32_t              mode;   //!< The mode of the template rule.
+            std::vector<uint32_t> params; //!< The \c xsl:param instructions.
+            std::vector<uint32_t> body;   //!< The instructions of the content.
+        };
+
+        //! \brief An alternative of the pattern of a template rule.
+        class rule_t {
+        public:
+            expression_pointer_t pattern;  //!< The pattern.
+            uint32_t             target;   //!< The template.
+            double               priority; //!< The priority of the rule.
+            uint32_t             order;    //!< The position of the rule in the stylesheet.
+        };
+
+        //! \brief An expanded name.
+        class name_t {
+        public:
+            namespace_id_t uri;   //!< The namespace, in the table of the stylesheet.
+            view_t         local; //!< The local name, that references a pattern.
+
+            //! \brief Equality operator.
+            bool operator==(const name_t& rhs) const { return uri == rhs.uri && local == rhs.local; }
+        };
+
+        //! \brief The hash function of expanded names.
+        class name_hash_t {
+        public:
+            //! \brief Hash an expanded name.
+            size_t operator()(const name_t& name) const { return name.local.hash() * 31 + name.uri; }
+        };
+
+        typedef std::unordered_map<name_t, std::vector<uint32_t>, name_hash_t> names_t; //!< The rules of each name.
+
+        //! \brief The dispatch tables of a mode.
+        /*!
+         *  Each list holds the rules that may match a kind of node, the
+         *  highest priority first : the list of a name also holds the rules
+         *  matching any name.
+         */
+        class mode_t {
+        public:
+            names_t               elements;   //!< The rules of elements, by name.
+            names_t               attributes; //!< The rules of attributes, by name.
+            std::vector<uint32_t> element;    //!< The rules of elements whose name has no rule.
+            std::vector<uint32_t> attribute;  //!< The rules of attributes whose name has no rule.
+            std::vector<uint32_t> texts;      //!< The rules of texts.
+            std::vector<uint32_t> documents;  //!< The rules of the root.
+        };
+
+        //! \brief The state of a transformation, shared by its processors.
+        class state_t {
+        public:
+            parameters_t                variables; //!< The variables in scope.
+            std::vector<namespace_id_t> ids;       //!< The namespace of the stylesheet matching each namespace of the source, filled as they are met.
+            const table_t*              source;    //!< The namespace table of the source, or \c nullptr if it is not in a document.
+            std::vector<value_t>        shadows;   //!< The values of the global variables shadowed by local ones.
+        };
+
+        //! \brief A handler collecting the characters of the result.
+        class collector_t : public handler_t {
+        public:
+            //! \brief Constructor.
+            explicit collector_t(string_t& text)
+            :
+                mText(text)
+            {}
+
+            //! \brief Collect characters.
+            void text(const view_t& value) { mText.append(value.begin(), value.end()); }
+
+        private:
+            string_t& mText; //!< The collected characters.
+        };
+
+        //! \brief The node being processed, in the list being processed.
+        class frame_t {
+        public:
+            node_t node;     //!< The current node.
+            size_t position; //!< The position of \c node, from 1.
+            size_t size;     //!< The size of the list.
+        };
+
+        //! \brief The executor of templates.
+        /*!
+         *  Variables are bound in a single map, saving the values they
+         *  shadow until the end of their scope.
+         *
+         *  \tparam handlerT The receiver of the result.
+         */
+        template <typename handlerT>
+        class processor_t {
+        public:
+            //! \brief Constructor.
+            processor_t(const stylesheet_t& stylesheet, handlerT& handler, state_t& state, size_t depth)
+            :
+                mStylesheet(stylesheet),
+                mHandler(handler),
+                mState(state),
+                mDepth(depth),
+                mSaved(),
+                mScope(),
+                mMarks(),
+                mOpen(),
+                mPending(false),
+                mElement(),
+                mAttributes(),
+                mLevels(),
+                mArguments()
+            {}
+
+            //! \brief Bind the global variables, and apply templates to the source.
+            void run(const node_t& source, const parameters_t* parameters)
+            {
+                globals(frame_t { source, 1, 1 }, parameters);
+                apply(node_set_t(1, source), 0, arguments_t());
+                flush();
+            }
+
+            //! \brief Start a streamed transformation.
+            /*!
+             *  Binds the global variables, and instantiates the template of
+             *  the root down to the instruction selecting the records, with
+             *  no current node.
+             */
+            void open(const parameters_t* parameters)
+            {
+                const frame_t                none = { node_t(), 1, 1 };
+                const std::vector<uint32_t>* body = &mStylesheet.mTemplates[mStylesheet.mRoot].body;
+
+                globals(none, parameters);
+                enter();
+
+                for (size_t n = 0; n != mStylesheet.mShadowed.size(); ++n)
+                    bind(mStylesheet.mInstructions[mStylesheet.mShadowed[n]].text, mState.shadows[n]);
+
+                for (uint32_t link : mStylesheet.mChain) {
+                    const instruction_t& i = mStylesheet.mInstructions[link];
+
+                    mLevels.push_back(mSaved.size());
+
+                    for (auto it = body->begin(); *it != link; ++it)
+                        execute(mStylesheet.mInstructions[*it], none);
+
+                    if (i.op == op_literal) {
+                        start(i.uri, i.text);
+
+                        for (const literal_attribute_t& attribute : i.attributes)
+                            add(attribute.uri, attribute.name, avt(attribute.value, none));
+                    } else if (i.op == op_element) {
+                        const string_t name = avt(i.name, none);
+
+                        start(i.flag ? avt(i.ns, none) : resolve(i.bindings, name, true), name);
+                    }
+
+                    body = &i.body;
+                }
+
+                mArguments = arguments(mStylesheet.mInstructions[mStylesheet.mChain.back()], none);
+            }
+
+            //! \brief Process a record of a streamed transformation.
+            /*!
+             *  \param [in] node     The record.
+             *  \param [in] position The position of the record, which is
+             *                       also the size of the list of records.
+             */
+            void record(const node_t& node, size_t position)
+            {
+                const instruction_t& i     = mStylesheet.mInstructions[mStylesheet.mChain.back()];
+                const frame_t        frame = { node, position, position };
+
+                if (i.op == op_for_each) {
+                    execute(i.body, frame);
+
+                    return;
+                }
+
+                const uint32_t found = find(i.target, node);
+
+                if (found != npos)
+                    invoke(found, frame, mArguments);
+                else
+                    builtin(frame, i.target);
+            }
+
+            //! \brief End a streamed transformation.
+            /*!
+             *  Instantiates the rest of the template of the root, from the
+             *  instruction selecting the records up.
+             */
+            void close()
+            {
+                const frame_t none = { node_t(), 1, 1 };
+
+                for (size_t level = mStylesheet.mChain.size(); level-- != 0;) {
+                    const std::vector<uint32_t>& body = level == 0 ? mStylesheet.mTemplates[mStylesheet.mRoot].body :
+                                                                     mStylesheet.mInstructions[mStylesheet.mChain[level - 1]].body;
+
+                    for (auto it = ++std::find(body.begin(), body.end(), mStylesheet.mChain[level]); it != body.end(); ++it)
+                        execute(mStylesheet.mInstructions[*it], none);
+
+                    restore(mLevels[level]);
+
+                    if (level != 0)
+                        end();
+                }
+
+                mLevels.clear();
+                --mDepth;
+                flush();
+            }
+
+            //! \brief Execute instructions.
+            /*!
+             *  The variables they bind go out of scope at the end.
+             */
+            void execute(const std::vector<uint32_t>& body, const frame_t& frame)
+            {
+                const size_t mark = mSaved.size();
+
+                for (uint32_t index : body)
+                    execute(mStylesheet.mInstructions[index], frame);
+
+                restore(mark);
+            }
+
+        private:
+            typedef std::vector<std::pair<const string_t*, value_t> > arguments_t; //!< The values of the parameters of a call.
+
+            //! \brief Bind the global variables and parameters.
+            void globals(const frame_t& root, const parameters_t* parameters)
+            {
+                for (uint32_t global : mStylesheet.mGlobals) {
+                    const instruction_t& decl = mStylesheet.mInstructions[global];
+                    typename parameters_t::const_iterator it;
+
+                    if (decl.flag && parameters != nullptr && (it = parameters->find(decl.text)) != parameters->end())
+                        bind(decl.text, it->second);
+                    else
+                        bind(decl.text, value(decl, root));
+                }
+
+                for (uint32_t global : mStylesheet.mShadowed)
+                    mState.shadows.push_back(mState.variables[mStylesheet.mInstructions[global].text]);
+            }
+
+            //! \brief A value shadowed by a variable.
+            class saved_t {
+            public:
+                string_t name;  //!< The name of the variable.
+                bool     bound; //!< Whether the name was bound.
+                value_t  value; //!< The shadowed value.
+            };
+
+            //! \brief An element of the result.
+            class tag_t {
+            public:
+                string_t uri;  //!< The namespace.
+                string_t name; //!< The qualified name.
+            };
+
+            //! \brief An attribute of the element being started.
+            class pending_attribute_t {
+            public:
+                string_t uri;   //!< The namespace.
+                string_t name;  //!< The qualified name.
+                string_t value; //!< The value.
+            };
+
+            //! \brief Execute an instruction.
+            void execute(const instruction_t& i, const frame_t& frame)
+            {
+                switch (i.op) {
+                case op_literal:
+                    start(i.uri, i.text);
+
+                    for (const literal_attribute_t& attribute : i.attributes)
+                        add(attribute.uri, attribute.name, avt(attribute.value, frame));
+
+                    execute(i.body, frame);
+                    end();
+                    break;
+
+                case op_text:
+                    characters(i.text);
+                    break;
+
+                case op_value_of:
+                    characters(evaluate(*i.select, frame).string());
+                    break;
+
+                case op_apply: {
+                    node_set_t nodes;
+
+                    if (i.select)
+                        nodes = select(*i.select, frame);
+                    else
+                        children(frame.node, nodes);
+
+                    sort(nodes, i.sorts);
+                    apply(nodes, i.target, arguments(i, frame));
+                    break;
+                }
+
+                case op_call: {
+                    const arguments_t args = arguments(i, frame);
+
+                    invoke(i.target, frame, args);
+                    break;
+                }
+
+                case op_for_each: {
+                    node_set_t nodes = select(*i.select, frame);
+
+                    sort(nodes, i.sorts);
+
+                    for (size_t n = 0; n != nodes.size(); ++n)
+                        execute(i.body, frame_t { nodes[n], n + 1, nodes.size() });
+
+                    break;
+                }
+
+                case op_if:
+                    if (i.select->test(frame.node, frame.position, frame.size, mState.source, &mState.variables))
+                        execute(i.body, frame);
+
+                    break;
+
+                case op_choose:
+                    for (uint32_t index : i.body) {
+                        const instruction_t& when = mStylesheet.mInstructions[index];
+
+                        if (!when.select || when.select->test(frame.node, frame.position, frame.size, mState.source, &mState.variables)) {
+                            execute(when.body, frame);
+                            break;
+                        }
+                    }
+
+                    break;
+
+                case op_when:
+                    break;
+
+                case op_copy:
+                    switch (frame.node.kind()) {
+                    case node_t::element_kind: {
+                        const element_t& element = *frame.node.element();
+
+                        start(uri(element.namespace_id()), element.name().view().str());
+                        execute(i.body, frame);
+                        end();
+                        break;
+                    }
+
+                    case node_t::document_kind:
+                        execute(i.body, frame);
+                        break;
+
+                    default:
+                        copy(frame.node);
+                        break;
+                    }
+
+                    break;
+
+                case op_copy_of: {
+                    const value_t result = evaluate(*i.select, frame);
+
+                    if (result.type() != value_t::node_set_type) {
+                        characters(result.string());
+                    } else {
+                        for (const node_t& node : result.nodes())
+                            copy(node);
+                    }
+
+                    break;
+                }
+
+                case op_element: {
+                    const string_t name = avt(i.name, frame);
+                    const string_t ns   = i.flag ? avt(i.ns, frame) : resolve(i.bindings, name, true);
+
+                    start(ns, name);
+                    execute(i.body, frame);
+                    end();
+                    break;
+                }
+
+                case op_attribute: {
+                    const string_t name = avt(i.name, frame);
+                    const string_t ns   = i.flag ? avt(i.ns, frame) : resolve(i.bindings, name, false);
+
+                    add(ns, name, collect(i.body, frame));
+                    break;
+                }
+
+                case op_variable:
+                    bind(i.text, value(i, frame));
+                    break;
+
+                case op_comment: {
+                    const string_t text = collect(i.body, frame);
+
+                    flush();
+                    mHandler.comment(view_t(text));
+                    break;
+                }
+
+                case op_pi: {
+                    const string_t target = avt(i.name, frame);
+                    const string_t text   = collect(i.body, frame);
+
+                    flush();
+                    mHandler.processing_instruction(view_t(target), view_t(text));
+                    break;
+                }
+
+                case op_message:
+                    if (i.flag)
+                        fail("the transformation was terminated by xsl:message");
+
+                    break;
+                }
+            }
+
+            //! \brief Apply the template rules of a mode to a list of nodes.
+            void apply(const node_set_t& nodes, uint32_t mode, const arguments_t& args)
+            {
+                for (size_t n = 0; n != nodes.size(); ++n) {
+                    const frame_t  frame = { nodes[n], n + 1, nodes.size() };
+                    const uint32_t found = find(mode, nodes[n]);
+
+                    if (found != npos)
+                        invoke(found, frame, args);
+                    else
+                        builtin(frame, mode);
+                }
+            }
+
+            //! \brief Find the template rule of a node.
+            /*!
+             *  \return The template, or \c npos if no rule matches.
+             */
+            uint32_t find(uint32_t mode, const node_t& node)
+            {
+                const mode_t&                m     = mStylesheet.mModes[mode];
+                const std::vector<uint32_t>* rules = nullptr;
+
+                switch (node.kind()) {
+                case node_t::element_kind:
+                    rules = candidates(m.elements, node.element()->namespace_id(), node.element()->local_name(), m.element);
+                    break;
+
+                case node_t::attribute_kind:
+                    rules = candidates(m.attributes, node.attribute()->namespace_id(), node.attribute()->local_name(), m.attribute);
+                    break;
+
+                case node_t::text_kind:
+                    rules = &m.texts;
+                    break;
+
+                case node_t::document_kind:
+                    rules = &m.documents;
+                    break;
+
+                default:
+                    return npos;
+                }
+
+                for (uint32_t rule : *rules)
+                    if (mStylesheet.mRules[rule].pattern->matches(node, mState.source, &mState.variables))
+                        return mStylesheet.mRules[rule].target;
+
+                return npos;
+            }
+
+            //! \brief Get the rules that may match a name.
+            /*!
+             *  The namespaces interned in the source table since the last
+             *  call are looked up first.
+             */
+            const std::vector<uint32_t>* candidates(const names_t& names, namespace_id_t ns, const view_t& local, const std::vector<uint32_t>& others) const
+            {
+                if (mState.source != nullptr)
+                    for (size_t i = mState.ids.size(); i < mState.source->size(); ++i)
+                        mState.ids.push_back(mStylesheet.mNamespaces.find(view_t(mState.source->uri(static_cast<namespace_id_t>(i)))));
+
+                const namespace_id_t id = ns < mState.ids.size() ? mState.ids[ns] : table_t::npos;
+
+                if (id == table_t::npos)
+                    return &others;
+
+                typename names_t::const_iterator it = names.find(name_t { id, local });
+
+                return it != names.end() ? &it->second : &others;
+            }
+
+            //! \brief Apply the built-in template rule of a node.
+            void builtin(const frame_t& frame, uint32_t mode)
+            {
+                switch (frame.node.kind()) {
+                case node_t::document_kind:
+                case node_t::element_kind: {
+                    node_set_t nodes;
+
+                    children(frame.node, nodes);
+                    enter();
+                    apply(nodes, mode, arguments_t());
+                    --mDepth;
+                    break;
+                }
+
+                default:
+                    characters(frame.node.string_value());
+                    break;
+                }
+            }
+
+            //! \brief Instantiate a template.
+            void invoke(uint32_t index, const frame_t& frame, const arguments_t& args)
+            {
+                const template_t& t    = mStylesheet.mTemplates[index];
+                const size_t      mark = mSaved.size();
+
+                enter();
+
+                for (size_t n = 0; n != mStylesheet.mShadowed.size(); ++n)
+                    bind(mStylesheet.mInstructions[mStylesheet.mShadowed[n]].text, mState.shadows[n]);
+
+                for (uint32_t param : t.params) {
+                    const instruction_t& decl  = mStylesheet.mInstructions[param];
+                    auto                 found = std::find_if(args.begin(), args.end(), [&decl](const std::pair<const string_t*, value_t>& arg) {
+                        return *arg.first == decl.text;
+                    });
+
+                    if (found != args.end())
+                        bind(decl.text, found->second);
+                    else
+                        bind(decl.text, value(decl, frame));
+                }
+
+                execute(t.body, frame);
+                restore(mark);
+                --mDepth;
+            }
+
+            //! \brief Enter a template, checking the depth of the calls.
+            void enter()
+            {
+                if (++mDepth > max_depth)
+                    fail("too many nested templates");
+            }
+
+            //! \brief Evaluate the \c xsl:with-param of an instruction.
+            arguments_t arguments(const instruction_t& i, const frame_t& frame)
+            {
+                arguments_t args;
+
+                for (uint32_t param : i.params) {
+                    const instruction_t& decl = mStylesheet.mInstructions[param];
+
+                    args.emplace_back(&decl.text, value(decl, frame));
+                }
+
+                return args;
+            }
+
+            //! \brief Evaluate an expression.
+            value_t evaluate(const expression_t& expression, const frame_t& frame) const
+            {
+                return expression.evaluate(frame.node, frame.position, frame.size, mState.source, &mState.variables);
+            }
+
+            //! \brief Evaluate an expression that must be a node-set.
+            node_set_t select(const expression_t& expression, const frame_t& frame) const
+            {
+                value_t result = evaluate(expression, frame);
+
+                if (result.type() != value_t::node_set_type)
+                    fail("the selected value is not a node-set");
+
+                return std::move(result.nodes());
+            }
+
+            //! \brief Get the value of a variable or a parameter.
+            value_t value(const instruction_t& decl, const frame_t& frame)
+            {
+                if (decl.select)
+                    return evaluate(*decl.select, frame);
+
+                return value_t(collect(decl.body, frame));
+            }
+
+            //! \brief Get the characters produced by instructions.
+            string_t collect(const std::vector<uint32_t>& body, const frame_t& frame)
+            {
+                string_t result;
+
+                if (body.empty())
+                    return result;
+
+                collector_t                collector(result);
+                processor_t<collector_t>   nested(mStylesheet, collector, mState, mDepth);
+
+                nested.execute(body, frame);
+
+                return result;
+            }
+
+            //! \brief Evaluate an attribute value template.
+            string_t avt(const avt_t& parts, const frame_t& frame) const
+            {
+                if (parts.size() == 1 && !parts.front().expression)
+                    return parts.front().text;
+
+                string_t result;
+
+                for (const part_t& part : parts)
+                    if (part.expression)
+                        result += evaluate(*part.expression, frame).string();
+                    else
+                        result += part.text;
+
+                return result;
+            }
+
+            //! \brief Sort nodes by the keys of \c xsl:sort.
+            void sort(node_set_t& nodes, const std::vector<sort_t>& sorts) const
+            {
+                if (sorts.empty() || nodes.size() < 2)
+                    return;
+
+                const size_t                     count = nodes.size();
+                std::vector<string_t>            strings(count * sorts.size());
+                std::vector<double>              numbers(count * sorts.size());
+                std::vector<size_t>              order(count);
+
+                for (size_t n = 0; n != count; ++n)
+                    for (size_t k = 0; k != sorts.size(); ++k) {
+                        const value_t key = evaluate(*sorts[k].select, frame_t { nodes[n], n + 1, count });
+
+                        if (sorts[k].number)
+                            numbers[n * sorts.size() + k] = key.number();
+                        else
+                            strings[n * sorts.size() + k] = key.string();
+                    }
+
+                std::iota(order.begin(), order.end(), size_t(0));
+                std::stable_sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs) {
+                    for (size_t k = 0; k != sorts.size(); ++k) {
+                        const size_t l = lhs * sorts.size() + k;
+                        const size_t r = rhs * sorts.size() + k;
+                        int          c;
+
+                        if (sorts[k].number)
+                            c = less(numbers[l], numbers[r]) ? -1 : less(numbers[r], numbers[l]) ? 1 : 0;
+                        else
+                            c = strings[l].compare(strings[r]);
+
+                        if (c != 0)
+                            return sorts[k].descending ? c > 0 : c < 0;
+                    }
+
+                    return false;
+                });
+
+                node_set_t sorted;
+
+                sorted.reserve(count);
+
+                for (size_t n : order)
+                    sorted.push_back(nodes[n]);
+
+                nodes.swap(sorted);
+            }
+
+            //! \brief Compare sort keys, NaN first.
+            static bool less(double lhs, double rhs)
+            {
+                if (std::isnan(lhs))
+                    return !std::isnan(rhs);
+
+                return !std::isnan(rhs) && lhs < rhs;
+            }
+
+            //! \brief Get the children of a node.
+            static void children(const node_t& node, node_set_t& nodes)
+            {
+                const typename node_t::parent_t* parent = node.parent_node();
+
+                if (parent == nullptr)
+                    return;
+
+                for (const child_t* it = node_t::first_child(*parent); it != nullptr; it = it->next_sibling()) {
+                    const node_t child = node_t::from_child(*it);
+
+                    if (child)
+                        nodes.push_back(child);
+                }
+            }
+
+            //! \brief Copy a node of the source and its descendants.
+            void copy(const node_t& node)
+            {
+                switch (node.kind()) {
+                case node_t::document_kind: {
+                    node_set_t nodes;
+
+                    children(node, nodes);
+
+                    for (const node_t& child : nodes)
+                        copy(child);
+
+                    break;
+                }
+
+                case node_t::element_kind: {
+                    const element_t& element = *node.element();
+                    node_set_t       nodes;
+
+                    start(uri(element.namespace_id()), element.name().view().str());
+
+                    for (const attribute_t& attribute : element.attributes())
+                        if (!declaration(attribute))
+                            add(uri(attribute.namespace_id()), attribute.name().view().str(), attribute.value().view().str());
+
+                    children(node, nodes);
+
+                    for (const node_t& child : nodes)
+                        copy(child);
+
+                    end();
+                    break;
+                }
+
+                case node_t::attribute_kind:
+                    if (!declaration(*node.attribute()))
+                        add(uri(node.attribute()->namespace_id()), node.attribute()->name().view().str(), node.attribute()->value().view().str());
+
+                    break;
+
+                case node_t::text_kind:
+                    characters(node.text()->data().view().str());
+                    break;
+
+                default:
+                    break;
+                }
+            }
+
+            //! \brief Whether an attribute of the source declares a namespace.
+            static bool declaration(const attribute_t& attribute)
+            {
+                const view_t name = attribute.name().view();
+
+                return attribute.namespace_id() == table_t::xmlns_namespace || name.equals("xmlns") ||
+                       (name.size() > 6 && name.substr(0, 6).equals("xmlns:"));
+            }
+
+            //! \brief Get the URI of a namespace of the source.
+            const string_t& uri(namespace_id_t id) const
+            {
+                static const string_t none;
+
+                return mState.source != nullptr && id < mState.source->size() ? mState.source->uri(id) : none;
+            }
+
+            //! \brief Get the namespace of a computed name from the namespaces in scope.
+            /*!
+             *  \throw exception_t If the prefix of \c name is not bound.
+             */
+            static string_t resolve(const bindings_t& bindings, const string_t& name, bool element)
+            {
+                const size_t colon  = name.find(':');
+                const string_t prefix = colon != string_t::npos ? name.substr(0, colon) : string_t();
+
+                if (prefix.empty() && !element)
+                    return string_t();
+
+                if (view_t(prefix).equals("xml"))
+                    return ascii("http://www.w3.org/XML/1998/namespace");
+
+                for (auto it = bindings.rbegin(); it != bindings.rend(); ++it)
+                    if (it->first == prefix)
+                        return it->second;
+
+                if (!prefix.empty())
+                    fail("unbound prefix in a computed name");
+
+                return string_t();
+            }
+
+            //! \brief Bind a variable until the end of the current scope.
+            void bind(const string_t& name, value_t value)
+            {
+                typename parameters_t::iterator it = mState.variables.find(name);
+
+                if (it != mState.variables.end()) {
+                    mSaved.push_back(saved_t { name, true, std::move(it->second) });
+                    it->second = std::move(value);
+                } else {
+                    mSaved.push_back(saved_t { name, false, value_t() });
+                    mState.variables.emplace(name, std::move(value));
+                }
+            }
+
+            //! \brief Restore the variables shadowed since a mark.
+            void restore(size_t mark)
+            {
+                while (mSaved.size() > mark) {
+                    saved_t& saved = mSaved.back();
+
+                    if (saved.bound)
+                        mState.variables[saved.name] = std::move(saved.value);
+                    else
+                        mState.variables.erase(saved.name);
+
+                    mSaved.pop_back();
+                }
+            }
+
+            //! \brief Start an element of the result.
+            /*!
+             *  The start tag is held until its content starts, so that the
+             *  attributes can be added and the namespaces declared.
+             */
+            void start(const string_t& uri, const string_t& name)
+            {
+                flush();
+
+                mPending = true;
+                mElement = tag_t { uri, name };
+                mAttributes.clear();
+            }
+
+            //! \brief Add an attribute to the element being started.
+            /*!
+             *  An attribute added after content is ignored, and replaces an
+             *  attribute of the same name added before.
+             */
+            void add(const string_t& uri, const string_t& name, string_t value)
+            {
+                if (!mPending || view_t(name).equals("xmlns") || view_t(uri).equals("http://www.w3.org/2000/xmlns/"))
+                    return;
+
+                const view_t local = localName(name);
+
+                for (pending_attribute_t& attribute : mAttributes)
+                    if (attribute.uri == uri && localName(attribute.name) == local) {
+                        attribute.value = std::move(value);
+
+                        return;
+                    }
+
+                mAttributes.push_back(pending_attribute_t { uri, name, std::move(value) });
+            }
+
+            //! \brief Add characters to the result.
+            void characters(const string_t& text)
+            {
+                flush();
+
+                if (!text.empty())
+                    mHandler.text(view_t(text));
+            }
+
+            //! \brief End an element of the result.
+            void end()
+            {
+                flush();
+
+                mHandler.end_element(view_t(mOpen.back().uri), view_t(mOpen.back().name));
+                mOpen.pop_back();
+                mScope.resize(mMarks.back());
+                mMarks.pop_back();
+            }
+
+            //! \brief Report the element being started, with its namespace declarations.
+            void flush()
+            {
+                if (!mPending)
+                    return;
+
+                mPending = false;
+
+                const size_t first = mScope.size();
+
+                mMarks.push_back(first);
+
+                const string_t tag = prefix(mElement.name);
+
+                if (tag.empty() || !mElement.uri.empty())
+                    declare(tag, mElement.uri);
+
+                for (pending_attribute_t& attribute : mAttributes) {
+                    if (attribute.uri.empty())
+                        continue;
+
+                    const string_t p     = prefix(attribute.name);
+                    const string_t* bound = lookup(p);
+
+                    if (!p.empty() && bound != nullptr && *bound == attribute.uri)
+                        continue;
+
+                    if (!p.empty() && std::none_of(mScope.begin() + first, mScope.end(), [&p](const std::pair<string_t, string_t>& binding) {
+                            return binding.first == p;
+                        })) {
+                        declare(p, attribute.uri);
+                        continue;
+                    }
+
+                    attribute.name = generate(attribute.uri) + ascii(":") + localName(attribute.name).str();
+                }
+
+                mOpen.push_back(mElement);
+                mHandler.start_element(view_t(mElement.uri), view_t(mElement.name));
+
+                const string_t xmlns = ascii("http://www.w3.org/2000/xmlns/");
+
+                for (size_t n = first; n != mScope.size(); ++n)
+                    mHandler.attribute(view_t(xmlns), view_t(mScope[n].first.empty() ? ascii("xmlns") : ascii("xmlns:") + mScope[n].first), view_t(mScope[n].second));
+
+                for (const pending_attribute_t& attribute : mAttributes)
+                    mHandler.attribute(view_t(attribute.uri), view_t(attribute.name), view_t(attribute.value));
+            }
+
+            //! \brief Get a prefix bound to a namespace, declaring a new one if needed.
+            string_t generate(const string_t& uri)
+            {
+                for (auto it = mScope.rbegin(); it != mScope.rend(); ++it)
+                    if (!it->first.empty() && it->second == uri && *lookup(it->first) == uri)
+                        return it->first;
+
+                for (size_t n = 0;; ++n) {
+                    const string_t candidate = ascii("ns") + value_t::to_string(double(n));
+
+                    if (lookup(candidate) == nullptr) {
+                        mScope.emplace_back(candidate, uri);
+
+                        return candidate;
+                    }
+                }
+            }
+
+            //! \brief Declare a prefix, unless it is already bound to a namespace.
+            void declare(const string_t& prefix, const string_t& uri)
+            {
+                const string_t* bound = lookup(prefix);
+
+                if (bound == nullptr || *bound != uri)
+                    mScope.emplace_back(prefix, uri);
+            }
+
+            //! \brief Get the namespace bound to a prefix in the result.
+            /*!
+             *  \return The namespace, or \c nullptr if the prefix is not bound.
+             */
+            const string_t* lookup(const string_t& prefix) const
+            {
+                static const string_t none;
+                static const string_t xml = ascii("http://www.w3.org/XML/1998/namespace");
+
+                for (auto it = mScope.rbegin(); it != mScope.rend(); ++it)
+                    if (it->first == prefix)
+                        return &it->second;
+
+                if (prefix.empty())
+                    return &none;
+
+                return view_t(prefix).equals("xml") ? &xml : nullptr;
+            }
+
+            //! \brief Get the prefix of a qualified name.
+            static string_t prefix(const string_t& name)
+            {
+                const size_t colon = name.find(':');
+
+                return colon != string_t::npos ? name.substr(0, colon) : string_t();
+            }
+
+            //! \brief Get the local part of a qualified name.
+            static view_t localName(const string_t& name)
+            {
+                const size_t colon = name.find(':');
+
+                return colon != string_t::npos ? view_t(name).substr(colon + 1) : view_t(name);
+            }
+
+            const stylesheet_t&                           mStylesheet; //!< The stylesheet.
+            handlerT&                                     mHandler;    //!< The receiver of the result.
+            state_t&                                      mState;      //!< The state of the transformation.
+            size_t                                        mDepth;      //!< The number of nested templates.
+            std::vector<saved_t>                          mSaved;      //!< The values shadowed by variables in scope.
+            std::vector<std::pair<string_t, string_t> >   mScope;      //!< The prefixes declared by the open elements of the result.
+            std::vector<size_t>                           mMarks;      //!< The size of \c mScope before each open element.
+            std::vector<tag_t>                            mOpen;       //!< The open elements of the result.
+            bool                                          mPending;    //!< Whether an element is being started.
+            tag_t                                         mElement;    //!< The element being started.
+            std::vector<pending_attribute_t>              mAttributes; //!< The attributes of the element being started.
+            std::vector<size_t>                           mLevels;     //!< The size of \c mSaved when each level of a streamed template was entered.
+            arguments_t                                   mArguments;  //!< The parameters applied to the streamed records.
+        };
+
+        //! \brief The compiler of a stylesheet document.
+        class compiler_t {
+        public:
+            //! \brief Constructor.
+            compiler_t(stylesheet_t& target, const document_t& document)
+            :
+                error(nullptr),
+                stylesheet(target),
+                source(document),
+                xsl(document.namespaces().find(ascii("http://www.w3.org/1999/XSL/Transform"))),
+                scope(),
+                modes(),
+                named(),
+                calls(),
+                locals()
+            {}
+
+            //! \brief Compile the stylesheet document.
+            bool compile()
+            {
+                const element_t& root = source.root();
+                const size_t     mark = enter(root);
+
+                stylesheet.mModes.push_back(mode_t());
+                modes.emplace(string_t(), 0);
+
+                if (isXsl(root, "stylesheet") || isXsl(root, "transform")) {
+                    for (auto it = root.begin(); it != root.end(); ++it) {
+                        if (it->kind() == node_interface_t::text_kind && !stripped(static_cast<const text_t&>(*it), root))
+                            return fail("text is not allowed at the top level of a stylesheet");
+
+                        if (it->kind() == node_interface_t::element_kind && !declaration(static_cast<const element_t&>(*it)))
+                            return false;
+                    }
+                } else {
+                    bool simplified = false;
+
+                    for (const attribute_t& attribute : root.attributes())
+                        simplified = simplified || (xsl != table_t::npos && attribute.namespace_id() == xsl && attribute.local_name().equals("version"));
+
+                    if (!simplified)
+                        return fail("the root element is not a stylesheet");
+
+                    template_t t = { string_t(), 0, std::vector<uint32_t>(), std::vector<uint32_t>() };
+                    uint32_t   index;
+
+                    if (!literal(root, index))
+                        return false;
+
+                    t.body.push_back(index);
+                    stylesheet.mTemplates.push_back(std::move(t));
+                    stylesheet.mRules.push_back(rule_t { expression_t::compile(ascii("/")), 0, 0.5, 0 });
+                }
+
+                leave(mark);
+
+                for (uint32_t call : calls) {
+                    instruction_t& i = stylesheet.mInstructions[call];
+                    auto           it = named.find(i.text);
+
+                    if (it == named.end())
+                        return fail("call of an undefined template");
+
+                    i.target = it->second;
+                }
+
+                for (uint32_t global : stylesheet.mGlobals)
+                    if (locals.count(stylesheet.mInstructions[global].text) != 0)
+                        stylesheet.mShadowed.push_back(global);
+
+                dispatch();
+                stream();
+
+                return true;
+            }
+
+            const char* error; //!< A description of the compilation error.
+
+        private:
+            //! \brief Widen an ASCII string.
+            static string_t ascii(const char* str)
+            {
+                return stylesheet_t::ascii(str);
+            }
+
+            //! \brief Record an error.
+            bool fail(const char* what)
+            {
+                if (error == nullptr)
+                    error = what;
+
+                return false;
+            }
+
+            //! \brief Whether an element is a given XSLT element.
+            bool isXsl(const element_t& element, const char* local) const
+            {
+                return xsl != table_t::npos && element.namespace_id() == xsl && element.local_name().equals(local);
+            }
+
+            //! \brief Get an unqualified attribute.
+            static bool attribute(const element_t& element, const char* name, view_t& value)
+            {
+                for (const attribute_t& attribute : element.attributes())
+                    if (attribute.namespace_id() == table_t::no_namespace && attribute.local_name().equals(name)) {
+                        value = attribute.value().view();
+
+                        return true;
+                    }
+
+                return false;
+            }
+
+            //! \brief Bring the namespaces declared by an element into scope.
+            /*!
+             *  \return The mark to give to \c leave() at the end of the element.
+             */
+            size_t enter(const element_t& element)
+            {
+                const size_t mark = scope.size();
+
+                for (const attribute_t& attribute : element.attributes())
+                    if (attribute.namespace_id() == table_t::xmlns_namespace) {
+                        const view_t name = attribute.name().view();
+
+                        scope.emplace_back(name.equals("xmlns") ? string_t() : name.substr(6).str(), attribute.value().view().str());
+                    }
+
+                return mark;
+            }
+
+            //! \brief Take the namespaces declared by an element out of scope.
+            void leave(size_t mark)
+            {
+                scope.resize(mark);
+            }
+
+            //! \brief Get the prefixes in scope, for XPath expressions.
+            bindings_t bindings() const
+            {
+                bindings_t result;
+
+                for (const std::pair<string_t, string_t>& binding : scope)
+                    if (!binding.first.empty())
+                        result.push_back(binding);
+
+                return result;
+            }
+
+            //! \brief Compile an expression attribute.
+            /*!
+             *  \param [in] element  The element.
+             *  \param [in] name     The name of the attribute.
+             *  \param [out] result  The compiled expression, left empty if
+             *                       the attribute is missing.
+             *  \param [in] required Whether the attribute is required.
+             */
+            bool expression(const element_t& element, const char* name, expression_pointer_t& result, bool required)
+            {
+                view_t value;
+
+                if (!attribute(element, name, value))
+                    return !required || fail("a required XPath expression is missing");
+
+                return compile(value, result);
+            }
+
+            //! \brief Compile an expression.
+            bool compile(const view_t& value, expression_pointer_t& result)
+            {
+                typename expression_t::result_t compiled = expression_t::try_compile(value, bindings());
+
+                if (!compiled)
+                    return fail("invalid XPath expression");
+
+                result = std::move(compiled.value());
+
+                return true;
+            }
+
+            //! \brief Compile an attribute value template.
+            bool avt(const view_t& value, avt_t& result)
+            {
+                string_t text;
+
+                for (size_t i = 0; i < value.size(); ++i) {
+                    const charT c = value[i];
+
+                    if (c == '{' && i + 1 < value.size() && value[i + 1] == '{') {
+                        text.push_back(c);
+                        ++i;
+                    } else if (c == '}' && i + 1 < value.size() && value[i + 1] == '}') {
+                        text.push_back(c);
+                        ++i;
+                    } else if (c == '}') {
+                        return fail("unmatched brace in an attribute value template");
+                    } else if (c == '{') {
+                        size_t j     = i + 1;
+                        charT  quote = 0;
+
+                        for (; j < value.size(); ++j) {
+                            if (quote != 0) {
+                                if (value[j] == quote)
+                                    quote = 0;
+                            } else if (value[j] == '\'' || value[j] == '"') {
+                                quote = value[j];
+                            } else if (value[j] == '}') {
+                                break;
+                            }
+                        }
+
+                        if (j == value.size())
+                            return fail("unterminated expression in an attribute value template");
+
+                        if (!text.empty()) {
+                            result.push_back(part_t { std::move(text), expression_pointer_t() });
+                            text.clear();
+                        }
+
+                        part_t part;
+
+                        if (!compile(value.substr(i + 1, j - i - 1), part.expression))
+                            return false;
+
+                        result.push_back(std::move(part));
+                        i = j;
+                    } else {
+                        text.push_back(c);
+                    }
+                }
+
+                if (!text.empty() || result.empty())
+                    result.push_back(part_t { std::move(text), expression_pointer_t() });
+
+                return true;
+            }
+
+            //! \brief Get the index of a mode.
+            uint32_t mode(const view_t& name)
+            {
+                auto it = modes.find(name.str());
+
+                if (it != modes.end())
+                    return it->second;
+
+                const uint32_t index = static_cast<uint32_t>(stylesheet.mModes.size());
+
+                stylesheet.mModes.push_back(mode_t());
+                modes.emplace(name.str(), index);
+
+                return index;
+            }
+
+            //! \brief Add an instruction to the program.
+            uint32_t add(instruction_t i)
+            {
+                stylesheet.mInstructions.push_back(std::move(i));
+
+                return static_cast<uint32_t>(stylesheet.mInstructions.size() - 1);
+            }
+
+            //! \brief Compile a top-level element.
+            bool declaration(const element_t& element)
+            {
+                if (xsl == table_t::npos || element.namespace_id() != xsl)
+                    return true;
+
+                const size_t mark = enter(element);
+                const view_t local = element.local_name();
+                bool         ok    = true;
+
+                if (local.equals("template")) {
+                    ok = templateRule(element);
+                } else if (local.equals("variable") || local.equals("param")) {
+                    uint32_t index;
+
+                    ok = variable(element, local.equals("param"), index);
+
+                    if (ok)
+                        stylesheet.mGlobals.push_back(index);
+                } else if (local.equals("output")) {
+                    view_t value;
+
+                    if (attribute(element, "method", value))
+                        stylesheet.mOutput.method = value.equals("text") ? writer_t::text_method : writer_t::xml_method;
+
+                    if (attribute(element, "indent", value))
+                        stylesheet.mOutput.indent = value.equals("yes");
+
+                    if (attribute(element, "omit-xml-declaration", value))
+                        stylesheet.mOutput.declaration = !value.equals("yes");
+                } else if (local.equals("strip-space") || local.equals("preserve-space")) {
+                    ok = true;
+                } else if (local.equals("import") || local.equals("include") || local.equals("key") ||
+                           local.equals("attribute-set") || local.equals("decimal-format") || local.equals("namespace-alias")) {
+                    ok = fail("unsupported XSLT declaration");
+                } else {
+                    ok = fail("unknown XSLT declaration");
+                }
+
+                leave(mark);
+
+                return ok;
+            }
+
+            //! \brief Compile a \c xsl:template.
+            bool templateRule(const element_t& element)
+            {
+                const uint32_t index = static_cast<uint32_t>(stylesheet.mTemplates.size());
+                template_t     t     = { string_t(), 0, std::vector<uint32_t>(), std::vector<uint32_t>() };
+                view_t         match, name, value;
+                const bool     matches = attribute(element, "match", match);
+
+                if (attribute(element, "name", name)) {
+                    if (!named.emplace(name.str(), index).second)
+                        return fail("duplicate template name");
+
+                    t.name = name.str();
+                } else if (!matches) {
+                    return fail("a template has neither a match nor a name attribute");
+                }
+
+                if (attribute(element, "mode", value))
+                    t.mode = mode(value);
+
+                if (!body(element, t.body, &t.params, nullptr))
+                    return false;
+
+                stylesheet.mTemplates.push_back(std::move(t));
+
+                if (!matches)
+                    return true;
+
+                double priority = std::numeric_limits<double>::quiet_NaN();
+
+                if (attribute(element, "priority", value) && std::isnan(priority = value_t::to_number(value)))
+                    return fail("invalid template priority");
+
+                for (const view_t& alternative : alternatives(match)) {
+                    expression_pointer_t pattern;
+
+                    if (!compile(alternative, pattern))
+                        return false;
+
+                    if (!pattern->pattern())
+                        return fail("invalid template pattern");
+
+                    const double p = std::isnan(priority) ? pattern->priority() : priority;
+
+                    stylesheet.mRules.push_back(rule_t { std::move(pattern), index, p, static_cast<uint32_t>(stylesheet.mRules.size()) });
+                }
+
+                return true;
+            }
+
+            //! \brief Split a pattern on its top-level \c | operators.
+            static std::vector<view_t> alternatives(const view_t& pattern)
+            {
+                std::vector<view_t> result;
+                size_t              start = 0;
+                size_t              depth = 0;
+                charT               quote = 0;
+
+                for (size_t i = 0; i != pattern.size(); ++i) {
+                    const charT c = pattern[i];
+
+                    if (quote != 0) {
+                        if (c == quote)
+                            quote = 0;
+                    } else if (c == '\'' || c == '"') {
+                        quote = c;
+                    } else if (c == '[' || c == '(') {
+                        ++depth;
+                    } else if ((c == ']' || c == ')') && depth > 0) {
+                        --depth;
+                    } else if (c == '|' && depth == 0) {
+                        result.push_back(pattern.substr(start, i - start));
+                        start = i + 1;
+                    }
+                }
+
+                result.push_back(pattern.substr(start));
+
+                return result;
+            }
+
+            //! \brief Compile a variable, a parameter or an argument.
+            bool variable(const element_t& element, bool param, uint32_t& index)
+            {
+                instruction_t i(op_variable);
+                view_t        name;
+
+                if (!attribute(element, "name", name))
+                    return fail("a variable has no name");
+
+                i.text = name.str();
+                i.flag = param;
+
+                if (!expression(element, "select", i.select, false))
+                    return false;
+
+                if (!body(element, i.body, nullptr, nullptr))
+                    return false;
+
+                if (i.select && !i.body.empty())
+                    return fail("a variable has both a select attribute and a content");
+
+                index = add(std::move(i));
+
+                return true;
+            }
+
+            //! \brief Whether a text of the stylesheet is stripped.
+            /*!
+             *  Texts made of white spaces are stripped, except in the scope of
+             *  \c xml:space="preserve" and in \c xsl:text.
+             *
+             *  \param [in] text   The text.
+             *  \param [in] parent The element holding the text.
+             */
+            static bool stripped(const text_t& text, const element_t& parent)
+            {
+                const view_t data = text.data().view();
+
+                return reader_t::scanner_t::all_whitespace(data.begin(), data.end()) && !parent.preserves_space();
+            }
+
+            //! \brief Compile the content of an element.
+            /*!
+             *  \param [in] parent  The element.
+             *  \param [out] result The instructions of the content.
+             *  \param [out] params The leading \c xsl:param, or \c nullptr if they are not allowed.
+             *  \param [out] sorts  The leading \c xsl:sort, or \c nullptr if they are not allowed.
+             */
+            bool body(const element_t& parent, std::vector<uint32_t>& result, std::vector<uint32_t>* params, std::vector<sort_t>* sorts)
+            {
+                for (auto it = parent.begin(); it != parent.end(); ++it) {
+                    if (it->kind() == node_interface_t::text_kind) {
+                        if (stripped(static_cast<const text_t&>(*it), parent))
+                            continue;
+
+                        instruction_t i(op_text);
+
+                        i.text = static_cast<const text_t&>(*it).data().view().str();
+                        result.push_back(add(std::move(i)));
+                        continue;
+                    }
+
+                    if (it->kind() != node_interface_t::element_kind)
+                        continue;
+
+                    const element_t& child = static_cast<const element_t&>(*it);
+                    uint32_t         index = npos;
+
+                    if (isXsl(child, "param")) {
+                        if (params == nullptr || !result.empty())
+                            return fail("misplaced xsl:param");
+
+                        const size_t mark = enter(child);
+                        const bool   ok   = variable(child, true, index);
+
+                        leave(mark);
+
+                        if (!ok)
+                            return false;
+
+                        locals.insert(stylesheet.mInstructions[index].text);
+                        params->push_back(index);
+                    } else if (isXsl(child, "sort")) {
+                        if (sorts == nullptr || !result.empty())
+                            return fail("misplaced xsl:sort");
+
+                        sort_t s;
+
+                        if (!sort(child, s))
+                            return false;
+
+                        sorts->push_back(std::move(s));
+                    } else {
+                        if (!instruction(child, index))
+                            return false;
+
+                        if (index != npos)
+                            result.push_back(index);
+                    }
+                }
+
+                return true;
+            }
+
+            //! \brief Compile a \c xsl:sort.
+            bool sort(const element_t& element, sort_t& result)
+            {
+                const size_t mark = enter(element);
+                view_t       value;
+
+                result.descending = attribute(element, "order", value) && value.equals("descending");
+                result.number     = attribute(element, "data-type", value) && value.equals("number");
+
+                bool ok = expression(element, "select", result.select, false);
+
+                if (ok && !result.select)
+                    result.select = expression_t::compile(ascii("."));
+
+                leave(mark);
+
+                return ok;
+            }
+
+            //! \brief Compile an instruction or a literal result element.
+            /*!
+             *  \param [in] element The element.
+             *  \param [out] index  The instruction, or \c npos if the element is ignored.
+             */
+            bool instruction(const element_t& element, uint32_t& index)
+            {
+                const size_t mark = enter(element);
+                const bool   ok   = xsl != table_t::npos && element.namespace_id() == xsl ? xslt(element, index) : literal(element, index);
+
+                leave(mark);
+
+                return ok;
+            }
+
+            //! \brief Compile a literal result element.
+            bool literal(const element_t& element, uint32_t& index)
+            {
+                instruction_t i(op_literal);
+
+                i.uri  = source.namespaces().uri(element.namespace_id());
+                i.text = element.name().view().str();
+
+                for (const attribute_t& attribute : element.attributes()) {
+                    if (attribute.namespace_id() == table_t::xmlns_namespace || (xsl != table_t::npos && attribute.namespace_id() == xsl))
+                        continue;
+
+                    literal_attribute_t item = { source.namespaces().uri(attribute.namespace_id()), attribute.name().view().str(), avt_t() };
+
+                    if (!avt(attribute.value().view(), item.value))
+                        return false;
+
+                    i.attributes.push_back(std::move(item));
+                }
+
+                if (!body(element, i.body, nullptr, nullptr))
+                    return false;
+
+                index = add(std::move(i));
+
+                return true;
+            }
+
+            //! \brief Compile a computed name, and its namespace.
+            bool name(const element_t& element, instruction_t& i)
+            {
+                view_t value;
+
+                if (!attribute(element, "name", value))
+                    return fail("a computed name is missing");
+
+                if (!avt(value, i.name))
+                    return false;
+
+                if (attribute(element, "namespace", value)) {
+                    i.flag = true;
+
+                    return avt(value, i.ns);
+                }
+
+                i.bindings = scope;
+
+                return true;
+            }
+
+            //! \brief Compile a XSLT instruction.
+            bool xslt(const element_t& element, uint32_t& index)
+            {
+                const view_t local = element.local_name();
+                view_t       value;
+
+                if (local.equals("apply-templates")) {
+                    instruction_t i(op_apply);
+
+                    if (!expression(element, "select", i.select, false))
+                        return false;
+
+                    i.bindings = bindings();
+
+                    if (attribute(element, "mode", value))
+                        i.target = mode(value);
+
+                    if (!arguments(element, i, true))
+                        return false;
+
+                    index = add(std::move(i));
+                } else if (local.equals("call-template")) {
+                    instruction_t i(op_call);
+
+                    if (!attribute(element, "name", value))
+                        return fail("a template call has no name");
+
+                    i.text = value.str();
+
+                    if (!arguments(element, i, false))
+                        return false;
+
+                    index = add(std::move(i));
+                    calls.push_back(index);
+                } else if (local.equals("for-each")) {
+                    instruction_t i(op_for_each);
+
+                    if (!expression(element, "select", i.select, true) || !body(element, i.body, nullptr, &i.sorts))
+                        return false;
+
+                    i.bindings = bindings();
+
+                    index = add(std::move(i));
+                } else if (local.equals("value-of") || local.equals("copy-of")) {
+                    instruction_t i(local.equals("value-of") ? op_value_of : op_copy_of);
+
+                    if (!expression(element, "select", i.select, true))
+                        return false;
+
+                    index = add(std::move(i));
+                } else if (local.equals("text")) {
+                    instruction_t i(op_text);
+
+                    for (auto it = element.begin(); it != element.end(); ++it)
+                        if (it->kind() == node_interface_t::text_kind)
+                            i.text += static_cast<const text_t&>(*it).data().view().str();
+
+                    index = add(std::move(i));
+                } else if (local.equals("if")) {
+                    instruction_t i(op_if);
+
+                    if (!expression(element, "test", i.select, true) || !body(element, i.body, nullptr, nullptr))
+                        return false;
+
+                    index = add(std::move(i));
+                } else if (local.equals("choose")) {
+                    instruction_t i(op_choose);
+
+                    if (!choose(element, i))
+                        return false;
+
+                    index = add(std::move(i));
+                } else if (local.equals("copy") || local.equals("comment") || local.equals("message")) {
+                    instruction_t i(local.equals("copy") ? op_copy : local.equals("comment") ? op_comment : op_message);
+
+                    if (attribute(element, "use-attribute-sets", value))
+                        return fail("attribute sets are not supported");
+
+                    i.flag = attribute(element, "terminate", value) && value.equals("yes");
+
+                    if (!body(element, i.body, nullptr, nullptr))
+                        return false;
+
+                    index = add(std::move(i));
+                } else if (local.equals("element") || local.equals("attribute")) {
+                    instruction_t i(local.equals("element") ? op_element : op_attribute);
+
+                    if (attribute(element, "use-attribute-sets", value))
+                        return fail("attribute sets are not supported");
+
+                    if (!name(element, i) || !body(element, i.body, nullptr, nullptr))
+                        return false;
+
+                    index = add(std::move(i));
+                } else if (local.equals("processing-instruction")) {
+                    instruction_t i(op_pi);
+
+                    if (!attribute(element, "name", value))
+                        return fail("a processing instruction has no name");
+
+                    if (!avt(value, i.name) || !body(element, i.body, nullptr, nullptr))
+                        return false;
+
+                    index = add(std::move(i));
+                } else if (local.equals("variable")) {
+                    if (!variable(element, false, index))
+                        return false;
+
+                    locals.insert(stylesheet.mInstructions[index].text);
+                } else if (local.equals("fallback")) {
+                    index = npos;
+                } else if (local.equals("number") || local.equals("apply-imports")) {
+                    return fail("unsupported XSLT instruction");
+                } else {
+                    return fail("unknown XSLT instruction");
+                }
+
+                return true;
+            }
+
+            //! \brief Compile the \c xsl:sort and \c xsl:with-param of an instruction.
+            bool arguments(const element_t& element, instruction_t& i, bool sorts)
+            {
+                for (auto it = element.begin(); it != element.end(); ++it) {
+                    if (it->kind() != node_interface_t::element_kind)
+                        continue;
+
+                    const element_t& child = static_cast<const element_t&>(*it);
+                    const size_t     mark  = enter(child);
+                    bool             ok;
+
+                    if (isXsl(child, "with-param")) {
+                        uint32_t index;
+
+                        ok = variable(child, false, index);
+
+                        if (ok)
+                            i.params.push_back(index);
+                    } else if (sorts && isXsl(child, "sort")) {
+                        sort_t s;
+
+                        ok = sort(child, s);
+
+                        if (ok)
+                            i.sorts.push_back(std::move(s));
+                    } else {
+                        ok = fail("invalid content of a template call");
+                    }
+
+                    leave(mark);
+
+                    if (!ok)
+                        return false;
+                }
+
+                return true;
+            }
+
+            //! \brief Compile the branches of a \c xsl:choose.
+            bool choose(const element_t& element, instruction_t& i)
+            {
+                bool otherwise = false;
+
+                for (auto it = element.begin(); it != element.end(); ++it) {
+                    if (it->kind() != node_interface_t::element_kind)
+                        continue;
+
+                    const element_t& child = static_cast<const element_t&>(*it);
+                    instruction_t    branch(op_when);
+
+                    if (otherwise || !(isXsl(child, "when") || isXsl(child, "otherwise")))
+                        return fail("invalid content of xsl:choose");
+
+                    otherwise = isXsl(child, "otherwise");
+
+                    const size_t mark = enter(child);
+                    const bool   ok   = (otherwise || expression(child, "test", branch.select, true)) && body(child, branch.body, nullptr, nullptr);
+
+                    leave(mark);
+
+                    if (!ok)
+                        return false;
+
+                    i.body.push_back(add(std::move(branch)));
+                }
+
+                if (i.body.empty())
+                    return fail("xsl:choose has no branch");
+
+                return true;
+            }
+
+            //! \brief Build the dispatch tables of the modes.
+            void dispatch()
+            {
+                std::vector<uint32_t> order(stylesheet.mRules.size());
+
+                std::iota(order.begin(), order.end(), uint32_t(0));
+                std::stable_sort(order.begin(), order.end(), [this](uint32_t lhs, uint32_t rhs) {
+                    const rule_t& l = stylesheet.mRules[lhs];
+                    const rule_t& r = stylesheet.mRules[rhs];
+
+                    return l.priority != r.priority ? l.priority > r.priority : l.order > r.order;
+                });
+
+                for (uint32_t index : order) {
+                    const typename expression_t::target_t target = stylesheet.mRules[index].pattern->target();
+                    mode_t&                               m      = stylesheet.mModes[stylesheet.mTemplates[stylesheet.mRules[index].target].mode];
+
+                    if (target.local != nullptr) {
+                        names_t& names = target.kind == node_t::attribute_kind ? m.attributes : m.elements;
+
+                        names.emplace(name_t { stylesheet.mNamespaces.intern(view_t(*target.uri)), view_t(*target.local) }, std::vector<uint32_t>());
+                    }
+                }
+
+                for (uint32_t index : order) {
+                    const typename expression_t::target_t target = stylesheet.mRules[index].pattern->target();
+                    mode_t&                               m      = stylesheet.mModes[stylesheet.mTemplates[stylesheet.mRules[index].target].mode];
+
+                    switch (target.kind) {
+                    case node_t::element_kind:
+                    case node_t::attribute_kind: {
+                        const bool element = target.kind == node_t::element_kind;
+                        names_t&   names   = element ? m.elements : m.attributes;
+
+                        if (target.local != nullptr) {
+                            names[name_t { stylesheet.mNamespaces.find(view_t(*target.uri)), view_t(*target.local) }].push_back(index);
+                        } else {
+                            (element ? m.element : m.attribute).push_back(index);
+
+                            for (typename names_t::value_type& entry : names)
+                                entry.second.push_back(index);
+                        }
+
+                        break;
+                    }
+
+                    case node_t::text_kind:
+                        m.texts.push_back(index);
+                        break;
+
+                    case node_t::document_kind:
+                        m.documents.push_back(index);
+                        break;
+
+                    default:
+                        m.element.push_back(index);
+                        m.texts.push_back(index);
+
+                        for (typename names_t::value_type& entry : m.elements)
+                            entry.second.push_back(index);
+
+                        break;
+                    }
+                }
+            }
+
+            //! \brief Find whether the stylesheet is streamable.
+            /*!
+             *  The template of the root is split into the wrappers that hold
+             *  the selection of the records and fixed content, then the
+             *  instructions reached from the selection are checked.
+             */
+            void stream()
+            {
+                const mode_t& m = stylesheet.mModes.front();
+
+                if (m.documents.empty())
+                    return;
+
+                const uint32_t        root = stylesheet.mRules[m.documents.front()].target;
+                std::vector<uint32_t> chain;
+
+                if (!stylesheet.mTemplates[root].params.empty() ||
+                    !std::all_of(stylesheet.mGlobals.begin(), stylesheet.mGlobals.end(), [this](uint32_t global) { return fixed(global); }))
+                    return;
+
+                for (const std::vector<uint32_t>* body = &stylesheet.mTemplates[root].body; body != nullptr;) {
+                    uint32_t link = npos;
+
+                    for (uint32_t index : *body)
+                        if (!fixed(index)) {
+                            if (link != npos)
+                                return;
+
+                            link = index;
+                        }
+
+                    if (link == npos)
+                        return;
+
+                    const instruction_t& i = stylesheet.mInstructions[link];
+
+                    chain.push_back(link);
+                    body = nullptr;
+
+                    if (i.op == op_literal || i.op == op_element) {
+                        if (!constant(i.name) || !constant(i.ns) || !std::all_of(i.attributes.begin(), i.attributes.end(), [](const literal_attribute_t& a) {
+                                return constant(a.value);
+                            }))
+                            return;
+
+                        body = &i.body;
+                    }
+                }
+
+                const instruction_t& i = stylesheet.mInstructions[chain.back()];
+
+                if ((i.op != op_apply && i.op != op_for_each) || !i.select || !i.sorts.empty() ||
+                    !std::all_of(i.params.begin(), i.params.end(), [this](uint32_t param) { return fixed(param); }))
+                    return;
+
+                expression_pointer_t records = i.select;
+
+                if (!records->streamable()) {
+                    typename expression_t::result_t absolute = expression_t::try_compile(view_t(ascii("/") + records->str()), i.bindings);
+
+                    if (!absolute || !absolute.value()->streamable())
+                        return;
+
+                    records = std::move(absolute.value());
+                }
+
+                std::vector<bool> modes(stylesheet.mModes.size(), false);
+                std::vector<bool> templates(stylesheet.mTemplates.size(), false);
+
+                if (i.op == op_for_each ? !local(i.body, modes, templates) : !reach(i.target, modes, templates))
+                    return;
+
+                stylesheet.mChain.swap(chain);
+                stylesheet.mRecords = std::move(records);
+                stylesheet.mRoot    = root;
+            }
+
+            //! \brief Whether an attribute value template is fixed.
+            static bool constant(const avt_t& parts)
+            {
+                return std::all_of(parts.begin(), parts.end(), [](const part_t& part) {
+                    return !part.expression || part.expression->constant();
+                });
+            }
+
+            //! \brief Whether an instruction outputs the same content for any current node.
+            bool fixed(uint32_t index) const
+            {
+                const instruction_t& i = stylesheet.mInstructions[index];
+
+                switch (i.op) {
+                case op_apply:
+                case op_call:
+                case op_for_each:
+                case op_copy:
+                    return false;
+
+                default:
+                    break;
+                }
+
+                if ((i.select && !i.select->constant()) || !constant(i.name) || !constant(i.ns))
+                    return false;
+
+                for (const literal_attribute_t& attribute : i.attributes)
+                    if (!constant(attribute.value))
+                        return false;
+
+                return std::all_of(i.body.begin(), i.body.end(), [this](uint32_t child) { return fixed(child); });
+            }
+
+            //! \brief Whether instructions only read below their current node.
+            /*!
+             *  \param [in,out] modes     The modes already checked.
+             *  \param [in,out] templates The templates already checked.
+             */
+            bool local(const std::vector<uint32_t>& body, std::vector<bool>& modes, std::vector<bool>& templates) const
+            {
+                for (uint32_t index : body) {
+                    const instruction_t& i = stylesheet.mInstructions[index];
+
+                    if ((i.select && !i.select->downward()) || !downward(i.name) || !downward(i.ns))
+                        return false;
+
+                    for (const literal_attribute_t& attribute : i.attributes)
+                        if (!downward(attribute.value))
+                            return false;
+
+                    for (const sort_t& key : i.sorts)
+                        if (!key.select->downward())
+                            return false;
+
+                    if (!local(i.body, modes, templates) || !local(i.params, modes, templates))
+                        return false;
+
+                    if (i.op == op_apply && !reach(i.target, modes, templates))
+                        return false;
+
+                    if (i.op == op_call && !instantiable(i.target, modes, templates))
+                        return false;
+                }
+
+                return true;
+            }
+
+            //! \brief Whether the template rules of a mode only read below the nodes they match.
+            bool reach(uint32_t mode, std::vector<bool>& modes, std::vector<bool>& templates) const
+            {
+                if (modes[mode])
+                    return true;
+
+                modes[mode] = true;
+
+                for (const rule_t& rule : stylesheet.mRules) {
+                    if (stylesheet.mTemplates[rule.target].mode != mode || rule.pattern->target().kind == node_t::document_kind)
+                        continue;
+
+                    if (!rule.pattern->shallow() || !instantiable(rule.target, modes, templates))
+                        return false;
+                }
+
+                return true;
+            }
+
+            //! \brief Whether a template only reads below its current node.
+            bool instantiable(uint32_t index, std::vector<bool>& modes, std::vector<bool>& templates) const
+            {
+                if (templates[index])
+                    return true;
+
+                templates[index] = true;
+
+                return local(stylesheet.mTemplates[index].params, modes, templates) && local(stylesheet.mTemplates[index].body, modes, templates);
+            }
+
+            //! \brief Whether an attribute value template only reads below its current node.
+            static bool downward(const avt_t& parts)
+            {
+                return std::all_of(parts.begin(), parts.end(), [](const part_t& part) {
+                    return !part.expression || part.expression->downward();
+                });
+            }
+
+            stylesheet_t&                             stylesheet; //!< The compiled stylesheet.
+            const document_t&                         source;     //!< The stylesheet document.
+            const namespace_id_t                      xsl;        //!< The XSLT namespace in the table of the document.
+            std::vector<std::pair<string_t, string_t> > scope;    //!< The namespaces in scope.
+            std::unordered_map<string_t, uint32_t>    modes;      //!< The index of each mode, by name.
+            std::unordered_map<string_t, uint32_t>    named;      //!< The index of each named template.
+            std::vector<uint32_t>                     calls;      //!< The \c xsl:call-template instructions.
+            std::unordered_set<string_t>              locals;     //!< The names of the local variables and parameters.
+        };
+
+        //! \brief Constructor.
+        /*!
+         *  Builds an empty stylesheet, filled by \c compiler_t.
+         */
+        basic_stylesheet()
+        :
+            mInstructions(),
+            mTemplates(),
+            mRules(),
+            mModes(),
+            mGlobals(),
+            mShadowed(),
+            mNamespaces(),
+            mOutput(output_t { writer_t::xml_method, false, true }),
+            mChain(),
+            mRecords(),
+            mRoot(npos)
+        {}
+
+        //! \brief Widen an ASCII string.
+        static string_t ascii(const char* str)
+        {
+            string_t result;
+
+            while (*str != '\0')
+                result.push_back(static_cast<charT>(*str++));
+
+            return result;
+        }
+
+        //! \brief Throw an exception.
+        static void fail(const char* what)
+        {
+            throw exception_t(parse_error_t(what, reader_t::no_error, 0), nullptr);
+        }
+
+        std::vector<instruction_t> mInstructions; //!< The instructions of all the templates.
+        std::vector<template_t>    mTemplates;    //!< The templates.
+        std::vector<rule_t>        mRules;        //!< The alternatives of the patterns of the template rules.
+        std::vector<mode_t>        mModes;        //!< The dispatch tables of each mode, the default mode first.
+        std::vector<uint32_t>      mGlobals;      //!< The global variables and parameters, in document order.
+        std::vector<uint32_t>      mShadowed;     //!< The global variables whose name is also used by local ones.
+        table_t                    mNamespaces;   //!< The namespaces of the names matched by the patterns.
+        output_t                   mOutput;       //!< The output settings.
+        std::vector<uint32_t>      mChain;        //!< The instructions of the template of the root leading to the selection of the records, if streamable.
+        expression_pointer_t       mRecords;      //!< The absolute expression selecting the records, if streamable.
+        uint32_t                   mRoot;         //!< The template of the root, if streamable.
+    };
+
+    typedef basic_stylesheet<char>    stylesheet;  //!< A specialized \c basic_stylesheet for char.
+    typedef basic_stylesheet<wchar_t> wstylesheet; //!< A specialized \c basic_stylesheet for wchar_t.
+}
+
+#endif /* XSLT_H_INCLUDED */
@@ -0,0 +1,78 @@
+#include "arena.h"
+
+#include <new>
+#include <algorithm>
+#include <functional>
+
+namespace {
+    //! The alignment of the memory handed out by an arena.
+    const size_t sAlignment = alignof(std::max_align_t);
+}
+
+xml::arena::arena(size_t blockSize)
+:
+    mBlocks(),
+    mBlock(0),
+    mUsed(0),
+    mBlockSize(blockSize)
+{}
+
+xml::arena::~arena()
+{
+    for (const block_t& block : mBlocks)
+        ::operator delete(block.data);
+}
+
+void* xml::arena::allocate(size_t size)
+{
+    size = (size + sAlignment - 1) & ~(sAlignment - 1);
+
+    while (mBlock < mBlocks.size()) {
+        block_t& block = mBlocks[mBlock];
+
+        if (block.size - mUsed >= size) {
+            void* ptr = block.data + mUsed;
+            mUsed += size;
+            return ptr;
+        }
+
+        ++mBlock;
+        mUsed = 0;
+    }
+
+    const size_t blockSize = std::max(size, mBlocks.empty() ? mBlockSize : mBlocks.back().size * 2);
+    const block_t block = { static_cast<char*>(::operator new(blockSize)), blockSize };
+
+    mBlocks.push_back(block);
+    mBlock = mBlocks.size() - 1;
+    mUsed  = size;
+
+    return block.data;
+}
+
+void xml::arena::reset() noexcept
+{
+    mBlock = 0;
+    mUsed  = 0;
+}
+
+bool xml::arena::owns(const void* ptr) const noexcept
+{
+    const char* p = static_cast<const char*>(ptr);
+
+    for (const block_t& block : mBlocks)
+        if (std::less_equal<const char*>()(block.data, p) && std::less<const char*>()(p, block.data + block.size))
+            return true;
+
+    return false;
+}
+
+size_t xml::arena::capacity() const noexcept
+{
+    size_t size = 0;
+
+    for (const block_t& block : mBlocks)
+        size += block.size;
+
+    return size;
+}
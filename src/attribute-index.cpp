@@ -0,0 +1,6 @@
+#include "attribute-index.h"
+
+template class xml::basic_attribute_index<char>;
+template class xml::basic_attribute_index<char16_t>;
+template class xml::basic_attribute_index<char32_t>;
+template class xml::basic_attribute_index<wchar_t>;
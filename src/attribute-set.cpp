@@ -0,0 +1,6 @@
+#include "attribute-set.h"
+
+template class xml::basic_attribute_set<char>;
+template class xml::basic_attribute_set<char16_t>;
+template class xml::basic_attribute_set<char32_t>;
+template class xml::basic_attribute_set<wchar_t>;
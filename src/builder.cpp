@@ -0,0 +1,6 @@
+#include "builder.h"
+
+template class xml::basic_builder<char>;
+template class xml::basic_builder<char16_t>;
+template class xml::basic_builder<char32_t>;
+template class xml::basic_builder<wchar_t>;
\ No newline at end of file
@@ -0,0 +1,6 @@
+#include "dtd.h"
+
+template class xml::basic_dtd<char>;
+template class xml::basic_dtd<char16_t>;
+template class xml::basic_dtd<char32_t>;
+template class xml::basic_dtd<wchar_t>;
\ No newline at end of file
@@ -0,0 +1,6 @@
+#include "entity-decoder.h"
+
+template class xml::basic_entity_decoder<char>;
+template class xml::basic_entity_decoder<char16_t>;
+template class xml::basic_entity_decoder<char32_t>;
+template class xml::basic_entity_decoder<wchar_t>;
\ No newline at end of file
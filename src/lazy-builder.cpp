@@ -0,0 +1,6 @@
+#include "lazy-builder.h"
+
+template class xml::basic_lazy_builder<char>;
+template class xml::basic_lazy_builder<char16_t>;
+template class xml::basic_lazy_builder<char32_t>;
+template class xml::basic_lazy_builder<wchar_t>;
\ No newline at end of file
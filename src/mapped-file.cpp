@@ -0,0 +1,57 @@
+#include "mapped-file.h"
+
+#include <stdexcept>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace {
+    void raise(const std::string& what, const std::string& path)
+    {
+        throw std::runtime_error(what + " " + path + ": " + std::strerror(errno));
+    }
+}
+
+xml::mapped_file::mapped_file(const std::string& path)
+:
+    mData(nullptr),
+    mSize(0)
+{
+    const int fd = ::open(path.c_str(), O_RDONLY);
+
+    if (fd < 0)
+        raise("cannot open", path);
+
+    struct stat status;
+
+    if (::fstat(fd, &status) != 0) {
+        ::close(fd);
+        raise("cannot stat", path);
+    }
+
+    mSize = static_cast<size_t>(status.st_size);
+
+    if (mSize > 0) {
+        mData = ::mmap(nullptr, mSize, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        if (mData == MAP_FAILED) {
+            mData = nullptr;
+            ::close(fd);
+            raise("cannot map", path);
+        }
+
+        ::madvise(mData, mSize, MADV_WILLNEED);
+    }
+
+    ::close(fd);
+}
+
+xml::mapped_file::~mapped_file()
+{
+    if (mData != nullptr)
+        ::munmap(mData, mSize);
+}
\ No newline at end of file
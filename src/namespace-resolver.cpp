@@ -0,0 +1,6 @@
+#include "namespace-resolver.h"
+
+template class xml::basic_namespace_resolver<char>;
+template class xml::basic_namespace_resolver<char16_t>;
+template class xml::basic_namespace_resolver<char32_t>;
+template class xml::basic_namespace_resolver<wchar_t>;
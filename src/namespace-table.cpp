@@ -0,0 +1,11 @@
+#include "namespace-table.h"
+
+template class xml::basic_namespace_table<char>;
+template class xml::basic_namespace_table<char16_t>;
+template class xml::basic_namespace_table<char32_t>;
+template class xml::basic_namespace_table<wchar_t>;
+
+template class xml::basic_namespace_scope<char>;
+template class xml::basic_namespace_scope<char16_t>;
+template class xml::basic_namespace_scope<char32_t>;
+template class xml::basic_namespace_scope<wchar_t>;
\ No newline at end of file
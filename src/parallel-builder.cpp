@@ -0,0 +1,6 @@
+#include "parallel-builder.h"
+
+template class xml::basic_parallel_builder<char>;
+template class xml::basic_parallel_builder<char16_t>;
+template class xml::basic_parallel_builder<char32_t>;
+template class xml::basic_parallel_builder<wchar_t>;
\ No newline at end of file
@@ -0,0 +1,6 @@
+#include "pattern.h"
+
+template class xml::basic_pattern<char>;
+template class xml::basic_pattern<char16_t>;
+template class xml::basic_pattern<char32_t>;
+template class xml::basic_pattern<wchar_t>;
\ No newline at end of file
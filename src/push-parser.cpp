@@ -0,0 +1,6 @@
+#include "push-parser.h"
+
+template class xml::basic_push_parser<char>;
+template class xml::basic_push_parser<char16_t>;
+template class xml::basic_push_parser<char32_t>;
+template class xml::basic_push_parser<wchar_t>;
\ No newline at end of file
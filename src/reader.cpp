@@ -0,0 +1,6 @@
+#include "reader.h"
+
+template class xml::basic_reader<char>;
+template class xml::basic_reader<char16_t>;
+template class xml::basic_reader<char32_t>;
+template class xml::basic_reader<wchar_t>;
\ No newline at end of file
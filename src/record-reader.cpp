@@ -0,0 +1,6 @@
+#include "record-reader.h"
+
+template class xml::basic_record_reader<char>;
+template class xml::basic_record_reader<char16_t>;
+template class xml::basic_record_reader<char32_t>;
+template class xml::basic_record_reader<wchar_t>;
\ No newline at end of file
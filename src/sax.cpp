@@ -0,0 +1,11 @@
+#include "sax.h"
+
+template class xml::basic_sax_handler<char>;
+template class xml::basic_sax_handler<char16_t>;
+template class xml::basic_sax_handler<char32_t>;
+template class xml::basic_sax_handler<wchar_t>;
+
+template class xml::basic_sax_parser<char>;
+template class xml::basic_sax_parser<char16_t>;
+template class xml::basic_sax_parser<char32_t>;
+template class xml::basic_sax_parser<wchar_t>;
\ No newline at end of file
@@ -0,0 +1,6 @@
+#include "scanner.h"
+
+template class xml::basic_scanner<char>;
+template class xml::basic_scanner<char16_t>;
+template class xml::basic_scanner<char32_t>;
+template class xml::basic_scanner<wchar_t>;
\ No newline at end of file
@@ -0,0 +1,11 @@
+#include "schema.h"
+
+template class xml::basic_compiled_schema<char>;
+template class xml::basic_compiled_schema<char16_t>;
+template class xml::basic_compiled_schema<char32_t>;
+template class xml::basic_compiled_schema<wchar_t>;
+
+template class xml::basic_schema_validator<char>;
+template class xml::basic_schema_validator<char16_t>;
+template class xml::basic_schema_validator<char32_t>;
+template class xml::basic_schema_validator<wchar_t>;
\ No newline at end of file
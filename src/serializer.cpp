@@ -0,0 +1,6 @@
+#include "serializer.h"
+
+template class xml::basic_serializer<char>;
+template class xml::basic_serializer<char16_t>;
+template class xml::basic_serializer<char32_t>;
+template class xml::basic_serializer<wchar_t>;
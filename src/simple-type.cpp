@@ -0,0 +1,6 @@
+#include "simple-type.h"
+
+template class xml::basic_simple_type<char>;
+template class xml::basic_simple_type<char16_t>;
+template class xml::basic_simple_type<char32_t>;
+template class xml::basic_simple_type<wchar_t>;
\ No newline at end of file
@@ -0,0 +1,6 @@
+#include "stream-validator.h"
+
+template class xml::basic_stream_validator<char>;
+template class xml::basic_stream_validator<char16_t>;
+template class xml::basic_stream_validator<char32_t>;
+template class xml::basic_stream_validator<wchar_t>;
\ No newline at end of file
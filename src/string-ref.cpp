@@ -0,0 +1,6 @@
+#include "string-ref.h"
+
+template class xml::basic_string_ref<char>;
+template class xml::basic_string_ref<char16_t>;
+template class xml::basic_string_ref<char32_t>;
+template class xml::basic_string_ref<wchar_t>;
\ No newline at end of file
@@ -0,0 +1,6 @@
+#include "string-view.h"
+
+template class xml::basic_string_view<char>;
+template class xml::basic_string_view<char16_t>;
+template class xml::basic_string_view<char32_t>;
+template class xml::basic_string_view<wchar_t>;
\ No newline at end of file
@@ -0,0 +1,6 @@
+#include "structural-index.h"
+
+template class xml::basic_structural_index<char>;
+template class xml::basic_structural_index<char16_t>;
+template class xml::basic_structural_index<char32_t>;
+template class xml::basic_structural_index<wchar_t>;
\ No newline at end of file
@@ -0,0 +1,6 @@
+#include "typed-string.h"
+
+template class xml::basic_typed_string<char>;
+template class xml::basic_typed_string<char16_t>;
+template class xml::basic_typed_string<char32_t>;
+template class xml::basic_typed_string<wchar_t>;
\ No newline at end of file
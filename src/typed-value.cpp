@@ -0,0 +1,69 @@
+#include "typed-value.h"
+
+namespace {
+    //! The number of microseconds in a minute.
+    const int64_t sMinute = int64_t(60) * 1000000;
+
+    //! The number of microseconds in a day.
+    const int64_t sDay = 24 * 60 * sMinute;
+
+    //! \brief Get the number of days from 1970-01-01 to a date of the proleptic Gregorian calendar.
+    int64_t daysFromCivil(int64_t year, unsigned month, unsigned day)
+    {
+        year -= month <= 2;
+
+        const int64_t  era       = (year >= 0 ? year : year - 399) / 400;
+        const unsigned yearOfEra = static_cast<unsigned>(year - era * 400);
+        const unsigned dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+        const unsigned dayOfEra  = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+
+        return era * 146097 + static_cast<int64_t>(dayOfEra) - 719468;
+    }
+}
+
+xml::typed_value xml::typed_value::from_boolean(bool value)
+{
+    typed_value typed;
+
+    typed.mType    = boolean_type;
+    typed.mInteger = value ? 1 : 0;
+
+    return typed;
+}
+
+xml::typed_value xml::typed_value::from_integer(int64_t value)
+{
+    typed_value typed;
+
+    typed.mType    = integer_type;
+    typed.mInteger = value;
+
+    return typed;
+}
+
+xml::typed_value xml::typed_value::from_number(type_t type, double value)
+{
+    typed_value typed;
+
+    typed.mType   = type;
+    typed.mNumber = value;
+
+    return typed;
+}
+
+xml::typed_value xml::typed_value::from_time(type_t type, int64_t year, unsigned month, unsigned day,
+                                             unsigned hour, unsigned minute, int64_t microsecond,
+                                             bool timezone, int offset)
+{
+    typed_value typed;
+
+    typed.mType     = type;
+    typed.mTimezone = timezone;
+    typed.mInteger  = (type == time_type ? 0 : daysFromCivil(year, month, day) * sDay) +
+                      (int64_t(hour) * 60 + minute - (timezone ? offset : 0)) * sMinute + microsecond;
+
+    if (type == time_type)
+        typed.mInteger = (typed.mInteger % sDay + sDay) % sDay;
+
+    return typed;
+}
@@ -0,0 +1,1360 @@
+#include "utf8.h"
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// The lookup validator and the transcoding kernels are built for the target
+// when it has AVX2. Otherwise, with GCC or Clang, they are built for AVX2 and
+// for SSSE3, and the versions matching the processor are selected at run time.
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define UTF8_LOOKUP
+#define UTF8_TARGET(isa)
+#elif defined(__SSE2__) && defined(__GNUC__)
+#include <immintrin.h>
+#define UTF8_LOOKUP
+#define UTF8_DISPATCH
+#define UTF8_TARGET(isa) __attribute__((target(isa)))
+#endif
+
+// The helpers of the kernels are inlined in them, so that they are built for
+// the target of each kernel.
+#if defined(__GNUC__)
+#define UTF8_INLINE inline __attribute__((always_inline))
+#else
+#define UTF8_INLINE inline
+#endif
+
+namespace {
+    typedef const unsigned char* bytes_t; //!< Pointer to constant bytes.
+
+    //! \brief Check sequences one at a time.
+    /*!
+     *  \param [in] first A pointer to the first byte of a sequence.
+     *  \param [in] stop  A pointer past the last sequence to check.
+     *  \param [in] last  A pointer past the last byte of the buffer.
+     *
+     *  \return A pointer to the first invalid sequence, or a pointer past
+     *          the last sequence starting before \c stop.
+     */
+    bytes_t validateSequences(bytes_t first, bytes_t stop, bytes_t last)
+    {
+        while (first < stop) {
+            const unsigned char c = *first;
+
+            if (c < 0x80) {
+                ++first;
+                continue;
+            }
+
+            unsigned char low  = 0x80;
+            unsigned char high = 0xBF;
+            ptrdiff_t     size = 0;
+
+            if (c < 0xC2) {
+                return first;
+            } else if (c < 0xE0) {
+                size = 2;
+            } else if (c < 0xF0) {
+                size = 3;
+                low  = c == 0xE0 ? 0xA0 : low;
+                high = c == 0xED ? 0x9F : high;
+            } else if (c < 0xF5) {
+                size = 4;
+                low  = c == 0xF0 ? 0x90 : low;
+                high = c == 0xF4 ? 0x8F : high;
+            } else {
+                return first;
+            }
+
+            if (last - first < size || first[1] < low || first[1] > high)
+                return first;
+
+            for (ptrdiff_t i = 2; i < size; ++i)
+                if ((first[i] & 0xC0) != 0x80)
+                    return first;
+
+            first += size;
+        }
+
+        return first;
+    }
+
+#if defined(__SSE2__)
+    //! \brief Widen 16 ASCII bytes to UTF-16 or UTF-32 characters.
+    /*!
+     *  \param [in]  bytes The bytes to widen.
+     *  \param [out] out   A pointer to the first character of the output.
+     */
+    template <typename unitT>
+    UTF8_INLINE void widen(__m128i bytes, unitT* out)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i low  = _mm_unpacklo_epi8(bytes, zero);
+        const __m128i high = _mm_unpackhi_epi8(bytes, zero);
+
+        __m128i* units = reinterpret_cast<__m128i*>(out);
+
+        if (sizeof(unitT) == 2) {
+            _mm_storeu_si128(units,     low);
+            _mm_storeu_si128(units + 1, high);
+        } else {
+            _mm_storeu_si128(units,     _mm_unpacklo_epi16(low,  zero));
+            _mm_storeu_si128(units + 1, _mm_unpackhi_epi16(low,  zero));
+            _mm_storeu_si128(units + 2, _mm_unpacklo_epi16(high, zero));
+            _mm_storeu_si128(units + 3, _mm_unpackhi_epi16(high, zero));
+        }
+    }
+
+    //! \brief Narrow 16 UTF-16 or UTF-32 characters to ASCII bytes.
+    /*!
+     *  \param [in]  first A pointer to the first character to narrow.
+     *  \param [out] out   A pointer to the first byte of the output.
+     *
+     *  \return \c false if one of the characters is not ASCII, in which
+     *          case nothing is written.
+     */
+    template <typename unitT>
+    bool narrow(const unitT* first, char* out)
+    {
+        const __m128i* units = reinterpret_cast<const __m128i*>(first);
+        __m128i bytes;
+
+        if (sizeof(unitT) == 2) {
+            const __m128i a = _mm_loadu_si128(units);
+            const __m128i b = _mm_loadu_si128(units + 1);
+            const __m128i ascii = _mm_and_si128(_mm_or_si128(a, b), _mm_set1_epi16(static_cast<short>(0xFF80)));
+
+            if (_mm_movemask_epi8(_mm_cmpeq_epi8(ascii, _mm_setzero_si128())) != 0xFFFF)
+                return false;
+
+            bytes = _mm_packus_epi16(a, b);
+        } else {
+            const __m128i a = _mm_loadu_si128(units);
+            const __m128i b = _mm_loadu_si128(units + 1);
+            const __m128i c = _mm_loadu_si128(units + 2);
+            const __m128i d = _mm_loadu_si128(units + 3);
+            const __m128i ascii = _mm_and_si128(_mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d)), _mm_set1_epi32(static_cast<int>(0xFFFFFF80)));
+
+            if (_mm_movemask_epi8(_mm_cmpeq_epi8(ascii, _mm_setzero_si128())) != 0xFFFF)
+                return false;
+
+            bytes = _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+        }
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), bytes);
+
+        return true;
+    }
+#endif
+
+    //! \brief Convert a sequence of valid UTF-8 to UTF-16 or UTF-32.
+    /*!
+     *  \param [in,out] first A pointer to the first byte of the sequence,
+     *                        moved past its last byte.
+     *  \param [in,out] out   A pointer to the first character of the output,
+     *                        moved past the last character written.
+     */
+    template <typename unitT>
+    void decodeSequence(bytes_t& first, unitT*& out)
+    {
+        const uint32_t c = *first;
+
+        if (c < 0x80) {
+            *out++ = static_cast<unitT>(c);
+            first += 1;
+        } else if (c < 0xE0) {
+            *out++ = static_cast<unitT>((c & 0x1F) << 6 | (first[1] & 0x3F));
+            first += 2;
+        } else if (c < 0xF0) {
+            *out++ = static_cast<unitT>((c & 0x0F) << 12 | (first[1] & 0x3F) << 6 | (first[2] & 0x3F));
+            first += 3;
+        } else {
+            const uint32_t code = (c & 0x07) << 18 | (first[1] & 0x3F) << 12 | (first[2] & 0x3F) << 6 | (first[3] & 0x3F);
+
+            if (sizeof(unitT) == 2) {
+                *out++ = static_cast<unitT>(0xD800 + ((code - 0x10000) >> 10));
+                *out++ = static_cast<unitT>(0xDC00 + (code & 0x3FF));
+            } else {
+                *out++ = static_cast<unitT>(code);
+            }
+
+            first += 4;
+        }
+    }
+
+    //! \brief Convert a UTF-16 or UTF-32 character to UTF-8.
+    /*!
+     *  \param [in,out] first A pointer to the character, moved past it, or
+     *                        past both characters of a surrogate pair.
+     *  \param [in]     last  A pointer past the last character of the input.
+     *  \param [in,out] out   A pointer to the first byte of the output, moved
+     *                        past the last byte written.
+     */
+    template <typename unitT>
+    void encodeCharacter(const unitT*& first, const unitT* last, char*& out)
+    {
+        uint32_t code = static_cast<uint32_t>(*first++);
+
+        if (code < 0x80) {
+            *out++ = static_cast<char>(code);
+            return;
+        }
+
+        if (code >= 0xD800 && code <= 0xDFFF) {
+            const uint32_t next = first != last ? static_cast<uint32_t>(*first) : 0;
+
+            if (sizeof(unitT) == 2 && code < 0xDC00 && next >= 0xDC00 && next <= 0xDFFF) {
+                code = 0x10000 + ((code - 0xD800) << 10) + (next - 0xDC00);
+                ++first;
+            } else {
+                code = 0xFFFD;
+            }
+        } else if (code > 0x10FFFF) {
+            code = 0xFFFD;
+        }
+
+        if (code < 0x800) {
+            *out++ = static_cast<char>(0xC0 | code >> 6);
+        } else if (code < 0x10000) {
+            *out++ = static_cast<char>(0xE0 | code >> 12);
+            *out++ = static_cast<char>(0x80 | (code >> 6 & 0x3F));
+        } else {
+            *out++ = static_cast<char>(0xF0 | code >> 18);
+            *out++ = static_cast<char>(0x80 | (code >> 12 & 0x3F));
+            *out++ = static_cast<char>(0x80 | (code >> 6 & 0x3F));
+        }
+
+        *out++ = static_cast<char>(0x80 | (code & 0x3F));
+    }
+
+#if defined(UTF8_LOOKUP)
+    //! \name Errors found by the lookup tables
+    //!@{
+    const unsigned char TOO_SHORT      = 1 << 0; //!< A leading byte is followed by another leading byte or ASCII.
+    const unsigned char TOO_LONG       = 1 << 1; //!< ASCII is followed by a continuation byte.
+    const unsigned char OVERLONG_3     = 1 << 2; //!< A 3 bytes sequence encodes a code point below U+0800.
+    const unsigned char TOO_LARGE      = 1 << 3; //!< A 4 bytes sequence encodes a code point above U+10FFFF.
+    const unsigned char SURROGATE      = 1 << 4; //!< A 3 bytes sequence encodes a surrogate.
+    const unsigned char OVERLONG_2     = 1 << 5; //!< A 2 bytes sequence encodes a code point below U+0080.
+    const unsigned char TOO_LARGE_1000 = 1 << 6; //!< A 4 bytes sequence starts above 0xF4.
+    const unsigned char OVERLONG_4     = 1 << 6; //!< A 4 bytes sequence encodes a code point below U+10000.
+    const unsigned char TWO_CONTS      = 1 << 7; //!< Two continuation bytes follow each other.
+    const unsigned char CARRY          = TOO_SHORT | TOO_LONG | TWO_CONTS; //!< The errors that do not depend on the low nibble.
+
+    //!@}
+
+    //! The errors indexed by the high nibble of the first byte of a pair.
+    const unsigned char sFirstHigh[16] = {
+        TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+        TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+        TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS,
+        TOO_SHORT | OVERLONG_2,
+        TOO_SHORT,
+        TOO_SHORT | OVERLONG_3 | SURROGATE,
+        TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4
+    };
+
+    //! The errors indexed by the low nibble of the first byte of a pair.
+    const unsigned char sFirstLow[16] = {
+        CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4,
+        CARRY | OVERLONG_2,
+        CARRY,
+        CARRY,
+        CARRY | TOO_LARGE,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000
+    };
+
+    //! The errors indexed by the high nibble of the second byte of a pair.
+    const unsigned char sSecondHigh[16] = {
+        TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+        TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+        TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4,
+        TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE,
+        TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+        TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+        TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT
+    };
+
+    //! The largest value of each of the last bytes of a block that does not start a truncated sequence.
+    const unsigned char sLastBytes[32] = {
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xEF, 0xDF, 0xBF
+    };
+
+    //! \brief Find where to check sequences one at a time after the lookup validator stopped.
+    /*!
+     *  \param [in] first  A pointer to the first byte of the buffer.
+     *  \param [in] cursor A pointer to the block the validator stopped at.
+     *
+     *  \return A pointer to the last leading byte of the previous block if
+     *          its sequence may reach \c cursor, \c cursor otherwise.
+     */
+    bytes_t resume(bytes_t first, bytes_t cursor)
+    {
+        for (bytes_t lead = cursor; lead != first && cursor - lead < 3; ) {
+            if ((*--lead & 0xC0) != 0x80)
+                return (*lead & 0x80) != 0 ? lead : cursor;
+        }
+
+        return cursor;
+    }
+
+    //! \brief Load a lookup table in both lanes of a register.
+    UTF8_TARGET("avx2") __m256i table(const unsigned char* values)
+    {
+        return _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(values)));
+    }
+
+    //! \brief Get the high nibble of each byte.
+    UTF8_TARGET("avx2") __m256i high(__m256i bytes)
+    {
+        return _mm256_and_si256(_mm256_srli_epi16(bytes, 4), _mm256_set1_epi8(0x0F));
+    }
+
+    //! \brief Shift a block by \c N bytes, taking the first bytes from the previous block.
+    template <int N>
+    UTF8_TARGET("avx2") __m256i shift(__m256i block, __m256i previous)
+    {
+        return _mm256_alignr_epi8(block, _mm256_permute2x128_si256(previous, block, 0x21), 16 - N);
+    }
+
+    //! \brief Find the errors of a block of 32 bytes.
+    /*!
+     *  \param [in] block    The block to check.
+     *  \param [in] previous The previous block.
+     *
+     *  \return A non-zero byte for each error.
+     */
+    UTF8_TARGET("avx2") __m256i check(__m256i block, __m256i previous)
+    {
+        const __m256i prev1 = shift<1>(block, previous);
+
+        const __m256i special = _mm256_and_si256(
+            _mm256_and_si256(
+                _mm256_shuffle_epi8(table(sFirstHigh), high(prev1)),
+                _mm256_shuffle_epi8(table(sFirstLow), _mm256_and_si256(prev1, _mm256_set1_epi8(0x0F)))),
+            _mm256_shuffle_epi8(table(sSecondHigh), high(block)));
+
+        const __m256i third  = _mm256_subs_epu8(shift<2>(block, previous), _mm256_set1_epi8(static_cast<char>(0xE0 - 0x80)));
+        const __m256i fourth = _mm256_subs_epu8(shift<3>(block, previous), _mm256_set1_epi8(static_cast<char>(0xF0 - 0x80)));
+
+        const __m256i continuation = _mm256_and_si256(_mm256_or_si256(third, fourth), _mm256_set1_epi8(static_cast<char>(0x80)));
+
+        return _mm256_xor_si256(continuation, special);
+    }
+
+    //! \brief Check blocks of 64 bytes with AVX2.
+    /*!
+     *  \param [in] first A pointer to the first byte of the buffer.
+     *  \param [in] last  A pointer past the last byte of the buffer.
+     *
+     *  \return A pointer to the first sequence to check one at a time.
+     */
+    UTF8_TARGET("avx2") bytes_t validateAvx2(bytes_t first, bytes_t last)
+    {
+        const __m256i lastBytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(sLastBytes));
+
+        __m256i previous  = _mm256_setzero_si256();
+        __m256i truncated = _mm256_setzero_si256();
+        __m256i error     = _mm256_setzero_si256();
+
+        bytes_t cursor = first;
+
+        while (last - cursor >= 64) {
+            const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(cursor));
+            const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(cursor + 32));
+
+            if (_mm256_movemask_epi8(_mm256_or_si256(a, b)) == 0) {
+                error     = truncated;
+                truncated = _mm256_setzero_si256();
+            } else {
+                error     = _mm256_or_si256(check(a, previous), check(b, a));
+                truncated = _mm256_subs_epu8(b, lastBytes);
+            }
+
+            if (!_mm256_testz_si256(error, error))
+                break;
+
+            previous = b;
+            cursor  += 64;
+        }
+
+        return resume(first, cursor);
+    }
+
+#if defined(UTF8_DISPATCH)
+    //! \brief Get the high nibble of each byte.
+    UTF8_TARGET("ssse3") __m128i high(__m128i bytes)
+    {
+        return _mm_and_si128(_mm_srli_epi16(bytes, 4), _mm_set1_epi8(0x0F));
+    }
+
+    //! \brief Find the errors of a block of 16 bytes.
+    /*!
+     *  \param [in] block    The block to check.
+     *  \param [in] previous The previous block.
+     *
+     *  \return A non-zero byte for each error.
+     */
+    UTF8_TARGET("ssse3") __m128i check(__m128i block, __m128i previous)
+    {
+        const __m128i prev1 = _mm_alignr_epi8(block, previous, 15);
+
+        const __m128i special = _mm_and_si128(
+            _mm_and_si128(
+                _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(sFirstHigh)), high(prev1)),
+                _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(sFirstLow)), _mm_and_si128(prev1, _mm_set1_epi8(0x0F)))),
+            _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(sSecondHigh)), high(block)));
+
+        const __m128i third  = _mm_subs_epu8(_mm_alignr_epi8(block, previous, 14), _mm_set1_epi8(static_cast<char>(0xE0 - 0x80)));
+        const __m128i fourth = _mm_subs_epu8(_mm_alignr_epi8(block, previous, 13), _mm_set1_epi8(static_cast<char>(0xF0 - 0x80)));
+
+        const __m128i continuation = _mm_and_si128(_mm_or_si128(third, fourth), _mm_set1_epi8(static_cast<char>(0x80)));
+
+        return _mm_xor_si128(continuation, special);
+    }
+
+    //! \brief Check blocks of 32 bytes with SSSE3.
+    /*!
+     *  \param [in] first A pointer to the first byte of the buffer.
+     *  \param [in] last  A pointer past the last byte of the buffer.
+     *
+     *  \return A pointer to the first sequence to check one at a time.
+     */
+    UTF8_TARGET("ssse3") bytes_t validateSsse3(bytes_t first, bytes_t last)
+    {
+        const __m128i lastBytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(sLastBytes + 16));
+        const __m128i zero      = _mm_setzero_si128();
+
+        __m128i previous  = zero;
+        __m128i truncated = zero;
+        __m128i error     = zero;
+
+        bytes_t cursor = first;
+
+        while (last - cursor >= 32) {
+            const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cursor));
+            const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cursor + 16));
+
+            if (_mm_movemask_epi8(_mm_or_si128(a, b)) == 0) {
+                error     = truncated;
+                truncated = zero;
+            } else {
+                error     = _mm_or_si128(check(a, previous), check(b, a));
+                truncated = _mm_subs_epu8(b, lastBytes);
+            }
+
+            if (_mm_movemask_epi8(_mm_cmpeq_epi8(error, zero)) != 0xFFFF)
+                break;
+
+            previous = b;
+            cursor  += 32;
+        }
+
+        return resume(first, cursor);
+    }
+#endif
+#endif
+
+#if defined(__SSE2__) && !defined(__AVX2__)
+    //! \brief Skip blocks of 32 ASCII bytes with SSE2.
+    /*!
+     *  The other blocks are checked one sequence at a time.
+     *
+     *  \param [in] first A pointer to the first byte of the buffer.
+     *  \param [in] last  A pointer past the last byte of the buffer.
+     *
+     *  \return A pointer to the first invalid sequence, or to the first
+     *          sequence to check one at a time.
+     */
+    bytes_t validateSse2(bytes_t first, bytes_t last)
+    {
+        bytes_t cursor = first;
+
+        while (last - cursor >= 32) {
+            const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cursor));
+            const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cursor + 16));
+
+            if (_mm_movemask_epi8(_mm_or_si128(a, b)) == 0) {
+                cursor += 32;
+                continue;
+            }
+
+            bytes_t stop = cursor + 32;
+
+            cursor = validateSequences(cursor, stop, last);
+
+            if (cursor < stop)
+                break;
+        }
+
+        return cursor;
+    }
+#endif
+
+#if defined(UTF8_LOOKUP)
+    //! \brief The shuffles gathering the characters converted by the kernels.
+    struct shuffles_t {
+        unsigned char decode[256][16]; //!< Keep the 16-bit lanes whose bit is not set in the index.
+        unsigned char count[256];      //!< The number of lanes kept by each shuffle of \c decode.
+        unsigned char encode[256][16]; //!< Keep the first bytes of the 32-bit lanes, the index holding 2 bits per lane for their number minus one.
+        unsigned char length[256];     //!< The number of bytes kept by each shuffle of \c encode.
+        unsigned char twos[256][16];   //!< Keep the first byte of the 16-bit lanes, and the second one of those whose bit is set in the index.
+        unsigned char bytes[256];      //!< The number of bytes kept by each shuffle of \c twos.
+
+        //! \brief Build the shuffles.
+        shuffles_t()
+        {
+            for (unsigned index = 0; index != 256; ++index) {
+                unsigned char kept = 0;
+
+                for (unsigned lane = 0; lane != 8; ++lane) {
+                    if ((index >> lane & 1) == 0) {
+                        decode[index][kept++] = static_cast<unsigned char>(2 * lane);
+                        decode[index][kept++] = static_cast<unsigned char>(2 * lane + 1);
+                    }
+                }
+
+                std::memset(decode[index] + kept, 0x80, 16 - kept);
+
+                count[index] = kept / 2;
+                kept         = 0;
+
+                for (unsigned lane = 0; lane != 4; ++lane)
+                    for (unsigned byte = 0; byte <= (index >> 2 * lane & 3); ++byte)
+                        encode[index][kept++] = static_cast<unsigned char>(4 * lane + byte);
+
+                std::memset(encode[index] + kept, 0x80, 16 - kept);
+
+                length[index] = kept;
+                kept          = 0;
+
+                for (unsigned lane = 0; lane != 8; ++lane) {
+                    twos[index][kept++] = static_cast<unsigned char>(2 * lane);
+
+                    if ((index >> lane & 1) != 0)
+                        twos[index][kept++] = static_cast<unsigned char>(2 * lane + 1);
+                }
+
+                std::memset(twos[index] + kept, 0x80, 16 - kept);
+
+                bytes[index] = kept;
+            }
+        }
+    };
+
+    const shuffles_t sShuffles; //!< The shuffles of the kernels.
+
+    //! \brief Load a shuffle.
+    UTF8_INLINE __m128i shuffle(const unsigned char* values)
+    {
+        return _mm_loadu_si128(reinterpret_cast<const __m128i*>(values));
+    }
+
+    //! \brief Blend the lanes of \c a where \c mask is set, and those of \c b elsewhere.
+    UTF8_INLINE __m128i blend(__m128i mask, __m128i a, __m128i b)
+    {
+        return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+    }
+
+    //! \brief Store 8 characters of 16 bits as UTF-16 or UTF-32 characters.
+    /*!
+     *  \param [in]  units The characters.
+     *  \param [out] out   A pointer to the first character of the output.
+     */
+    template <typename unitT>
+    UTF8_INLINE void storeUnits(__m128i units, unitT* out)
+    {
+        __m128i* output = reinterpret_cast<__m128i*>(out);
+
+        if (sizeof(unitT) == 2) {
+            _mm_storeu_si128(output, units);
+        } else {
+            _mm_storeu_si128(output,     _mm_unpacklo_epi16(units, _mm_setzero_si128()));
+            _mm_storeu_si128(output + 1, _mm_unpackhi_epi16(units, _mm_setzero_si128()));
+        }
+    }
+
+    //! \brief Check whether a block of 16 bytes holds a leading byte of a 4 bytes sequence.
+    UTF8_INLINE bool hasLongSequence(__m128i bytes)
+    {
+        const __m128i lead = _mm_set1_epi8(static_cast<char>(0xF0));
+
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(bytes, lead), bytes)) != 0;
+    }
+
+    //! \brief Write 8 ASCII characters of 16 bits.
+    /*!
+     *  \param [in]  units The characters.
+     *  \param [out] out   A pointer to the first byte of the output.
+     *
+     *  \return \c false if one of the characters is not ASCII, in which
+     *          case nothing is written.
+     */
+    UTF8_INLINE bool narrowUnits(__m128i units, char* out)
+    {
+        const __m128i ascii = _mm_and_si128(units, _mm_set1_epi16(static_cast<short>(0xFF80)));
+
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(ascii, _mm_setzero_si128())) != 0xFFFF)
+            return false;
+
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(out), _mm_packus_epi16(units, units));
+
+        return true;
+    }
+
+    //! \brief Compute the characters of the sequences starting in the first 8 bytes of a block.
+    /*!
+     *  \param [in] block The block, without 4 bytes sequences.
+     *
+     *  \return The character of each sequence, in the 16-bit lane of its
+     *          leading byte.
+     */
+    UTF8_INLINE __m128i decodeLanes(__m128i block)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i bits = _mm_set1_epi16(0x3F);
+
+        const __m128i lead   = _mm_unpacklo_epi8(block, zero);
+        const __m128i second = _mm_and_si128(_mm_unpacklo_epi8(_mm_srli_si128(block, 1), zero), bits);
+        const __m128i third  = _mm_and_si128(_mm_unpacklo_epi8(_mm_srli_si128(block, 2), zero), bits);
+
+        const __m128i two   = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(lead, _mm_set1_epi16(0x1F)), 6), second);
+        const __m128i three = _mm_or_si128(_mm_or_si128(_mm_slli_epi16(lead, 12), _mm_slli_epi16(second, 6)), third);
+
+        const __m128i units = blend(_mm_cmpgt_epi16(lead, _mm_set1_epi16(0xBF)), two, lead);
+
+        return blend(_mm_cmpgt_epi16(lead, _mm_set1_epi16(0xDF)), three, units);
+    }
+
+    //! \brief Write 8 characters of 16 bits below U+0800.
+    /*!
+     *  Each character is encoded in its 16-bit lane, and a shuffle drops
+     *  the second byte of the ASCII ones.
+     *
+     *  \param [in]     units The characters.
+     *  \param [in,out] out   A pointer to the first byte of the output,
+     *                        moved past the last byte written.
+     *
+     *  \return \c false if one of the characters is above U+07FF, in
+     *          which case nothing is written.
+     */
+    UTF8_TARGET("ssse3") UTF8_INLINE bool encodeShort(__m128i units, char*& out)
+    {
+        const __m128i zero = _mm_setzero_si128();
+
+        if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(units, _mm_set1_epi16(static_cast<short>(0xF800))), zero)) != 0xFFFF)
+            return false;
+
+        const __m128i  ascii = _mm_cmpeq_epi16(_mm_and_si128(units, _mm_set1_epi16(static_cast<short>(0xFF80))), zero);
+        const unsigned index = ~_mm_movemask_epi8(_mm_packs_epi16(ascii, zero)) & 0xFF;
+
+        const __m128i two = _mm_or_si128(
+            _mm_or_si128(_mm_set1_epi16(0xC0), _mm_srli_epi16(units, 6)),
+            _mm_slli_epi16(_mm_or_si128(_mm_set1_epi16(0x80), _mm_and_si128(units, _mm_set1_epi16(0x3F))), 8));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_shuffle_epi8(blend(ascii, units, two), shuffle(sShuffles.twos[index])));
+        out += sShuffles.bytes[index];
+
+        return true;
+    }
+
+    //! \brief Pack the lengths minus one of the sequences of 4 lanes in the index of an encode shuffle.
+    UTF8_INLINE unsigned encodeIndex(__m128i lengths)
+    {
+        const __m128i  packed = _mm_packus_epi16(_mm_packs_epi32(lengths, lengths), _mm_setzero_si128());
+        const uint32_t bytes  = static_cast<uint32_t>(_mm_cvtsi128_si32(packed));
+
+        return (bytes | bytes >> 6 | bytes >> 12 | bytes >> 18) & 0xFF;
+    }
+
+    //! \brief 8 UTF-16 characters, with the surrogate pairs they belong to.
+    struct surrogates_t {
+        __m128i code;   //!< The characters, U+FFFD for the unpaired surrogates.
+        __m128i lead;   //!< The first character of the pair of each lane.
+        __m128i trail;  //!< The second character of the pair of each lane.
+        __m128i first;  //!< The lanes holding the first character of a pair.
+        __m128i second; //!< The lanes holding the second character of a pair.
+    };
+
+    //! \brief Pair the surrogates of 8 UTF-16 characters.
+    /*!
+     *  \param [in] units The characters.
+     *  \param [in] first A pointer to the first character.
+     *  \param [in] begin A pointer to the first character of the input.
+     *  \param [in] last  A pointer past the last character of the input.
+     *
+     *  \return The characters, paired with their neighbours.
+     */
+    template <typename unitT>
+    UTF8_INLINE surrogates_t pairSurrogates(__m128i units, const unitT* first, const unitT* begin, const unitT* last)
+    {
+        const __m128i previous = _mm_insert_epi16(_mm_slli_si128(units, 2), first != begin ? first[-1] : 0, 0);
+        const __m128i next     = _mm_insert_epi16(_mm_srli_si128(units, 2), last - first > 8 ? first[8] : 0, 7);
+        const __m128i mask     = _mm_set1_epi16(static_cast<short>(0xFC00));
+        const __m128i high     = _mm_set1_epi16(static_cast<short>(0xD800));
+        const __m128i low      = _mm_set1_epi16(static_cast<short>(0xDC00));
+
+        surrogates_t result;
+
+        result.first  = _mm_and_si128(_mm_cmpeq_epi16(_mm_and_si128(units, mask), high), _mm_cmpeq_epi16(_mm_and_si128(next, mask), low));
+        result.second = _mm_and_si128(_mm_cmpeq_epi16(_mm_and_si128(units, mask), low), _mm_cmpeq_epi16(_mm_and_si128(previous, mask), high));
+        result.lead   = blend(result.first, units, previous);
+        result.trail  = blend(result.first, next, units);
+
+        const __m128i surrogate = _mm_cmpeq_epi16(_mm_and_si128(units, _mm_set1_epi16(static_cast<short>(0xF800))), high);
+        const __m128i unpaired  = _mm_andnot_si128(_mm_or_si128(result.first, result.second), surrogate);
+
+        result.code = blend(unpaired, _mm_set1_epi16(static_cast<short>(0xFFFD)), units);
+
+        return result;
+    }
+
+    const int SURROGATE_OFFSET = 0x10000 - (0xD800 << 10) - 0xDC00; //!< Added to the first character of a pair shifted by 10 bits and the second one.
+
+    //! \brief Convert UTF-8 with AVX2.
+    /*!
+     *  \param [in,out] first A pointer to the first byte of the input,
+     *                        moved to the first sequence left to convert.
+     *  \param [in]     last  A pointer past the last byte of the input.
+     *  \param [in,out] out   A pointer to the first character of the
+     *                        output, moved past the last character written.
+     *
+     *  \sa decodeSsse3()
+     */
+    template <typename unitT>
+    UTF8_TARGET("avx2") void decodeAvx2(bytes_t& first, bytes_t last, unitT*& out)
+    {
+        while (last - first >= 18) {
+            const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+
+            if (_mm_movemask_epi8(bytes) == 0) {
+                widen(bytes, out);
+
+                first += 16;
+                out   += 16;
+                continue;
+            }
+
+            if (hasLongSequence(bytes)) {
+                for (bytes_t stop = first + 16; first < stop; )
+                    decodeSequence(first, out);
+
+                continue;
+            }
+
+            const unsigned continuations = _mm_movemask_epi8(_mm_cmplt_epi8(bytes, _mm_set1_epi8(static_cast<char>(0xC0))));
+            const unsigned low           = continuations & 0xFF;
+            const unsigned high          = continuations >> 8;
+
+            const __m256i lead   = _mm256_cvtepu8_epi16(bytes);
+            const __m256i second = _mm256_and_si256(_mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(first + 1))), _mm256_set1_epi16(0x3F));
+            const __m256i third  = _mm256_and_si256(_mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(first + 2))), _mm256_set1_epi16(0x3F));
+
+            const __m256i two   = _mm256_or_si256(_mm256_slli_epi16(_mm256_and_si256(lead, _mm256_set1_epi16(0x1F)), 6), second);
+            const __m256i three = _mm256_or_si256(_mm256_or_si256(_mm256_slli_epi16(lead, 12), _mm256_slli_epi16(second, 6)), third);
+
+            __m256i units = _mm256_blendv_epi8(lead, two, _mm256_cmpgt_epi16(lead, _mm256_set1_epi16(0xBF)));
+
+            units = _mm256_blendv_epi8(units, three, _mm256_cmpgt_epi16(lead, _mm256_set1_epi16(0xDF)));
+
+            storeUnits(_mm_shuffle_epi8(_mm256_castsi256_si128(units), shuffle(sShuffles.decode[low])), out);
+            out += sShuffles.count[low];
+            storeUnits(_mm_shuffle_epi8(_mm256_extracti128_si256(units, 1), shuffle(sShuffles.decode[high])), out);
+            out += sShuffles.count[high];
+
+            // The sequences starting in the last positions may end in the
+            // 2 next bytes.
+            const bool longer = (first[16] & 0xC0) == 0x80;
+
+            first += 16 + longer + (longer && (first[17] & 0xC0) == 0x80);
+        }
+    }
+
+    //! \brief Write the UTF-8 of 8 characters with AVX2.
+    /*!
+     *  \param [in]     code   The characters, U+FFFD for the invalid ones.
+     *  \param [in]     wide   The code points written with 4 bytes.
+     *  \param [in]     first  The lanes holding the first character of a surrogate pair.
+     *  \param [in]     second The lanes holding the second character of a surrogate pair.
+     *  \param [in,out] out    A pointer to the first byte of the output,
+     *                         moved past the last byte written.
+     *
+     *  \sa encodeLanes(__m128i, __m128i, __m128i, __m128i, char*&)
+     */
+    UTF8_TARGET("avx2") UTF8_INLINE void encodeLanes(__m256i code, __m256i wide, __m256i first, __m256i second, char*& out)
+    {
+        const __m256i bits         = _mm256_set1_epi32(0x3F);
+        const __m256i continuation = _mm256_set1_epi32(0x80);
+
+        const __m256i two = _mm256_or_si256(
+            _mm256_or_si256(_mm256_set1_epi32(0xC0), _mm256_srli_epi32(code, 6)),
+            _mm256_slli_epi32(_mm256_or_si256(continuation, _mm256_and_si256(code, bits)), 8));
+        const __m256i three = _mm256_or_si256(
+            _mm256_or_si256(_mm256_set1_epi32(0xE0), _mm256_srli_epi32(code, 12)),
+            _mm256_or_si256(
+                _mm256_slli_epi32(_mm256_or_si256(continuation, _mm256_and_si256(_mm256_srli_epi32(code, 6), bits)), 8),
+                _mm256_slli_epi32(_mm256_or_si256(continuation, _mm256_and_si256(code, bits)), 16)));
+        const __m256i four = _mm256_or_si256(
+            _mm256_or_si256(
+                _mm256_or_si256(_mm256_set1_epi32(0xF0), _mm256_srli_epi32(wide, 18)),
+                _mm256_slli_epi32(_mm256_or_si256(continuation, _mm256_and_si256(_mm256_srli_epi32(wide, 12), bits)), 8)),
+            _mm256_or_si256(
+                _mm256_slli_epi32(_mm256_or_si256(continuation, _mm256_and_si256(_mm256_srli_epi32(wide, 6), bits)), 16),
+                _mm256_slli_epi32(_mm256_or_si256(continuation, _mm256_and_si256(wide, bits)), 24)));
+
+        const __m256i over1 = _mm256_cmpgt_epi32(code, _mm256_set1_epi32(0x7F));
+        const __m256i over2 = _mm256_cmpgt_epi32(code, _mm256_set1_epi32(0x7FF));
+        const __m256i over3 = _mm256_cmpgt_epi32(code, _mm256_set1_epi32(0xFFFF));
+        const __m256i pairs = _mm256_or_si256(first, second);
+
+        __m256i bytes = _mm256_blendv_epi8(code, two, over1);
+
+        bytes = _mm256_blendv_epi8(bytes, three, over2);
+        bytes = _mm256_blendv_epi8(bytes, four, over3);
+        bytes = _mm256_blendv_epi8(bytes, four, first);
+        bytes = _mm256_blendv_epi8(bytes, _mm256_srli_epi32(four, 16), second);
+
+        const __m256i lengths = _mm256_blendv_epi8(
+            _mm256_sub_epi32(_mm256_sub_epi32(_mm256_sub_epi32(_mm256_setzero_si256(), over1), over2), over3),
+            _mm256_set1_epi32(1), pairs);
+
+        const unsigned low  = encodeIndex(_mm256_castsi256_si128(lengths));
+        const unsigned high = encodeIndex(_mm256_extracti128_si256(lengths, 1));
+
+        bytes = _mm256_shuffle_epi8(bytes, _mm256_inserti128_si256(_mm256_castsi128_si256(shuffle(sShuffles.encode[low])), shuffle(sShuffles.encode[high]), 1));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm256_castsi256_si128(bytes));
+        out += sShuffles.length[low];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm256_extracti128_si256(bytes, 1));
+        out += sShuffles.length[high];
+    }
+
+    //! \brief Convert UTF-16 or UTF-32 to UTF-8 with AVX2.
+    /*!
+     *  \param [in,out] first A pointer to the first character of the input,
+     *                        moved to the first character left to convert.
+     *  \param [in]     last  A pointer past the last character of the input.
+     *  \param [in,out] out   A pointer to the first byte of the output,
+     *                        moved past the last byte written.
+     *
+     *  \sa encodeSsse3()
+     */
+    template <typename unitT>
+    UTF8_TARGET("avx2") void encodeAvx2(const unitT*& first, const unitT* last, char*& out)
+    {
+        const unitT* begin = first;
+
+        while (last - first >= 16) {
+            if (sizeof(unitT) == 2) {
+                const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+
+                if (narrowUnits(block, out)) {
+                    first += 8;
+                    out   += 8;
+                    continue;
+                }
+
+                if (encodeShort(block, out)) {
+                    first += 8;
+                    continue;
+                }
+
+                const surrogates_t units = pairSurrogates(block, first, begin, last);
+                const __m256i      wide  = _mm256_add_epi32(
+                    _mm256_add_epi32(_mm256_slli_epi32(_mm256_cvtepu16_epi32(units.lead), 10), _mm256_cvtepu16_epi32(units.trail)),
+                    _mm256_set1_epi32(SURROGATE_OFFSET));
+
+                encodeLanes(_mm256_cvtepu16_epi32(units.code), wide, _mm256_cvtepi16_epi32(units.first), _mm256_cvtepi16_epi32(units.second), out);
+            } else {
+                const __m256i units = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+
+                const __m128i packed = _mm_packs_epi32(_mm256_castsi256_si128(units), _mm256_extracti128_si256(units, 1));
+
+                if (narrowUnits(packed, out)) {
+                    first += 8;
+                    out   += 8;
+                    continue;
+                }
+
+                if (encodeShort(packed, out)) {
+                    first += 8;
+                    continue;
+                }
+
+                const __m256i invalid = _mm256_or_si256(
+                    _mm256_cmpeq_epi32(_mm256_and_si256(units, _mm256_set1_epi32(static_cast<int>(0xFFFFF800))), _mm256_set1_epi32(0xD800)),
+                    _mm256_cmpgt_epi32(_mm256_xor_si256(units, _mm256_set1_epi32(INT32_MIN)), _mm256_set1_epi32(0x10FFFF ^ INT32_MIN)));
+                const __m256i code    = _mm256_blendv_epi8(units, _mm256_set1_epi32(0xFFFD), invalid);
+
+                encodeLanes(code, code, _mm256_setzero_si256(), _mm256_setzero_si256(), out);
+            }
+
+            first += 8;
+        }
+    }
+
+#if defined(UTF8_DISPATCH)
+    //! \brief Convert UTF-8 with SSSE3.
+    /*!
+     *  Each block of 16 bytes is widened when it is made of ASCII, and
+     *  converted one sequence at a time when it holds a 4 bytes sequence.
+     *  Otherwise, the characters of its sequences are computed in 16-bit
+     *  lanes, 8 positions at a time, from the byte at each position and
+     *  the 2 next ones, and a shuffle drops the lanes of the continuation
+     *  bytes.
+     *
+     *  \param [in,out] first A pointer to the first byte of the input,
+     *                        moved to the first sequence left to convert.
+     *  \param [in]     last  A pointer past the last byte of the input.
+     *  \param [in,out] out   A pointer to the first character of the
+     *                        output, moved past the last character written.
+     */
+    template <typename unitT>
+    UTF8_TARGET("ssse3") void decodeSsse3(bytes_t& first, bytes_t last, unitT*& out)
+    {
+        while (last - first >= 24) {
+            const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+
+            if (_mm_movemask_epi8(bytes) == 0) {
+                widen(bytes, out);
+
+                first += 16;
+                out   += 16;
+                continue;
+            }
+
+            if (hasLongSequence(bytes)) {
+                for (bytes_t stop = first + 16; first < stop; )
+                    decodeSequence(first, out);
+
+                continue;
+            }
+
+            const unsigned continuations = _mm_movemask_epi8(_mm_cmplt_epi8(bytes, _mm_set1_epi8(static_cast<char>(0xC0))));
+            const unsigned low           = continuations & 0xFF;
+            const unsigned high          = continuations >> 8;
+
+            storeUnits(_mm_shuffle_epi8(decodeLanes(bytes), shuffle(sShuffles.decode[low])), out);
+            out += sShuffles.count[low];
+            storeUnits(_mm_shuffle_epi8(decodeLanes(_mm_loadu_si128(reinterpret_cast<const __m128i*>(first + 8))), shuffle(sShuffles.decode[high])), out);
+            out += sShuffles.count[high];
+
+            // The sequences starting in the last positions may end in the
+            // 2 next bytes.
+            const bool longer = (first[16] & 0xC0) == 0x80;
+
+            first += 16 + longer + (longer && (first[17] & 0xC0) == 0x80);
+        }
+    }
+
+    //! \brief Write the UTF-8 of 4 characters with SSSE3.
+    /*!
+     *  Each character is encoded in its 32-bit lane, and a shuffle gathers
+     *  the bytes of the lanes. The first character of a surrogate pair
+     *  writes the 2 first bytes of its sequence, and the second one writes
+     *  the 2 last bytes.
+     *
+     *  \param [in]     code   The characters, U+FFFD for the invalid ones.
+     *  \param [in]     wide   The code points written with 4 bytes.
+     *  \param [in]     first  The lanes holding the first character of a surrogate pair.
+     *  \param [in]     second The lanes holding the second character of a surrogate pair.
+     *  \param [in,out] out    A pointer to the first byte of the output,
+     *                         moved past the last byte written.
+     */
+    UTF8_TARGET("ssse3") UTF8_INLINE void encodeLanes(__m128i code, __m128i wide, __m128i first, __m128i second, char*& out)
+    {
+        const __m128i bits         = _mm_set1_epi32(0x3F);
+        const __m128i continuation = _mm_set1_epi32(0x80);
+
+        const __m128i two = _mm_or_si128(
+            _mm_or_si128(_mm_set1_epi32(0xC0), _mm_srli_epi32(code, 6)),
+            _mm_slli_epi32(_mm_or_si128(continuation, _mm_and_si128(code, bits)), 8));
+        const __m128i three = _mm_or_si128(
+            _mm_or_si128(_mm_set1_epi32(0xE0), _mm_srli_epi32(code, 12)),
+            _mm_or_si128(
+                _mm_slli_epi32(_mm_or_si128(continuation, _mm_and_si128(_mm_srli_epi32(code, 6), bits)), 8),
+                _mm_slli_epi32(_mm_or_si128(continuation, _mm_and_si128(code, bits)), 16)));
+        const __m128i four = _mm_or_si128(
+            _mm_or_si128(
+                _mm_or_si128(_mm_set1_epi32(0xF0), _mm_srli_epi32(wide, 18)),
+                _mm_slli_epi32(_mm_or_si128(continuation, _mm_and_si128(_mm_srli_epi32(wide, 12), bits)), 8)),
+            _mm_or_si128(
+                _mm_slli_epi32(_mm_or_si128(continuation, _mm_and_si128(_mm_srli_epi32(wide, 6), bits)), 16),
+                _mm_slli_epi32(_mm_or_si128(continuation, _mm_and_si128(wide, bits)), 24)));
+
+        const __m128i over1 = _mm_cmpgt_epi32(code, _mm_set1_epi32(0x7F));
+        const __m128i over2 = _mm_cmpgt_epi32(code, _mm_set1_epi32(0x7FF));
+        const __m128i over3 = _mm_cmpgt_epi32(code, _mm_set1_epi32(0xFFFF));
+        const __m128i pairs = _mm_or_si128(first, second);
+
+        __m128i bytes = blend(over1, two, code);
+
+        bytes = blend(over2, three, bytes);
+        bytes = blend(over3, four, bytes);
+        bytes = blend(first, four, bytes);
+        bytes = blend(second, _mm_srli_epi32(four, 16), bytes);
+
+        const unsigned index = encodeIndex(blend(pairs, _mm_set1_epi32(1),
+            _mm_sub_epi32(_mm_sub_epi32(_mm_sub_epi32(_mm_setzero_si128(), over1), over2), over3)));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_shuffle_epi8(bytes, shuffle(sShuffles.encode[index])));
+        out += sShuffles.length[index];
+    }
+
+    //! \brief Convert UTF-16 or UTF-32 to UTF-8 with SSSE3.
+    /*!
+     *  Each block of 8 characters is narrowed when it is made of ASCII,
+     *  and written 4 characters at a time by \c encodeLanes() otherwise.
+     *
+     *  \param [in,out] first A pointer to the first character of the input,
+     *                        moved to the first character left to convert.
+     *  \param [in]     last  A pointer past the last character of the input.
+     *  \param [in,out] out   A pointer to the first byte of the output,
+     *                        moved past the last byte written.
+     */
+    template <typename unitT>
+    UTF8_TARGET("ssse3") void encodeSsse3(const unitT*& first, const unitT* last, char*& out)
+    {
+        const unitT*  begin = first;
+        const __m128i zero  = _mm_setzero_si128();
+
+        while (last - first >= 16) {
+            if (sizeof(unitT) == 2) {
+                const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+
+                if (narrowUnits(block, out)) {
+                    first += 8;
+                    out   += 8;
+                    continue;
+                }
+
+                if (encodeShort(block, out)) {
+                    first += 8;
+                    continue;
+                }
+
+                const surrogates_t units  = pairSurrogates(block, first, begin, last);
+                const __m128i      offset = _mm_set1_epi32(SURROGATE_OFFSET);
+
+                encodeLanes(
+                    _mm_unpacklo_epi16(units.code, zero),
+                    _mm_add_epi32(_mm_add_epi32(_mm_slli_epi32(_mm_unpacklo_epi16(units.lead, zero), 10), _mm_unpacklo_epi16(units.trail, zero)), offset),
+                    _mm_unpacklo_epi16(units.first, units.first),
+                    _mm_unpacklo_epi16(units.second, units.second),
+                    out);
+                encodeLanes(
+                    _mm_unpackhi_epi16(units.code, zero),
+                    _mm_add_epi32(_mm_add_epi32(_mm_slli_epi32(_mm_unpackhi_epi16(units.lead, zero), 10), _mm_unpackhi_epi16(units.trail, zero)), offset),
+                    _mm_unpackhi_epi16(units.first, units.first),
+                    _mm_unpackhi_epi16(units.second, units.second),
+                    out);
+            } else {
+                const __m128i blocks[2] = {
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(first)),
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(first + 4))
+                };
+
+                const __m128i packed = _mm_packs_epi32(blocks[0], blocks[1]);
+
+                if (narrowUnits(packed, out)) {
+                    first += 8;
+                    out   += 8;
+                    continue;
+                }
+
+                if (encodeShort(packed, out)) {
+                    first += 8;
+                    continue;
+                }
+
+                for (const __m128i& units : blocks) {
+                    const __m128i invalid = _mm_or_si128(
+                        _mm_cmpeq_epi32(_mm_and_si128(units, _mm_set1_epi32(static_cast<int>(0xFFFFF800))), _mm_set1_epi32(0xD800)),
+                        _mm_cmpgt_epi32(_mm_xor_si128(units, _mm_set1_epi32(INT32_MIN)), _mm_set1_epi32(0x10FFFF ^ INT32_MIN)));
+                    const __m128i code    = blend(invalid, _mm_set1_epi32(0xFFFD), units);
+
+                    encodeLanes(code, code, zero, zero, out);
+                }
+            }
+
+            first += 8;
+        }
+    }
+#endif
+#endif
+
+#if defined(UTF8_DISPATCH)
+    typedef bytes_t (*validator_t)(bytes_t, bytes_t); //!< A validator checking the blocks of a buffer.
+
+    //! \brief Select the validator matching the processor.
+    validator_t selectValidator()
+    {
+        __builtin_cpu_init();
+
+        if (__builtin_cpu_supports("avx2"))
+            return validateAvx2;
+
+        if (__builtin_cpu_supports("ssse3"))
+            return validateSsse3;
+
+        return validateSse2;
+    }
+
+    template <typename unitT>
+    using decoder_t = void (*)(bytes_t&, bytes_t, unitT*&); //!< A kernel converting UTF-8 to the encoding of a character type.
+
+    template <typename unitT>
+    using encoder_t = void (*)(const unitT*&, const unitT*, char*&); //!< A kernel converting the encoding of a character type to UTF-8.
+
+    //! \brief Select the decoding kernel matching the processor.
+    /*!
+     *  \return The kernel, or \c nullptr when the processor has no SSSE3.
+     */
+    template <typename unitT>
+    decoder_t<unitT> selectDecoder()
+    {
+        __builtin_cpu_init();
+
+        if (__builtin_cpu_supports("avx2"))
+            return decodeAvx2<unitT>;
+
+        if (__builtin_cpu_supports("ssse3"))
+            return decodeSsse3<unitT>;
+
+        return nullptr;
+    }
+
+    //! \brief Select the encoding kernel matching the processor.
+    /*!
+     *  \return The kernel, or \c nullptr when the processor has no SSSE3.
+     */
+    template <typename unitT>
+    encoder_t<unitT> selectEncoder()
+    {
+        __builtin_cpu_init();
+
+        if (__builtin_cpu_supports("avx2"))
+            return encodeAvx2<unitT>;
+
+        if (__builtin_cpu_supports("ssse3"))
+            return encodeSsse3<unitT>;
+
+        return nullptr;
+    }
+#endif
+
+    //! \brief Convert valid UTF-8 to UTF-16 or UTF-32.
+    /*!
+     *  The kernel matching the processor converts the blocks of 16 bytes,
+     *  and the last bytes are converted one sequence at a time.
+     *
+     *  \param [in]  first A pointer to the first byte of the input.
+     *  \param [in]  last  A pointer past the last byte of the input.
+     *  \param [out] out   A pointer to the first character of the output.
+     *
+     *  \return A pointer past the last character written.
+     */
+    template <typename unitT>
+    unitT* decodeUnits(bytes_t first, bytes_t last, unitT* out)
+    {
+#if defined(__AVX2__)
+        decodeAvx2(first, last, out);
+#elif defined(UTF8_DISPATCH)
+        static const decoder_t<unitT> decoder = selectDecoder<unitT>();
+
+        if (decoder != nullptr)
+            decoder(first, last, out);
+#endif
+
+        while (first != last) {
+#if defined(__SSE2__)
+            while (last - first >= 16) {
+                const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+
+                if (_mm_movemask_epi8(bytes) != 0)
+                    break;
+
+                widen(bytes, out);
+
+                first += 16;
+                out   += 16;
+            }
+#endif
+
+            // The block holding non-ASCII bytes is converted one sequence
+            // at a time, before trying the next block.
+            bytes_t stop = last - first > 16 ? first + 16 : last;
+
+            while (first < stop)
+                decodeSequence(first, out);
+        }
+
+        return out;
+    }
+
+    //! \brief Convert UTF-16 or UTF-32 to UTF-8.
+    /*!
+     *  The kernel matching the processor converts the blocks of 16
+     *  characters, and the last characters are converted one at a time.
+     *
+     *  \param [in]  first A pointer to the first character of the input.
+     *  \param [in]  last  A pointer past the last character of the input.
+     *  \param [out] out   A pointer to the first byte of the output.
+     *
+     *  \return A pointer past the last byte written.
+     */
+    template <typename unitT>
+    char* encodeUnits(const unitT* first, const unitT* last, char* out)
+    {
+#if defined(UTF8_LOOKUP)
+        const unitT* begin = first;
+
+#if defined(__AVX2__)
+        encodeAvx2(first, last, out);
+#else
+        static const encoder_t<unitT> encoder = selectEncoder<unitT>();
+
+        if (encoder != nullptr)
+            encoder(first, last, out);
+#endif
+
+        // The kernels split the surrogate pairs between their characters,
+        // so the end of a pair cut by their last block is written here.
+        if (sizeof(unitT) == 2 && first != begin && first != last && (first[-1] & 0xFC00) == 0xD800 && (*first & 0xFC00) == 0xDC00) {
+            const uint32_t code = 0x10000 + ((static_cast<uint32_t>(first[-1]) - 0xD800) << 10) + (static_cast<uint32_t>(*first) - 0xDC00);
+
+            *out++ = static_cast<char>(0x80 | (code >> 6 & 0x3F));
+            *out++ = static_cast<char>(0x80 | (code & 0x3F));
+            ++first;
+        }
+#endif
+
+        while (first != last) {
+#if defined(__SSE2__)
+            while (last - first >= 16 && narrow(first, out)) {
+                first += 16;
+                out   += 16;
+            }
+#endif
+
+            const unitT* stop = last - first > 16 ? first + 16 : last;
+
+            while (first < stop)
+                encodeCharacter(first, last, out);
+        }
+
+        return out;
+    }
+}
+
+const char* xml::utf8::validate(const char* first, const char* last)
+{
+    bytes_t cursor = reinterpret_cast<bytes_t>(first);
+    bytes_t end    = reinterpret_cast<bytes_t>(last);
+
+#if defined(__AVX2__)
+    cursor = validateAvx2(cursor, end);
+#elif defined(UTF8_DISPATCH)
+    static const validator_t validator = selectValidator();
+
+    cursor = validator(cursor, end);
+#elif defined(__SSE2__)
+    cursor = validateSse2(cursor, end);
+#endif
+
+    return reinterpret_cast<const char*>(validateSequences(cursor, end, end));
+}
+
+const char* xml::utf8::truncated(const char* first, const char* last)
+{
+    const char* cursor = last;
+
+    for (size_t count = 1; count <= 3 && cursor != first; ++count) {
+        --cursor;
+
+        if ((*cursor & 0xC0) != 0x80)
+            return length(*cursor) > count ? cursor : last;
+    }
+
+    return last;
+}
+
+size_t xml::utf8::length(char lead)
+{
+    const unsigned char c = static_cast<unsigned char>(lead);
+
+    if (c < 0x80)
+        return 1;
+    else if (c < 0xC0)
+        return 0;
+    else if (c < 0xE0)
+        return 2;
+    else if (c < 0xF0)
+        return 3;
+    else if (c < 0xF8)
+        return 4;
+
+    return 0;
+}
+
+char* xml::utf8::decode(const char* first, const char* last, char* out)
+{
+    std::memcpy(out, first, last - first);
+
+    return out + (last - first);
+}
+
+char16_t* xml::utf8::decode(const char* first, const char* last, char16_t* out)
+{
+    return decodeUnits(reinterpret_cast<bytes_t>(first), reinterpret_cast<bytes_t>(last), out);
+}
+
+char32_t* xml::utf8::decode(const char* first, const char* last, char32_t* out)
+{
+    return decodeUnits(reinterpret_cast<bytes_t>(first), reinterpret_cast<bytes_t>(last), out);
+}
+
+wchar_t* xml::utf8::decode(const char* first, const char* last, wchar_t* out)
+{
+    return decodeUnits(reinterpret_cast<bytes_t>(first), reinterpret_cast<bytes_t>(last), out);
+}
+
+char* xml::utf8::encode(const char* first, const char* last, char* out)
+{
+    std::memcpy(out, first, last - first);
+
+    return out + (last - first);
+}
+
+char* xml::utf8::encode(const char16_t* first, const char16_t* last, char* out)
+{
+    return encodeUnits(first, last, out);
+}
+
+char* xml::utf8::encode(const char32_t* first, const char32_t* last, char* out)
+{
+    return encodeUnits(first, last, out);
+}
+
+char* xml::utf8::encode(const wchar_t* first, const wchar_t* last, char* out)
+{
+    return encodeUnits(first, last, out);
+}
\ No newline at end of file
@@ -0,0 +1,6 @@
+#include "xpath-cache.h"
+
+template class xml::basic_xpath_cache<char>;
+template class xml::basic_xpath_cache<char16_t>;
+template class xml::basic_xpath_cache<char32_t>;
+template class xml::basic_xpath_cache<wchar_t>;
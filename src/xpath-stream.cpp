@@ -0,0 +1,6 @@
+#include "xpath-stream.h"
+
+template class xml::basic_xpath_stream<char>;
+template class xml::basic_xpath_stream<char16_t>;
+template class xml::basic_xpath_stream<char32_t>;
+template class xml::basic_xpath_stream<wchar_t>;
\ No newline at end of file
@@ -0,0 +1,16 @@
+#include "xpath.h"
+
+template class xml::basic_xpath_node<char>;
+template class xml::basic_xpath_node<char16_t>;
+template class xml::basic_xpath_node<char32_t>;
+template class xml::basic_xpath_node<wchar_t>;
+
+template class xml::basic_xpath_value<char>;
+template class xml::basic_xpath_value<char16_t>;
+template class xml::basic_xpath_value<char32_t>;
+template class xml::basic_xpath_value<wchar_t>;
+
+template class xml::basic_xpath_expression<char>;
+template class xml::basic_xpath_expression<char16_t>;
+template class xml::basic_xpath_expression<char32_t>;
+template class xml::basic_xpath_expression<wchar_t>;
\ No newline at end of file
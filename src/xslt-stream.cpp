@@ -0,0 +1,6 @@
+#include "xslt-stream.h"
+
+template class xml::basic_xslt_stream<char>;
+template class xml::basic_xslt_stream<char16_t>;
+template class xml::basic_xslt_stream<char32_t>;
+template class xml::basic_xslt_stream<wchar_t>;
@@ -0,0 +1,16 @@
+#include "xslt.h"
+
+template class xml::basic_result_builder<char>;
+template class xml::basic_result_builder<char16_t>;
+template class xml::basic_result_builder<char32_t>;
+template class xml::basic_result_builder<wchar_t>;
+
+template class xml::basic_result_writer<char>;
+template class xml::basic_result_writer<char16_t>;
+template class xml::basic_result_writer<char32_t>;
+template class xml::basic_result_writer<wchar_t>;
+
+template class xml::basic_stylesheet<char>;
+template class xml::basic_stylesheet<char16_t>;
+template class xml::basic_stylesheet<char32_t>;
+template class xml::basic_stylesheet<wchar_t>;
@@ -0,0 +1,195 @@
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <string>
+
+#include "dtd.h"
+#include "builder.h"
+
+template <typename charT>
+class test_dtd : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE( test_dtd );
+    CPPUNIT_TEST( test_compile );
+    CPPUNIT_TEST( test_content );
+    CPPUNIT_TEST( test_mixed );
+    CPPUNIT_TEST( test_attributes );
+    CPPUNIT_TEST( test_violations );
+    CPPUNIT_TEST( test_errors );
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    typedef xml::basic_dtd<charT>          dtd_t;
+    typedef typename dtd_t::dtd_pointer_t  dtd_pointer_t;
+    typedef typename dtd_t::result_t       result_t;
+    typedef typename dtd_t::violations_t   violations_t;
+    typedef typename dtd_t::reader_t       reader_t;
+    typedef xml::basic_builder<charT>      builder_t;
+    typedef std::basic_string<charT>       string_t;
+
+    static string_t str(const std::string& ascii)
+    {
+        return string_t(ascii.begin(), ascii.end());
+    }
+
+    static bool valid(const dtd_pointer_t& dtd, const std::string& document)
+    {
+        return dtd->validate(builder_t::parse(str(document)));
+    }
+
+    void test_compile()
+    {
+        const dtd_pointer_t dtd = dtd_t::compile(str(
+            "<?xml version='1.0'?>\n"
+            "<!-- a > comment -->\n"
+            "<!ENTITY copy '&#169;'>\n"
+            "<!NOTATION gif SYSTEM 'image/gif'>\n"
+            "<!ELEMENT book (title, (chapter | appendix)+, index?)>\n"
+            "<!ELEMENT title (#PCDATA)>\n"
+            "<!ELEMENT chapter EMPTY>\n"
+            "<!ELEMENT appendix ANY>\n"));
+
+        CPPUNIT_ASSERT(dtd->declares(str("book")));
+        CPPUNIT_ASSERT(dtd->declares(str("appendix")));
+        CPPUNIT_ASSERT(!dtd->declares(str("index")));
+        CPPUNIT_ASSERT(!dtd->declares(str("other")));
+    }
+
+    void test_content()
+    {
+        const dtd_pointer_t dtd = dtd_t::compile(str(
+            "<!ELEMENT book (title, (chapter | appendix)+, index?)>"
+            "<!ELEMENT title (#PCDATA)>"
+            "<!ELEMENT chapter EMPTY>"
+            "<!ELEMENT appendix ANY>"
+            "<!ELEMENT index (entry*)>"
+            "<!ELEMENT entry EMPTY>"
+            "<!ELEMENT list ((a, b) | (a, c))*>"
+            "<!ELEMENT a EMPTY><!ELEMENT b EMPTY><!ELEMENT c EMPTY>"));
+
+        CPPUNIT_ASSERT(valid(dtd, "<book><title>t</title><chapter/></book>"));
+        CPPUNIT_ASSERT(valid(dtd, "<book>\n  <title/>\n  <chapter/><appendix>x<chapter/></appendix><chapter/>\n  <index><entry/><entry/></index>\n</book>"));
+        CPPUNIT_ASSERT(!valid(dtd, "<book><title/></book>"));
+        CPPUNIT_ASSERT(!valid(dtd, "<book><chapter/><title/></book>"));
+        CPPUNIT_ASSERT(!valid(dtd, "<book><title/><chapter/><index/><chapter/></book>"));
+        CPPUNIT_ASSERT(!valid(dtd, "<book><title/>text<chapter/></book>"));
+        CPPUNIT_ASSERT(!valid(dtd, "<book><title/><chapter>x</chapter></book>"));
+        CPPUNIT_ASSERT(!valid(dtd, "<book><title/><appendix><unknown/></appendix></book>"));
+
+        CPPUNIT_ASSERT(valid(dtd, "<list/>"));
+        CPPUNIT_ASSERT(valid(dtd, "<list><a/><b/><a/><c/></list>"));
+        CPPUNIT_ASSERT(!valid(dtd, "<list><a/><b/><a/></list>"));
+        CPPUNIT_ASSERT(!valid(dtd, "<list><a/><a/></list>"));
+    }
+
+    void test_mixed()
+    {
+        const dtd_pointer_t dtd = dtd_t::compile(str(
+            "<!ELEMENT p (#PCDATA | em | strong)*><!ELEMENT em (#PCDATA)><!ELEMENT strong (#PCDATA)>"));
+
+        CPPUNIT_ASSERT(valid(dtd, "<p>a <em>b</em> c <strong>d</strong><em/></p>"));
+        CPPUNIT_ASSERT(valid(dtd, "<p/>"));
+        CPPUNIT_ASSERT(!valid(dtd, "<p><em><strong/></em></p>"));
+        CPPUNIT_ASSERT(!valid(dtd, "<p><p/></p>"));
+    }
+
+    void test_attributes()
+    {
+        const dtd_pointer_t dtd = dtd_t::compile(str(
+            "<!ELEMENT r (n*)><!ELEMENT n EMPTY>"
+            "<!ATTLIST r version CDATA #FIXED '1.0' lang NMTOKEN #IMPLIED>"
+            "<!ATTLIST n id ID #REQUIRED ref IDREF #IMPLIED refs IDREFS #IMPLIED"
+            "            kind (leaf | node) 'leaf' size NMTOKENS #IMPLIED>"
+            "<!ATTLIST n id CDATA #IMPLIED>"));
+
+        CPPUNIT_ASSERT(valid(dtd, "<r version='1.0' lang='en-US'><n id='a' kind='node' size=' 1 2 '/><n id='b' ref='a' refs='a  b'/></r>"));
+        CPPUNIT_ASSERT(valid(dtd, "<r><n id='a' ref=' a '/></r>"));
+        CPPUNIT_ASSERT(!valid(dtd, "<r version='2.0'/>"));
+        CPPUNIT_ASSERT(!valid(dtd, "<r lang='a b'/>"));
+        CPPUNIT_ASSERT(!valid(dtd, "<r><n/></r>"));
+        CPPUNIT_ASSERT(!valid(dtd, "<r><n id='1a'/></r>"));
+        CPPUNIT_ASSERT(!valid(dtd, "<r><n id='a'/><n id='a'/></r>"));
+        CPPUNIT_ASSERT(!valid(dtd, "<r><n id='a' ref='b'/></r>"));
+        CPPUNIT_ASSERT(!valid(dtd, "<r><n id='a' refs='a c'/></r>"));
+        CPPUNIT_ASSERT(!valid(dtd, "<r><n id='a' kind='root'/></r>"));
+        CPPUNIT_ASSERT(!valid(dtd, "<r><n id='a' other='x'/></r>"));
+    }
+
+    void test_violations()
+    {
+        const dtd_pointer_t dtd = dtd_t::compile(str(
+            "<!ELEMENT r (a, b)><!ELEMENT a EMPTY><!ELEMENT b EMPTY><!ATTLIST b k CDATA #REQUIRED>"));
+
+        const typename builder_t::document_t doc = builder_t::parse(str("<r><a x='1'/><c/><b/></r>"));
+        violations_t violations;
+
+        CPPUNIT_ASSERT(!dtd->validate(doc, &violations));
+        CPPUNIT_ASSERT(violations.size() == 4);
+
+        CPPUNIT_ASSERT(violations[0].code == dtd_t::invalid_content);
+        CPPUNIT_ASSERT(violations[0].element == &doc.root());
+        CPPUNIT_ASSERT(violations[1].code == dtd_t::undeclared_attribute);
+        CPPUNIT_ASSERT(violations[1].name == str("x"));
+        CPPUNIT_ASSERT(violations[2].code == dtd_t::undeclared_element);
+        CPPUNIT_ASSERT(violations[2].element->name() == str("c"));
+        CPPUNIT_ASSERT(violations[3].code == dtd_t::missing_attribute);
+        CPPUNIT_ASSERT(violations[3].name == str("k"));
+
+        const size_t depth = 10000;
+        std::string deep;
+
+        for (size_t i = 0; i < depth; ++i)
+            deep += "<r><a/><b k=''/>";
+
+        deep += "<r><a/><b k=''/></r>";
+
+        for (size_t i = 0; i < depth; ++i)
+            deep += "</r>";
+
+        CPPUNIT_ASSERT(!valid(dtd, deep));
+    }
+
+    void test_errors()
+    {
+        const char* const invalid[] = {
+            "<!ELEMENT a>",
+            "<!ELEMENT a (b,c|d)>",
+            "<!ELEMENT a EMPTY><!ELEMENT a ANY>",
+            "<!ELEMENT a (#PCDATA|b)>",
+            "<!ATTLIST a b INTEGER #IMPLIED>",
+            "<!ATTLIST a b CDATA>",
+            "%entity;",
+            "<!ELEMENT a (b"
+        };
+
+        for (const char* input : invalid) {
+            const string_t declarations = str(input);
+            result_t result = dtd_t::try_compile(declarations.data(), declarations.data() + declarations.size());
+
+            CPPUNIT_ASSERT(!result);
+        }
+
+        const string_t truncated = str("<!ELEMENT a EMPTY>\n<!ATTLIST a b CDATA '");
+        result_t result = dtd_t::try_compile(truncated.data(), truncated.data() + truncated.size());
+
+        CPPUNIT_ASSERT(!result);
+        CPPUNIT_ASSERT(result.error().code() == reader_t::unexpected_end);
+        CPPUNIT_ASSERT(result.error().line(truncated.data()) == 2);
+
+        bool thrown = false;
+
+        try {
+            dtd_t::compile(str("<!ELEMENT a (b,c|d)>"));
+        } catch (typename dtd_t::exception_t& e) {
+            thrown = true;
+
+            CPPUNIT_ASSERT(e.errCode() == reader_t::invalid_doctype);
+        }
+
+        CPPUNIT_ASSERT(thrown);
+    }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(test_dtd<char>);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_dtd<char16_t>);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_dtd<char32_t>);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_dtd<wchar_t>);
@@ -0,0 +1,144 @@
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <string>
+#include <stdexcept>
+
+#include "entity-decoder.h"
+#include "builder.h"
+#include "parallel-builder.h"
+#include "record-reader.h"
+#include "lazy-builder.h"
+
+template <typename charT>
+class test_entity_decoder : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE( test_entity_decoder );
+    CPPUNIT_TEST( test_decode );
+    CPPUNIT_TEST( test_view );
+    CPPUNIT_TEST( test_invalid );
+    CPPUNIT_TEST( test_builders );
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    typedef xml::basic_entity_decoder<charT>  decoder_t;
+    typedef typename decoder_t::view_t        view_t;
+    typedef typename decoder_t::string_ref_t  string_ref_t;
+    typedef xml::basic_builder<charT>         builder_t;
+    typedef typename builder_t::document_t    document_t;
+    typedef typename builder_t::element_t     element_t;
+    typedef xml::basic_text<charT>            text_t;
+    typedef std::basic_string<charT>          string_t;
+
+    static string_t str(const std::string& ascii)
+    {
+        return string_t(ascii.begin(), ascii.end());
+    }
+
+    static string_t decode(const std::string& ascii)
+    {
+        string_t value = str(ascii);
+        charT* last = decoder_t::decode(&value[0], &value[0] + value.size());
+
+        CPPUNIT_ASSERT(last != nullptr);
+
+        value.resize(last - value.data());
+
+        return value;
+    }
+
+    void test_decode()
+    {
+        CPPUNIT_ASSERT(decode("") == str(""));
+        CPPUNIT_ASSERT(decode("plain") == str("plain"));
+        CPPUNIT_ASSERT(decode("&lt;a&gt; &amp;&amp; &apos;&quot;") == str("<a> && '\""));
+        CPPUNIT_ASSERT(decode("&#65;&#x42;&#x0043;&#x6a;x") == str("ABCjx"));
+        CPPUNIT_ASSERT(decode("&#9;&#10;&#13;") == str("\t\n\r"));
+        CPPUNIT_ASSERT(decode(std::string(100, 'a') + "&amp;" + std::string(100, 'b')) == str(std::string(100, 'a') + "&" + std::string(100, 'b')));
+
+        const string_t wide = decode("&#xE9;&#x20AC;&#x1F600;");
+
+        if (sizeof(charT) == 1)
+            CPPUNIT_ASSERT(wide == str("\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80"));
+        else if (sizeof(charT) == 2)
+            CPPUNIT_ASSERT(wide.size() == 4 && wide[0] == 0xE9 && wide[1] == 0x20AC && wide[2] == 0xD83D && wide[3] == 0xDE00);
+        else
+            CPPUNIT_ASSERT(wide.size() == 3 && wide[0] == 0xE9 && wide[1] == 0x20AC && wide[2] == 0x1F600);
+    }
+
+    void test_view()
+    {
+        const string_t plain = str("no reference here");
+        const string_t escaped = str("a &lt; b");
+        string_ref_t out;
+
+        CPPUNIT_ASSERT(decoder_t::decode(view_t(plain.data(), plain.data() + plain.size()), out, true));
+        CPPUNIT_ASSERT(out.references());
+        CPPUNIT_ASSERT(out == plain);
+
+        CPPUNIT_ASSERT(decoder_t::decode(view_t(plain.data(), plain.data() + plain.size()), out, false));
+        CPPUNIT_ASSERT(!out.references());
+        CPPUNIT_ASSERT(out == plain);
+
+        CPPUNIT_ASSERT(decoder_t::decode(view_t(escaped.data(), escaped.data() + escaped.size()), out, true));
+        CPPUNIT_ASSERT(!out.references());
+        CPPUNIT_ASSERT(out == str("a < b"));
+    }
+
+    void test_invalid()
+    {
+        const std::string invalid[] = {
+            "&", "&amp", "&;", "&foo;", "&#;", "&#x;", "&#12a;", "&#xG;", "&#X41;",
+            "&#0;", "&#x1;", "&#xD800;", "&#xFFFE;", "&#x110000;", "&#99999999999;"
+        };
+
+        for (const std::string& ascii : invalid) {
+            string_t value = str("a" + ascii + "b");
+
+            CPPUNIT_ASSERT(decoder_t::decode(&value[0], &value[0] + value.size()) == nullptr);
+        }
+    }
+
+    void test_builders()
+    {
+        const string_t input = str("<r a='x &amp; y'><c k='&#x41;'>1 &lt; 2</c><d>plain</d></r>");
+
+        const document_t documents[] = {
+            builder_t::parse(input),
+            builder_t::parse(input.data(), input.data() + input.size(), true),
+            xml::basic_parallel_builder<charT>::parse(input.data(), input.data() + input.size(), 2),
+            xml::basic_lazy_builder<charT>::parse(input.data(), input.data() + input.size())
+        };
+
+        for (const document_t& doc : documents) {
+            const element_t& c = static_cast<const element_t&>(doc.root().front());
+            const element_t& d = static_cast<const element_t&>(doc.root().back());
+
+            CPPUNIT_ASSERT(doc.root().attributes().begin()->value() == str("x & y"));
+            CPPUNIT_ASSERT(c.attributes().begin()->value() == str("A"));
+            CPPUNIT_ASSERT(static_cast<const text_t&>(c.front()).data() == str("1 < 2"));
+            CPPUNIT_ASSERT(static_cast<const text_t&>(d.front()).data() == str("plain"));
+        }
+
+        xml::basic_record_reader<charT> records(input.data(), input.data() + input.size());
+
+        CPPUNIT_ASSERT(records.root().attributes().begin()->value() == str("x & y"));
+        CPPUNIT_ASSERT(records.next());
+        CPPUNIT_ASSERT(static_cast<const text_t&>(records.record().front()).data() == str("1 < 2"));
+
+        const string_t malformed = str("<r><c k='&bogus;'/></r>");
+        bool thrown = false;
+
+        try {
+            builder_t::parse(malformed);
+        } catch (std::runtime_error&) {
+            thrown = true;
+        }
+
+        CPPUNIT_ASSERT(thrown);
+    }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(test_entity_decoder<char>);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_entity_decoder<char16_t>);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_entity_decoder<char32_t>);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_entity_decoder<wchar_t>);
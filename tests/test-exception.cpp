@@ -0,0 +1,180 @@
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <string>
+#include <cstdio>
+#include <stdexcept>
+
+#include "exception.h"
+#include "builder.h"
+#include "lazy-builder.h"
+
+template <typename charT>
+class test_exception : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE( test_exception );
+    CPPUNIT_TEST( test_position );
+    CPPUNIT_TEST( test_try_parse );
+    CPPUNIT_TEST( test_throw );
+    CPPUNIT_TEST( test_builders );
+    CPPUNIT_TEST( test_load_utf8 );
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    typedef xml::basic_builder<charT>         builder_t;
+    typedef typename builder_t::reader_t      reader_t;
+    typedef typename builder_t::result_t      result_t;
+    typedef typename builder_t::parse_error_t parse_error_t;
+    typedef typename builder_t::exception_t   exception_t;
+    typedef xml::basic_lazy_builder<charT>    lazy_t;
+    typedef std::basic_string<charT>          string_t;
+
+    static string_t str(const std::string& ascii)
+    {
+        return string_t(ascii.begin(), ascii.end());
+    }
+
+    void test_position()
+    {
+        const string_t input = str("<a>\n  <b>\n\n    <c></d>");
+        const parse_error_t error("malformed XML document", reader_t::mismatched_tag, input.find(str("</d>")));
+
+        CPPUNIT_ASSERT(error.line(input.data()) == 4);
+        CPPUNIT_ASSERT(error.column(input.data()) == 8);
+
+        const parse_error_t first("malformed XML document", reader_t::no_root, 0);
+
+        CPPUNIT_ASSERT(first.line(input.data()) == 1);
+        CPPUNIT_ASSERT(first.column(input.data()) == 1);
+    }
+
+    void test_try_parse()
+    {
+        const string_t valid = str("<r><a/></r>");
+        result_t result = builder_t::try_parse(valid.data(), valid.data() + valid.size());
+
+        CPPUNIT_ASSERT(result.has_value());
+        CPPUNIT_ASSERT(result.value().root().name() == str("r"));
+        CPPUNIT_ASSERT(result.value().root().size() == 1);
+
+        const string_t invalid = str("<r>\n<a></b></r>");
+        result_t failed = builder_t::try_parse(invalid.data(), invalid.data() + invalid.size());
+
+        CPPUNIT_ASSERT(!failed);
+        CPPUNIT_ASSERT(failed.error().code() == reader_t::mismatched_tag);
+        CPPUNIT_ASSERT(failed.error().offset() == 7);
+        CPPUNIT_ASSERT(failed.error().line(invalid.data()) == 2);
+        CPPUNIT_ASSERT(failed.error().column(invalid.data()) == 4);
+
+        const string_t reference = str("<r>&bogus;</r>");
+        result_t rejected = builder_t::try_parse(reference.data(), reference.data() + reference.size());
+
+        CPPUNIT_ASSERT(!rejected);
+        CPPUNIT_ASSERT(rejected.error().code() == reader_t::invalid_reference);
+
+        const string_t declaration = str("<?xml version='x'?><r/>");
+        result_t misdeclared = builder_t::try_parse(declaration.data(), declaration.data() + declaration.size());
+
+        CPPUNIT_ASSERT(!misdeclared);
+        CPPUNIT_ASSERT(misdeclared.error().code() == reader_t::invalid_declaration);
+        CPPUNIT_ASSERT(std::string(misdeclared.error().what()) == "invalid XML version");
+    }
+
+    void test_throw()
+    {
+        const string_t input = str("<r>\n  <a></b>\n</r>");
+        bool thrown = false;
+
+        try {
+            builder_t::parse(input);
+        } catch (exception_t& e) {
+            thrown = true;
+
+            CPPUNIT_ASSERT(e.errCode() == reader_t::mismatched_tag);
+            CPPUNIT_ASSERT(e.offset() == 9);
+            CPPUNIT_ASSERT(e.line() == 2);
+            CPPUNIT_ASSERT(e.column() == 6);
+            CPPUNIT_ASSERT(std::string(e.what()) ==
+                "malformed XML document (error " + std::to_string(static_cast<int>(reader_t::mismatched_tag)) + " at line 2, column 6)");
+        }
+
+        CPPUNIT_ASSERT(thrown);
+
+        thrown = false;
+
+        try {
+            builder_t::parse(str("<r>"));
+        } catch (std::runtime_error& e) {
+            thrown = true;
+
+            CPPUNIT_ASSERT(std::string(e.what()).find("malformed XML document") == 0);
+        }
+
+        CPPUNIT_ASSERT(thrown);
+
+        thrown = false;
+
+        const std::string utf8 = "<r>\n  <a>\xC3\xA9</b>\n</r>";
+
+        try {
+            builder_t::parse_utf8(utf8.data(), utf8.data() + utf8.size());
+        } catch (exception_t& e) {
+            thrown = true;
+
+            CPPUNIT_ASSERT(e.errCode() == reader_t::mismatched_tag);
+            CPPUNIT_ASSERT(e.line() == 2);
+            CPPUNIT_ASSERT(e.column() == (sizeof(charT) == 1 ? 8 : 7));
+        }
+
+        CPPUNIT_ASSERT(thrown);
+    }
+
+    void test_builders()
+    {
+        const string_t input = str("<r>\n<a k='&bogus;'/></r>");
+        const typename lazy_t::document_t doc = lazy_t::parse(input.data(), input.data() + input.size());
+        bool thrown = false;
+
+        try {
+            static_cast<const typename lazy_t::element_t&>(doc.root().back()).attributes();
+        } catch (exception_t& e) {
+            thrown = true;
+
+            CPPUNIT_ASSERT(e.errCode() == reader_t::invalid_reference);
+            CPPUNIT_ASSERT(e.line() == 2);
+        }
+
+        CPPUNIT_ASSERT(thrown);
+    }
+
+    void test_load_utf8()
+    {
+        const std::string path    = "test-exception-" + std::to_string(sizeof(charT)) + ".xml";
+        const std::string content = "<?xml version='1.0'?>\n<r>\n  <a>\xC3\xA9</b>\n</r>";
+
+        FILE* file = std::fopen(path.c_str(), "wb");
+        std::fwrite(content.data(), 1, content.size(), file);
+        std::fclose(file);
+
+        bool thrown = false;
+
+        try {
+            builder_t::load_utf8(path);
+        } catch (exception_t& e) {
+            thrown = true;
+
+            CPPUNIT_ASSERT(e.errCode() == reader_t::mismatched_tag);
+            CPPUNIT_ASSERT(e.line() == 3);
+            CPPUNIT_ASSERT(e.column() == (sizeof(charT) == 1 ? 8 : 7));
+            CPPUNIT_ASSERT(std::string(e.what()).find("at line 3, column") != std::string::npos);
+        }
+
+        std::remove(path.c_str());
+
+        CPPUNIT_ASSERT(thrown);
+    }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(test_exception<char>);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_exception<char16_t>);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_exception<char32_t>);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_exception<wchar_t>);
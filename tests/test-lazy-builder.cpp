@@ -0,0 +1,212 @@
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <string>
+#include <stdexcept>
+
+#include "lazy-builder.h"
+
+template <typename charT>
+class test_lazy_builder : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE( test_lazy_builder );
+    CPPUNIT_TEST( test_parse );
+    CPPUNIT_TEST( test_deferred );
+    CPPUNIT_TEST( test_modify );
+    CPPUNIT_TEST( test_copy );
+    CPPUNIT_TEST( test_errors );
+    CPPUNIT_TEST( test_namespaces );
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    typedef xml::basic_lazy_builder<charT>  lazy_t;
+    typedef typename lazy_t::builder_t      builder_t;
+    typedef typename lazy_t::document_t     document_t;
+    typedef typename lazy_t::element_t      element_t;
+    typedef typename element_t::table_t     table_t;
+    typedef xml::basic_text<charT>          text_t;
+    typedef std::basic_string<charT>        string_t;
+
+    static string_t str(const std::string& ascii)
+    {
+        return string_t(ascii.begin(), ascii.end());
+    }
+
+    static void check(const element_t& expected, const element_t& actual,
+                      const table_t* expectedNamespaces = nullptr, const table_t* actualNamespaces = nullptr)
+    {
+        CPPUNIT_ASSERT(expected.name() == actual.name());
+        CPPUNIT_ASSERT(expected.attributes().size() == actual.attributes().size());
+        CPPUNIT_ASSERT(expected.size() == actual.size());
+
+        if (expectedNamespaces != nullptr)
+            CPPUNIT_ASSERT(expectedNamespaces->uri(expected.namespace_id()) == actualNamespaces->uri(actual.namespace_id()));
+
+        for (auto i = expected.attributes().begin(), j = actual.attributes().begin(); i != expected.attributes().end(); ++i, ++j) {
+            CPPUNIT_ASSERT(i->name() == j->name());
+            CPPUNIT_ASSERT(i->value() == j->value());
+
+            if (expectedNamespaces != nullptr)
+                CPPUNIT_ASSERT(expectedNamespaces->uri(i->namespace_id()) == actualNamespaces->uri(j->namespace_id()));
+        }
+
+        for (auto i = expected.begin(), j = actual.begin(); i != expected.end(); ++i, ++j) {
+            CPPUNIT_ASSERT(i->type() == j->type());
+
+            if (xml::basic_string_view<charT>(i->type()).equals("element"))
+                check(static_cast<const element_t&>(*i), static_cast<const element_t&>(*j), expectedNamespaces, actualNamespaces);
+            else
+                CPPUNIT_ASSERT(static_cast<const text_t&>(*i).data() == static_cast<const text_t&>(*j).data());
+        }
+    }
+
+    static string_t document(size_t count)
+    {
+        std::string content = "<?xml version='1.0' standalone='yes'?>\n<root kind='records'>\n";
+
+        for (size_t i = 0; i < count; ++i)
+            content += "<record id='" + std::to_string(i) + "'><name>name</name><![CDATA[<raw>]]><deep><deeper/></deep></record>\n";
+
+        return str(content + "</root>\n");
+    }
+
+    void test_parse()
+    {
+        const string_t input = document(100);
+        const document_t doc = lazy_t::parse(input.data(), input.data() + input.size());
+
+        CPPUNIT_ASSERT(doc.source());
+        CPPUNIT_ASSERT(doc.standalone().value == builder_t::standalone_t::yes);
+        CPPUNIT_ASSERT(doc.root().name() == str("root"));
+        CPPUNIT_ASSERT(doc.root().name().references());
+
+        check(builder_t::parse(input).root(), doc.root());
+    }
+
+    void test_deferred()
+    {
+        const string_t input = str("<r><a><1/></a><c k='v'>t</c></r>");
+        document_t doc = lazy_t::parse(input.data(), input.data() + input.size());
+        element_t& a = static_cast<element_t&>(doc.root().front());
+        element_t& c = static_cast<element_t&>(doc.root().back());
+
+        CPPUNIT_ASSERT(doc.root().size() == 2);
+        CPPUNIT_ASSERT(a.name() == str("a"));
+        CPPUNIT_ASSERT(c.attributes().begin()->value() == str("v"));
+        CPPUNIT_ASSERT(static_cast<const text_t&>(c.front()).data() == str("t"));
+
+        bool thrown = false;
+
+        try {
+            a.begin();
+        } catch (std::runtime_error&) {
+            thrown = true;
+        }
+
+        CPPUNIT_ASSERT(thrown);
+    }
+
+    void test_modify()
+    {
+        const string_t input = str("<r><a/><b/></r>");
+        document_t doc = lazy_t::parse(input.data(), input.data() + input.size());
+
+        doc.root().emplace_element_back(str("z"));
+
+        CPPUNIT_ASSERT(doc.root().size() == 3);
+        CPPUNIT_ASSERT(static_cast<const element_t&>(doc.root().front()).name() == str("a"));
+        CPPUNIT_ASSERT(static_cast<const element_t&>(doc.root().back()).name() == str("z"));
+
+        const string_t other = str("<r><a/><b/></r>");
+        document_t cleared = lazy_t::parse(other.data(), other.data() + other.size());
+
+        cleared.root().clear();
+
+        CPPUNIT_ASSERT(cleared.root().empty());
+    }
+
+    void test_copy()
+    {
+        const string_t input = document(10);
+        document_t* doc = new document_t(lazy_t::parse(input.data(), input.data() + input.size()));
+        const document_t copy(*doc);
+
+        delete doc;
+
+        CPPUNIT_ASSERT(!copy.source());
+        CPPUNIT_ASSERT(!copy.root().name().references());
+
+        check(builder_t::parse(input).root(), copy.root());
+    }
+
+    void test_errors()
+    {
+        const std::string inputs[] = {
+            "<a>",
+            "<a/><b/>",
+            "<?xml version='2'?><a/>",
+            "<1/>"
+        };
+
+        for (const std::string& ascii : inputs) {
+            const string_t input = str(ascii);
+            bool thrown = false;
+
+            try {
+                lazy_t::parse(input.data(), input.data() + input.size());
+            } catch (std::runtime_error&) {
+                thrown = true;
+            }
+
+            CPPUNIT_ASSERT(thrown);
+        }
+
+        const string_t input = str("<r><a></b></r>");
+        const document_t doc = lazy_t::parse(input.data(), input.data() + input.size());
+        bool thrown = false;
+
+        try {
+            static_cast<const element_t&>(doc.root().front()).size();
+        } catch (std::runtime_error&) {
+            thrown = true;
+        }
+
+        CPPUNIT_ASSERT(thrown);
+    }
+
+    void test_namespaces()
+    {
+        const string_t input = str(
+            "<root xmlns='urn:default' xmlns:a='urn:a' xml:lang='en'>"
+            "<a:record a:k='v' xmlns:b='urn:b'><b:name b:x='1' a:x='2'>name</b:name><plain xmlns=''>text</plain></a:record>"
+            "<a:record xmlns:a='urn:other'><a:inner/></a:record>"
+            "</root>");
+        const document_t expected = builder_t::parse(input);
+        const document_t doc      = lazy_t::parse(input.data(), input.data() + input.size());
+        const element_t& record   = static_cast<const element_t&>(doc.root().back());
+
+        CPPUNIT_ASSERT(doc.namespaces().uri(record.namespace_id()) == str("urn:other"));
+        CPPUNIT_ASSERT(doc.namespaces().uri(static_cast<const element_t&>(record.front()).namespace_id()) == str("urn:other"));
+
+        check(expected.root(), doc.root(), &expected.namespaces(), &doc.namespaces());
+
+        const string_t unbound = str("<r xmlns:a='urn:a'><a:b/><c:d/></r>");
+        const document_t invalid = lazy_t::parse(unbound.data(), unbound.data() + unbound.size());
+
+        CPPUNIT_ASSERT(invalid.namespaces().uri(static_cast<const element_t&>(invalid.root().front()).namespace_id()) == str("urn:a"));
+
+        bool thrown = false;
+
+        try {
+            static_cast<const element_t&>(invalid.root().back()).namespace_id();
+        } catch (std::runtime_error&) {
+            thrown = true;
+        }
+
+        CPPUNIT_ASSERT(thrown);
+    }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(test_lazy_builder<char>);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_lazy_builder<char16_t>);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_lazy_builder<char32_t>);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_lazy_builder<wchar_t>);
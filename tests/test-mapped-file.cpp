@@ -0,0 +1,112 @@
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <string>
+#include <cstdio>
+#include <stdexcept>
+
+#include "builder.h"
+
+template <typename charT>
+class test_mapped_file : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE( test_mapped_file );
+    CPPUNIT_TEST( test_load );
+    CPPUNIT_TEST( test_modify );
+    CPPUNIT_TEST( test_copy );
+    CPPUNIT_TEST( test_missing );
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    typedef xml::basic_builder<charT>      builder_t;
+    typedef typename builder_t::document_t document_t;
+    typedef typename builder_t::element_t  element_t;
+    typedef xml::basic_text<charT>         text_t;
+    typedef std::basic_string<charT>       string_t;
+
+    static string_t str(const std::string& ascii)
+    {
+        return string_t(ascii.begin(), ascii.end());
+    }
+
+    void setUp()
+    {
+        const string_t content = str("<root id='1'><child>text</child><child/></root>");
+
+        mPath = "test-mapped-file-" + std::to_string(sizeof(charT)) + ".xml";
+
+        FILE* file = std::fopen(mPath.c_str(), "wb");
+        std::fwrite(content.data(), sizeof(charT), content.size(), file);
+        std::fclose(file);
+    }
+
+    void tearDown()
+    {
+        std::remove(mPath.c_str());
+    }
+
+    void test_load()
+    {
+        const document_t doc = builder_t::load(mPath);
+        const element_t& child = static_cast<const element_t&>(doc.root().front());
+
+        CPPUNIT_ASSERT(doc.source());
+        CPPUNIT_ASSERT(doc.root().name() == str("root"));
+        CPPUNIT_ASSERT(doc.root().name().references());
+        CPPUNIT_ASSERT(doc.root().size() == 2);
+        CPPUNIT_ASSERT(doc.root().attributes().begin()->value() == str("1"));
+        CPPUNIT_ASSERT(doc.root().attributes().begin()->value().references());
+        CPPUNIT_ASSERT(static_cast<const text_t&>(child.front()).data() == str("text"));
+        CPPUNIT_ASSERT(static_cast<const text_t&>(child.front()).data().references());
+    }
+
+    void test_modify()
+    {
+        document_t doc = builder_t::load(mPath);
+
+        doc.root().name().modify().append(str("-modified"));
+
+        CPPUNIT_ASSERT(!doc.root().name().references());
+        CPPUNIT_ASSERT(doc.root().name() == str("root-modified"));
+
+        element_t& child = static_cast<element_t&>(doc.root().front());
+
+        child.name() = str("renamed");
+
+        CPPUNIT_ASSERT(!child.name().references());
+        CPPUNIT_ASSERT(child.name() == str("renamed"));
+    }
+
+    void test_copy()
+    {
+        document_t* doc = new document_t(builder_t::load(mPath));
+        const document_t copy(*doc);
+
+        delete doc;
+
+        CPPUNIT_ASSERT(!copy.source());
+        CPPUNIT_ASSERT(!copy.root().name().references());
+        CPPUNIT_ASSERT(copy.root().name() == str("root"));
+        CPPUNIT_ASSERT(copy.root().attributes().begin()->value() == str("1"));
+    }
+
+    void test_missing()
+    {
+        bool thrown = false;
+
+        try {
+            builder_t::load("missing-file.xml");
+        } catch (std::runtime_error&) {
+            thrown = true;
+        }
+
+        CPPUNIT_ASSERT(thrown);
+    }
+
+private:
+    std::string mPath;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(test_mapped_file<char>);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_mapped_file<char16_t>);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_mapped_file<char32_t>);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_mapped_file<wchar_t>);
@@ -0,0 +1,203 @@
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <string>
+
+#include "namespace-table.h"
+#include "builder.h"
+
+template <typename charT>
+class test_namespace : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE( test_namespace );
+    CPPUNIT_TEST( test_table );
+    CPPUNIT_TEST( test_scope );
+    CPPUNIT_TEST( test_resolve );
+    CPPUNIT_TEST( test_errors );
+    CPPUNIT_TEST( test_copy );
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    typedef xml::basic_namespace_table<charT> table_t;
+    typedef xml::basic_namespace_scope<charT> scope_t;
+    typedef xml::basic_builder<charT>         builder_t;
+    typedef typename builder_t::reader_t      reader_t;
+    typedef typename builder_t::result_t      result_t;
+    typedef typename builder_t::document_t    document_t;
+    typedef typename builder_t::element_t     element_t;
+    typedef typename element_t::attribute_t   attribute_t;
+    typedef typename table_t::view_t          view_t;
+    typedef std::basic_string<charT>          string_t;
+
+    static string_t str(const std::string& ascii)
+    {
+        return string_t(ascii.begin(), ascii.end());
+    }
+
+    static const element_t& child(const element_t& parent, size_t index)
+    {
+        auto it = parent.begin();
+
+        while (index-- != 0)
+            ++it;
+
+        return static_cast<const element_t&>(*it);
+    }
+
+    static const attribute_t& attribute(const element_t& element, const std::string& name)
+    {
+        for (auto it = element.attributes().begin(); it != element.attributes().end(); ++it)
+            if (it->name() == str(name))
+                return *it;
+
+        CPPUNIT_ASSERT(false);
+
+        return *element.attributes().begin();
+    }
+
+    void test_table()
+    {
+        table_t table;
+        const string_t soap = str("http://schemas.xmlsoap.org/soap/envelope/");
+        const string_t xsd  = str("http://www.w3.org/2001/XMLSchema");
+
+        CPPUNIT_ASSERT(table.size() == 3);
+        CPPUNIT_ASSERT(table.uri(table_t::no_namespace).empty());
+        CPPUNIT_ASSERT(table.uri(table_t::xml_namespace) == str("http://www.w3.org/XML/1998/namespace"));
+        CPPUNIT_ASSERT(table.find(soap) == table_t::npos);
+
+        const xml::namespace_id_t id = table.intern(soap);
+
+        CPPUNIT_ASSERT(id == 3);
+        CPPUNIT_ASSERT(table.intern(xsd) == 4);
+        CPPUNIT_ASSERT(table.intern(string_t(soap)) == id);
+        CPPUNIT_ASSERT(table.find(soap) == id);
+        CPPUNIT_ASSERT(table.uri(id) == soap);
+        CPPUNIT_ASSERT(table.size() == 5);
+
+        table_t copy(table);
+        table_t moved(std::move(table));
+
+        CPPUNIT_ASSERT(copy.find(xsd) == 4);
+        CPPUNIT_ASSERT(moved.find(soap) == id);
+        CPPUNIT_ASSERT(moved.uri(4) == xsd);
+    }
+
+    void test_scope()
+    {
+        scope_t scope;
+        const string_t p = str("p");
+        const string_t q = str("q");
+
+        CPPUNIT_ASSERT(scope.find(view_t()) == table_t::no_namespace);
+        CPPUNIT_ASSERT(scope.find(str("xml")) == table_t::xml_namespace);
+        CPPUNIT_ASSERT(scope.find(p) == table_t::npos);
+
+        scope.push();
+        scope.bind(p, 3);
+        scope.bind(view_t(), 4);
+
+        scope.push();
+        scope.bind(p, 5);
+        scope.bind(q, 6);
+
+        CPPUNIT_ASSERT(scope.depth() == 2);
+        CPPUNIT_ASSERT(scope.find(p) == 5);
+        CPPUNIT_ASSERT(scope.find(q) == 6);
+        CPPUNIT_ASSERT(scope.find(view_t()) == 4);
+
+        scope.pop();
+
+        CPPUNIT_ASSERT(scope.find(p) == 3);
+        CPPUNIT_ASSERT(scope.find(q) == table_t::npos);
+
+        scope.pop();
+
+        CPPUNIT_ASSERT(scope.find(p) == table_t::npos);
+        CPPUNIT_ASSERT(scope.find(view_t()) == table_t::no_namespace);
+    }
+
+    void test_resolve()
+    {
+        const document_t doc = builder_t::parse(str(
+            "<s:Envelope xmlns:s='urn:soap' xmlns='urn:default' s:role='r' id='1'>"
+              "<Body><s:Fault xmlns:s='urn:other' xmlns=''><code xml:lang='en'/></s:Fault></Body>"
+              "<p:x p:a='1' xmlns:p='urn:soap'/>"
+            "</s:Envelope>"));
+
+        const xml::namespace_id_t soap  = doc.namespaces().find(str("urn:soap"));
+        const xml::namespace_id_t def   = doc.namespaces().find(str("urn:default"));
+        const xml::namespace_id_t other = doc.namespaces().find(str("urn:other"));
+
+        CPPUNIT_ASSERT(doc.namespaces().size() == 6);
+        CPPUNIT_ASSERT(doc.root().namespace_id() == soap);
+        CPPUNIT_ASSERT(doc.root().has_name(soap, str("Envelope")));
+        CPPUNIT_ASSERT(doc.root().local_name() == str("Envelope"));
+        CPPUNIT_ASSERT(attribute(doc.root(), "s:role").has_name(soap, str("role")));
+        CPPUNIT_ASSERT(attribute(doc.root(), "id").namespace_id() == table_t::no_namespace);
+        CPPUNIT_ASSERT(attribute(doc.root(), "xmlns:s").namespace_id() == table_t::xmlns_namespace);
+
+        const element_t& body  = child(doc.root(), 0);
+        const element_t& fault = child(body, 0);
+        const element_t& code  = child(fault, 0);
+
+        CPPUNIT_ASSERT(body.has_name(def, str("Body")));
+        CPPUNIT_ASSERT(fault.has_name(other, str("Fault")));
+        CPPUNIT_ASSERT(code.has_name(table_t::no_namespace, str("code")));
+        CPPUNIT_ASSERT(attribute(code, "xml:lang").has_name(table_t::xml_namespace, str("lang")));
+
+        const element_t& x = child(doc.root(), 1);
+
+        CPPUNIT_ASSERT(x.namespace_id() == soap);
+        CPPUNIT_ASSERT(attribute(x, "p:a").namespace_id() == soap);
+
+        const string_t unresolved = str("<p:a q:b='1'/>");
+        result_t ignored = builder_t::try_parse(unresolved.data(), unresolved.data() + unresolved.size(),
+            false, reader_t::parse_no_namespaces);
+
+        CPPUNIT_ASSERT(ignored.has_value());
+        CPPUNIT_ASSERT(ignored.value().root().namespace_id() == table_t::no_namespace);
+    }
+
+    void test_errors()
+    {
+        const char* const invalid[] = {
+            "<p:a/>",
+            "<a p:b='1'/>",
+            "<a><p:b xmlns:p='u'/><p:c/></a>",
+            "<a xmlns:p=''/>",
+            "<a xmlns:xmlns='u'/>",
+            "<a xmlns:xml='u'/>",
+            "<a xmlns='http://www.w3.org/XML/1998/namespace'/>",
+            "<a xmlns:p='u' xmlns:q='u' p:x='1' q:x='2'/>",
+            "<xmlns:a/>"
+        };
+
+        for (const char* input : invalid) {
+            const string_t document = str(input);
+            result_t result = builder_t::try_parse(document.data(), document.data() + document.size());
+
+            CPPUNIT_ASSERT(!result);
+            CPPUNIT_ASSERT(result.error().code() == reader_t::invalid_namespace);
+        }
+
+        const string_t undeclared = str("<a xmlns='u'><b xmlns=''/></a>");
+
+        CPPUNIT_ASSERT(builder_t::try_parse(undeclared.data(), undeclared.data() + undeclared.size()).has_value());
+    }
+
+    void test_copy()
+    {
+        const document_t doc = builder_t::parse(str("<a xmlns='urn:a'><b/></a>"));
+        const document_t copy(doc);
+        const xml::namespace_id_t id = copy.namespaces().find(str("urn:a"));
+
+        CPPUNIT_ASSERT(id == doc.root().namespace_id());
+        CPPUNIT_ASSERT(child(copy.root(), 0).has_name(id, str("b")));
+        CPPUNIT_ASSERT(copy.namespaces().uri(id) == str("urn:a"));
+    }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(test_namespace<char>);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_namespace<char16_t>);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_namespace<char32_t>);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_namespace<wchar_t>);
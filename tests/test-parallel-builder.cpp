@@ -0,0 +1,247 @@
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <string>
+#include <stdexcept>
+
+#include "parallel-builder.h"
+
+template <typename charT>
+class test_parallel_builder : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE( test_parallel_builder );
+    CPPUNIT_TEST( test_small );
+    CPPUNIT_TEST( test_large );
+    CPPUNIT_TEST( test_splits_in_markup );
+    CPPUNIT_TEST( test_errors );
+    CPPUNIT_TEST( test_namespaces );
+    CPPUNIT_TEST( test_encoding );
+    CPPUNIT_TEST( test_flags );
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    typedef xml::basic_parallel_builder<charT> parallel_t;
+    typedef xml::basic_builder<charT>          builder_t;
+    typedef typename builder_t::document_t     document_t;
+    typedef typename builder_t::element_t      element_t;
+    typedef typename element_t::table_t        table_t;
+    typedef typename builder_t::reader_t       reader_t;
+    typedef xml::basic_text<charT>             text_t;
+    typedef std::basic_string<charT>           string_t;
+
+    static string_t str(const std::string& ascii)
+    {
+        return string_t(ascii.begin(), ascii.end());
+    }
+
+    static void check(const element_t& expected, const element_t& actual,
+                      const table_t* expectedNamespaces = nullptr, const table_t* actualNamespaces = nullptr)
+    {
+        CPPUNIT_ASSERT(expected.name() == actual.name());
+        CPPUNIT_ASSERT(expected.attributes().size() == actual.attributes().size());
+        CPPUNIT_ASSERT(expected.size() == actual.size());
+
+        if (expectedNamespaces != nullptr)
+            CPPUNIT_ASSERT(expectedNamespaces->uri(expected.namespace_id()) == actualNamespaces->uri(actual.namespace_id()));
+
+        for (auto i = expected.attributes().begin(), j = actual.attributes().begin(); i != expected.attributes().end(); ++i, ++j) {
+            CPPUNIT_ASSERT(i->name() == j->name());
+            CPPUNIT_ASSERT(i->value() == j->value());
+
+            if (expectedNamespaces != nullptr)
+                CPPUNIT_ASSERT(expectedNamespaces->uri(i->namespace_id()) == actualNamespaces->uri(j->namespace_id()));
+        }
+
+        for (auto i = expected.begin(), j = actual.begin(); i != expected.end(); ++i, ++j) {
+            CPPUNIT_ASSERT(i->type() == j->type());
+
+            if (xml::basic_string_view<charT>(i->type()).equals("element"))
+                check(static_cast<const element_t&>(*i), static_cast<const element_t&>(*j), expectedNamespaces, actualNamespaces);
+            else
+                CPPUNIT_ASSERT(static_cast<const text_t&>(*i).data() == static_cast<const text_t&>(*j).data());
+        }
+    }
+
+    static string_t document(const std::string& record, size_t count)
+    {
+        std::string content = "<?xml version='1.0' standalone='yes'?>\n<!DOCTYPE root>\n<root>\n";
+
+        for (size_t i = 0; i < count; ++i)
+            content += "<record id='" + std::to_string(i) + "'>" + record + "</record>\n";
+
+        return str(content + "</root>\n<!-- end -->\n");
+    }
+
+    void test_small()
+    {
+        const string_t input = str("<root a='1'><b>text</b><c/></root>");
+        const document_t doc = parallel_t::parse(input, 4);
+
+        check(builder_t::parse(input).root(), doc.root());
+    }
+
+    void test_large()
+    {
+        const string_t input = document("<name>a name</name><deep><deeper><deepest>x</deepest></deeper></deep>", 20000);
+        const document_t doc = parallel_t::parse(input, 8);
+
+        CPPUNIT_ASSERT(doc.standalone().value == builder_t::standalone_t::yes);
+        CPPUNIT_ASSERT(doc.root().size() == 2 * 20000 + 1);
+
+        check(builder_t::parse(input).root(), doc.root());
+    }
+
+    void test_splits_in_markup()
+    {
+        const string_t input = document(
+            "<!-- <a><b></b> --><![CDATA[<x><y></y>]]><?pi <z>?><v k='&lt;'/>", 20000);
+
+        for (size_t threads = 2; threads <= 16; threads *= 2) {
+            const document_t doc = parallel_t::parse(input, threads);
+
+            check(builder_t::parse(input).root(), doc.root());
+        }
+    }
+
+    void test_errors()
+    {
+        const std::string inputs[] = {
+            "<a></b>",
+            "<a/><b/>",
+            "<a>",
+            "text<a/>"
+        };
+
+        for (const std::string& input : inputs) {
+            bool thrown = false;
+
+            try {
+                parallel_t::parse(str(input), 4);
+            } catch (std::runtime_error&) {
+                thrown = true;
+            }
+
+            CPPUNIT_ASSERT(thrown);
+        }
+
+        string_t input = document("<name>a name</name>", 20000);
+
+        input.replace(input.size() / 2, 0, str("</mismatched>"));
+
+        bool thrown = false;
+
+        try {
+            parallel_t::parse(input, 8);
+        } catch (std::runtime_error&) {
+            thrown = true;
+        }
+
+        CPPUNIT_ASSERT(thrown);
+    }
+
+    void test_namespaces()
+    {
+        std::string content = "<root xmlns='urn:default' xmlns:a='urn:a' xml:lang='en'>\n";
+
+        for (size_t i = 0; i < 20000; ++i)
+            content += "<a:record id='" + std::to_string(i) + "' a:k='v' xmlns:b='urn:b'>"
+                       "<b:name b:x='1' a:x='2'>name</b:name><plain xmlns=''>text</plain><xml:space/></a:record>\n";
+
+        const string_t   input    = str(content + "</root>\n");
+        const document_t expected = builder_t::parse(input);
+
+        for (size_t threads = 1; threads <= 8; threads *= 2) {
+            const document_t doc = parallel_t::parse(input, threads);
+
+            CPPUNIT_ASSERT(doc.namespaces().uri(doc.root().namespace_id()) == str("urn:default"));
+            CPPUNIT_ASSERT(doc.namespaces().size() == expected.namespaces().size());
+
+            check(expected.root(), doc.root(), &expected.namespaces(), &doc.namespaces());
+        }
+
+        string_t unbound = input;
+
+        unbound.replace(unbound.size() / 2, 0, str("<c:unbound/>"));
+
+        bool thrown = false;
+
+        try {
+            parallel_t::parse(unbound, 4);
+        } catch (std::runtime_error&) {
+            thrown = true;
+        }
+
+        CPPUNIT_ASSERT(thrown);
+    }
+
+    void test_encoding()
+    {
+        std::string content = "<?xml version='1.0' encoding='UTF-8'?>\n<!-- caf\xc3\xa9 -->\n<root>\n";
+
+        for (size_t i = 0; i < 20000; ++i)
+            content += "<record id='" + std::to_string(i) + "'>\xc3\xa9t\xc3\xa9 \xe2\x82\xac \xf0\x9f\x98\x80</record>\n";
+
+        const string_t input = str(content + "</root>\n");
+
+        for (size_t threads = 1; threads <= 8; threads *= 2)
+            check(builder_t::parse(input).root(), parallel_t::parse(input, threads).root());
+
+        if (sizeof(charT) != 1)
+            return;
+
+        const std::string invalid[] = {
+            std::string(content).replace(content.size() / 2, 0, "\xff") + "</root>\n",
+            std::string(content).replace(content.find("caf"), 0, "\xc3") + "</root>\n",
+            content + "\xe2\x82</root>\n"
+        };
+
+        for (const std::string& document : invalid) {
+            bool thrown = false;
+
+            try {
+                parallel_t::parse(str(document), 8);
+            } catch (std::runtime_error&) {
+                thrown = true;
+            }
+
+            CPPUNIT_ASSERT(thrown);
+        }
+    }
+
+    void test_flags()
+    {
+        std::string content = "<root>\n";
+
+        for (size_t i = 0; i < 20000; ++i)
+            content += i % 100 == 0
+                ? "<pre xml:space='preserve'> <v> </v> <w xml:space='default'> </w></pre>\n"
+                : "<record id='" + std::to_string(i) + "'> <name>a name</name> <![CDATA[x]]> </record>\n";
+
+        const string_t input = str(content + "</root>\n");
+        const unsigned flags[] = {
+            reader_t::parse_strip_whitespace,
+            reader_t::parse_trusted | reader_t::parse_strip_whitespace,
+            reader_t::parse_no_namespaces
+        };
+
+        for (unsigned flag : flags) {
+            const document_t expected = builder_t::parse(input.data(), input.data() + input.size(), false, flag);
+
+            for (size_t threads = 1; threads <= 8; threads *= 2)
+                check(expected.root(), parallel_t::parse(input, threads, flag).root());
+        }
+
+        string_t references = input;
+
+        references.insert(references.find(str("\n<record"), references.size() / 2) + 1, str("<a>&#32;</a><b><![CDATA[ ]]></b>"));
+
+        check(builder_t::parse(references.data(), references.data() + references.size(), false, reader_t::parse_strip_whitespace).root(),
+              parallel_t::parse(references, 8, reader_t::parse_strip_whitespace).root());
+
+        CPPUNIT_ASSERT(parallel_t::parse(input, 8, reader_t::parse_strip_whitespace).root().size() == 20000);
+    }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(test_parallel_builder<char>);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_parallel_builder<char16_t>);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_parallel_builder<char32_t>);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_parallel_builder<wchar_t>);
@@ -0,0 +1,111 @@
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <string>
+
+#include "pattern.h"
+
+template <typename charT>
+class test_pattern : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE( test_pattern );
+    CPPUNIT_TEST( test_matches );
+    CPPUNIT_TEST( test_classes );
+    CPPUNIT_TEST( test_errors );
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    typedef xml::basic_pattern<charT>      pattern_t;
+    typedef typename pattern_t::result_t   result_t;
+    typedef typename pattern_t::scratch_t  scratch_t;
+    typedef typename pattern_t::reader_t   reader_t;
+    typedef std::basic_string<charT>       string_t;
+
+    static string_t str(const std::string& ascii)
+    {
+        return string_t(ascii.begin(), ascii.end());
+    }
+
+    static bool matches(const std::string& expression, const std::string& value)
+    {
+        return pattern_t::compile(str(expression)).matches(str(value));
+    }
+
+    void test_matches()
+    {
+        CPPUNIT_ASSERT(matches("[0-9]{3}-[A-Z]{2}", "123-AB"));
+        CPPUNIT_ASSERT(!matches("[0-9]{3}-[A-Z]{2}", "123-ABC"));
+        CPPUNIT_ASSERT(matches("a|bc*", "bccc"));
+        CPPUNIT_ASSERT(!matches("a|bc*", "ac"));
+        CPPUNIT_ASSERT(matches("(ab)+", "ababab"));
+        CPPUNIT_ASSERT(!matches("(ab)+", ""));
+        CPPUNIT_ASSERT(matches("\\d+(\\.\\d{1,2})?", "12.50"));
+        CPPUNIT_ASSERT(!matches("\\d+(\\.\\d{1,2})?", "12.500"));
+        CPPUNIT_ASSERT(matches("a{2,}", "aaaa"));
+        CPPUNIT_ASSERT(!matches("a{2,}", "a"));
+        CPPUNIT_ASSERT(matches("", ""));
+        CPPUNIT_ASSERT(!matches("", "a"));
+        CPPUNIT_ASSERT(matches(".*", "anything"));
+
+        const pattern_t pattern = pattern_t::compile(str("(a|b)*abb"));
+        scratch_t       scratch;
+
+        CPPUNIT_ASSERT(pattern.matches(str("babaabb"), scratch));
+        CPPUNIT_ASSERT(!pattern.matches(str("babaab"), scratch));
+        CPPUNIT_ASSERT(pattern.matches(str(std::string(10000, 'a') + "bb"), scratch));
+    }
+
+    void test_classes()
+    {
+        CPPUNIT_ASSERT(matches("[a-z-[aeiou]]+", "bcd"));
+        CPPUNIT_ASSERT(!matches("[a-z-[aeiou]]+", "bad"));
+        CPPUNIT_ASSERT(matches("\\p{Lu}\\p{Ll}*", "Hello"));
+        CPPUNIT_ASSERT(!matches("\\p{Lu}\\p{Ll}*", "hello"));
+        CPPUNIT_ASSERT(matches("\\P{N}+", "abc"));
+        CPPUNIT_ASSERT(matches("\\p{IsBasicLatin}+", "abc"));
+        CPPUNIT_ASSERT(matches("\\i\\c*", "x1"));
+        CPPUNIT_ASSERT(!matches("\\i\\c*", "1x"));
+        CPPUNIT_ASSERT(matches("\\w+", "ab1"));
+        CPPUNIT_ASSERT(!matches("\\w+", "a_b"));
+        CPPUNIT_ASSERT(matches("[\\s]", " "));
+        CPPUNIT_ASSERT(matches("[a-]*", "a-a"));
+        CPPUNIT_ASSERT(matches("[^a]", "b"));
+        CPPUNIT_ASSERT(!matches("[^a]", "a"));
+    }
+
+    void test_errors()
+    {
+        const char* const invalid[] = {
+            "(a", "a)", "[a", "a{2,1}", "\\q", "*a", "[z-a]", "\\p{Foo}"
+        };
+
+        for (const char* input : invalid) {
+            const string_t expression = str(input);
+
+            CPPUNIT_ASSERT(!pattern_t::try_compile(expression));
+        }
+
+        const string_t expression = str("ab)");
+        result_t result = pattern_t::try_compile(expression);
+
+        CPPUNIT_ASSERT(!result);
+        CPPUNIT_ASSERT(result.error().code() == reader_t::invalid_attribute_value);
+        CPPUNIT_ASSERT(result.error().offset() == 2);
+
+        bool thrown = false;
+
+        try {
+            pattern_t::compile(str("[a"));
+        } catch (typename pattern_t::exception_t& e) {
+            thrown = true;
+
+            CPPUNIT_ASSERT(e.errCode() == reader_t::invalid_attribute_value);
+        }
+
+        CPPUNIT_ASSERT(thrown);
+    }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(test_pattern<char>);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_pattern<char16_t>);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_pattern<char32_t>);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_pattern<wchar_t>);
@@ -0,0 +1,243 @@
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <string>
+#include <algorithm>
+
+#include "push-parser.h"
+#include "builder.h"
+
+template <typename charT>
+class recording_handler : public xml::basic_sax_handler<charT>
+{
+public:
+    typedef typename xml::basic_sax_handler<charT>::view_t view_t;
+    typedef std::basic_string<charT>                       string_t;
+
+    bool declaration(const view_t& name, const view_t& value)
+    {
+        return record('D', name, value);
+    }
+
+    bool doctype(const view_t& name, const view_t& value)
+    {
+        return record('T', name, value);
+    }
+
+    bool start_element(const view_t& name)
+    {
+        return record('S', name, view_t());
+    }
+
+    bool attribute(const view_t& name, const view_t& value)
+    {
+        return record('A', name, value);
+    }
+
+    bool end_element(const view_t& name)
+    {
+        return record('E', name, view_t());
+    }
+
+    bool text(const view_t& value)
+    {
+        return record('X', view_t(), value);
+    }
+
+    bool cdata(const view_t& value)
+    {
+        return record('C', view_t(), value);
+    }
+
+    bool comment(const view_t& value)
+    {
+        return record('M', view_t(), value);
+    }
+
+    bool processing_instruction(const view_t& target, const view_t& value)
+    {
+        return record('P', target, value);
+    }
+
+    bool record(char kind, const view_t& name, const view_t& value)
+    {
+        mEvents.push_back(kind);
+        mEvents.append(name.begin(), name.end());
+        mEvents.push_back('|');
+        mEvents.append(value.begin(), value.end());
+        mEvents.push_back('\n');
+        return true;
+    }
+
+    string_t mEvents;
+};
+
+template <typename charT>
+class test_push_parser : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE( test_push_parser );
+    CPPUNIT_TEST( test_chunks );
+    CPPUNIT_TEST( test_errors );
+    CPPUNIT_TEST( test_builder );
+    CPPUNIT_TEST( test_byte_order_mark );
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    typedef xml::basic_sax_parser<charT>             sax_parser_t;
+    typedef recording_handler<charT>                 handler_t;
+    typedef xml::basic_push_parser<charT, handler_t> parser_t;
+    typedef typename parser_t::reader_t              reader_t;
+    typedef std::basic_string<charT>                 string_t;
+
+    static string_t str(const std::string& ascii)
+    {
+        return string_t(ascii.begin(), ascii.end());
+    }
+
+    void test_chunks()
+    {
+        const string_t input = str(
+            "<?xml version=\"1.0\" encoding='UTF-8'?>\n"
+            "<!DOCTYPE root [ <!-- it's ]> --> <?pi don't ]>?> <!ELEMENT root ANY> <!ATTLIST root a CDATA \"]>\"> ]>\n"
+            "<root a=\"1\" long-attribute-name = 'a &amp; b'>\n"
+            "  some text &#x41; <empty/><child x='&lt;'>inner</child>\n"
+            "  <!-- a - comment --><![CDATA[ <x> ]] ]]]><?pi some data?\?>\n"
+            "</root>\n<!-- trailing -->\n");
+
+        sax_parser_t sax(input.data(), input.data() + input.size());
+        handler_t expected;
+
+        CPPUNIT_ASSERT(sax.parse(expected) == reader_t::end_document);
+
+        for (size_t chunk = 1; chunk <= input.size(); ++chunk) {
+            handler_t handler;
+            parser_t parser(handler);
+
+            for (size_t i = 0; i < input.size(); i += chunk)
+                CPPUNIT_ASSERT(parser.feed(input.data() + i, std::min(chunk, input.size() - i)));
+
+            CPPUNIT_ASSERT(parser.finish());
+            CPPUNIT_ASSERT(handler.mEvents == expected.mEvents);
+        }
+    }
+
+    void test_errors()
+    {
+        const char* inputs[] = {
+            "<a></b>",
+            "<a x='1' x='2'/>",
+            "<a x=1/>",
+            "<a>",
+            "<a/><b/>",
+            "text<a/>",
+            "<a><!-- -- --></a>",
+            "<1a/>",
+            "<a x='1'",
+            "<!DOCTYPE a><!DOCTYPE a><a/>",
+            ""
+        };
+
+        const typename reader_t::error_t errors[] = {
+            reader_t::mismatched_tag,
+            reader_t::duplicate_attribute,
+            reader_t::invalid_attribute,
+            reader_t::unclosed_element,
+            reader_t::multiple_roots,
+            reader_t::text_outside_root,
+            reader_t::invalid_comment,
+            reader_t::invalid_name,
+            reader_t::unexpected_end,
+            reader_t::invalid_doctype,
+            reader_t::no_root
+        };
+
+        for (size_t i = 0; i < sizeof(errors) / sizeof(errors[0]); ++i) {
+            const string_t input = str(inputs[i]);
+            handler_t handler;
+            parser_t parser(handler);
+
+            bool valid = true;
+
+            for (size_t j = 0; valid && j < input.size(); ++j)
+                valid = parser.feed(input.data() + j, 1);
+
+            CPPUNIT_ASSERT(!valid || !parser.finish());
+            CPPUNIT_ASSERT(parser.error_code() == errors[i]);
+        }
+
+        handler_t handler;
+        parser_t parser(handler);
+
+        const string_t input = str("<a>\n  </b>");
+
+        CPPUNIT_ASSERT(parser.feed(input.data(), 5));
+        CPPUNIT_ASSERT(!parser.feed(input.data() + 5, input.size() - 5));
+        CPPUNIT_ASSERT(parser.offset() == 8);
+    }
+
+    void test_builder()
+    {
+        typedef xml::basic_builder<charT>                builder_t;
+        typedef xml::basic_push_parser<charT, builder_t> builder_parser_t;
+
+        const string_t input = str("<?xml version='1.0'?><root id='1'><child>text</child><child/></root>");
+
+        builder_t builder;
+        builder_parser_t parser(builder);
+
+        for (size_t i = 0; i < input.size(); i += 7)
+            CPPUNIT_ASSERT(parser.feed(input.data() + i, std::min<size_t>(7, input.size() - i)));
+
+        CPPUNIT_ASSERT(parser.finish());
+
+        typename builder_t::document_t doc = builder.release();
+
+        CPPUNIT_ASSERT(doc.root().name() == str("root"));
+        CPPUNIT_ASSERT(doc.root().size() == 2);
+        CPPUNIT_ASSERT(doc.root().attributes().begin()->value() == str("1"));
+    }
+
+    void test_byte_order_mark()
+    {
+        static const unsigned char utf8[] = { 0xEF, 0xBB, 0xBF };
+
+        const string_t mark  = sizeof(charT) == 1 ? string_t(utf8, utf8 + 3) : string_t(1, static_cast<charT>(0xFEFF));
+        const string_t input = mark + str("<?xml version=\"1.0\"?><a x='1'>t</a>");
+
+        sax_parser_t sax(input.data(), input.data() + input.size());
+        handler_t expected;
+
+        CPPUNIT_ASSERT(sax.parse(expected) == reader_t::end_document);
+
+        for (size_t chunk = 1; chunk <= input.size(); ++chunk) {
+            handler_t handler;
+            parser_t parser(handler);
+
+            for (size_t i = 0; i < input.size(); i += chunk)
+                CPPUNIT_ASSERT(parser.feed(input.data() + i, std::min(chunk, input.size() - i)));
+
+            CPPUNIT_ASSERT(parser.finish());
+            CPPUNIT_ASSERT(handler.mEvents == expected.mEvents);
+        }
+
+        const string_t broken = mark.substr(0, mark.size() - 1) + str("<a/>");
+
+        for (size_t chunk = 1; chunk <= broken.size(); ++chunk) {
+            handler_t handler;
+            parser_t parser(handler);
+
+            bool valid = true;
+
+            for (size_t i = 0; valid && i < broken.size(); i += chunk)
+                valid = parser.feed(broken.data() + i, std::min(chunk, broken.size() - i));
+
+            CPPUNIT_ASSERT(valid == (mark.size() == 1));
+            CPPUNIT_ASSERT(!valid || parser.finish());
+            CPPUNIT_ASSERT(parser.error_code() == (valid ? reader_t::no_error : reader_t::text_outside_root));
+        }
+    }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(test_push_parser<char>);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_push_parser<char16_t>);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_push_parser<char32_t>);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_push_parser<wchar_t>);
@@ -0,0 +1,294 @@
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <string>
+
+#include "reader.h"
+#include "builder.h"
+
+template <typename charT>
+class test_reader : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE( test_reader );
+    CPPUNIT_TEST( test_tokens );
+    CPPUNIT_TEST( test_empty_element );
+    CPPUNIT_TEST( test_markup_declarations );
+    CPPUNIT_TEST( test_errors );
+    CPPUNIT_TEST( test_builder );
+    CPPUNIT_TEST( test_trusted );
+    CPPUNIT_TEST( test_whitespace );
+    CPPUNIT_TEST( test_scanner );
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    typedef xml::basic_reader<charT>  reader_t;
+    typedef xml::basic_builder<charT> builder_t;
+    typedef xml::basic_scanner<charT> scanner_t;
+    typedef std::basic_string<charT>  string_t;
+
+    static string_t str(const std::string& ascii)
+    {
+        return string_t(ascii.begin(), ascii.end());
+    }
+
+    void test_tokens()
+    {
+        const string_t input = str("<?xml version=\"1.0\"?>\n<a x='1' y=\"2\">hello<b/>world</a>\n");
+        reader_t reader(input.data(), input.data() + input.size());
+
+        CPPUNIT_ASSERT(reader.next() == reader_t::declaration);
+        CPPUNIT_ASSERT(reader.next() == reader_t::attribute);
+        CPPUNIT_ASSERT(reader.name().equals("version"));
+        CPPUNIT_ASSERT(reader.value().equals("1.0"));
+
+        CPPUNIT_ASSERT(reader.next() == reader_t::start_element);
+        CPPUNIT_ASSERT(reader.name().equals("a"));
+        CPPUNIT_ASSERT(reader.depth() == 1);
+
+        CPPUNIT_ASSERT(reader.next() == reader_t::attribute);
+        CPPUNIT_ASSERT(reader.name().equals("x"));
+        CPPUNIT_ASSERT(reader.value().equals("1"));
+
+        CPPUNIT_ASSERT(reader.next() == reader_t::attribute);
+        CPPUNIT_ASSERT(reader.name().equals("y"));
+        CPPUNIT_ASSERT(reader.value().equals("2"));
+
+        CPPUNIT_ASSERT(reader.next() == reader_t::text);
+        CPPUNIT_ASSERT(reader.value().equals("hello"));
+
+        CPPUNIT_ASSERT(reader.next() == reader_t::start_element);
+        CPPUNIT_ASSERT(reader.name().equals("b"));
+        CPPUNIT_ASSERT(reader.next() == reader_t::end_element);
+        CPPUNIT_ASSERT(reader.name().equals("b"));
+
+        CPPUNIT_ASSERT(reader.next() == reader_t::text);
+        CPPUNIT_ASSERT(reader.value().equals("world"));
+
+        CPPUNIT_ASSERT(reader.next() == reader_t::end_element);
+        CPPUNIT_ASSERT(reader.name().equals("a"));
+        CPPUNIT_ASSERT(reader.depth() == 0);
+
+        CPPUNIT_ASSERT(reader.next() == reader_t::end_document);
+        CPPUNIT_ASSERT(reader.next() == reader_t::end_document);
+    }
+
+    void test_empty_element()
+    {
+        const string_t input = str("<a />");
+        reader_t reader(input.data(), input.data() + input.size());
+
+        CPPUNIT_ASSERT(reader.next() == reader_t::start_element);
+        CPPUNIT_ASSERT(reader.next() == reader_t::end_element);
+        CPPUNIT_ASSERT(reader.name().equals("a"));
+        CPPUNIT_ASSERT(reader.next() == reader_t::end_document);
+    }
+
+    void test_markup_declarations()
+    {
+        const string_t input = str(
+            "<!DOCTYPE a [ <!ELEMENT a (#PCDATA)> <!-- > --> ]>"
+            "<a><!-- a - comment --><![CDATA[<x>]]]><?pi data?></a>");
+        reader_t reader(input.data(), input.data() + input.size());
+
+        CPPUNIT_ASSERT(reader.next() == reader_t::doctype);
+        CPPUNIT_ASSERT(reader.name().equals("a"));
+
+        CPPUNIT_ASSERT(reader.next() == reader_t::start_element);
+
+        CPPUNIT_ASSERT(reader.next() == reader_t::comment);
+        CPPUNIT_ASSERT(reader.value().equals(" a - comment "));
+
+        CPPUNIT_ASSERT(reader.next() == reader_t::cdata);
+        CPPUNIT_ASSERT(reader.value().equals("<x>]"));
+
+        CPPUNIT_ASSERT(reader.next() == reader_t::processing_instruction);
+        CPPUNIT_ASSERT(reader.name().equals("pi"));
+        CPPUNIT_ASSERT(reader.value().equals("data"));
+
+        CPPUNIT_ASSERT(reader.next() == reader_t::end_element);
+        CPPUNIT_ASSERT(reader.next() == reader_t::end_document);
+    }
+
+    void test_errors()
+    {
+        const char* inputs[] = {
+            "<a></b>",
+            "<a x='1' x='2'/>",
+            "<a x=1/>",
+            "<a>",
+            "<a/><b/>",
+            "text<a/>",
+            "<a><!-- -- --></a>",
+            "<1a/>",
+            ""
+        };
+
+        const typename reader_t::error_t errors[] = {
+            reader_t::mismatched_tag,
+            reader_t::duplicate_attribute,
+            reader_t::invalid_attribute,
+            reader_t::unclosed_element,
+            reader_t::multiple_roots,
+            reader_t::text_outside_root,
+            reader_t::invalid_comment,
+            reader_t::invalid_name,
+            reader_t::no_root
+        };
+
+        for (size_t i = 0; i < sizeof(errors) / sizeof(errors[0]); ++i) {
+            const string_t input = str(inputs[i]);
+            reader_t reader(input.data(), input.data() + input.size());
+
+            typename reader_t::token_t token;
+
+            do {
+                token = reader.next();
+            } while (token != reader_t::error && token != reader_t::end_document);
+
+            CPPUNIT_ASSERT(token == reader_t::error);
+            CPPUNIT_ASSERT(reader.error_code() == errors[i]);
+        }
+    }
+
+    void test_builder()
+    {
+        const string_t input = str(
+            "<?xml version='1.0' encoding='UTF-8' standalone='yes'?>"
+            "<root id='1'>\n  <child>text</child>\n  <child/>\n</root>");
+        typename builder_t::document_t doc = builder_t::parse(
+            input.data(), input.data() + input.size(), false, reader_t::parse_strip_whitespace);
+
+        CPPUNIT_ASSERT(doc.version().major == 1);
+        CPPUNIT_ASSERT(doc.version().minor == 0);
+        CPPUNIT_ASSERT(doc.encoding().value == builder_t::encoding_t::UTF8);
+        CPPUNIT_ASSERT(doc.standalone().value == builder_t::standalone_t::yes);
+
+        CPPUNIT_ASSERT(doc.root().name() == str("root"));
+        CPPUNIT_ASSERT(doc.root().size() == 2);
+        CPPUNIT_ASSERT(doc.root().attributes().size() == 1);
+        CPPUNIT_ASSERT(doc.root().attributes().begin()->value() == str("1"));
+
+        typedef typename builder_t::element_t element_t;
+        typedef xml::basic_text<charT>        text_t;
+
+        element_t& child = static_cast<element_t&>(doc.root().front());
+
+        CPPUNIT_ASSERT(child.name() == str("child"));
+        CPPUNIT_ASSERT(child.size() == 1);
+        CPPUNIT_ASSERT(static_cast<text_t&>(child.front()).data() == str("text"));
+
+        bool thrown = false;
+
+        try {
+            builder_t::parse(str("<a><b></a>"));
+        } catch (std::runtime_error&) {
+            thrown = true;
+        }
+
+        CPPUNIT_ASSERT(thrown);
+    }
+
+    void test_trusted()
+    {
+        const char* inputs[] = {
+            "<a x='1' x='2'><b></c></a>",
+            "<1a/>",
+            "<a><b>text</a></b>"
+        };
+
+        for (const char* ascii : inputs) {
+            const string_t input = str(ascii);
+            reader_t strict(input.data(), input.data() + input.size());
+            reader_t trusted(input.data(), input.data() + input.size(), reader_t::parse_trusted);
+
+            typename reader_t::token_t token;
+
+            do {
+                token = strict.next();
+            } while (token != reader_t::error && token != reader_t::end_document);
+
+            CPPUNIT_ASSERT(token == reader_t::error);
+
+            do {
+                token = trusted.next();
+            } while (token != reader_t::error && token != reader_t::end_document);
+
+            CPPUNIT_ASSERT(token == reader_t::end_document);
+        }
+
+        const string_t input = str("<a x='1'><b>");
+        reader_t reader(input.data(), input.data() + input.size(), reader_t::parse_trusted);
+
+        typename reader_t::token_t token;
+
+        do {
+            token = reader.next();
+        } while (token != reader_t::error && token != reader_t::end_document);
+
+        CPPUNIT_ASSERT(token == reader_t::error);
+        CPPUNIT_ASSERT(reader.error_code() == reader_t::unclosed_element);
+
+        const string_t document = str("<root id='1'><child>text</other></root>");
+        typename builder_t::document_t doc = builder_t::parse(
+            document.data(), document.data() + document.size(), false, reader_t::parse_trusted);
+
+        CPPUNIT_ASSERT(doc.root().name() == str("root"));
+        CPPUNIT_ASSERT(doc.root().size() == 1);
+    }
+
+    void test_whitespace()
+    {
+        typedef typename builder_t::element_t element_t;
+        typedef xml::basic_text<charT>        text_t;
+
+        const string_t mixed = str("<p><b>x</b> <i>y</i></p>");
+        const string_t input = str(
+            "<r>\n  <p xml:space='preserve'>   <q xml:space='default'> </q></p>\n  <s> </s>\n</r>");
+
+        const typename builder_t::document_t kept = builder_t::parse(mixed);
+
+        CPPUNIT_ASSERT(kept.root().size() == 3);
+        CPPUNIT_ASSERT(static_cast<const text_t&>(*++kept.root().begin()).data() == str(" "));
+
+        const typename builder_t::document_t all = builder_t::parse(input);
+
+        CPPUNIT_ASSERT(all.root().size() == 5);
+
+        const typename builder_t::document_t stripped = builder_t::parse(
+            input.data(), input.data() + input.size(), false, reader_t::parse_strip_whitespace);
+        const element_t& p = static_cast<const element_t&>(stripped.root().front());
+        const element_t& q = static_cast<const element_t&>(p.back());
+        const element_t& t = static_cast<const element_t&>(stripped.root().back());
+
+        CPPUNIT_ASSERT(stripped.root().size() == 2);
+        CPPUNIT_ASSERT(p.size() == 2);
+        CPPUNIT_ASSERT(static_cast<const text_t&>(p.front()).data() == str("   "));
+        CPPUNIT_ASSERT(p.preserves_space());
+        CPPUNIT_ASSERT(q.empty());
+        CPPUNIT_ASSERT(!q.preserves_space());
+        CPPUNIT_ASSERT(t.empty());
+    }
+
+    void test_scanner()
+    {
+        for (unsigned code = 1; code < 256; ++code) {
+            const charT c = static_cast<charT>(code);
+
+            for (size_t position : { 0, 5, 15, 16, 17, 31, 32, 40, 47, 48, 63, 64, 80 }) {
+                const string_t spaces = string_t(position, ' ') + c + string_t(40, 'x');
+                const string_t name   = string_t(position, 'a') + c + string_t(40, '>');
+
+                CPPUNIT_ASSERT(size_t(scanner_t::skip_whitespace(spaces.data(), spaces.data() + spaces.size()) - spaces.data()) ==
+                               position + scanner_t::is_whitespace(c));
+                CPPUNIT_ASSERT(size_t(scanner_t::find_name_end(name.data(), name.data() + name.size()) - name.data()) ==
+                               position + scanner_t::is_name_char(c));
+                CPPUNIT_ASSERT(size_t(scanner_t::find_name_delimiter(name.data(), name.data() + name.size()) - name.data()) ==
+                               position + !scanner_t::is_name_delimiter(c));
+            }
+        }
+    }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(test_reader<char>);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_reader<char16_t>);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_reader<char32_t>);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_reader<wchar_t>);
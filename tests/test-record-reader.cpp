@@ -0,0 +1,227 @@
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <string>
+#include <stdexcept>
+
+#include "record-reader.h"
+
+template <typename charT>
+class test_record_reader : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE( test_record_reader );
+    CPPUNIT_TEST( test_records );
+    CPPUNIT_TEST( test_iterator );
+    CPPUNIT_TEST( test_empty );
+    CPPUNIT_TEST( test_scratch );
+    CPPUNIT_TEST( test_ownership );
+    CPPUNIT_TEST( test_errors );
+    CPPUNIT_TEST( test_namespaces );
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    typedef xml::basic_record_reader<charT>     reader_t;
+    typedef typename reader_t::element_t        element_t;
+    typedef typename element_t::attribute_t     attribute_t;
+    typedef typename element_t::table_t         table_t;
+    typedef xml::basic_text<charT>              text_t;
+    typedef std::basic_string<charT>            string_t;
+
+    static string_t str(const std::string& ascii)
+    {
+        return string_t(ascii.begin(), ascii.end());
+    }
+
+    static string_t document(size_t count)
+    {
+        std::string content = "<?xml version='1.0'?>\n<root kind='records'>\n";
+
+        for (size_t i = 0; i < count; ++i)
+            content += "<record id='" + std::to_string(i) + "'><name>name " + std::to_string(i) + "</name><empty/></record>\n";
+
+        return str(content + "</root>\n");
+    }
+
+    void test_records()
+    {
+        const string_t input = str("<root a='1'>text<first x='y'><b>t</b></first><!-- c --><second/></root>");
+        reader_t reader(input.data(), input.data() + input.size());
+
+        CPPUNIT_ASSERT(reader.root().name() == str("root"));
+        CPPUNIT_ASSERT(reader.root().attributes().size() == 1);
+        CPPUNIT_ASSERT(reader.root().attributes().begin()->value() == str("1"));
+
+        CPPUNIT_ASSERT(reader.next());
+        CPPUNIT_ASSERT(reader.record().name() == str("first"));
+        CPPUNIT_ASSERT(reader.record().name().references());
+        CPPUNIT_ASSERT(reader.record().attributes().begin()->value() == str("y"));
+        CPPUNIT_ASSERT(reader.record().size() == 1);
+
+        const element_t& b = static_cast<const element_t&>(reader.record().front());
+
+        CPPUNIT_ASSERT(b.name() == str("b"));
+        CPPUNIT_ASSERT(static_cast<const text_t&>(b.front()).data() == str("t"));
+
+        const element_t copy(reader.record());
+
+        CPPUNIT_ASSERT(reader.next());
+        CPPUNIT_ASSERT(reader.record().name() == str("second"));
+        CPPUNIT_ASSERT(reader.record().empty());
+
+        CPPUNIT_ASSERT(!reader.next());
+        CPPUNIT_ASSERT(!reader.next());
+
+        CPPUNIT_ASSERT(copy.name() == str("first"));
+        CPPUNIT_ASSERT(!copy.name().references());
+        CPPUNIT_ASSERT(copy.size() == 1);
+    }
+
+    void test_iterator()
+    {
+        const string_t input = document(100);
+        reader_t reader(input.data(), input.data() + input.size());
+        size_t count = 0;
+
+        for (element_t& record : reader) {
+            CPPUNIT_ASSERT(record.name() == str("record"));
+            CPPUNIT_ASSERT(record.attributes().begin()->value() == str(std::to_string(count)));
+            CPPUNIT_ASSERT(record.size() == 2);
+            CPPUNIT_ASSERT(static_cast<const text_t&>(static_cast<const element_t&>(record.front()).front()).data()
+                == str("name " + std::to_string(count)));
+
+            ++count;
+        }
+
+        CPPUNIT_ASSERT(count == 100);
+    }
+
+    void test_empty()
+    {
+        const string_t input = str("<root/>");
+        reader_t reader(input.data(), input.data() + input.size());
+
+        CPPUNIT_ASSERT(reader.root().name() == str("root"));
+        CPPUNIT_ASSERT(reader.begin() == reader.end());
+    }
+
+    void test_scratch()
+    {
+        const string_t input = document(10000);
+        reader_t reader(input.data(), input.data() + input.size());
+
+        CPPUNIT_ASSERT(reader.next());
+
+        const size_t capacity = reader.scratch().capacity();
+
+        CPPUNIT_ASSERT(capacity > 0);
+        CPPUNIT_ASSERT(reader.scratch().owns(&reader.record()));
+
+        size_t count = 1;
+
+        while (reader.next()) {
+            CPPUNIT_ASSERT(reader.scratch().owns(&reader.record()));
+            ++count;
+        }
+
+        CPPUNIT_ASSERT(count == 10000);
+        CPPUNIT_ASSERT(reader.scratch().capacity() == capacity);
+    }
+
+    void test_ownership()
+    {
+        xml::arena memory;
+        element_t* inside = new (memory) xml::arena_node<element_t>(str("inside"), memory);
+        element_t* heap   = new element_t(str("heap"));
+
+        inside->emplace_element_back(str("child"));
+        inside->adopt_back(new (memory) xml::arena_node<text_t>(str("text")));
+        inside->attributes().emplace(str("k"), str("v"));
+        heap->attributes().emplace(str("k"), str("v"));
+
+        CPPUNIT_ASSERT(memory.owns(inside) && memory.owns(&inside->back()));
+        CPPUNIT_ASSERT(memory.owns(&*inside->attributes().begin()));
+        CPPUNIT_ASSERT(!memory.owns(heap) && !memory.owns(&inside->front()));
+        CPPUNIT_ASSERT(!memory.owns(&*heap->attributes().begin()));
+
+        element_t copy(*inside);
+
+        CPPUNIT_ASSERT(copy.size() == 2 && copy.attributes().size() == 1);
+        CPPUNIT_ASSERT(!memory.owns(&copy.back()));
+        CPPUNIT_ASSERT(!memory.owns(&*copy.attributes().begin()));
+
+        const size_t capacity = memory.capacity();
+
+        delete inside;
+        delete heap;
+
+        CPPUNIT_ASSERT(memory.capacity() == capacity);
+    }
+
+    void test_errors()
+    {
+        const std::string inputs[] = {
+            "<root><a></b></root>",
+            "<root><a>",
+            "<root><a/><b></root>",
+            "<root/><other/>",
+            "<root><a:b/></root>",
+            "<root xmlns:a='urn:a'><a:b/><c a:x='1' a:x='2'/></root>"
+        };
+
+        for (const std::string& ascii : inputs) {
+            const string_t input = str(ascii);
+            bool thrown = false;
+
+            try {
+                reader_t reader(input.data(), input.data() + input.size());
+
+                while (reader.next());
+            } catch (std::runtime_error&) {
+                thrown = true;
+            }
+
+            CPPUNIT_ASSERT(thrown);
+        }
+    }
+
+    void test_namespaces()
+    {
+        const string_t input = str(
+            "<root xmlns='urn:default' xmlns:a='urn:a'>"
+            "<a:first a:k='v' k='w' xmlns:b='urn:b'><b:name/><plain xmlns=''/></a:first>"
+            "<second/><b:third xmlns:b='urn:other'/>"
+            "</root>");
+        reader_t reader(input.data(), input.data() + input.size());
+
+        CPPUNIT_ASSERT(reader.namespaces().uri(reader.root().namespace_id()) == str("urn:default"));
+
+        CPPUNIT_ASSERT(reader.next());
+        CPPUNIT_ASSERT(reader.namespaces().uri(reader.record().namespace_id()) == str("urn:a"));
+
+        for (const attribute_t& attribute : reader.record().attributes())
+            if (attribute.name() == str("a:k"))
+                CPPUNIT_ASSERT(reader.namespaces().uri(attribute.namespace_id()) == str("urn:a"));
+            else if (attribute.name() == str("k"))
+                CPPUNIT_ASSERT(attribute.namespace_id() == table_t::no_namespace);
+            else
+                CPPUNIT_ASSERT(attribute.namespace_id() == table_t::xmlns_namespace);
+
+        const element_t& name  = static_cast<const element_t&>(reader.record().front());
+        const element_t& plain = static_cast<const element_t&>(reader.record().back());
+
+        CPPUNIT_ASSERT(reader.namespaces().uri(name.namespace_id()) == str("urn:b"));
+        CPPUNIT_ASSERT(plain.namespace_id() == table_t::no_namespace);
+
+        CPPUNIT_ASSERT(reader.next());
+        CPPUNIT_ASSERT(reader.namespaces().uri(reader.record().namespace_id()) == str("urn:default"));
+
+        CPPUNIT_ASSERT(reader.next());
+        CPPUNIT_ASSERT(reader.namespaces().uri(reader.record().namespace_id()) == str("urn:other"));
+
+        CPPUNIT_ASSERT(!reader.next());
+    }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(test_record_reader<char>);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_record_reader<char16_t>);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_record_reader<char32_t>);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_record_reader<wchar_t>);
@@ -0,0 +1,110 @@
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <string>
+
+#include "sax.h"
+
+template <typename charT>
+class counting_handler : public xml::basic_sax_handler<charT>
+{
+public:
+    typedef typename xml::basic_sax_handler<charT>::view_t view_t;
+
+    counting_handler(size_t limit = size_t(-1))
+    :
+        mElements(0),
+        mAttributes(0),
+        mTexts(0),
+        mEnds(0),
+        mLimit(limit)
+    {}
+
+    bool start_element(const view_t& name)
+    {
+        return ++mElements < mLimit;
+    }
+
+    bool attribute(const view_t& name, const view_t& value)
+    {
+        ++mAttributes;
+        return true;
+    }
+
+    bool text(const view_t& value)
+    {
+        ++mTexts;
+        return true;
+    }
+
+    bool end_element(const view_t& name)
+    {
+        ++mEnds;
+        return true;
+    }
+
+    size_t mElements;
+    size_t mAttributes;
+    size_t mTexts;
+    size_t mEnds;
+    size_t mLimit;
+};
+
+template <typename charT>
+class test_sax : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE( test_sax );
+    CPPUNIT_TEST( test_events );
+    CPPUNIT_TEST( test_stop );
+    CPPUNIT_TEST( test_error );
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    typedef xml::basic_sax_parser<charT> parser_t;
+    typedef counting_handler<charT>      handler_t;
+    typedef std::basic_string<charT>     string_t;
+
+    static string_t str(const std::string& ascii)
+    {
+        return string_t(ascii.begin(), ascii.end());
+    }
+
+    void test_events()
+    {
+        const string_t input = str("<a x='1'><b y='2' z='3'>t</b><c/></a>");
+        parser_t parser(input.data(), input.data() + input.size());
+        handler_t handler;
+
+        CPPUNIT_ASSERT(parser.parse(handler) == parser_t::reader_t::end_document);
+        CPPUNIT_ASSERT(handler.mElements   == 3);
+        CPPUNIT_ASSERT(handler.mAttributes == 3);
+        CPPUNIT_ASSERT(handler.mTexts      == 1);
+        CPPUNIT_ASSERT(handler.mEnds       == 3);
+    }
+
+    void test_stop()
+    {
+        const string_t input = str("<a><b/><c/><d/></a>");
+        parser_t parser(input.data(), input.data() + input.size());
+        handler_t handler(2);
+
+        CPPUNIT_ASSERT(parser.parse(handler) == parser_t::reader_t::start_element);
+        CPPUNIT_ASSERT(handler.mElements == 2);
+        CPPUNIT_ASSERT(handler.mEnds     == 0);
+    }
+
+    void test_error()
+    {
+        const string_t input = str("<a><b></a>");
+        parser_t parser(input.data(), input.data() + input.size());
+        handler_t handler;
+
+        CPPUNIT_ASSERT(parser.parse(handler) == parser_t::reader_t::error);
+        CPPUNIT_ASSERT(parser.error_code() == parser_t::reader_t::mismatched_tag);
+        CPPUNIT_ASSERT(parser.offset() == 6);
+    }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(test_sax<char>);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_sax<char16_t>);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_sax<char32_t>);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_sax<wchar_t>);
@@ -0,0 +1,406 @@
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <string>
+#include <cstdint>
+
+#include "schema.h"
+#include "builder.h"
+
+template <typename charT>
+class test_schema : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE( test_schema );
+    CPPUNIT_TEST( test_compile );
+    CPPUNIT_TEST( test_content );
+    CPPUNIT_TEST( test_simple );
+    CPPUNIT_TEST( test_attributes );
+    CPPUNIT_TEST( test_derivation );
+    CPPUNIT_TEST( test_wildcards );
+    CPPUNIT_TEST( test_violations );
+    CPPUNIT_TEST( test_errors );
+    CPPUNIT_TEST( test_annotate );
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    typedef xml::basic_compiled_schema<charT>     schema_t;
+    typedef typename schema_t::schema_pointer_t   schema_pointer_t;
+    typedef typename schema_t::result_t           result_t;
+    typedef typename schema_t::violations_t       violations_t;
+    typedef typename schema_t::reader_t           reader_t;
+    typedef xml::basic_builder<charT>             builder_t;
+    typedef std::basic_string<charT>              string_t;
+
+    static string_t str(const std::string& ascii)
+    {
+        return string_t(ascii.begin(), ascii.end());
+    }
+
+    static schema_pointer_t compile(const std::string& components, const std::string& attributes = std::string())
+    {
+        return schema_t::compile(str(
+            "<xs:schema xmlns:xs='http://www.w3.org/2001/XMLSchema'" + attributes + ">" + components + "</xs:schema>"));
+    }
+
+    static bool valid(const schema_pointer_t& schema, const std::string& document)
+    {
+        return schema->validate(builder_t::parse(str(document)));
+    }
+
+    void test_compile()
+    {
+        const schema_pointer_t schema = compile(
+            "<xs:annotation><xs:documentation>A library</xs:documentation></xs:annotation>"
+            "<xs:element name='library' type='t:library'/>"
+            "<xs:element name='book' type='xs:string'/>"
+            "<xs:complexType name='library'><xs:sequence>"
+            "  <xs:element ref='t:book' maxOccurs='unbounded'/>"
+            "</xs:sequence></xs:complexType>",
+            " xmlns:t='urn:library' targetNamespace='urn:library'");
+
+        CPPUNIT_ASSERT(schema->declares(str("urn:library"), str("library")));
+        CPPUNIT_ASSERT(schema->declares(str("urn:library"), str("book")));
+        CPPUNIT_ASSERT(!schema->declares(str(""), str("book")));
+        CPPUNIT_ASSERT(!schema->declares(str("urn:other"), str("library")));
+
+        CPPUNIT_ASSERT(valid(schema, "<library xmlns='urn:library'><book>A</book><book>B</book></library>"));
+        CPPUNIT_ASSERT(!valid(schema, "<library xmlns='urn:library'/>"));
+        CPPUNIT_ASSERT(!valid(schema, "<library><book/></library>"));
+    }
+
+    void test_content()
+    {
+        const schema_pointer_t schema = compile(
+            "<xs:element name='book'><xs:complexType><xs:sequence>"
+            "  <xs:element name='title' type='xs:string'/>"
+            "  <xs:choice minOccurs='1' maxOccurs='3'>"
+            "    <xs:element name='chapter'/>"
+            "    <xs:element name='appendix'/>"
+            "  </xs:choice>"
+            "  <xs:group ref='index' minOccurs='0'/>"
+            "</xs:sequence></xs:complexType></xs:element>"
+            "<xs:group name='index'><xs:sequence>"
+            "  <xs:element name='index'><xs:complexType><xs:sequence>"
+            "    <xs:element name='entry' minOccurs='2' maxOccurs='unbounded'><xs:complexType/></xs:element>"
+            "  </xs:sequence></xs:complexType></xs:element>"
+            "</xs:sequence></xs:group>"
+            "<xs:element name='person'><xs:complexType><xs:all>"
+            "  <xs:element name='name' type='xs:string'/>"
+            "  <xs:element name='age' type='xs:int' minOccurs='0'/>"
+            "</xs:all></xs:complexType></xs:element>"
+            "<xs:element name='p'><xs:complexType mixed='true'><xs:sequence>"
+            "  <xs:element name='em' type='xs:string' minOccurs='0' maxOccurs='unbounded'/>"
+            "</xs:sequence></xs:complexType></xs:element>");
+
+        CPPUNIT_ASSERT(valid(schema, "<book><title>t</title><chapter/></book>"));
+        CPPUNIT_ASSERT(valid(schema, "<book>\n  <title/>\n  <chapter>any <x/></chapter><appendix/><chapter/>\n  <index><entry/><entry/></index>\n</book>"));
+        CPPUNIT_ASSERT(!valid(schema, "<book><title/></book>"));
+        CPPUNIT_ASSERT(!valid(schema, "<book><chapter/><title/></book>"));
+        CPPUNIT_ASSERT(!valid(schema, "<book><title/><chapter/><chapter/><chapter/><chapter/></book>"));
+        CPPUNIT_ASSERT(!valid(schema, "<book><title/><chapter/><index><entry/></index></book>"));
+        CPPUNIT_ASSERT(!valid(schema, "<book><title/><chapter/><index><entry>x</entry><entry/></index></book>"));
+        CPPUNIT_ASSERT(!valid(schema, "<book><title/>text<chapter/></book>"));
+
+        CPPUNIT_ASSERT(valid(schema, "<person><age>3</age><name>n</name></person>"));
+        CPPUNIT_ASSERT(valid(schema, "<person><name>n</name></person>"));
+        CPPUNIT_ASSERT(!valid(schema, "<person><age>3</age></person>"));
+        CPPUNIT_ASSERT(!valid(schema, "<person><name/><name/></person>"));
+
+        CPPUNIT_ASSERT(valid(schema, "<p>a <em>b</em> c <em/></p>"));
+        CPPUNIT_ASSERT(!valid(schema, "<p><em><em/></em></p>"));
+    }
+
+    void test_simple()
+    {
+        const schema_pointer_t schema = compile(
+            "<xs:simpleType name='code'><xs:restriction base='xs:token'>"
+            "  <xs:pattern value='[A-Z]{2}-\\d{3}'/>"
+            "</xs:restriction></xs:simpleType>"
+            "<xs:simpleType name='percent'><xs:restriction base='xs:decimal'>"
+            "  <xs:minInclusive value='0'/><xs:maxInclusive value='100'/><xs:fractionDigits value='1'/>"
+            "</xs:restriction></xs:simpleType>"
+            "<xs:simpleType name='codes'><xs:list itemType='code'/></xs:simpleType>"
+            "<xs:element name='r'><xs:complexType><xs:sequence>"
+            "  <xs:element name='code' type='code' minOccurs='0'/>"
+            "  <xs:element name='percent' type='percent' minOccurs='0'/>"
+            "  <xs:element name='codes' type='codes' minOccurs='0'/>"
+            "  <xs:element name='size' minOccurs='0' default='small'><xs:simpleType><xs:restriction base='xs:string'>"
+            "    <xs:enumeration value='small'/><xs:enumeration value='large'/>"
+            "  </xs:restriction></xs:simpleType></xs:element>"
+            "  <xs:element name='version' type='xs:string' fixed='1.0' minOccurs='0'/>"
+            "  <xs:element name='note' type='xs:string' nillable='true' minOccurs='0'/>"
+            "</xs:sequence></xs:complexType></xs:element>");
+
+        CPPUNIT_ASSERT(valid(schema, "<r><code> AB-123 </code><percent>99.5</percent><codes>AB-123 CD-456</codes></r>"));
+        CPPUNIT_ASSERT(valid(schema, "<r><size/><version>1.0</version><version/></r>") == false);
+        CPPUNIT_ASSERT(valid(schema, "<r><size/><version>1.0</version></r>"));
+        CPPUNIT_ASSERT(valid(schema, "<r><version/></r>"));
+        CPPUNIT_ASSERT(valid(schema, "<r xmlns:xsi='http://www.w3.org/2001/XMLSchema-instance'><note xsi:nil='true'/></r>"));
+        CPPUNIT_ASSERT(!valid(schema, "<r xmlns:xsi='http://www.w3.org/2001/XMLSchema-instance'><code xsi:nil='true'/></r>"));
+        CPPUNIT_ASSERT(!valid(schema, "<r xmlns:xsi='http://www.w3.org/2001/XMLSchema-instance'><note xsi:nil='true'>x</note></r>"));
+        CPPUNIT_ASSERT(!valid(schema, "<r><code>ab-123</code></r>"));
+        CPPUNIT_ASSERT(!valid(schema, "<r><percent>100.5</percent></r>"));
+        CPPUNIT_ASSERT(!valid(schema, "<r><percent>9.25</percent></r>"));
+        CPPUNIT_ASSERT(!valid(schema, "<r><codes>AB-123 x</codes></r>"));
+        CPPUNIT_ASSERT(!valid(schema, "<r><size>medium</size></r>"));
+        CPPUNIT_ASSERT(!valid(schema, "<r><version>2.0</version></r>"));
+        CPPUNIT_ASSERT(!valid(schema, "<r><code>AB-<b/>123</code></r>"));
+    }
+
+    void test_attributes()
+    {
+        const schema_pointer_t schema = compile(
+            "<xs:attribute name='lang' type='xs:language'/>"
+            "<xs:attributeGroup name='common'>"
+            "  <xs:attribute name='id' type='xs:ID' use='required'/>"
+            "  <xs:attribute ref='t:lang'/>"
+            "</xs:attributeGroup>"
+            "<xs:element name='r'><xs:complexType><xs:sequence>"
+            "  <xs:element name='n' minOccurs='0' maxOccurs='unbounded'><xs:complexType>"
+            "    <xs:attributeGroup ref='t:common'/>"
+            "    <xs:attribute name='kind' use='optional'><xs:simpleType><xs:restriction base='xs:NMTOKEN'>"
+            "      <xs:enumeration value='leaf'/><xs:enumeration value='node'/>"
+            "    </xs:restriction></xs:simpleType></xs:attribute>"
+            "    <xs:attribute name='version' type='xs:string' fixed='1'/>"
+            "  </xs:complexType></xs:element>"
+            "</xs:sequence></xs:complexType></xs:element>",
+            " xmlns:t='urn:t' targetNamespace='urn:t' elementFormDefault='qualified'");
+
+        CPPUNIT_ASSERT(valid(schema, "<r xmlns='urn:t' xmlns:t='urn:t' xml:lang='en'><n id='a' t:lang='en-US' kind=' node '/><n id='b' version='1'/></r>"));
+        CPPUNIT_ASSERT(!valid(schema, "<r xmlns='urn:t'><n/></r>"));
+        CPPUNIT_ASSERT(!valid(schema, "<r xmlns='urn:t'><n id='1a'/></r>"));
+        CPPUNIT_ASSERT(!valid(schema, "<r xmlns='urn:t'><n id='a' lang='en'/></r>"));
+        CPPUNIT_ASSERT(!valid(schema, "<r xmlns='urn:t' xmlns:t='urn:t'><n id='a' t:lang='1'/></r>"));
+        CPPUNIT_ASSERT(!valid(schema, "<r xmlns='urn:t'><n id='a' kind='root'/></r>"));
+        CPPUNIT_ASSERT(!valid(schema, "<r xmlns='urn:t'><n id='a' version='2'/></r>"));
+        CPPUNIT_ASSERT(!valid(schema, "<r xmlns='urn:t' a='1'/>"));
+    }
+
+    void test_derivation()
+    {
+        const schema_pointer_t schema = compile(
+            "<xs:complexType name='base'><xs:sequence>"
+            "  <xs:element name='a' type='xs:int'/>"
+            "</xs:sequence><xs:attribute name='x' type='xs:int'/><xs:attribute name='y'/></xs:complexType>"
+            "<xs:complexType name='extended'><xs:complexContent><xs:extension base='base'><xs:sequence>"
+            "  <xs:element name='b' type='xs:int' minOccurs='0'/>"
+            "</xs:sequence><xs:attribute name='z' type='xs:boolean'/></xs:extension></xs:complexContent></xs:complexType>"
+            "<xs:complexType name='restricted'><xs:complexContent><xs:restriction base='base'><xs:sequence>"
+            "  <xs:element name='a' type='xs:int'/>"
+            "</xs:sequence><xs:attribute name='y' use='prohibited'/></xs:restriction></xs:complexContent></xs:complexType>"
+            "<xs:complexType name='price'><xs:simpleContent><xs:extension base='xs:decimal'>"
+            "  <xs:attribute name='currency' type='xs:string' use='required'/>"
+            "</xs:extension></xs:simpleContent></xs:complexType>"
+            "<xs:complexType name='cheap'><xs:simpleContent><xs:restriction base='price'>"
+            "  <xs:maxExclusive value='10'/>"
+            "</xs:restriction></xs:simpleContent></xs:complexType>"
+            "<xs:element name='e' type='extended'/>"
+            "<xs:element name='r' type='restricted'/>"
+            "<xs:element name='p' type='price'/>"
+            "<xs:element name='c' type='cheap'/>");
+
+        CPPUNIT_ASSERT(valid(schema, "<e x='1' z='true'><a>1</a><b>2</b></e>"));
+        CPPUNIT_ASSERT(valid(schema, "<e><a>1</a></e>"));
+        CPPUNIT_ASSERT(!valid(schema, "<e><b>2</b></e>"));
+        CPPUNIT_ASSERT(valid(schema, "<r x='1'><a>1</a></r>"));
+        CPPUNIT_ASSERT(!valid(schema, "<r y='1'><a>1</a></r>"));
+        CPPUNIT_ASSERT(valid(schema, "<p currency='EUR'>12.50</p>"));
+        CPPUNIT_ASSERT(!valid(schema, "<p>12.50</p>"));
+        CPPUNIT_ASSERT(!valid(schema, "<p currency='EUR'>twelve</p>"));
+        CPPUNIT_ASSERT(valid(schema, "<c currency='EUR'>9.99</c>"));
+        CPPUNIT_ASSERT(!valid(schema, "<c currency='EUR'>12.50</c>"));
+    }
+
+    void test_wildcards()
+    {
+        const schema_pointer_t schema = compile(
+            "<xs:element name='known' type='xs:int'/>"
+            "<xs:element name='r'><xs:complexType><xs:sequence>"
+            "  <xs:element name='head'/>"
+            "  <xs:any namespace='##other' processContents='skip' minOccurs='0'/>"
+            "  <xs:any namespace='##targetNamespace' processContents='strict' minOccurs='0'/>"
+            "</xs:sequence><xs:anyAttribute namespace='urn:ext' processContents='lax'/></xs:complexType></xs:element>",
+            " targetNamespace='urn:t' elementFormDefault='qualified'");
+
+        CPPUNIT_ASSERT(valid(schema, "<r xmlns='urn:t'><head/></r>"));
+        CPPUNIT_ASSERT(valid(schema, "<r xmlns='urn:t' xmlns:e='urn:ext' e:a='1'><head/><e:x><y/></e:x><known>1</known></r>"));
+        CPPUNIT_ASSERT(!valid(schema, "<r xmlns='urn:t'><head/><known>x</known></r>"));
+        CPPUNIT_ASSERT(!valid(schema, "<r xmlns='urn:t'><head/><unknown/></r>"));
+        CPPUNIT_ASSERT(!valid(schema, "<r xmlns='urn:t' xmlns:o='urn:o' o:a='1'><head/></r>"));
+        CPPUNIT_ASSERT(!valid(schema, "<r xmlns='urn:t'><head/><x xmlns=''/></r>"));
+    }
+
+    void test_violations()
+    {
+        const schema_pointer_t schema = compile(
+            "<xs:element name='r'><xs:complexType><xs:sequence>"
+            "  <xs:element name='a' type='xs:int'/>"
+            "  <xs:element name='b'><xs:complexType><xs:attribute name='k' use='required'/></xs:complexType></xs:element>"
+            "</xs:sequence></xs:complexType></xs:element>");
+
+        const typename builder_t::document_t doc = builder_t::parse(str("<r><a x='1'>z</a><c/><b/></r>"));
+        violations_t violations;
+
+        CPPUNIT_ASSERT(!schema->validate(doc, &violations));
+        CPPUNIT_ASSERT(violations.size() == 4);
+
+        CPPUNIT_ASSERT(violations[0].code == schema_t::undeclared_attribute);
+        CPPUNIT_ASSERT(violations[0].name == str("x"));
+        CPPUNIT_ASSERT(violations[1].code == schema_t::invalid_value);
+        CPPUNIT_ASSERT(violations[1].element->name() == str("a"));
+        CPPUNIT_ASSERT(violations[2].code == schema_t::invalid_content);
+        CPPUNIT_ASSERT(violations[2].element == &doc.root());
+        CPPUNIT_ASSERT(violations[3].code == schema_t::missing_attribute);
+        CPPUNIT_ASSERT(violations[3].name == str("k"));
+
+        const schema_pointer_t recursive = compile(
+            "<xs:element name='r'><xs:complexType><xs:sequence>"
+            "  <xs:element ref='r' minOccurs='0'/>"
+            "</xs:sequence></xs:complexType></xs:element>");
+
+        const size_t depth = 10000;
+        std::string deep;
+
+        for (size_t i = 0; i < depth; ++i)
+            deep += "<r>";
+
+        deep += "<r><x/></r>";
+
+        for (size_t i = 0; i < depth; ++i)
+            deep += "</r>";
+
+        CPPUNIT_ASSERT(!valid(recursive, deep));
+        CPPUNIT_ASSERT(valid(recursive, "<r><r><r/></r></r>"));
+    }
+
+    void test_errors()
+    {
+        const char* const invalid[] = {
+            "<xs:element name='a' type='missing'/>",
+            "<xs:element name='a'/><xs:element name='a'/>",
+            "<xs:element name='a'><xs:complexType><xs:choice>"
+            "<xs:sequence><xs:element name='b'/><xs:element name='c'/></xs:sequence>"
+            "<xs:sequence><xs:element name='b'/><xs:element name='d'/></xs:sequence>"
+            "</xs:choice></xs:complexType></xs:element>",
+            "<xs:element name='a'><xs:complexType><xs:sequence>"
+            "<xs:element name='b' minOccurs='2' maxOccurs='1'/></xs:sequence></xs:complexType></xs:element>",
+            "<xs:simpleType name='s'><xs:restriction base='xs:string'><xs:pattern value='[a'/></xs:restriction></xs:simpleType>",
+            "<xs:simpleType name='s'><xs:restriction base='xs:string'><xs:maxInclusive value='1'/></xs:restriction></xs:simpleType>",
+            "<xs:simpleType name='s'><xs:restriction base='t'/></xs:simpleType>"
+            "<xs:simpleType name='t'><xs:restriction base='s'/></xs:simpleType>",
+            "<xs:group name='g'><xs:sequence><xs:group ref='g'/></xs:sequence></xs:group>"
+            "<xs:element name='a'><xs:complexType><xs:group ref='g'/></xs:complexType></xs:element>",
+            "<xs:import namespace='urn:other'/>",
+            "<xs:element name='a' type='xs:int' default='x'/>"
+        };
+
+        for (const char* input : invalid) {
+            const string_t document = str(
+                std::string("<xs:schema xmlns:xs='http://www.w3.org/2001/XMLSchema'>") + input + "</xs:schema>");
+            result_t result = schema_t::try_compile(builder_t::parse(document));
+
+            CPPUNIT_ASSERT(!result);
+            CPPUNIT_ASSERT(result.error().code() == reader_t::no_error);
+        }
+
+        CPPUNIT_ASSERT(!schema_t::try_compile(builder_t::parse(str("<schema/>"))));
+
+        bool thrown = false;
+
+        try {
+            compile("<xs:element name='a' type='xs:unknown'/>");
+        } catch (typename schema_t::exception_t& e) {
+            thrown = true;
+
+            CPPUNIT_ASSERT(e.errCode() == reader_t::no_error);
+        }
+
+        CPPUNIT_ASSERT(thrown);
+    }
+
+    typedef typename builder_t::document_t document_t;
+    typedef typename schema_t::element_t   element_t;
+    typedef typename schema_t::text_t      text_t;
+    typedef typename schema_t::attribute_t attribute_t;
+
+    static element_t& child(element_t& parent, size_t index)
+    {
+        auto it = parent.begin();
+
+        while (index-- != 0)
+            ++it;
+
+        return static_cast<element_t&>(*it);
+    }
+
+    static const xml::typed_value& typed(element_t& element)
+    {
+        return static_cast<text_t&>(*element.begin()).typed();
+    }
+
+    void test_annotate()
+    {
+        const schema_pointer_t schema = compile(
+            "<xs:element name='order'><xs:complexType><xs:sequence>"
+            "  <xs:element name='count' type='xs:int'/>"
+            "  <xs:element name='price' type='xs:decimal'/>"
+            "  <xs:element name='at' type='xs:dateTime'/>"
+            "  <xs:element name='note' type='xs:string'/>"
+            "</xs:sequence>"
+            "<xs:attribute name='id' type='xs:unsignedLong'/>"
+            "<xs:attribute name='paid' type='xs:boolean'/>"
+            "</xs:complexType></xs:element>");
+
+        document_t doc = builder_t::parse(str(
+            "<order id='123' paid='true'><count> 7 </count><price>19.99</price>"
+            "<at>2020-01-01T00:00:00Z</at><note>42</note></order>"));
+
+        CPPUNIT_ASSERT(schema->annotate(doc));
+
+        element_t& order = doc.root();
+
+        for (const attribute_t& attribute : order.attributes()) {
+            if (attribute.name() == str("id"))
+                CPPUNIT_ASSERT(attribute.typed().as_integer() == 123);
+            else
+                CPPUNIT_ASSERT(attribute.typed().as_boolean());
+        }
+
+        CPPUNIT_ASSERT(typed(child(order, 0)).as_integer() == 7);
+        CPPUNIT_ASSERT(typed(child(order, 1)).as_double() == 19.99);
+        CPPUNIT_ASSERT(typed(child(order, 2)).as_time() == int64_t(1577836800) * 1000000);
+        CPPUNIT_ASSERT(!typed(child(order, 3)).typed());
+
+        text_t& count = static_cast<text_t&>(*child(order, 0).begin());
+        text_t& price = static_cast<text_t&>(*child(order, 1).begin());
+
+        CPPUNIT_ASSERT(price.data().size() == 5);
+        CPPUNIT_ASSERT(price.typed().as_double() == 19.99);
+
+        count.data() = str("8");
+        CPPUNIT_ASSERT(!count.typed().typed());
+
+        const document_t copy(doc);
+
+        CPPUNIT_ASSERT(schema->validate(copy));
+        CPPUNIT_ASSERT(typed(child(const_cast<element_t&>(copy.root()), 1)).as_double() == 19.99);
+
+        price.data().modify();
+        CPPUNIT_ASSERT(!price.typed().typed());
+
+        document_t invalid = builder_t::parse(str(
+            "<order id='x'><count>1.5</count><price>2</price><at>2020-01-01T00:00:00</at><note/></order>"));
+        violations_t violations;
+
+        CPPUNIT_ASSERT(!schema->annotate(invalid, &violations));
+        CPPUNIT_ASSERT(violations.size() == 2);
+        CPPUNIT_ASSERT(!invalid.root().attributes().begin()->typed().typed());
+        CPPUNIT_ASSERT(!typed(child(invalid.root(), 0)).typed());
+        CPPUNIT_ASSERT(typed(child(invalid.root(), 1)).as_double() == 2);
+        CPPUNIT_ASSERT(!typed(child(invalid.root(), 2)).has_timezone());
+    }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(test_schema<char>);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_schema<char16_t>);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_schema<char32_t>);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_schema<wchar_t>);
@@ -0,0 +1,182 @@
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <string>
+#include <sstream>
+
+#include "serializer.h"
+#include "builder.h"
+
+template <typename charT>
+class test_serializer : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE( test_serializer );
+    CPPUNIT_TEST( test_compact );
+    CPPUNIT_TEST( test_indent );
+    CPPUNIT_TEST( test_escape );
+    CPPUNIT_TEST( test_large );
+    CPPUNIT_TEST( test_utf8 );
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    typedef xml::basic_serializer<charT>        serializer_t;
+    typedef typename serializer_t::settings_t   settings_t;
+    typedef typename serializer_t::scanner_t    scanner_t;
+    typedef typename serializer_t::document_t   document_t;
+    typedef typename serializer_t::element_t    element_t;
+    typedef typename serializer_t::text_t       text_t;
+    typedef xml::basic_builder<charT>           builder_t;
+    typedef std::basic_string<charT>            string_t;
+
+    static string_t str(const std::string& ascii)
+    {
+        return string_t(ascii.begin(), ascii.end());
+    }
+
+    static document_t strip(const string_t& input)
+    {
+        return builder_t::parse(input.data(), input.data() + input.size(), false, xml::basic_reader<charT>::parse_strip_whitespace);
+    }
+
+    static string_t write(const document_t& document, const settings_t& settings)
+    {
+        std::basic_ostringstream<charT> out;
+        serializer_t                    serializer(out, settings);
+
+        serializer.write(document);
+        serializer.flush();
+
+        return out.str();
+    }
+
+    void test_compact()
+    {
+        const string_t input = str(
+            "<?xml version='1.0' encoding='UTF-8' standalone='yes'?>\n"
+            "<a:root xmlns:a='urn:a' k='v'>\n  <b/>\n  <c x='1' y='2'>text<d>more</d>tail</c>\n  <a:e><f/></a:e>\n</a:root>");
+        const document_t doc = strip(input);
+        const string_t   body = str("<a:root k=\"v\" xmlns:a=\"urn:a\"><b/><c x=\"1\" y=\"2\">text<d>more</d>tail</c><a:e><f/></a:e></a:root>");
+
+        std::basic_ostringstream<charT> out;
+
+        out << doc;
+
+        CPPUNIT_ASSERT(out.str() == str("<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>") + body);
+        CPPUNIT_ASSERT(write(doc, settings_t { false, false }) == body);
+        CPPUNIT_ASSERT(write(strip(out.str()), settings_t { false, false }) == body);
+
+        std::basic_ostringstream<charT> element;
+
+        element << doc.root();
+
+        CPPUNIT_ASSERT(element.str() == body);
+    }
+
+    void test_indent()
+    {
+        const document_t doc = builder_t::parse(str("<r><a><b/><c>x<d/>y</c></a><e/></r>"));
+
+        CPPUNIT_ASSERT(write(doc, settings_t { true, false }) == str(
+            "<r>\n  <a>\n    <b/>\n    <c>x<d/>y</c>\n  </a>\n  <e/>\n</r>"));
+        CPPUNIT_ASSERT(write(builder_t::parse(str("<r>only</r>")), settings_t { true, false }) == str("<r>only</r>"));
+        CPPUNIT_ASSERT(write(strip(write(doc, settings_t { true, true })), settings_t { false, false }) ==
+                       str("<r><a><b/><c>x<d/>y</c></a><e/></r>"));
+    }
+
+    void test_escape()
+    {
+        const document_t doc = builder_t::parse(str("<r q='&quot;&lt;&amp;&gt;&apos;'>a &lt; b &amp;&amp; c &gt; \"d\" 'e'</r>"));
+
+        CPPUNIT_ASSERT(write(doc, settings_t { false, false }) == str("<r q=\"&quot;&lt;&amp;&gt;'\">a &lt; b &amp;&amp; c &gt; \"d\" 'e'</r>"));
+
+        const document_t spaces = builder_t::parse(str("<r q='a&#9;b&#10;c&#13;d'>x&#13;&#10;y\tz\n</r>"));
+        const string_t   output = write(spaces, settings_t { false, false });
+        const document_t parsed = builder_t::parse(output);
+
+        CPPUNIT_ASSERT(output == str("<r q=\"a&#9;b&#10;c&#13;d\">x&#13;\ny\tz\n</r>"));
+        CPPUNIT_ASSERT(parsed.root().attributes().begin()->value().view().equals("a\tb\nc\rd"));
+        CPPUNIT_ASSERT(static_cast<const text_t&>(parsed.root().front()).data().view().equals("x\r\ny\tz\n"));
+        CPPUNIT_ASSERT(write(parsed, settings_t { false, false }) == output);
+
+        std::string padded;
+
+        for (size_t i = 0; i != 200; ++i)
+            padded += i % 37 == 0 ? "&amp;" : i % 53 == 0 ? "&lt;" : i % 61 == 0 ? "\"" : "x";
+
+        const document_t long_text = builder_t::parse(str("<r>" + padded + "</r>"));
+
+        CPPUNIT_ASSERT(write(long_text, settings_t { false, false }) == str("<r>" + padded + "</r>"));
+
+        for (size_t length = 0; length != 80; ++length)
+            for (size_t position = 0; position <= length; ++position) {
+                string_t buffer(length, charT('a'));
+
+                if (position != length)
+                    buffer[position] = "<>&\"\t\n\r\x01"[(length + position) % 8];
+
+                CPPUNIT_ASSERT(scanner_t::find_escaped(buffer.data(), buffer.data() + length) == buffer.data() + position);
+            }
+    }
+
+    void test_large()
+    {
+        std::string input = "<items>";
+
+        for (size_t i = 0; i != 20000; ++i)
+            input += "<item id='" + std::to_string(i) + "'>&lt;" + std::to_string(i) + "&gt;</item>";
+
+        input += "</items>";
+
+        const document_t doc    = builder_t::parse(str(input));
+        const string_t   output = write(doc, settings_t { false, false });
+
+        CPPUNIT_ASSERT(output.size() > 4 * serializer_t::block_size);
+        CPPUNIT_ASSERT(output.find(str("<items><item id=\"0\">&lt;0&gt;</item><item id=\"1\">")) == 0);
+        CPPUNIT_ASSERT(write(builder_t::parse(output), settings_t { false, false }) == output);
+
+        std::string deep;
+
+        for (size_t i = 0; i != 10000; ++i)
+            deep += "<d>";
+
+        for (size_t i = 0; i != 10000; ++i)
+            deep += "</d>";
+
+        CPPUNIT_ASSERT(write(builder_t::parse(str(deep)), settings_t { false, false }).size() == 9999 * 7 + 4);
+    }
+
+    void test_utf8()
+    {
+        const std::string input = "<a t=\"caf\xC3\xA9\">na\xC3\xAFve &amp; \xE2\x82\xAC \xF0\x9D\x84\x9E</a>";
+        const document_t  doc   = builder_t::parse_utf8(input.data(), input.data() + input.size());
+
+        std::ostringstream element;
+
+        element << doc.root();
+
+        CPPUNIT_ASSERT(element.str() == input);
+
+        std::string records = "<r>";
+
+        for (size_t i = 0; i != 20000; ++i)
+            records += "<i n='" + std::to_string(i) + "'>\xC3\xA9\xE2\x82\xAC\xF0\x9D\x84\x9E</i>";
+
+        records += "</r>";
+
+        const document_t   large = builder_t::parse_utf8(records.data(), records.data() + records.size());
+        std::ostringstream out;
+
+        out << large;
+
+        const std::string output = out.str();
+        const document_t  parsed = builder_t::parse_utf8(output.data(), output.data() + output.size());
+
+        CPPUNIT_ASSERT(output.size() > 4 * serializer_t::block_size);
+        CPPUNIT_ASSERT(write(parsed, settings_t { false, false }) == write(large, settings_t { false, false }));
+        CPPUNIT_ASSERT(output.find("<i n=\"19999\">\xC3\xA9\xE2\x82\xAC\xF0\x9D\x84\x9E</i></r>") != std::string::npos);
+    }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(test_serializer<char>);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_serializer<char16_t>);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_serializer<char32_t>);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_serializer<wchar_t>);
@@ -0,0 +1,197 @@
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "simple-type.h"
+
+template <typename charT>
+class test_simple_type : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE( test_simple_type );
+    CPPUNIT_TEST( test_builtin );
+    CPPUNIT_TEST( test_temporal );
+    CPPUNIT_TEST( test_facets );
+    CPPUNIT_TEST( test_list_union );
+    CPPUNIT_TEST( test_typed );
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    typedef xml::basic_simple_type<charT>        type_t;
+    typedef typename type_t::type_pointer_t      type_pointer_t;
+    typedef typename type_t::view_t              view_t;
+    typedef std::basic_string<charT>             string_t;
+
+    static string_t str(const std::string& ascii)
+    {
+        return string_t(ascii.begin(), ascii.end());
+    }
+
+    static bool check(const std::string& type, const std::string& value)
+    {
+        const type_pointer_t builtin = type_t::builtin(str(type));
+
+        CPPUNIT_ASSERT(builtin);
+
+        return builtin->check(str(value));
+    }
+
+    static std::shared_ptr<type_t> derive(const std::string& base)
+    {
+        return std::shared_ptr<type_t>(new type_t(*type_t::builtin(str(base))));
+    }
+
+    void test_builtin()
+    {
+        CPPUNIT_ASSERT(!type_t::builtin(str("unknown")));
+
+        CPPUNIT_ASSERT(check("int", "42"));
+        CPPUNIT_ASSERT(check("int", " -7 "));
+        CPPUNIT_ASSERT(!check("int", "2147483648"));
+        CPPUNIT_ASSERT(!check("int", "1.5"));
+        CPPUNIT_ASSERT(check("decimal", "1.50"));
+        CPPUNIT_ASSERT(check("decimal", ".5"));
+        CPPUNIT_ASSERT(!check("decimal", "1e3"));
+        CPPUNIT_ASSERT(check("double", "1e3"));
+        CPPUNIT_ASSERT(check("double", "-INF"));
+        CPPUNIT_ASSERT(!check("float", "abc"));
+        CPPUNIT_ASSERT(check("boolean", "true"));
+        CPPUNIT_ASSERT(!check("boolean", "yes"));
+        CPPUNIT_ASSERT(!check("positiveInteger", "0"));
+        CPPUNIT_ASSERT(check("unsignedByte", "255"));
+        CPPUNIT_ASSERT(!check("unsignedByte", "256"));
+
+        CPPUNIT_ASSERT(check("hexBinary", "0aF9"));
+        CPPUNIT_ASSERT(!check("hexBinary", "0aF"));
+        CPPUNIT_ASSERT(check("base64Binary", "YWJj ZA=="));
+        CPPUNIT_ASSERT(!check("base64Binary", "YWJ"));
+
+        CPPUNIT_ASSERT(check("language", "en-US"));
+        CPPUNIT_ASSERT(!check("language", "1en"));
+        CPPUNIT_ASSERT(!check("NCName", "a:b"));
+        CPPUNIT_ASSERT(check("Name", "a:b"));
+        CPPUNIT_ASSERT(check("QName", "xs:int"));
+        CPPUNIT_ASSERT(check("NMTOKENS", " a  b "));
+        CPPUNIT_ASSERT(!check("NMTOKENS", "  "));
+        CPPUNIT_ASSERT(check("token", "  a   b "));
+        CPPUNIT_ASSERT(check("string", " x "));
+    }
+
+    void test_temporal()
+    {
+        CPPUNIT_ASSERT(check("date", "2024-02-29"));
+        CPPUNIT_ASSERT(!check("date", "2023-02-29"));
+        CPPUNIT_ASSERT(!check("date", "2024-13-01"));
+        CPPUNIT_ASSERT(check("dateTime", "2024-01-01T12:00:00Z"));
+        CPPUNIT_ASSERT(!check("dateTime", "2024-01-01T25:00:00"));
+        CPPUNIT_ASSERT(check("time", "24:00:00"));
+        CPPUNIT_ASSERT(check("time", "12:30:00.5+01:00"));
+        CPPUNIT_ASSERT(check("gYear", "2024"));
+        CPPUNIT_ASSERT(check("gMonthDay", "--12-25"));
+        CPPUNIT_ASSERT(check("gDay", "---31"));
+        CPPUNIT_ASSERT(check("duration", "P1Y2M3DT4H5M6.5S"));
+        CPPUNIT_ASSERT(check("duration", "-PT1M"));
+        CPPUNIT_ASSERT(!check("duration", "P"));
+        CPPUNIT_ASSERT(!check("duration", "PT"));
+        CPPUNIT_ASSERT(!check("duration", "P1S"));
+    }
+
+    void test_facets()
+    {
+        std::shared_ptr<type_t> color = derive("string");
+
+        CPPUNIT_ASSERT(color->add_enumeration(std::vector<string_t> { str("red"), str("green") }) == nullptr);
+        CPPUNIT_ASSERT(color->add_facet(str("maxLength"), str("4")) == nullptr);
+        CPPUNIT_ASSERT(color->check(str("red")));
+        CPPUNIT_ASSERT(!color->check(str("green")));
+        CPPUNIT_ASSERT(!color->check(str("blue")));
+
+        std::shared_ptr<type_t> number = derive("integer");
+        const string_t          expression = str("[0-9]*5");
+
+        CPPUNIT_ASSERT(number->add_facet(str("minExclusive"), str("10")) == nullptr);
+        CPPUNIT_ASSERT(number->add_facet(str("totalDigits"), str("3")) == nullptr);
+        CPPUNIT_ASSERT(number->add_pattern(std::vector<view_t> { view_t(expression) }) == nullptr);
+        CPPUNIT_ASSERT(!number->check(str("10")));
+        CPPUNIT_ASSERT(number->check(str("15")));
+        CPPUNIT_ASSERT(!number->check(str("1005")));
+        CPPUNIT_ASSERT(!number->check(str("16")));
+
+        CPPUNIT_ASSERT(derive("string")->add_facet(str("minInclusive"), str("1")) != nullptr);
+        CPPUNIT_ASSERT(derive("integer")->add_facet(str("maxInclusive"), str("x")) != nullptr);
+        CPPUNIT_ASSERT(derive("string")->add_facet(str("unknown"), str("1")) != nullptr);
+    }
+
+    void test_list_union()
+    {
+        const type_pointer_t list = type_t::list_of(type_t::builtin(str("int")));
+
+        CPPUNIT_ASSERT(list->check(str("1 2\n3")));
+        CPPUNIT_ASSERT(!list->check(str("1 x")));
+
+        const type_pointer_t either = type_t::union_of(std::vector<type_pointer_t> {
+            type_t::builtin(str("int")), type_t::builtin(str("boolean")) });
+
+        CPPUNIT_ASSERT(either->check(str("12")));
+        CPPUNIT_ASSERT(either->check(str("false")));
+        CPPUNIT_ASSERT(!either->check(str("maybe")));
+    }
+
+    static xml::typed_value convert(const std::string& type, const std::string& value)
+    {
+        typename type_t::scratch_t scratch;
+        xml::typed_value           typed = xml::typed_value::from_integer(1);
+
+        CPPUNIT_ASSERT(type_t::builtin(str(type))->check(str(value), scratch, &typed) || !typed.typed());
+
+        return typed;
+    }
+
+    void test_typed()
+    {
+        const int64_t second = 1000000;
+
+        CPPUNIT_ASSERT(convert("int", " -42 ").type() == xml::typed_value::integer_type);
+        CPPUNIT_ASSERT(convert("int", " -42 ").as_integer() == -42);
+        CPPUNIT_ASSERT(convert("long", "-9223372036854775808").as_integer() == INT64_MIN);
+        CPPUNIT_ASSERT(convert("unsignedLong", "18446744073709551615").type() == xml::typed_value::decimal_type);
+        CPPUNIT_ASSERT(convert("decimal", "2.50").as_double() == 2.5);
+        CPPUNIT_ASSERT(convert("double", "1e3").type() == xml::typed_value::double_type);
+        CPPUNIT_ASSERT(convert("float", "-INF").as_double() == -HUGE_VAL);
+        CPPUNIT_ASSERT(convert("boolean", "1").as_boolean());
+        CPPUNIT_ASSERT(!convert("boolean", "false").as_boolean());
+        CPPUNIT_ASSERT(convert("boolean", "false").type() == xml::typed_value::boolean_type);
+
+        CPPUNIT_ASSERT(convert("dateTime", "1970-01-01T00:00:01.5").as_time() == second * 3 / 2);
+        CPPUNIT_ASSERT(!convert("dateTime", "1970-01-01T00:00:01.5").has_timezone());
+        CPPUNIT_ASSERT(convert("dateTime", "2000-03-01T12:00:00+02:00").as_time() == (int64_t(951868800) + 10 * 3600) * second);
+        CPPUNIT_ASSERT(convert("dateTime", "2000-03-01T12:00:00+02:00").has_timezone());
+        CPPUNIT_ASSERT(convert("dateTime", "1969-12-31T23:59:59Z").as_time() == -second);
+        CPPUNIT_ASSERT(convert("date", "2024-02-29").as_time() == int64_t(19782) * 86400 * second);
+        CPPUNIT_ASSERT(convert("date", "2024-02-29").type() == xml::typed_value::date_type);
+        CPPUNIT_ASSERT(convert("time", "01:30:00+02:00").as_time() == int64_t(23) * 3600 * second + 30 * 60 * second);
+
+        CPPUNIT_ASSERT(!convert("int", "x").typed());
+        CPPUNIT_ASSERT(!convert("string", "42").typed());
+        CPPUNIT_ASSERT(!convert("duration", "P1D").typed());
+
+        typename type_t::scratch_t scratch;
+        xml::typed_value           typed;
+
+        const type_pointer_t either = type_t::union_of(std::vector<type_pointer_t> {
+            type_t::builtin(str("int")), type_t::builtin(str("boolean")) });
+
+        CPPUNIT_ASSERT(either->check(str("true"), scratch, &typed));
+        CPPUNIT_ASSERT(typed.type() == xml::typed_value::boolean_type);
+        CPPUNIT_ASSERT(type_t::list_of(type_t::builtin(str("int")))->check(str("1 2"), scratch, &typed));
+        CPPUNIT_ASSERT(!typed.typed());
+    }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(test_simple_type<char>);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_simple_type<char16_t>);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_simple_type<char32_t>);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_simple_type<wchar_t>);
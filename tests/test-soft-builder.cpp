@@ -0,0 +1,232 @@
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <string>
+
+#include "soft-builder.h"
+
+template <typename charT>
+class test_soft_builder : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE( test_soft_builder );
+    CPPUNIT_TEST( test_well_formed );
+    CPPUNIT_TEST( test_unclosed );
+    CPPUNIT_TEST( test_references );
+    CPPUNIT_TEST( test_attributes );
+    CPPUNIT_TEST( test_content );
+    CPPUNIT_TEST( test_adversarial );
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    typedef xml::basic_soft_builder<charT>   soft_t;
+    typedef typename soft_t::builder_t       builder_t;
+    typedef typename soft_t::reader_t        reader_t;
+    typedef typename soft_t::document_t      document_t;
+    typedef typename soft_t::element_t       element_t;
+    typedef typename soft_t::diagnostics_t   diagnostics_t;
+    typedef xml::basic_text<charT>           text_t;
+    typedef std::basic_string<charT>         string_t;
+    typedef typename element_t::string_ref_t string_ref_t;
+
+    static string_t str(const std::string& ascii)
+    {
+        return string_t(ascii.begin(), ascii.end());
+    }
+
+    static const element_t& child(const element_t& parent, size_t index)
+    {
+        auto it = parent.begin();
+
+        while (index-- != 0)
+            ++it;
+
+        return static_cast<const element_t&>(*it);
+    }
+
+    static string_ref_t text(const element_t& parent, size_t index)
+    {
+        auto it = parent.begin();
+
+        while (index-- != 0)
+            ++it;
+
+        return static_cast<const text_t&>(*it).data();
+    }
+
+    static string_ref_t attribute(const element_t& element, const std::string& name)
+    {
+        for (auto it = element.attributes().begin(); it != element.attributes().end(); ++it)
+            if (it->name() == str(name))
+                return it->value();
+
+        CPPUNIT_ASSERT(false);
+
+        return string_ref_t();
+    }
+
+    static bool reported(const diagnostics_t& diagnostics, typename reader_t::error_t code, size_t offset)
+    {
+        for (const typename soft_t::diagnostic_t& diagnostic : diagnostics)
+            if (diagnostic.code == code && diagnostic.offset == offset)
+                return true;
+
+        return false;
+    }
+
+    void test_well_formed()
+    {
+        const string_t input = str(
+            "<?xml version='1.0' standalone='yes'?>\n<!DOCTYPE r [<!ELEMENT r ANY>]>\n"
+            "<r k='v &amp; w'><!-- c --><a>t&lt;</a><?pi x?><![CDATA[<raw>]]></r>\n");
+        diagnostics_t diagnostics;
+        const document_t doc = soft_t::parse(input, diagnostics);
+        const document_t expected = builder_t::parse(input);
+
+        CPPUNIT_ASSERT(diagnostics.empty());
+        CPPUNIT_ASSERT(doc.standalone().value == builder_t::standalone_t::yes);
+        CPPUNIT_ASSERT(doc.root().name() == expected.root().name());
+        CPPUNIT_ASSERT(attribute(doc.root(), "k") == str("v & w"));
+        CPPUNIT_ASSERT(doc.root().size() == 2);
+        CPPUNIT_ASSERT(text(child(doc.root(), 0), 0) == str("t<"));
+        CPPUNIT_ASSERT(text(doc.root(), 1) == str("<raw>"));
+    }
+
+    void test_unclosed()
+    {
+        diagnostics_t diagnostics;
+        const document_t doc = soft_t::parse(str("<r><a><b>x</a><c></z></r><d>"), diagnostics);
+
+        CPPUNIT_ASSERT(doc.root().size() == 3);
+        CPPUNIT_ASSERT(child(doc.root(), 0).name() == str("a"));
+        CPPUNIT_ASSERT(child(child(doc.root(), 0), 0).name() == str("b"));
+        CPPUNIT_ASSERT(text(child(child(doc.root(), 0), 0), 0) == str("x"));
+        CPPUNIT_ASSERT(child(doc.root(), 1).name() == str("c"));
+        CPPUNIT_ASSERT(child(doc.root(), 1).empty());
+        CPPUNIT_ASSERT(child(doc.root(), 2).name() == str("d"));
+
+        CPPUNIT_ASSERT(diagnostics.size() == 5);
+        CPPUNIT_ASSERT(reported(diagnostics, reader_t::mismatched_tag, 10));
+        CPPUNIT_ASSERT(reported(diagnostics, reader_t::mismatched_tag, 17));
+        CPPUNIT_ASSERT(reported(diagnostics, reader_t::mismatched_tag, 21));
+        CPPUNIT_ASSERT(reported(diagnostics, reader_t::multiple_roots, 25));
+        CPPUNIT_ASSERT(reported(diagnostics, reader_t::unclosed_element, 28));
+
+        diagnostics.clear();
+
+        const document_t appended = soft_t::parse(str("<r/><s/>t"), diagnostics);
+
+        CPPUNIT_ASSERT(appended.root().size() == 2);
+        CPPUNIT_ASSERT(child(appended.root(), 0).name() == str("s"));
+        CPPUNIT_ASSERT(text(appended.root(), 1) == str("t"));
+        CPPUNIT_ASSERT(reported(diagnostics, reader_t::multiple_roots, 4));
+        CPPUNIT_ASSERT(reported(diagnostics, reader_t::text_outside_root, 8));
+        CPPUNIT_ASSERT(diagnostics.size() == 2);
+
+        diagnostics.clear();
+
+        const document_t empty = soft_t::parse(str("text"), diagnostics);
+
+        CPPUNIT_ASSERT(empty.root().name().empty());
+        CPPUNIT_ASSERT(reported(diagnostics, reader_t::text_outside_root, 0));
+        CPPUNIT_ASSERT(reported(diagnostics, reader_t::no_root, 4));
+    }
+
+    void test_references()
+    {
+        diagnostics_t diagnostics;
+        const document_t doc = soft_t::parse(str("<r k='1 & 2'>R&D &amp; &#65; &bogus; &#xD800;</r>"), diagnostics);
+
+        CPPUNIT_ASSERT(attribute(doc.root(), "k") == str("1 & 2"));
+        CPPUNIT_ASSERT(text(doc.root(), 0) == str("R&D & A &bogus; &#xD800;"));
+
+        CPPUNIT_ASSERT(diagnostics.size() == 4);
+        CPPUNIT_ASSERT(reported(diagnostics, reader_t::invalid_reference, 8));
+        CPPUNIT_ASSERT(reported(diagnostics, reader_t::invalid_reference, 14));
+        CPPUNIT_ASSERT(reported(diagnostics, reader_t::invalid_reference, 29));
+        CPPUNIT_ASSERT(reported(diagnostics, reader_t::invalid_reference, 37));
+    }
+
+    void test_attributes()
+    {
+        diagnostics_t diagnostics;
+        const document_t doc = soft_t::parse(str("<r a=1 b = two checked c='x' c='y' d=\"q\"/>"), diagnostics);
+
+        CPPUNIT_ASSERT(doc.root().attributes().size() == 5);
+        CPPUNIT_ASSERT(attribute(doc.root(), "a") == str("1"));
+        CPPUNIT_ASSERT(attribute(doc.root(), "b") == str("two"));
+        CPPUNIT_ASSERT(attribute(doc.root(), "checked").empty());
+        CPPUNIT_ASSERT(attribute(doc.root(), "c") == str("x"));
+        CPPUNIT_ASSERT(attribute(doc.root(), "d") == str("q"));
+
+        CPPUNIT_ASSERT(diagnostics.size() == 4);
+        CPPUNIT_ASSERT(reported(diagnostics, reader_t::invalid_attribute, 5));
+        CPPUNIT_ASSERT(reported(diagnostics, reader_t::invalid_attribute, 11));
+        CPPUNIT_ASSERT(reported(diagnostics, reader_t::invalid_attribute, 22));
+        CPPUNIT_ASSERT(reported(diagnostics, reader_t::duplicate_attribute, 29));
+
+        diagnostics.clear();
+
+        const document_t unterminated = soft_t::parse(str("<r><a k='v<b/></r>"), diagnostics);
+
+        CPPUNIT_ASSERT(attribute(child(unterminated.root(), 0), "k") == str("v"));
+        CPPUNIT_ASSERT(child(child(unterminated.root(), 0), 0).name() == str("b"));
+        CPPUNIT_ASSERT(reported(diagnostics, reader_t::invalid_attribute_value, 10));
+    }
+
+    void test_content()
+    {
+        diagnostics_t diagnostics;
+        const document_t doc = soft_t::parse(str("<r>1 < 2 <a-b%c>x</a-b%c><!-- -- --></r>"), diagnostics);
+
+        CPPUNIT_ASSERT(text(doc.root(), 0) == str("1 < 2 "));
+        CPPUNIT_ASSERT(child(doc.root(), 1).name() == str("a-b%c"));
+        CPPUNIT_ASSERT(text(child(doc.root(), 1), 0) == str("x"));
+
+        CPPUNIT_ASSERT(diagnostics.size() == 4);
+        CPPUNIT_ASSERT(reported(diagnostics, reader_t::invalid_tag, 5));
+        CPPUNIT_ASSERT(reported(diagnostics, reader_t::invalid_name, 13));
+        CPPUNIT_ASSERT(reported(diagnostics, reader_t::invalid_name, 22));
+        CPPUNIT_ASSERT(reported(diagnostics, reader_t::invalid_comment, 30));
+
+        diagnostics.clear();
+
+        const document_t truncated = soft_t::parse(str("<r><a>x<!-- never closed"), diagnostics);
+
+        CPPUNIT_ASSERT(text(child(truncated.root(), 0), 0) == str("x"));
+        CPPUNIT_ASSERT(reported(diagnostics, reader_t::unexpected_end, 24));
+        CPPUNIT_ASSERT(reported(diagnostics, reader_t::unclosed_element, 24));
+    }
+
+    void test_adversarial()
+    {
+        const size_t count = 10000;
+        std::string ascii = "<r>";
+
+        for (size_t i = 0; i < count; ++i)
+            ascii += "<a>";
+
+        for (size_t i = 0; i < count; ++i)
+            ascii += "</b>&";
+
+        ascii += std::string(count, '&') + "</r>";
+
+        diagnostics_t diagnostics;
+        const document_t doc = soft_t::parse(str(ascii), diagnostics);
+
+        CPPUNIT_ASSERT(diagnostics.size() == 3 * count + 1);
+        CPPUNIT_ASSERT(doc.root().size() == 1);
+
+        const element_t* deepest = &doc.root();
+
+        for (size_t i = 0; i < count; ++i)
+            deepest = &child(*deepest, 0);
+
+        CPPUNIT_ASSERT(deepest->size() == count);
+        CPPUNIT_ASSERT(text(*deepest, 0) == str("&"));
+        CPPUNIT_ASSERT(text(*deepest, count - 1) == str(std::string(count + 1, '&')));
+    }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(test_soft_builder<char>);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_soft_builder<char16_t>);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_soft_builder<char32_t>);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_soft_builder<wchar_t>);
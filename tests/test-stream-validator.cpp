@@ -0,0 +1,219 @@
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <string>
+#include <algorithm>
+
+#include "stream-validator.h"
+#include "push-parser.h"
+#include "sax.h"
+#include "builder.h"
+
+template <typename charT>
+class test_stream_validator : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE( test_stream_validator );
+    CPPUNIT_TEST( test_sax );
+    CPPUNIT_TEST( test_push );
+    CPPUNIT_TEST( test_namespaces );
+    CPPUNIT_TEST( test_violations );
+    CPPUNIT_TEST( test_errors );
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    typedef xml::basic_compiled_schema<charT>      schema_t;
+    typedef typename schema_t::schema_pointer_t    schema_pointer_t;
+    typedef typename schema_t::violations_t        violations_t;
+    typedef xml::basic_stream_validator<charT>     validator_t;
+    typedef xml::basic_sax_parser<charT>           parser_t;
+    typedef xml::basic_push_parser<charT, validator_t> push_parser_t;
+    typedef typename parser_t::reader_t            reader_t;
+    typedef xml::basic_builder<charT>              builder_t;
+    typedef std::basic_string<charT>               string_t;
+
+    static string_t str(const std::string& ascii)
+    {
+        return string_t(ascii.begin(), ascii.end());
+    }
+
+    static schema_pointer_t compile()
+    {
+        return schema_t::compile(str(
+            "<xs:schema xmlns:xs='http://www.w3.org/2001/XMLSchema' targetNamespace='urn:orders'"
+            "           xmlns:o='urn:orders' elementFormDefault='qualified'>"
+            "<xs:element name='orders'><xs:complexType><xs:sequence>"
+            "  <xs:element ref='o:order' maxOccurs='unbounded'/>"
+            "</xs:sequence></xs:complexType></xs:element>"
+            "<xs:element name='order'><xs:complexType><xs:sequence>"
+            "  <xs:element name='item' type='xs:string' maxOccurs='unbounded'/>"
+            "  <xs:element name='total' type='xs:decimal'/>"
+            "</xs:sequence><xs:attribute name='id' type='xs:positiveInteger' use='required'/></xs:complexType></xs:element>"
+            "</xs:schema>"));
+    }
+
+    static bool valid(const schema_pointer_t& schema, const std::string& document)
+    {
+        const string_t input = str(document);
+        validator_t    validator(*schema);
+        parser_t       parser(input.data(), input.data() + input.size());
+
+        return parser.parse(validator) == reader_t::end_document && validator.valid();
+    }
+
+    void test_sax()
+    {
+        const schema_pointer_t schema = compile();
+
+        const char* const documents[] = {
+            "<orders xmlns='urn:orders'><order id='1'><item>a</item><total>1.5</total></order></orders>",
+            "<?xml version='1.0'?>\n<!-- orders -->\n<o:orders xmlns:o='urn:orders'>\n"
+            "  <o:order id='2'><o:item>a &amp; b</o:item><o:item/><o:total><![CDATA[2]]>.&#x35;</o:total></o:order>\n"
+            "</o:orders>\n",
+            "<orders xmlns='urn:orders'/>",
+            "<orders xmlns='urn:orders'><order><item/><total>1</total></order></orders>",
+            "<orders xmlns='urn:orders'><order id='0'><item/><total>1</total></order></orders>",
+            "<orders xmlns='urn:orders'><order id='1'><total>1</total></order></orders>",
+            "<orders xmlns='urn:orders'><order id='1'><item/><total>x</total></order></orders>",
+            "<orders xmlns='urn:orders'><order id='1'><item><b/></item><total>1</total></order></orders>",
+            "<orders><order id='1'><item/><total>1</total></order></orders>"
+        };
+
+        for (const char* document : documents)
+            CPPUNIT_ASSERT(valid(schema, document) == schema->validate(builder_t::parse(str(document))));
+
+        CPPUNIT_ASSERT(valid(schema, documents[0]));
+        CPPUNIT_ASSERT(valid(schema, documents[1]));
+        CPPUNIT_ASSERT(!valid(schema, documents[2]));
+    }
+
+    void test_push()
+    {
+        const schema_pointer_t schema = compile();
+        std::string document = "<orders xmlns='urn:orders'>";
+
+        for (size_t i = 0; i < 1000; ++i)
+            document += "<order id='" + std::to_string(i + 1) + "'><item>x &lt; y</item><total>3.25</total></order>";
+
+        document += "</orders>";
+
+        const string_t input = str(document);
+
+        for (size_t chunk : { size_t(1), size_t(7), input.size() }) {
+            validator_t   validator(*schema);
+            push_parser_t parser(validator);
+
+            for (size_t i = 0; i < input.size(); i += chunk)
+                CPPUNIT_ASSERT(parser.feed(input.data() + i, std::min(chunk, input.size() - i)));
+
+            CPPUNIT_ASSERT(parser.finish());
+            CPPUNIT_ASSERT(validator.valid());
+        }
+
+        const string_t invalid = str("<orders xmlns='urn:orders'><order id='1'><total>1</total></order>");
+        validator_t    validator(*schema);
+        push_parser_t  parser(validator);
+
+        CPPUNIT_ASSERT(!parser.feed(invalid.data(), invalid.size()));
+        CPPUNIT_ASSERT(!validator.valid());
+        CPPUNIT_ASSERT(validator.error_code() == reader_t::no_error);
+    }
+
+    void test_namespaces()
+    {
+        const schema_pointer_t schema = compile();
+
+        CPPUNIT_ASSERT(valid(schema, "<orders xmlns='urn:orders'><order xmlns='urn:orders' id='1'><item/><total>1</total></order></orders>"));
+        CPPUNIT_ASSERT(valid(schema, "<a:orders xmlns:a='urn:orders'><b:order xmlns:b='urn:orders' id='1'><a:item/><b:total>1</b:total></b:order></a:orders>"));
+        CPPUNIT_ASSERT(!valid(schema, "<a:orders xmlns:a='urn:orders'><b:order xmlns:b='urn:orders' id='1'><b:item/></b:order><b:order id='1'/></a:orders>"));
+        CPPUNIT_ASSERT(!valid(schema, "<orders xmlns='urn:orders'><order xmlns='urn:other' id='1'><item/><total>1</total></order></orders>"));
+
+        const string_t unbound = str("<orders xmlns='urn:orders'><p:order id='1'/></orders>");
+        validator_t    validator(*schema);
+        parser_t       parser(unbound.data(), unbound.data() + unbound.size());
+
+        CPPUNIT_ASSERT(parser.parse(validator) != reader_t::end_document);
+        CPPUNIT_ASSERT(validator.error_code() == reader_t::invalid_namespace);
+        CPPUNIT_ASSERT(!validator.valid());
+    }
+
+    void test_violations()
+    {
+        const schema_pointer_t schema = compile();
+        const string_t input = str(
+            "<orders xmlns='urn:orders'>"
+            "<order id='1'><item/><total>1</total></order>"
+            "<order id='x' other='1'><item/><total>1</total></order>"
+            "<order><total>y</total></order>"
+            "</orders>");
+
+        violations_t violations;
+        validator_t  validator(*schema, &violations);
+        parser_t     parser(input.data(), input.data() + input.size());
+
+        CPPUNIT_ASSERT(parser.parse(validator) == reader_t::end_document);
+        CPPUNIT_ASSERT(!validator.valid());
+        CPPUNIT_ASSERT(violations.size() == 4);
+
+        CPPUNIT_ASSERT(violations[0].code == schema_t::invalid_attribute_value);
+        CPPUNIT_ASSERT(violations[0].offset == 4);
+        CPPUNIT_ASSERT(violations[0].element == nullptr);
+        CPPUNIT_ASSERT(violations[0].name == str("id"));
+        CPPUNIT_ASSERT(violations[1].code == schema_t::undeclared_attribute);
+        CPPUNIT_ASSERT(violations[1].name == str("other"));
+        CPPUNIT_ASSERT(violations[2].code == schema_t::missing_attribute);
+        CPPUNIT_ASSERT(violations[2].offset == 7);
+        CPPUNIT_ASSERT(violations[3].code == schema_t::invalid_content);
+        CPPUNIT_ASSERT(violations[3].offset == 7);
+
+        violations.clear();
+        validator.reset();
+        parser.reset(input.data(), input.data() + input.size());
+
+        CPPUNIT_ASSERT(parser.parse(validator) == reader_t::end_document);
+        CPPUNIT_ASSERT(violations.size() == 4);
+
+        const schema_pointer_t recursive = schema_t::compile(str(
+            "<xs:schema xmlns:xs='http://www.w3.org/2001/XMLSchema'>"
+            "<xs:element name='r'><xs:complexType><xs:sequence>"
+            "  <xs:element ref='r' minOccurs='0'/>"
+            "</xs:sequence></xs:complexType></xs:element>"
+            "</xs:schema>"));
+
+        const size_t depth = 100000;
+        std::string deep;
+
+        for (size_t i = 0; i < depth; ++i)
+            deep += "<r>";
+
+        for (size_t i = 0; i < depth; ++i)
+            deep += "</r>";
+
+        CPPUNIT_ASSERT(valid(recursive, deep));
+    }
+
+    void test_errors()
+    {
+        const schema_pointer_t schema = compile();
+        const string_t reference = str("<orders xmlns='urn:orders'><order id='&bad;'/></orders>");
+        validator_t    validator(*schema);
+        parser_t       parser(reference.data(), reference.data() + reference.size());
+
+        CPPUNIT_ASSERT(parser.parse(validator) != reader_t::end_document);
+        CPPUNIT_ASSERT(validator.error_code() == reader_t::invalid_reference);
+
+        const string_t truncated = str("<orders xmlns='urn:orders'><order id='1'>");
+
+        validator.reset();
+        parser.reset(truncated.data(), truncated.data() + truncated.size());
+
+        CPPUNIT_ASSERT(parser.parse(validator) == reader_t::error);
+        CPPUNIT_ASSERT(!validator.valid());
+
+        validator.reset();
+        CPPUNIT_ASSERT(!validator.valid());
+    }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(test_stream_validator<char>);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_stream_validator<char16_t>);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_stream_validator<char32_t>);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_stream_validator<wchar_t>);
@@ -0,0 +1,165 @@
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <string>
+#include <stdexcept>
+
+#include "structural-index.h"
+
+template <typename charT>
+class test_structural_index : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE( test_structural_index );
+    CPPUNIT_TEST( test_entries );
+    CPPUNIT_TEST( test_skip );
+    CPPUNIT_TEST( test_materialize );
+    CPPUNIT_TEST( test_materialize_element );
+    CPPUNIT_TEST( test_errors );
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    typedef xml::basic_structural_index<charT> index_t;
+    typedef typename index_t::builder_t        builder_t;
+    typedef typename index_t::reader_t         reader_t;
+    typedef typename index_t::document_t       document_t;
+    typedef typename index_t::element_t        element_t;
+    typedef xml::basic_text<charT>             text_t;
+    typedef std::basic_string<charT>           string_t;
+
+    static string_t str(const std::string& ascii)
+    {
+        return string_t(ascii.begin(), ascii.end());
+    }
+
+    static void check(const element_t& expected, const element_t& actual)
+    {
+        CPPUNIT_ASSERT(expected.name() == actual.name());
+        CPPUNIT_ASSERT(expected.attributes().size() == actual.attributes().size());
+        CPPUNIT_ASSERT(expected.size() == actual.size());
+
+        for (auto i = expected.attributes().begin(), j = actual.attributes().begin(); i != expected.attributes().end(); ++i, ++j) {
+            CPPUNIT_ASSERT(i->name() == j->name());
+            CPPUNIT_ASSERT(i->value() == j->value());
+        }
+
+        for (auto i = expected.begin(), j = actual.begin(); i != expected.end(); ++i, ++j) {
+            CPPUNIT_ASSERT(i->type() == j->type());
+
+            if (xml::basic_string_view<charT>(i->type()).equals("element"))
+                check(static_cast<const element_t&>(*i), static_cast<const element_t&>(*j));
+            else
+                CPPUNIT_ASSERT(static_cast<const text_t&>(*i).data() == static_cast<const text_t&>(*j).data());
+        }
+    }
+
+    void test_entries()
+    {
+        const string_t input = str("<?xml version='1.0'?><!DOCTYPE r><r a='>'>t<e/><!-- c --><![CDATA[<>]]><?p d?></r>");
+        const index_t index(input.data(), input.data() + input.size());
+
+        CPPUNIT_ASSERT(index.size() == 9);
+        CPPUNIT_ASSERT(index[0].kind == reader_t::declaration);
+        CPPUNIT_ASSERT(index[1].kind == reader_t::doctype);
+        CPPUNIT_ASSERT(index[2].kind == reader_t::start_element);
+        CPPUNIT_ASSERT(index[3].kind == reader_t::text);
+        CPPUNIT_ASSERT(index[4].kind == reader_t::start_element);
+        CPPUNIT_ASSERT(index[5].kind == reader_t::comment);
+        CPPUNIT_ASSERT(index[6].kind == reader_t::cdata);
+        CPPUNIT_ASSERT(index[7].kind == reader_t::processing_instruction);
+        CPPUNIT_ASSERT(index[8].kind == reader_t::end_element);
+
+        CPPUNIT_ASSERT(index.root() == 2);
+        CPPUNIT_ASSERT(index.name(2) == str("r"));
+        CPPUNIT_ASSERT(index.view(2) == str("<r a='>'>"));
+        CPPUNIT_ASSERT(index.view(3) == str("t"));
+        CPPUNIT_ASSERT(index.name(4) == str("e"));
+        CPPUNIT_ASSERT(index.next(2) == 9);
+        CPPUNIT_ASSERT(index.name(8) == str("r"));
+        CPPUNIT_ASSERT(index.next(4) == 5);
+    }
+
+    void test_skip()
+    {
+        const string_t input = str("<r><a><b><c/></b></a><d>x</d><e/></r>");
+        const index_t index(input.data(), input.data() + input.size());
+        std::string names;
+
+        for (size_t i = index.first_child(index.root()); i < index.last_child(index.root()); i = index.next(i))
+            names += index.name(i).str()[0];
+
+        CPPUNIT_ASSERT(names == "ade");
+    }
+
+    void test_materialize()
+    {
+        std::string content = "<?xml version='1.0' standalone='yes'?>\n<root kind='records'>\n";
+
+        for (size_t i = 0; i < 1000; ++i)
+            content += "<record id='" + std::to_string(i) + "' quoted=\"a > b\"><name>name</name><![CDATA[<raw>]]><deep><deeper/></deep></record>\n";
+
+        const string_t input = str(content + "</root>\n<!-- end -->\n");
+        const index_t index(input.data(), input.data() + input.size());
+        const document_t doc = index.materialize(true);
+
+        CPPUNIT_ASSERT(doc.standalone().value == builder_t::standalone_t::yes);
+        CPPUNIT_ASSERT(doc.root().name().references());
+
+        check(builder_t::parse(input).root(), doc.root());
+    }
+
+    void test_materialize_element()
+    {
+        const string_t input = str("<r><a x='1'><b>t</b><c/></a><d/></r>");
+        const index_t index(input.data(), input.data() + input.size());
+        const element_t a = index.materialize_element(index.first_child(index.root()));
+
+        CPPUNIT_ASSERT(!a.name().references());
+
+        check(static_cast<const element_t&>(builder_t::parse(input).root().front()), a);
+    }
+
+    void test_errors()
+    {
+        const std::string structural[] = {
+            "<a>",
+            "<a></a></b>",
+            "<a/><b/>",
+            "text<a/>",
+            "<a x='>",
+            "<a><!-- x -- y --></a>",
+            ""
+        };
+
+        for (const std::string& input : structural) {
+            const string_t data = str(input);
+            index_t index;
+
+            CPPUNIT_ASSERT(!index.build(data.data(), data.data() + data.size()));
+            CPPUNIT_ASSERT(index.error_code() != reader_t::no_error);
+        }
+
+        const std::string names[] = {
+            "<a></b>",
+            "<a x='1' x='2'/>",
+            "<a 1='x'/>"
+        };
+
+        for (const std::string& input : names) {
+            const string_t data = str(input);
+            const index_t index(data.data(), data.data() + data.size());
+            bool thrown = false;
+
+            try {
+                index.materialize();
+            } catch (std::runtime_error&) {
+                thrown = true;
+            }
+
+            CPPUNIT_ASSERT(thrown);
+        }
+    }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(test_structural_index<char>);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_structural_index<char16_t>);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_structural_index<char32_t>);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_structural_index<wchar_t>);
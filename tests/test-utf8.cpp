@@ -0,0 +1,348 @@
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <string>
+
+#include "utf8.h"
+#include "builder.h"
+#include "push-parser.h"
+#include "structural-index.h"
+
+class test_utf8 : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE( test_utf8 );
+    CPPUNIT_TEST( test_validate );
+    CPPUNIT_TEST( test_invalid );
+    CPPUNIT_TEST( test_truncated );
+    CPPUNIT_TEST( test_reader );
+    CPPUNIT_TEST( test_push_parser );
+    CPPUNIT_TEST( test_structural_index );
+    CPPUNIT_TEST( test_decode );
+    CPPUNIT_TEST( test_encode );
+    CPPUNIT_TEST( test_kernels );
+    CPPUNIT_TEST( test_parse );
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    typedef xml::reader                           reader_t;
+    typedef xml::basic_push_parser<char>          parser_t;
+    typedef xml::basic_structural_index<char>     index_t;
+
+    static size_t validate(const std::string& input)
+    {
+        return xml::utf8::validate(input.data(), input.data() + input.size()) - input.data();
+    }
+
+    template <typename charT>
+    static std::basic_string<charT> decode(const std::string& input)
+    {
+        std::basic_string<charT> output(input.size(), charT());
+
+        output.resize(xml::utf8::decode(input.data(), input.data() + input.size(), &output[0]) - output.data());
+
+        return output;
+    }
+
+    template <typename charT>
+    static std::string encode(const std::basic_string<charT>& input)
+    {
+        std::string output(input.size() * 4, '\0');
+
+        output.resize(xml::utf8::encode(input.data(), input.data() + input.size(), &output[0]) - output.data());
+
+        return output;
+    }
+
+    template <typename charT>
+    static void check_parse()
+    {
+        typedef xml::basic_builder<charT>      builder_t;
+        typedef typename builder_t::document_t document_t;
+        typedef typename builder_t::element_t  element_t;
+        typedef xml::basic_text<charT>         text_t;
+
+        const std::string input = "\xEF\xBB\xBF" + document("<caf\xC3\xA9 a='\xE2\x82\xAC'>\xF0\x9F\x98\x80</caf\xC3\xA9>");
+        const document_t doc = builder_t::parse_utf8(input.data(), input.data() + input.size());
+        const element_t& child = static_cast<const element_t&>(doc.root().front());
+
+        CPPUNIT_ASSERT(doc.encoding().value == builder_t::encoding_t::UTF8);
+        CPPUNIT_ASSERT(doc.root().name().references() == (sizeof(charT) != 1));
+        CPPUNIT_ASSERT(child.name() == decode<charT>("caf\xC3\xA9"));
+        CPPUNIT_ASSERT(child.attributes().begin()->value() == decode<charT>("\xE2\x82\xAC"));
+        CPPUNIT_ASSERT(static_cast<const text_t&>(child.front()).data() == decode<charT>("\xF0\x9F\x98\x80"));
+
+        const std::string invalid = document("\xC3(");
+        bool thrown = false;
+
+        try {
+            builder_t::parse_utf8(invalid.data(), invalid.data() + invalid.size());
+        } catch (std::runtime_error&) {
+            thrown = true;
+        }
+
+        CPPUNIT_ASSERT(thrown);
+    }
+
+    static std::string document(const std::string& text)
+    {
+        return "<?xml version='1.0' encoding='utf-8'?><root>" + text + "</root>";
+    }
+
+    void test_validate()
+    {
+        const std::string valid[] = {
+            "",
+            "ascii only",
+            "caf\xC3\xA9",
+            "\xE2\x82\xAC \xED\x9F\xBF \xEE\x80\x80",
+            "\xF0\x90\x80\x80 \xF4\x8F\xBF\xBF",
+            "\xC2\x80\xDF\xBF\xE0\xA0\x80\xEF\xBF\xBF"
+        };
+
+        for (const std::string& input : valid)
+            CPPUNIT_ASSERT(validate(input) == input.size());
+
+        std::string large;
+
+        for (size_t i = 0; i < 1000; ++i)
+            large += i % 7 == 0 ? "\xE6\x97\xA5\xE6\x9C\xAC" : "<a b='c'>text</a>";
+
+        CPPUNIT_ASSERT(validate(large) == large.size());
+    }
+
+    void test_invalid()
+    {
+        const std::string invalid[] = {
+            "\x80",
+            "\xC0\xAF",
+            "\xC1\xBF",
+            "\xE0\x9F\xBF",
+            "\xED\xA0\x80",
+            "\xF0\x8F\xBF\xBF",
+            "\xF4\x90\x80\x80",
+            "\xF5\x80\x80\x80",
+            "\xFF",
+            "\xC3\x28",
+            "\xE2\x82\x28",
+            "\xE2\x82"
+        };
+
+        for (const std::string& sequence : invalid) {
+            for (size_t position : { 0, 5, 31, 63, 64, 100 }) {
+                std::string input(position, 'a');
+
+                input += sequence + std::string(70, 'b');
+
+                CPPUNIT_ASSERT(validate(input) == position);
+                CPPUNIT_ASSERT(validate(input.substr(0, position + sequence.size())) == position);
+            }
+        }
+    }
+
+    void test_truncated()
+    {
+        const std::string input = "a\xF0\x9F\x98";
+
+        CPPUNIT_ASSERT(xml::utf8::truncated(input.data(), input.data() + input.size()) == input.data() + 1);
+        CPPUNIT_ASSERT(xml::utf8::truncated(input.data(), input.data() + 1) == input.data() + 1);
+        CPPUNIT_ASSERT(xml::utf8::length(input[1]) == 4);
+        CPPUNIT_ASSERT(xml::utf8::length(input[2]) == 0);
+
+        CPPUNIT_ASSERT(xml::utf8::is_utf8(input.data(), input.data()) == false);
+
+        const std::string names[] = { "UTF-8", "utf-8", "Utf-8" };
+
+        for (const std::string& name : names)
+            CPPUNIT_ASSERT(xml::utf8::is_utf8(name.data(), name.data() + name.size()));
+    }
+
+    void test_reader()
+    {
+        const std::string input = document("caf\xC3\xA9 \xC3(");
+        reader_t reader(input.data(), input.data() + input.size());
+        reader_t::token_t token;
+
+        while ((token = reader.next()) != reader_t::error && token != reader_t::end_document);
+
+        CPPUNIT_ASSERT(token == reader_t::error);
+        CPPUNIT_ASSERT(reader.error_code() == reader_t::invalid_encoding);
+        CPPUNIT_ASSERT(reader.offset() == input.find('(') - 1);
+
+        reader.reset(input.data(), input.data() + input.size(), reader_t::parse_unchecked_encoding);
+
+        while ((token = reader.next()) != reader_t::error && token != reader_t::end_document);
+
+        CPPUNIT_ASSERT(token == reader_t::end_document);
+
+        std::string blocks;
+
+        for (size_t i = 0; i < 100000; ++i)
+            blocks += "\xE2\x82\xAC";
+
+        const std::string large = document("<a/>" + blocks);
+
+        reader.reset(large.data(), large.data() + large.size());
+
+        while ((token = reader.next()) != reader_t::error && token != reader_t::end_document);
+
+        CPPUNIT_ASSERT(token == reader_t::end_document);
+
+        const std::string late = document("<a/>" + blocks + "\xC3(" + blocks);
+
+        reader.reset(late.data(), late.data() + late.size());
+
+        while ((token = reader.next()) != reader_t::error && token != reader_t::text);
+
+        CPPUNIT_ASSERT(token == reader_t::error);
+        CPPUNIT_ASSERT(reader.error_code() == reader_t::invalid_encoding);
+        CPPUNIT_ASSERT(reader.offset() == late.find('(') - 1);
+
+        const std::string undeclared = "<root>\xC3(</root>";
+
+        reader.reset(undeclared.data(), undeclared.data() + undeclared.size());
+
+        while ((token = reader.next()) != reader_t::error && token != reader_t::end_document);
+
+        CPPUNIT_ASSERT(token == reader_t::end_document);
+    }
+
+    void test_push_parser()
+    {
+        xml::sax_handler handler;
+        parser_t parser(handler);
+
+        const std::string valid = document("\xF0\x9F\x98\x80 \xE2\x82\xAC");
+
+        for (size_t i = 0; i < valid.size(); ++i) {
+            parser.reset();
+
+            CPPUNIT_ASSERT(parser.feed(valid.data(), i));
+            CPPUNIT_ASSERT(parser.feed(valid.data() + i, valid.size() - i));
+            CPPUNIT_ASSERT(parser.finish());
+        }
+
+        const std::string invalid = document("\xF0\x9F\x98(");
+
+        for (size_t i = 0; i < invalid.size(); ++i) {
+            parser.reset();
+
+            if (parser.feed(invalid.data(), i))
+                parser.feed(invalid.data() + i, invalid.size() - i);
+
+            CPPUNIT_ASSERT(!parser.finish());
+            CPPUNIT_ASSERT(parser.error_code() == reader_t::invalid_encoding);
+            CPPUNIT_ASSERT(parser.offset() == invalid.find('(') - 3);
+        }
+
+        const std::string truncated = "<?xml version='1.0' encoding='UTF-8'?><root/>\xE2\x82";
+
+        parser.reset();
+
+        CPPUNIT_ASSERT(parser.feed(truncated.data(), truncated.size()));
+        CPPUNIT_ASSERT(!parser.finish());
+        CPPUNIT_ASSERT(parser.error_code() == reader_t::invalid_encoding);
+        CPPUNIT_ASSERT(parser.offset() == truncated.size() - 2);
+    }
+
+    void test_structural_index()
+    {
+        const std::string input = document("<a>\xED\xA0\x80</a>");
+        index_t index;
+
+        CPPUNIT_ASSERT(!index.build(input.data(), input.data() + input.size()));
+        CPPUNIT_ASSERT(index.error_code() == reader_t::invalid_encoding);
+        CPPUNIT_ASSERT(index.offset() == input.find('\xED'));
+    }
+
+    void test_decode()
+    {
+        const std::string input = std::string(40, 'a') + "\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80" + std::string(20, 'b');
+
+        CPPUNIT_ASSERT(decode<char16_t>(input) == std::u16string(40, 'a') + u"\u00E9\u20AC\U0001F600" + std::u16string(20, 'b'));
+        CPPUNIT_ASSERT(decode<char32_t>(input) == std::u32string(40, 'a') + U"\u00E9\u20AC\U0001F600" + std::u32string(20, 'b'));
+        CPPUNIT_ASSERT(decode<wchar_t>(input) == std::wstring(40, 'a') + L"\u00E9\u20AC\U0001F600" + std::wstring(20, 'b'));
+        CPPUNIT_ASSERT(decode<char>(input) == input);
+    }
+
+    void test_encode()
+    {
+        const std::string expected = std::string(40, 'a') + "\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80" + std::string(20, 'b');
+
+        CPPUNIT_ASSERT(encode(std::u16string(40, 'a') + u"\u00E9\u20AC\U0001F600" + std::u16string(20, 'b')) == expected);
+        CPPUNIT_ASSERT(encode(std::u32string(40, 'a') + U"\u00E9\u20AC\U0001F600" + std::u32string(20, 'b')) == expected);
+        CPPUNIT_ASSERT(encode(std::wstring(40, 'a') + L"\u00E9\u20AC\U0001F600" + std::wstring(20, 'b')) == expected);
+
+        const char16_t unpaired[] = { 'a', 0xD800, 'b', 0xDC00 };
+
+        CPPUNIT_ASSERT(encode(std::u16string(unpaired, unpaired + 4)) == "a\xEF\xBF\xBD" "b\xEF\xBF\xBD");
+        CPPUNIT_ASSERT(encode(std::u32string(1, 0x110000)) == "\xEF\xBF\xBD");
+    }
+
+    static void append(std::string& utf8, std::u16string& utf16, char32_t code)
+    {
+        if (code < 0x80) {
+            utf8 += static_cast<char>(code);
+        } else if (code < 0x800) {
+            utf8 += static_cast<char>(0xC0 | code >> 6);
+            utf8 += static_cast<char>(0x80 | (code & 0x3F));
+        } else if (code < 0x10000) {
+            utf8 += static_cast<char>(0xE0 | code >> 12);
+            utf8 += static_cast<char>(0x80 | (code >> 6 & 0x3F));
+            utf8 += static_cast<char>(0x80 | (code & 0x3F));
+        } else {
+            utf8 += static_cast<char>(0xF0 | code >> 18);
+            utf8 += static_cast<char>(0x80 | (code >> 12 & 0x3F));
+            utf8 += static_cast<char>(0x80 | (code >> 6 & 0x3F));
+            utf8 += static_cast<char>(0x80 | (code & 0x3F));
+        }
+
+        if (code < 0x10000) {
+            utf16 += static_cast<char16_t>(code);
+        } else {
+            utf16 += static_cast<char16_t>(0xD800 + ((code - 0x10000) >> 10));
+            utf16 += static_cast<char16_t>(0xDC00 + (code & 0x3FF));
+        }
+    }
+
+    void test_kernels()
+    {
+        const char32_t codes[] = { 'a', 0xE9, 0x20AC, 0x1F600, 'b', 0x430, 0x4E2D, 0x7FF, 0x800, 0xFFFD, 0x10FFFF };
+
+        for (size_t offset = 0; offset != 40; ++offset) {
+            std::u32string utf32(offset, 'x');
+            std::u16string utf16(offset, 'x');
+            std::string    utf8(offset, 'x');
+
+            for (size_t i = 0; i != 300; ++i) {
+                const char32_t code = codes[(i * 7 + offset + i / 50) % 11];
+
+                utf32 += code;
+                append(utf8, utf16, code);
+            }
+
+            CPPUNIT_ASSERT(decode<char16_t>(utf8) == utf16);
+            CPPUNIT_ASSERT(decode<char32_t>(utf8) == utf32);
+            CPPUNIT_ASSERT(encode(utf16) == utf8);
+            CPPUNIT_ASSERT(encode(utf32) == utf8);
+
+            std::u16string unpaired(40, 0xE9);
+            std::string    expected;
+
+            unpaired[offset] = offset % 2 == 0 ? 0xD800 : 0xDC00;
+
+            for (size_t i = 0; i != unpaired.size(); ++i)
+                expected += i == offset ? "\xEF\xBF\xBD" : "\xC3\xA9";
+
+            CPPUNIT_ASSERT(encode(unpaired) == expected);
+        }
+    }
+
+    void test_parse()
+    {
+        check_parse<char>();
+        check_parse<char16_t>();
+        check_parse<char32_t>();
+        check_parse<wchar_t>();
+    }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(test_utf8);
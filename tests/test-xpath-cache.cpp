@@ -0,0 +1,151 @@
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+
+#include "xpath-cache.h"
+#include "builder.h"
+
+template <typename charT>
+class test_xpath_cache : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE( test_xpath_cache );
+    CPPUNIT_TEST( test_lookup );
+    CPPUNIT_TEST( test_eviction );
+    CPPUNIT_TEST( test_errors );
+    CPPUNIT_TEST( test_threads );
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    typedef xml::basic_xpath_cache<charT>               cache_t;
+    typedef typename cache_t::expression_t              expression_t;
+    typedef typename cache_t::expression_pointer_t      expression_pointer_t;
+    typedef typename cache_t::bindings_t                bindings_t;
+    typedef typename cache_t::exception_t               exception_t;
+    typedef typename cache_t::statistics_t              statistics_t;
+    typedef typename expression_t::node_t               node_t;
+    typedef xml::basic_builder<charT>                   builder_t;
+    typedef typename builder_t::document_t              document_t;
+    typedef std::basic_string<charT>                    string_t;
+
+    static string_t str(const std::string& ascii)
+    {
+        return string_t(ascii.begin(), ascii.end());
+    }
+
+    void test_lookup()
+    {
+        cache_t                    cache;
+        const bindings_t           x { { str("x"), str("urn:x") } };
+        const bindings_t           y { { str("x"), str("urn:y") } };
+        const expression_pointer_t first = cache.compile(str("//x:item[@k = 1]"), x);
+
+        CPPUNIT_ASSERT(cache.compile(str("//x:item[@k = 1]"), x) == first);
+        CPPUNIT_ASSERT(cache.compile(str("//x:item[@k = 1]"), y) != first);
+        CPPUNIT_ASSERT(cache.compile(str("//x:item[@k = 2]"), x) != first);
+        CPPUNIT_ASSERT(cache.try_compile(str("//x:item[@k = 1]"), x).value() == first);
+
+        const statistics_t stats = cache.statistics();
+
+        CPPUNIT_ASSERT(stats.hits == 2);
+        CPPUNIT_ASSERT(stats.misses == 3);
+        CPPUNIT_ASSERT(stats.failures == 0);
+        CPPUNIT_ASSERT(stats.evictions == 0);
+        CPPUNIT_ASSERT(stats.size == 3);
+        CPPUNIT_ASSERT(stats.compile_time > 0);
+
+        const document_t doc = builder_t::parse(str("<r xmlns:p='urn:x'><p:item k='1'/><p:item k='2'/></r>"));
+
+        CPPUNIT_ASSERT(first->select(node_t(doc)).size() == 1);
+
+        cache.clear();
+
+        CPPUNIT_ASSERT(cache.statistics().size == 0);
+        CPPUNIT_ASSERT(cache.compile(str("//x:item[@k = 1]"), x) != first);
+        CPPUNIT_ASSERT(first->select(node_t(doc)).size() == 1);
+
+        CPPUNIT_ASSERT(&cache_t::instance() == &cache_t::instance());
+        CPPUNIT_ASSERT(cache_t::instance().capacity() == cache_t::default_capacity);
+    }
+
+    void test_eviction()
+    {
+        cache_t cache(2, 1);
+
+        CPPUNIT_ASSERT(cache.capacity() == 2);
+
+        const expression_pointer_t a = cache.compile(str("a"));
+        const expression_pointer_t b = cache.compile(str("b"));
+
+        CPPUNIT_ASSERT(cache.compile(str("a")) == a);
+
+        cache.compile(str("c"));
+
+        CPPUNIT_ASSERT(cache.statistics().evictions == 1);
+        CPPUNIT_ASSERT(cache.statistics().size == 2);
+        CPPUNIT_ASSERT(cache.compile(str("a")) == a);
+        CPPUNIT_ASSERT(cache.compile(str("b")) != b);
+        CPPUNIT_ASSERT(b->str() == str("b"));
+
+        cache_t sharded(64, 8);
+
+        for (size_t i = 0; i != 1000; ++i)
+            sharded.compile(str("/r/item[" + std::to_string(i) + "]"));
+
+        CPPUNIT_ASSERT(sharded.capacity() == 64);
+        CPPUNIT_ASSERT(sharded.statistics().size <= 64);
+        CPPUNIT_ASSERT(sharded.statistics().evictions == 1000 - sharded.statistics().size);
+    }
+
+    void test_errors()
+    {
+        cache_t cache;
+        bool    thrown = false;
+
+        try {
+            cache.compile(str("//a["));
+        } catch (exception_t& e) {
+            thrown = e.column() == 5;
+        }
+
+        CPPUNIT_ASSERT(thrown);
+        CPPUNIT_ASSERT(!cache.try_compile(str("//a[")));
+        CPPUNIT_ASSERT(cache.try_compile(str("//a[")).error().offset() == 4);
+        CPPUNIT_ASSERT(cache.statistics().failures == 3);
+        CPPUNIT_ASSERT(cache.statistics().size == 0);
+    }
+
+    void test_threads()
+    {
+        cache_t                  cache(16, 4);
+        std::atomic<size_t>      wrong(0);
+        std::vector<std::thread> threads;
+
+        for (size_t t = 0; t != 8; ++t)
+            threads.emplace_back([&cache, &wrong, t]() {
+                for (size_t i = 0; i != 500; ++i) {
+                    const string_t             expression = str("count(//item[" + std::to_string((i * 7 + t) % 24) + "])");
+                    const expression_pointer_t compiled   = cache.compile(expression);
+
+                    if (compiled->str() != expression)
+                        ++wrong;
+                }
+            });
+
+        for (std::thread& thread : threads)
+            thread.join();
+
+        const statistics_t stats = cache.statistics();
+
+        CPPUNIT_ASSERT(wrong == 0);
+        CPPUNIT_ASSERT(stats.hits + stats.misses == 8 * 500);
+        CPPUNIT_ASSERT(stats.size <= 16);
+    }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(test_xpath_cache<char>);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_xpath_cache<char16_t>);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_xpath_cache<char32_t>);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_xpath_cache<wchar_t>);
@@ -0,0 +1,224 @@
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+
+#include "xpath-stream.h"
+#include "push-parser.h"
+#include "sax.h"
+#include "builder.h"
+
+template <typename charT>
+class test_xpath_stream : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE( test_xpath_stream );
+    CPPUNIT_TEST( test_sax );
+    CPPUNIT_TEST( test_push );
+    CPPUNIT_TEST( test_namespaces );
+    CPPUNIT_TEST( test_errors );
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    typedef xml::basic_xpath_stream<charT>              stream_t;
+    typedef typename stream_t::expression_t             expression_t;
+    typedef typename stream_t::expression_pointer_t     expression_pointer_t;
+    typedef typename stream_t::element_t                element_t;
+    typedef typename stream_t::table_t                  table_t;
+    typedef typename expression_t::bindings_t           bindings_t;
+    typedef typename expression_t::node_t               node_t;
+    typedef typename expression_t::node_set_t           node_set_t;
+    typedef xml::basic_sax_parser<charT>                parser_t;
+    typedef xml::basic_push_parser<charT, stream_t>     push_parser_t;
+    typedef typename parser_t::reader_t                 reader_t;
+    typedef xml::basic_builder<charT>                   builder_t;
+    typedef typename builder_t::document_t              document_t;
+    typedef std::basic_string<charT>                    string_t;
+
+    static string_t str(const std::string& ascii)
+    {
+        return string_t(ascii.begin(), ascii.end());
+    }
+
+    static expression_pointer_t compile(const std::string& expression)
+    {
+        return expression_t::compile(str(expression), bindings_t { { str("x"), str("urn:x") } });
+    }
+
+    static std::vector<string_t> stream(const std::string& expression, const string_t& document)
+    {
+        std::vector<string_t> values;
+        stream_t              handler(compile(expression), [&values](const element_t& element) {
+            values.push_back(node_t(element).string_value());
+
+            return true;
+        });
+        parser_t parser(document.data(), document.data() + document.size());
+
+        CPPUNIT_ASSERT(parser.parse(handler) == reader_t::end_document);
+        CPPUNIT_ASSERT(handler.count() == values.size());
+
+        return values;
+    }
+
+    static std::vector<string_t> select(const std::string& expression, const document_t& document)
+    {
+        std::vector<string_t> values;
+
+        for (const node_t& node : compile(expression)->select(node_t(document)))
+            values.push_back(node.string_value());
+
+        return values;
+    }
+
+    void test_sax()
+    {
+        const string_t input = str(
+            "<?xml version='1.0'?>\n<!-- library -->\n"
+            "<library xmlns:x='urn:x'>\n"
+            "  <book id='b1' year='1999'><title>Alpha</title><price>10</price></book>\n"
+            "  <book id='b2' year='2005'><title>Be&amp;ta</title><price>25.5</price><x:note>n</x:note></book>\n"
+            "  <magazine id='m1'><title><![CDATA[Gam]]>ma</title><price>4</price></magazine>\n"
+            "  <book id='b3' year='2010'><title>Delta</title><price>7</price></book>\n"
+            "</library>");
+        const document_t doc = builder_t::parse(input);
+
+        const char* const expressions[] = {
+            "/library",
+            "//book",
+            "/library/book[@year > 2000]/title",
+            "//*[@id = 'm1']",
+            "/library/*/price",
+            "//x:note",
+            "//book[not(@year = 1999)]//*",
+            "//*[starts-with(@id, 'b') and name() != 'magazine']/title",
+            "/book",
+            "//book[@missing]"
+        };
+
+        for (const char* expression : expressions)
+            CPPUNIT_ASSERT(stream(expression, input) == select(expression, doc));
+
+        CPPUNIT_ASSERT(stream("//title", input).size() == 4);
+        CPPUNIT_ASSERT(stream("//title", input)[2] == str("Gamma"));
+        CPPUNIT_ASSERT(stream("//*", input).size() == 1);
+
+        expression_pointer_t first = compile("//book");
+        size_t               seen  = 0;
+        stream_t             handler(first, [&seen](const element_t&) { return ++seen != 2; });
+        parser_t             parser(input.data(), input.data() + input.size());
+
+        CPPUNIT_ASSERT(parser.parse(handler) != reader_t::end_document);
+        CPPUNIT_ASSERT(handler.count() == 2);
+        CPPUNIT_ASSERT(handler.error_code() == reader_t::no_error);
+    }
+
+    void test_push()
+    {
+        std::string document = "<orders>";
+
+        for (size_t i = 0; i < 1000; ++i)
+            document += "<order id='" + std::to_string(i + 1) + "'><skip><a/><b/></skip><item>x &lt; y</item></order>";
+
+        document += "</orders>";
+
+        const string_t input = str(document);
+
+        for (size_t chunk : { size_t(1), size_t(7), input.size() }) {
+            std::vector<string_t> values;
+            stream_t              handler(compile("/orders/order[@id mod 100 = 0]/item"), [&values](const element_t& element) {
+                values.push_back(node_t(element).string_value());
+
+                return true;
+            });
+            push_parser_t parser(handler);
+
+            for (size_t i = 0; i < input.size(); i += chunk)
+                CPPUNIT_ASSERT(parser.feed(input.data() + i, std::min(chunk, input.size() - i)));
+
+            CPPUNIT_ASSERT(parser.finish());
+            CPPUNIT_ASSERT(values.size() == 10);
+            CPPUNIT_ASSERT(std::count(values.begin(), values.end(), str("x < y")) == 10);
+        }
+    }
+
+    void test_namespaces()
+    {
+        const string_t input = str(
+            "<a:root xmlns:a='urn:x' xmlns='urn:d'><item k='1'/><a:item a:k='2'>"
+            "<b:item xmlns:b='urn:x' b:k='3'><deep/></b:item></a:item><item xmlns='' k='4'/></a:root>");
+
+        CPPUNIT_ASSERT(stream("//x:item", input).size() == 1);
+        CPPUNIT_ASSERT(stream("/x:root/x:item/x:item", input).size() == 1);
+        CPPUNIT_ASSERT(stream("//item", input).size() == 1);
+        CPPUNIT_ASSERT(stream("//x:*[@x:k = 3]", input).size() == 1);
+        CPPUNIT_ASSERT(stream("/x:root/*[@k]", input).size() == 2);
+
+        const expression_pointer_t deep = compile("x:item/*");
+        const expression_pointer_t keys = compile("x:item/@x:k");
+        size_t                     found = 0;
+        stream_t                   handler(compile("/x:root/x:item"), [&](const element_t& element) {
+            found += deep->select(node_t(element)).size();
+            found += keys->evaluate(node_t(element)).number() == 3 ? 0 : 100;
+
+            return true;
+        });
+        parser_t                   parser(input.data(), input.data() + input.size());
+
+        CPPUNIT_ASSERT(parser.parse(handler) == reader_t::end_document);
+        CPPUNIT_ASSERT(handler.count() == 1);
+        CPPUNIT_ASSERT(found == 100);
+
+        const table_t*             table    = nullptr;
+        size_t                     resolved = 0;
+        stream_t                   namespaced(compile("/x:root/x:item"), [&](const element_t& element) {
+            resolved += deep->evaluate(node_t(element), *table).nodes().size();
+            resolved += keys->evaluate(node_t(element), *table).number() == 3 ? 10 : 0;
+
+            return true;
+        });
+        parser_t                   again(input.data(), input.data() + input.size());
+
+        table = &namespaced.namespaces();
+
+        CPPUNIT_ASSERT(again.parse(namespaced) == reader_t::end_document);
+        CPPUNIT_ASSERT(resolved == 11);
+    }
+
+    void test_errors()
+    {
+        for (const char* expression : { "//book[1]", "count(//book)", "//book[title]" }) {
+            bool thrown = false;
+
+            try {
+                stream_t rejected(compile(expression), [](const element_t&) { return true; });
+            } catch (std::invalid_argument&) {
+                thrown = true;
+            }
+
+            CPPUNIT_ASSERT(thrown);
+        }
+
+        const string_t unbound = str("<root><p:item/></root>");
+        stream_t       handler(compile("/root/item"), [](const element_t&) { return true; });
+        parser_t       parser(unbound.data(), unbound.data() + unbound.size());
+
+        CPPUNIT_ASSERT(parser.parse(handler) != reader_t::end_document);
+        CPPUNIT_ASSERT(handler.error_code() == reader_t::invalid_namespace);
+
+        const string_t skipped = str("<root><other><p:item/></other></root>");
+        parser_t       tolerant(skipped.data(), skipped.data() + skipped.size());
+
+        handler.reset();
+
+        CPPUNIT_ASSERT(tolerant.parse(handler) == reader_t::end_document);
+        CPPUNIT_ASSERT(handler.error_code() == reader_t::no_error);
+        CPPUNIT_ASSERT(handler.count() == 0);
+    }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(test_xpath_stream<char>);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_xpath_stream<char16_t>);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_xpath_stream<char32_t>);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_xpath_stream<wchar_t>);
@@ -0,0 +1,399 @@
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "xpath.h"
+#include "builder.h"
+
+template <typename charT>
+class test_xpath : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE( test_xpath );
+    CPPUNIT_TEST( test_compile );
+    CPPUNIT_TEST( test_paths );
+    CPPUNIT_TEST( test_axes );
+    CPPUNIT_TEST( test_functions );
+    CPPUNIT_TEST( test_operators );
+    CPPUNIT_TEST( test_variables );
+    CPPUNIT_TEST( test_index );
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    typedef xml::basic_xpath_expression<charT>         expression_t;
+    typedef typename expression_t::expression_pointer_t expression_pointer_t;
+    typedef typename expression_t::bindings_t          bindings_t;
+    typedef typename expression_t::variables_t         variables_t;
+    typedef typename expression_t::exception_t         exception_t;
+    typedef typename expression_t::node_t              node_t;
+    typedef typename expression_t::value_t             value_t;
+    typedef typename expression_t::node_set_t          node_set_t;
+    typedef xml::basic_builder<charT>                  builder_t;
+    typedef typename builder_t::document_t             document_t;
+    typedef typename document_t::root_t                element_t;
+    typedef typename element_t::attribute_t            attribute_t;
+    typedef std::basic_string<charT>                   string_t;
+
+    static string_t str(const std::string& ascii)
+    {
+        return string_t(ascii.begin(), ascii.end());
+    }
+
+    static document_t library()
+    {
+        const string_t input = str(
+            "<library xmlns:x='urn:x' xml:lang='en'>\n"
+            "  <book id='b1' year='1999' xml:id='one'><title>Alpha</title><price>10</price></book>\n"
+            "  <book id='b2' year='2005'><title>Beta</title><price>25.5</price><x:note>n</x:note></book>\n"
+            "  <magazine id='m1'><title>Gamma</title><price>4</price></magazine>\n"
+            "  <book id='b3' year='2010' xml:lang='fr-CA'><title>Delta</title><price>7</price></book>\n"
+            "</library>");
+
+        return builder_t::parse(input.data(), input.data() + input.size(), false, xml::basic_reader<charT>::parse_strip_whitespace);
+    }
+
+    static expression_pointer_t compile(const std::string& expression)
+    {
+        return expression_t::compile(str(expression), bindings_t { { str("x"), str("urn:x") } });
+    }
+
+    static value_t evaluate(const node_t& context, const std::string& expression)
+    {
+        return compile(expression)->evaluate(context);
+    }
+
+    static bool failed(const std::string& expression, size_t offset)
+    {
+        const typename expression_t::result_t result = expression_t::try_compile(str(expression));
+
+        return !result && result.error().offset() == offset;
+    }
+
+    void test_compile()
+    {
+        CPPUNIT_ASSERT(failed("//", 2));
+        CPPUNIT_ASSERT(failed("1 +", 3));
+        CPPUNIT_ASSERT(failed("foo(1)", 0));
+        CPPUNIT_ASSERT(failed("a/p:b", 2));
+        CPPUNIT_ASSERT(failed("count(1)", 6));
+        CPPUNIT_ASSERT(failed("'abc", 0));
+        CPPUNIT_ASSERT(failed("bogus::a", 0));
+        CPPUNIT_ASSERT(failed("1 | 2", 2));
+        CPPUNIT_ASSERT(failed("a[1", 3));
+        CPPUNIT_ASSERT(failed("concat('a')", 0));
+        CPPUNIT_ASSERT(failed("a b", 2));
+
+        bool thrown = false;
+
+        try {
+            expression_t::compile(str("a +* b"));
+        } catch (exception_t& e) {
+            thrown = true;
+
+            CPPUNIT_ASSERT(e.errCode() == expression_t::reader_t::no_error);
+        }
+
+        CPPUNIT_ASSERT(thrown);
+
+        CPPUNIT_ASSERT(expression_t::try_compile(str("div div div")).has_value());
+        CPPUNIT_ASSERT(expression_t::try_compile(str("mod/and [or = * * 2]")).has_value());
+        CPPUNIT_ASSERT(expression_t::try_compile(str("child :: a / @ b")).has_value());
+
+        CPPUNIT_ASSERT(compile("//book")->returns_nodes());
+        CPPUNIT_ASSERT(!compile("count(//book)")->returns_nodes());
+        CPPUNIT_ASSERT(compile("//a")->str() == str("//a"));
+
+        CPPUNIT_ASSERT(compile("/library/book[@year > 2000]/title")->streamable());
+        CPPUNIT_ASSERT(compile("//x:note")->streamable());
+        CPPUNIT_ASSERT(compile("//book[not(@year = 1999) and name() = 'book']//*")->streamable());
+        CPPUNIT_ASSERT(!compile("//book[1]")->streamable());
+        CPPUNIT_ASSERT(!compile("//book[title]")->streamable());
+        CPPUNIT_ASSERT(!compile("//book[string()]")->streamable());
+        CPPUNIT_ASSERT(!compile("book")->streamable());
+        CPPUNIT_ASSERT(!compile("/library/..")->streamable());
+        CPPUNIT_ASSERT(!compile("//@id")->streamable());
+        CPPUNIT_ASSERT(!compile("count(//book)")->streamable());
+    }
+
+    void test_paths()
+    {
+        const document_t doc = library();
+        const node_t     root(doc);
+
+        CPPUNIT_ASSERT(compile("//book")->select(root).size() == 3);
+        CPPUNIT_ASSERT(compile("/library/*")->select(root).size() == 4);
+        CPPUNIT_ASSERT(compile("/")->select(root).front() == root);
+        CPPUNIT_ASSERT(evaluate(root, "//book[1]/title").string() == str("Alpha"));
+        CPPUNIT_ASSERT(evaluate(root, "//book[last()]/title").string() == str("Delta"));
+        CPPUNIT_ASSERT(evaluate(root, "//book[position() = 2]/title").string() == str("Beta"));
+        CPPUNIT_ASSERT(evaluate(root, "(//title)[3]").string() == str("Gamma"));
+        CPPUNIT_ASSERT(evaluate(root, "//book[2][1]/title").string() == str("Beta"));
+        CPPUNIT_ASSERT(compile("//book[1][2]")->select(root).empty());
+        CPPUNIT_ASSERT(compile("//book[@year > 2000][2]/title")->select(root).front().string_value() == str("Delta"));
+        CPPUNIT_ASSERT(compile("//book[price > 8]")->select(root).size() == 2);
+        CPPUNIT_ASSERT(compile("//*[@id = 'm1' or @id = 'b3']")->select(root).size() == 2);
+        CPPUNIT_ASSERT(compile("//book[0]")->select(root).empty());
+        CPPUNIT_ASSERT(compile("//book[false()]")->select(root).empty());
+        CPPUNIT_ASSERT(compile("//book[true()]")->select(root).size() == 3);
+        CPPUNIT_ASSERT(compile("//title | //price")->select(root).size() == 8);
+        CPPUNIT_ASSERT(evaluate(root, "(//price | //title)[1]").string() == str("Alpha"));
+        CPPUNIT_ASSERT(evaluate(root, "//x:note").string() == str("n"));
+        CPPUNIT_ASSERT(evaluate(root, "count(//x:*)").number() == 1);
+        CPPUNIT_ASSERT(evaluate(root, "count(//note)").number() == 0);
+        CPPUNIT_ASSERT(evaluate(root, "string(//book[2])").string() == str("Beta25.5n"));
+        CPPUNIT_ASSERT(evaluate(root, "id('one')/title").string() == str("Alpha"));
+        CPPUNIT_ASSERT(evaluate(root, "count(//book[lang('en')])").number() == 2);
+        CPPUNIT_ASSERT(evaluate(root, "count(//book[lang('FR')])").number() == 1);
+
+        const node_set_t titles = compile("//book/title")->select(root);
+        const node_set_t same   = compile("/descendant-or-self::node()/child::book/./child::title")->select(root);
+
+        CPPUNIT_ASSERT(titles == same);
+        CPPUNIT_ASSERT(titles.size() == 3);
+
+        const node_t book = compile("//book[2]")->select_first(root);
+
+        CPPUNIT_ASSERT(book.element() != nullptr);
+        CPPUNIT_ASSERT(evaluate(book, "title").string() == str("Beta"));
+        CPPUNIT_ASSERT(evaluate(book, "../magazine/@id").string() == str("m1"));
+        CPPUNIT_ASSERT(evaluate(book, "count(/library/book)").number() == 3);
+        CPPUNIT_ASSERT(evaluate(book, "@year + 1").number() == 2006);
+        CPPUNIT_ASSERT(evaluate(book, "name(@*[1])").string() == str("id"));
+
+        size_t visited = 0;
+
+        CPPUNIT_ASSERT(!compile("//price")->for_each(root, [&visited](const node_t&) { return ++visited != 2; }));
+        CPPUNIT_ASSERT(visited == 2);
+        CPPUNIT_ASSERT(compile("//book[price < 8]")->test(root));
+        CPPUNIT_ASSERT(!compile("//book[price > 100]")->test(root));
+    }
+
+    void test_axes()
+    {
+        const document_t doc = library();
+        const node_t     root(doc);
+
+        CPPUNIT_ASSERT(evaluate(root, "//magazine/following-sibling::*[1]/@id").string() == str("b3"));
+        CPPUNIT_ASSERT(evaluate(root, "//magazine/preceding-sibling::book[1]/@id").string() == str("b2"));
+        CPPUNIT_ASSERT(evaluate(root, "//title[. = 'Gamma']/../@id").string() == str("m1"));
+        CPPUNIT_ASSERT(evaluate(root, "count(//price/ancestor::*)").number() == 5);
+        CPPUNIT_ASSERT(evaluate(root, "name(//title[. = 'Delta']/ancestor-or-self::*[2])").string() == str("book"));
+        CPPUNIT_ASSERT(evaluate(root, "//title[. = 'Delta']/preceding::title[1]").string() == str("Gamma"));
+        CPPUNIT_ASSERT(evaluate(root, "count(//magazine/following::*)").number() == 3);
+        CPPUNIT_ASSERT(evaluate(root, "count(//magazine/preceding::*)").number() == 7);
+        CPPUNIT_ASSERT(evaluate(root, "count(//magazine/@id/following::*)").number() == 5);
+        CPPUNIT_ASSERT(evaluate(root, "count(//@id/parent::*)").number() == 4);
+        CPPUNIT_ASSERT(evaluate(root, "count(//book/descendant::text())").number() == 7);
+        CPPUNIT_ASSERT(evaluate(root, "count(/library/descendant-or-self::*)").number() == 14);
+        CPPUNIT_ASSERT(evaluate(root, "count(//book/self::book)").number() == 3);
+        CPPUNIT_ASSERT(evaluate(root, "count(//book/self::magazine)").number() == 0);
+        CPPUNIT_ASSERT(evaluate(root, "count(/library/@*)").number() == 1);
+        CPPUNIT_ASSERT(evaluate(root, "count(//namespace::*)").number() == 0);
+        CPPUNIT_ASSERT(evaluate(root, "count(//comment() | //processing-instruction('x'))").number() == 0);
+        CPPUNIT_ASSERT(evaluate(root, "count(//node())").number() == 23);
+
+        const node_set_t reversed = compile("//price/ancestor-or-self::node()")->select(root);
+
+        CPPUNIT_ASSERT(reversed.size() == 10);
+        CPPUNIT_ASSERT(reversed.front() == root);
+        CPPUNIT_ASSERT(reversed[1].element() != nullptr && reversed[1].element()->name().view().equals("library"));
+    }
+
+    void test_functions()
+    {
+        const node_t none;
+
+        CPPUNIT_ASSERT(evaluate(none, "concat('a', \"b\", 'c')").string() == str("abc"));
+        CPPUNIT_ASSERT(evaluate(none, "substring('12345', 2, 3)").string() == str("234"));
+        CPPUNIT_ASSERT(evaluate(none, "substring('12345', 1.5, 2.6)").string() == str("234"));
+        CPPUNIT_ASSERT(evaluate(none, "substring('12345', 0, 3)").string() == str("12"));
+        CPPUNIT_ASSERT(evaluate(none, "substring('12345', 0 div 0, 3)").string() == str(""));
+        CPPUNIT_ASSERT(evaluate(none, "substring('12345', -42, 1 div 0)").string() == str("12345"));
+        CPPUNIT_ASSERT(evaluate(none, "substring-before('1999/04/01', '/')").string() == str("1999"));
+        CPPUNIT_ASSERT(evaluate(none, "substring-after('1999/04/01', '/')").string() == str("04/01"));
+        CPPUNIT_ASSERT(evaluate(none, "translate('bar', 'abc', 'ABC')").string() == str("BAr"));
+        CPPUNIT_ASSERT(evaluate(none, "translate('--aaa--', 'abc-', 'ABC')").string() == str("AAA"));
+        CPPUNIT_ASSERT(evaluate(none, "normalize-space('  a \t b  ')").string() == str("a b"));
+        CPPUNIT_ASSERT(evaluate(none, "string-length('abc')").number() == 3);
+        CPPUNIT_ASSERT(evaluate(none, "starts-with('abc', 'ab')").boolean());
+        CPPUNIT_ASSERT(!evaluate(none, "contains('abc', 'x')").boolean());
+        CPPUNIT_ASSERT(evaluate(none, "floor(2.5)").number() == 2);
+        CPPUNIT_ASSERT(evaluate(none, "ceiling(2.1)").number() == 3);
+        CPPUNIT_ASSERT(evaluate(none, "round(2.5)").number() == 3);
+        CPPUNIT_ASSERT(evaluate(none, "round(-2.5)").number() == -2);
+        CPPUNIT_ASSERT(evaluate(none, "number(' 12 ')").number() == 12);
+        CPPUNIT_ASSERT(std::isnan(evaluate(none, "number('1e3')").number()));
+        CPPUNIT_ASSERT(!evaluate(none, "boolean('')").boolean());
+        CPPUNIT_ASSERT(evaluate(none, "not(0)").boolean());
+        CPPUNIT_ASSERT(evaluate(none, "string(true())").string() == str("true"));
+
+        const document_t doc = library();
+        const node_t     root(doc);
+
+        CPPUNIT_ASSERT(evaluate(root, "sum(//price)").number() == 46.5);
+        CPPUNIT_ASSERT(evaluate(root, "count(//@id)").number() == 4);
+        CPPUNIT_ASSERT(evaluate(root, "name(/*)").string() == str("library"));
+        CPPUNIT_ASSERT(evaluate(root, "name(//x:note)").string() == str("x:note"));
+        CPPUNIT_ASSERT(evaluate(root, "local-name(//x:note)").string() == str("note"));
+        CPPUNIT_ASSERT(evaluate(root, "namespace-uri(//x:note)").string() == str("urn:x"));
+        CPPUNIT_ASSERT(evaluate(root, "namespace-uri(/*)").string() == str(""));
+        CPPUNIT_ASSERT(evaluate(root, "count(//*[local-name() = 'note'])").number() == 1);
+        CPPUNIT_ASSERT(evaluate(root, "string-length(//title[1])").number() == 5);
+        CPPUNIT_ASSERT(evaluate(root, "count(//book[starts-with(title, 'D')])").number() == 1);
+    }
+
+    void test_operators()
+    {
+        const node_t none;
+
+        CPPUNIT_ASSERT(evaluate(none, "1 div 0").string() == str("Infinity"));
+        CPPUNIT_ASSERT(evaluate(none, "-1 div 0").string() == str("-Infinity"));
+        CPPUNIT_ASSERT(evaluate(none, "0 div 0").string() == str("NaN"));
+        CPPUNIT_ASSERT(evaluate(none, "1 div 3").string() == str("0.3333333333333333"));
+        CPPUNIT_ASSERT(evaluate(none, "0.1 + 0.2").string() == str("0.30000000000000004"));
+        CPPUNIT_ASSERT(evaluate(none, "12.50").string() == str("12.5"));
+        CPPUNIT_ASSERT(evaluate(none, "-0.000001").string() == str("-0.000001"));
+        CPPUNIT_ASSERT(evaluate(none, "1000000 * 1000000 * 1000000").string() == str("1000000000000000000"));
+        CPPUNIT_ASSERT(evaluate(none, "10 mod 3").number() == 1);
+        CPPUNIT_ASSERT(evaluate(none, "-7 mod 2").number() == -1);
+        CPPUNIT_ASSERT(evaluate(none, "2 * 3 - -1").number() == 7);
+        CPPUNIT_ASSERT(evaluate(none, "1 = '1'").boolean());
+        CPPUNIT_ASSERT(evaluate(none, "true() = 'x'").boolean());
+        CPPUNIT_ASSERT(evaluate(none, "'2' < '10'").boolean());
+        CPPUNIT_ASSERT(!evaluate(none, "'a' = 'b' or 1 > 2").boolean());
+        CPPUNIT_ASSERT(evaluate(none, "1 < 2 and 2 <= 2 and 3 >= 2 and 3 != 2").boolean());
+
+        const document_t doc = library();
+        const node_t     root(doc);
+
+        CPPUNIT_ASSERT(evaluate(root, "count(/library/*) * 2").number() == 8);
+        CPPUNIT_ASSERT(evaluate(root, "//title = //magazine/title").boolean());
+        CPPUNIT_ASSERT(evaluate(root, "//price != 10").boolean());
+        CPPUNIT_ASSERT(evaluate(root, "//price = 10").boolean());
+        CPPUNIT_ASSERT(!evaluate(root, "//price = 11").boolean());
+        CPPUNIT_ASSERT(evaluate(root, "5 < //price").boolean());
+        CPPUNIT_ASSERT(!evaluate(root, "30 < //price").boolean());
+        CPPUNIT_ASSERT(evaluate(root, "//price > //title").boolean() == false);
+        CPPUNIT_ASSERT(evaluate(root, "//nothing = false()").boolean());
+        CPPUNIT_ASSERT(evaluate(root, "count(//book[title = //magazine/title])").number() == 0);
+        CPPUNIT_ASSERT(evaluate(root, "//book[1]/price + //book[2]/price").number() == 35.5);
+    }
+
+    void test_variables()
+    {
+        const document_t doc = library();
+        const node_t     root(doc);
+        variables_t      variables;
+
+        variables[str("n")]     = value_t(2.0);
+        variables[str("name")]  = value_t(str("Delta"));
+        variables[str("books")] = value_t(compile("//book[@year > 2000]")->select(root));
+
+        const expression_pointer_t nth = compile("//book[$n]/title");
+
+        CPPUNIT_ASSERT(nth->evaluate(root, &variables).string() == str("Beta"));
+        CPPUNIT_ASSERT(compile("//book[title = $name]/@id")->evaluate(root, &variables).string() == str("b3"));
+        CPPUNIT_ASSERT(compile("count($books)")->evaluate(root, &variables).number() == 2);
+        CPPUNIT_ASSERT(compile("$books[2]/title")->evaluate(root, &variables).string() == str("Delta"));
+        CPPUNIT_ASSERT(compile("count($missing)")->evaluate(root, &variables).number() == 0);
+
+        variables[str("n")] = value_t(3.0);
+
+        CPPUNIT_ASSERT(nth->evaluate(root, &variables).string() == str("Delta"));
+        CPPUNIT_ASSERT(nth->evaluate(root).string() == str(""));
+    }
+
+    static std::vector<string_t> titles(const node_t& context, const std::string& expression, const variables_t* variables = nullptr)
+    {
+        std::vector<string_t> values;
+
+        for (const node_t& node : compile(expression)->select(context, variables))
+            values.push_back(node.string_value());
+
+        return values;
+    }
+
+    void test_index()
+    {
+        const document_t plain = library();
+        document_t       doc   = library();
+        variables_t      variables;
+
+        variables[str("id")]   = value_t(str("b3"));
+        variables[str("year")] = value_t(2005.0);
+
+        CPPUNIT_ASSERT(!doc.indexes_attributes());
+        CPPUNIT_ASSERT(doc.attribute_index() == nullptr);
+
+        doc.index_attributes();
+
+        CPPUNIT_ASSERT(doc.indexes_attributes());
+        CPPUNIT_ASSERT(doc.attribute_index()->built());
+
+        const char* const expressions[] = {
+            "//book[@id = 'b2']/title",
+            "//*[@id = $id]/title",
+            "//*['m1' = @id]/title",
+            "//book[@id = 'm1']/title",
+            "//book[@year = $year]/title",
+            "//book[@year = 2010]/title",
+            "//*[@x:k = 'v']",
+            "/library//book[@id = 'b1'][price > 5]/title",
+            "//book[@id = 'b1']/ancestor::*",
+            "//book[@id = 'b1'] | //book[@id = 'b3']",
+            "//title[@id = 'b1']",
+            "//book[@id = 'none']"
+        };
+
+        for (const char* expression : expressions)
+            CPPUNIT_ASSERT(titles(node_t(doc), expression, &variables) == titles(node_t(plain), expression, &variables));
+
+        CPPUNIT_ASSERT(titles(node_t(doc), "//*[@id = $id]/title", &variables) == std::vector<string_t> { str("Delta") });
+        auto it = doc.root().template begin<element_t>();
+
+        CPPUNIT_ASSERT(titles(node_t(*it), "descendant-or-self::*[@id = 'b1']/title").size() == 1);
+        CPPUNIT_ASSERT(titles(node_t(*++it), ".//*[@id = 'b1']").empty());
+
+        element_t&                                    magazine = *++it;
+        const typename document_t::attribute_index_t* index    = doc.attribute_index();
+
+        CPPUNIT_ASSERT(magazine.attributes().size() != 0);
+        CPPUNIT_ASSERT(magazine.attributes().erase(attribute_t(string_t(str("none")), string_t())) == 0);
+        CPPUNIT_ASSERT(index->built());
+
+        document_t other = library();
+
+        other.root().attributes().emplace(string_t(str("k")), string_t(str("v")));
+        other.root().erase(other.root().begin());
+
+        CPPUNIT_ASSERT(index->built());
+
+        magazine.attributes().emplace(string_t(str("k")), string_t(str("v")), doc.namespaces().find(str("urn:x")));
+
+        CPPUNIT_ASSERT(!index->built());
+
+        CPPUNIT_ASSERT(!doc.attribute_index()->find(doc.namespaces().find(str("urn:x")), str("k"), str("v")).empty());
+        CPPUNIT_ASSERT(titles(node_t(doc), "//*[@x:k = 'v']/title") == std::vector<string_t> { str("Gamma") });
+
+        doc.root().erase(doc.root().template begin<element_t>());
+
+        CPPUNIT_ASSERT(titles(node_t(doc), "//book[@id = 'b1']").empty());
+        CPPUNIT_ASSERT(titles(node_t(doc), "//book[@id = 'b2']/title") == std::vector<string_t> { str("Beta") });
+
+        const document_t copy(doc);
+
+        CPPUNIT_ASSERT(copy.indexes_attributes());
+        CPPUNIT_ASSERT(titles(node_t(copy), "//*[@x:k = 'v']/title") == std::vector<string_t> { str("Gamma") });
+
+        doc.index_attributes(false);
+
+        CPPUNIT_ASSERT(doc.attribute_index() == nullptr);
+        CPPUNIT_ASSERT(titles(node_t(doc), "//book[@id = 'b3']/title") == std::vector<string_t> { str("Delta") });
+    }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(test_xpath<char>);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_xpath<char16_t>);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_xpath<char32_t>);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_xpath<wchar_t>);
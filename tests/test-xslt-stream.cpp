@@ -0,0 +1,268 @@
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <string>
+#include <sstream>
+#include <algorithm>
+#include <stdexcept>
+
+#include "xslt-stream.h"
+#include "push-parser.h"
+#include "sax.h"
+#include "builder.h"
+
+template <typename charT>
+class test_xslt_stream : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE( test_xslt_stream );
+    CPPUNIT_TEST( test_sax );
+    CPPUNIT_TEST( test_push );
+    CPPUNIT_TEST( test_streamable );
+    CPPUNIT_TEST( test_errors );
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    typedef xml::basic_xslt_stream<charT>               stream_t;
+    typedef typename stream_t::stylesheet_t             stylesheet_t;
+    typedef typename stream_t::stylesheet_pointer_t     stylesheet_pointer_t;
+    typedef typename stream_t::parameters_t             parameters_t;
+    typedef typename stream_t::exception_t              exception_t;
+    typedef typename stream_t::handler_t                writer_t;
+    typedef typename stylesheet_t::node_t               node_t;
+    typedef typename stylesheet_t::value_t              value_t;
+    typedef typename stylesheet_t::document_t           document_t;
+    typedef xml::basic_sax_parser<charT>                parser_t;
+    typedef xml::basic_push_parser<charT, stream_t>     push_parser_t;
+    typedef typename parser_t::reader_t                 reader_t;
+    typedef xml::basic_builder<charT>                   builder_t;
+    typedef std::basic_string<charT>                    string_t;
+
+    static string_t str(const std::string& ascii)
+    {
+        return string_t(ascii.begin(), ascii.end());
+    }
+
+    static std::string stylesheet(const std::string& content)
+    {
+        return "<xsl:stylesheet version='1.0' xmlns:xsl='http://www.w3.org/1999/XSL/Transform' xmlns:p='urn:x'>" + content + "</xsl:stylesheet>";
+    }
+
+    static stylesheet_pointer_t compile(const std::string& xslt)
+    {
+        return stylesheet_t::compile(str(xslt));
+    }
+
+    static string_t write(const stylesheet_pointer_t& compiled, const string_t& source, const parameters_t* parameters = nullptr)
+    {
+        std::basic_ostringstream<charT> out;
+
+        compiled->write(node_t(builder_t::parse(source)), out, parameters);
+
+        return out.str();
+    }
+
+    static string_t stream(const stylesheet_pointer_t& compiled, const string_t& source, const parameters_t* parameters = nullptr, size_t records = 0)
+    {
+        std::basic_ostringstream<charT> out;
+        writer_t                        writer(out, compiled->output());
+        stream_t                        handler(compiled, writer, parameters);
+        parser_t                        parser(source.data(), source.data() + source.size());
+
+        CPPUNIT_ASSERT(parser.parse(handler) == reader_t::end_document);
+        CPPUNIT_ASSERT(handler.error_code() == reader_t::no_error);
+        CPPUNIT_ASSERT(records == 0 || handler.count() == records);
+
+        writer.finish();
+
+        return out.str();
+    }
+
+    void test_sax()
+    {
+        const string_t catalog = str(
+            "<?xml version='1.0'?>\n<!-- catalog -->\n"
+            "<catalog xmlns:q='urn:x'>\n"
+            "  <q:item id='a' price='3'><name>A</name></q:item>\n"
+            "  <q:item id='b' price='10'><name>B</name><tag>x</tag><tag>y</tag></q:item>\n"
+            "  <other><q:item id='z' price='99'/></other>\n"
+            "  <q:item id='c' price='7.5'><name><![CDATA[C & D]]></name></q:item>\n"
+            "</catalog>");
+
+        const stylesheet_pointer_t report = compile(stylesheet(
+            "<xsl:output indent='yes'/>"
+            "<xsl:param name='currency' select=\"'EUR'\"/>"
+            "<xsl:template match='/'>"
+            "<report><xsl:comment>start</xsl:comment><xsl:variable name='v' select='1'/>"
+            "<items><xsl:attribute name='kind'>items</xsl:attribute>"
+            "<xsl:apply-templates select='catalog/p:item[@price &gt; 5]'><xsl:with-param name='unit' select=\"'u'\"/></xsl:apply-templates>"
+            "</items><total>end</total></report></xsl:template>"
+            "<xsl:template match='p:item'><xsl:param name='unit'/>"
+            "<i n='{position()}' id='{@id}'><xsl:value-of select='name'/>:<xsl:value-of select='@price * 2'/>"
+            "<xsl:value-of select='$unit'/><xsl:value-of select='$currency'/><xsl:apply-templates select='tag' mode='t'/></i></xsl:template>"
+            "<xsl:template match='tag' mode='t'><t><xsl:value-of select='.'/></t></xsl:template>"));
+
+        CPPUNIT_ASSERT(report->streamable());
+        CPPUNIT_ASSERT(stream(report, catalog, nullptr, 2) == write(report, catalog));
+        CPPUNIT_ASSERT(stream(report, catalog).find(str("<i id=\"c\" n=\"2\">C &amp; D:15uEUR</i>")) != string_t::npos);
+
+        const parameters_t parameters = { { str("currency"), value_t(str("USD")) } };
+
+        CPPUNIT_ASSERT(stream(report, catalog, &parameters) == write(report, catalog, &parameters));
+        CPPUNIT_ASSERT(stream(report, catalog, &parameters).find(str("20uUSD")) != string_t::npos);
+
+        const stylesheet_pointer_t rows = compile(
+            "<out xsl:version='1.0' xmlns:xsl='http://www.w3.org/1999/XSL/Transform'>"
+            "<xsl:variable name='sep' select=\"'; '\"/>"
+            "<xsl:for-each select='//row'><xsl:if test='@k'><xsl:value-of select='@k'/>=</xsl:if>"
+            "<xsl:value-of select='.'/><xsl:value-of select='$sep'/></xsl:for-each>"
+            "<xsl:text>done</xsl:text></out>");
+        const string_t table = str("<t><row k='1'>a</row><g><row>b</row><row k='3'>c<row>nested</row></row></g></t>");
+
+        CPPUNIT_ASSERT(rows->streamable());
+        CPPUNIT_ASSERT(stream(rows, table, nullptr, 3) == str("<?xml version=\"1.0\"?>\n<out>1=a; b; 3=cnested; done</out>"));
+
+        const stylesheet_pointer_t builtin = compile(stylesheet(
+            "<xsl:output method='text'/>"
+            "<xsl:template match='/'>[<xsl:apply-templates select='doc/sec'/>]</xsl:template>"
+            "<xsl:template match='title'>(<xsl:value-of select='.'/>)</xsl:template>"
+            "<xsl:template match='sec[@hidden]'/>"));
+        const string_t sections = str("<doc><sec><title>One</title>body</sec><sec hidden='1'>x</sec><sec>two<title>Two</title></sec></doc>");
+
+        CPPUNIT_ASSERT(builtin->streamable());
+        CPPUNIT_ASSERT(stream(builtin, sections, nullptr, 3) == write(builtin, sections));
+        CPPUNIT_ASSERT(stream(builtin, sections) == str("[(One)bodytwo(Two)]"));
+    }
+
+    void test_push()
+    {
+        std::string document = "<orders>";
+
+        for (size_t i = 0; i < 3000; ++i)
+            document += "<order id='" + std::to_string(i + 1) + "'><line q='" + std::to_string(i % 7) + "'>x &lt; y</line><line q='1'/></order>";
+
+        document += "</orders>";
+
+        const string_t             input    = str(document);
+        const stylesheet_pointer_t compiled = compile(stylesheet(
+            "<xsl:output omit-xml-declaration='yes'/>"
+            "<xsl:template match='/'><total><xsl:apply-templates select='orders/order'/></total></xsl:template>"
+            "<xsl:template match='order'><o id='{@id}' q='{sum(line/@q)}'><xsl:value-of select='line'/></o></xsl:template>"));
+        const string_t             expected = write(compiled, input);
+
+        CPPUNIT_ASSERT(expected.size() > 65536);
+
+        for (size_t chunk : { size_t(1), size_t(13), input.size() }) {
+            std::basic_ostringstream<charT> out;
+            writer_t                        writer(out, compiled->output());
+            stream_t                        handler(compiled, writer);
+            push_parser_t                   parser(handler);
+
+            for (size_t i = 0; i < input.size(); i += chunk)
+                CPPUNIT_ASSERT(parser.feed(input.data() + i, std::min(chunk, input.size() - i)));
+
+            CPPUNIT_ASSERT(parser.finish());
+            CPPUNIT_ASSERT(handler.count() == 3000);
+
+            writer.finish();
+
+            CPPUNIT_ASSERT(out.str() == expected);
+        }
+
+        std::basic_ostringstream<charT> out;
+        writer_t                        writer(out, compiled->output());
+        stream_t                        handler(compiled, writer);
+        const string_t                  small = str("<orders><order id='7'><line q='2'>z</line></order></orders>");
+
+        for (size_t n = 0; n != 2; ++n) {
+            parser_t parser(small.data(), small.data() + small.size());
+
+            handler.reset();
+
+            CPPUNIT_ASSERT(parser.parse(handler) == reader_t::end_document);
+            CPPUNIT_ASSERT(handler.count() == 1);
+        }
+
+        writer.finish();
+
+        CPPUNIT_ASSERT(out.str() == str("<total><o id=\"7\" q=\"2\">z</o></total><total><o id=\"7\" q=\"2\">z</o></total>"));
+    }
+
+    void test_streamable()
+    {
+        const char* const rejected[] = {
+            "<xsl:template match='item'/>",
+            "<xsl:template match='/'><xsl:apply-templates select='//item'><xsl:sort select='@k'/></xsl:apply-templates></xsl:template>",
+            "<xsl:template match='/'><xsl:value-of select='count(//item)'/><xsl:apply-templates select='//item'/></xsl:template>",
+            "<xsl:template match='/'><xsl:apply-templates select='//item[1]'/></xsl:template>",
+            "<xsl:template match='/'><xsl:apply-templates select='//item[name]'/></xsl:template>",
+            "<xsl:template match='/'><xsl:apply-templates select='//item'/></xsl:template><xsl:template match='list/item'/>",
+            "<xsl:template match='/'><xsl:apply-templates select='//item'/></xsl:template><xsl:template match='item[2]'/>",
+            "<xsl:template match='/'><xsl:apply-templates select='//item'/></xsl:template><xsl:template match='item'><xsl:value-of select='../@k'/></xsl:template>",
+            "<xsl:template match='/'><xsl:for-each select='//item'><xsl:value-of select='/r/@k'/></xsl:for-each></xsl:template>",
+            "<xsl:template match='/'><xsl:for-each select='//item'><xsl:call-template name='n'/></xsl:for-each></xsl:template>"
+            "<xsl:template name='n'><xsl:value-of select='preceding::item'/></xsl:template>",
+            "<xsl:variable name='n' select='count(//item)'/><xsl:template match='/'><xsl:apply-templates select='//item'/></xsl:template>",
+            "<xsl:template match='/'><xsl:if test='r'><xsl:apply-templates select='//item'/></xsl:if></xsl:template>",
+            "<xsl:template match='/'><a x='{r/@k}'><xsl:apply-templates select='//item'/></a></xsl:template>"
+        };
+
+        for (const char* content : rejected)
+            CPPUNIT_ASSERT(!compile(stylesheet(content))->streamable());
+
+        const char* const accepted[] = {
+            "<xsl:template match='/'><xsl:apply-templates select='//item'/></xsl:template>",
+            "<xsl:template match='/'><xsl:apply-templates select='/r/item'/></xsl:template><xsl:template match='item[@k]'/>",
+            "<xsl:template match='/'><a><b x='1'><xsl:apply-templates select='r/p:item[@k = 2]' mode='m'/></b></a></xsl:template>"
+            "<xsl:template match='p:item' mode='m'><xsl:apply-templates select='@*|*'/></xsl:template><xsl:template match='@k'/>",
+            "<xsl:variable name='n' select='2'/><xsl:template match='/'><xsl:for-each select='//item[@k = $n]'>"
+            "<xsl:call-template name='n'/></xsl:for-each></xsl:template><xsl:template name='n'><xsl:copy-of select='.'/></xsl:template>"
+        };
+
+        for (const char* content : accepted)
+            CPPUNIT_ASSERT(compile(stylesheet(content))->streamable());
+    }
+
+    void test_errors()
+    {
+        std::basic_ostringstream<charT> out;
+        writer_t                        writer(out);
+        bool                            thrown = false;
+
+        try {
+            stream_t rejected(compile(stylesheet("<xsl:template match='item'/>")), writer);
+        } catch (std::invalid_argument&) {
+            thrown = true;
+        }
+
+        CPPUNIT_ASSERT(thrown);
+
+        const stylesheet_pointer_t stop = compile(stylesheet(
+            "<xsl:template match='/'><r><xsl:apply-templates select='r/item'/></r></xsl:template>"
+            "<xsl:template match='item[@stop]'><xsl:message terminate='yes'/></xsl:template>"));
+        const string_t             input = str("<r><item/><item stop='1'/><item/></r>");
+        stream_t                   handler(stop, writer);
+        parser_t                   parser(input.data(), input.data() + input.size());
+
+        thrown = false;
+
+        try {
+            parser.parse(handler);
+        } catch (exception_t&) {
+            thrown = true;
+        }
+
+        CPPUNIT_ASSERT(thrown);
+        CPPUNIT_ASSERT(handler.count() == 2);
+
+        const string_t unbound = str("<r><q:item/></r>");
+        stream_t       names(stop, writer);
+        parser_t       again(unbound.data(), unbound.data() + unbound.size());
+
+        CPPUNIT_ASSERT(again.parse(names) != reader_t::end_document);
+        CPPUNIT_ASSERT(names.error_code() == reader_t::invalid_namespace);
+    }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(test_xslt_stream<char>);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_xslt_stream<char16_t>);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_xslt_stream<char32_t>);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_xslt_stream<wchar_t>);
@@ -0,0 +1,248 @@
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <string>
+#include <sstream>
+
+#include "xslt.h"
+#include "builder.h"
+
+template <typename charT>
+class test_xslt : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE( test_xslt );
+    CPPUNIT_TEST( test_templates );
+    CPPUNIT_TEST( test_dispatch );
+    CPPUNIT_TEST( test_namespaces );
+    CPPUNIT_TEST( test_output );
+    CPPUNIT_TEST( test_errors );
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    typedef xml::basic_stylesheet<charT>                stylesheet_t;
+    typedef typename stylesheet_t::stylesheet_pointer_t stylesheet_pointer_t;
+    typedef typename stylesheet_t::parameters_t         parameters_t;
+    typedef typename stylesheet_t::exception_t          exception_t;
+    typedef typename stylesheet_t::expression_t         expression_t;
+    typedef typename stylesheet_t::value_t              value_t;
+    typedef typename stylesheet_t::node_t               node_t;
+    typedef typename stylesheet_t::document_t           document_t;
+    typedef xml::basic_builder<charT>                   builder_t;
+    typedef std::basic_string<charT>                    string_t;
+
+    static string_t str(const std::string& ascii)
+    {
+        return string_t(ascii.begin(), ascii.end());
+    }
+
+    static std::string stylesheet(const std::string& content, const std::string& output = "<xsl:output omit-xml-declaration='yes'/>")
+    {
+        return "<xsl:stylesheet version='1.0' xmlns:xsl='http://www.w3.org/1999/XSL/Transform' xmlns:p='urn:x'>" + output + content + "</xsl:stylesheet>";
+    }
+
+    static string_t write(const std::string& xslt, const std::string& source, const parameters_t* parameters = nullptr)
+    {
+        const stylesheet_pointer_t      compiled = stylesheet_t::compile(str(xslt));
+        const document_t                doc      = builder_t::parse(str(source));
+        std::basic_ostringstream<charT> out;
+
+        compiled->write(node_t(doc), out, parameters);
+
+        return out.str();
+    }
+
+    static bool rejected(const std::string& xslt)
+    {
+        return !stylesheet_t::try_compile(builder_t::parse(str(xslt)));
+    }
+
+    static bool throws(const std::string& xslt, const std::string& source)
+    {
+        try {
+            stylesheet_t::compile(str(xslt))->transform(node_t(builder_t::parse(str(source))));
+        } catch (exception_t&) {
+            return true;
+        }
+
+        return false;
+    }
+
+    void test_templates()
+    {
+        const std::string library =
+            "<library><book id='b1'><title>Alpha</title><price>10</price></book>"
+            "<book id='b2'><title>Beta</title><price>25.5</price></book>"
+            "<book id='b3'><title>Delta</title><price>7</price></book></library>";
+        const std::string catalog = stylesheet(
+            "<xsl:param name='currency' select=\"'EUR'\"/>"
+            "<xsl:template match='/'>"
+            "  <catalog count='{count(//book)}'>"
+            "    <xsl:apply-templates select='library/book'>"
+            "      <xsl:sort select='price' data-type='number' order='descending'/>"
+            "    </xsl:apply-templates>"
+            "  </catalog>"
+            "</xsl:template>"
+            "<xsl:template match='book'>"
+            "  <xsl:variable name='cheap' select='price &lt; 10'/>"
+            "  <item id='{@id}' currency='{$currency}'>"
+            "    <xsl:if test='$cheap'><xsl:attribute name='cheap'>yes</xsl:attribute></xsl:if>"
+            "    <xsl:value-of select='title'/>"
+            "  </item>"
+            "</xsl:template>");
+
+        CPPUNIT_ASSERT(write(catalog, library) == str(
+            "<catalog count=\"3\"><item currency=\"EUR\" id=\"b2\">Beta</item>"
+            "<item currency=\"EUR\" id=\"b1\">Alpha</item>"
+            "<item currency=\"EUR\" id=\"b3\" cheap=\"yes\">Delta</item></catalog>"));
+
+        parameters_t parameters;
+
+        parameters.emplace(str("currency"), value_t(str("USD")));
+
+        CPPUNIT_ASSERT(write(catalog, library, &parameters).find(str("currency=\"USD\"")) != string_t::npos);
+
+        const std::string calls = stylesheet(
+            "<xsl:variable name='n' select='100'/>"
+            "<xsl:template match='/'>"
+            "  <r>"
+            "    <xsl:call-template name='repeat'><xsl:with-param name='n' select='3'/></xsl:call-template>"
+            "    <xsl:for-each select='//book'>"
+            "      <xsl:choose>"
+            "        <xsl:when test='position() = last()'><last><xsl:value-of select='@id'/></last></xsl:when>"
+            "        <xsl:otherwise><xsl:copy-of select='.'/></xsl:otherwise>"
+            "      </xsl:choose>"
+            "    </xsl:for-each>"
+            "    <xsl:variable name='v'><xsl:text>t</xsl:text><xsl:value-of select='count(//book)'/></xsl:variable>"
+            "    <xsl:element name='{concat(\"e\", 1)}'><xsl:value-of select='$v'/></xsl:element>"
+            "    <xsl:call-template name='global'/>"
+            "  </r>"
+            "</xsl:template>"
+            "<xsl:template name='repeat'>"
+            "  <xsl:param name='n'/>"
+            "  <xsl:if test='$n &gt; 0'>"
+            "    <x><xsl:value-of select='$n'/></x>"
+            "    <xsl:call-template name='repeat'><xsl:with-param name='n' select='$n - 1'/></xsl:call-template>"
+            "  </xsl:if>"
+            "</xsl:template>"
+            "<xsl:template name='global'><g><xsl:value-of select='$n'/></g></xsl:template>");
+
+        CPPUNIT_ASSERT(write(calls, "<l><book id='a'>1</book><book id='b'>2</book></l>") == str(
+            "<r><x>3</x><x>2</x><x>1</x><book id=\"a\">1</book><last>b</last><e1>t2</e1><g>100</g></r>"));
+
+        const stylesheet_pointer_t simplified = stylesheet_t::compile(str(
+            "<out xsl:version='1.0' xmlns:xsl='http://www.w3.org/1999/XSL/Transform' xmlns='urn:o'>"
+            "<xsl:value-of select='count(//book)'/></out>"));
+        const document_t           source     = builder_t::parse(str(library));
+        const document_t           result     = simplified->transform(node_t(source));
+
+        CPPUNIT_ASSERT(result.namespaces().uri(result.root().namespace_id()) == str("urn:o"));
+        CPPUNIT_ASSERT(expression_t::compile(str("string(/*)"))->evaluate(node_t(result)).string() == str("3"));
+    }
+
+    void test_dispatch()
+    {
+        const std::string rules = stylesheet(
+            "<xsl:template match='*'><any><xsl:apply-templates/></any></xsl:template>"
+            "<xsl:template match='b'><b/></xsl:template>"
+            "<xsl:template match='a/c'><ac/></xsl:template>"
+            "<xsl:template match='c[@k]' priority='2'><ck/></xsl:template>"
+            "<xsl:template match='text()'>[<xsl:value-of select='.'/>]</xsl:template>"
+            "<xsl:template match='d | e'><de/></xsl:template>"
+            "<xsl:template match='b' mode='m'><bm/></xsl:template>"
+            "<xsl:template match='f'><xsl:apply-templates select='b' mode='m'/><xsl:apply-templates select='@*'/></xsl:template>"
+            "<xsl:template match='@k'><k><xsl:value-of select='.'/></k></xsl:template>"
+            "<xsl:template match='x'><first/></xsl:template>"
+            "<xsl:template match='x'><second/></xsl:template>"
+            "<xsl:template match='//y[2]'><y2/></xsl:template>");
+
+        CPPUNIT_ASSERT(write(rules, "<a><b/><c/><c k='1'/><d/>txt<e/><f z='0' k='2'><b/></f><g><c/></g><x/><y/><y/></a>") == str(
+            "<any><b/><ac/><ck/><de/>[txt]<de/><bm/><k>2</k>0<any><any/></any><second/><any/><y2/></any>"));
+
+        std::string many = "<r>";
+        std::string expected = "<any>";
+
+        for (size_t i = 0; i != 200; ++i) {
+            many += "<e" + std::to_string(i % 50) + "/>";
+            expected += i % 50 == 7 ? "<seven/>" : i % 50 == 8 ? "<eight/>" : "<any/>";
+        }
+
+        many += "</r>";
+        expected += "</any>";
+
+        CPPUNIT_ASSERT(write(stylesheet(
+            "<xsl:template match='*'><any><xsl:apply-templates/></any></xsl:template>"
+            "<xsl:template match='e7'><seven/></xsl:template>"
+            "<xsl:template match='r/e8'><eight/></xsl:template>"), many) == str(expected));
+    }
+
+    void test_namespaces()
+    {
+        const std::string xslt = stylesheet(
+            "<xsl:template match='/'><root><xsl:apply-templates select='//p:item'/></root></xsl:template>"
+            "<xsl:template match='p:item'>"
+            "  <p:found n='{@n}'><xsl:copy-of select='.'/></p:found>"
+            "  <xsl:element name='q:e' namespace='urn:q'><xsl:attribute name='a' namespace='urn:x'>1</xsl:attribute></xsl:element>"
+            "</xsl:template>");
+        const std::string source = "<doc xmlns:a='urn:x' xmlns='urn:d'><a:item n='1'><x/></a:item><item n='2'/></doc>";
+
+        CPPUNIT_ASSERT(write(xslt, source) == str(
+            "<root><p:found xmlns:p=\"urn:x\" n=\"1\"><a:item xmlns:a=\"urn:x\" n=\"1\"><x xmlns=\"urn:d\"/></a:item></p:found>"
+            "<q:e xmlns:q=\"urn:q\" xmlns:ns0=\"urn:x\" ns0:a=\"1\"/></root>"));
+
+        const document_t result = stylesheet_t::compile(str(xslt))->transform(node_t(builder_t::parse(str(source))));
+        const typename expression_t::bindings_t bindings { { str("x"), str("urn:x") }, { str("d"), str("urn:d") } };
+
+        CPPUNIT_ASSERT(expression_t::compile(str("count(//x:found/x:item/d:x)"), bindings)->evaluate(node_t(result)).number() == 1);
+        CPPUNIT_ASSERT(expression_t::compile(str("string(//@x:a)"), bindings)->evaluate(node_t(result)).string() == str("1"));
+    }
+
+    void test_output()
+    {
+        CPPUNIT_ASSERT(write(stylesheet(
+            "<xsl:template match='/'><a><b>x &amp; y</b><c q='&quot;&lt;'/><d><e/></d></a></xsl:template>",
+            "<xsl:output indent='yes'/>"), "<s/>") == str(
+            "<?xml version=\"1.0\"?>\n<a>\n  <b>x &amp; y</b>\n  <c q=\"&quot;&lt;\"/>\n  <d>\n    <e/>\n  </d>\n</a>"));
+
+        CPPUNIT_ASSERT(write(stylesheet(
+            "<xsl:template match='/'><a><xsl:for-each select='//b'><xsl:value-of select='.'/><xsl:text>&lt;</xsl:text></xsl:for-each></a></xsl:template>",
+            "<xsl:output method='text'/>"), "<s><b>1</b><b>2</b></s>") == str("1<2<"));
+
+        std::string large = "<s>";
+
+        for (size_t i = 0; i != 20000; ++i)
+            large += "<b>&lt;" + std::to_string(i) + "</b>";
+
+        large += "</s>";
+
+        const string_t output = write(stylesheet("<xsl:template match='b'><c><xsl:value-of select='.'/></c></xsl:template>"), large);
+
+        CPPUNIT_ASSERT(output.size() > 65536);
+        CPPUNIT_ASSERT(output.substr(0, 16) == str("<c>&lt;0</c><c>&"));
+        CPPUNIT_ASSERT(output.substr(output.size() - 13) == str("&lt;19999</c>"));
+    }
+
+    void test_errors()
+    {
+        CPPUNIT_ASSERT(rejected("<a/>"));
+        CPPUNIT_ASSERT(rejected(stylesheet("<xsl:template match='a['/>")));
+        CPPUNIT_ASSERT(rejected(stylesheet("<xsl:template match='count(a)'/>")));
+        CPPUNIT_ASSERT(rejected(stylesheet("<xsl:template match='a/following::b'/>")));
+        CPPUNIT_ASSERT(rejected(stylesheet("<xsl:key name='k' match='a' use='@id'/>")));
+        CPPUNIT_ASSERT(rejected(stylesheet("<xsl:template match='/'><xsl:call-template name='missing'/></xsl:template>")));
+        CPPUNIT_ASSERT(rejected(stylesheet("<xsl:template match='/'><xsl:unknown/></xsl:template>")));
+        CPPUNIT_ASSERT(rejected(stylesheet("<xsl:template match='/'><a href='{@x'/></xsl:template>")));
+        CPPUNIT_ASSERT(rejected(stylesheet("<xsl:template name='t'/><xsl:template name='t'/>")));
+        CPPUNIT_ASSERT(!rejected(stylesheet("<xsl:strip-space elements='*'/><other xmlns='urn:o'/>")));
+
+        CPPUNIT_ASSERT(throws(stylesheet("<xsl:template match='/'><a><xsl:message terminate='yes'>stop</xsl:message></a></xsl:template>"), "<s/>"));
+        CPPUNIT_ASSERT(throws(stylesheet("<xsl:template match='/'><a/><b/></xsl:template>"), "<s/>"));
+        CPPUNIT_ASSERT(throws(stylesheet("<xsl:template match='/'><xsl:call-template name='loop'/></xsl:template>"
+                                         "<xsl:template name='loop'><xsl:call-template name='loop'/></xsl:template>"), "<s/>"));
+        CPPUNIT_ASSERT(throws(stylesheet("<xsl:template match='/'><xsl:element name='u:a'/></xsl:template>"), "<s/>"));
+        CPPUNIT_ASSERT(!throws(stylesheet("<xsl:template match='/'><a><xsl:message>note</xsl:message></a></xsl:template>"), "<s/>"));
+    }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(test_xslt<char>);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_xslt<char16_t>);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_xslt<char32_t>);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_xslt<wchar_t>);